@@ -30,5 +30,16 @@ SUBDIRS = geometry \
 		src \
           plugins \
           tests
+
+# The benchmarks need google-benchmark, so they are only built when it is installed or with CONFIG+=benchmarks.
+CONFIG( benchmarks ) | exists( $$(TDE_ROOT)/local/include/benchmark/benchmark.h ) | packagesExist( benchmark ) {
+	benchmarks.target = benchmarks
+	benchmarks.CONFIG = recursive
+	benchmarks.recurse = benchmarks
+	benchmarks.depends = geometry
+
+	QMAKE_EXTRA_TARGETS += benchmarks
+	SUBDIRS += benchmarks
+}
             
 			
\ No newline at end of file
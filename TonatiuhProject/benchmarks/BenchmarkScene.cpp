@@ -0,0 +1,241 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cmath>
+
+#include <QFuture>
+#include <QMutex>
+#include <QStringList>
+#include <QtConcurrentMap>
+
+#include <Inventor/nodes/SoTransform.h>
+
+#include "BenchmarkScene.h"
+#include "Document.h"
+#include "InstanceNode.h"
+#include "Matrix4x4.h"
+#include "PhotonMapExport.h"
+#include "RandomDeviate.h"
+#include "RayTracer.h"
+#include "SceneModel.h"
+#include "tgf.h"
+#include "TLightKit.h"
+#include "TLightShape.h"
+#include "TPhotonMap.h"
+#include "Transform.h"
+#include "trf.h"
+#include "TSceneKit.h"
+#include "TSunShape.h"
+#include "TTransmissivity.h"
+
+BenchmarkScene::BenchmarkScene()
+:m_document( new Document ),
+m_sceneModel( new SceneModel ),
+m_pRootSeparatorInstance( 0 ),
+m_pPhotonMap( 0 ),
+m_tracedRays( 0 ),
+m_errorMessage( QLatin1String( "" ) )
+{
+
+}
+
+BenchmarkScene::~BenchmarkScene()
+{
+	delete m_pPhotonMap;
+	delete m_sceneModel;
+	delete m_document;
+}
+
+/*!
+ * Returns the description of the last error.
+ */
+QString BenchmarkScene::GetErrorMessage() const
+{
+	return m_errorMessage;
+}
+
+/*!
+ * Returns the photon map with the photons of the last trace.
+ */
+TPhotonMap* BenchmarkScene::GetPhotonMap() const
+{
+	return m_pPhotonMap;
+}
+
+/*!
+ * Returns the number of photons stored in the last trace.
+ */
+unsigned long BenchmarkScene::GetStoredPhotons() const
+{
+	if( !m_pPhotonMap )	return 0;
+	return m_pPhotonMap->GetAllPhotons().size();
+}
+
+/*!
+ * Exports the photons of the last trace with \a pExportMode and removes them from the photon map.
+ * The power of each photon is computed from the sun irradiance and the light source area as the main window does.
+ *
+ * Returns false if there is not a trace to export or the export cannot be started.
+ */
+bool BenchmarkScene::Export( PhotonMapExport* pExportMode )
+{
+	if( !m_pPhotonMap || ( m_tracedRays == 0 ) || !pExportMode )
+	{
+		m_errorMessage = QLatin1String( "There are not photons to export." );
+		return false;
+	}
+
+	TSceneKit* coinScene = m_document->GetSceneKit();
+	TLightKit* lightKit = static_cast< TLightKit* >( coinScene->getPart( "lightList[0]", false ) );
+	TSunShape* sunShape = static_cast< TSunShape * >( lightKit->getPart( "tsunshape", false ) );
+	TLightShape* raycastingSurface = static_cast< TLightShape * >( lightKit->getPart( "icon", false ) );
+
+	pExportMode->SetSceneModel( *m_sceneModel );
+	if( !m_pPhotonMap->SetExportMode( pExportMode ) )
+	{
+		m_errorMessage = QLatin1String( "The photon map export cannot be started." );
+		return false;
+	}
+
+	double wPhoton = ( raycastingSurface->GetValidArea() * sunShape->GetIrradiance() ) / m_tracedRays;
+	m_pPhotonMap->EndStore( wPhoton );
+
+	return true;
+}
+
+/*!
+ * Reads the model saved in \a fileName and computes the scene tree map and the sun light source area.
+ *
+ * Returns false if the model cannot be read or it has not a light.
+ */
+bool BenchmarkScene::Open( QString fileName )
+{
+	if( !m_document->ReadFile( fileName ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot open file %1." ) ).arg( fileName );
+		return false;
+	}
+
+	TSceneKit* coinScene = m_document->GetSceneKit();
+	m_sceneModel->SetCoinScene( *coinScene );
+
+	InstanceNode* sunNode = m_sceneModel->NodeFromIndex( m_sceneModel->IndexFromNodeUrl( QLatin1String( "//SunNode" ) ) );
+	if( !sunNode || !sunNode->GetParent() )
+	{
+		m_errorMessage = QString( QLatin1String( "The model %1 has not a concentrator." ) ).arg( fileName );
+		return false;
+	}
+	m_pRootSeparatorInstance = sunNode;
+
+	if ( !coinScene->getPart( "lightList[0]", false ) )
+	{
+		m_errorMessage = QString( QLatin1String( "The model %1 has not a sun light." ) ).arg( fileName );
+		return false;
+	}
+	TLightKit* lightKit = static_cast< TLightKit* >( coinScene->getPart( "lightList[0]", false ) );
+
+	trf::ComputeSceneTreeMap( m_pRootSeparatorInstance, Transform( new Matrix4x4 ), true );
+
+	QSet< QString > disabledNodes = QString( lightKit->disabledNodes.getValue().getString() ).split( ";", QString::SkipEmptyParts ).toSet();
+	QVector< QPair< TShapeKit*, Transform > > surfacesList;
+	trf::ComputeFistStageSurfaceList( m_pRootSeparatorInstance, disabledNodes, &surfacesList );
+	if( surfacesList.count() < 1 )
+	{
+		m_errorMessage = QString( QLatin1String( "There are no surfaces defined for ray tracing in %1." ) ).arg( fileName );
+		return false;
+	}
+	lightKit->ComputeLightSourceArea( 200, 200, surfacesList );
+
+	return true;
+}
+
+/*!
+ * Traces \a numberOfRays rays from the sun with the random generator \a rand.
+ * The photons of the previous trace are discarded.
+ *
+ * Returns false if the scene is not ready to trace.
+ */
+bool BenchmarkScene::Trace( unsigned long numberOfRays, RandomDeviate& rand )
+{
+	if( !m_pRootSeparatorInstance )
+	{
+		m_errorMessage = QLatin1String( "There is not any model opened." );
+		return false;
+	}
+
+	TSceneKit* coinScene = m_document->GetSceneKit();
+	TLightKit* lightKit = static_cast< TLightKit* >( coinScene->getPart( "lightList[0]", false ) );
+	TSunShape* sunShape = static_cast< TSunShape * >( lightKit->getPart( "tsunshape", false ) );
+	TLightShape* raycastingSurface = static_cast< TLightShape * >( lightKit->getPart( "icon", false ) );
+	SoTransform* lightTransform = static_cast< SoTransform * >( lightKit->getPart( "transform" ,false ) );
+	if( !sunShape || !raycastingSurface || !lightTransform )
+	{
+		m_errorMessage = QLatin1String( "The sun light is not properly configured." );
+		return false;
+	}
+
+	TTransmissivity* transmissivity = 0;
+	if( coinScene->getPart( "transmissivity", false ) )
+		transmissivity = static_cast< TTransmissivity* > ( coinScene->getPart( "transmissivity", false ) );
+
+	InstanceNode* lightInstance = m_pRootSeparatorInstance->GetParent()->children[0];
+
+	delete m_pPhotonMap;
+	m_pPhotonMap = new TPhotonMap();
+	m_pPhotonMap->SetBufferSize( HUGE_VAL );
+	m_pPhotonMap->SetConcentratorToWorld( m_pRootSeparatorInstance->GetIntersectionTransform() );
+
+	Transform lightToWorld = tgf::TransformFromSoTransform( lightTransform );
+	lightInstance->SetIntersectionTransform( lightToWorld.GetInverse() );
+
+	QVector< long > raysPerThread = trf::ComputeRaysPerThread( numberOfRays, 0 );
+	QVector< InstanceNode* > exportSuraceList;
+
+	QMutex mutex;
+	QMutex mutexPhotonMap;
+	QFuture< void > photonMap;
+	photonMap = QtConcurrent::map( raysPerThread, RayTracer( m_pRootSeparatorInstance,
+			lightInstance, raycastingSurface, sunShape, lightToWorld,
+			transmissivity, rand,
+			&mutex, m_pPhotonMap, &mutexPhotonMap,
+			exportSuraceList ) );
+	photonMap.waitForFinished();
+	m_tracedRays = numberOfRays;
+
+	return true;
+}
@@ -0,0 +1,82 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef BENCHMARKSCENE_H_
+#define BENCHMARKSCENE_H_
+
+#include <QString>
+
+class Document;
+class InstanceNode;
+class PhotonMapExport;
+class RandomDeviate;
+class SceneModel;
+class TPhotonMap;
+
+//!  BenchmarkScene traces a Tonatiuh model without the graphic user interface.
+/*!
+  The model is read from a file and prepared for the ray tracing as the main window does,
+  so that the traced rays measure the same code that runs in the application.
+  The photons are kept in memory until they are exported with Export.
+*/
+
+class BenchmarkScene
+{
+
+public:
+	BenchmarkScene();
+	~BenchmarkScene();
+
+	QString GetErrorMessage() const;
+	TPhotonMap* GetPhotonMap() const;
+	unsigned long GetStoredPhotons() const;
+
+	bool Export( PhotonMapExport* pExportMode );
+	bool Open( QString fileName );
+	bool Trace( unsigned long numberOfRays, RandomDeviate& rand );
+
+private:
+	Document* m_document;
+	SceneModel* m_sceneModel;
+	InstanceNode* m_pRootSeparatorInstance;
+	TPhotonMap* m_pPhotonMap;
+	unsigned long m_tracedRays;
+	QString m_errorMessage;
+};
+
+#endif /* BENCHMARKSCENE_H_ */
@@ -0,0 +1,205 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cmath>
+
+#if defined( WIN32 )
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <QString>
+
+#include "BBox.h"
+#include "BenchmarksAuxiliaryFunctions.h"
+#include "gc.h"
+#include "InstanceNode.h"
+#include "Photon.h"
+#include "Point3D.h"
+#include "Ray.h"
+#include "Vector3D.h"
+
+BenchmarkRandomDeviate::BenchmarkRandomDeviate( unsigned long seed, const unsigned long arraySize )
+:RandomDeviate( arraySize ),
+m_state( seed )
+{
+
+}
+
+/*!
+ * Fills \a array with \a arraySize numbers in [0,1) of a xorshift64* generator.
+ */
+void BenchmarkRandomDeviate::FillArray( double* array, const unsigned long arraySize )
+{
+	for( unsigned long i = 0; i < arraySize; ++i )
+	{
+		m_state ^= m_state >> 12;
+		m_state ^= m_state << 25;
+		m_state ^= m_state >> 27;
+		unsigned long long value = m_state * 2685821657736338717ULL;
+		array[i] = ( value >> 11 ) * ( 1.0 / 9007199254740992.0 );
+	}
+}
+
+/*!
+ * Adds the bytes of \a value to the FNV-1a \a hash.
+ */
+static void HashValue( unsigned long long* hash, long long value )
+{
+	for( int b = 0; b < 8; ++b )
+	{
+		*hash ^= ( value >> ( 8 * b ) ) & 0xff;
+		*hash *= 1099511628211ULL;
+	}
+}
+
+/*!
+ * Returns the maximum memory used by the process until now, in bytes.
+ * The value never decreases, so to measure a single scene run only its benchmark.
+ */
+double baf::PeakMemoryUsage()
+{
+#if defined( WIN32 )
+	PROCESS_MEMORY_COUNTERS memoryCounters;
+	if( !GetProcessMemoryInfo( GetCurrentProcess(), &memoryCounters, sizeof( memoryCounters ) ) )	return 0.0;
+	return double( memoryCounters.PeakWorkingSetSize );
+#else
+	struct rusage usage;
+	if( getrusage( RUSAGE_SELF, &usage ) != 0 )	return 0.0;
+#if defined( __APPLE__ )
+	return double( usage.ru_maxrss );
+#else
+	return double( usage.ru_maxrss ) * 1024.0;
+#endif
+#endif
+}
+
+/*!
+ * Returns a FNV-1a checksum of the \a photons id, position, side, absorption and intersected surface url.
+ * The positions are rounded to micrometres, so the checksum changes only if the physics of the trace change.
+ */
+unsigned long long baf::PhotonsChecksum( const std::vector< Photon* >& photons )
+{
+	unsigned long long checksum = 14695981039346656037ULL;
+	for( unsigned int p = 0; p < photons.size(); ++p )
+	{
+		Photon* photon = photons[p];
+		HashValue( &checksum, llround( photon->id ) );
+		HashValue( &checksum, llround( photon->pos.x * 1.0e6 ) );
+		HashValue( &checksum, llround( photon->pos.y * 1.0e6 ) );
+		HashValue( &checksum, llround( photon->pos.z * 1.0e6 ) );
+		HashValue( &checksum, photon->side );
+		HashValue( &checksum, photon->isAbsorbed );
+		if( photon->intersectedSurface )
+		{
+			QString surfaceURL = photon->intersectedSurface->GetNodeURL();
+			for( int c = 0; c < surfaceURL.size(); ++c )
+				HashValue( &checksum, surfaceURL[c].unicode() );
+		}
+	}
+	return checksum;
+}
+
+/*!
+ * Returns a random number in [\a a, \a b).
+ */
+double baf::RandomNumber( RandomDeviate& rand, double a, double b )
+{
+	return a + ( b - a ) * rand.RandomDouble();
+}
+
+/*!
+ * Returns a random point inside \a box.
+ */
+Point3D baf::RandomPoint( RandomDeviate& rand, const BBox& box )
+{
+	return Point3D( RandomNumber( rand, box.pMin.x, box.pMax.x ),
+			RandomNumber( rand, box.pMin.y, box.pMax.y ),
+			RandomNumber( rand, box.pMin.z, box.pMax.z ) );
+}
+
+/*!
+ * Returns a random unit vector uniformly distributed over the sphere.
+ */
+Vector3D baf::RandomDirection( RandomDeviate& rand )
+{
+	double z = RandomNumber( rand, -1.0, 1.0 );
+	double phi = gc::TwoPi * rand.RandomDouble();
+	double r = sqrt( 1.0 - z * z );
+	return Vector3D( r * cos( phi ), r * sin( phi ), z );
+}
+
+/*!
+ * Returns \a numberOfRays rays with origin in the cube [\a a, \a b]^3 and random directions.
+ */
+std::vector< Ray > baf::RandomRays( double a, double b, int numberOfRays )
+{
+	BenchmarkRandomDeviate rand;
+	BBox box( Point3D( a, a, a ), Point3D( b, b, b ) );
+
+	std::vector< Ray > rays;
+	rays.reserve( numberOfRays );
+	for( int i = 0; i < numberOfRays; ++i )
+		rays.push_back( Ray( RandomPoint( rand, box ), RandomDirection( rand ) ) );
+	return rays;
+}
+
+/*!
+ * Returns \a numberOfRays rays aimed at random points of \a box from points of a sphere around the box.
+ * Most of the rays hit the shapes bounded by \a box, as the rays of the ray tracer do.
+ */
+std::vector< Ray > baf::RaysToBox( const BBox& box, int numberOfRays )
+{
+	BenchmarkRandomDeviate rand;
+	Point3D center;
+	double radius;
+	box.BoundingSphere( center, radius );
+	if( radius < gc::Epsilon )	radius = 1.0;
+
+	std::vector< Ray > rays;
+	rays.reserve( numberOfRays );
+	for( int i = 0; i < numberOfRays; ++i )
+	{
+		Point3D origin = center + 2.0 * radius * RandomDirection( rand );
+		Point3D target = RandomPoint( rand, box );
+		rays.push_back( Ray( origin, Normalize( target - origin ) ) );
+	}
+	return rays;
+}
@@ -0,0 +1,83 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef BENCHMARKSAUXILIARYFUNCTIONS_H_
+#define BENCHMARKSAUXILIARYFUNCTIONS_H_
+
+#include <vector>
+
+#include "RandomDeviate.h"
+
+class BBox;
+class Point3D;
+class Ray;
+class Vector3D;
+struct Photon;
+
+//!  BenchmarkRandomDeviate is a small deterministic generator for the benchmarks.
+/*!
+  It does not depend on the random generator plugins, so the benchmarks of the shapes, materials and
+  sunshapes measure always the same sequence of random numbers.
+*/
+
+class BenchmarkRandomDeviate : public RandomDeviate
+{
+public:
+	explicit BenchmarkRandomDeviate( unsigned long seed = 12345, const unsigned long arraySize = 100000 );
+	void FillArray( double* array, const unsigned long arraySize );
+
+private:
+	unsigned long long m_state;
+};
+
+namespace baf
+{
+	const int numberOfSamples = 4096;
+	const unsigned long referenceNumberOfRays = 1000000;
+	const unsigned long referenceSeed = 12345;
+
+	double PeakMemoryUsage();
+	unsigned long long PhotonsChecksum( const std::vector< Photon* >& photons );
+	double RandomNumber( RandomDeviate& rand, double a, double b );
+	Point3D RandomPoint( RandomDeviate& rand, const BBox& box );
+	Vector3D RandomDirection( RandomDeviate& rand );
+	std::vector< Ray > RandomRays( double a, double b, int numberOfRays );
+	std::vector< Ray > RaysToBox( const BBox& box, int numberOfRays );
+}
+
+#endif /* BENCHMARKSAUXILIARYFUNCTIONS_H_ */
@@ -0,0 +1,200 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "BBox.h"
+#include "BenchmarksAuxiliaryFunctions.h"
+#include "gc.h"
+#include "gf.h"
+#include "NormalVector.h"
+#include "Point3D.h"
+#include "Ray.h"
+#include "Transform.h"
+#include "Vector3D.h"
+
+static Transform BenchmarkTransform()
+{
+	return Translate( 1.0, -2.0, 3.0 ) * Rotate( 0.7, Vector3D( 1.0, 1.0, 0.0 ) ) * Scale( 2.0, 2.0, 2.0 );
+}
+
+static void BM_BBoxIntersectP( benchmark::State& state )
+{
+	BBox box( Point3D( -1.0, -1.0, -1.0 ), Point3D( 1.0, 1.0, 1.0 ) );
+	std::vector< Ray > rays = baf::RandomRays( -5.0, 5.0, baf::numberOfSamples );
+
+	int r = 0;
+	int hits = 0;
+	for( auto _ : state )
+	{
+		double t0, t1;
+		if( box.IntersectP( rays[r], &t0, &t1 ) )	++hits;
+		r = ( r + 1 ) % baf::numberOfSamples;
+	}
+	benchmark::DoNotOptimize( hits );
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_BBoxIntersectP );
+
+static void BM_TransformPoint( benchmark::State& state )
+{
+	Transform transform = BenchmarkTransform();
+	std::vector< Ray > rays = baf::RandomRays( -5.0, 5.0, baf::numberOfSamples );
+
+	int r = 0;
+	for( auto _ : state )
+	{
+		Point3D point = transform( rays[r].origin );
+		benchmark::DoNotOptimize( point );
+		r = ( r + 1 ) % baf::numberOfSamples;
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_TransformPoint );
+
+static void BM_TransformNormal( benchmark::State& state )
+{
+	Transform transform = BenchmarkTransform();
+	std::vector< Ray > rays = baf::RandomRays( -5.0, 5.0, baf::numberOfSamples );
+
+	int r = 0;
+	for( auto _ : state )
+	{
+		NormalVector normal = transform( NormalVector( rays[r].direction() ) );
+		benchmark::DoNotOptimize( normal );
+		r = ( r + 1 ) % baf::numberOfSamples;
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_TransformNormal );
+
+static void BM_TransformRay( benchmark::State& state )
+{
+	Transform transform = BenchmarkTransform();
+	std::vector< Ray > rays = baf::RandomRays( -5.0, 5.0, baf::numberOfSamples );
+
+	int r = 0;
+	for( auto _ : state )
+	{
+		Ray ray = transform( rays[r] );
+		benchmark::DoNotOptimize( ray );
+		r = ( r + 1 ) % baf::numberOfSamples;
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_TransformRay );
+
+static void BM_TransformBBox( benchmark::State& state )
+{
+	Transform transform = BenchmarkTransform();
+	BBox box( Point3D( -1.0, -2.0, -3.0 ), Point3D( 1.0, 2.0, 3.0 ) );
+
+	for( auto _ : state )
+	{
+		BBox transformedBox = transform( box );
+		benchmark::DoNotOptimize( transformedBox );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_TransformBBox );
+
+static void BM_TransformGetInverse( benchmark::State& state )
+{
+	Transform transform = BenchmarkTransform();
+
+	for( auto _ : state )
+	{
+		Transform inverse = transform.GetInverse();
+		benchmark::DoNotOptimize( inverse );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_TransformGetInverse );
+
+static void BM_TransformProduct( benchmark::State& state )
+{
+	Transform lhs = BenchmarkTransform();
+	Transform rhs = RotateY( 0.3 ) * Translate( 0.0, 4.0, 0.0 );
+
+	for( auto _ : state )
+	{
+		Transform product = lhs * rhs;
+		benchmark::DoNotOptimize( product );
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_TransformProduct );
+
+static void BM_Quadratic( benchmark::State& state )
+{
+	BenchmarkRandomDeviate rand;
+	std::vector< double > coefficients;
+	for( int c = 0; c < 3 * baf::numberOfSamples; ++c )
+		coefficients.push_back( baf::RandomNumber( rand, -10.0, 10.0 ) );
+
+	int s = 0;
+	int solutions = 0;
+	for( auto _ : state )
+	{
+		double t0, t1;
+		if( gf::Quadratic( coefficients[3*s], coefficients[3*s+1], coefficients[3*s+2], &t0, &t1 ) )	++solutions;
+		s = ( s + 1 ) % baf::numberOfSamples;
+	}
+	benchmark::DoNotOptimize( solutions );
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_Quadratic );
+
+static void BM_VectorNormalizeCrossProduct( benchmark::State& state )
+{
+	std::vector< Ray > rays = baf::RandomRays( -5.0, 5.0, baf::numberOfSamples );
+
+	int r = 0;
+	for( auto _ : state )
+	{
+		const Vector3D& a = rays[r].direction();
+		const Vector3D& b = rays[( r + 1 ) % baf::numberOfSamples].direction();
+		Vector3D v = Normalize( CrossProduct( a, b ) );
+		benchmark::DoNotOptimize( v );
+		r = ( r + 1 ) % baf::numberOfSamples;
+	}
+	state.SetItemsProcessed( state.iterations() );
+}
+BENCHMARK( BM_VectorNormalizeCrossProduct );
@@ -0,0 +1,187 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include <QVector>
+
+#include "BBox.h"
+#include "BenchmarksAuxiliaryFunctions.h"
+#include "DifferentialGeometry.h"
+#include "PluginBenchmarks.h"
+#include "PluginManager.h"
+#include "Ray.h"
+#include "ReferenceScenes.h"
+#include "TMaterial.h"
+#include "TMaterialFactory.h"
+#include "TShape.h"
+#include "TShapeFactory.h"
+#include "TSunShape.h"
+#include "TSunShapeFactory.h"
+
+/*!
+ * Measures the intersection of the rays aimed at the bounding box of the shape created by \a factory.
+ * The shape is created with \a parametersList if it is not empty, or with its default values otherwise.
+ * The fraction of rays that hit the shape is reported as "hit_ratio".
+ */
+static void BM_ShapeIntersect( benchmark::State& state, TShapeFactory* factory, QVector< QVariant > parametersList )
+{
+	TShape* shape = ( parametersList.size() > 0 ) ?
+			factory->CreateTShape( parametersList.size(), parametersList ) :
+			factory->CreateTShape();
+	if( !shape )
+	{
+		state.SkipWithError( "The shape cannot be created." );
+		return;
+	}
+	shape->ref();
+	std::vector< Ray > rays = baf::RaysToBox( shape->GetBBox(), baf::numberOfSamples );
+
+	int r = 0;
+	unsigned long hits = 0;
+	for( auto _ : state )
+	{
+		Ray ray = rays[r];
+		double thit = 0.0;
+		DifferentialGeometry dg;
+		if( shape->Intersect( ray, &thit, &dg ) )	++hits;
+		r = ( r + 1 ) % baf::numberOfSamples;
+	}
+
+	state.SetItemsProcessed( state.iterations() );
+	state.counters["hit_ratio"] = double( hits ) / state.iterations();
+	shape->unref();
+}
+
+/*!
+ * Measures the output ray of the default material created by \a factory for rays that hit a horizontal surface.
+ */
+static void BM_MaterialOutputRay( benchmark::State& state, TMaterialFactory* factory )
+{
+	TMaterial* material = factory->CreateTMaterial();
+	material->ref();
+
+	BenchmarkRandomDeviate rand;
+	std::vector< Ray > rays;
+	for( int r = 0; r < baf::numberOfSamples; ++r )
+	{
+		Vector3D direction( baf::RandomNumber( rand, -0.5, 0.5 ), -1.0, baf::RandomNumber( rand, -0.5, 0.5 ) );
+		rays.push_back( Ray( Point3D( 0.0, 1.0, 0.0 ), Normalize( direction ), gc::Epsilon, 1.0 ) );
+	}
+
+	DifferentialGeometry dg( Point3D( 0.0, 0.0, 0.0 ), Vector3D( 1.0, 0.0, 0.0 ), Vector3D( 0.0, 0.0, 1.0 ),
+			Vector3D( 0.0, 0.0, 0.0 ), Vector3D( 0.0, 0.0, 0.0 ), 0.5, 0.5, 0 );
+	dg.normal = NormalVector( 0.0, 1.0, 0.0 );
+	dg.shapeFrontSide = true;
+
+	int r = 0;
+	unsigned long outputRays = 0;
+	for( auto _ : state )
+	{
+		Ray outputRay;
+		if( material->OutputRay( rays[r], &dg, rand, &outputRay ) )	++outputRays;
+		r = ( r + 1 ) % baf::numberOfSamples;
+	}
+
+	state.SetItemsProcessed( state.iterations() );
+	state.counters["output_ratio"] = double( outputRays ) / state.iterations();
+	material->unref();
+}
+
+/*!
+ * Measures the generation of the sun ray directions of the default sunshape created by \a factory.
+ */
+static void BM_SunshapeGenerateRayDirection( benchmark::State& state, TSunShapeFactory* factory )
+{
+	TSunShape* sunshape = factory->CreateTSunShape();
+	sunshape->ref();
+
+	BenchmarkRandomDeviate rand;
+	for( auto _ : state )
+	{
+		Vector3D direction;
+		sunshape->GenerateRayDirection( direction, rand );
+		benchmark::DoNotOptimize( direction );
+	}
+
+	state.SetItemsProcessed( state.iterations() );
+	sunshape->unref();
+}
+
+/*!
+ * Registers a benchmark for the OutputRay of each material plugin loaded by \a pluginManager.
+ */
+void pbf::RegisterMaterialBenchmarks( const PluginManager& pluginManager )
+{
+	QVector< TMaterialFactory* > factoryList = pluginManager.GetMaterialFactories();
+	for( int m = 0; m < factoryList.size(); ++m )
+	{
+		QString name = QString( QLatin1String( "BM_MaterialOutputRay/%1" ) ).arg( factoryList[m]->TMaterialName() );
+		benchmark::RegisterBenchmark( name.toStdString().c_str(), BM_MaterialOutputRay, factoryList[m] );
+	}
+}
+
+/*!
+ * Registers a benchmark for the Intersect of each shape plugin loaded by \a pluginManager.
+ * The shapes defined from a file are created with the files of the \a referenceScenes.
+ */
+void pbf::RegisterShapeBenchmarks( const PluginManager& pluginManager, ReferenceScenes& referenceScenes )
+{
+	QVector< TShapeFactory* > factoryList = pluginManager.GetShapeFactories();
+	for( int s = 0; s < factoryList.size(); ++s )
+	{
+		QString name = QString( QLatin1String( "BM_ShapeIntersect/%1" ) ).arg( factoryList[s]->TShapeName() );
+		QVector< QVariant > parametersList = referenceScenes.GetShapeParameters( factoryList[s]->TShapeName() );
+		benchmark::RegisterBenchmark( name.toStdString().c_str(), BM_ShapeIntersect, factoryList[s], parametersList );
+	}
+}
+
+/*!
+ * Registers a benchmark for the GenerateRayDirection of each sunshape plugin loaded by \a pluginManager.
+ */
+void pbf::RegisterSunshapeBenchmarks( const PluginManager& pluginManager )
+{
+	QVector< TSunShapeFactory* > factoryList = pluginManager.GetSunShapeFactories();
+	for( int s = 0; s < factoryList.size(); ++s )
+	{
+		QString name = QString( QLatin1String( "BM_SunshapeGenerateRayDirection/%1" ) ).arg( factoryList[s]->TSunShapeName() );
+		benchmark::RegisterBenchmark( name.toStdString().c_str(), BM_SunshapeGenerateRayDirection, factoryList[s] );
+	}
+}
@@ -0,0 +1,694 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cmath>
+#include <vector>
+
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+
+#include <Inventor/actions/SoGetBoundingBoxAction.h>
+#include <Inventor/actions/SoSearchAction.h>
+#include <Inventor/fields/SoField.h>
+#include <Inventor/nodekits/SoNodeKitListPart.h>
+#include <Inventor/nodes/SoTransform.h>
+#include <Inventor/SbViewportRegion.h>
+
+#include "BBox.h"
+#include "Document.h"
+#include "gc.h"
+#include "PluginManager.h"
+#include "Point3D.h"
+#include "ReferenceScenes.h"
+#include "SceneModel.h"
+#include "TComponentFactory.h"
+#include "TLightKit.h"
+#include "TMaterial.h"
+#include "TMaterialFactory.h"
+#include "TSceneKit.h"
+#include "TSeparatorKit.h"
+#include "TShape.h"
+#include "TShapeFactory.h"
+#include "TShapeKit.h"
+#include "TSunShape.h"
+#include "TSunShapeFactory.h"
+#include "TTracker.h"
+#include "TTrackerFactory.h"
+#include "Vector3D.h"
+
+ReferenceScenes::ReferenceScenes( PluginManager* pPluginManager, QString workingDirectory )
+:m_pPluginManager( pPluginManager ),
+m_workingDirectory( workingDirectory ),
+m_errorMessage( QLatin1String( "" ) )
+{
+	QDir().mkpath( m_workingDirectory );
+}
+
+/*!
+ * Returns the description of the last error.
+ */
+QString ReferenceScenes::GetErrorMessage() const
+{
+	return m_errorMessage;
+}
+
+/*!
+ * Returns the name of the file where the \a scene model is saved.
+ */
+QString ReferenceScenes::GetSceneFileName( Scene scene ) const
+{
+	return QDir( m_workingDirectory ).absoluteFilePath( QString( QLatin1String( "%1.tnh" ) ).arg( GetSceneName( scene ) ) );
+}
+
+/*!
+ * Returns the name of the reference \a scene.
+ */
+QString ReferenceScenes::GetSceneName( Scene scene )
+{
+	switch( scene )
+	{
+		case CentralReceiver:
+			return QLatin1String( "CentralReceiver" );
+		case ParabolicTroughLoop:
+			return QLatin1String( "ParabolicTroughLoop" );
+		case LinearFresnel:
+			return QLatin1String( "LinearFresnel" );
+		case DishCADReceiver:
+			return QLatin1String( "DishCADReceiver" );
+		case BezierConcentrator:
+			return QLatin1String( "BezierConcentrator" );
+		default:
+			return QLatin1String( "" );
+	}
+}
+
+/*!
+ * Returns the parameters to create the \a shapeName shape without asking the user for an input file.
+ * The input files are written in the working directory the first time they are needed.
+ *
+ * Returns an empty list for the shapes that are created with their default values.
+ */
+QVector< QVariant > ReferenceScenes::GetShapeParameters( QString shapeName )
+{
+	QVector< QVariant > parametersList;
+	if( shapeName == QLatin1String( "CAD_Shape" ) )
+	{
+		QString fileName = QDir( m_workingDirectory ).absoluteFilePath( QLatin1String( "CADReceiver.stl" ) );
+		if( QFile::exists( fileName ) || WriteCADReceiverFile( fileName ) )	parametersList << fileName;
+	}
+	else if( shapeName == QLatin1String( "Bezier_Patch" ) )
+	{
+		QString fileName = QDir( m_workingDirectory ).absoluteFilePath( QLatin1String( "BezierConcentrator.txt" ) );
+		if( QFile::exists( fileName ) || WriteBezierPointsFile( fileName ) )	parametersList << fileName;
+	}
+	return parametersList;
+}
+
+/*!
+ * Builds the \a scene model and saves it into the file returned by GetSceneFileName.
+ *
+ * The model is defined as the main window does: the concentrator is inserted under the
+ * "RootNode" node, the trackers are connected to the sun light angles and the light is
+ * resized to cover the concentrator.
+ *
+ * Returns false if any of the plugins needed for the scene is not available.
+ */
+bool ReferenceScenes::WriteScene( Scene scene )
+{
+	TSeparatorKit* concentrator = 0;
+	QString sunshapeName = QLatin1String( "Pillbox_Sunshape" );
+	double azimuth = 180.0;
+	double elevation = 60.0;
+	switch( scene )
+	{
+		case CentralReceiver:
+			concentrator = CreateCentralReceiver();
+			sunshapeName = QLatin1String( "Buie_Sunshape" );
+			break;
+		case ParabolicTroughLoop:
+			concentrator = CreateParabolicTroughLoop();
+			break;
+		case LinearFresnel:
+			concentrator = CreateLinearFresnel();
+			break;
+		case DishCADReceiver:
+			concentrator = CreateDishCADReceiver();
+			elevation = 90.0;
+			break;
+		case BezierConcentrator:
+			concentrator = CreateBezierConcentrator();
+			elevation = 90.0;
+			break;
+		default:
+			m_errorMessage = QLatin1String( "Unknown reference scene." );
+			return false;
+	}
+	if( !concentrator )	return false;
+	concentrator->ref();
+
+	TSunShape* sunshape = CreateSunShape( sunshapeName );
+	if( !sunshape )
+	{
+		concentrator->unref();
+		return false;
+	}
+
+	Document document;
+	document.New();
+	TSceneKit* coinScene = document.GetSceneKit();
+
+	SceneModel sceneModel;
+	sceneModel.SetCoinScene( *coinScene );
+
+	TSeparatorKit* sunNode = static_cast< TSeparatorKit* >( coinScene->getPart( "childList[0]", false ) );
+	TSeparatorKit* rootNode = static_cast< TSeparatorKit* >( sunNode->getPart( "childList[0]", false ) );
+	AddChild( rootNode, concentrator );
+	concentrator->unref();
+
+	TLightKit* lightKit = new TLightKit;
+	lightKit->setName( "Light" );
+	lightKit->setPart( "tsunshape", sunshape );
+	lightKit->ChangePosition( azimuth * gc::Degree, ( 90 - elevation ) * gc::Degree );
+	coinScene->setPart( "lightList[0]", lightKit );
+
+	SoSearchAction trackersSearch;
+	trackersSearch.setType( TTracker::getClassTypeId() );
+	trackersSearch.setInterest( SoSearchAction::ALL );
+	trackersSearch.apply( coinScene );
+	SoPathList& trackersPath = trackersSearch.getPaths();
+	for( int index = 0; index < trackersPath.getLength(); ++index )
+	{
+		SoFullPath* trackerPath = static_cast< SoFullPath* > ( trackersPath[index] );
+		TTracker* tracker = static_cast< TTracker* >( trackerPath->getTail() );
+		tracker->SetAzimuthAngle( &lightKit->azimuth );
+		tracker->SetZenithAngle( &lightKit->zenith );
+	}
+
+	SoGetBoundingBoxAction* bbAction = new SoGetBoundingBoxAction( SbViewportRegion() );
+	sunNode->getBoundingBox( bbAction );
+	SbBox3f box = bbAction->getXfBoundingBox().project();
+	delete bbAction;
+	if( box.isEmpty() )
+	{
+		m_errorMessage = QString( QLatin1String( "The %1 scene is empty." ) ).arg( GetSceneName( scene ) );
+		return false;
+	}
+	lightKit->Update( BBox( Point3D( box.getMin()[0], box.getMin()[1], box.getMin()[2] ),
+			Point3D( box.getMax()[0], box.getMax()[1], box.getMax()[2] ) ) );
+
+	if( !document.WriteFile( GetSceneFileName( scene ) ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot write file %1." ) ).arg( GetSceneFileName( scene ) );
+		return false;
+	}
+	return true;
+}
+
+/*!
+ * Creates a concentrator of 7 x 7 Bezier patches that interpolates a paraboloid of 3 m focal length,
+ * with a flat receiver at the focal point.
+ */
+TSeparatorKit* ReferenceScenes::CreateBezierConcentrator()
+{
+	TShape* surfaceShape = CreateShape( QLatin1String( "Bezier_Patch" ) );
+	TMaterial* surfaceMaterial = CreateMaterial( 0.93, 1.5 );
+	TShape* receiverShape = CreateShape( QLatin1String( "Flat_Rectangle" ) );
+	if( !surfaceShape || !surfaceMaterial || !receiverShape )	return 0;
+	SetFieldValue( receiverShape, QLatin1String( "width" ), QLatin1String( "0.6" ) );
+	SetFieldValue( receiverShape, QLatin1String( "height" ), QLatin1String( "0.6" ) );
+
+	TSeparatorKit* concentrator = CreateSeparator( QLatin1String( "BezierConcentrator" ), 0 );
+	AddChild( concentrator, CreateSurface( QLatin1String( "Surface" ), surfaceShape, surfaceMaterial ) );
+
+	TSeparatorKit* receiver = CreateSeparator( QLatin1String( "Receiver" ), concentrator );
+	SoTransform* receiverTransform = static_cast< SoTransform* >( receiver->getPart( "transform", true ) );
+	receiverTransform->translation.setValue( 0.0, 3.0, 0.0 );
+	AddChild( receiver, CreateSurface( QLatin1String( "Receiver" ), receiverShape, 0 ) );
+
+	return concentrator;
+}
+
+/*!
+ * Creates a surrounding heliostat field of about 3000 heliostats of 9.75 x 9.75 m aimed at
+ * a cylindrical receiver of 8 m radius and 16 m height on top of a 92 m tower.
+ */
+TSeparatorKit* ReferenceScenes::CreateCentralReceiver()
+{
+	QVector< TComponentFactory* > componentFactoryList = m_pPluginManager->GetComponentFactories();
+	TComponentFactory* fieldFactory = 0;
+	for( int c = 0; c < componentFactoryList.size(); ++c )
+		if( componentFactoryList[c]->TComponentName() == QLatin1String( "Heliostat_Field_Component" ) )
+			fieldFactory = componentFactoryList[c];
+	if( !fieldFactory )
+	{
+		m_errorMessage = QLatin1String( "'Heliostat_Field_Component' plugin not found." );
+		return 0;
+	}
+
+	QString coordinatesFileName = QDir( m_workingDirectory ).absoluteFilePath( QLatin1String( "HeliostatCoordinates.txt" ) );
+	if( !WriteHeliostatCoordinatesFile( coordinatesFileName ) )	return 0;
+
+	TShape* receiverShape = CreateShape( QLatin1String( "Cylinder" ) );
+	if( !receiverShape )	return 0;
+	SetFieldValue( receiverShape, QLatin1String( "radius" ), QLatin1String( "8.0" ) );
+	SetFieldValue( receiverShape, QLatin1String( "length" ), QLatin1String( "16.0" ) );
+
+	QVector< QVariant > parametersList;
+	parametersList << coordinatesFileName
+			<< QString( QLatin1String( "" ) )
+			<< QString( QLatin1String( "Flat_Rectangle" ) )
+			<< 9.75 << 9.75 << -1.0
+			<< 0.88 << 2.9
+			<< 3 << QString( QLatin1String( "" ) ) << 100.0 << 8.0
+			<< 0.0 << 100.0 << 0.0;
+	TSeparatorKit* field = fieldFactory->CreateTComponent( m_pPluginManager, parametersList.size(), parametersList );
+	if( !field )
+	{
+		m_errorMessage = QLatin1String( "The heliostat field cannot be created." );
+		return 0;
+	}
+
+	TSeparatorKit* concentrator = CreateSeparator( QLatin1String( "CentralReceiver" ), 0 );
+	AddChild( concentrator, field );
+	field->unrefNoDelete();
+
+	TSeparatorKit* receiver = CreateSeparator( QLatin1String( "Receiver" ), concentrator );
+	SoTransform* receiverTransform = static_cast< SoTransform* >( receiver->getPart( "transform", true ) );
+	receiverTransform->translation.setValue( 0.0, 92.0, 0.0 );
+	receiverTransform->rotation.setValue( SbVec3f( 1.0, 0.0, 0.0 ), -gc::Pi / 2 );
+	AddChild( receiver, CreateSurface( QLatin1String( "Receiver" ), receiverShape, 0 ) );
+
+	return concentrator;
+}
+
+/*!
+ * Creates a parabolic dish of 4.5 m focal length and 8.5 m diameter with a cavity receiver
+ * defined as a CAD shape around the focal point.
+ */
+TSeparatorKit* ReferenceScenes::CreateDishCADReceiver()
+{
+	TShape* dishShape = CreateShape( QLatin1String( "Parabolic_dish" ) );
+	TMaterial* dishMaterial = CreateMaterial( 0.93, 1.5 );
+	TShape* receiverShape = CreateShape( QLatin1String( "CAD_Shape" ) );
+	if( !dishShape || !dishMaterial || !receiverShape )	return 0;
+	SetFieldValue( dishShape, QLatin1String( "focusLength" ), QLatin1String( "4.5" ) );
+	SetFieldValue( dishShape, QLatin1String( "dishMinRadius" ), QLatin1String( "0.3" ) );
+	SetFieldValue( dishShape, QLatin1String( "dishMaxRadius" ), QLatin1String( "4.25" ) );
+
+	TSeparatorKit* concentrator = CreateSeparator( QLatin1String( "DishCADReceiver" ), 0 );
+	AddChild( concentrator, CreateSurface( QLatin1String( "Dish" ), dishShape, dishMaterial ) );
+	AddChild( concentrator, CreateSurface( QLatin1String( "Receiver" ), receiverShape, 0 ) );
+
+	return concentrator;
+}
+
+/*!
+ * Creates a linear Fresnel collector of 16 tracking mirror rows of 0.75 m width and 48 m length
+ * with a tubular receiver 8 m above the field.
+ */
+TSeparatorKit* ReferenceScenes::CreateLinearFresnel()
+{
+	TShape* receiverShape = CreateShape( QLatin1String( "Cylinder" ) );
+	if( !receiverShape )	return 0;
+	SetFieldValue( receiverShape, QLatin1String( "radius" ), QLatin1String( "0.15" ) );
+	SetFieldValue( receiverShape, QLatin1String( "length" ), QLatin1String( "48.0" ) );
+
+	TSeparatorKit* concentrator = CreateSeparator( QLatin1String( "LinearFresnel" ), 0 );
+
+	int nRows = 16;
+	for( int row = 0; row < nRows; ++row )
+	{
+		TShape* mirrorShape = CreateShape( QLatin1String( "Flat_Rectangle" ) );
+		TMaterial* mirrorMaterial = CreateMaterial( 0.92, 2.0 );
+		TTracker* tracker = CreateTracker( QLatin1String( "Linear_Fresnel_tracker" ) );
+		if( !mirrorShape || !mirrorMaterial || !tracker )
+		{
+			concentrator->ref();
+			concentrator->unref();
+			return 0;
+		}
+		SetFieldValue( mirrorShape, QLatin1String( "width" ), QLatin1String( "48.0" ) );
+		SetFieldValue( mirrorShape, QLatin1String( "height" ), QLatin1String( "0.75" ) );
+		SetFieldValue( tracker, QLatin1String( "activeAxis" ), QLatin1String( "Z" ) );
+		SetFieldValue( tracker, QLatin1String( "axisOrigin" ), QLatin1String( "0 8" ) );
+
+		TSeparatorKit* mirror = CreateSeparator( QString( QLatin1String( "Mirror%1" ) ).arg( row ), concentrator );
+		SoTransform* mirrorTransform = static_cast< SoTransform* >( mirror->getPart( "transform", true ) );
+		mirrorTransform->translation.setValue( -7.5 + row * 1.0, 0.0, 0.0 );
+
+		TSeparatorKit* trackingNode = CreateSeparator( QLatin1String( "TrackingNode" ), mirror );
+		trackingNode->setPart( "tracker", tracker );
+		AddChild( trackingNode, CreateSurface( QLatin1String( "Mirror" ), mirrorShape, mirrorMaterial ) );
+	}
+
+	TSeparatorKit* receiver = CreateSeparator( QLatin1String( "Receiver" ), concentrator );
+	SoTransform* receiverTransform = static_cast< SoTransform* >( receiver->getPart( "transform", true ) );
+	receiverTransform->translation.setValue( 0.0, 8.0, -24.0 );
+	AddChild( receiver, CreateSurface( QLatin1String( "Receiver" ), receiverShape, 0 ) );
+
+	return concentrator;
+}
+
+/*!
+ * Creates a loop of 4 parabolic trough rows. Each row has 8 modules of 12 m length and 5.77 m aperture,
+ * with the absorber tube at the focal line, and tracks the sun with a one axis tracker.
+ */
+TSeparatorKit* ReferenceScenes::CreateParabolicTroughLoop()
+{
+	TSeparatorKit* concentrator = CreateSeparator( QLatin1String( "ParabolicTroughLoop" ), 0 );
+
+	int nRows = 4;
+	int nModules = 8;
+	for( int row = 0; row < nRows; ++row )
+	{
+		TTracker* tracker = CreateTracker( QLatin1String( "One Axis tracker" ) );
+		if( !tracker )
+		{
+			concentrator->ref();
+			concentrator->unref();
+			return 0;
+		}
+
+		TSeparatorKit* rowNode = CreateSeparator( QString( QLatin1String( "Row%1" ) ).arg( row ), concentrator );
+		SoTransform* rowTransform = static_cast< SoTransform* >( rowNode->getPart( "transform", true ) );
+		rowTransform->translation.setValue( 0.0, 0.0, row * 17.3 );
+
+		TSeparatorKit* trackingNode = CreateSeparator( QLatin1String( "TrackingNode" ), rowNode );
+		trackingNode->setPart( "tracker", tracker );
+
+		for( int module = 0; module < nModules; ++module )
+		{
+			TShape* parabolaShape = CreateShape( QLatin1String( "Trough_Parabola" ) );
+			TMaterial* parabolaMaterial = CreateMaterial( 0.94, 2.5 );
+			TShape* absorberShape = CreateShape( QLatin1String( "Cylinder" ) );
+			if( !parabolaShape || !parabolaMaterial || !absorberShape )
+			{
+				concentrator->ref();
+				concentrator->unref();
+				return 0;
+			}
+			SetFieldValue( parabolaShape, QLatin1String( "focusLength" ), QLatin1String( "1.71" ) );
+			SetFieldValue( parabolaShape, QLatin1String( "xMin" ), QLatin1String( "-2.885" ) );
+			SetFieldValue( parabolaShape, QLatin1String( "xMax" ), QLatin1String( "2.885" ) );
+			SetFieldValue( parabolaShape, QLatin1String( "lengthXMin" ), QLatin1String( "12.0" ) );
+			SetFieldValue( parabolaShape, QLatin1String( "lengthXMax" ), QLatin1String( "12.0" ) );
+			SetFieldValue( absorberShape, QLatin1String( "radius" ), QLatin1String( "0.035" ) );
+			SetFieldValue( absorberShape, QLatin1String( "length" ), QLatin1String( "12.0" ) );
+
+			TSeparatorKit* moduleNode = CreateSeparator( QString( QLatin1String( "Module%1" ) ).arg( module ), trackingNode );
+			SoTransform* moduleTransform = static_cast< SoTransform* >( moduleNode->getPart( "transform", true ) );
+			moduleTransform->translation.setValue( 0.0, 0.0, -48.0 + module * 12.0 );
+			AddChild( moduleNode, CreateSurface( QLatin1String( "Parabola" ), parabolaShape, parabolaMaterial ) );
+
+			TSeparatorKit* absorberNode = CreateSeparator( QLatin1String( "Absorber" ), moduleNode );
+			SoTransform* absorberTransform = static_cast< SoTransform* >( absorberNode->getPart( "transform", true ) );
+			absorberTransform->translation.setValue( 0.0, 1.71, 0.0 );
+			AddChild( absorberNode, CreateSurface( QLatin1String( "Absorber" ), absorberShape, 0 ) );
+		}
+	}
+
+	return concentrator;
+}
+
+/*!
+ * Creates a "Specular_Standard_Material" with \a reflectivity and normal slope error distribution
+ * of \a sigmaSlope mrad.
+ */
+TMaterial* ReferenceScenes::CreateMaterial( double reflectivity, double sigmaSlope )
+{
+	QVector< TMaterialFactory* > factoryList = m_pPluginManager->GetMaterialFactories();
+	for( int m = 0; m < factoryList.size(); ++m )
+	{
+		if( factoryList[m]->TMaterialName() == QLatin1String( "Specular_Standard_Material" ) )
+		{
+			TMaterial* material = factoryList[m]->CreateTMaterial();
+			SetFieldValue( material, QLatin1String( "m_reflectivity" ), QString::number( reflectivity ) );
+			SetFieldValue( material, QLatin1String( "m_sigmaSlope" ), QString::number( sigmaSlope ) );
+			SetFieldValue( material, QLatin1String( "m_distribution" ), QLatin1String( "NORMAL" ) );
+			return material;
+		}
+	}
+
+	m_errorMessage = QLatin1String( "'Specular_Standard_Material' plugin not found." );
+	return 0;
+}
+
+/*!
+ * Creates a \a shapeName shape. The shapes that are defined from a file are created with the files
+ * returned by GetShapeParameters.
+ */
+TShape* ReferenceScenes::CreateShape( QString shapeName )
+{
+	QVector< TShapeFactory* > factoryList = m_pPluginManager->GetShapeFactories();
+	for( int s = 0; s < factoryList.size(); ++s )
+	{
+		if( factoryList[s]->TShapeName() == shapeName )
+		{
+			QVector< QVariant > parametersList = GetShapeParameters( shapeName );
+			TShape* shape = ( parametersList.size() > 0 ) ?
+					factoryList[s]->CreateTShape( parametersList.size(), parametersList ) :
+					factoryList[s]->CreateTShape();
+			if( !shape )	m_errorMessage = QString( QLatin1String( "The '%1' shape cannot be created." ) ).arg( shapeName );
+			return shape;
+		}
+	}
+
+	m_errorMessage = QString( QLatin1String( "'%1' plugin not found." ) ).arg( shapeName );
+	return 0;
+}
+
+/*!
+ * Creates a surface node named \a name with \a shape and \a material. If \a material is null,
+ * the surface absorbs all the rays that hit it.
+ */
+TShapeKit* ReferenceScenes::CreateSurface( QString name, TShape* shape, TMaterial* material )
+{
+	TShapeKit* surface = new TShapeKit;
+	surface->setName( name.toStdString().c_str() );
+	surface->setPart( "shape", shape );
+	if( material )	surface->setPart( "material", material );
+	return surface;
+}
+
+/*!
+ * Creates a \a sunshapeName sunshape with its default parameters.
+ */
+TSunShape* ReferenceScenes::CreateSunShape( QString sunshapeName )
+{
+	QVector< TSunShapeFactory* > factoryList = m_pPluginManager->GetSunShapeFactories();
+	for( int s = 0; s < factoryList.size(); ++s )
+		if( factoryList[s]->TSunShapeName() == sunshapeName )	return factoryList[s]->CreateTSunShape();
+
+	m_errorMessage = QString( QLatin1String( "'%1' plugin not found." ) ).arg( sunshapeName );
+	return 0;
+}
+
+/*!
+ * Creates a \a trackerName tracker.
+ */
+TTracker* ReferenceScenes::CreateTracker( QString trackerName )
+{
+	QVector< TTrackerFactory* > factoryList = m_pPluginManager->GetTrackerFactories();
+	for( int t = 0; t < factoryList.size(); ++t )
+		if( factoryList[t]->TTrackerName() == trackerName )	return factoryList[t]->CreateTTracker();
+
+	m_errorMessage = QString( QLatin1String( "'%1' plugin not found." ) ).arg( trackerName );
+	return 0;
+}
+
+/*!
+ * Creates a group node named \a name and adds it to \a parent children if \a parent is not null.
+ */
+TSeparatorKit* ReferenceScenes::CreateSeparator( QString name, TSeparatorKit* parent )
+{
+	TSeparatorKit* separator = new TSeparatorKit;
+	separator->setName( name.toStdString().c_str() );
+	if( parent )	AddChild( parent, separator );
+	return separator;
+}
+
+/*!
+ * Adds \a child at the end of the \a parent children list.
+ */
+void ReferenceScenes::AddChild( TSeparatorKit* parent, SoNode* child )
+{
+	SoNodeKitListPart* childList = static_cast< SoNodeKitListPart* >( parent->getPart( "childList", true ) );
+	childList->addChild( child );
+}
+
+/*!
+ * Sets the \a fieldName field of \a node to \a value, as the scripts do.
+ *
+ * Returns false if the node has not a field with this name or the value is not valid.
+ */
+bool ReferenceScenes::SetFieldValue( SoNode* node, QString fieldName, QString value )
+{
+	SoField* field = node->getField( SbName( fieldName.toStdString().c_str() ) );
+	if( !field || !field->set( value.toStdString().c_str() ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot set '%1' to the '%2' field." ) ).arg( value, fieldName );
+		return false;
+	}
+	return true;
+}
+
+/*!
+ * Writes to \a fileName the points of a 7 x 7 grid over a paraboloid of 3 m focal length and 6 m side,
+ * in the format that reads the "Bezier_Patch" shape. Each line has the points of one curve.
+ */
+bool ReferenceScenes::WriteBezierPointsFile( QString fileName )
+{
+	QFile pointsFile( fileName );
+	if( !pointsFile.open( QIODevice::WriteOnly | QIODevice::Text ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot write file %1." ) ).arg( fileName );
+		return false;
+	}
+
+	QTextStream out( &pointsFile );
+	int nCurves = 7;
+	double focusLength = 3.0;
+	for( int i = 0; i < nCurves; ++i )
+	{
+		double x = -3.0 + i * 6.0 / ( nCurves - 1 );
+		for( int j = 0; j < nCurves; ++j )
+		{
+			double z = -3.0 + j * 6.0 / ( nCurves - 1 );
+			double y = ( x * x + z * z ) / ( 4 * focusLength );
+			if( j > 0 )	out << QLatin1String( ", " );
+			out << x << QLatin1String( " " ) << y << QLatin1String( " " ) << z;
+		}
+		out << QLatin1String( "\n" );
+	}
+
+	return true;
+}
+
+/*!
+ * Writes to \a fileName an ASCII STL cavity receiver: a faceted cylinder of 0.25 m radius and 0.4 m depth,
+ * closed at the top and open to the dish, placed at the focal point of the reference dish.
+ */
+bool ReferenceScenes::WriteCADReceiverFile( QString fileName )
+{
+	QFile stlFile( fileName );
+	if( !stlFile.open( QIODevice::WriteOnly | QIODevice::Text ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot write file %1." ) ).arg( fileName );
+		return false;
+	}
+
+	QTextStream out( &stlFile );
+	out.setRealNumberPrecision( 9 );
+	out << QLatin1String( "solid CADReceiver\n" );
+
+	int nSegments = 32;
+	int nRings = 8;
+	double radius = 0.25;
+	double yMin = 4.45;
+	double yMax = 4.85;
+	for( int s = 0; s < nSegments; ++s )
+	{
+		double phi0 = gc::TwoPi * s / nSegments;
+		double phi1 = gc::TwoPi * ( s + 1 ) / nSegments;
+		Point3D p0( radius * sin( phi0 ), 0.0, radius * cos( phi0 ) );
+		Point3D p1( radius * sin( phi1 ), 0.0, radius * cos( phi1 ) );
+
+		std::vector< Point3D > facets;
+		for( int r = 0; r < nRings; ++r )
+		{
+			double y0 = yMin + ( yMax - yMin ) * r / nRings;
+			double y1 = yMin + ( yMax - yMin ) * ( r + 1 ) / nRings;
+			facets.push_back( Point3D( p0.x, y0, p0.z ) );
+			facets.push_back( Point3D( p1.x, y0, p1.z ) );
+			facets.push_back( Point3D( p1.x, y1, p1.z ) );
+
+			facets.push_back( Point3D( p0.x, y0, p0.z ) );
+			facets.push_back( Point3D( p1.x, y1, p1.z ) );
+			facets.push_back( Point3D( p0.x, y1, p0.z ) );
+		}
+		facets.push_back( Point3D( 0.0, yMax, 0.0 ) );
+		facets.push_back( Point3D( p1.x, yMax, p1.z ) );
+		facets.push_back( Point3D( p0.x, yMax, p0.z ) );
+
+		for( unsigned int f = 0; f < facets.size(); f += 3 )
+		{
+			Vector3D normal = Normalize( CrossProduct( facets[f + 1] - facets[f], facets[f + 2] - facets[f] ) );
+			out << QLatin1String( "facet normal " ) << normal.x << QLatin1String( " " ) << normal.y << QLatin1String( " " ) << normal.z << QLatin1String( "\n" );
+			out << QLatin1String( "outer loop\n" );
+			for( int v = 0; v < 3; ++v )
+				out << QLatin1String( "vertex " ) << facets[f + v].x << QLatin1String( " " ) << facets[f + v].y << QLatin1String( " " ) << facets[f + v].z << QLatin1String( "\n" );
+			out << QLatin1String( "endloop\n" );
+			out << QLatin1String( "endfacet\n" );
+		}
+	}
+
+	out << QLatin1String( "endsolid CADReceiver\n" );
+	return true;
+}
+
+/*!
+ * Writes to \a fileName the coordinates of a radial staggered field of 28 rows, from 80 m to 404 m
+ * from the tower, with a circumferential spacing of 14 m between heliostats.
+ */
+bool ReferenceScenes::WriteHeliostatCoordinatesFile( QString fileName )
+{
+	QFile coordinatesFile( fileName );
+	if( !coordinatesFile.open( QIODevice::WriteOnly | QIODevice::Text ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot write file %1." ) ).arg( fileName );
+		return false;
+	}
+
+	QTextStream out( &coordinatesFile );
+	out.setRealNumberPrecision( 9 );
+	int nRows = 28;
+	for( int row = 0; row < nRows; ++row )
+	{
+		double radius = 80.0 + row * 12.0;
+		int nHeliostats = int( gc::TwoPi * radius / 14.0 );
+		double offset = ( row % 2 ) * 0.5;
+		for( int h = 0; h < nHeliostats; ++h )
+		{
+			double phi = gc::TwoPi * ( h + offset ) / nHeliostats;
+			out << radius * sin( phi ) << QLatin1String( "\t" ) << 5.0 << QLatin1String( "\t" ) << radius * cos( phi ) << QLatin1String( "\n" );
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,111 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef REFERENCESCENES_H_
+#define REFERENCESCENES_H_
+
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+class PluginManager;
+class SoNode;
+class TMaterial;
+class TSeparatorKit;
+class TShape;
+class TShapeKit;
+class TSunShape;
+class TTracker;
+
+//!  ReferenceScenes builds the canonical models used to validate the ray tracer performance.
+/*!
+  Each reference scene is generated with the shape, material, sunshape, tracker and component plugins,
+  so the models are always the same for a given set of plugins and they do not depend on files edited by hand.
+  The scenes are saved as Tonatiuh model files in the working directory, together with the
+  auxiliary files that some plugins need (heliostat coordinates, CAD receiver and Bezier surface points).
+*/
+
+class ReferenceScenes
+{
+
+public:
+	enum Scene
+	{
+		CentralReceiver = 0,
+		ParabolicTroughLoop = 1,
+		LinearFresnel = 2,
+		DishCADReceiver = 3,
+		BezierConcentrator = 4,
+		NumberOfScenes = 5
+	};
+
+	ReferenceScenes( PluginManager* pPluginManager, QString workingDirectory );
+
+	QString GetErrorMessage() const;
+	QString GetSceneFileName( Scene scene ) const;
+	static QString GetSceneName( Scene scene );
+	QVector< QVariant > GetShapeParameters( QString shapeName );
+
+	bool WriteScene( Scene scene );
+
+private:
+	TSeparatorKit* CreateBezierConcentrator();
+	TSeparatorKit* CreateCentralReceiver();
+	TSeparatorKit* CreateDishCADReceiver();
+	TSeparatorKit* CreateLinearFresnel();
+	TSeparatorKit* CreateParabolicTroughLoop();
+
+	TMaterial* CreateMaterial( double reflectivity, double sigmaSlope );
+	TShape* CreateShape( QString shapeName );
+	TShapeKit* CreateSurface( QString name, TShape* shape, TMaterial* material );
+	TSunShape* CreateSunShape( QString sunshapeName );
+	TTracker* CreateTracker( QString trackerName );
+	TSeparatorKit* CreateSeparator( QString name, TSeparatorKit* parent );
+	void AddChild( TSeparatorKit* parent, SoNode* child );
+	bool SetFieldValue( SoNode* node, QString fieldName, QString value );
+
+	bool WriteBezierPointsFile( QString fileName );
+	bool WriteCADReceiverFile( QString fileName );
+	bool WriteHeliostatCoordinatesFile( QString fileName );
+
+	PluginManager* m_pPluginManager;
+	QString m_workingDirectory;
+	QString m_errorMessage;
+};
+
+#endif /* REFERENCESCENES_H_ */
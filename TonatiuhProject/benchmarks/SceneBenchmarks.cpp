@@ -0,0 +1,178 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <QVector>
+
+#include "BenchmarkScene.h"
+#include "BenchmarksAuxiliaryFunctions.h"
+#include "PhotonMapExport.h"
+#include "PhotonMapExportFactory.h"
+#include "PluginManager.h"
+#include "ReferenceScenes.h"
+#include "SceneBenchmarks.h"
+#include "TPhotonMap.h"
+
+/*!
+ * Measures the whole ray tracing of the solar furnace test model, from the sun rays generation to the
+ * photons storage. The number of rays of each trace is the benchmark argument.
+ */
+static void BM_SolarFurnaceTrace( benchmark::State& state )
+{
+	QDir testDirectory( TEST_DIR );
+	BenchmarkScene scene;
+	if( !scene.Open( testDirectory.absoluteFilePath( QLatin1String( "SolarFurnace_normal.tnh" ) ) ) )
+	{
+		state.SkipWithError( scene.GetErrorMessage().toStdString().c_str() );
+		return;
+	}
+
+	BenchmarkRandomDeviate rand;
+	unsigned long numberOfRays = state.range( 0 );
+	unsigned long photons = 0;
+	for( auto _ : state )
+	{
+		scene.Trace( numberOfRays, rand );
+		photons += scene.GetStoredPhotons();
+	}
+
+	state.SetItemsProcessed( state.iterations() * numberOfRays );
+	state.counters["rays_per_second"] = benchmark::Counter( double( state.iterations() * numberOfRays ), benchmark::Counter::kIsRate );
+	state.counters["photons_per_ray"] = double( photons ) / ( state.iterations() * numberOfRays );
+}
+BENCHMARK( BM_SolarFurnaceTrace )->Arg( 100000 )->Arg( 1000000 )->Unit( benchmark::kMillisecond )->UseRealTime();
+
+/*!
+ * Traces baf::referenceNumberOfRays rays in the reference scene saved in \a fileName with the
+ * baf::referenceSeed seed, and exports the photons with \a exportFactory to \a exportDirectory.
+ *
+ * Before the measure, the scene is traced once with a single thread to compute the "checksum" label
+ * of the photon map, which is the same for every run while the traced physics do not change.
+ * The timed traces use all the threads of the pool, so their photons are not reproducible.
+ * If \a errorMessage is not empty, the scene could not be built and the benchmark is skipped.
+ */
+static void BM_ReferenceScene( benchmark::State& state, QString fileName, QString errorMessage,
+		PhotonMapExportFactory* exportFactory, QString exportDirectory )
+{
+	if( !errorMessage.isEmpty() )
+	{
+		state.SkipWithError( errorMessage.toStdString().c_str() );
+		return;
+	}
+
+	BenchmarkScene scene;
+	if( !scene.Open( fileName ) )
+	{
+		state.SkipWithError( scene.GetErrorMessage().toStdString().c_str() );
+		return;
+	}
+
+	unsigned long numberOfRays = state.range( 0 );
+
+	QThreadPool* threadPool = QThreadPool::globalInstance();
+	int maxThreadCount = threadPool->maxThreadCount();
+	threadPool->setMaxThreadCount( 1 );
+	BenchmarkRandomDeviate validationRand( baf::referenceSeed );
+	scene.Trace( numberOfRays, validationRand );
+	unsigned long long checksum = baf::PhotonsChecksum( scene.GetPhotonMap()->GetAllPhotons() );
+	unsigned long validationPhotons = scene.GetStoredPhotons();
+	threadPool->setMaxThreadCount( maxThreadCount );
+
+	unsigned long photons = 0;
+	for( auto _ : state )
+	{
+		BenchmarkRandomDeviate rand( baf::referenceSeed );
+		scene.Trace( numberOfRays, rand );
+		photons += scene.GetStoredPhotons();
+
+		if( exportFactory )
+		{
+			PhotonMapExport* pExportMode = exportFactory->GetExportPhotonMapMode();
+			pExportMode->SetSaveAllPhotonsEnabled();
+			pExportMode->SetSaveCoordinatesEnabled( true );
+			pExportMode->SetSaveSideEnabled( true );
+			pExportMode->SetSaveSurfacesIDEnabled( true );
+			pExportMode->SetSaveParameterValue( QLatin1String( "ExportDirectory" ), exportDirectory );
+			pExportMode->SetSaveParameterValue( QLatin1String( "ExportFile" ), QFileInfo( fileName ).baseName() );
+			pExportMode->SetSaveParameterValue( QLatin1String( "FileSize" ), QLatin1String( "-1" ) );
+			bool exported = scene.Export( pExportMode );
+			delete pExportMode;
+			if( !exported )
+			{
+				state.SkipWithError( scene.GetErrorMessage().toStdString().c_str() );
+				return;
+			}
+		}
+	}
+
+	state.SetItemsProcessed( state.iterations() * numberOfRays );
+	state.counters["rays_per_second"] = benchmark::Counter( double( state.iterations() * numberOfRays ), benchmark::Counter::kIsRate );
+	state.counters["photons_per_second"] = benchmark::Counter( double( photons ), benchmark::Counter::kIsRate );
+	state.counters["validation_photons"] = double( validationPhotons );
+	state.counters["peak_memory_mb"] = baf::PeakMemoryUsage() / ( 1024.0 * 1024.0 );
+	state.SetLabel( QString( QLatin1String( "checksum=%1" ) ).arg( checksum, 16, 16, QLatin1Char( '0' ) ).toStdString() );
+}
+
+/*!
+ * Writes the models of \a referenceScenes and registers a benchmark for each of them.
+ * The photons are exported with the "Binary_file" plugin of \a pluginManager, if it is loaded.
+ */
+void sbf::RegisterReferenceSceneBenchmarks( const PluginManager& pluginManager, ReferenceScenes& referenceScenes )
+{
+	PhotonMapExportFactory* exportFactory = 0;
+	QVector< PhotonMapExportFactory* > exportFactoryList = pluginManager.GetExportPMModeFactories();
+	for( int e = 0; e < exportFactoryList.size(); ++e )
+		if( exportFactoryList[e]->GetName() == QLatin1String( "Binary_file" ) )	exportFactory = exportFactoryList[e];
+
+	for( int s = 0; s < ReferenceScenes::NumberOfScenes; ++s )
+	{
+		ReferenceScenes::Scene scene = ReferenceScenes::Scene( s );
+		QString errorMessage = QLatin1String( "" );
+		if( !referenceScenes.WriteScene( scene ) )	errorMessage = referenceScenes.GetErrorMessage();
+
+		QString fileName = referenceScenes.GetSceneFileName( scene );
+		QString exportDirectory = QFileInfo( fileName ).absolutePath();
+		QString name = QString( QLatin1String( "BM_ReferenceScene/%1" ) ).arg( ReferenceScenes::GetSceneName( scene ) );
+		benchmark::RegisterBenchmark( name.toStdString().c_str(), BM_ReferenceScene, fileName, errorMessage, exportFactory, exportDirectory )
+				->Arg( baf::referenceNumberOfRays )->Unit( benchmark::kMillisecond )->UseRealTime();
+	}
+}
@@ -0,0 +1,118 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <QApplication>
+#include <QDir>
+
+#include <Inventor/Qt/SoQt.h>
+
+#include "PluginBenchmarks.h"
+#include "PluginManager.h"
+#include "ReferenceScenes.h"
+#include "SceneBenchmarks.h"
+#include "TCube.h"
+#include "TDefaultMaterial.h"
+#include "TDefaultSunShape.h"
+#include "TDefaultTracker.h"
+#include "TDefaultTransmissivity.h"
+#include "TLightKit.h"
+#include "TLightShape.h"
+#include "TSceneKit.h"
+#include "TSceneTracker.h"
+#include "TSeparatorKit.h"
+#include "TShapeKit.h"
+#include "TSquare.h"
+#include "TTrackerForAiming.h"
+#include "TTransmissivity.h"
+
+//!  Benchmarks entry point.
+/*!
+  Initializes Coin3D and the Tonatiuh nodes, loads the plugins from the "plugins" directory next to the
+  executable and registers a benchmark for each shape, material and sunshape plugin and for each
+  reference scene before running the benchmarks selected in the command line.
+  The reference scenes are written to the "TonatiuhReferenceScenes" directory of the system temporary path.
+
+  Use --benchmark_out=<file> --benchmark_out_format=json to save the results for trend tracking.
+*/
+
+int main( int argc, char** argv )
+{
+	QApplication a( argc, argv );
+
+	SoQt::init( (QWidget *) NULL );
+
+	TSceneKit::initClass();
+	TMaterial::initClass();
+	TDefaultMaterial::initClass();
+	TSeparatorKit::initClass();
+	TShape::initClass();
+	TCube::initClass();
+	TLightShape::initClass();
+	TShapeKit::initClass();
+	TSquare::initClass();
+	TLightKit::initClass();
+	TSunShape::initClass();
+	TDefaultSunShape::initClass();
+	TTracker::initClass();
+	TTrackerForAiming::initClass();
+	TDefaultTracker::initClass();
+	TSceneTracker::initClass();
+	TTransmissivity::initClass();
+	TDefaultTransmissivity::initClass();
+
+	QDir pluginsDirectory( qApp->applicationDirPath() );
+	pluginsDirectory.cd( "plugins" );
+	PluginManager pluginManager;
+	pluginManager.LoadAvailablePlugins( pluginsDirectory );
+
+	ReferenceScenes referenceScenes( &pluginManager, QDir::temp().absoluteFilePath( QLatin1String( "TonatiuhReferenceScenes" ) ) );
+
+	pbf::RegisterShapeBenchmarks( pluginManager, referenceScenes );
+	pbf::RegisterMaterialBenchmarks( pluginManager );
+	pbf::RegisterSunshapeBenchmarks( pluginManager );
+	sbf::RegisterReferenceSceneBenchmarks( pluginManager, referenceScenes );
+
+	benchmark::Initialize( &argc, argv );
+	if( benchmark::ReportUnrecognizedArguments( argc, argv ) )	return 1;
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	return 0;
+}
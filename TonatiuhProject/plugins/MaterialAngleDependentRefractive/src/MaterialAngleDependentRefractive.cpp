@@ -122,81 +122,47 @@ QString MaterialAngleDependentRefractive::getIcon()
 
 
 /*!
- * Linear interpolation of the vectors \a incidenceAnglesList and \a valuesList to obtaine the property value for the angle \a incidenceAngle.
- */
-//New function for interpolation reflectivity and transmissivity
-
-std::vector < double > MaterialAngleDependentRefractive::OutputPropertyValue (std::vector < double > incidenceAnglesList, std::vector < double > reflectivityValuesList, std::vector < double > transmissivityValuesList, double incidenceAngle) const
-{
-	int m = incidenceAnglesList.size();
-
-	std::vector < double > propValue;
-	propValue.push_back(0.0);
-	propValue.push_back(0.0);
-
-
-	if( incidenceAngle > 0.5* gc::Pi )	incidenceAngle = 0.5 * gc:: Pi;
-
-		for(  int i = 0;  i < m; i++ )
-		{
-			if( incidenceAnglesList[i] >= incidenceAngle )
-			{
-				double interpol = (incidenceAngle - incidenceAnglesList[i-1] ) /( incidenceAnglesList[i]  - incidenceAnglesList[i-1] );
-				propValue[0] = reflectivityValuesList[i-1] + interpol * ( reflectivityValuesList[i] - reflectivityValuesList[i-1] );
-				propValue[1] = transmissivityValuesList[i-1] + interpol * ( transmissivityValuesList[i] - transmissivityValuesList[i-1] );
-
-				break;
-			}
-		}
-		return ( propValue );
-}
-
-/*!
- * Updates the internal vectors of the front parameters  with the values in the inputs.
+ * Updates the front reflectivity and transmissivity tables with the values in the inputs.
  */
 void MaterialAngleDependentRefractive::updateOpticFront( void* data, SoSensor* )
 {
 	MaterialAngleDependentRefractive* material = static_cast< MaterialAngleDependentRefractive* >( data );
 
-	std::vector< double > oldFrontReflectivityIncidenceAngle = material->m_frontReflectivityIncidenceAngle;
-	std::vector< double > oldFrontReflectivityValue = material->m_frontReflectivityValue;
-	std::vector< double > oldFrontTransmissivityValue = material->m_frontTransmissivityValue;
-
-
 	int numberOfValues = material->frontOpticValues.getNum();
 
-	material->m_frontReflectivityIncidenceAngle.clear();
-	material->m_frontReflectivityValue.clear();
-	material->m_frontTransmissivityValue.clear();
+	std::vector< double > frontIncidenceAngle;
+	std::vector< double > frontReflectivityValue;
+	std::vector< double > frontTransmissivityValue;
 	for( int i = 0; i < numberOfValues; i++ )
 	{
-		material->m_frontReflectivityIncidenceAngle.push_back( material->frontOpticValues[i][0] );
-		material->m_frontReflectivityValue.push_back( material->frontOpticValues[i][1] );
-		material->m_frontTransmissivityValue.push_back( material->frontOpticValues[i][2] );
+		frontIncidenceAngle.push_back( material->frontOpticValues[i][0] );
+		frontReflectivityValue.push_back( material->frontOpticValues[i][1] );
+		frontTransmissivityValue.push_back( material->frontOpticValues[i][2] );
 	}
+	material->m_frontReflectivity.SetValues( frontIncidenceAngle, frontReflectivityValue );
+	material->m_frontTransmissivity.SetValues( frontIncidenceAngle, frontTransmissivityValue );
 }
 
 /*!
- * Updates the internal vectors of the back parameters  with the values in the inputs.
+ * Updates the back reflectivity and transmissivity tables with the values in the inputs.
  */
 void MaterialAngleDependentRefractive::updateOpticBack( void* data, SoSensor* )
 {
 	MaterialAngleDependentRefractive* material = static_cast< MaterialAngleDependentRefractive* >( data );
 
-
-	//std::vector< double > m_backReflectivityIncidenceAngle;
-	//std::vector< double > m_backReflectivityValue;
 	int numberOfValues = material->backOpticValues.getNum();
 
-	material->m_backReflectivityIncidenceAngle.clear();
-	material->m_backReflectivityValue.clear();
-	material->m_backTransmissivityValue.clear();
+	std::vector< double > backIncidenceAngle;
+	std::vector< double > backReflectivityValue;
+	std::vector< double > backTransmissivityValue;
 	for( int i = 0; i < numberOfValues; i++ )
 	{
-		material->m_backReflectivityIncidenceAngle.push_back( material->backOpticValues[i][0] );
-		material->m_backReflectivityValue.push_back( material->backOpticValues[i][1] );
-		material->m_backTransmissivityValue.push_back( material->backOpticValues[i][2] );
+		backIncidenceAngle.push_back( material->backOpticValues[i][0] );
+		backReflectivityValue.push_back( material->backOpticValues[i][1] );
+		backTransmissivityValue.push_back( material->backOpticValues[i][2] );
 	}
+	material->m_backReflectivity.SetValues( backIncidenceAngle, backReflectivityValue );
+	material->m_backTransmissivity.SetValues( backIncidenceAngle, backTransmissivityValue );
 }
 
 /*!
@@ -241,25 +207,21 @@ void MaterialAngleDependentRefractive::updateTransparency( void* data, SoSensor*
 
 bool MaterialAngleDependentRefractive::OutputRay( const Ray& incident, DifferentialGeometry* dg, RandomDeviate& rand, Ray* outputRay  ) const
 {
-	NormalVector dgNormal;
-	std::vector< double>  reflectivityTransmissivity;
+	double reflectivity = 0.0;
+	double transmissivity = 0.0;
 	if( dg->shapeFrontSide )
 	{
-
-		dgNormal = dg->normal;
-		double incidenceAngle = acos( DotProduct( -incident.direction(), dgNormal ) );
-		reflectivityTransmissivity = OutputPropertyValue( m_frontReflectivityIncidenceAngle,  m_frontReflectivityValue, m_frontTransmissivityValue, incidenceAngle );
+		double cosIncidence = DotProduct( -incident.direction(), dg->normal );
+		reflectivity = m_frontReflectivity.Value( cosIncidence );
+		transmissivity = m_frontTransmissivity.Value( cosIncidence );
 	}
 	else
 	{
-
-		dgNormal = - dg->normal;
-		double incidenceAngle = acos( DotProduct( -incident.direction(), dgNormal ) );
-		reflectivityTransmissivity = OutputPropertyValue( m_backReflectivityIncidenceAngle,  m_backReflectivityValue, m_backTransmissivityValue, incidenceAngle );
+		double cosIncidence = DotProduct( -incident.direction(), - dg->normal );
+		reflectivity = m_backReflectivity.Value( cosIncidence );
+		transmissivity = m_backTransmissivity.Value( cosIncidence );
 	}
 	double randomNumber = rand.RandomDouble();
-	double reflectivity = reflectivityTransmissivity[0];
-	double transmissivity = reflectivityTransmissivity[1];
 
 	if ( randomNumber < reflectivity )
 	{
@@ -289,33 +251,8 @@ Ray MaterialAngleDependentRefractive::ReflectedRay( const Ray& incident, Differe
 	double sSlope = sigmaSlope.getValue() / 1000;
 	if( sSlope > 0.0 )
 	{
-		NormalVector errorNormal;
-		if ( distribution.getValue() == 0 )
-		{
-			double phi = gc::TwoPi * rand.RandomDouble();
-			double theta = sSlope * rand.RandomDouble();
-
-			errorNormal.x = sin( theta ) * sin( phi ) ;
-			errorNormal.y = cos( theta );
-			errorNormal.z = sin( theta ) * cos( phi );
-		 }
-		 else if (distribution.getValue() == 1 )
-		 {
-			 errorNormal.x = sSlope * tgf::AlternateBoxMuller( rand );
-			 errorNormal.y = 1.0;
-			 errorNormal.z = sSlope * tgf::AlternateBoxMuller( rand );
-
-		 }
-		Vector3D r = dgNormal;
-		Vector3D s = Normalize( dg->dpdu );
-		Vector3D t = Normalize( dg->dpdv );
-		Transform trasform( s.x, s.y, s.z, 0.0,
-								r.x, r.y, r.z, 0.0,
-								t.x, t.y, t.z, 0.0,
-								0.0, 0.0, 0.0, 1.0);
-
-		NormalVector normalDirection = trasform.GetInverse()( errorNormal );
-		normalVector = Normalize( normalDirection );
+		NormalVector errorNormal = tgf::SlopeErrorNormal( sSlope, distribution.getValue(), rand );
+		normalVector = tgf::NormalFromLocalFrame( errorNormal, dgNormal, dg->dpdu, dg->dpdv );
 	}
 	else
 	{
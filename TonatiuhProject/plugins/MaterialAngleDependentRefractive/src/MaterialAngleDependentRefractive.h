@@ -17,6 +17,7 @@
 #include <Inventor/fields/SoSFString.h>
 #include <Inventor/sensors/SoFieldSensor.h>
 
+#include "IncidenceAngleTable.h"
 #include "TMaterial.h"
 #include "MFVec3.h"
 #include "trt.h"
@@ -62,8 +63,6 @@ public:
 protected:
    	virtual ~MaterialAngleDependentRefractive();
 
-	std::vector < double > OutputPropertyValue( std::vector < double > incidenceAnglesList, std::vector < double > reflectivityValuesList, std::vector < double > transmissivityValuesList, double incidenceAngle ) const;
-
    	static void updateOpticFront( void* data, SoSensor* );
    	static void updateOpticBack( void* data, SoSensor* );
 
@@ -89,12 +88,10 @@ private:
 	SoFieldSensor* m_shininessSensor;
 	SoFieldSensor* m_transparencySensor;
 
-	std::vector< double > m_frontReflectivityIncidenceAngle;
-	std::vector< double > m_frontReflectivityValue;
-	std::vector< double > m_frontTransmissivityValue;
-	std::vector< double > m_backReflectivityIncidenceAngle;
-	std::vector< double > m_backReflectivityValue;
-	std::vector< double > m_backTransmissivityValue;
+	IncidenceAngleTable m_frontReflectivity;
+	IncidenceAngleTable m_frontTransmissivity;
+	IncidenceAngleTable m_backReflectivity;
+	IncidenceAngleTable m_backTransmissivity;
 };
 
 
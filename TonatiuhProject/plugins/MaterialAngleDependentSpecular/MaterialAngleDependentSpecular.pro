@@ -12,6 +12,7 @@ INCLUDEPATH += . \
 # Input
 HEADERS = src/*.h \
             $$(TONATIUH_ROOT)/src/source/geometry/tgf.h \	
+			$$(TONATIUH_ROOT)/src/source/raytracing/IncidenceAngleTable.h \
 			$$(TONATIUH_ROOT)/src/source/raytracing/DifferentialGeometry.h \
 			$$(TONATIUH_ROOT)/src/source/raytracing/TMaterial.h \
 			$$(TONATIUH_ROOT)/src/source/raytracing/TShape.h  \
@@ -21,6 +22,7 @@ HEADERS = src/*.h \
 SOURCES = src/*.cpp \
             $$(TONATIUH_ROOT)/src/source/geometry/tgf.cpp \		
 			$$(TONATIUH_ROOT)/src/source/raytracing/DifferentialGeometry.cpp \
+			$$(TONATIUH_ROOT)/src/source/raytracing/IncidenceAngleTable.cpp \
 			$$(TONATIUH_ROOT)/src/source/raytracing/TMaterial.cpp \
 			$$(TONATIUH_ROOT)/src/source/raytracing/TShape.cpp  \
 			$$(TONATIUH_ROOT)/src/source/raytracing/TShapeKit.cpp 
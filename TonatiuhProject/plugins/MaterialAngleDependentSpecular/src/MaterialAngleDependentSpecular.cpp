@@ -119,92 +119,41 @@ QString MaterialAngleDependentSpecular::getIcon()
 
 
 /*!
- * Linear interpolation of the vectors \a incidenceAnglesList and \a valuesList to obtaine the property value for the angle \a incidenceAngle.
- */
-// New function OutputPropertyValue (JMQ)
-double MaterialAngleDependentSpecular::OutputPropertyValue( std::vector< double > incidenceAnglesList,  std::vector< double > valuesList, double incidenceAngle ) const
-{
-	// Size incidenceAnglesList vector
-	int m = incidenceAnglesList.size();
-
-	//Classify element's incident Angle lowest to biggest
-	for (int i = 0; i < (m - 1); i++)
-	{
-		for (int j = i + 1; j < m; j++)
-		{
-			if (incidenceAnglesList[j] < incidenceAnglesList[i])
-			{
-				double aux1 = incidenceAnglesList[j];
-				double aux2 = valuesList[j];
-				incidenceAnglesList[j] = incidenceAnglesList[i];
-				valuesList[j] = valuesList[i];
-				incidenceAnglesList[i] = aux1;
-				valuesList[i] = aux2;
-			}
-		}
-	}
-
-
-	//Incidence angle can not be higher than 0.5 * Pi
-	if( incidenceAngle > 0.5* gc::Pi )	incidenceAngle = 0.5 * gc:: Pi;
-
-	double propValue = 0.0;
-	for(  int i = 0;  i < m; i++ )
-	{
-		if( incidenceAnglesList[i] >= incidenceAngle )
-		{
-			double interpol = (incidenceAngle - incidenceAnglesList[i-1] ) /( incidenceAnglesList[i]  - incidenceAnglesList[i-1] );
-			propValue = valuesList[i-1] + interpol * ( valuesList[i] - valuesList[i-1] );
-			// Return reflectivity
-
-			break;
-		}
-	}
-	return ( propValue );
-
-}
-
-/*!
- * Updates the internal vectors of the front parameters  with the values in the inputs.
+ * Updates the front reflectivity table with the values in the inputs.
  */
 void MaterialAngleDependentSpecular::updateReflectivityFront( void* data, SoSensor* )
 {
 	MaterialAngleDependentSpecular* material = static_cast< MaterialAngleDependentSpecular* >( data );
 
-	std::vector< double > oldFrontReflectivityIncidenceAngle = material->m_frontReflectivityIncidenceAngle;
-	std::vector< double > oldFrontReflectivityValue = material->m_frontReflectivityValue;
-
-
 	int numberOfValues = material->reflectivityFrontValues.getNum();
 
-	material->m_frontReflectivityIncidenceAngle.clear();
-	material->m_frontReflectivityValue.clear();
+	std::vector< double > frontReflectivityIncidenceAngle;
+	std::vector< double > frontReflectivityValue;
 	for( int i = 0; i < numberOfValues; i++ )
 	{
-		material->m_frontReflectivityIncidenceAngle.push_back( material->reflectivityFrontValues[i][0] );
-		material->m_frontReflectivityValue.push_back( material->reflectivityFrontValues[i][1] );
+		frontReflectivityIncidenceAngle.push_back( material->reflectivityFrontValues[i][0] );
+		frontReflectivityValue.push_back( material->reflectivityFrontValues[i][1] );
 	}
+	material->m_frontReflectivity.SetValues( frontReflectivityIncidenceAngle, frontReflectivityValue );
 }
 
 /*!
- * Updates the internal vectors of the back parameters  with the values in the inputs.
+ * Updates the back reflectivity table with the values in the inputs.
  */
 void MaterialAngleDependentSpecular::updateReflectivityBack( void* data, SoSensor* )
 {
 	MaterialAngleDependentSpecular* material = static_cast< MaterialAngleDependentSpecular* >( data );
 
-
-	//std::vector< double > m_backReflectivityIncidenceAngle;
-	//std::vector< double > m_backReflectivityValue;
 	int numberOfValues = material->reflectivityBackValues.getNum();
 
-	material->m_backReflectivityIncidenceAngle.clear();
-	material->m_backReflectivityValue.clear();
+	std::vector< double > backReflectivityIncidenceAngle;
+	std::vector< double > backReflectivityValue;
 	for( int i = 0; i < numberOfValues; i++ )
 	{
-		material->m_backReflectivityIncidenceAngle.push_back( material->reflectivityBackValues[i][0] );
-		material->m_backReflectivityValue.push_back( material->reflectivityBackValues[i][1] );
+		backReflectivityIncidenceAngle.push_back( material->reflectivityBackValues[i][0] );
+		backReflectivityValue.push_back( material->reflectivityBackValues[i][1] );
 	}
+	material->m_backReflectivity.SetValues( backReflectivityIncidenceAngle, backReflectivityValue );
 }
 
 /*!
@@ -260,19 +209,14 @@ bool MaterialAngleDependentSpecular::OutputRay( const Ray& incident, Differentia
 	{
 		if( !reflectivityFront.getValue() )	return ( false );
 		dgNormal = dg->normal;
-
-		// Product
-		double incidenceAngle  = acos( DotProduct( -incident.direction(), dgNormal ) );
-		reflectivity = OutputPropertyValue( m_frontReflectivityIncidenceAngle,  m_frontReflectivityValue, incidenceAngle );
+		reflectivity = m_frontReflectivity.Value( DotProduct( -incident.direction(), dgNormal ) );
 	}
 	else
 	{
 		if( !reflectivityBack.getValue() )	return ( false );
 
 		dgNormal = - dg->normal;
-		double incidenceAngle  = acos( DotProduct( -incident.direction(), dgNormal) );
-		reflectivity = OutputPropertyValue( m_backReflectivityIncidenceAngle,  m_backReflectivityValue, incidenceAngle );
-
+		reflectivity = m_backReflectivity.Value( DotProduct( -incident.direction(), dgNormal ) );
 	}
 
 	double randomNumber = rand.RandomDouble();
@@ -287,33 +231,8 @@ bool MaterialAngleDependentSpecular::OutputRay( const Ray& incident, Differentia
 	double sSlope = sigmaSlope.getValue() / 1000;
 	if( sSlope > 0.0 )
 	{
-		NormalVector errorNormal;
-		if ( distribution.getValue() == 0 )
-		{
-			double phi = gc::TwoPi * rand.RandomDouble();
-			double theta = sSlope * rand.RandomDouble();
-
-			errorNormal.x = sin( theta ) * sin( phi ) ;
-			errorNormal.y = cos( theta );
-			errorNormal.z = sin( theta ) * cos( phi );
-		}
-		else if (distribution.getValue() == 1 )
-		{
-			errorNormal.x = sSlope * tgf::AlternateBoxMuller( rand );
-			errorNormal.y = 1.0;
-			errorNormal.z = sSlope * tgf::AlternateBoxMuller( rand );
-		}
-		Vector3D r = dgNormal;
-		Vector3D s = Normalize( dg->dpdu );
-		Vector3D t = Normalize( dg->dpdv );
-
-		Transform trasform( s.x, s.y, s.z, 0.0,
-				r.x, r.y, r.z, 0.0,
-				t.x, t.y, t.z, 0.0,
-				0.0, 0.0, 0.0, 1.0);
-
-		NormalVector normalDirection = trasform.GetInverse()( errorNormal );
-		normalVector = Normalize( normalDirection );
+		NormalVector errorNormal = tgf::SlopeErrorNormal( sSlope, distribution.getValue(), rand );
+		normalVector = tgf::NormalFromLocalFrame( errorNormal, dgNormal, dg->dpdu, dg->dpdv );
 	}
 	else
 	{
@@ -17,6 +17,7 @@
 #include <Inventor/fields/SoSFString.h>
 #include <Inventor/sensors/SoFieldSensor.h>
 
+#include "IncidenceAngleTable.h"
 #include "TMaterial.h"
 #include "MFVec2.h"
 #include "trt.h"
@@ -60,8 +61,6 @@ public:
 protected:
    	virtual ~MaterialAngleDependentSpecular();
 
-	double OutputPropertyValue( std::vector< double > anglesList,  std::vector< double > valuesList, double angle ) const;
-
    	static void updateReflectivityFront( void* data, SoSensor* );
    	static void updateReflectivityBack( void* data, SoSensor* );
 
@@ -84,10 +83,8 @@ private:
 	SoFieldSensor* m_shininessSensor;
 	SoFieldSensor* m_transparencySensor;
 
-	std::vector< double > m_frontReflectivityIncidenceAngle;
-	std::vector< double > m_frontReflectivityValue;
-	std::vector< double > m_backReflectivityIncidenceAngle;
-	std::vector< double > m_backReflectivityValue;
+	IncidenceAngleTable m_frontReflectivity;
+	IncidenceAngleTable m_backReflectivity;
 };
 
 
@@ -140,33 +140,8 @@ bool MaterialOneSideSpecular::OutputRay( const Ray& incident, DifferentialGeomet
 	double sSlope = sigmaSlope.getValue() / 1000;
 	if( sSlope > 0.0 )
 	{
-		NormalVector errorNormal;
-		if ( distribution.getValue() == 0 )
-		{
-			double phi = gc::TwoPi * rand.RandomDouble();
-			double theta = sSlope * rand.RandomDouble();
-
-			errorNormal.x = sin( theta ) * sin( phi ) ;
-			errorNormal.y = cos( theta );
-			errorNormal.z = sin( theta ) * cos( phi );
-		 }
-		 else if (distribution.getValue() == 1 )
-		 {
-			 errorNormal.x = sSlope * tgf::AlternateBoxMuller( rand );
-			 errorNormal.y = 1.0;
-			 errorNormal.z = sSlope * tgf::AlternateBoxMuller( rand );
-
-		 }
-		Vector3D r = dg->normal;
-		Vector3D s = Normalize( dg->dpdu );
-		Vector3D t = Normalize( dg->dpdv );
-		Transform trasform( s.x, s.y, s.z, 0.0,
-								r.x, r.y, r.z, 0.0,
-								t.x, t.y, t.z, 0.0,
-								0.0, 0.0, 0.0, 1.0);
-
-		NormalVector normalDirection = trasform.GetInverse()( errorNormal );
-		normalVector = Normalize( normalDirection );
+		NormalVector errorNormal = tgf::SlopeErrorNormal( sSlope, distribution.getValue(), rand );
+		normalVector = tgf::NormalFromLocalFrame( errorNormal, dg->normal, dg->dpdu, dg->dpdv );
 	}
 	else
 	{
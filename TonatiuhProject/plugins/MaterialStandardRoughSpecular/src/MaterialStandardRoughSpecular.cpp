@@ -166,16 +166,8 @@ bool MaterialStandardRoughSpecular::OutputRay( const Ray& incident, Differential
 	double sigmaNormal = sigmaSlope.getValue() / 1000;
 	if( sigmaNormal > 0.0 )
 	{
-		NormalVector errorNormal = Normalize( NormalVector( ComputeErrorVector( sigmaNormal, rand ) ) );
-		Vector3D r = dg->normal;
-		Vector3D s = Normalize( dg->dpdu );
-		Vector3D t = Normalize( dg->dpdv );
-		Transform trasform( s.x, s.y, s.z, 0.0,
-							r.x, r.y, r.z, 0.0,
-							t.x, t.y, t.z, 0.0,
-							0.0, 0.0, 0.0, 1.0);
-
-		normalVector = trasform.GetInverse()( errorNormal );
+		NormalVector errorNormal( ComputeErrorVector( sigmaNormal, rand ) );
+		normalVector = tgf::NormalFromLocalFrame( errorNormal, dg->normal, dg->dpdu, dg->dpdv );
 	}
 	else
 	{
@@ -195,15 +187,11 @@ bool MaterialStandardRoughSpecular::OutputRay( const Ray& incident, Differential
 	{
 		Vector3D errorReflectedRay = ComputeErrorVector( sigmaReflected, rand );
 
-		Vector3D r = outputRay->direction();
-		Vector3D s = Normalize( CrossProduct( outputRay->direction(), dg->normal ) );
-		Vector3D t = Normalize( CrossProduct( outputRay->direction(), s ) );
-		Transform trasform( s.x, s.y, s.z, 0.0,
-								r.x, r.y, r.z, 0.0,
-								t.x, t.y, t.z, 0.0,
-								0.0, 0.0, 0.0, 1.0);
+		NormalVector r( outputRay->direction() );
+		Vector3D s = CrossProduct( outputRay->direction(), dg->normal );
+		Vector3D t = CrossProduct( outputRay->direction(), s );
 
-		Vector3D errorReflectedRayDirection = trasform.GetInverse()( errorReflectedRay );
+		Vector3D errorReflectedRayDirection( tgf::NormalFromLocalFrame( NormalVector( errorReflectedRay ), r, s, t ) );
 		outputRay->setDirection( errorReflectedRayDirection );
 	}
 
@@ -224,9 +212,12 @@ Vector3D MaterialStandardRoughSpecular::ComputeErrorVector( double simgaError, R
 	 }
 	 else if( distribution.getValue() == 1 )
 	 {
-		 errorVector.x = simgaError * tgf::AlternateBoxMuller( rand );
+		 double x1;
+		 double x2;
+		 tgf::BoxMullerPair( rand, &x1, &x2 );
+		 errorVector.x = simgaError * x1;
 		 errorVector.y = 1.0;
-		 errorVector.z = simgaError * tgf::AlternateBoxMuller( rand );
+		 errorVector.z = simgaError * x2;
 
 	 }
 	return errorVector;
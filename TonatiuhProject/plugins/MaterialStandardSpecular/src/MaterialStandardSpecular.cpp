@@ -171,33 +171,8 @@ bool MaterialStandardSpecular::OutputRay( const Ray& incident, DifferentialGeome
 	double sigmaSlope = m_sigmaSlope.getValue() / 1000;
 	if( sigmaSlope > 0.0 )
 	{
-		NormalVector errorNormal;
-		if ( m_distribution.getValue() == 0 )
-		{
-			double phi = gc::TwoPi * rand.RandomDouble();
-			double theta = sigmaSlope * rand.RandomDouble();
-
-			errorNormal.x = sin( theta ) * sin( phi ) ;
-			errorNormal.y = cos( theta );
-			errorNormal.z = sin( theta ) * cos( phi );
-		 }
-		 else if (m_distribution.getValue() == 1 )
-		 {
-			 errorNormal.x = sigmaSlope * tgf::AlternateBoxMuller( rand );
-			 errorNormal.y = 1.0;
-			 errorNormal.z = sigmaSlope * tgf::AlternateBoxMuller( rand );
-
-		 }
-		Vector3D r = dg->normal;
-		Vector3D s = Normalize( dg->dpdu );
-		Vector3D t = Normalize( dg->dpdv );
-		Transform trasform( s.x, s.y, s.z, 0.0,
-								r.x, r.y, r.z, 0.0,
-								t.x, t.y, t.z, 0.0,
-								0.0, 0.0, 0.0, 1.0);
-
-		NormalVector normalDirection = trasform.GetInverse()( errorNormal );
-		normalVector = Normalize( normalDirection );
+		NormalVector errorNormal = tgf::SlopeErrorNormal( sigmaSlope, m_distribution.getValue(), rand );
+		normalVector = tgf::NormalFromLocalFrame( errorNormal, dg->normal, dg->dpdu, dg->dpdv );
 	}
 	else
 	{
@@ -113,6 +113,100 @@ void PhotonMapExportFile::EndExport()
 	out<<double( m_powerPerPhoton );
 }
 
+/*!
+ * Restores the exported photons, files and surface identifiers of the checkpoint \a state.
+ * The current data file is truncated to its size at the checkpoint and the later files are removed.
+ *
+ * Returns false if the surfaces of the \a state are not in the scene or the data file is shorter than at the checkpoint.
+ */
+bool PhotonMapExportFile::RestoreCheckpoint( const QByteArray& state )
+{
+	QDataStream in( state );
+
+	quint64 exportedPhotons = 0;
+	qint32 currentFile = 0;
+	double powerPerPhoton = 0.0;
+	quint64 dataFileSize = 0;
+	qint32 nSurfaces = 0;
+	in>>exportedPhotons>>currentFile>>powerPerPhoton>>dataFileSize>>nSurfaces;
+	if( in.status() != QDataStream::Ok || currentFile < 1 || nSurfaces < 0 )	return false;
+
+	if( nSurfaces > 0 && !m_pSceneModel )	return false;
+
+	QVector< InstanceNode* > surfaceIdentfier;
+	QVector< Transform > surfaceWorldToObject;
+	for( int s = 0; s < nSurfaces; ++s )
+	{
+		QString surfaceURL;
+		double worldToObject[4][4];
+		in>>surfaceURL;
+		for( int i = 0; i < 4; ++i )
+			for( int j = 0; j < 4; ++j )
+				in>>worldToObject[i][j];
+
+		QModelIndex surfaceIndex = m_pSceneModel->IndexFromNodeUrl( surfaceURL );
+		if( !surfaceIndex.isValid() )	return false;
+		surfaceIdentfier.push_back( m_pSceneModel->NodeFromIndex( surfaceIndex ) );
+		surfaceWorldToObject.push_back( Transform( worldToObject ) );
+	}
+	if( in.status() != QDataStream::Ok )	return false;
+
+	QFile dataFile( DataFileName( currentFile ) );
+	if( dataFileSize > 0 )
+	{
+		if( !dataFile.exists() || quint64( dataFile.size() ) < dataFileSize || !dataFile.resize( qint64( dataFileSize ) ) )
+			return false;
+	}
+	else if( dataFile.exists() && !dataFile.remove() )
+		return false;
+
+	if( !m_oneFile )
+	{
+		QDir exportDirectory( m_exportDirecotryName );
+		QStringList filters;
+		filters<<QString( QLatin1String( "%1_*.dat" ) ).arg( m_photonsFilename );
+		QFileInfoList partialFilesList = exportDirectory.entryInfoList( filters );
+		for( int i = 0; i < partialFilesList.count(); ++i )
+		{
+			QString fileNumber = partialFilesList[i].completeBaseName().mid( m_photonsFilename.length() + 1 );
+			bool isNumber = false;
+			int fileIndex = fileNumber.toInt( &isNumber );
+			if( isNumber && fileIndex > currentFile && !QFile::remove( partialFilesList[i].absoluteFilePath() ) )
+				return false;
+		}
+	}
+
+	m_exportedPhotons = exportedPhotons;
+	m_currentFile = currentFile;
+	m_powerPerPhoton = powerPerPhoton;
+	m_surfaceIdentfier = surfaceIdentfier;
+	m_surfaceWorldToObject = surfaceWorldToObject;
+	return true;
+}
+
+/*!
+ * Saves in \a state the number of exported photons, the current data file and its size and the surface identifiers.
+ */
+bool PhotonMapExportFile::SaveCheckpoint( QByteArray* state ) const
+{
+	QFileInfo dataFile( DataFileName( m_currentFile ) );
+
+	QDataStream out( state, QIODevice::WriteOnly );
+	out<<quint64( m_exportedPhotons )<<qint32( m_currentFile )<<m_powerPerPhoton
+		<<quint64( dataFile.exists() ? dataFile.size() : 0 )<<qint32( m_surfaceIdentfier.count() );
+
+	for( int s = 0; s < m_surfaceIdentfier.count(); ++s )
+	{
+		out<<m_surfaceIdentfier[s]->GetNodeURL();
+		Ptr< Matrix4x4 > worldToObject = m_surfaceWorldToObject[s].GetMatrix();
+		for( int i = 0; i < 4; ++i )
+			for( int j = 0; j < 4; ++j )
+				out<<worldToObject->m[i][j];
+	}
+
+	return ( out.status() == QDataStream::Ok );
+}
+
 /*!
  * Saves \a raysList photons to file.
  */
@@ -188,6 +282,19 @@ bool PhotonMapExportFile::StartExport()
 	return 1;
 }
 
+/*!
+ * Returns the name of the data file \a fileIndex. If all the photons are exported to one file, the index is not used.
+ */
+QString PhotonMapExportFile::DataFileName( int fileIndex ) const
+{
+	QDir exportDirectory( m_exportDirecotryName );
+	if( m_oneFile )
+		return exportDirectory.absoluteFilePath( QString( QLatin1String( "%1.dat" ) ).arg( m_photonsFilename ) );
+
+	return exportDirectory.absoluteFilePath( QString( QLatin1String( "%1_%2.dat" ) ).arg(
+			m_photonsFilename, QString::number( fileIndex ) ) );
+}
+
 /*!
  * Export \a a raysList all data to file \a filename.
  */
@@ -57,12 +57,15 @@ public:
 	static QStringList GetParameterNames();
 
 	void EndExport();
+	bool RestoreCheckpoint( const QByteArray& state );
+	bool SaveCheckpoint( QByteArray* state ) const;
 	void SavePhotonMap( std::vector< Photon* > raysLists );
 	void SetPowerPerPhoton( double wPhoton );
 	void SetSaveParameterValue( QString parameterName, QString parameterValue );
 	bool StartExport();
 
 private:
+	QString DataFileName( int fileIndex ) const;
 	void ExportAllPhotonsAllData( QString filename, std::vector< Photon* > raysLists );
 	void ExportAllPhotonsNotNextPrevID( QString filename, std::vector< Photon* > raysLists );
 	void ExportAllPhotonsSelectedData( QString filename, std::vector< Photon* > raysLists );
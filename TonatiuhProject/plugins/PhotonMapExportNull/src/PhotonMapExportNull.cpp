@@ -71,6 +71,22 @@ void PhotonMapExportNull::EndExport()
 
 }
 
+/*!
+ * Nothing is exported, so the export can always continue.
+ */
+bool PhotonMapExportNull::RestoreCheckpoint( const QByteArray& /*state*/ )
+{
+	return true;
+}
+
+/*!
+ * Nothing is exported, so the export can always continue.
+ */
+bool PhotonMapExportNull::SaveCheckpoint( QByteArray* /*state*/ ) const
+{
+	return true;
+}
+
 /*!
  * Nothing is done
  */
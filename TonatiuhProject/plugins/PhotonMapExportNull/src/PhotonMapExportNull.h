@@ -57,6 +57,8 @@ public:
 	static QStringList GetParameterNames();
 
 	void EndExport();
+	bool RestoreCheckpoint( const QByteArray& state );
+	bool SaveCheckpoint( QByteArray* state ) const;
 	void SavePhotonMap( std::vector< Photon* > raysLists );
 	void SetPowerPerPhoton( double wPhoton );
 	void SetSaveParameterValue( QString parameterName, QString parameterValue );
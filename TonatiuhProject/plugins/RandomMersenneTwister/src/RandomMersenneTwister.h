@@ -52,6 +52,7 @@ public:
     virtual ~RandomMersenneTwister( );
     void FillArray( double* array, const unsigned long arraySize );
     unsigned long RandomUInt();
+    bool SetSeed( unsigned long seed );
 
 private:
    enum { N = 624, M = 397 };
@@ -95,6 +96,13 @@ inline void RandomMersenneTwister::FillArray( double* array, const unsigned long
     for( unsigned int i = 0; i < arraySize; i++ ) array[i] = Random01( );
 }
 
+inline bool RandomMersenneTwister::SetSeed( unsigned long seed )
+{
+	Seed( seed );
+	ClearArray();
+	return true;
+}
+
 inline unsigned long RandomMersenneTwister::Twiddle( unsigned long u, unsigned long v )
 {
     return ( ( ( u & 0x80000000UL ) | ( v & 0x7FFFFFFFUL ) ) >> 1 )
@@ -0,0 +1,29 @@
+######################################################################
+# Automatically generated by qmake (2.01a) mi� 7. feb 13:18:07 2007
+######################################################################
+
+TEMPLATE      = lib
+CONFIG       += plugin debug_and_release
+
+include( ../../config.pri )
+
+INCLUDEPATH += . \
+			src \
+			$$(TONATIUH_ROOT)/src
+
+# Input
+HEADERS = src/*.h \
+			$$(TONATIUH_ROOT)/src/source/statistics/Philox.h
+
+SOURCES = src/*.cpp \
+			$$(TONATIUH_ROOT)/src/source/statistics/Philox.cpp
+
+TARGET        = RandomPhilox
+
+CONFIG(debug, debug|release) {
+	DESTDIR       = $$(TONATIUH_ROOT)/bin/debug/plugins/RandomPhilox	
+
+}
+else { 
+	DESTDIR       = $$(TONATIUH_ROOT)/bin/release/plugins/RandomPhilox
+}
@@ -0,0 +1,113 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <algorithm>
+
+#include "RandomPhilox.h"
+
+RandomPhilox::RandomPhilox( unsigned long seedValue, const unsigned long arraySize )
+:RandomDeviate( arraySize ),
+ m_philox( seedValue ),
+ m_nextGroup( 0 ),
+ m_groupPosition( Philox::GroupSize )
+{
+
+}
+
+RandomPhilox::~RandomPhilox()
+{
+
+}
+
+/*!
+ * Fills \a array with the next \a arraySize numbers of the substream. The complete groups are
+ * generated directly into the \a array, and the numbers of the last group that are not used are kept
+ * for the next call.
+ */
+void RandomPhilox::FillArray( double* array, const unsigned long arraySize )
+{
+	unsigned long filled = 0;
+	while( filled < arraySize && m_groupPosition < Philox::GroupSize )
+		array[filled++] = m_group[m_groupPosition++];
+
+	while( arraySize - filled >= Philox::GroupSize )
+	{
+		m_philox.GenerateGroup( m_nextGroup++, array + filled );
+		filled += Philox::GroupSize;
+	}
+
+	if( filled < arraySize )
+	{
+		m_philox.GenerateGroup( m_nextGroup++, m_group );
+		m_groupPosition = static_cast< int >( arraySize - filled );
+		std::copy( m_group, m_group + m_groupPosition, array + filled );
+	}
+}
+
+/*!
+ * Restarts the generator at the start of the first substream of the \a seed.
+ */
+bool RandomPhilox::SetSeed( unsigned long seed )
+{
+	m_philox.SetSeed( seed );
+	m_philox.SetStream( 0 );
+	return SetOffset( 0 );
+}
+
+/*!
+ * Moves the generator to the start of the \a substream.
+ */
+bool RandomPhilox::SetSubstream( unsigned long substream )
+{
+	m_philox.SetStream( substream );
+	return SetOffset( 0 );
+}
+
+/*!
+ * Moves the generator to the number \a offset of the current substream.
+ */
+bool RandomPhilox::SetOffset( quint64 offset )
+{
+	m_nextGroup = offset / Philox::GroupSize;
+	m_groupPosition = static_cast< int >( offset % Philox::GroupSize );
+	if( m_groupPosition > 0 )	m_philox.GenerateGroup( m_nextGroup++, m_group );
+	else	m_groupPosition = Philox::GroupSize;
+
+	ClearArray();
+	return true;
+}
@@ -0,0 +1,71 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef RANDOMPHILOX_H_
+#define RANDOMPHILOX_H_
+
+#include "Philox.h"
+#include "RandomDeviate.h"
+
+//!  RandomPhilox is a random generator based on the Philox4x32-10 counter based generator.
+/*!
+  The numbers are generated in groups of Philox::GroupSize numbers with SSE2 or AVX2 instructions. The seed is the
+  key of the generator and each substream is an independent stream of the same key. Any number of a substream is
+  computed without generating the previous ones, so the generator moves to any offset of any substream at once.
+*/
+
+class RandomPhilox : public RandomDeviate
+{
+
+public:
+	RandomPhilox( unsigned long seedValue = 5489UL, const unsigned long arraySize = 100000 );
+	~RandomPhilox();
+
+	void FillArray( double* array, const unsigned long arraySize );
+	bool SetSeed( unsigned long seed );
+	bool SetSubstream( unsigned long substream );
+	bool SetOffset( quint64 offset );
+
+private:
+	Philox m_philox;
+	quint64 m_nextGroup;
+	double m_group[Philox::GroupSize];
+	int m_groupPosition;
+};
+
+#endif /*RANDOMPHILOX_H_*/
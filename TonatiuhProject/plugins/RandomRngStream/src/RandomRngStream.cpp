@@ -260,6 +260,25 @@ namespace
 	    return 0;
 	}
 
+
+	//-------------------------------------------------------------------------
+	// Computes the six seed components from a single seed with the SplitMix64
+	// mixing function. Every component is in [1, m2 - 1], so any seed,
+	// including 0, gives a legal and well mixed state.
+	//
+	void MixSeed (unsigned long seed, unsigned long seedArray[6])
+	{
+	    unsigned long long state = seed;
+	    for (int i = 0; i < 6; ++i) {
+	        state += 0x9E3779B97F4A7C15ULL;
+	        unsigned long long z = state;
+	        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	        z = z ^ (z >> 31);
+	        seedArray[i] = (unsigned long) (1 + z % ((unsigned long long) m2 - 1));
+	    }
+	}
+
 } // end of anonymous namespace
 
 
@@ -358,7 +377,43 @@ RandomRngStream::~RandomRngStream()
 }
 
 /**
- * Reset Stream to beginning of Stream.
+ * Restarts the stream with a state computed from \a seed. Each component of the state is mixed from
+ * the seed, so different seeds give unrelated streams.
+ */
+bool RandomRngStream::SetSeed( unsigned long seed )
+{
+	unsigned long seedArray[6];
+	MixSeed( seed, seedArray );
+	if( !SetSeed( seedArray ) )	return false;
+
+	ClearArray();
+	return true;
+}
+
+/**
+ * Moves the stream to the start of its substream number \a substream.
+ * Substreams are 2^76 numbers long, so the jump is computed as A^(2^76 * substream).
+ */
+bool RandomRngStream::SetSubstream( unsigned long substream )
+{
+	double A1[3][3];
+	double A2[3][3];
+	MatPowModM( A1p76, A1, m1, substream );
+	MatPowModM( A2p76, A2, m2, substream );
+
+	for( int i = 0; i < 6; ++i )
+		m_bg[i] = m_ig[i];
+	MatVecModM( A1, m_bg, m_bg, m1 );
+	MatVecModM( A2, &m_bg[3], &m_bg[3], m2 );
+	for( int i = 0; i < 6; ++i )
+		m_cg[i] = m_bg[i];
+
+	ClearArray();
+	return true;
+}
+
+/**
+ * Reset Stream to beginning of Stream.
  */
 void RandomRngStream::ResetStartStream ()
 {
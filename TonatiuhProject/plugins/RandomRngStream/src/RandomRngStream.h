@@ -50,6 +50,8 @@ public:
 	RandomRngStream ( unsigned long seedValue = 5489UL, const unsigned long arraySize = 1000000 );
 	~RandomRngStream();
 	void FillArray( double* array, const unsigned long arraySize );
+	bool SetSeed( unsigned long seed );
+	bool SetSubstream( unsigned long substream );
 
 private:
 	static bool SetPackageSeed( const unsigned long seed[6] ) ;
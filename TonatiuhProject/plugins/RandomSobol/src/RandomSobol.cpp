@@ -0,0 +1,204 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include "RandomSobol.h"
+
+namespace
+{
+	const double UnsignedIntegerToDouble = 1.0 / 4294967296.0;
+}
+
+RandomSobol::RandomSobol( unsigned long seedValue, const unsigned long arraySize )
+:RandomDeviate( arraySize ),
+ m_seed( seedValue ),
+ m_scrambleSeed( 0 ),
+ m_streamIndex( 0 )
+{
+	ComputeDirections();
+	SetSeed( seedValue );
+	SetPathSampler( this );
+}
+
+RandomSobol::~RandomSobol()
+{
+
+}
+
+/*!
+ * Fills \a array with the next \a arraySize numbers of the hashed stream.
+ */
+void RandomSobol::FillArray( double* array, const unsigned long arraySize )
+{
+	for( unsigned long i = 0; i < arraySize; ++i, ++m_streamIndex )
+	{
+		unsigned int index = static_cast< unsigned int >( m_streamIndex & 0xFFFFFFFFUL );
+		unsigned int block = static_cast< unsigned int >( ( m_streamIndex >> 16 ) >> 16 );
+		unsigned int value = Hash( HashCombine( HashCombine( m_scrambleSeed, block ), index ) );
+		array[i] = ( value + 0.5 ) * UnsignedIntegerToDouble;
+	}
+}
+
+bool RandomSobol::IsPathSampler( ) const
+{
+	return true;
+}
+
+/*!
+ * Returns the scrambled Sobol number of the \a dimension of the \a path.
+ */
+double RandomSobol::PathSample( unsigned long path, unsigned int dimension ) const
+{
+	unsigned int group = dimension / GroupDimensions;
+	unsigned int groupSeed = HashCombine( m_scrambleSeed, group );
+
+	//The paths beyond the 32 bits index of the sequence use other shuffle seeds
+	unsigned int pathBlock = static_cast< unsigned int >( ( path >> 16 ) >> 16 );
+	if( pathBlock > 0 )	groupSeed = HashCombine( groupSeed, Hash( pathBlock ) );
+
+	unsigned int index = NestedUniformScramble( static_cast< unsigned int >( path & 0xFFFFFFFFUL ), groupSeed );
+	unsigned int value = Sobol( index, dimension % GroupDimensions );
+	value = NestedUniformScramble( value, HashCombine( groupSeed, dimension + 1 ) );
+	return ( value + 0.5 ) * UnsignedIntegerToDouble;
+}
+
+/*!
+ * Restarts the generator with a new scrambling for the \a seed.
+ */
+bool RandomSobol::SetSeed( unsigned long seed )
+{
+	m_seed = seed;
+	m_scrambleSeed = Hash( static_cast< unsigned int >( seed & 0xFFFFFFFFUL ) );
+	m_streamIndex = 0;
+	ClearArray();
+	ClearPaths();
+	return true;
+}
+
+/*!
+ * Restarts the generator with the scrambling of the \a substream of the seed, that is independent of the scrambling of the other substreams.
+ */
+bool RandomSobol::SetSubstream( unsigned long substream )
+{
+	m_scrambleSeed = HashCombine( Hash( static_cast< unsigned int >( m_seed & 0xFFFFFFFFUL ) ), Hash( static_cast< unsigned int >( substream & 0xFFFFFFFFUL ) + 1 ) );
+	m_streamIndex = 0;
+	ClearArray();
+	ClearPaths();
+	return true;
+}
+
+/*!
+ * Computes the direction numbers of the first four dimensions of the Sobol sequence.
+ * The primitive polynomials and initial numbers are the ones of Joe and Kuo.
+ */
+void RandomSobol::ComputeDirections()
+{
+	for( int bit = 0; bit < Bits; ++bit )
+		m_directions[0][bit] = 1U << ( Bits - 1 - bit );
+
+	const int degree[GroupDimensions] = { 0, 1, 2, 3 };
+	const unsigned int coefficients[GroupDimensions] = { 0, 0, 1, 1 };
+	const unsigned int initialNumbers[GroupDimensions][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 3, 0 }, { 1, 3, 1 } };
+
+	for( int d = 1; d < GroupDimensions; ++d )
+	{
+		int s = degree[d];
+		unsigned int* v = m_directions[d];
+		for( int bit = 0; bit < s; ++bit )
+			v[bit] = initialNumbers[d][bit] << ( Bits - 1 - bit );
+
+		for( int bit = s; bit < Bits; ++bit )
+		{
+			v[bit] = v[bit - s] ^ ( v[bit - s] >> s );
+			for( int k = 1; k < s; ++k )
+				if( ( coefficients[d] >> ( s - 1 - k ) ) & 1 )	v[bit] ^= v[bit - k];
+		}
+	}
+}
+
+/*!
+ * Returns the \a index number of the \a dimension of the Sobol sequence.
+ */
+unsigned int RandomSobol::Sobol( unsigned int index, unsigned int dimension ) const
+{
+	unsigned int value = 0;
+	for( int bit = 0; index != 0; ++bit, index >>= 1 )
+		if( index & 1 )	value ^= m_directions[dimension][bit];
+	return value;
+}
+
+unsigned int RandomSobol::Hash( unsigned int value )
+{
+	value ^= value >> 16;
+	value *= 0x7feb352dU;
+	value ^= value >> 15;
+	value *= 0x846ca68bU;
+	value ^= value >> 16;
+	return value;
+}
+
+unsigned int RandomSobol::HashCombine( unsigned int seed, unsigned int value )
+{
+	return seed ^ ( Hash( value ) + 0x9e3779b9U + ( seed << 6 ) + ( seed >> 2 ) );
+}
+
+/*!
+ * Returns the Owen scrambling of \a value for the \a seed. Each bit is flipped depending on the higher bits,
+ * so the numbers of each elementary interval are permuted inside the same interval.
+ */
+unsigned int RandomSobol::NestedUniformScramble( unsigned int value, unsigned int seed )
+{
+	value = ReverseBits( value );
+
+	//Laine-Karras permutation: each bit only depends on the lower bits
+	value += seed;
+	value ^= value * 0x6c50b47cU;
+	value ^= value * 0xb82f1e52U;
+	value ^= value * 0xc7afe638U;
+	value ^= value * 0x8d22f6e6U;
+
+	return ReverseBits( value );
+}
+
+unsigned int RandomSobol::ReverseBits( unsigned int value )
+{
+	value = ( ( value >> 1 ) & 0x55555555U ) | ( ( value & 0x55555555U ) << 1 );
+	value = ( ( value >> 2 ) & 0x33333333U ) | ( ( value & 0x33333333U ) << 2 );
+	value = ( ( value >> 4 ) & 0x0F0F0F0FU ) | ( ( value & 0x0F0F0F0FU ) << 4 );
+	value = ( ( value >> 8 ) & 0x00FF00FFU ) | ( ( value & 0x00FF00FFU ) << 8 );
+	return ( value >> 16 ) | ( value << 16 );
+}
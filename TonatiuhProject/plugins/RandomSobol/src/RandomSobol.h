@@ -0,0 +1,84 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef RANDOMSOBOL_H_
+#define RANDOMSOBOL_H_
+
+#include "RandomDeviate.h"
+
+//!  RandomSobol is an Owen scrambled Sobol sequence path sampler.
+/*!
+  The path dimensions are taken in groups of four. The four dimensions of each group are the first four dimensions
+  of the Sobol sequence, and the order of the paths is shuffled with a different seed for each group, so the groups
+  are independent. Each dimension is Owen scrambled with hash based nested uniform scrambling. The scrambling keeps
+  the stratification of the sequence, and each seed or substream is an independent randomization of the sequence.
+
+  When the numbers are not requested for a path, the generator provides a stream of hashed numbers.
+*/
+
+class RandomSobol : public RandomDeviate
+{
+
+public:
+	RandomSobol( unsigned long seedValue = 5489UL, const unsigned long arraySize = 100000 );
+	~RandomSobol();
+
+	void FillArray( double* array, const unsigned long arraySize );
+	bool IsPathSampler( ) const;
+	double PathSample( unsigned long path, unsigned int dimension ) const;
+	bool SetSeed( unsigned long seed );
+	bool SetSubstream( unsigned long substream );
+
+private:
+	enum { GroupDimensions = 4, Bits = 32 };
+
+	void ComputeDirections();
+	unsigned int Sobol( unsigned int index, unsigned int dimension ) const;
+
+	static unsigned int Hash( unsigned int value );
+	static unsigned int HashCombine( unsigned int seed, unsigned int value );
+	static unsigned int NestedUniformScramble( unsigned int value, unsigned int seed );
+	static unsigned int ReverseBits( unsigned int value );
+
+	unsigned int m_directions[GroupDimensions][Bits];
+	unsigned long m_seed;
+	unsigned int m_scrambleSeed;
+	unsigned long m_streamIndex;
+};
+
+#endif /*RANDOMSOBOL_H_*/
@@ -95,6 +95,30 @@ ShapeBezierSurface* ShapeBezierSurfaceFactory::CreateTShape( ) const
 	return 0;
 }
 
+/*!
+ * Creates a Bezier surface from the points data file given as the first parameter of \a parametersList.
+ * The file is not asked to the user, so the shape can be created from scripts and without graphic interface.
+ *
+ * Returns null if the parameters are not valid or the file cannot be read.
+ */
+ShapeBezierSurface* ShapeBezierSurfaceFactory::CreateTShape( int numberofParameters, QVector< QVariant > parametersList ) const
+{
+	if( numberofParameters != 1 )	return ( 0 );
+
+	QString fileName = parametersList[0].toString();
+	if( !IsValidInputDataFile( fileName ) )	return ( 0 );
+
+	std::vector< Point3D > pointsListData;
+	int nUCurves;
+	int nVCurves;
+	if( !ReadInputDataFile( fileName, &pointsListData, &nUCurves, &nVCurves ) )	return ( 0 );
+
+	ShapeBezierSurface* shape = new ShapeBezierSurface;
+	shape->DefineSurfacePatches( pointsListData, nUCurves, nVCurves );
+
+	return ( shape );
+}
+
 bool ShapeBezierSurfaceFactory::IsValidInputDataFile( QString fileName ) const
 {
 	if( fileName.isEmpty() )	return false;
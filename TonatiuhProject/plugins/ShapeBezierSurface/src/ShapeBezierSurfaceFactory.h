@@ -55,6 +55,7 @@ public:
    	QString TShapeName() const;
    	QIcon TShapeIcon() const;
    	ShapeBezierSurface* CreateTShape( ) const;
+   	ShapeBezierSurface* CreateTShape( int numberofParameters, QVector< QVariant > parametersList ) const;
    	bool IsFlat() { return false; }
 
 private:
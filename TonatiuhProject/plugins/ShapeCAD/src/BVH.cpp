@@ -39,7 +39,6 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 #include <algorithm>
 
 #include "BVH.h"
-#include "DifferentialGeometry.h"
 #include "gf.h"
 #include "Ray.h"
 
@@ -72,7 +71,7 @@ BVHNode::~BVHNode()
 
 
 /*!
- * Defines this node as leaf node.
+ * Defines this node as leaf node. For leaf nodes, \a index is the index of the node triangles packet.
  */
 void BVHNode::MakeLeaf(unsigned int index, unsigned int nTriangles )
 {
@@ -112,10 +111,11 @@ void BVHNode::SetBoundingBox( BBox bbox )
  * **************************** */
 
 /*!
- * Creates bounding volume hierarchy object
+ * Creates bounding volume hierarchy object. The leaves have at most \a leafSize triangles, that
+ * cannot be more than TrianglePacket::Size.
  */
 BVH::BVH( std::vector< Triangle*>* triangleList, int leafSize )
-:m_leafSize( leafSize ),
+:m_leafSize( std::max( 1, std::min( leafSize, int( TrianglePacket::Size ) ) ) ),
  m_nNodes ( 0 ),
  m_nLeafs( 0 ),
  m_rootNode( 0 ),
@@ -144,7 +144,12 @@ BBox BVH::GetBBox() const
 	return BBox();
 }
 
-bool BVH::Intersect(const Ray& objectRay , double* tHit, DifferentialGeometry* dg ) const
+/*!
+ * Computes to \a tHit the distance to the closest triangle intersected by \a objectRay and sets it to \a triangle.
+ * Only the intersection distances are computed, the caller computes the differential geometry of the closest triangle.
+ * The intersections farther than the input value of \a tHit are rejected.
+ */
+bool BVH::Intersect( const Ray& objectRay, double* tHit, const Triangle** triangle ) const
 {
 
 	if( ! m_rootNode )
@@ -153,8 +158,8 @@ bool BVH::Intersect(const Ray& objectRay , double* tHit, DifferentialGeometry* d
 	if( !m_rootNode->GetBoundingBox().IntersectP( objectRay ) )	return ( false );
 
 	double tHitBVH = objectRay.maxt;
-	if(!Intersect(m_rootNode, objectRay, &tHitBVH, dg ) )	return ( false );
-	if( tHitBVH < *tHit )
+	if(!Intersect(m_rootNode, objectRay, &tHitBVH, triangle ) )	return ( false );
+	if( tHitBVH <= *tHit )
 	{
 		*tHit = tHitBVH;
 		return ( true );
@@ -164,7 +169,7 @@ bool BVH::Intersect(const Ray& objectRay , double* tHit, DifferentialGeometry* d
 }
 
 
-bool BVH::Intersect(BVHNode* node, const Ray& objectRay, double *tHit, DifferentialGeometry *dg ) const
+bool BVH::Intersect( BVHNode* node, const Ray& objectRay, double* tHit, const Triangle** triangle ) const
 {
 
 	double tHitNode = *tHit;
@@ -210,14 +215,14 @@ bool BVH::Intersect(BVHNode* node, const Ray& objectRay, double *tHit, Different
 		if( firstNode )
 		{
 			double thit1 = tHitNode;
-			DifferentialGeometry dg1;
-			bool isIntersection1 = Intersect( firstNode, objectRay, &thit1, &dg1 );
+			const Triangle* triangle1 = 0;
+			bool isIntersection1 = Intersect( firstNode, objectRay, &thit1, &triangle1 );
 
-			if( isIntersection1 && thit1 < tHitNode )
+			if( isIntersection1 && thit1 <= tHitNode )
 			{
 				tHitNode = thit1;
 				*tHit = thit1;
-				*dg = dg1;
+				*triangle = triangle1;
 
 				isIntersection = true;
 
@@ -228,15 +233,15 @@ bool BVH::Intersect(BVHNode* node, const Ray& objectRay, double *tHit, Different
 		if( secondNode )
 		{
 			double thit2 = tHitNode;
-			DifferentialGeometry dg2;
+			const Triangle* triangle2 = 0;
 
-			bool isIntersection2 = Intersect( rightNode, objectRay, &thit2, &dg2 );
+			bool isIntersection2 = Intersect( rightNode, objectRay, &thit2, &triangle2 );
 
-			if( isIntersection2 && thit2 < tHitNode )
+			if( isIntersection2 && thit2 <= tHitNode )
 			{
 				tHitNode = thit2;
 				*tHit = thit2;
-				*dg = dg2;
+				*triangle = triangle2;
 				isIntersection = true;
 			}
 		}
@@ -246,29 +251,23 @@ bool BVH::Intersect(BVHNode* node, const Ray& objectRay, double *tHit, Different
 	else
 	{
 		bool isIntersection = false;
-		int left_index = node->GetIndex();
-		for( int f = 0; f < node->GetNumberOfTriangles(); f++ )
+		const TrianglePacket& packet = m_packets[node->GetIndex()];
+
+		//Only the candidates of the packet test are intersected in double precision
+		int candidates = packet.Intersect( objectRay, tHitNode );
+		for( int f = 0; candidates != 0; f++, candidates >>= 1 )
 		{
-			int tIndex = left_index + f;
-			Triangle* triangle = m_triangleList->at( tIndex );
+			Triangle* packetTriangle = packet.GetTriangle( f );
 
-			if( triangle )
+			if( ( candidates & 1 ) && packetTriangle )
 			{
-
-				Point3D v1 = triangle->GetVertex1();
-				Point3D v2 = triangle->GetVertex2();
-				Point3D v3 = triangle->GetVertex3();
-
 				double thitT = tHitNode;
-				DifferentialGeometry dgT;
-
-
-				bool isIntersectionT = triangle->Intersect( objectRay, &thitT, &dgT );
-				if( isIntersectionT && thitT < tHitNode )
+				bool isIntersectionT = packetTriangle->IntersectT( objectRay, &thitT );
+				if( isIntersectionT && thitT <= tHitNode )
 				{
 					tHitNode = thitT;
 					*tHit = thitT;
-					*dg = dgT;
+					*triangle = packetTriangle;
 					isIntersection = true;
 				}
 			}
@@ -280,11 +279,55 @@ bool BVH::Intersect(BVHNode* node, const Ray& objectRay, double *tHit, Different
 	return ( false );
 }
 
+/*!
+ * Returns true if \a objectRay intersects any triangle between the ray mint and maxt.
+ * The traversal finishes at the first intersected triangle.
+ */
+bool BVH::IntersectP( const Ray& objectRay ) const
+{
+	if( ! m_rootNode )
+		return ( false );
+
+	if( !m_rootNode->GetBoundingBox().IntersectP( objectRay ) )	return ( false );
+	return ( IntersectP( m_rootNode, objectRay ) );
+}
+
+bool BVH::IntersectP( BVHNode* node, const Ray& objectRay ) const
+{
+	if( !node->IsLeaf() )
+	{
+		BVHNode* leftNode = node->GetLeftNode();
+		if( leftNode && leftNode->GetBoundingBox().IntersectP( objectRay ) && IntersectP( leftNode, objectRay ) )
+			return ( true );
+
+		BVHNode* rightNode = node->GetRightNode();
+		if( rightNode && rightNode->GetBoundingBox().IntersectP( objectRay ) && IntersectP( rightNode, objectRay ) )
+			return ( true );
+
+		return ( false );
+	}
+
+	const TrianglePacket& packet = m_packets[node->GetIndex()];
+	int candidates = packet.Intersect( objectRay, objectRay.maxt );
+	for( int f = 0; candidates != 0; f++, candidates >>= 1 )
+	{
+		Triangle* packetTriangle = packet.GetTriangle( f );
+		if( ( candidates & 1 ) && packetTriangle )
+		{
+			double thitT = objectRay.maxt;
+			if( packetTriangle->IntersectT( objectRay, &thitT ) && thitT <= objectRay.maxt )	return ( true );
+		}
+	}
+
+	return ( false );
+}
+
 /*!
  * Creates the nodes hierarchy.
  */
 void BVH::Build()
 {
+	if( m_triangleList->size() < 1 )	return;
 
 	BBox hBBox;
 
@@ -314,7 +357,8 @@ void BVH::BuildRecursive(int left_index, int right_index, BVHNode* node, int dep
 
 	if( ( right_index - left_index ) <= m_leafSize )
 	{
-		node->MakeLeaf( left_index, right_index - left_index );
+		m_packets.push_back( TrianglePacket( &m_triangleList->at( left_index ), right_index - left_index ) );
+		node->MakeLeaf( m_packets.size() - 1, right_index - left_index );
 		m_nLeafs++;
 	}
 	else
@@ -46,8 +46,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 
 #include "BBox.h"
 #include "Triangle.h"
-
-class DifferentialGeometry;
+#include "TrianglePacket.h"
 
 /*! *****************************
  * class BVHNode
@@ -94,12 +93,14 @@ class BVH {
 
 public:
 
-	BVH( std::vector< Triangle*>* triangleList, int leafSize = 1 );
+	BVH( std::vector< Triangle*>* triangleList, int leafSize = TrianglePacket::Size );
 	~BVH();
 
 	BBox GetBBox() const;
-	bool Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg ) const;
-	bool Intersect(BVHNode* node, const Ray& objectRay, double *tHit, DifferentialGeometry *dg ) const;
+	bool Intersect( const Ray& objectRay, double* tHit, const Triangle** triangle ) const;
+	bool Intersect( BVHNode* node, const Ray& objectRay, double* tHit, const Triangle** triangle ) const;
+	bool IntersectP( const Ray& objectRay ) const;
+	bool IntersectP( BVHNode* node, const Ray& objectRay ) const;
 	//bool getIntersection( const Ray& ray, IntersectionInfo *intersection, bool occlusion) const;
 
 private:
@@ -120,6 +121,7 @@ private:
 
 	BVHNode* m_rootNode;
 	std::vector< Triangle*>* m_triangleList;
+	std::vector< TrianglePacket > m_packets;
 
 
 };
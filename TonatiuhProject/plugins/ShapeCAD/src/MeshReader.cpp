@@ -0,0 +1,618 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <ctype.h>
+#include <string.h>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <QtConcurrentMap>
+
+#include "MeshReader.h"
+#include "Vector3D.h"
+
+/*! *****************************
+ * class VertexIndexer
+ * **************************** */
+
+/*!
+ * Creates an indexer that adds the new vertices to the \a vertices list.
+ */
+VertexIndexer::VertexIndexer( std::vector< Point3D >* vertices )
+:m_vertices( vertices ),
+ m_mask( 0 )
+{
+	unsigned int tableSize = 1024;
+	while( tableSize < 2 * m_vertices->size() )	tableSize *= 2;
+	Resize( tableSize );
+}
+
+/*!
+ * Returns the index of \a point in the vertices list. The point is added to the list if it is not already there.
+ */
+int VertexIndexer::Index( const Point3D& point )
+{
+	unsigned int slot = Hash( point ) & m_mask;
+	while( m_table[slot] > -1 )
+	{
+		const Point3D& vertex = (*m_vertices)[m_table[slot]];
+		if( vertex.x == point.x && vertex.y == point.y && vertex.z == point.z )	return m_table[slot];
+		slot = ( slot + 1 ) & m_mask;
+	}
+
+	int index = int( m_vertices->size() );
+	m_vertices->push_back( point );
+	m_table[slot] = index;
+
+	if( 2 * m_vertices->size() > m_table.size() )	Resize( 2 * m_table.size() );
+	return index;
+}
+
+/*!
+ * Returns the FNV-1a hash of the coordinates of \a point.
+ */
+unsigned int VertexIndexer::Hash( const Point3D& point )
+{
+	//Adding 0.0 changes -0.0 to 0.0
+	double coordinates[3] = { point.x + 0.0, point.y + 0.0, point.z + 0.0 };
+	const unsigned char* bytes = reinterpret_cast< const unsigned char* >( coordinates );
+
+	unsigned int hash = 2166136261u;
+	for( unsigned int b = 0; b < sizeof( coordinates ); ++b )
+	{
+		hash ^= bytes[b];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/*!
+ * Changes the hash table size to \a tableSize, that must be a power of two, and adds again all the vertices.
+ */
+void VertexIndexer::Resize( unsigned int tableSize )
+{
+	m_table.assign( tableSize, -1 );
+	m_mask = tableSize - 1;
+
+	for( unsigned int v = 0; v < m_vertices->size(); ++v )
+	{
+		unsigned int slot = Hash( (*m_vertices)[v] ) & m_mask;
+		while( m_table[slot] > -1 )	slot = ( slot + 1 ) & m_mask;
+		m_table[slot] = v;
+	}
+}
+
+/*! *****************************
+ * class MeshReader
+ * **************************** */
+
+MeshReader::MeshReader()
+:m_errorMessage( QLatin1String( "" ) )
+{
+
+}
+
+MeshReader::~MeshReader()
+{
+
+}
+
+/*!
+ * Returns the description of the last error.
+ */
+QString MeshReader::GetErrorMessage() const
+{
+	return m_errorMessage;
+}
+
+/*!
+ * Returns the unit normal vector of each facet.
+ */
+const std::vector< NormalVector >& MeshReader::GetFacetNormals() const
+{
+	return m_facetNormals;
+}
+
+/*!
+ * Returns the indices of the three vertices of each facet.
+ */
+const std::vector< int >& MeshReader::GetFacetVertices() const
+{
+	return m_facetVertices;
+}
+
+/*!
+ * Returns the vertices of the mesh.
+ */
+const std::vector< Point3D >& MeshReader::GetVertices() const
+{
+	return m_vertices;
+}
+
+/*!
+ * Reads the facets of the STL or OBJ file \a fileName. The file is read as an OBJ file if its suffix is "obj".
+ * The STL files can be binary or ASCII files.
+ *
+ * Returns false if the file cannot be read or it does not define any facet.
+ */
+bool MeshReader::Read( QString fileName )
+{
+	m_facetNormals.clear();
+	m_facetVertices.clear();
+	m_vertices.clear();
+
+	QFile meshFile( fileName );
+	if( !meshFile.open( QIODevice::ReadOnly ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot open file %1." ) ).arg( fileName );
+		return false;
+	}
+
+	qint64 size = meshFile.size();
+	uchar* mappedFile = ( size > 0 ) ? meshFile.map( 0, size ) : 0;
+	if( !mappedFile )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot read file %1." ) ).arg( fileName );
+		return false;
+	}
+	const char* data = reinterpret_cast< const char* >( mappedFile );
+
+	bool isRead = false;
+	if( QFileInfo( fileName ).suffix().toLower() == QLatin1String( "obj" ) )
+		isRead = ReadTextFile( data, size, true );
+	else
+	{
+		const char* position = data;
+		while( position < data + size && isspace( (unsigned char) *position ) )	++position;
+		bool isASCII = IsKeyword( position, data + size, "solid" );
+
+		//A binary file size is defined by the number of facets. Some binary files headers also start with "solid".
+		bool isBinary = false;
+		if( size >= 84 )
+		{
+			quint32 nFacets = 0;
+			memcpy( &nFacets, data + 80, 4 );
+			qint64 binarySize = 84 + 50 * qint64( nFacets );
+			isBinary = ( binarySize == size ) || ( !isASCII && binarySize < size );
+		}
+
+		if( isBinary )	isRead = ReadBinarySTL( data, size );
+		else if( isASCII )	isRead = ReadTextFile( data, size, false );
+		else	m_errorMessage = QString( QLatin1String( "The file %1 is not a valid STL file." ) ).arg( fileName );
+	}
+
+	meshFile.unmap( mappedFile );
+	meshFile.close();
+
+	if( isRead && m_facetNormals.size() < 1 )
+	{
+		m_errorMessage = QString( QLatin1String( "The file %1 does not define any facet." ) ).arg( fileName );
+		isRead = false;
+	}
+	return isRead;
+}
+
+/*!
+ * Adds the facet with vertices \a v1, \a v2 and \a v3. If \a normal is a null vector, the facet normal is computed
+ * from its vertices.
+ */
+void MeshReader::AddFacet( int v1, int v2, int v3, NormalVector normal )
+{
+	m_facetVertices.push_back( v1 );
+	m_facetVertices.push_back( v2 );
+	m_facetVertices.push_back( v3 );
+
+	if( normal.lengthSquared() == 0.0 )
+	{
+		Vector3D facetNormal = CrossProduct( m_vertices[v2] - m_vertices[v1], m_vertices[v3] - m_vertices[v1] );
+		if( facetNormal.lengthSquared() > 0.0 )	normal = NormalVector( Normalize( facetNormal ) );
+	}
+	m_facetNormals.push_back( normal );
+}
+
+/*!
+ * Reads the facets of the binary STL file mapped in \a data with \a size bytes.
+ */
+bool MeshReader::ReadBinarySTL( const char* data, qint64 size )
+{
+	quint32 nFacets = 0;
+	memcpy( &nFacets, data + 80, 4 );
+	if( 84 + 50 * qint64( nFacets ) > size )
+	{
+		m_errorMessage = QLatin1String( "The binary STL file is truncated." );
+		return false;
+	}
+
+	m_facetNormals.reserve( nFacets );
+	m_facetVertices.reserve( 3 * nFacets );
+	VertexIndexer vertexIndexer( &m_vertices );
+
+	//Each facet stores the normal and vertices coordinates as floats and an attribute byte count
+	const char* facet = data + 84;
+	for( quint32 f = 0; f < nFacets; ++f )
+	{
+		float values[12];
+		memcpy( values, facet, sizeof( values ) );
+		facet += 50;
+
+		int v1 = vertexIndexer.Index( Point3D( values[3], values[4], values[5] ) );
+		int v2 = vertexIndexer.Index( Point3D( values[6], values[7], values[8] ) );
+		int v3 = vertexIndexer.Index( Point3D( values[9], values[10], values[11] ) );
+		AddFacet( v1, v2, v3, NormalVector( values[0], values[1], values[2] ) );
+	}
+
+	return true;
+}
+
+/*!
+ * Reads the facets of the ASCII STL file, or the OBJ file if \a isOBJ is true, mapped in \a data with \a size bytes.
+ * The file is parsed in parallel chunks.
+ */
+bool MeshReader::ReadTextFile( const char* data, qint64 size, bool isOBJ )
+{
+	QVector< MeshChunk > chunks = SplitChunks( data, size, isOBJ );
+	if( isOBJ )	QtConcurrent::blockingMap( chunks, ParseOBJChunk );
+	else	QtConcurrent::blockingMap( chunks, ParseSTLChunk );
+
+	unsigned long nFacets = 0;
+	for( int c = 0; c < chunks.count(); ++c )
+	{
+		if( !chunks[c].isValid )
+		{
+			m_errorMessage = isOBJ ? QLatin1String( "The OBJ file format is not valid." ) :
+					QLatin1String( "The ASCII STL file format is not valid." );
+			return false;
+		}
+		nFacets += isOBJ ? chunks[c].faces.size() / 3 : chunks[c].normals.size() / 3;
+	}
+
+	m_facetNormals.reserve( nFacets );
+	m_facetVertices.reserve( 3 * nFacets );
+	VertexIndexer vertexIndexer( &m_vertices );
+
+	if( !isOBJ )
+	{
+		for( int c = 0; c < chunks.count(); ++c )
+		{
+			const std::vector< float >& coordinates = chunks[c].coordinates;
+			const std::vector< float >& normals = chunks[c].normals;
+			for( unsigned int f = 0; f < normals.size() / 3; ++f )
+			{
+				const float* v = &coordinates[9 * f];
+				int v1 = vertexIndexer.Index( Point3D( v[0], v[1], v[2] ) );
+				int v2 = vertexIndexer.Index( Point3D( v[3], v[4], v[5] ) );
+				int v3 = vertexIndexer.Index( Point3D( v[6], v[7], v[8] ) );
+				AddFacet( v1, v2, v3, NormalVector( normals[3 * f], normals[3 * f + 1], normals[3 * f + 2] ) );
+			}
+		}
+		return true;
+	}
+
+	//The OBJ faces refer to the vertices in the file order, or relative to the last vertex for negative indices
+	std::vector< int > vertexIndex;
+	std::vector< int > chunkFirstVertex( chunks.count(), 0 );
+	for( int c = 0; c < chunks.count(); ++c )
+	{
+		chunkFirstVertex[c] = int( vertexIndex.size() );
+		const std::vector< float >& coordinates = chunks[c].coordinates;
+		for( unsigned int v = 0; v < coordinates.size(); v += 3 )
+			vertexIndex.push_back( vertexIndexer.Index( Point3D( coordinates[v], coordinates[v + 1], coordinates[v + 2] ) ) );
+	}
+
+	int nVertices = int( vertexIndex.size() );
+	for( int c = 0; c < chunks.count(); ++c )
+	{
+		const std::vector< int >& faces = chunks[c].faces;
+		for( unsigned int f = 0; f < faces.size(); f += 3 )
+		{
+			int v[3];
+			for( int i = 0; i < 3; ++i )
+			{
+				v[i] = chunks[c].isRelativeFace[f + i] ? chunkFirstVertex[c] + faces[f + i] : faces[f + i];
+				if( v[i] < 0 || v[i] >= nVertices )
+				{
+					m_errorMessage = QLatin1String( "The OBJ file has faces with undefined vertices." );
+					return false;
+				}
+			}
+			AddFacet( vertexIndex[v[0]], vertexIndex[v[1]], vertexIndex[v[2]], NormalVector() );
+		}
+	}
+
+	return true;
+}
+
+/*!
+ * Splits the \a size bytes of \a data into chunks to be parsed in parallel. The ASCII STL chunks end after
+ * a facet and the OBJ chunks end after a line.
+ */
+QVector< MeshReader::MeshChunk > MeshReader::SplitChunks( const char* data, qint64 size, bool isOBJ ) const
+{
+	const qint64 minimumChunkSize = 1048576;
+	qint64 nChunks = std::max( 1, 4 * QThread::idealThreadCount() );
+	if( size / nChunks < minimumChunkSize )	nChunks = std::max( qint64( 1 ), size / minimumChunkSize );
+
+	const char* end = data + size;
+	const char* endFacet = "endfacet";
+	QVector< MeshChunk > chunks;
+	const char* begin = data;
+	for( qint64 c = 1; c <= nChunks && begin < end; ++c )
+	{
+		const char* chunkEnd = end;
+		if( c < nChunks )
+		{
+			chunkEnd = std::max( begin, data + c * ( size / nChunks ) );
+			if( !isOBJ )	chunkEnd = std::search( chunkEnd, end, endFacet, endFacet + 8 );
+			chunkEnd = FindLineEnd( chunkEnd, end );
+		}
+
+		MeshChunk chunk;
+		chunk.begin = begin;
+		chunk.end = chunkEnd;
+		chunk.isValid = true;
+		chunks.push_back( chunk );
+		begin = chunkEnd;
+	}
+
+	return chunks;
+}
+
+/*!
+ * Returns the position after the end of the line at \a position, or \a end.
+ */
+const char* MeshReader::FindLineEnd( const char* position, const char* end )
+{
+	const char* lineEnd = static_cast< const char* >( memchr( position, '\n', end - position ) );
+	return lineEnd ? lineEnd + 1 : end;
+}
+
+/*!
+ * Returns true if the text at \a position is the \a keyword followed by a white space.
+ */
+bool MeshReader::IsKeyword( const char* position, const char* end, const char* keyword )
+{
+	int length = int( strlen( keyword ) );
+	if( end - position <= length )	return false;
+	return ( strncmp( position, keyword, length ) == 0 ) && isspace( (unsigned char) position[length] );
+}
+
+/*!
+ * Reads the vertices and faces of an OBJ file \a chunk. The faces with more than three vertices are split in triangles.
+ */
+void MeshReader::ParseOBJChunk( MeshChunk& chunk )
+{
+	int nChunkVertices = 0;
+	std::vector< int > faceVertices;
+	std::vector< bool > isRelativeVertex;
+
+	const char* line = chunk.begin;
+	while( line < chunk.end )
+	{
+		const char* lineEnd = FindLineEnd( line, chunk.end );
+		const char* position = line;
+		while( position < lineEnd && ( *position == ' ' || *position == '\t' ) )	++position;
+
+		if( IsKeyword( position, lineEnd, "v" ) )
+		{
+			position++;
+			float coordinates[3];
+			for( int i = 0; i < 3; ++i )
+			{
+				if( !ReadFloat( &position, lineEnd, &coordinates[i] ) )
+				{
+					chunk.isValid = false;
+					return;
+				}
+				chunk.coordinates.push_back( coordinates[i] );
+			}
+			nChunkVertices++;
+		}
+		else if( IsKeyword( position, lineEnd, "f" ) )
+		{
+			position++;
+			faceVertices.clear();
+			isRelativeVertex.clear();
+
+			//Each vertex can be followed by its texture and normal indices, separated by '/'
+			int vertex = 0;
+			while( ReadInteger( &position, lineEnd, &vertex ) )
+			{
+				if( vertex == 0 )
+				{
+					chunk.isValid = false;
+					return;
+				}
+				faceVertices.push_back( ( vertex > 0 ) ? vertex - 1 : nChunkVertices + vertex );
+				isRelativeVertex.push_back( vertex < 0 );
+				while( position < lineEnd && !isspace( (unsigned char) *position ) )	++position;
+			}
+
+			if( faceVertices.size() < 3 )
+			{
+				chunk.isValid = false;
+				return;
+			}
+			for( unsigned int v = 1; v + 1 < faceVertices.size(); ++v )
+			{
+				chunk.faces.push_back( faceVertices[0] );
+				chunk.faces.push_back( faceVertices[v] );
+				chunk.faces.push_back( faceVertices[v + 1] );
+				chunk.isRelativeFace.push_back( isRelativeVertex[0] );
+				chunk.isRelativeFace.push_back( isRelativeVertex[v] );
+				chunk.isRelativeFace.push_back( isRelativeVertex[v + 1] );
+			}
+		}
+
+		line = lineEnd;
+	}
+}
+
+/*!
+ * Reads the facet normals and vertices of an ASCII STL file \a chunk. Each facet must have three vertices.
+ */
+void MeshReader::ParseSTLChunk( MeshChunk& chunk )
+{
+	const char* line = chunk.begin;
+	while( line < chunk.end )
+	{
+		const char* lineEnd = FindLineEnd( line, chunk.end );
+		const char* position = line;
+		while( position < lineEnd && isspace( (unsigned char) *position ) )	++position;
+
+		int nValues = 0;
+		std::vector< float >* values = 0;
+		if( IsKeyword( position, lineEnd, "facet" ) )
+		{
+			if( chunk.coordinates.size() != 3 * chunk.normals.size() )
+			{
+				chunk.isValid = false;
+				return;
+			}
+
+			position += 5;
+			while( position < lineEnd && isspace( (unsigned char) *position ) )	++position;
+			if( !IsKeyword( position, lineEnd, "normal" ) )
+			{
+				chunk.isValid = false;
+				return;
+			}
+			position += 6;
+			nValues = 3;
+			values = &chunk.normals;
+		}
+		else if( IsKeyword( position, lineEnd, "vertex" ) )
+		{
+			position += 6;
+			nValues = 3;
+			values = &chunk.coordinates;
+		}
+
+		for( int i = 0; i < nValues; ++i )
+		{
+			float value = 0.0;
+			if( !ReadFloat( &position, lineEnd, &value ) )
+			{
+				chunk.isValid = false;
+				return;
+			}
+			values->push_back( value );
+		}
+
+		line = lineEnd;
+	}
+
+	if( chunk.coordinates.size() != 3 * chunk.normals.size() )	chunk.isValid = false;
+}
+
+/*!
+ * Reads the number at \a position, after the spaces, and moves \a position after it. The number is read
+ * with '.' as decimal separator whatever the locale is.
+ *
+ * Returns false if there is no number before \a end.
+ */
+bool MeshReader::ReadFloat( const char** position, const char* end, float* value )
+{
+	const char* p = *position;
+	while( p < end && ( *p == ' ' || *p == '\t' ) )	++p;
+
+	bool isNegative = false;
+	if( p < end && ( *p == '-' || *p == '+' ) )	isNegative = ( *p++ == '-' );
+
+	double mantissa = 0.0;
+	int exponent = 0;
+	int nDigits = 0;
+	while( p < end && *p >= '0' && *p <= '9' )
+	{
+		mantissa = 10.0 * mantissa + ( *p++ - '0' );
+		nDigits++;
+	}
+	if( p < end && *p == '.' )
+	{
+		++p;
+		while( p < end && *p >= '0' && *p <= '9' )
+		{
+			mantissa = 10.0 * mantissa + ( *p++ - '0' );
+			exponent--;
+			nDigits++;
+		}
+	}
+	if( nDigits < 1 )	return false;
+
+	if( p < end && ( *p == 'e' || *p == 'E' ) )
+	{
+		const char* exponentPosition = p + 1;
+		int exponentValue = 0;
+		if( ReadInteger( &exponentPosition, end, &exponentValue ) )
+		{
+			exponent += exponentValue;
+			p = exponentPosition;
+		}
+	}
+
+	double number = ( exponent < 0 ) ? mantissa / pow( 10.0, -exponent ) : mantissa * pow( 10.0, exponent );
+	*value = float( isNegative ? -number : number );
+	*position = p;
+	return true;
+}
+
+/*!
+ * Reads the integer at \a position, after the spaces, and moves \a position after it.
+ *
+ * Returns false if there is no integer before \a end.
+ */
+bool MeshReader::ReadInteger( const char** position, const char* end, int* value )
+{
+	const char* p = *position;
+	while( p < end && ( *p == ' ' || *p == '\t' ) )	++p;
+
+	bool isNegative = false;
+	if( p < end && ( *p == '-' || *p == '+' ) )	isNegative = ( *p++ == '-' );
+
+	if( p >= end || *p < '0' || *p > '9' )	return false;
+
+	int number = 0;
+	while( p < end && *p >= '0' && *p <= '9' )
+		number = 10 * number + ( *p++ - '0' );
+
+	*value = isNegative ? -number : number;
+	*position = p;
+	return true;
+}
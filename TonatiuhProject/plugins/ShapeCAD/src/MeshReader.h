@@ -0,0 +1,131 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef MESHREADER_H_
+#define MESHREADER_H_
+
+#include <vector>
+
+#include <QString>
+#include <QVector>
+
+#include "NormalVector.h"
+#include "Point3D.h"
+
+/*! *****************************
+ * class VertexIndexer
+ * **************************** */
+
+//!  VertexIndexer stores each different vertex of a mesh only once.
+/*!
+  The vertices are kept in a hash table with open addressing, so the index of each vertex is found in constant time.
+*/
+
+class VertexIndexer
+{
+
+public:
+	VertexIndexer( std::vector< Point3D >* vertices );
+
+	int Index( const Point3D& point );
+
+private:
+	static unsigned int Hash( const Point3D& point );
+	void Resize( unsigned int tableSize );
+
+	std::vector< Point3D >* m_vertices;
+	std::vector< int > m_table;
+	unsigned int m_mask;
+};
+
+/*! *****************************
+ * class MeshReader
+ * **************************** */
+
+//!  MeshReader reads the facets of a STL or OBJ file as an indexed triangle mesh.
+/*!
+  The file is mapped in memory. Binary STL facets are read directly from the mapped file. ASCII STL and OBJ
+  files are split in chunks at facet or line boundaries and the chunks are parsed in parallel.
+  The vertices shared by several facets are stored once and each facet stores the indices of its three vertices.
+*/
+
+class MeshReader
+{
+
+public:
+	MeshReader();
+	~MeshReader();
+
+	QString GetErrorMessage() const;
+	const std::vector< NormalVector >& GetFacetNormals() const;
+	const std::vector< int >& GetFacetVertices() const;
+	const std::vector< Point3D >& GetVertices() const;
+
+	bool Read( QString fileName );
+
+private:
+	struct MeshChunk
+	{
+		const char* begin;
+		const char* end;
+		bool isValid;
+		std::vector< float > coordinates;
+		std::vector< float > normals;
+		std::vector< int > faces;
+		std::vector< bool > isRelativeFace;
+	};
+
+	void AddFacet( int v1, int v2, int v3, NormalVector normal );
+	bool ReadBinarySTL( const char* data, qint64 size );
+	bool ReadTextFile( const char* data, qint64 size, bool isOBJ );
+	QVector< MeshChunk > SplitChunks( const char* data, qint64 size, bool isOBJ ) const;
+
+	static const char* FindLineEnd( const char* position, const char* end );
+	static bool IsKeyword( const char* position, const char* end, const char* keyword );
+	static void ParseOBJChunk( MeshChunk& chunk );
+	static void ParseSTLChunk( MeshChunk& chunk );
+	static bool ReadFloat( const char** position, const char* end, float* value );
+	static bool ReadInteger( const char** position, const char* end, int* value );
+
+	QString m_errorMessage;
+	std::vector< NormalVector > m_facetNormals;
+	std::vector< int > m_facetVertices;
+	std::vector< Point3D > m_vertices;
+};
+
+#endif /* MESHREADER_H_ */
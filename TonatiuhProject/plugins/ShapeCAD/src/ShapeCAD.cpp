@@ -37,6 +37,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 ***************************************************************************/
 
 #include <algorithm>
+#include <cmath>
 #include <functional> // for std::bind
 
 #include <QString>
@@ -52,11 +53,75 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 
 #include "BBox.h"
 #include "DifferentialGeometry.h"
+#include "MeshReader.h"
 #include "NormalVector.h"
 #include "Ray.h"
 #include "ShapeCAD.h"
+#include "Transform.h"
 #include "Triangle.h"
 
+namespace
+{
+	/*!
+	 * Point of the mesh parametric coordinates.
+	 */
+	struct ParametricPoint
+	{
+		double u;
+		double v;
+	};
+
+	/*!
+	 * Returns the area of the convex \a polygon.
+	 */
+	double PolygonArea( const std::vector< ParametricPoint >& polygon )
+	{
+		double area = 0.0;
+		for( unsigned int i = 0; i < polygon.size(); i++ )
+		{
+			const ParametricPoint& p0 = polygon[i];
+			const ParametricPoint& p1 = polygon[( i + 1 ) % polygon.size()];
+			area += p0.u * p1.v - p1.u * p0.v;
+		}
+		return ( 0.5 * fabs( area ) );
+	}
+
+	/*!
+	 * Clips \a polygon to the half plane where the u coordinate, or the v coordinate if \a isU is false,
+	 * minus \a limit has the sign of \a side.
+	 */
+	void ClipPolygon( std::vector< ParametricPoint >* polygon, bool isU, double limit, double side )
+	{
+		std::vector< ParametricPoint > clipped;
+		for( unsigned int i = 0; i < polygon->size(); i++ )
+		{
+			const ParametricPoint& p0 = ( *polygon )[i];
+			const ParametricPoint& p1 = ( *polygon )[( i + 1 ) % polygon->size()];
+			double d0 = side * ( ( isU ? p0.u : p0.v ) - limit );
+			double d1 = side * ( ( isU ? p1.u : p1.v ) - limit );
+			if( d0 >= 0.0 )	clipped.push_back( p0 );
+			if( ( d0 < 0.0 && d1 > 0.0 ) || ( d0 > 0.0 && d1 < 0.0 ) )
+			{
+				double t = d0 / ( d0 - d1 );
+				ParametricPoint intersection = { p0.u + t * ( p1.u - p0.u ), p0.v + t * ( p1.v - p0.v ) };
+				clipped.push_back( intersection );
+			}
+		}
+		polygon->swap( clipped );
+	}
+
+	/*!
+	 * Returns the cell of \a divisions cells over [0,1] that contains \a value, as the flux analysis counts the photons.
+	 */
+	int CellIndex( double value, int divisions )
+	{
+		int cell = int( value * divisions );
+		if( cell < 0 )	return ( 0 );
+		if( cell >= divisions )	return ( divisions - 1 );
+		return ( cell );
+	}
+}
+
 
 /*! *****************************
  * class ShapeCAD
@@ -71,15 +136,27 @@ void ShapeCAD::initClass()
 }
 
 ShapeCAD::ShapeCAD(  )
-: m_pBVH( 0 )
+: m_uAxis( 0 ),
+  m_vAxis( 2 ),
+  m_uLength( 0.0 ),
+  m_vLength( 0.0 ),
+  m_pBVH( 0 )
 {
 	SO_NODE_CONSTRUCTOR(ShapeCAD);
+	SO_NODE_ADD_FIELD( vertexList, (0, 0, 0 ) );
+	SO_NODE_ADD_FIELD( facetVertexList, ( 0 ) );
 	SO_NODE_ADD_FIELD( v1VertexList, (0, 0, 0 ) );
 	SO_NODE_ADD_FIELD( v2VertexList, (0, 0, 0 ) );
 	SO_NODE_ADD_FIELD( v3VertexList, (0, 0, 0 ) );
 	SO_NODE_ADD_FIELD( normalVertexList, (0, 0, 0 ) );
 
 
+	m_vertexSensor = new SoFieldSensor(updateTrinaglesList, this);
+	m_vertexSensor->setPriority( 0 );
+	m_vertexSensor->attach( &vertexList );
+	m_facetVertexSensor = new SoFieldSensor(updateTrinaglesList, this);
+	m_facetVertexSensor->setPriority( 0 );
+	m_facetVertexSensor->attach( &facetVertexList );
 	m_v1Sensor = new SoFieldSensor(updateTrinaglesList, this);
 	m_v1Sensor->setPriority( 0 );
 	m_v1Sensor->attach( &v1VertexList );
@@ -98,16 +175,8 @@ ShapeCAD::~ShapeCAD()
 {
 	delete m_pBVH;
 
-
-	if( m_pTriangleList.size() > 0 )
-	{
-		for( unsigned int f = 0; f < m_pTriangleList.size(); f++ )
-		{
-			delete m_pTriangleList[f];
-		}
-	}
-	m_pTriangleList.clear();
-
+	delete m_vertexSensor;
+	delete m_facetVertexSensor;
 	delete m_v1Sensor;
 	delete m_v2Sensor;
 	delete m_v3Sensor;
@@ -141,30 +210,50 @@ QString ShapeCAD::GetIcon() const
 
 bool ShapeCAD::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
 {
-	double tHitShape= objectRay.maxt;
-	DifferentialGeometry dgShape;
-
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) )	return ( false );
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return ( true );
+}
 
+/*!
+ * The intersected triangle is stored in the \a hit element.
+ */
+bool ShapeCAD::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
+{
 	if( !m_pBVH )	return ( false );
 
-	if ( !m_pBVH->Intersect( objectRay, &tHitShape, &dgShape ) )	return ( false );
-
-	if( ( tHit == 0 ) && ( dg == 0 ) )	return ( true );
-	if( ( tHit == 0 ) || ( dg == 0 ) ) gf::SevereError( "Function ShapeCAD::Intersect(...) called with null pointers" );
-
-
-	*tHit = tHitShape;
-	*dg = dgShape;
-	dg->pShape = this;
+	double tHitShape= objectRay.maxt;
+	const Triangle* triangle = 0;
+	if ( !m_pBVH->Intersect( objectRay, &tHitShape, &triangle ) )	return ( false );
 
+	hit->tHit = tHitShape;
+	hit->element = triangle;
 	return ( true );
+}
 
+/*!
+ * The differential geometry is computed for the triangle that IntersectT stored in the \a hit element,
+ * so the BVH is not traversed again. The (u,v) coordinates of the hit are its mesh parametric coordinates.
+ */
+void ShapeCAD::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	const Triangle* triangle = static_cast< const Triangle* >( hit.element );
+	if( !triangle )	return;
 
+	triangle->ComputeDifferentialGeometry( objectRay, hit.tHit, dg );
+	ParametricCoordinates( dg->point, &dg->u, &dg->v );
+	dg->pShape = this;
 }
 
+/*!
+ * The BVH traversal finishes at the first intersected triangle.
+ */
 bool ShapeCAD::IntersectP( const Ray& worldRay ) const
 {
-	return Intersect( worldRay, 0, 0 );
+	if( !m_pBVH )	return ( false );
+	return ( m_pBVH->IntersectP( worldRay ) );
 }
 
 Point3D ShapeCAD::Sample( double /*u*/, double /*v*/ ) const
@@ -173,51 +262,105 @@ Point3D ShapeCAD::Sample( double /*u*/, double /*v*/ ) const
 	return ( Point3D( 0.0, 0.0, 0.0 ) );
 }
 
-
-bool ShapeCAD:: SetFacetList( std::vector< Triangle* > triangleList )
+/*!
+ * Computes the area of the cells of the parametric grid from the areas of the facets, transformed with \a objectToWorld.
+ *
+ * Each facet is projected to the (u,v) coordinates and clipped to each cell that it overlaps. The cell takes the
+ * fraction of the facet area of the clipped projection. The facets parallel to the projection direction only
+ * have hits on a segment, so all their area is added to the cell of their centroid.
+ */
+bool ShapeCAD::ComputeParametricAreas( const Transform& objectToWorld, int heightDivisions, int widthDivisions,
+		std::vector< double >* cellAreas ) const
 {
-	m_v1Sensor->detach();
-	m_v2Sensor->detach();
-	m_v3Sensor->detach();
-	m_normalSensor->detach();
-
+	if( m_triangles.size() < 1 )	return ( false );
 
-	if( m_pTriangleList.size() > 0 )
+	cellAreas->assign( heightDivisions * widthDivisions, 0.0 );
+	for( unsigned int f = 0; f < m_triangles.size(); f++ )
 	{
-		for( unsigned int f = 0; f < m_pTriangleList.size(); f++ )
-		{
-			delete m_pTriangleList[f];
-		}
-	}
-	m_pTriangleList.clear();
+		Point3D vertices[3] = { m_triangles[f].GetVertex1(), m_triangles[f].GetVertex2(), m_triangles[f].GetVertex3() };
+		double facetArea = 0.5 * CrossProduct( objectToWorld( vertices[1] ) - objectToWorld( vertices[0] ),
+				objectToWorld( vertices[2] ) - objectToWorld( vertices[0] ) ).length();
+		if( !( facetArea > 0.0 ) )	continue;
 
-	m_pTriangleList = triangleList;
-
-
-	for( unsigned int f = 0; f < triangleList.size(); f++ )
-	{
+		std::vector< ParametricPoint > facet( 3 );
+		for( int i = 0; i < 3; i++ )
+			ParametricCoordinates( vertices[i], &facet[i].u, &facet[i].v );
+		double projectedArea = PolygonArea( facet );
 
-		Triangle* facet = triangleList[f];
-
-		Point3D v1 = facet->GetVertex1();
-		Point3D v2 = facet->GetVertex2();
-		Point3D v3 = facet->GetVertex3();
-		v1VertexList.set1Value( f, v1.x, v1.y, v1.z);
-		v2VertexList.set1Value( f, v2.x, v2.y, v2.z);
-		v3VertexList.set1Value( f, v3.x, v3.y, v3.z);
-		normalVertexList.set1Value( f, facet->GetNormal().x, facet->GetNormal().y, facet->GetNormal().z);
+		if( !( projectedArea > 0.0 ) )
+		{
+			double u = ( facet[0].u + facet[1].u + facet[2].u ) / 3;
+			double v = ( facet[0].v + facet[1].v + facet[2].v ) / 3;
+			( *cellAreas )[CellIndex( v, heightDivisions ) * widthDivisions + CellIndex( u, widthDivisions )] += facetArea;
+			continue;
+		}
 
+		double uMin = std::min( facet[0].u, std::min( facet[1].u, facet[2].u ) );
+		double uMax = std::max( facet[0].u, std::max( facet[1].u, facet[2].u ) );
+		double vMin = std::min( facet[0].v, std::min( facet[1].v, facet[2].v ) );
+		double vMax = std::max( facet[0].v, std::max( facet[1].v, facet[2].v ) );
+		for( int h = CellIndex( vMin, heightDivisions ); h <= CellIndex( vMax, heightDivisions ); h++ )
+		{
+			for( int w = CellIndex( uMin, widthDivisions ); w <= CellIndex( uMax, widthDivisions ); w++ )
+			{
+				std::vector< ParametricPoint > cellPolygon = facet;
+				ClipPolygon( &cellPolygon, true, double( w ) / widthDivisions, 1.0 );
+				ClipPolygon( &cellPolygon, true, double( w + 1 ) / widthDivisions, -1.0 );
+				ClipPolygon( &cellPolygon, false, double( h ) / heightDivisions, 1.0 );
+				ClipPolygon( &cellPolygon, false, double( h + 1 ) / heightDivisions, -1.0 );
+				( *cellAreas )[h * widthDivisions + w] += facetArea * PolygonArea( cellPolygon ) / projectedArea;
+			}
+		}
 	}
+	return ( true );
+}
 
-	if( m_pBVH )
-	{
-		delete m_pBVH;
-		m_pBVH = 0;
-	}
 
-	m_pBVH = new BVH( &m_pTriangleList, 1 );
+/*!
+ * Sets the shape facets. The \a facetVertices has the indices in \a vertices of the three vertices of each facet.
+ * Only the vertices and their indices are stored in the shape fields. Returns false if any index is not valid.
+ */
+bool ShapeCAD::SetMesh( const std::vector< Point3D >& vertices, const std::vector< int >& facetVertices )
+{
+	if( ( facetVertices.size() % 3 ) != 0 )	return ( false );
+	for( unsigned int i = 0; i < facetVertices.size(); i++ )
+		if( ( facetVertices[i] < 0 ) || ( facetVertices[i] >= int( vertices.size() ) ) )	return ( false );
 
+	m_vertexSensor->detach();
+	m_facetVertexSensor->detach();
+	m_v1Sensor->detach();
+	m_v2Sensor->detach();
+	m_v3Sensor->detach();
+	m_normalSensor->detach();
 
+	//The fields are filled without notifications for each value
+	int nVertices = int( vertices.size() );
+	vertexList.enableNotify( false );
+	vertexList.setNum( nVertices );
+	for( int v = 0; v < nVertices; v++ )
+		vertexList.set1Value( v, vertices[v].x, vertices[v].y, vertices[v].z );
+	vertexList.enableNotify( true );
+
+	int nIndices = int( facetVertices.size() );
+	facetVertexList.enableNotify( false );
+	facetVertexList.setNum( nIndices );
+	int32_t* indices = facetVertexList.startEditing();
+	for( int i = 0; i < nIndices; i++ )
+		indices[i] = facetVertices[i];
+	facetVertexList.finishEditing();
+	facetVertexList.enableNotify( true );
+
+	ClearFacetLists();
+	touch();
+
+	m_vertices = vertices;
+	m_facetVertices = facetVertices;
+	BuildMesh();
+
+	m_vertexSensor->setPriority( 0 );
+	m_vertexSensor->attach( &vertexList );
+	m_facetVertexSensor->setPriority( 0 );
+	m_facetVertexSensor->attach( &facetVertexList );
 	m_v1Sensor->setPriority( 0 );
 	m_v1Sensor->attach( &v1VertexList );
 	m_v2Sensor->setPriority( 0 );
@@ -269,16 +412,17 @@ void ShapeCAD::generatePrimitives(SoAction *action)
 
 	beginShape(action, TRIANGLES );
 
-	for( int f = 0; f < v1VertexList.getNum(); f++ )
+	for( unsigned int f = 0; f < m_triangles.size(); f++ )
 	{
-		//SbVec3f aPoint = v1VertexList[f];
-		SbVec3f aPoint( v1VertexList[f][0], v1VertexList[f][1], v1VertexList[f][2] );
-		SbVec3f bPoint( v2VertexList[f][0], v2VertexList[f][1], v2VertexList[f][2] );
-		SbVec3f cPoint( v3VertexList[f][0], v3VertexList[f][1], v3VertexList[f][2] );
-
-		//SbVec3f dpdu =  bPoint - aPoint;
-		//SbVec3f dpdv = cPoint - aPoint;
-		SbVec3f normal( normalVertexList[f][0], normalVertexList[f][1], normalVertexList[f][2] );
+		Point3D v1 = m_triangles[f].GetVertex1();
+		Point3D v2 = m_triangles[f].GetVertex2();
+		Point3D v3 = m_triangles[f].GetVertex3();
+		SbVec3f aPoint( v1.x, v1.y, v1.z );
+		SbVec3f bPoint( v2.x, v2.y, v2.z );
+		SbVec3f cPoint( v3.x, v3.y, v3.z );
+
+		//The normal of the triangle, as it is computed for the ray tracing
+		SbVec3f normal = ( bPoint - aPoint ).cross( cPoint - aPoint );
 		normal.normalize();
 
 
@@ -316,75 +460,125 @@ void ShapeCAD::updateTrinaglesList( void* data, SoSensor* )
 
 	ShapeCAD* shapeCAD = (ShapeCAD *) data;
 
+	if( !shapeCAD->facetVertexList.isDefault() )	shapeCAD->ReadIndexedMesh();
+	else	shapeCAD->ReadFacetLists();
+
+	shapeCAD->BuildMesh();
+}
+
+/*!
+ * Resets the facet lists of the files saved before the indexed mesh, so they are not saved again.
+ */
+void ShapeCAD::ClearFacetLists()
+{
+	v1VertexList.setValue( 0, 0, 0 );
+	v1VertexList.setDefault( TRUE );
+	v2VertexList.setValue( 0, 0, 0 );
+	v2VertexList.setDefault( TRUE );
+	v3VertexList.setValue( 0, 0, 0 );
+	v3VertexList.setDefault( TRUE );
+	normalVertexList.setValue( 0, 0, 0 );
+	normalVertexList.setDefault( TRUE );
+}
 
-	if( shapeCAD->m_pTriangleList.size() > 0 )
+/*!
+ * Sets the mesh vertices and facets from the vertexList and facetVertexList fields.
+ * The mesh is empty if any facet vertex index is not valid.
+ */
+void ShapeCAD::ReadIndexedMesh()
+{
+	m_vertices.clear();
+	m_facetVertices.clear();
+
+	int nVertices = vertexList.getNum();
+	int nIndices = facetVertexList.getNum();
+	if( ( nIndices % 3 ) != 0 )	return;
+	for( int i = 0; i < nIndices; i++ )
+		if( ( facetVertexList[i] < 0 ) || ( facetVertexList[i] >= nVertices ) )	return;
+
+	m_vertices.reserve( nVertices );
+	for( int v = 0; v < nVertices; v++ )
+		m_vertices.push_back( Point3D( vertexList[v][0], vertexList[v][1], vertexList[v][2] ) );
+
+	const int32_t* indices = facetVertexList.getValues( 0 );
+	m_facetVertices.assign( indices, indices + nIndices );
+}
+
+/*!
+ * Sets the mesh vertices and facets from the facet lists of the files saved before the indexed mesh.
+ * The vertices shared by several facets are stored once.
+ */
+void ShapeCAD::ReadFacetLists()
+{
+	m_vertices.clear();
+	m_facetVertices.clear();
+
+	int v1Size = v1VertexList.getNum();
+	if( !v1VertexList.isDefault() && ( v1Size > 0 ) &&
+			( v2VertexList.getNum() == v1Size ) &&
+			( v3VertexList.getNum() == v1Size ) &&
+			( normalVertexList.getNum() == v1Size )  )
 	{
-		for( unsigned int f = 0; f < shapeCAD->m_pTriangleList.size(); f++ )
+		m_facetVertices.reserve( 3 * v1Size );
+		VertexIndexer vertexIndexer( &m_vertices );
+		for(  int f = 0; f < v1Size; f++ )
 		{
-			delete shapeCAD->m_pTriangleList[f];
+			Point3D v1 = Point3D( v1VertexList[f][0], v1VertexList[f][1], v1VertexList[f][2] );
+			Point3D v2 = Point3D( v2VertexList[f][0], v2VertexList[f][1], v2VertexList[f][2] );
+			Point3D v3 = Point3D( v3VertexList[f][0], v3VertexList[f][1], v3VertexList[f][2] );
+			m_facetVertices.push_back( vertexIndexer.Index( v1 ) );
+			m_facetVertices.push_back( vertexIndexer.Index( v2 ) );
+			m_facetVertices.push_back( vertexIndexer.Index( v3 ) );
 		}
 	}
-	shapeCAD->m_pTriangleList.clear();
+}
 
-	if( shapeCAD->m_pBVH )
+/*!
+ * Creates the triangles of the mesh defined by the vertices and the facets vertices indices, and their hierarchy.
+ */
+void ShapeCAD::BuildMesh()
+{
+	if( m_pBVH )
 	{
-		delete shapeCAD->m_pBVH;
-		shapeCAD->m_pBVH = 0;
+		delete m_pBVH;
+		m_pBVH = 0;
 	}
 
+	m_pTriangleList.clear();
+	m_triangles.clear();
 
-	int v1Size = shapeCAD->v1VertexList.getNum();
-	if( ( v1Size > 0 ) &&
-			( shapeCAD->v2VertexList.getNum() == v1Size ) &&
-			( shapeCAD->v3VertexList.getNum() == v1Size ) &&
-			( shapeCAD->normalVertexList.getNum() == v1Size )  )
-	{
-		/*
-		shapeCAD->m_xMin = gc::Infinity;
-		shapeCAD->m_yMin = gc::Infinity;
-		shapeCAD->m_zMin = gc::Infinity;
-
-		shapeCAD->m_xMax = - gc::Infinity;
-		shapeCAD->m_yMax = - gc::Infinity;
-		shapeCAD->m_zMax = - gc::Infinity;
-		*/
+	unsigned int nFacets = m_facetVertices.size() / 3;
+	if( nFacets < 1 )	return;
 
-		for(  int f = 0; f < v1Size; f++ )
-		{
-			Point3D v1 = Point3D( shapeCAD->v1VertexList[f][0], shapeCAD->v1VertexList[f][1], shapeCAD->v1VertexList[f][2] );
-			Point3D v2 = Point3D( shapeCAD->v2VertexList[f][0], shapeCAD->v2VertexList[f][1], shapeCAD->v2VertexList[f][2] );
-			Point3D v3 = Point3D( shapeCAD->v3VertexList[f][0], shapeCAD->v3VertexList[f][1], shapeCAD->v3VertexList[f][2] );
-			NormalVector normal = NormalVector( shapeCAD->normalVertexList[f][0], shapeCAD->normalVertexList[f][1], shapeCAD->normalVertexList[f][2] );
-			Triangle* triangle = new Triangle( v1, v2, v3, normal );
-			shapeCAD->m_pTriangleList.push_back( triangle );
-
-			/*
-			if( v1.x < shapeCAD->m_xMin )	shapeCAD->m_xMin = v1.x;
-			if( v2.x < shapeCAD->m_xMin )	shapeCAD->m_xMin = v2.x;
-			if( v3.x < shapeCAD->m_xMin )	shapeCAD->m_xMin = v3.x;
-
-			if( v1.y < shapeCAD->m_yMin )	shapeCAD->m_yMin = v1.y;
-			if( v2.y < shapeCAD->m_yMin )	shapeCAD->m_yMin = v2.y;
-			if( v3.y < shapeCAD->m_yMin ) 	shapeCAD->m_yMin = v3.y;
-
-			if( v1.z < shapeCAD->m_zMin )	shapeCAD->m_zMin = v1.z;
-			if( v2.z < shapeCAD->m_zMin )	shapeCAD->m_zMin = v2.z;
-			if( v3.z < shapeCAD->m_zMin )	shapeCAD->m_zMin = v3.z;
-
-			if( v1.x > shapeCAD->m_xMax )	shapeCAD->m_xMax = v1.x;
-			if( v2.x > shapeCAD->m_xMax )	shapeCAD->m_xMax = v2.x;
-			if( v3.x > shapeCAD->m_xMax )	shapeCAD->m_xMax = v3.x;
-
-			if( v1.y > shapeCAD->m_yMax )	shapeCAD->m_yMax = v1.y;
-			if( v2.y > shapeCAD->m_yMax )	shapeCAD->m_yMax = v2.y;
-			if( v3.y > shapeCAD->m_yMax )	shapeCAD->m_yMax = v3.y;
-
-			if( v1.z > shapeCAD->m_zMax )	shapeCAD->m_zMax = v1.z;
-			if( v2.z > shapeCAD->m_zMax )	shapeCAD->m_zMax = v2.z;
-			if( v3.z > shapeCAD->m_zMax )	shapeCAD->m_zMax = v3.z;
-			*/
-		}
-		shapeCAD->m_pBVH = new BVH( &shapeCAD->m_pTriangleList, 1);
+	m_triangles.reserve( nFacets );
+	m_pTriangleList.reserve( nFacets );
+	for( unsigned int f = 0; f < nFacets; f++ )
+	{
+		m_triangles.push_back( Triangle( &m_vertices[0], m_facetVertices[3 * f], m_facetVertices[3 * f + 1], m_facetVertices[3 * f + 2] ) );
+		m_pTriangleList.push_back( &m_triangles[f] );
 	}
+
+	m_pBVH = new BVH( &m_pTriangleList );
+
+	//The projection direction is the smallest dimension of the mesh
+	BBox bbox = m_pBVH->GetBBox();
+	Vector3D extent = bbox.pMax - bbox.pMin;
+	int normalAxis = 1;
+	if( ( extent.x <= extent.y ) && ( extent.x <= extent.z ) )	normalAxis = 0;
+	else if( ( extent.z < extent.x ) && ( extent.z < extent.y ) )	normalAxis = 2;
+	m_uAxis = ( normalAxis == 0 ) ? 1 : 0;
+	m_vAxis = ( normalAxis == 2 ) ? 1 : 2;
+	m_parametricOrigin = bbox.pMin;
+	m_uLength = extent[m_uAxis];
+	m_vLength = extent[m_vAxis];
 }
 
+/*!
+ * Computes to \a u and \a v the parametric coordinates of the mesh \a point, that are its coordinates
+ * along the two largest dimensions of the mesh bounding box scaled to [0,1].
+ */
+void ShapeCAD::ParametricCoordinates( const Point3D& point, double* u, double* v ) const
+{
+	*u = ( m_uLength > 0.0 ) ? ( point[m_uAxis] - m_parametricOrigin[m_uAxis] ) / m_uLength : 0.5;
+	*v = ( m_vLength > 0.0 ) ? ( point[m_vAxis] - m_parametricOrigin[m_vAxis] ) / m_vLength : 0.5;
+}
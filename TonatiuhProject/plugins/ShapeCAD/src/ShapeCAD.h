@@ -41,6 +41,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 
 #include <vector>
 
+#include <Inventor/fields/SoMFInt32.h>
 #include <Inventor/sensors/SoFieldSensor.h>
 
 #include "BVH.h"
@@ -88,11 +89,15 @@ public:
 	QString GetIcon() const;
 
 	bool Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg ) const;
+	bool IntersectT( const Ray& objectRay, ShapeHit* hit ) const;
+	void ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const;
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v ) const;
+	bool ComputeParametricAreas( const Transform& objectToWorld, int heightDivisions, int widthDivisions,
+			std::vector< double >* cellAreas ) const;
 
-	bool SetFacetList( std::vector< Triangle* > triangleList );
+	bool SetMesh( const std::vector< Point3D >& vertices, const std::vector< int >& facetVertices );
 
 	int	getFields(SoFieldList & fields) const;
 
@@ -108,13 +113,35 @@ protected:
 
 private:
 
+	trt::TONATIUH_CONTAINERREALVECTOR3 vertexList;
+	SoMFInt32 facetVertexList;
+
+	//Facet vertices and normals of the files saved before the indexed mesh. They are only read.
 	trt::TONATIUH_CONTAINERREALVECTOR3 v1VertexList;
 	trt::TONATIUH_CONTAINERREALVECTOR3 v2VertexList;
 	trt::TONATIUH_CONTAINERREALVECTOR3 v3VertexList;
 	trt::TONATIUH_CONTAINERREALVECTOR3 normalVertexList;
 
+	void BuildMesh();
+	void ClearFacetLists();
+	void ParametricCoordinates( const Point3D& point, double* u, double* v ) const;
+	void ReadIndexedMesh();
+	void ReadFacetLists();
+
+	std::vector< Point3D > m_vertices;
+	std::vector< int > m_facetVertices;
+	std::vector< Triangle > m_triangles;
 	std::vector< Triangle*> m_pTriangleList;
 
+	//The (u,v) coordinates are the mesh coordinates along the two largest dimensions of its bounding box
+	int m_uAxis;
+	int m_vAxis;
+	Point3D m_parametricOrigin;
+	double m_uLength;
+	double m_vLength;
+
+	SoFieldSensor* m_vertexSensor;
+	SoFieldSensor* m_facetVertexSensor;
 	SoFieldSensor* m_v1Sensor;
 	SoFieldSensor* m_v2Sensor;
 	SoFieldSensor* m_v3Sensor;
@@ -40,7 +40,6 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 #define SHAPECADFACTORY_H_
 
 #include "ShapeCAD.h"
-#include "Triangle.h"
 #include "TShapeFactory.h"
 
 class ShapeCADFactory: public QObject, public TShapeFactory
@@ -57,9 +56,6 @@ public:
    	ShapeCAD* CreateTShape( ) const;
    	ShapeCAD* CreateTShape( int numberofParameters, QVector< QVariant > parametersList ) const;
    	bool IsFlat() { return false; }
-
-private:
-   	bool ReadSTLFile( QString filename, std::vector< Triangle* >* facetList ) const;
 };
 
 
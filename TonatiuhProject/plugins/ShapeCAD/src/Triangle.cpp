@@ -36,6 +36,8 @@ Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez
 Juana Amieva, Azael Mancillas, Cesar Cantu, Iigo Les.
 ***************************************************************************/
 
+#include <algorithm>
+
 #include "DifferentialGeometry.h"
 #include "gc.h"
 #include "gf.h"
@@ -45,62 +47,44 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 /*! *****************************
  * class Triangle
  * **************************** */
-Triangle::Triangle( Point3D v1, Point3D v2, Point3D v3, NormalVector normal )
-:m_bbox( ),
- m_centoid(),
- m_normal ( normal ),
+Triangle::Triangle( const Point3D* vertices, int v1, int v2, int v3 )
+:m_vertices( vertices ),
  m_v1( v1 ),
  m_v2 ( v2 ),
  m_v3( v3 ),
- m_vE1( Vector3D() ),
- m_vE2( Vector3D() ),
- m_vW1( Vector3D() ),
  m_tol( 0.000001 )
 {
+	Vector3D vE1( m_vertices[m_v2] - m_vertices[m_v1] );
+	Vector3D vE2( m_vertices[m_v3] - m_vertices[m_v1] );
+	m_tol = vE1.length()*vE2.length()/1000000;
+}
+
+/*!
+ * Returns the bounding box of the triangle vertices.
+ */
+BBox Triangle::GetBBox() const
+{
+	const Point3D& v1 = m_vertices[m_v1];
+	const Point3D& v2 = m_vertices[m_v2];
+	const Point3D& v3 = m_vertices[m_v3];
+
+	return ( BBox( Point3D( std::min( v1.x, std::min( v2.x, v3.x ) ),
+							std::min( v1.y, std::min( v2.y, v3.y ) ),
+							std::min( v1.z, std::min( v2.z, v3.z ) ) ),
+					Point3D( std::max( v1.x, std::max( v2.x, v3.x ) ),
+							std::max( v1.y, std::max( v2.y, v3.y ) ),
+							std::max( v1.z, std::max( v2.z, v3.z ) ) ) ) );
+}
 
-	double xMin = gc::Infinity;
-	if( m_v1.x < xMin )	xMin = m_v1.x;
-	if( m_v2.x < xMin )	xMin = m_v2.x;
-	if( m_v3.x < xMin )	xMin = m_v3.x;
-	double yMin = gc::Infinity;
-	if( m_v1.y < yMin )	yMin = m_v1.y;
-	if( m_v2.y < yMin )	yMin = m_v2.y;
-	if( m_v3.y < yMin )	yMin = m_v3.y;
-	double zMin = gc::Infinity;
-	if( m_v1.z < zMin )	zMin = m_v1.z;
-	if( m_v2.z < zMin )	zMin = m_v2.z;
-	if( m_v3.z < zMin )	zMin = m_v3.z;
-	double xMax = - gc::Infinity;
-	if( m_v1.x > xMax )	xMax = m_v1.x;
-	if( m_v2.x > xMax )	xMax = m_v2.x;
-	if( m_v3.x > xMax )	xMax = m_v3.x;
-	double yMax = - gc::Infinity;
-	if( m_v1.y > yMax )	yMax = m_v1.y;
-	if( m_v2.y > yMax )	yMax = m_v2.y;
-	if( m_v3.y > yMax )	yMax = m_v3.y;
-	double zMax = - gc::Infinity;
-	if( m_v1.z > zMax )	zMax = m_v1.z;
-	if( m_v2.z > zMax )	zMax = m_v2.z;
-	if( m_v3.z > zMax )	zMax = m_v3.z;
-
-	m_bbox.pMin = Point3D( xMin, yMin, zMin );
-	m_bbox.pMax  = Point3D( xMax, yMax, zMax );
-
-	m_centoid = Point3D( m_bbox.pMin.x + 0.5 * ( m_bbox.pMax.x - m_bbox.pMin.x  ),
-			m_bbox.pMin.y + 0.5 * ( m_bbox.pMax.y - m_bbox.pMin.y  ),
-			m_bbox.pMin.z + 0.5 * ( m_bbox.pMax.z - m_bbox.pMin.z  ) );
-
-
-	/*
-	 m_vB = Vector3D( m_v1 - m_v3 );
-	 m_vC = Vector3D( m_v2 - m_v3 );
-	 m_vW1 = CrossProduct( m_vB, m_vC );
-	 */
-	 m_vE1 = Vector3D( m_v2 - m_v1 );
-	 m_vE2 = Vector3D( m_v3 - m_v1 );
-	 m_vW1 = CrossProduct( m_vE1, m_vE2 );
-
-	 m_tol = m_vE1.length()*m_vE2.length()/1000000;
+/*!
+ * Returns the center of the triangle bounding box.
+ */
+Point3D Triangle::GetCentroid() const
+{
+	BBox bbox = GetBBox();
+	return ( Point3D( bbox.pMin.x + 0.5 * ( bbox.pMax.x - bbox.pMin.x  ),
+			bbox.pMin.y + 0.5 * ( bbox.pMax.y - bbox.pMin.y  ),
+			bbox.pMin.z + 0.5 * ( bbox.pMax.z - bbox.pMin.z  ) ) );
 }
 
 
@@ -109,16 +93,30 @@ Triangle::Triangle( Point3D v1, Point3D v2, Point3D v3, NormalVector normal )
  */
 bool Triangle::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
 {
+	if( !IntersectT( objectRay, tHit ) )	return ( false );
+	ComputeDifferentialGeometry( objectRay, *tHit, dg );
+	return ( true );
+}
+
+/*!
+ * Computes to \a tHit the intersection distance of \a objectRay with the triangle.
+ * The intersection is rejected if it is farther than the input value of \a tHit.
+ */
+bool Triangle::IntersectT( const Ray& objectRay, double* tHit ) const
+{
+	const Point3D& v1 = m_vertices[m_v1];
+	Vector3D vE1( m_vertices[m_v2] - v1 );
+	Vector3D vE2( m_vertices[m_v3] - v1 );
 
 	//e1 = B - A
 	//e2 = C - A
-	Vector3D pVector = CrossProduct( objectRay.direction(), m_vE2 );
-	double det = DotProduct( m_vE1, pVector );
+	Vector3D pVector = CrossProduct( objectRay.direction(), vE2 );
+	double det = DotProduct( vE1, pVector );
 	double inv_det = 1/det;
 
 	//Vector3D tVector = Vector3D( objectRay.origin )  Vector3D(m_v1) ;
-	Vector3D tVector = Vector3D( objectRay.origin - m_v1 );
-	Vector3D qVec = CrossProduct( tVector ,  m_vE1 );
+	Vector3D tVector = Vector3D( objectRay.origin - v1 );
+	Vector3D qVec = CrossProduct( tVector ,  vE1 );
 	double thit;
 	//double tol = 0.000001;
 	if (det > m_tol)
@@ -129,7 +127,7 @@ bool Triangle::Intersect( const Ray& objectRay, double* tHit, DifferentialGeomet
 		double v = DotProduct( objectRay.direction(), qVec );
 		if (v < 0 || ( v + u ) > det) return ( false );
 
-		double t = DotProduct( m_vE2, qVec );
+		double t = DotProduct( vE2, qVec );
 		thit  =  t * inv_det;
 		u *= inv_det;
 		v *= inv_det;
@@ -144,7 +142,7 @@ bool Triangle::Intersect( const Ray& objectRay, double* tHit, DifferentialGeomet
 		if (v < 0.0 || ( ( v+u ) > 1.0 ) ) 	return ( false );
 
 
-		double t = DotProduct( m_vE2, qVec ) * inv_det;
+		double t = DotProduct( vE2, qVec ) * inv_det;
 		thit  =  t;
 	}
 	else
@@ -227,36 +225,28 @@ bool Triangle::Intersect( const Ray& objectRay, double* tHit, DifferentialGeomet
 	if( thit > *tHit ) return false;
 	if( (thit - objectRay.mint) < m_tol ) return false;
 
+	*tHit = thit;
+	return true;
+}
 
-	Point3D hitPoint = objectRay( thit );
-
-
-	Vector3D dpdu = Normalize( m_vE1 );
-	Vector3D dpdv = Normalize( m_vE2 );
+/*!
+ * Computes to \a dg the differential geometry of the triangle at the intersection \a tHit of \a objectRay.
+ */
+void Triangle::ComputeDifferentialGeometry( const Ray& objectRay, double tHit, DifferentialGeometry* dg ) const
+{
+	const Point3D& v1 = m_vertices[m_v1];
+	Vector3D vE1( m_vertices[m_v2] - v1 );
+	Vector3D vE2( m_vertices[m_v3] - v1 );
 
-	// Compute ShapeCone \dndu and \dndv
-	Vector3D d2Pduu( 0.0, 0.0, 0.0 );
-	Vector3D d2Pduv( 0.0, 0.0, 0.0 );
-	Vector3D d2Pdvv( 0.0, 0.0, 0.0 );
+	Point3D hitPoint = objectRay( tHit );
 
-	// Compute coefficients for fundamental forms
-	double E = DotProduct( dpdu, dpdu );
-	double F = DotProduct( dpdu, dpdv );
-	double G = DotProduct( dpdv, dpdv );
+	Vector3D dpdu = Normalize( vE1 );
+	Vector3D dpdv = Normalize( vE2 );
 
 	Vector3D N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
 
-
-	double e = DotProduct( N, d2Pduu );
-	double f = DotProduct( N, d2Pduv );
-	double g = DotProduct( N, d2Pdvv );
-
-	// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / (E*G - F*F);
-	Vector3D dndu = (f*F - e*G) * invEGF2 * dpdu +
-			        (e*F - f*E) * invEGF2 * dpdv;
-	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
-	                (f*F - g*E) * invEGF2 * dpdv;
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry( hitPoint ,
@@ -267,10 +257,4 @@ bool Triangle::Intersect( const Ray& objectRay, double* tHit, DifferentialGeomet
 		                        -1, -1, 0 );
 
 	dg->shapeFrontSide = ( DotProduct( N, objectRay.direction() ) > 0 ) ? false : true;
-
-    // Update _tHit_ for quadric intersection
-    *tHit = thit;
-
-	return true;
-
 }
@@ -48,35 +48,35 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 class DifferentialGeometry;
 class Ray;
 
+/*! *****************************
+ * class Triangle
+ *
+ * The triangle stores the indices of its vertices in the vertices array of the mesh,
+ * that must not change while the triangle is used.
+ * **************************** */
 class Triangle
 {
 
 public:
-	Triangle( Point3D v1, Point3D v2, Point3D v3, NormalVector normal );
+	Triangle( const Point3D* vertices, int v1, int v2, int v3 );
 
 
-	BBox GetBBox() const { return ( m_bbox ); } ;
-	Point3D GetCentroid() const { return ( m_centoid ); };
-	NormalVector GetNormal() const { return ( m_normal ); } ;
-	Point3D GetVertex1() const { return ( m_v1 ); } ;
-	Point3D GetVertex2() const { return ( m_v2 ); } ;
-	Point3D GetVertex3() const { return ( m_v3 ); } ;
+	BBox GetBBox() const;
+	Point3D GetCentroid() const;
+	Point3D GetVertex1() const { return ( m_vertices[m_v1] ); } ;
+	Point3D GetVertex2() const { return ( m_vertices[m_v2] ); } ;
+	Point3D GetVertex3() const { return ( m_vertices[m_v3] ); } ;
 
 	bool Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const;
+	bool IntersectT( const Ray& objectRay, double* tHit ) const;
+	void ComputeDifferentialGeometry( const Ray& objectRay, double tHit, DifferentialGeometry* dg ) const;
 
 private:
 
-	BBox m_bbox;
-	Point3D m_centoid;
-	NormalVector m_normal;
-	Point3D m_v1;
-	Point3D m_v2;
-	Point3D m_v3;
-
-
-	Vector3D m_vE1;
-	Vector3D m_vE2;
-	Vector3D m_vW1;
+	const Point3D* m_vertices;
+	int m_v1;
+	int m_v2;
+	int m_v3;
 
 	double m_tol;
 };
@@ -0,0 +1,258 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include "gf.h"
+#include "Ray.h"
+#include "Triangle.h"
+#include "TrianglePacket.h"
+#include "Vector3D.h"
+
+#if defined( __AVX__ )
+
+#include <immintrin.h>
+
+namespace
+{
+	typedef __m256 PacketFloat;
+	const int PacketWidth = 8;
+
+	inline PacketFloat Load( const float* values ) { return ( _mm256_loadu_ps( values ) ); }
+	inline PacketFloat Set( float value ) { return ( _mm256_set1_ps( value ) ); }
+	inline PacketFloat Add( PacketFloat a, PacketFloat b ) { return ( _mm256_add_ps( a, b ) ); }
+	inline PacketFloat Sub( PacketFloat a, PacketFloat b ) { return ( _mm256_sub_ps( a, b ) ); }
+	inline PacketFloat Mul( PacketFloat a, PacketFloat b ) { return ( _mm256_mul_ps( a, b ) ); }
+	inline PacketFloat And( PacketFloat a, PacketFloat b ) { return ( _mm256_and_ps( a, b ) ); }
+	inline PacketFloat Or( PacketFloat a, PacketFloat b ) { return ( _mm256_or_ps( a, b ) ); }
+	inline PacketFloat LessEqual( PacketFloat a, PacketFloat b ) { return ( _mm256_cmp_ps( a, b, _CMP_LE_OQ ) ); }
+	inline PacketFloat Abs( PacketFloat a ) { return ( _mm256_andnot_ps( _mm256_set1_ps( -0.0f ), a ) ); }
+	inline PacketFloat SignOf( PacketFloat a ) { return ( _mm256_and_ps( _mm256_set1_ps( -0.0f ), a ) ); }
+	inline PacketFloat Xor( PacketFloat a, PacketFloat b ) { return ( _mm256_xor_ps( a, b ) ); }
+	inline int Mask( PacketFloat a ) { return ( _mm256_movemask_ps( a ) ); }
+}
+
+#elif defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 1 ) )
+
+#include <xmmintrin.h>
+
+namespace
+{
+	typedef __m128 PacketFloat;
+	const int PacketWidth = 4;
+
+	inline PacketFloat Load( const float* values ) { return ( _mm_loadu_ps( values ) ); }
+	inline PacketFloat Set( float value ) { return ( _mm_set1_ps( value ) ); }
+	inline PacketFloat Add( PacketFloat a, PacketFloat b ) { return ( _mm_add_ps( a, b ) ); }
+	inline PacketFloat Sub( PacketFloat a, PacketFloat b ) { return ( _mm_sub_ps( a, b ) ); }
+	inline PacketFloat Mul( PacketFloat a, PacketFloat b ) { return ( _mm_mul_ps( a, b ) ); }
+	inline PacketFloat And( PacketFloat a, PacketFloat b ) { return ( _mm_and_ps( a, b ) ); }
+	inline PacketFloat Or( PacketFloat a, PacketFloat b ) { return ( _mm_or_ps( a, b ) ); }
+	inline PacketFloat LessEqual( PacketFloat a, PacketFloat b ) { return ( _mm_cmple_ps( a, b ) ); }
+	inline PacketFloat Abs( PacketFloat a ) { return ( _mm_andnot_ps( _mm_set1_ps( -0.0f ), a ) ); }
+	inline PacketFloat SignOf( PacketFloat a ) { return ( _mm_and_ps( _mm_set1_ps( -0.0f ), a ) ); }
+	inline PacketFloat Xor( PacketFloat a, PacketFloat b ) { return ( _mm_xor_ps( a, b ) ); }
+	inline int Mask( PacketFloat a ) { return ( _mm_movemask_ps( a ) ); }
+}
+
+#else
+
+//Without SIMD instructions the same test is done for one triangle at a time.
+namespace
+{
+	typedef float PacketFloat;
+	const int PacketWidth = 1;
+
+	inline PacketFloat Load( const float* values ) { return ( *values ); }
+	inline PacketFloat Set( float value ) { return ( value ); }
+	inline PacketFloat Add( PacketFloat a, PacketFloat b ) { return ( a + b ); }
+	inline PacketFloat Sub( PacketFloat a, PacketFloat b ) { return ( a - b ); }
+	inline PacketFloat Mul( PacketFloat a, PacketFloat b ) { return ( a * b ); }
+	inline PacketFloat And( PacketFloat a, PacketFloat b ) { return ( ( a != 0.0f ) && ( b != 0.0f ) ) ? 1.0f : 0.0f; }
+	inline PacketFloat Or( PacketFloat a, PacketFloat b ) { return ( ( a != 0.0f ) || ( b != 0.0f ) ) ? 1.0f : 0.0f; }
+	inline PacketFloat LessEqual( PacketFloat a, PacketFloat b ) { return ( a <= b ) ? 1.0f : 0.0f; }
+	inline PacketFloat Abs( PacketFloat a ) { return ( ( a < 0.0f ) ? -a : a ); }
+	inline PacketFloat SignOf( PacketFloat a ) { return ( ( a < 0.0f ) ? -1.0f : 1.0f ); }
+	inline PacketFloat Xor( PacketFloat a, PacketFloat sign ) { return ( a * sign ); }
+	inline int Mask( PacketFloat a ) { return ( ( a != 0.0f ) ? 1 : 0 ); }
+}
+
+#endif
+
+//Bound of the relative rounding error of the float products and sums of the test, with a margin
+static const double FloatError = 4.0e-6;
+
+
+/*! *****************************
+ * class TrianglePacket
+ * **************************** */
+
+/*!
+ * Creates a packet with the first \a nTriangles triangles of \a triangles. \a nTriangles must be
+ * between 1 and TrianglePacket::Size.
+ */
+TrianglePacket::TrianglePacket( Triangle* const* triangles, int nTriangles )
+:m_center( 0.0, 0.0, 0.0 ),
+ m_tolerance( 0.0 ),
+ m_edgeLength( 0.0 ),
+ m_vertexDistance( 0.0 ),
+ m_nTriangles( std::min( nTriangles, int( Size ) ) )
+{
+	if( m_nTriangles < 1 )	gf::SevereError( "TrianglePacket::TrianglePacket called without triangles" );
+
+	BBox packetBBox;
+	for( int t = 0; t < m_nTriangles; ++t )
+		packetBBox = Union( packetBBox, triangles[t]->GetBBox() );
+	m_center = packetBBox.pMin + 0.5 * ( packetBBox.pMax - packetBBox.pMin );
+
+	//Float errors are bounded relative to the packet size
+	m_tolerance = 0.001 * Distance( packetBBox.pMin, packetBBox.pMax );
+
+	for( int t = 0; t < Size; ++t )
+	{
+		//The empty lanes repeat the last triangle and they are discarded with the triangles mask
+		Triangle* triangle = triangles[std::min( t, m_nTriangles - 1 )];
+		m_triangles[t] = ( t < m_nTriangles ) ? triangle : 0;
+
+		Vector3D v1( triangle->GetVertex1() - m_center );
+		Vector3D e1( triangle->GetVertex2() - triangle->GetVertex1() );
+		Vector3D e2( triangle->GetVertex3() - triangle->GetVertex1() );
+		m_edgeLength = std::max( m_edgeLength, std::max( e1.length(), e2.length() ) );
+		m_vertexDistance = std::max( m_vertexDistance, v1.length() );
+		m_v1x[t] = float( v1.x );
+		m_v1y[t] = float( v1.y );
+		m_v1z[t] = float( v1.z );
+		m_e1x[t] = float( e1.x );
+		m_e1y[t] = float( e1.y );
+		m_e1z[t] = float( e1.z );
+		m_e2x[t] = float( e2.x );
+		m_e2y[t] = float( e2.y );
+		m_e2z[t] = float( e2.z );
+	}
+}
+
+/*!
+ * Returns a mask with the bit t set for each triangle t that \a objectRay may intersect between the
+ * ray minimum distance and \a tMax. The triangles are tested at once with Moller-Trumbore test in float
+ * precision.
+ *
+ * The barycentric and distance limits are widened with a tolerance relative to the determinant and with
+ * absolute bounds of the float rounding errors, computed from the magnitudes of the edges, the direction
+ * and the ray origin. For grazing rays the determinant is small and it may be wrong even in its sign, so
+ * the triangles whose determinant is within its error bound are always candidates for the double test.
+ * The error bounds are estimated with a margin, not proven, so an intersection of the double test could
+ * still be missed for rays with coordinates many orders of magnitude larger than the packet.
+ */
+int TrianglePacket::Intersect( const Ray& objectRay, double tMax ) const
+{
+	//The ray origin is moved next to the packet to keep the float coordinates small
+	double directionLength2 = objectRay.direction().lengthSquared();
+	double tCenter = DotProduct( m_center - objectRay.origin, objectRay.direction() ) / directionLength2;
+	double tTolerance = m_tolerance / sqrt( directionLength2 );
+	Vector3D origin( objectRay( tCenter ) - m_center );
+
+	const PacketFloat ox = Set( float( origin.x ) );
+	const PacketFloat oy = Set( float( origin.y ) );
+	const PacketFloat oz = Set( float( origin.z ) );
+	const PacketFloat dx = Set( float( objectRay.direction().x ) );
+	const PacketFloat dy = Set( float( objectRay.direction().y ) );
+	const PacketFloat dz = Set( float( objectRay.direction().z ) );
+
+	double tLowerValue = objectRay.mint - tCenter - tTolerance;
+	double tUpperValue = tMax - tCenter + tTolerance;
+	const PacketFloat tLower = Set( float( tLowerValue ) );
+	const PacketFloat tUpper = Set( float( tUpperValue ) );
+	const PacketFloat lowerLimit = Set( -0.001f );
+	const PacketFloat upperLimit = Set( 1.001f );
+
+	//Absolute errors of the scaled values, from the magnitudes of the factors of each product
+	double directionLength = sqrt( directionLength2 );
+	double originDistance = origin.length() + m_vertexDistance;
+	double detError = FloatError * m_edgeLength * m_edgeLength * directionLength;
+	double uvError = FloatError * originDistance * directionLength * m_edgeLength;
+	double tError = FloatError * originDistance * m_edgeLength * m_edgeLength;
+	const PacketFloat determinantError = Set( float( detError ) );
+	const PacketFloat barycentricError = Set( float( uvError ) );
+	const PacketFloat sumError = Set( float( 2.0 * uvError + detError ) );
+	const PacketFloat tLowerError = Set( float( tError + fabs( tLowerValue ) * detError ) );
+	const PacketFloat tUpperError = Set( float( tError + fabs( tUpperValue ) * detError ) );
+
+	int mask = 0;
+	for( int lane = 0; lane < Size; lane += PacketWidth )
+	{
+		PacketFloat e1x = Load( m_e1x + lane );
+		PacketFloat e1y = Load( m_e1y + lane );
+		PacketFloat e1z = Load( m_e1z + lane );
+		PacketFloat e2x = Load( m_e2x + lane );
+		PacketFloat e2y = Load( m_e2y + lane );
+		PacketFloat e2z = Load( m_e2z + lane );
+
+		//p = d x e2
+		PacketFloat px = Sub( Mul( dy, e2z ), Mul( dz, e2y ) );
+		PacketFloat py = Sub( Mul( dz, e2x ), Mul( dx, e2z ) );
+		PacketFloat pz = Sub( Mul( dx, e2y ), Mul( dy, e2x ) );
+		PacketFloat det = Add( Add( Mul( e1x, px ), Mul( e1y, py ) ), Mul( e1z, pz ) );
+		PacketFloat detSign = SignOf( det );
+		PacketFloat absDet = Abs( det );
+
+		//s = o - v1, q = s x e1
+		PacketFloat sx = Sub( ox, Load( m_v1x + lane ) );
+		PacketFloat sy = Sub( oy, Load( m_v1y + lane ) );
+		PacketFloat sz = Sub( oz, Load( m_v1z + lane ) );
+		PacketFloat qx = Sub( Mul( sy, e1z ), Mul( sz, e1y ) );
+		PacketFloat qy = Sub( Mul( sz, e1x ), Mul( sx, e1z ) );
+		PacketFloat qz = Sub( Mul( sx, e1y ), Mul( sy, e1x ) );
+
+		//Barycentric coordinates and distance scaled with |det|
+		PacketFloat u = Xor( Add( Add( Mul( sx, px ), Mul( sy, py ) ), Mul( sz, pz ) ), detSign );
+		PacketFloat v = Xor( Add( Add( Mul( dx, qx ), Mul( dy, qy ) ), Mul( dz, qz ) ), detSign );
+		PacketFloat t = Xor( Add( Add( Mul( e2x, qx ), Mul( e2y, qy ) ), Mul( e2z, qz ) ), detSign );
+
+		PacketFloat isCandidate = LessEqual( Sub( Mul( lowerLimit, absDet ), barycentricError ), u );
+		isCandidate = And( isCandidate, LessEqual( Sub( Mul( lowerLimit, absDet ), barycentricError ), v ) );
+		isCandidate = And( isCandidate, LessEqual( Add( u, v ), Add( Mul( upperLimit, absDet ), sumError ) ) );
+		isCandidate = And( isCandidate, LessEqual( Sub( Mul( tLower, absDet ), tLowerError ), t ) );
+		isCandidate = And( isCandidate, LessEqual( t, Add( Mul( tUpper, absDet ), tUpperError ) ) );
+		isCandidate = Or( isCandidate, LessEqual( absDet, determinantError ) );
+
+		mask |= Mask( isCandidate ) << lane;
+	}
+
+	return ( mask & ( ( 1 << m_nTriangles ) - 1 ) );
+}
@@ -0,0 +1,94 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef TRIANGLEPACKET_H_
+#define TRIANGLEPACKET_H_
+
+#include "Point3D.h"
+
+class Ray;
+class Triangle;
+
+/*! *****************************
+ * class TrianglePacket
+ *
+ * The packet stores up to TrianglePacket::Size triangles of a BVH leaf as structure of arrays of floats, so
+ * a ray is tested against all of them at once with SSE or AVX instructions. The float test is a conservative
+ * prefilter: its limits are widened with bounds of the float errors, so it returns as candidates the triangles
+ * that the ray could intersect, and the final intersection is computed in double precision with Triangle::Intersect.
+ * **************************** */
+class TrianglePacket
+{
+
+public:
+#if defined( __AVX__ )
+	static const int Size = 8;
+#else
+	static const int Size = 4;
+#endif
+
+	TrianglePacket( Triangle* const* triangles, int nTriangles );
+
+	int GetNumberOfTriangles() const { return ( m_nTriangles ); };
+	Triangle* GetTriangle( int index ) const { return ( m_triangles[index] ); };
+
+	int Intersect( const Ray& objectRay, double tMax ) const;
+
+private:
+	Point3D m_center;
+	double m_tolerance;
+	double m_edgeLength;
+	double m_vertexDistance;
+
+	//Vertex and edges of each triangle relative to the packet center
+	float m_v1x[Size];
+	float m_v1y[Size];
+	float m_v1z[Size];
+	float m_e1x[Size];
+	float m_e1y[Size];
+	float m_e1z[Size];
+	float m_e2x[Size];
+	float m_e2y[Size];
+	float m_e2z[Size];
+
+	Triangle* m_triangles[Size];
+	int m_nTriangles;
+};
+
+
+#endif /* TRIANGLEPACKET_H_ */
@@ -117,6 +117,15 @@ QString ShapeCone::GetIcon() const
 }
 
 bool ShapeCone::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
+
+bool ShapeCone::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
 {
 	// Compute quadratic ShapeCone coefficients
 	double theta = atan2( height.getValue(), ( baseRadius.getValue() - topRadius.getValue() ) );
@@ -167,13 +176,16 @@ bool ShapeCone::Intersect( const Ray& objectRay, double* tHit, DifferentialGeome
 		phi = atan2( hitPoint.x, hitPoint.z );
 		if ( hitPoint.y < 0 || hitPoint.y > height.getValue() || phi > phiMax.getValue() ) return false;
 	}
-	// Now check if the function is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) )	gf::SevereError( "Function Cylinder::Intersect(...) called with null pointers" );
 
+	hit->tHit = thit;
+	return true;
+}
+
+void ShapeCone::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
 	// Compute definitive ShapeCone hit position and $\phi$
-    hitPoint = objectRay( thit );
+	Point3D hitPoint = objectRay( hit.tHit );
+	double phi = atan2( hitPoint.x, hitPoint.z );
 
 	// Find parametric representation of ShapeCone hit
 	double u = phi / phiMax.getValue();
@@ -192,37 +204,10 @@ bool ShapeCone::Intersect( const Ray& objectRay, double* tHit, DifferentialGeome
 					-height.getValue()* cos( phiMax.getValue()* u )
 							 / tan ( atan2( height.getValue(), ( baseRadius.getValue() - topRadius.getValue() ) ) ) );
 
-	// Compute ShapeCone \dndu and \dndv
-
-	Vector3D d2Pduu( -phiMax.getValue() * phiMax.getValue() * ( baseRadius.getValue() - baseRadius.getValue() * v + topRadius.getValue() * v )
-			* sin( phiMax.getValue() * u ),
-	   0.0,
-	   -phiMax.getValue() * phiMax.getValue() * ( baseRadius.getValue() - baseRadius.getValue() * v + topRadius.getValue() * v )
-		   * cos( phiMax.getValue() * u ) );
-
-	Vector3D d2Pduv( phiMax.getValue() * ( -baseRadius.getValue() + topRadius.getValue() ) * cos( phiMax.getValue() * u ),
-			0.0,
-			phiMax.getValue() * ( baseRadius.getValue() - topRadius.getValue() ) * sin( phiMax.getValue()* u ) );
-
-	Vector3D d2Pdvv( 0.0, 0.0, 0.0 );
-
-	// Compute coefficients for fundamental forms
-	double E = DotProduct( dpdu, dpdu );
-	double F = DotProduct( dpdu, dpdv );
-	double G = DotProduct( dpdv, dpdv );
-
 	Vector3D N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
 
-	double e = DotProduct( N, d2Pduu );
-	double f = DotProduct( N, d2Pduv );
-	double g = DotProduct( N, d2Pdvv );
-
-	// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / (E*G - F*F);
-	Vector3D dndu = (f*F - e*G) * invEGF2 * dpdu +
-			        (e*F - f*E) * invEGF2 * dpdv;
-	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
-	                (f*F - g*E) * invEGF2 * dpdv;
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry( hitPoint ,
@@ -232,16 +217,12 @@ bool ShapeCone::Intersect( const Ray& objectRay, double* tHit, DifferentialGeome
 								dndv,
 		                        u, v, this );
 	dg->shapeFrontSide = ( DotProduct( N, objectRay.direction() ) > 0 ) ? false : true;
-
-    // Update _tHit_ for quadric intersection
-    *tHit = thit;
-
-	return true;
 }
 
 bool ShapeCone::IntersectP( const Ray& worldRay ) const
 {
-	return Intersect( worldRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( worldRay, &hit );
 }
 
 Point3D ShapeCone::Sample( double u, double v ) const
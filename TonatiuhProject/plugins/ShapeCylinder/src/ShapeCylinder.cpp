@@ -112,6 +112,15 @@ QString ShapeCylinder::GetIcon() const
 }
 
 bool ShapeCylinder::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
+
+bool ShapeCylinder::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
 {
 	// Compute quadratic cylinder coefficients
 	Vector3D vObjectRayOrigin = Vector3D( objectRay.origin );
@@ -151,12 +160,17 @@ bool ShapeCylinder::Intersect( const Ray& objectRay, double* tHit, DifferentialG
 		if ( phi < 0. ) phi += gc::TwoPi;
 		if ( (thit - objectRay.mint) < tol  || hitPoint.z < zmin || hitPoint.z > zmax || phi > phiMax.getValue() ) return false;
 	}
-	// Now check if the fucntion is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) )
-		gf::SevereError( "Function Cylinder::Intersect(...) called with null pointers" );
 
+	hit->tHit = thit;
+	return true;
+}
+
+void ShapeCylinder::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	// Compute cylinder hit position and $\phi
+	Point3D hitPoint = objectRay( hit.tHit );
+	double phi = atan2( hitPoint.y, hitPoint.x );
+	if ( phi < 0. ) phi += gc::TwoPi;
 
 	// Find parametric representation of Cylinder hit
 	double u = phi / phiMax.getValue();
@@ -171,31 +185,10 @@ bool ShapeCylinder::Intersect( const Ray& objectRay, double* tHit, DifferentialG
 						0.0 );
 	Vector3D dpdv( 0.0, 0.0, length.getValue() );
 
-	// Compute cylinder \dndu and \dndv
-	Vector3D d2Pduu( -phiMax.getValue() * phiMax.getValue() * radius.getValue()
-							* cos( phiMax.getValue() * u ),
-						-phiMax.getValue() * phiMax.getValue() * radius.getValue()
-							* sin( phiMax.getValue() * u ),
-						0.0 );
-	Vector3D d2Pduv( 0.0, 0.0, 0.0 );
-	Vector3D d2Pdvv( 0.0, 0.0, 0.0 );
-
-	// Compute coefficients for fundamental forms
-	double E = DotProduct( dpdu, dpdu );
-	double F = DotProduct( dpdu, dpdv );
-	double G = DotProduct( dpdv, dpdv );
 	Vector3D N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
 
-	double e = DotProduct( N, d2Pduu );
-	double f = DotProduct( N, d2Pduv );
-	double g = DotProduct( N, d2Pdvv );
-
-		// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / (E*G - F*F);
-	Vector3D dndu = (f*F - e*G) * invEGF2 * dpdu +
-			        (e*F - f*E) * invEGF2 * dpdv;
-	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
-	                (f*F - g*E) * invEGF2 * dpdv;
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry( hitPoint ,
@@ -205,16 +198,12 @@ bool ShapeCylinder::Intersect( const Ray& objectRay, double* tHit, DifferentialG
 								dndv,
 		                        u, v, this );
 	dg->shapeFrontSide = ( DotProduct( N, objectRay.direction() ) > 0 ) ? false : true;
-
-    // Update _tHit_ for quadric intersection
-    *tHit = thit;
-
-	return true;
 }
 
 bool ShapeCylinder::IntersectP( const Ray& worldRay ) const
 {
-	return Intersect( worldRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( worldRay, &hit );
 }
 
 Point3D ShapeCylinder::Sample( double u, double v ) const
@@ -96,7 +96,16 @@ QString ShapeFlatDisk::GetIcon() const
 	return ":/icons/ShapeFlatDisk.png";
 }
 
-bool ShapeFlatDisk::Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg) const
+bool ShapeFlatDisk::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
+
+bool ShapeFlatDisk::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
 {
 	// Solve equation for _t_ value
 	if ( ( objectRay.origin.y == 0 ) && ( objectRay.direction().y == 0 ) ) return false;
@@ -114,10 +123,14 @@ bool ShapeFlatDisk::Intersect(const Ray& objectRay, double *tHit, DifferentialGe
 	// Test intersection against clipping parameters
 	if( sqrt(hitPoint.x*hitPoint.x + hitPoint.z*hitPoint.z) > radius.getValue()) return false;
 
-	// Now check if the fucntion is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) ) gf::SevereError( "Function Sphere::Intersect(...) called with null pointers" );
+	hit->tHit = t;
+	return true;
+}
+
+void ShapeFlatDisk::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	// Compute disk hit position
+	Point3D hitPoint = objectRay( hit.tHit );
 
 	// Find parametric representation of the rectangle hit point
 	double phi = atan2( hitPoint.z, hitPoint.x );
@@ -146,16 +159,12 @@ bool ShapeFlatDisk::Intersect(const Ray& objectRay, double *tHit, DifferentialGe
 		                        u, v, this );
 
 	dg->shapeFrontSide = ( DotProduct( N, objectRay.direction() ) > 0 ) ? false : true;
-
-    // Update _tHit_ for quadric intersection
-    *tHit = t;
-
-	return true;
 }
 
 bool ShapeFlatDisk::IntersectP( const Ray& objectRay ) const
 {
-	return Intersect( objectRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( objectRay, &hit );
 }
 
 Point3D ShapeFlatDisk::Sample( double u, double v ) const
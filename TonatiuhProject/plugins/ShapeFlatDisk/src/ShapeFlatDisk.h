@@ -60,6 +60,8 @@ public:
 	QString GetIcon() const;
 
 	bool Intersect(const Ray &ray, double *tHit, DifferentialGeometry *dg ) const;
+	bool IntersectT( const Ray& objectRay, ShapeHit* hit ) const;
+	void ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const;
 	bool IntersectP( const Ray &ray ) const;
 	Point3D Sample( double u, double v ) const;
 
@@ -97,7 +97,16 @@ QString ShapeFlatRectangle::GetIcon() const
 	return ":/icons/ShapeFlatRectangle.png";
 }
 
-bool ShapeFlatRectangle::Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg) const
+bool ShapeFlatRectangle::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
+
+bool ShapeFlatRectangle::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
 {
 	// Solve equation for _t_ value
 	if ( ( objectRay.origin.y == 0 ) && ( objectRay.direction().y == 0 ) ) return false;
@@ -116,11 +125,14 @@ bool ShapeFlatRectangle::Intersect(const Ray& objectRay, double *tHit, Different
 	// Test intersection against clipping parameters
 	if( hitPoint.x < -height.getValue()/2 || hitPoint.x > height.getValue()/2 || hitPoint.z < -width.getValue()/2 || hitPoint.z > width.getValue()/2 ) return false;
 
-	// Now check if the fucntion is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) ) gf::SevereError( "Function Sphere::Intersect(...) called with null pointers" );
+	hit->tHit = t;
+	return true;
+}
 
+void ShapeFlatRectangle::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	// Compute rectangle hit position
+	Point3D hitPoint = objectRay( hit.tHit );
 
 	// Find parametric representation of the rectangle hit point
 	double u = ( hitPoint.x + height.getValue()/2 ) / ( height.getValue() );
@@ -144,16 +156,12 @@ bool ShapeFlatRectangle::Intersect(const Ray& objectRay, double *tHit, Different
 								dndv,
 		                        u, v, this );
 	dg->shapeFrontSide = ( DotProduct( N, objectRay.direction() ) > 0 ) ? false : true;
-
-    // Update _tHit_ for quadric intersection
-    *tHit = t;
-
-	return true;
 }
 
 bool ShapeFlatRectangle::IntersectP( const Ray& objectRay ) const
 {
-	return Intersect( objectRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( objectRay, &hit );
 }
 
 Point3D ShapeFlatRectangle::Sample( double u, double v ) const
@@ -137,6 +137,15 @@ QString ShapeFlatTriangle::GetIcon() const
 }
 
 bool ShapeFlatTriangle::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
+
+bool ShapeFlatTriangle::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
 {
 
 	Vector3D vAB = Vector3D( b.getValue()[0], b.getValue()[1], b.getValue()[2] ) - Vector3D( a.getValue()[0], a.getValue()[1], a.getValue()[2] );
@@ -176,37 +185,36 @@ bool ShapeFlatTriangle::Intersect( const Ray& objectRay, double* tHit, Different
 	double v = ( uv * wu - uu * wv ) / D;
 	if( v < 0.0 || ( u + v) > 1.0)	return false;
 
-	// Now check if the function is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) ) gf::SevereError( "Function ShapeFlatTriangle::Intersect(...) called with null pointers" );
+	hit->tHit = thit;
+	return true;
+}
 
-	Vector3D dpdu = vAB;
-	Vector3D dpdv = vAC;
+void ShapeFlatTriangle::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	Point3D hitPoint = objectRay( hit.tHit );
 
-	// Compute ShapeCone \dndu and \dndv
-	Vector3D d2Pduu( 0.0, 0.0, 0.0 );
-	Vector3D d2Pduv( 0.0, 0.0, 0.0 );
-	Vector3D d2Pdvv( 0.0, 0.0, 0.0 );
+	Vector3D vAB = Vector3D( b.getValue()[0], b.getValue()[1], b.getValue()[2] ) - Vector3D( a.getValue()[0], a.getValue()[1], a.getValue()[2] );
+	Vector3D vAC = Vector3D( c.getValue()[0], c.getValue()[1], c.getValue()[2] ) - Vector3D( a.getValue()[0], a.getValue()[1], a.getValue()[2] );
 
-	// Compute coefficients for fundamental forms
-	double E = DotProduct( dpdu, dpdu );
-	double F = DotProduct( dpdu, dpdv );
-	double G = DotProduct( dpdv, dpdv );
+	// Compute the parametric coords of hitPoint
+	double uu = DotProduct( vAB, vAB );
+	double uv = DotProduct( vAB, vAC );
+	double vv = DotProduct( vAC, vAC );
+	Vector3D  w = Vector3D( hitPoint ) - Vector3D( a.getValue()[0], a.getValue()[1], a.getValue()[2] );
+	double wu = DotProduct( w, vAB );
+	double wv = DotProduct( w, vAC );
+	double D = uv * uv - uu * vv;
 
-	Vector3D N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
+	double u = (uv * wv - vv * wu) / D;
+	double v = ( uv * wu - uu * wv ) / D;
 
+	Vector3D dpdu = vAB;
+	Vector3D dpdv = vAC;
 
-	double e = DotProduct( N, d2Pduu );
-	double f = DotProduct( N, d2Pduv );
-	double g = DotProduct( N, d2Pdvv );
+	Vector3D N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
 
-	// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / (E*G - F*F);
-	Vector3D dndu = (f*F - e*G) * invEGF2 * dpdu +
-			        (e*F - f*E) * invEGF2 * dpdv;
-	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
-	                (f*F - g*E) * invEGF2 * dpdv;
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry( hitPoint ,
@@ -217,16 +225,12 @@ bool ShapeFlatTriangle::Intersect( const Ray& objectRay, double* tHit, Different
 		                        u, v, this );
 
 	dg->shapeFrontSide = ( DotProduct( N, objectRay.direction() ) > 0 ) ? false : true;
-
-    // Update _tHit_ for quadric intersection
-    *tHit = thit;
-
-	return true;
 }
 
 bool ShapeFlatTriangle::IntersectP( const Ray& worldRay ) const
 {
-	return Intersect( worldRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( worldRay, &hit );
 }
 
 Point3D ShapeFlatTriangle::Sample( double u, double v ) const
@@ -115,6 +115,15 @@ QString ShapeHyperboloid::GetIcon() const
 }
 
 bool ShapeHyperboloid::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
+
+bool ShapeHyperboloid::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
 {
 	double xo= objectRay.origin.x;
 	double yo= objectRay.origin.y;
@@ -169,10 +178,16 @@ bool ShapeHyperboloid::Intersect( const Ray& objectRay, double* tHit, Differenti
 		yradius = sqrt(hitPoint.x * hitPoint.x + hitPoint.z * hitPoint.z);
 		if( hitPoint.y < ymin || hitPoint.y > ymax ||  yradius > r ) return false;
 	}
-	// Now check if the fucntion is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) ) gf::SevereError( "Function Cylinder::Intersect(...) called with null pointers" );
+
+	hit->tHit = thit;
+	return true;
+}
+
+void ShapeHyperboloid::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	// Compute hyperbola hit position
+	Point3D hitPoint = objectRay( hit.tHit );
+	double yradius = sqrt(hitPoint.x * hitPoint.x + hitPoint.z * hitPoint.z);
 
 	// Find parametric representation of hyperbola hit
 	double u = yradius / ( reflectorMaxDiameter.getValue() / 2 );
@@ -184,37 +199,10 @@ bool ShapeHyperboloid::Intersect( const Ray& objectRay, double* tHit, Differenti
 	Vector3D dpdu = Dpdu( u, v );
 	Vector3D dpdv = Dpdv( u, v );
 
-	// Compute cylinder \dndu and \dndv
-	Vector3D d2Pduu( 0.0,
-					(2 * pow( aConic, 4) * pow( bConic, 4 ) *  reflectorMaxDiameter.getValue() *  reflectorMaxDiameter.getValue() )
-					/ ( pow( aConic, 2 )* pow( bConic, 2)
-							* pow( 4 *  bConic * bConic + reflectorMaxDiameter.getValue() * reflectorMaxDiameter.getValue() * u * u , 3 / 2.0 ) ),
-					0.0 );
-
-	Vector3D d2Pduv( - reflectorMaxDiameter.getValue() *gc::Pi * sin( gc::TwoPi * v ),
-					0.0,
-					reflectorMaxDiameter.getValue() *gc::Pi * cos( gc::TwoPi * v ) );
-	Vector3D d2Pdvv( -2.0 * reflectorMaxDiameter.getValue() * gc::Pi * gc::Pi * u * cos( gc::TwoPi * v),
-					0.0,
-					-2.0 * reflectorMaxDiameter.getValue() * gc::Pi * gc::Pi * u * sin( gc::TwoPi * v ) );
-
-	// Compute coefficients for fundamental forms
-	double E = DotProduct( dpdu, dpdu );
-	double F = DotProduct( dpdu, dpdv );
-	double G = DotProduct( dpdv, dpdv );
-
 	Vector3D N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
 
-	double e = DotProduct( N, d2Pduu );
-	double f = DotProduct( N, d2Pduv );
-	double g = DotProduct( N, d2Pdvv );
-
-		// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / (E*G - F*F);
-	Vector3D dndu = (f*F - e*G) * invEGF2 * dpdu +
-					(e*F - f*E) * invEGF2 * dpdv;
-	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
-					(f*F - g*E) * invEGF2 * dpdv;
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry( hitPoint ,
@@ -224,17 +212,12 @@ bool ShapeHyperboloid::Intersect( const Ray& objectRay, double* tHit, Differenti
 								dndv,
 								u, v, this );
 	dg->shapeFrontSide = ( DotProduct( N, objectRay.direction() ) > 0 ) ? false : true;
-
-	// Update _tHit_ for quadric intersection
-	*tHit = thit;
-
-	return true;
-
 }
 
 bool ShapeHyperboloid::IntersectP( const Ray& worldRay ) const
 {
-	return Intersect( worldRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( worldRay, &hit );
 }
 
 Point3D ShapeHyperboloid::Sample( double u, double v ) const
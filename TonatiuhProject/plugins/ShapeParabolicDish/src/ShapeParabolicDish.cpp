@@ -120,7 +120,16 @@ QString ShapeParabolicDish::GetIcon() const
 	return ":/icons/ShapeParabolicDish.png";
 }
 
-bool ShapeParabolicDish::Intersect(const Ray& objectRay, double* tHit, DifferentialGeometry* dg) const
+bool ShapeParabolicDish::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
+
+bool ShapeParabolicDish::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
 {
 	double pMax = phiMax.getValue();
 	double A = objectRay.direction().x*objectRay.direction().x + objectRay.direction().z * objectRay.direction().z;
@@ -165,12 +174,22 @@ bool ShapeParabolicDish::Intersect(const Ray& objectRay, double* tHit, Different
 			if( (thit - objectRay.mint) < tol ||  radius < dishMinRadius.getValue() || radius > dishMaxRadius.getValue() || phi > pMax ) return false;
 		}
 
-	// Now check if the function is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) ) gf::SevereError( "Function ParabolicCyl::Intersect(...) called with null pointers" );
+	hit->tHit = thit;
+	return true;
+}
+
+void ShapeParabolicDish::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	double pMax = phiMax.getValue();
+
+	// Compute hit position
+	Point3D hitPoint = objectRay( hit.tHit );
 
-///////////////////////////////////////////////////////////////////////////////////////
+	double radius = sqrt(hitPoint.x*hitPoint.x + hitPoint.z*hitPoint.z) ;
+    double phi;
+    if( ( hitPoint.z == 0.0 ) &&( hitPoint.x ==0.0 ) ) phi = 0.0;
+    else if( hitPoint.x > 0 ) phi = atan2( hitPoint.x, hitPoint.z );
+    else phi = gc::TwoPi + atan2( hitPoint.x, hitPoint.z );
 
 	// Find parametric representation of paraboloid hit
 	double u = phi / pMax;
@@ -188,33 +207,10 @@ bool ShapeParabolicDish::Intersect(const Ray& objectRay, double* tHit, Different
 					( dishMaxRadius.getValue() - dishMinRadius.getValue() ) * cos( pMax * u ) );
 
 
-	// Compute Circular Parabolic Facet \dndu and \dndv
-	Vector3D d2Pduu ( -pMax * pMax * r * sin( pMax * u ),
-			0.0,
-			-pMax* pMax * r * cos( pMax * u ) );
-	Vector3D d2Pduv ( pMax* ( dishMaxRadius.getValue()- dishMinRadius.getValue() ) * cos( pMax * u ),
-					0.0,
-					-pMax * ( dishMaxRadius.getValue()- dishMinRadius.getValue() ) * sin( pMax * u ) );
-	Vector3D d2Pdvv (0, ( ( dishMaxRadius.getValue()- dishMinRadius.getValue() ) * ( dishMaxRadius.getValue()- dishMinRadius.getValue() ) ) /(2 * focusLength.getValue() ), 0 );
-
-
-	// Compute coefficients for fundamental forms
-	double E = DotProduct(dpdu, dpdu);
-	double F = DotProduct(dpdu, dpdv);
-	double G = DotProduct(dpdv, dpdv);
-
 	Vector3D N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
 
-	double e = DotProduct(N, d2Pduu);
-	double f = DotProduct(N, d2Pduv);
-	double g = DotProduct(N, d2Pdvv);
-
-	// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / (E*G - F*F);
-	Vector3D dndu = (f*F - e*G) * invEGF2 * dpdu +
-		(e*F - f*E) * invEGF2 * dpdv;
-	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
-		(f*F - g*E) * invEGF2 * dpdv;
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry(hitPoint,
@@ -224,19 +220,12 @@ bool ShapeParabolicDish::Intersect(const Ray& objectRay, double* tHit, Different
 							   dndv,
 	                           u, v, this);
 	dg->shapeFrontSide = ( DotProduct( N, objectRay.direction() ) > 0 ) ? false : true;
-
-
-///////////////////////////////////////////////////////////////////////////////////////
-
-	// Update _tHit_ for quadric intersection
-	*tHit = thit;
-
-	return true;
 }
 
 bool ShapeParabolicDish::IntersectP( const Ray& worldRay ) const
 {
-	return Intersect( worldRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( worldRay, &hit );
 }
 
 Point3D ShapeParabolicDish::Sample( double u, double v ) const
@@ -104,7 +104,16 @@ QString ShapeParabolicRectangle::GetIcon() const
 	return ":/icons/ShapeParabolicRectangle.png";
 }
 
-bool ShapeParabolicRectangle::Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg) const
+bool ShapeParabolicRectangle::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
+
+bool ShapeParabolicRectangle::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
 {
 	double focus = focusLength.getValue();
 	double wX = widthX.getValue();
@@ -144,14 +153,18 @@ bool ShapeParabolicRectangle::Intersect(const Ray& objectRay, double *tHit, Diff
 
 	}
 
-    // Now check if the function is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) )	gf::SevereError( "Function ParabolicCyl::Intersect(...) called with null pointers" );
+	hit->tHit = thit;
+	return true;
+}
 
-///////////////////////////////////////////////////////////////////////////////////////
+void ShapeParabolicRectangle::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	double focus = focusLength.getValue();
+	double wX = widthX.getValue();
+	double wZ = widthZ.getValue();
 
-	// Compute possible parabola hit position
+	// Compute parabola hit position
+	Point3D hitPoint = objectRay( hit.tHit );
 
 	// Find parametric representation of paraboloid hit
 	double u =  ( hitPoint.x  / wX ) + 0.5;
@@ -160,28 +173,10 @@ bool ShapeParabolicRectangle::Intersect(const Ray& objectRay, double *tHit, Diff
 	Vector3D dpdu( wX, ( (-0.5 + u) * wX *  wX ) / ( 2 * focus ), 0 );
 	Vector3D dpdv( 0.0, (( -0.5 + v) * wZ *  wZ ) /( 2 * focus ), wZ );
 
-	// Compute parabaloid \dndu and \dndv
-	Vector3D d2Pduu( 0.0,  (wX *  wX ) /( 2 * focus ), 0.0 );
-	Vector3D d2Pduv( 0.0, 0.0, 0.0 );
-	Vector3D d2Pdvv( 0.0,  (wZ *  wZ ) /( 2 * focus ), 0.0 );
-
-	// Compute coefficients for fundamental forms
-	double E = DotProduct(dpdu, dpdu);
-	double F = DotProduct(dpdu, dpdv);
-	double G = DotProduct(dpdv, dpdv);
-
 	NormalVector N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
 
-	double e = DotProduct(N, d2Pduu);
-	double f = DotProduct(N, d2Pduv);
-	double g = DotProduct(N, d2Pdvv);
-
-	// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / (E*G - F*F);
-	Vector3D dndu = (f*F - e*G) * invEGF2 * dpdu +
-		(e*F - f*E) * invEGF2 * dpdv;
-	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
-		(f*F - g*E) * invEGF2 * dpdv;
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry(hitPoint,
@@ -191,18 +186,12 @@ bool ShapeParabolicRectangle::Intersect(const Ray& objectRay, double *tHit, Diff
 							   dndv,
 							   u, v, this);
 	dg->shapeFrontSide = ( DotProduct( N, objectRay.direction() ) > 0 ) ? false : true;
-
-
-///////////////////////////////////////////////////////////////////////////////////////
-
-	// Update _tHit_ for quadric intersection
-	*tHit = thit;
-	return true;
 }
 
 bool ShapeParabolicRectangle::IntersectP( const Ray& objectRay ) const
 {
-	return Intersect( objectRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( objectRay, &hit );
 }
 
 Point3D ShapeParabolicRectangle::Sample( double u, double v ) const
@@ -130,6 +130,15 @@ QString ShapeSphericalPolygon::GetIcon() const
 }
 
 bool ShapeSphericalPolygon::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
+
+bool ShapeSphericalPolygon::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
 {
 	double A = objectRay.direction().lengthSquared();
 	double B = 2.0 * ( objectRay.origin.x *  objectRay.direction().x
@@ -204,10 +213,29 @@ bool ShapeSphericalPolygon::Intersect( const Ray& objectRay, double* tHit, Diffe
 		if( (thit - objectRay.mint) < tol || zRadius > radius.getValue() || Vector3D( hitPoint).length() > tPoint.length() )	return false;
 	}
 
-	// Now check if the fucntion is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) ) gf::SevereError( "Function ShapeSphere::Intersect(...) called with null pointers" );
+	hit->tHit = thit;
+	return true;
+}
+
+void ShapeSphericalPolygon::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	// Compute hit position and $\phi$
+	Point3D hitPoint = objectRay( hit.tHit );
+	double phi = atan2( hitPoint.x, hitPoint.y );
+	if( phi < 0.0 )	phi += gc::TwoPi;
+
+	// Find parametric representation of the hit from the polygon side point with the same $\phi$
+	double u = phi / gc::TwoPi;
+	double centralAngle = gc::TwoPi / polygonSides.getValue();
+
+	double part  =  floor( phi / centralAngle );
+	if( fabs( u - 1.0 ) < gc::Epsilon ) 	part = polygonSides.getValue() - 1;
+
+	double t2 = radius.getValue() * cos( 0.5 * centralAngle  )
+							* ( 1 / cos( 0.5 * centralAngle  - phi + centralAngle * part ) );
+	double x = sin( phi ) * t2;
+	double y = cos( phi )* t2;
+	Vector3D tPoint = Vector3D( x, y,  sphereRadius.getValue()- sqrt( sphereRadius.getValue() * sphereRadius.getValue() - x * x - y * y  ) );
 
 	double v = Vector3D( hitPoint).length()/ tPoint.length();
 
@@ -223,35 +251,10 @@ bool ShapeSphericalPolygon::Intersect( const Ray& objectRay, double* tHit, Diffe
 					radius.getValue() * thetaMax * cos( phi ) * cos( theta ),
 					radius.getValue() * thetaMax * sin( theta ) );
 
-	Vector3D d2Pduu( -4  * gc::Pi * gc::Pi * radius.getValue() * sin( phi ) * sin( theta ),
-					 -4  * gc::Pi * gc::Pi * radius.getValue() * cos( phi ) * sin( theta ),
-					 0.0 );
-	Vector3D d2Pduv( gc::TwoPi * radius.getValue() * thetaMax * cos( phi ) * cos( theta ),
-					- gc::TwoPi * radius.getValue() * thetaMax * sin( phi ) * cos( theta ),
-						 0.0 );
-
-	Vector3D d2Pdvv( -radius.getValue() * thetaMax * thetaMax * sin( phi )* sin( theta ),
-			-radius.getValue() * thetaMax * thetaMax * cos( phi )* sin( theta ),
-			radius.getValue() * thetaMax * thetaMax * cos( theta ) );
-
-
-	// Compute coefficients for fundamental forms
-	double E = DotProduct( dpdu, dpdu );
-	double F = DotProduct( dpdu, dpdv );
-	double G = DotProduct( dpdv, dpdv );
-
 	Vector3D N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
 
-	double e = DotProduct( N, d2Pduu );
-	double f = DotProduct( N, d2Pduv );
-	double g = DotProduct( N, d2Pdvv );
-
-		// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / (E*G - F*F);
-	Vector3D dndu = (f*F - e*G) * invEGF2 * dpdu +
-					(e*F - f*E) * invEGF2 * dpdv;
-	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
-					(f*F - g*E) * invEGF2 * dpdv;
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry( hitPoint ,
@@ -262,15 +265,12 @@ bool ShapeSphericalPolygon::Intersect( const Ray& objectRay, double* tHit, Diffe
 								u, v, this );
 
 	dg->shapeFrontSide = ( DotProduct( N, objectRay.direction() ) > 0 ) ? false : true;
-	// Update _tHit_ for quadric intersection
-	*tHit = thit;
-
-	return true;
 }
 
 bool ShapeSphericalPolygon::IntersectP( const Ray& worldRay ) const
 {
-	return Intersect( worldRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( worldRay, &hit );
 }
 
 Point3D ShapeSphericalPolygon::Sample( double u, double v) const
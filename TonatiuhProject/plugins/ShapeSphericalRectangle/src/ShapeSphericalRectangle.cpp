@@ -124,7 +124,16 @@ QString ShapeSphericalRectangle::GetIcon() const
 	return ":/icons/ShapeSphericalRectangle.png";
 }
 
-bool ShapeSphericalRectangle::Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg) const
+bool ShapeSphericalRectangle::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
+
+bool ShapeSphericalRectangle::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
 {
 	double r = radius.getValue();
 	double wX = widthX.getValue();
@@ -178,57 +187,29 @@ bool ShapeSphericalRectangle::Intersect(const Ray& objectRay, double *tHit, Diff
 
 	}
 
-    // Now check if the function is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) )	gf::SevereError( "Function ShapeSphericalRectangle::Intersect(...) called with null pointers" );
+	hit->tHit = thit;
+	return true;
+}
+
+void ShapeSphericalRectangle::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	double wX = widthX.getValue();
+	double wZ = widthZ.getValue();
 
-///////////////////////////////////////////////////////////////////////////////////////
-	// Compute possible parabola hit position
+	// Compute hit position
+	Point3D hitPoint = objectRay( hit.tHit );
 
-	// Find parametric representation of paraboloid hit
+	// Find parametric representation of hit
 	double u =  ( hitPoint.x  / wX ) + 0.5;
 	double v =  ( hitPoint.z  / wZ ) + 0.5;
 
-	double aux = r * r
-			- (-0.5 + u) * (-0.5 + u) * wX *wX
-			- (-0.5 + v) * (-0.5 + v) * wZ *wZ;
 	Vector3D dpdu = GetDPDU( u, v );
 	Vector3D dpdv = GetDPDV( u, v );
 
-	// Compute parabaloid \dndu and \dndv
-
-	Vector3D d2Pduu( 0.0,
-			( ( (-0.5 + u) * (-0.5 + u) * wX *  wX * wX *  wX ) / sqrt( aux * aux * aux ) )
-				+ ( ( wX *  wX )  / sqrt( aux ) ),
-			0.0 );
-
-	Vector3D d2Pduv( 0.0,
-			( (-0.5 + u) * (-0.5 + v ) * wX *  wX * wZ *  wZ  )
-				/ sqrt( aux * aux * aux ),
-			0.0 );
-	Vector3D d2Pdvv( 0.0,
-				( ( (-0.5 + u) * (-0.5 + u) * wZ *  wZ * wZ *  wZ ) / sqrt( aux * aux * aux ) )
-					+ ( ( wZ *  wZ )  / sqrt( aux ) ),
-				0.0 );
-
-	// Compute coefficients for fundamental forms
-	double E = DotProduct(dpdu, dpdu);
-	double F = DotProduct(dpdu, dpdv);
-	double G = DotProduct(dpdv, dpdv);
-
 	NormalVector N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
 
-	double e = DotProduct(N, d2Pduu);
-	double f = DotProduct(N, d2Pduv);
-	double g = DotProduct(N, d2Pdvv);
-
-	// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / (E*G - F*F);
-	Vector3D dndu = (f*F - e*G) * invEGF2 * dpdu +
-		(e*F - f*E) * invEGF2 * dpdv;
-	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
-		(f*F - g*E) * invEGF2 * dpdv;
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry(hitPoint,
@@ -238,18 +219,12 @@ bool ShapeSphericalRectangle::Intersect(const Ray& objectRay, double *tHit, Diff
 							   dndv,
 							   u, v, this);
 	dg->shapeFrontSide = ( DotProduct( N, objectRay.direction() ) > 0 ) ? false : true;
-
-
-///////////////////////////////////////////////////////////////////////////////////////
-
-	// Update _tHit_ for quadric intersection
-	*tHit = thit;
-	return true;
 }
 
 bool ShapeSphericalRectangle::IntersectP( const Ray& objectRay ) const
 {
-	return Intersect( objectRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( objectRay, &hit );
 }
 
 Point3D ShapeSphericalRectangle::Sample( double u, double v ) const
@@ -37,12 +37,9 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 ***************************************************************************/
 
 #include <algorithm>
-#include <iomanip>
-#include <map>
 #include <vector>
 
 #include <QIcon>
-#include <QMap>
 #include <QMessageBox>
 
 #include <Inventor/SoPrimitiveVertex.h>
@@ -58,10 +55,8 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "DifferentialGeometry.h"
 #include "ShapeTroughAsymmetricCPC.h"
 
-double fPart( double alpha, double x, double r1, double theta, double r, double eccentricity )
-{
-	return -r1 + sin( alpha - theta ) * ( r/ ( 1 - eccentricity * cos( alpha ) ) ) - x ;
-}
+//Number of profile segments used to bracket the ray intersections.
+const int profileSegments = 200;
 
 SO_NODE_SOURCE(ShapeTroughAsymmetricCPC);
 
@@ -141,67 +136,97 @@ double ShapeTroughAsymmetricCPC::GetVolume() const
 	return 0.0;
 }
 
-bool ShapeTroughAsymmetricCPC::Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg) const
+bool ShapeTroughAsymmetricCPC::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
+
+bool ShapeTroughAsymmetricCPC::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
 {
-	std::vector<double> roots = FindRoots( objectRay );
-	if ( roots.size() == 0 ) return false;
-	std::vector<double> tHits = FindThits( objectRay , roots );
-	QMap<double,double> intersectionsMap;
-	for ( unsigned int i = 0; i < roots.size(); i++)
-		intersectionsMap.insert( tHits[ i ] , roots[ i ] );
+	return IntersectProfile( objectRay, &hit->tHit, &hit->parameter );
+}
+
+/*!
+ * Computes the distance \a tHit and the profile angle \a thetaHit of the closest intersection of \a objectRay with the concentrator.
+ * Returns false if the ray does not intersect the concentrator.
+ */
+bool ShapeTroughAsymmetricCPC::IntersectProfile( const Ray& objectRay, double* tHit, double* thetaHit ) const
+{
+	double ox = objectRay.origin.x;
+	double oy = objectRay.origin.y;
+	double dx = objectRay.direction().x;
+	double dy = objectRay.direction().y;
 
-	std::sort( tHits.begin(), tHits.end() );
+	// Rays parallel to the trough axis never cross the profile
+	if( ( dx == 0.0 ) && ( dy == 0.0 ) ) return false;
 
-	//For each tHit check tolerance and ray limits.
+	//For each profile root check tolerance and ray limits.
 	double tol = 0.00001;
-	unsigned int i = 0;
 	bool valid = false;
-	Point3D hitPoint;
-	double thit;
-	while(  ( i < tHits.size() ) && !valid )
+	double thit = 0.0;
+	double theta = 0.0;
+
+	double deviation0 = ( m_profileX[0] - ox ) * dy - ( m_profileY[0] - oy ) * dx;
+	double slope0 = m_profileDXDTheta[0] * dy - m_profileDYDTheta[0] * dx;
+	for( int i = 1; i <= profileSegments; ++i )
 	{
-		thit = tHits[ i ];
-		if( ( fabs( thit ) < tol ) || ( thit > objectRay.maxt ) || ( thit < objectRay.mint ) )
-			valid = false;
-		else
+		double deviation1 = ( m_profileX[i] - ox ) * dy - ( m_profileY[i] - oy ) * dx;
+		double slope1 = m_profileDXDTheta[i] * dy - m_profileDYDTheta[i] * dx;
+
+		// The branches meet at the cusp node with different tangents, so the segment that ends there uses the left branch tangent
+		double slopeEnd = ( i == m_profileCuspNode ) ? ( m_cuspLeftDerivative.x * dy - m_cuspLeftDerivative.y * dx ) : slope1;
+
+		double segmentRoots[2];
+		int nRoots = FindSegmentRoots( ox, oy, dx, dy, i, deviation0, deviation1, slope0, slopeEnd, segmentRoots );
+		for( int r = 0; r < nRoots; ++r )
 		{
-			// Compute possible collector hit position. Only Z must be checked, as find root only computes roots within the shape limits.
-			hitPoint = objectRay( thit );
-			if( hitPoint.z < 0.0 || hitPoint.z > length.getValue() )	valid = false;
-			else	valid = true;
+			double thetaRoot = segmentRoots[r];
+
+			// Compute intersection distance along ray with the largest direction component
+			double tRoot = ( fabs( dx ) > fabs( dy ) ) ? ( ConcentratorProfileX( thetaRoot ) - ox ) / dx
+													: ( ConcentratorProfileY( thetaRoot ) - oy ) / dy;
+			if( ( fabs( tRoot ) >= tol ) && ( tRoot <= objectRay.maxt ) && ( tRoot >= objectRay.mint )
+					&& ( !valid || ( tRoot < thit ) ) )
+			{
+				// Compute possible collector hit position. Only Z must be checked, as the roots are within the shape limits.
+				Point3D point = objectRay( tRoot );
+				if( ( point.z >= 0.0 ) && ( point.z <= length.getValue() ) )
+				{
+					valid = true;
+					thit = tRoot;
+					theta = thetaRoot;
+				}
+			}
 		}
-		i++;
+		deviation0 = deviation1;
+		slope0 = slope1;
 	}
 	if( !valid ) return false;
-	// Now check if the fucntion is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) )	gf::SevereError( "Function Cylinder::Intersect(...) called with null pointers" );
+
+	*tHit = thit;
+	*thetaHit = theta;
+	return true;
+}
+
+void ShapeTroughAsymmetricCPC::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	// The profile angle of the hit was computed by IntersectT
+	double thetaHit = hit.parameter;
+	Point3D hitPoint = objectRay( hit.tHit );
 
 	// Find parametric representation of CPC concentrator hit
-	double thetaHit = intersectionsMap.value( thit );
 	double u = ( thetaHit - m_thetaMin ) / ( m_thetaMax - m_thetaMin );
 	double v = hitPoint.z / length.getValue();
 
 	Vector3D dpdu = GetDPDU( u , v );
 	Vector3D dpdv( 0.0 , 0.0 , 1.0 );
-	Vector3D d2pduu = GetD2PDUU( u , v );
-	Vector3D d2pduv( 0.0 , 0.0 , 0.0 );
-	Vector3D d2pdvv( 0.0 , 0.0 , 0.0 );
-
-	// Compute coefficients for fundamental forms
-	double E = DotProduct( dpdu, dpdu );
-	double F = DotProduct( dpdu, dpdv );
-	double G = DotProduct( dpdv, dpdv );
-	Vector3D N = Normalize( CrossProduct( dpdu, dpdv ) );
-	double e = DotProduct( N, d2pduu );
-	double f = DotProduct( N, d2pduv );
-	double g = DotProduct( N, d2pdvv );
-
-	// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / ( E * G - F * F );
-	Vector3D dndu = ( f * F - e * G ) * invEGF2 * dpdu + ( e * F - f * E ) * invEGF2 * dpdv;
-	Vector3D dndv = ( g * F - f * G ) * invEGF2 * dpdu + ( f * F - g * E ) * invEGF2 * dpdv;
+
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry( hitPoint ,
@@ -210,15 +235,12 @@ bool ShapeTroughAsymmetricCPC::Intersect(const Ray& objectRay, double *tHit, Dif
 								dndu,
 								dndv,
 								u, v, this );
-
-	// Update _tHit_ for quadric intersection
-	*tHit = thit;
-	return true;
 }
 
 bool ShapeTroughAsymmetricCPC::IntersectP( const Ray& objectRay ) const
 {
-	return Intersect( objectRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( objectRay, &hit );
 }
 
 Point3D ShapeTroughAsymmetricCPC::Sample( double u, double v ) const
@@ -456,6 +478,7 @@ void ShapeTroughAsymmetricCPC::SetInternalValues()
 	// Full length limits
 	m_thetaMax = 3*gc::Pi/2 - acceptanceAngleCW.getValue() - m_tangentAngle;
 	m_thetaMin = -( 3*gc::Pi/2 - acceptanceAngleCCW.getValue() - m_tangentAngle );
+	SetProfileTable();
 
 	// Truncation
 	double thetaMaxTruncated = m_thetaMax;
@@ -465,14 +488,53 @@ void ShapeTroughAsymmetricCPC::SetInternalValues()
 	Vector3D truncationDir = Vector3D( cos( truncationAngle.getValue() ) , sin( truncationAngle.getValue() ) , 0.0 );
 	Ray truncationLine = Ray( truncationOr , truncationDir );
 	std::vector<double> intersections = FindRoots( truncationLine );
-	if( intersections.size() > 0 )
+	for( unsigned int i = 0; i < intersections.size(); ++i )
 	{
-		if( intersections[ 0 ] > 0.0 ) thetaMaxTruncated = intersections[ 0 ];
-		if( intersections[ intersections.size() - 1 ] < 0.0 ) thetaMinTruncated = intersections[ intersections.size() - 1 ];
+		if( intersections[ i ] > 0.0 ) thetaMaxTruncated = std::min( thetaMaxTruncated, intersections[ i ] );
+		if( intersections[ i ] < 0.0 ) thetaMinTruncated = std::max( thetaMinTruncated, intersections[ i ] );
 	}
 	m_thetaMax = std::min( m_thetaMax , thetaMaxTruncated );
 	m_thetaMin = std::max( m_thetaMin , thetaMinTruncated );
+	SetProfileTable();
+}
 
+/*!
+ * Samples the profile between \a m_thetaMin and \a m_thetaMax. The samples bracket the ray intersections,
+ * so they must be updated each time the profile limits change.
+ *
+ * The left and right branches meet with different tangents at theta zero. When the cusp is within the limits,
+ * it is a sample so that no segment contains it.
+ */
+void ShapeTroughAsymmetricCPC::SetProfileTable()
+{
+	m_profileCuspNode = -1;
+	if( ( m_thetaMin < 0.0 ) && ( m_thetaMax > 0.0 ) )
+	{
+		m_profileCuspNode = int( floor( ( - m_thetaMin / ( m_thetaMax - m_thetaMin ) ) * profileSegments + 0.5 ) );
+		m_profileCuspNode = std::max( 1, std::min( profileSegments - 1, m_profileCuspNode ) );
+	}
+	Vector3D cuspDerivative = GetDPDURight( acceptanceAngleCW.getValue() , 0.0 );
+	m_cuspLeftDerivative = Vector3D( cuspDerivative.x , - cuspDerivative.y, 0.0 );
+
+	m_profileTheta.resize( profileSegments + 1 );
+	m_profileX.resize( profileSegments + 1 );
+	m_profileY.resize( profileSegments + 1 );
+	m_profileDXDTheta.resize( profileSegments + 1 );
+	m_profileDYDTheta.resize( profileSegments + 1 );
+	for( int i = 0; i <= profileSegments; ++i )
+	{
+		double theta;
+		if( m_profileCuspNode < 0 ) theta = m_thetaMin + i * ( m_thetaMax - m_thetaMin ) / profileSegments;
+		else if( i <= m_profileCuspNode ) theta = m_thetaMin * ( m_profileCuspNode - i ) / m_profileCuspNode;
+		else theta = m_thetaMax * ( i - m_profileCuspNode ) / ( profileSegments - m_profileCuspNode );
+		m_profileTheta[i] = theta;
+		m_profileX[i] = ConcentratorProfileX( theta );
+		m_profileY[i] = ConcentratorProfileY( theta );
+
+		Vector3D dpdtheta = ProfileDerivative( theta );
+		m_profileDXDTheta[i] = dpdtheta.x;
+		m_profileDYDTheta[i] = dpdtheta.y;
+	}
 }
 
 double ShapeTroughAsymmetricCPC::ConcentratorProfileX( double theta ) const
@@ -539,149 +601,147 @@ double ShapeTroughAsymmetricCPC::ConcentratorProfileY( double theta ) const
 	return y;
 }
 
-std::vector<double> ShapeTroughAsymmetricCPC::FindRigthRoots( const Ray ray, double thetaStart , double thetaEnd , double acceptanceAngle ) const
+/*!
+ * Returns the profile angles, in increasing order, where the \a ray crosses the profile.
+ */
+std::vector<double> ShapeTroughAsymmetricCPC::FindRoots( const Ray ray ) const
 {
 	std::vector<double> roots;
-	//Set general algorithm parameters
-	double maxIterations = 500;
-	double tolerance = 0.00000001;
-
-	//Initialize starting and ending point
-	double theta0 = thetaStart;
-	double theta1 = thetaEnd;
-
-	//Set step for going through the space in case YDistance(start) * YDistance(end) > 0 (both positives or negatives)
-	double delta = fabs( theta1 - theta0 ) / 100;
-	// Define an auxiliar value with -Infinity. This variable will hold the closest theta value next to the not computed root in case there are two roots
-	double thetaAux = - gc::Infinity;
-
-	//Compute extreme points
-	double tDeviation0 = TDeviation( ray, theta0 , acceptanceAngle );
-	double tDeviation1 = TDeviation( ray, theta1 , acceptanceAngle );
-
-	//If YDistance(start) * YDistance(end) > 0 add the defined step to the starting point
-	// until YDistance(start) * YDistance(end) < 0 condition is satisfied.
-	while( ( ( tDeviation0 * tDeviation1 ) > 0.0 ) && ( theta0 < theta1 ) )
-	{
-		//Set theta aux if while is entered.
-		thetaAux = theta0;
-		theta0 += delta;
-		tDeviation0 = TDeviation( ray, theta0 , acceptanceAngle );
-	}
-	// If YDistance(start) * YDistance(end) < 0 condition is NOT satisfied, there are no roots --> return.
-	if( ( ( tDeviation0 * tDeviation1 ) > 0.0 ) || ( theta0 > theta1 ) ) return roots;
 
-	// Once YDistance(start) * YDistance(end) < 0 iterate by the bisection method
-	int iterations = 0;
-	while( ( fabs( theta1 - theta0 ) > tolerance ) && ( iterations < maxIterations ) )
+	double ox = ray.origin.x;
+	double oy = ray.origin.y;
+	double dx = ray.direction().x;
+	double dy = ray.direction().y;
+
+	double deviation0 = ( m_profileX[0] - ox ) * dy - ( m_profileY[0] - oy ) * dx;
+	double slope0 = m_profileDXDTheta[0] * dy - m_profileDYDTheta[0] * dx;
+	for( int i = 1; i <= profileSegments; ++i )
 	{
-		double thetaMiddle = ( theta0 + theta1 ) / 2.0 ;
-		double tDeviationMiddle = TDeviation( ray, thetaMiddle , acceptanceAngle );
+		double deviation1 = ( m_profileX[i] - ox ) * dy - ( m_profileY[i] - oy ) * dx;
+		double slope1 = m_profileDXDTheta[i] * dy - m_profileDYDTheta[i] * dx;
 
-		if( ( tDeviationMiddle > 0.0 ) && ( tDeviation1 > tDeviation0 ) ) theta1 = thetaMiddle;
-		else if( ( tDeviationMiddle > 0.0 ) && ( tDeviation1 < tDeviation0 ) ) theta0 = thetaMiddle;
-		else if( ( tDeviationMiddle < 0.0 ) && ( tDeviation1 > tDeviation0 ) ) theta0 = thetaMiddle;
-		else theta1 = thetaMiddle;
+		// The branches meet at the cusp node with different tangents, so the segment that ends there uses the left branch tangent
+		double slopeEnd = ( i == m_profileCuspNode ) ? ( m_cuspLeftDerivative.x * dy - m_cuspLeftDerivative.y * dx ) : slope1;
 
-		iterations++;
-	}
+		double segmentRoots[2];
+		int nRoots = FindSegmentRoots( ox, oy, dx, dy, i, deviation0, deviation1, slope0, slopeEnd, segmentRoots );
+		for( int r = 0; r < nRoots; ++r )
+			roots.push_back( segmentRoots[r] );
 
-	//If max iterations has been reached --> return, else insert the root (mean) into the roots vector.
-	if( iterations >= maxIterations ) return roots;
-	roots.push_back( ( theta0 + theta1 ) / 2.0 );
+		deviation0 = deviation1;
+		slope0 = slope1;
+	}
 
-	// If thetaAux has been used (no more -Infinity value), this should be close to the non-computed root. Update theta0 and theta1 and repeat iteration.
-	if( thetaAux < thetaStart ) return roots;
+	return roots;
+}
 
-	theta0 = std::max( thetaStart , thetaAux - delta );
-	theta1 = std::min( thetaAux + delta , thetaEnd );
+/*!
+ * Stores at \a roots the profile angles where the ray with origin ( \a ox, \a oy ) and direction ( \a dx, \a dy ) crosses
+ * the profile \a segment and returns the number of crossings. The profile deviation takes the values \a deviation0 and
+ * \a deviation1 at the segment ends, and its derivative takes the values \a slope0 and \a slope1.
+ *
+ * The involutes and parabolas of each branch always turn to the same side and no segment contains the cusp between
+ * the branches, so the ray is tangent to the profile at most once inside a segment. A segment whose ends are at different sides of the ray brackets one crossing. Otherwise, when
+ * the deviation derivative changes its sign, the tangency point splits the segment in two brackets and the ray crosses
+ * the segment twice if it is at the other side.
+ */
+int ShapeTroughAsymmetricCPC::FindSegmentRoots( double ox, double oy, double dx, double dy, int segment,
+		double deviation0, double deviation1, double slope0, double slope1, double roots[2] ) const
+{
+	double theta0 = m_profileTheta[segment-1];
+	double theta1 = m_profileTheta[segment];
+	if( ( deviation0 < 0.0 ) != ( deviation1 < 0.0 ) )
+	{
+		roots[0] = FindProfileRoot( ox, oy, dx, dy, theta0, theta1, deviation0, deviation1 );
+		return 1;
+	}
+	if( ( slope0 < 0.0 ) == ( slope1 < 0.0 ) ) return 0;
 
-	tDeviation0 = TDeviation( ray, theta0 , acceptanceAngle );
-	tDeviation1 = TDeviation( ray, theta1 , acceptanceAngle );
+	double thetaTangent = FindProfileTangent( dx, dy, theta0, theta1, slope0 );
+	double derivative;
+	double deviationTangent = ProfileDeviation( thetaTangent, ox, oy, dx, dy, &derivative );
+	if( ( deviationTangent < 0.0 ) == ( deviation0 < 0.0 ) ) return 0;
 
-	if( ( tDeviation0 * tDeviation1 ) > 0.0 ) return roots;
+	roots[0] = FindProfileRoot( ox, oy, dx, dy, theta0, thetaTangent, deviation0, deviationTangent );
+	roots[1] = FindProfileRoot( ox, oy, dx, dy, thetaTangent, theta1, deviationTangent, deviation1 );
+	return 2;
+}
 
-	iterations = 0;
-	while( ( fabs( theta1 - theta0 ) > tolerance ) && ( iterations < maxIterations ) )
+/*!
+ * Returns the profile angle between \a theta0 and \a theta1 where the profile is parallel to the direction ( \a dx, \a dy ).
+ * The derivative of the profile deviation takes the value \a slope0 at \a theta0 and the opposite sign at \a theta1.
+ */
+double ShapeTroughAsymmetricCPC::FindProfileTangent( double dx, double dy, double theta0, double theta1, double slope0 ) const
+{
+	int iterations = 0;
+	while( ( ( theta1 - theta0 ) > 0.000000000001 ) && ( iterations < 100 ) )
 	{
-		double thetaMiddle = ( theta0 + theta1 ) / 2.0 ;
-		double tDeviationMiddle = TDeviation( ray, thetaMiddle , acceptanceAngle );
-
-		if( ( tDeviationMiddle > 0.0 ) && ( tDeviation1 > tDeviation0 ) ) theta1 = thetaMiddle;
-		else if( ( tDeviationMiddle > 0.0 ) && ( tDeviation1 < tDeviation0 ) ) theta0 = thetaMiddle;
-		else if( ( tDeviationMiddle < 0.0 ) && ( tDeviation1 > tDeviation0 ) ) theta0 = thetaMiddle;
-		else theta1 = thetaMiddle;
-
+		double theta = ( theta0 + theta1 ) / 2.0;
+		Vector3D dpdtheta = ProfileDerivative( theta );
+		if( ( ( dpdtheta.x * dy - dpdtheta.y * dx ) < 0.0 ) == ( slope0 < 0.0 ) ) theta0 = theta;
+		else theta1 = theta;
 		iterations++;
 	}
 
-
-	if( iterations >= maxIterations ) return roots;
-	roots.push_back( ( theta0 + theta1 ) / 2.0 );
-
-	return roots;
+	return ( theta0 + theta1 ) / 2.0;
 }
 
-std::vector<double> ShapeTroughAsymmetricCPC::FindRoots( const Ray ray ) const
+/*!
+ * Returns the profile angle where the ray with origin ( \a ox, \a oy ) and direction ( \a dx, \a dy ) crosses the profile
+ * between \a theta0 and \a theta1. The profile deviation takes the values \a deviation0 and \a deviation1, with opposite signs,
+ * at the bracket ends. Newton steps that leave the bracket are replaced by bisection steps.
+ */
+double ShapeTroughAsymmetricCPC::FindProfileRoot( double ox, double oy, double dx, double dy, double theta0, double theta1, double deviation0, double deviation1 ) const
 {
-	// Right branch roots
-	std::vector<double> roots = FindRigthRoots( ray, 0 , m_thetaMax , acceptanceAngleCCW.getValue() );
+	double theta = theta0 + ( theta1 - theta0 ) * deviation0 / ( deviation0 - deviation1 );
 
-	// Left branch hits calculated with the symmetric ray.
-	Point3D symmetricRayOrigin = Point3D( - ray.origin.x , ray.origin.y , ray.origin.z );
-	Vector3D symmetricRayDirection = Vector3D( - ray.direction().x , ray.direction().y , ray.direction().z );
-	Ray symmetricRay = Ray( symmetricRayOrigin , symmetricRayDirection );
+	int iterations = 0;
+	while( iterations < 100 )
+	{
+		double derivative;
+		double deviation = ProfileDeviation( theta, ox, oy, dx, dy, &derivative );
+		if( deviation == 0.0 ) return theta;
 
-	std::vector<double> rootsLeft = FindRigthRoots( symmetricRay, 0 , - m_thetaMin , acceptanceAngleCW.getValue() );
+		if( ( deviation < 0.0 ) == ( deviation0 < 0.0 ) )
+		{
+			theta0 = theta;
+			deviation0 = deviation;
+		}
+		else theta1 = theta;
 
-	// Change sign to roots thetaRoot --> -thetaRoot and append to roots
-	for ( unsigned int i = 0; i < rootsLeft.size(); i++)
-		roots.push_back( -1.0 * rootsLeft[i] );
+		double thetaNext = theta - deviation / derivative;
+		if( !( ( thetaNext > theta0 ) && ( thetaNext < theta1 ) ) ) thetaNext = ( theta0 + theta1 ) / 2.0;
+		if( fabs( thetaNext - theta ) < 0.000000000001 ) return thetaNext;
 
-	return roots;
-}
+		theta = thetaNext;
+		iterations++;
+	}
 
+	return theta;
+}
 
-double ShapeTroughAsymmetricCPC::TDeviation( const Ray ray, double theta, double acceptanceAngle ) const
+/*!
+ * Returns the deviation between the profile point for \a theta and the ray with origin ( \a ox, \a oy ) and direction ( \a dx, \a dy ).
+ * The deviation is zero when the ray crosses the point. Its derivative with respect to \a theta is stored at \a derivative.
+ * The left branch is the mirror image of the right branch for the clockwise acceptance angle.
+ */
+double ShapeTroughAsymmetricCPC::ProfileDeviation( double theta, double ox, double oy, double dx, double dy, double* derivative ) const
 {
-	double dx = ray.direction().x;
-	double ox = ray.origin.x;
-	double dy = ray.direction().y;
-	double oy = ray.origin.y;
-
-	double involuteLimit = gc::Pi/2 + acceptanceAngle - m_tangentAngle;
-	if( theta < involuteLimit )
-		return -dy * ox + dx * oy + rInt.getValue() * ( dx - dy * ( theta + m_tangentAngle - m_thetaZero ) ) * cos( theta + m_tangentAngle ) + rInt.getValue() * ( dy + dx * ( theta + m_tangentAngle - m_thetaZero ) ) * sin( theta + m_tangentAngle );
-	else
-		return ( ( -2 * dy * rInt.getValue() * cos( acceptanceAngle ) )
-			+ rInt.getValue() * ( -2 * dx + dy * ( 2 * acceptanceAngle + gc::Pi + 2 * ( theta + m_tangentAngle - 2 * m_thetaZero ) ) ) * cos( theta + m_tangentAngle )
-			+ 2 * ( dx * rInt.getValue() * sin( acceptanceAngle ) - ( dy * ox - dx * oy ) * ( -1 + sin( acceptanceAngle - theta - m_tangentAngle ) ) )
-			- rInt.getValue() * ( 2*dy + dx * ( 2 * acceptanceAngle + gc::Pi + 2 * ( theta + m_tangentAngle - 2 * m_thetaZero ) ) ) * sin( theta + m_tangentAngle ) ) /
-			( 2*( -1 + sin( acceptanceAngle - theta - m_tangentAngle ) ) );
+	double x = ConcentratorProfileX( theta );
+	double y = ConcentratorProfileY( theta );
 
+	Vector3D dpdtheta = ProfileDerivative( theta );
+	*derivative = dpdtheta.x * dy - dpdtheta.y * dx;
+	return ( x - ox ) * dy - ( y - oy ) * dx;
 }
 
-std::vector<double> ShapeTroughAsymmetricCPC::FindThits( const Ray ray, const std::vector<double> roots ) const
+/*!
+ * Returns the derivative of the profile point with respect to \a theta.
+ */
+Vector3D ShapeTroughAsymmetricCPC::ProfileDerivative( double theta ) const
 {
-	double tolerance = 0.000001;
-	std::vector<double> tHits;
-	for( unsigned int i = 0 ; i < roots.size(); ++i )
-	{
-		double x = ConcentratorProfileX( roots[ i ] );
-		double y = ConcentratorProfileY( roots[ i ] );
-
-		double a = 1 - ray.direction().z * ray.direction().z;
-		double b = 0;
-		double c = - ( x - ray.origin.x ) * ( x - ray.origin.x ) - ( y - ray.origin.y ) * ( y - ray.origin.y );
-
-		double t0;
-		double t1;
-
-		gf::Quadratic( a, b, c, &t0, &t1 );
-
-		if (  std::fabs( ray( t0 ).y - y ) < tolerance ) tHits.push_back( t0 );
-		else tHits.push_back( t1 );
-	}
+	if( theta >= 0.0 )	return GetDPDURight( acceptanceAngleCCW.getValue() , theta );
 
-	return tHits;
+	Vector3D dpdtheta = GetDPDURight( acceptanceAngleCW.getValue() , - theta );
+	return Vector3D( dpdtheta.x , - dpdtheta.y, 0.0 );
 }
@@ -65,6 +65,8 @@ public:
 	double GetVolume() const;
 
 	bool Intersect(const Ray &ray, double *tHit, DifferentialGeometry *dg ) const;
+	bool IntersectT( const Ray& objectRay, ShapeHit* hit ) const;
+	void ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const;
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v) const;
@@ -96,18 +98,30 @@ private:
 	Vector3D GetD2PDUU( double u, double v ) const;
 
 	void SetInternalValues();
+	void SetProfileTable();
 	double ConcentratorProfileX( double theta ) const;
 	double ConcentratorProfileY( double theta ) const;
 
-	double TDeviation( const Ray ray, double theta, double acceptanceAngle ) const;
-	std::vector<double> FindRigthRoots( const Ray ray, double thetaStart , double thetaEnd , double acceptanceAngle ) const;
+	double ProfileDeviation( double theta, double ox, double oy, double dx, double dy, double* derivative ) const;
+	Vector3D ProfileDerivative( double theta ) const;
+	bool IntersectProfile( const Ray& objectRay, double* tHit, double* thetaHit ) const;
+	int FindSegmentRoots( double ox, double oy, double dx, double dy, int segment,
+			double deviation0, double deviation1, double slope0, double slope1, double roots[2] ) const;
+	double FindProfileTangent( double dx, double dy, double theta0, double theta1, double slope0 ) const;
+	double FindProfileRoot( double ox, double oy, double dx, double dy, double theta0, double theta1, double deviation0, double deviation1 ) const;
 	std::vector<double> FindRoots( const Ray ray ) const;
-	std::vector<double> FindThits( const Ray ray, const std::vector<double> roots ) const;
 
 	double m_tangentAngle;
 	double m_thetaZero;
 	double m_thetaMin;
 	double m_thetaMax;
+	std::vector<double> m_profileTheta;
+	std::vector<double> m_profileX;
+	std::vector<double> m_profileY;
+	std::vector<double> m_profileDXDTheta;
+	std::vector<double> m_profileDYDTheta;
+	int m_profileCuspNode;
+	Vector3D m_cuspLeftDerivative;
 };
 
 #endif /*SHAPETROUGHASYMMETRICCPC_H_*/
@@ -37,10 +37,8 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 ***************************************************************************/
 
 #include <algorithm>
-#include <vector>
 
 #include <QIcon>
-#include <QMap>
 #include <QMessageBox>
 
 #include <Inventor/SoPrimitiveVertex.h>
@@ -53,18 +51,11 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "gc.h"
 #include "gf.h"
 #include "Ray.h"
-#include "Transform.h"
 #include "Vector3D.h"
 
 #include "DifferentialGeometry.h"
 #include "ShapeTroughCHC.h"
 
-
-double fPart( double alpha, double x, double r1, double theta, double r, double eccentricity )
-{
-	return -r1 + sin( alpha - theta ) * ( r/ ( 1 - eccentricity * cos( alpha ) ) ) - x ;
-}
-
 SO_NODE_SOURCE(ShapeTroughCHC);
 
 void ShapeTroughCHC::initClass()
@@ -124,20 +115,21 @@ QString ShapeTroughCHC::GetIcon() const
 	return ":/icons/ShapeTroughCHC.png";
 }
 
-bool ShapeTroughCHC::Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg) const
+bool ShapeTroughCHC::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
 {
-	double a = ( m_s - height.getValue() )/( cos( m_theta ) * 2 *  m_eccentricity);
-	double b = sqrt( ( m_eccentricity * m_eccentricity - 1 ) *  a * a );
-
-	double angle = -( 0.5 * gc::Pi ) + m_theta;
-
-	Transform hTransform( cos( angle ), -sin( angle ), 0.0, -r1.getValue() + a * m_eccentricity * sin( m_theta ),
-			sin( angle ), cos( angle ), 0.0, - a * m_eccentricity * cos( m_theta ),
-	           0.0, 0.0, 1.0, 0.0,
-	           0.0, 0.0, 0.0, 1.0 );
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
 
+bool ShapeTroughCHC::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
+{
+	double a = m_hyperbolaA;
+	double b = m_hyperbolaB;
 
-	Ray transformedRay = hTransform.GetInverse()( objectRay );
+	Ray transformedRay = m_objectToHyperbola( objectRay );
 
 	double A =   ( transformedRay.direction().x * transformedRay.direction().x ) / ( a * a )
 			   - ( transformedRay.direction().y * transformedRay.direction().y ) / ( b * b );
@@ -192,17 +184,24 @@ bool ShapeTroughCHC::Intersect(const Ray& objectRay, double *tHit, DifferentialG
 					|| hitPoint.z < zmin ||  hitPoint.z > zmax )	return false;
 	}
 
-	// Find parametric representation of CHC concentrator hit
+	hit->tHit = thit;
+	return true;
+}
+
+void ShapeTroughCHC::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	// Compute ShapeTroughCHC hit position
+	Point3D hitPoint = objectRay( hit.tHit );
 
+	// Find parametric representation of CHC concentrator hit from its polar angle around the focus
 	double sup = m_theta + 0.5* gc::Pi;
 	double inf = m_theta + m_phi;
 
-	double alpha;
-	bool isAlpha = findRoot( fPart, hitPoint.x,  m_eccentricity,  r1.getValue(), m_theta, inf, sup, 0.5*( sup-inf), 500, &alpha );
-	if( !isAlpha )return false;
+	double alpha = m_theta + atan2( hitPoint.x + r1.getValue(), hitPoint.y );
 	double u = ( alpha - inf ) / ( sup - inf );
 
-	zmax = (lengthX1.getValue() / 2 ) + m* ( hitPoint.x - r1.getValue() );
+	double m =  ( lengthX2.getValue() / 2- lengthX1.getValue() / 2 ) / ( p1.getValue() - r1.getValue() );
+	double zmax = (lengthX1.getValue() / 2 ) + m* ( hitPoint.x - r1.getValue() );
 	double v = ( ( hitPoint.z / zmax ) + 1 )/ 2;
 
 
@@ -210,30 +209,10 @@ bool ShapeTroughCHC::Intersect(const Ray& objectRay, double *tHit, DifferentialG
 	Vector3D dpdu = GetDPDU( u, v );
 	Vector3D dpdv = GetDPDV( u, v );
 
-	// Compute cylinder \dndu and \dndv
-
-	//Not yet implemented
-	Vector3D d2Pduu( 0.0, 0.0, 0.0 );
-
-	Vector3D d2Pduv( 0.0, 0.0, 0.0 );
-	Vector3D d2Pdvv( 0.0, 0.0, 0.0 );
-
-	// Compute coefficients for fundamental forms
-	double E = DotProduct( dpdu, dpdu );
-	double F = DotProduct( dpdu, dpdv );
-	double G = DotProduct( dpdv, dpdv );
 	Vector3D N = Normalize( CrossProduct( dpdu, dpdv ) );
 
-	double e = DotProduct( N, d2Pduu );
-	double f = DotProduct( N, d2Pduv );
-	double g = DotProduct( N, d2Pdvv );
-
-		// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / (E*G - F*F);
-	Vector3D dndu = (f*F - e*G) * invEGF2 * dpdu +
-			        (e*F - f*E) * invEGF2 * dpdv;
-	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
-	                (f*F - g*E) * invEGF2 * dpdv;
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry( hitPoint ,
@@ -243,18 +222,13 @@ bool ShapeTroughCHC::Intersect(const Ray& objectRay, double *tHit, DifferentialG
 								dndv,
 		                        u, v, this );
 
-    // Update _tHit_ for quadric intersection
-    *tHit = thit;
-
     dg->shapeFrontSide = ( DotProduct( N, objectRay.direction() ) > 0 ) ? false : true;
-
-	return true;
-
 }
 
 bool ShapeTroughCHC::IntersectP( const Ray& objectRay ) const
 {
-	return Intersect( objectRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( objectRay, &hit );
 }
 
 Point3D ShapeTroughCHC::Sample( double u, double v ) const
@@ -462,54 +436,9 @@ Vector3D ShapeTroughCHC::GetDPDV( double u, double /* v */ ) const
    return Vector3D( x, y, z );
 }
 
-bool ShapeTroughCHC::findRoot( double (*funcion)( double, double, double, double, double, double ), double xCoord, double e, double r1, double theta, double a, double b, double y0, int max, double* alpha )
-{
-
-	double r  =  2 * r1 *( 1 - e * cos( theta + 0.5* gc::Pi ) );
-
-
-	double y1 = funcion( a, xCoord, r1, theta, r, e );
-	double y2 =funcion( b, xCoord, r1, theta, r, e );
-
-	double delta = fabs( a - b ) / 100;
-	while( ( ( y1 * y2 ) > 0.0 ) && ( a < b ) )
-	{
-		a += delta;
-		y1 = funcion(  a, xCoord, r1, theta, r, e );
-		//funcion( a, r, thetaI, ray  );
-	}
-
-	if( ( ( y1 * y2 ) > 0.0 ) || ( a > b ) ) return false;
-
-	int iterations = 0;
-	while( ( fabs( a - b ) > 0.000000000001 ) && ( iterations < max ) )
-	{
-		double x = ( a + b ) / 2.0 ;
-		//double y = funcion( x, r, thetaI, ray );
-		double y = funcion( x, xCoord, r1, theta, r, e );
-
-		if( y == y0 )
-		{
-			*alpha = x;
-			return true;
-		}
-
-		if( ( y > y0 ) && ( y2 > y1 ) ) 	b= x;
-		else if( ( y > y0 ) && ( y2 < y1 ) ) 		a = x;
-		else if( ( y < y0 ) && ( y2 > y1 ) ) 		a= x;
-		else	b = x;
-		iterations++;
-
-	}
-
-	if( iterations >= max ) return false;
-
-	*alpha  = ( a + b ) / 2 ;
-	return true;
-}
-
 /*!
- * Computes and sets \a m_phi, \a m_s, \a m_theta and \a m_eccentricity.
+ * Computes and sets \a m_phi, \a m_s, \a m_theta and \a m_eccentricity, and the hyperbola
+ * semi-axes and transformation used to intersect the rays.
  */
 void ShapeTroughCHC::SetInternalValues()
 {
@@ -524,4 +453,13 @@ void ShapeTroughCHC::SetInternalValues()
 								* ( 1 + sin( m_phi ) ) * ( 1 + sin( m_phi ) ) * sin( m_phi ) * sin( m_phi ) )
 	                  /( 2 * p1.getValue() * cos( m_phi ) * cos( m_phi ) - ( p1.getValue() - r1.getValue() ) * ( 1 + sin( m_phi ) ) );
 
+	m_hyperbolaA = ( m_s - height.getValue() )/( cos( m_theta ) * 2 *  m_eccentricity);
+	m_hyperbolaB = sqrt( ( m_eccentricity * m_eccentricity - 1 ) *  m_hyperbolaA * m_hyperbolaA );
+
+	double angle = -( 0.5 * gc::Pi ) + m_theta;
+	Transform hTransform( cos( angle ), -sin( angle ), 0.0, -r1.getValue() + m_hyperbolaA * m_eccentricity * sin( m_theta ),
+			sin( angle ), cos( angle ), 0.0, - m_hyperbolaA * m_eccentricity * cos( m_theta ),
+	           0.0, 0.0, 1.0, 0.0,
+	           0.0, 0.0, 0.0, 1.0 );
+	m_objectToHyperbola = hTransform.GetInverse();
 }
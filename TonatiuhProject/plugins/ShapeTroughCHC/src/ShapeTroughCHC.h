@@ -44,6 +44,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include <Inventor/fields/SoSFDouble.h>
 #include <Inventor/sensors/SoFieldSensor.h>
 
+#include "Transform.h"
 #include "trt.h"
 #include "TShape.h"
 
@@ -62,6 +63,8 @@ public:
 	QString GetIcon() const;
 
 	bool Intersect(const Ray &ray, double *tHit, DifferentialGeometry *dg ) const;
+	bool IntersectT( const Ray& objectRay, ShapeHit* hit ) const;
+	void ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const;
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v) const;
@@ -87,7 +90,6 @@ protected:
 private:
 	Vector3D GetDPDU( double u, double v ) const;
 	Vector3D GetDPDV( double u, double v ) const;
-	static bool findRoot( double (*funcion)( double, double, double, double, double, double ), double xCoord, double e, double r1, double theta, double a, double b, double y0, int max, double* alpha );
 
 	void SetInternalValues();
 
@@ -95,6 +97,9 @@ private:
 	double m_s;
 	double m_theta;
 	double m_eccentricity;
+	double m_hyperbolaA;
+	double m_hyperbolaB;
+	Transform m_objectToHyperbola;
 };
 
 #endif /*SHAPETROUGHCHC_H_*/
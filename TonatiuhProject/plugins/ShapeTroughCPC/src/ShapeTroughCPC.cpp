@@ -36,11 +36,7 @@ Contributors: Javier Garcia-Barberena, I�aki Perez, Inigo Pagola,  Gilda Jimen
 Juana Amieva, Azael Mancillas, Cesar Cantu.
 ***************************************************************************/
 
-#include <algorithm>
-#include <vector>
-
 #include <QIcon>
-#include <QMap>
 #include <QMessageBox>
 
 #include <Inventor/SoPrimitiveVertex.h>
@@ -57,21 +53,8 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "DifferentialGeometry.h"
 #include "ShapeTroughCPC.h"
 
-double fPart( double theta, double a, double thetaI, Ray ray )
-{
-
-	//Caso 1a: RIGHT, If= FALSE
-
-	double xrd = ray.direction().x;
-	double xro = ray.origin.x;
-	double yrd = ray.direction().y;
-	double yro = ray.origin.y;
-
-	return ( 1 /(-1 + cos( theta ))) * ( (a + xro ) * yrd - xrd * yro + (-xro * yrd + xrd * yro ) * cos(theta)
-					+ a * ( -yrd * ( cos(theta - 2 * thetaI ) + 2 * sin( theta - thetaI ))
-					+ 2 * xrd * cos( theta - thetaI ) * (1 + sin(thetaI) ) ) );
-
-}
+//Number of profile segments used to bracket the ray intersections.
+const int profileSegments = 100;
 
 SO_NODE_SOURCE(ShapeTroughCPC);
 
@@ -107,7 +90,7 @@ ShapeTroughCPC::ShapeTroughCPC()
 	m_heightSensor->setPriority( 0 );
 	m_heightSensor->attach( &height );
 
-
+	SetProfileTable();
 }
 
 ShapeTroughCPC::~ShapeTroughCPC()
@@ -141,104 +124,99 @@ QString ShapeTroughCPC::GetIcon() const
 	return ":/icons/ShapeTroughCPC.png";
 }
 
-bool ShapeTroughCPC::Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg) const
+bool ShapeTroughCPC::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
 {
-	QMap< double, double > vectorTr;
-
-	double inf = 2 * m_thetaI;
-	double sup = ( gc::Pi / 2 ) + m_thetaI;
-	double ts11;
-	bool isRoot1 = findRoot( fPart, objectRay, a.getValue(), m_thetaI, inf, sup, 0, 500, &ts11 );
-	if( isRoot1 )
-	{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
 
-		double tr11 = findThit( objectRay, ts11, true );
-		vectorTr.insert( tr11, ts11 );
-		double ts12;
-		if ( findRoot( fPart, objectRay, a.getValue(), m_thetaI, inf, ts11 - 0.00001, 0, 500, &ts12 ) )
-		{
-			double tr12  = findThit( objectRay, ts12, true );
-			vectorTr.insert( tr12, ts12 );
-		}
-		else
-		{
-			if( findRoot( fPart, objectRay, a.getValue(), m_thetaI, ts11 + 0.00001, sup, 0, 500, &ts12 ) )
-			{
-				double tr12 = findThit( objectRay, ts12, true );
-				vectorTr.insert( tr12, ts12 );
-			}
-		}
+bool ShapeTroughCPC::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
+{
+	return IntersectProfile( objectRay, &hit->tHit, &hit->parameter );
+}
 
-	}
+/*!
+ * Computes the distance \a tHit and the profile angle \a thetaHit of the closest intersection of \a objectRay with the concentrator.
+ * Returns false if the ray does not intersect the concentrator.
+ */
+bool ShapeTroughCPC::IntersectProfile( const Ray& objectRay, double* tHit, double* thetaHit ) const
+{
+	double ox = objectRay.origin.x;
+	double oy = objectRay.origin.y;
+	double dx = objectRay.direction().x;
+	double dy = objectRay.direction().y;
 
+	// Rays parallel to the trough axis never cross the profile
+	if( ( dx == 0.0 ) && ( dy == 0.0 ) ) return false;
 
-	int nIntersections =  vectorTr.size();
-	if ( nIntersections == 0 ) return false;
-	QList< double > keys = vectorTr.keys();
-	std::vector<double> array = QVector<double>::fromList( keys ).toStdVector() ;
+	double xmin = a.getValue();
+	double xmax = m_profileX[0];
+	double m =  ( lengthXMax.getValue() / 2- lengthXMin.getValue() / 2 ) / ( xmax - xmin );
 
+	//Evaluate Tolerance
+	double tol = 0.0001;
 
- 	std::sort(array.begin(), array.end());
-	double thit = array[0];
-	int intersection = 0;
 	bool valid = false;
-	Point3D hitPoint;
+	double thit = 0.0;
+	double theta = 0.0;
 
-	double xmin = a.getValue();
-	double xmax = ( (2 * a.getValue() * (1 + sin(m_thetaI) ) * sin(m_thetaMin-m_thetaI) )
-			 / ( 1 - cos(m_thetaMin) ) )- a.getValue();
-	double ymin = 0.0;
-	double ymax = ( 2 * a.getValue() * cos(m_thetaI)* (1 + sin(m_thetaI ) ) )/(1 - cos( 2 * m_thetaI ) );
-
-	while(  ( intersection < vectorTr.size() ) && !valid )
+	double deviation0 = ( m_profileX[0] - ox ) * dy - ( m_profileY[0] - oy ) * dx;
+	double slope0 = m_profileDXDTheta[0] * dy - m_profileDYDTheta[0] * dx;
+	for( int i = 1; i <= profileSegments; ++i )
 	{
+		double deviation1 = ( m_profileX[i] - ox ) * dy - ( m_profileY[i] - oy ) * dx;
+		double slope1 = m_profileDXDTheta[i] * dy - m_profileDYDTheta[i] * dx;
 
-		thit = array[intersection];
-
-		if ( thit < 0 ) valid = false;
-		else
+		double segmentRoots[2];
+		int nRoots = FindSegmentRoots( ox, oy, dx, dy, i, deviation0, deviation1, slope0, slope1, segmentRoots );
+		for( int r = 0; r < nRoots; ++r )
 		{
-			// Compute intersection distance along ray
-				//Evaluate Tolerance
-			double tol = 0.0001;
-			double theta = vectorTr.value( thit );
-			if( ( fabs( thit ) < tol ) || ( theta > ( gc::Pi / 2 + m_thetaI )  ) ) valid = false;
-			else
+			double thetaRoot = segmentRoots[r];
+
+			// Compute intersection distance along ray with the largest direction component
+			double tRoot = ( fabs( dx ) > fabs( dy ) ) ? ( ProfileX( thetaRoot ) - ox ) / dx
+													: ( ProfileY( thetaRoot ) - oy ) / dy;
+			if( ( tRoot >= tol ) && ( tRoot >= objectRay.mint ) && ( tRoot <= objectRay.maxt )
+					&& ( !valid || ( tRoot < thit ) ) )
 			{
-				if( thit> objectRay.maxt || thit < objectRay.mint ) valid = false;
-		    	else
-		    	{
-			    	// Compute possible collector hit position
-					hitPoint = objectRay( thit );
-
-					// Test intersection against clipping parameters
-					double m =  ( lengthXMax.getValue() / 2- lengthXMin.getValue() / 2 ) / ( xmax - xmin );
-					double zmax = ( lengthXMin.getValue()  / 2 )+ m * ( hitPoint.x - xmin );
-					double zmin = -zmax;
-
-					if( hitPoint.z < zmin || hitPoint.z > zmax ||
-						hitPoint.y > ymax || hitPoint.y < ymin ||
-						hitPoint.x > xmax || hitPoint.x < xmin )	valid = false;
-					else valid = true;
-		    	}
+				// Compute possible collector hit position
+				Point3D point = objectRay( tRoot );
+
+				// Test intersection against clipping parameters
+				double zmax = ( lengthXMin.getValue()  / 2 )+ m * ( point.x - xmin );
+				if( ( point.z >= -zmax ) && ( point.z <= zmax ) )
+				{
+					valid = true;
+					thit = tRoot;
+					theta = thetaRoot;
+				}
 			}
 		}
-		intersection++;
+		deviation0 = deviation1;
+		slope0 = slope1;
 	}
 	if( !valid ) return false;
 
-	double theta = vectorTr.value( thit );
-
-	// Now check if the fucntion is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) ) gf::SevereError( "Function Cylinder::Intersect(...) called with null pointers" );
+	*tHit = thit;
+	*thetaHit = theta;
+	return true;
+}
 
+void ShapeTroughCPC::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	// The profile angle of the hit was computed by IntersectT
+	double theta = hit.parameter;
+	Point3D hitPoint = objectRay( hit.tHit );
 
 	// Find parametric representation of CPC concentrator hit
 	double u = ( theta - 2 * m_thetaI ) / ( gc::Pi / 2 - m_thetaI );
 
-	double m =  (  ( lengthXMax.getValue()- lengthXMin.getValue() ) / 2 ) /  ( xmax - xmin );
+	double xmin = a.getValue();
+	double xmax = m_profileX[0];
+	double m =  ( lengthXMax.getValue() / 2- lengthXMin.getValue() / 2 ) / ( xmax - xmin );
 	double zmax = (lengthXMin.getValue() / 2 ) + m* ( hitPoint.x - xmin );
 	double v = ( ( hitPoint.z / zmax ) + 1 )/ 2;
 
@@ -253,33 +231,8 @@ bool ShapeTroughCPC::Intersect(const Ray& objectRay, double *tHit, DifferentialG
 	Vector3D dpdu(dpduX, dpduY, 0.0);
 	Vector3D dpdv(0.0, 0.0, 1.0);
 
-	// Compute cylinder \dndu and \dndv
-	double dpduuX = 0.125 * a.getValue() * (gc::Pi - 2 * m_thetaI ) * (gc::Pi - 2 * m_thetaI ) * pow( (1 / cos( 0.25 * (-2 + u) * ( gc::Pi - 2 * m_thetaI  ) ) ), 4 )
-								* ( -2 * sin( m_thetaI ) + sin( u * gc::Pi  / 2  + m_thetaI - u * m_thetaI ) ) * (1 + sin( m_thetaI ) );
-
-	double dpduuY = 0.125 * a.getValue() * (gc::Pi - 2 * m_thetaI ) * (gc::Pi - 2 * m_thetaI ) * pow( (1 / cos( 0.25 * (-2 + u) * ( gc::Pi - 2 * m_thetaI  ) ) ), 4 )
-									* ( 2 * cos( m_thetaI ) + cos( u * gc::Pi  / 2  + m_thetaI - u * m_thetaI ) ) * (1 + sin( m_thetaI ) );
-
-	Vector3D d2Pduu(dpduuX , dpduuY, 0);
-
-	Vector3D d2Pduv( 0.0, 0.0, 0.0 );
-	Vector3D d2Pdvv( 0.0, 0.0, 0.0 );
-
-	// Compute coefficients for fundamental forms
-	double E = DotProduct( dpdu, dpdu );
-	double F = DotProduct( dpdu, dpdv );
-	double G = DotProduct( dpdv, dpdv );
-	Vector3D N = Normalize( CrossProduct( dpdu, dpdv ) );
-	double e = DotProduct( N, d2Pduu );
-	double f = DotProduct( N, d2Pduv );
-	double g = DotProduct( N, d2Pdvv );
-
-		// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / (E*G - F*F);
-	Vector3D dndu = (f*F - e*G) * invEGF2 * dpdu +
-			        (e*F - f*E) * invEGF2 * dpdv;
-	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
-	                (f*F - g*E) * invEGF2 * dpdv;
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry( hitPoint ,
@@ -288,16 +241,12 @@ bool ShapeTroughCPC::Intersect(const Ray& objectRay, double *tHit, DifferentialG
 		                        dndu,
 								dndv,
 		                        u, v, this );
-
-    // Update _tHit_ for quadric intersection
-    *tHit = thit;
-
-	return true;
 }
 
 bool ShapeTroughCPC::IntersectP( const Ray& objectRay ) const
 {
-	return Intersect( objectRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( objectRay, &hit );
 }
 
 Point3D ShapeTroughCPC::Sample( double u, double v ) const
@@ -335,6 +284,7 @@ void ShapeTroughCPC::updateCMaxValues( void *data, SoSensor *)
 
 	}
 	shapeTroughCPC->m_thetaMin = ( theta1 + theta2 ) / 2;
+	shapeTroughCPC->SetProfileTable();
 }
 
 void ShapeTroughCPC::updateHeightValues( void *data, SoSensor *)
@@ -385,6 +335,7 @@ void ShapeTroughCPC::updateHeightValues( void *data, SoSensor *)
 		}
 		shapeTroughCPC->m_thetaMin = ( theta1 + theta2 ) / 2;
 	}
+	shapeTroughCPC->SetProfileTable();
 }
 
 
@@ -543,65 +494,153 @@ void ShapeTroughCPC::generatePrimitives(SoAction *action)
 
 }
 
-double ShapeTroughCPC::findThit( Ray ray, double theta, bool right ) const
+/*!
+ * Stores at \a roots the profile angles where the ray with origin ( \a ox, \a oy ) and direction ( \a dx, \a dy ) crosses
+ * the profile \a segment and returns the number of crossings. The profile deviation takes the values \a deviation0 and
+ * \a deviation1 at the segment ends, and its derivative takes the values \a slope0 and \a slope1.
+ *
+ * The profile is convex, so the ray is tangent to it at most once inside a segment. A segment whose ends are at
+ * different sides of the ray brackets one crossing. Otherwise, when the deviation derivative changes its sign, the
+ * tangency point splits the segment in two brackets and the ray crosses the segment twice if it is at the other side.
+ */
+int ShapeTroughCPC::FindSegmentRoots( double ox, double oy, double dx, double dy, int segment,
+		double deviation0, double deviation1, double slope0, double slope1, double roots[2] ) const
 {
-
-	double tHit;
-	if( ray.direction().x > 0 )
+	double theta0 = m_profileTheta[segment-1];
+	double theta1 = m_profileTheta[segment];
+	if( ( deviation0 < 0.0 ) != ( deviation1 < 0.0 ) )
 	{
-		double x = ((2 * a.getValue() * (1 + sin(m_thetaI) ) * sin( theta-m_thetaI ))
-				/( 1 - cos(theta ))) - a.getValue();
-
-		if( !right )	x *= -1;
-		tHit = ( x - ray.origin.x ) * ray.invDirection().x;
-	}
-	else
-	{
-		double y = ( 2 * a.getValue() * (1 + sin(m_thetaI) ) *cos( theta-m_thetaI ) )
-				/( 1 - cos(theta) );
-		tHit = ( y - ray.origin.y ) * ray.invDirection().y;
+		roots[0] = FindProfileRoot( ox, oy, dx, dy, theta0, theta1, deviation0, deviation1 );
+		return 1;
 	}
+	if( ( slope0 < 0.0 ) == ( slope1 < 0.0 ) ) return 0;
 
-	return tHit;
+	double thetaTangent = FindProfileTangent( dx, dy, theta0, theta1, slope0 );
+	double derivative;
+	double deviationTangent = ProfileDeviation( thetaTangent, ox, oy, dx, dy, &derivative );
+	if( ( deviationTangent < 0.0 ) == ( deviation0 < 0.0 ) ) return 0;
+
+	roots[0] = FindProfileRoot( ox, oy, dx, dy, theta0, thetaTangent, deviation0, deviationTangent );
+	roots[1] = FindProfileRoot( ox, oy, dx, dy, thetaTangent, theta1, deviationTangent, deviation1 );
+	return 2;
 }
 
-bool ShapeTroughCPC::findRoot( double (*funcion)( double, double, double, Ray ), Ray ray, double r, double thetaI, double a, double b, double y0, int max, double* theta )
+/*!
+ * Returns the profile angle between \a theta0 and \a theta1 where the profile is parallel to the direction ( \a dx, \a dy ).
+ * The derivative of the profile deviation takes the value \a slope0 at \a theta0 and the opposite sign at \a theta1.
+ */
+double ShapeTroughCPC::FindProfileTangent( double dx, double dy, double theta0, double theta1, double slope0 ) const
 {
-
-	double y1 = funcion( a, r, thetaI, ray  );
-	double y2 = funcion( b, r, thetaI, ray );
-
-	double delta = fabs( a - b ) / 100;
-	while( ( ( y1 * y2 ) > 0.0 ) && ( a < b ) )
+	int iterations = 0;
+	while( ( ( theta1 - theta0 ) > 0.000000000001 ) && ( iterations < 100 ) )
 	{
-		a += delta;
-		y1 = funcion( a, r, thetaI, ray  );
+		double theta = ( theta0 + theta1 ) / 2.0;
+		Vector3D dpdtheta = ProfileDerivative( theta );
+		if( ( ( dpdtheta.x * dy - dpdtheta.y * dx ) < 0.0 ) == ( slope0 < 0.0 ) )	theta0 = theta;
+		else	theta1 = theta;
+		iterations++;
 	}
 
-	if( ( ( y1 * y2 ) > 0.0 ) || ( a > b ) ) return false;
+	return ( theta0 + theta1 ) / 2.0;
+}
+
+/*!
+ * Returns the profile angle where the ray with origin ( \a ox, \a oy ) and direction ( \a dx, \a dy ) crosses the profile
+ * between \a theta0 and \a theta1. The profile deviation takes the values \a deviation0 and \a deviation1, with opposite signs,
+ * at the bracket ends. Newton steps that leave the bracket are replaced by bisection steps.
+ */
+double ShapeTroughCPC::FindProfileRoot( double ox, double oy, double dx, double dy, double theta0, double theta1, double deviation0, double deviation1 ) const
+{
+	double theta = theta0 + ( theta1 - theta0 ) * deviation0 / ( deviation0 - deviation1 );
 
 	int iterations = 0;
-	while( ( fabs( a - b ) > 0.000000000001 ) && ( iterations < max ) )
+	while( iterations < 100 )
 	{
-		double x = ( a + b ) / 2.0 ;
-		double y = funcion( x, r, thetaI, ray );
+		double derivative;
+		double deviation = ProfileDeviation( theta, ox, oy, dx, dy, &derivative );
+		if( deviation == 0.0 ) return theta;
 
-		if( y == y0 )
+		if( ( deviation < 0.0 ) == ( deviation0 < 0.0 ) )
 		{
-			*theta = x;
-			return true;
+			theta0 = theta;
+			deviation0 = deviation;
 		}
+		else	theta1 = theta;
 
-		if( ( y > y0 ) && ( y2 > y1 ) ) 	b= x;
-		else if( ( y > y0 ) && ( y2 < y1 ) ) 		a = x;
-		else if( ( y < y0 ) && ( y2 > y1 ) ) 		a= x;
-		else	b = x;
-		iterations++;
+		double thetaNext = theta - deviation / derivative;
+		if( !( ( thetaNext > theta0 ) && ( thetaNext < theta1 ) ) ) thetaNext = ( theta0 + theta1 ) / 2.0;
+		if( fabs( thetaNext - theta ) < 0.000000000001 ) return thetaNext;
 
+		theta = thetaNext;
+		iterations++;
 	}
 
-	if( iterations >= max ) return false;
+	return theta;
+}
 
-	*theta  = ( a + b ) / 2 ;
-	return true;
+/*!
+ * Returns the deviation between the profile point for \a theta and the ray with origin ( \a ox, \a oy ) and direction ( \a dx, \a dy ).
+ * The deviation is zero when the ray crosses the point. Its derivative with respect to \a theta is stored at \a derivative.
+ */
+double ShapeTroughCPC::ProfileDeviation( double theta, double ox, double oy, double dx, double dy, double* derivative ) const
+{
+	Vector3D dpdtheta = ProfileDerivative( theta );
+	*derivative = dpdtheta.x * dy - dpdtheta.y * dx;
+	return ( ProfileX( theta ) - ox ) * dy - ( ProfileY( theta ) - oy ) * dx;
+}
+
+/*!
+ * Returns the derivative of the profile point with respect to \a theta.
+ */
+Vector3D ShapeTroughCPC::ProfileDerivative( double theta ) const
+{
+	double k = 2 * a.getValue() * ( 1 + sin( m_thetaI ) );
+	double c = 1 - cos( theta );
+	double sinTheta = sin( theta - m_thetaI );
+	double cosTheta = cos( theta - m_thetaI );
+
+	double dxdtheta = k * ( cosTheta * c - sinTheta * sin( theta ) ) / ( c * c );
+	double dydtheta = - k * ( sinTheta * c + cosTheta * sin( theta ) ) / ( c * c );
+	return Vector3D( dxdtheta, dydtheta, 0.0 );
+}
+
+double ShapeTroughCPC::ProfileX( double theta ) const
+{
+	return ( ( 2 * a.getValue() * (1 + sin(m_thetaI) ) * sin( theta - m_thetaI ) ) / ( 1 - cos( theta ) ) ) - a.getValue();
+}
+
+double ShapeTroughCPC::ProfileY( double theta ) const
+{
+	return ( 2 * a.getValue() * (1 + sin(m_thetaI) ) * cos( theta - m_thetaI ) ) / ( 1 - cos( theta ) );
+}
+
+/*!
+ * Samples the profile from \a m_thetaMin to the receiver edge. The samples bracket the ray intersections,
+ * so they must be updated each time a profile parameter changes.
+ *
+ * The profile x and y decrease monotonically from 2 * \a m_thetaI to the receiver edge, so the
+ * truncation limit x <= x( m_thetaMin ) is theta >= \a m_thetaMin, the receiver limit x >= a is
+ * theta <= pi / 2 + \a m_thetaI and the height limits hold for every angle in between. Limiting
+ * the samples to this interval replaces the bounds checks of the hit points on the profile plane.
+ */
+void ShapeTroughCPC::SetProfileTable()
+{
+	double thetaMax = ( gc::Pi / 2 ) + m_thetaI;
+
+	m_profileTheta.resize( profileSegments + 1 );
+	m_profileX.resize( profileSegments + 1 );
+	m_profileY.resize( profileSegments + 1 );
+	m_profileDXDTheta.resize( profileSegments + 1 );
+	m_profileDYDTheta.resize( profileSegments + 1 );
+	for( int i = 0; i <= profileSegments; ++i )
+	{
+		double theta = m_thetaMin + i * ( thetaMax - m_thetaMin ) / profileSegments;
+		m_profileTheta[i] = theta;
+		m_profileX[i] = ProfileX( theta );
+		m_profileY[i] = ProfileY( theta );
+
+		Vector3D dpdtheta = ProfileDerivative( theta );
+		m_profileDXDTheta[i] = dpdtheta.x;
+		m_profileDYDTheta[i] = dpdtheta.y;
+	}
 }
@@ -39,6 +39,8 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #ifndef SHAPETROUGHCPC_H_
 #define SHAPETROUGHCPC_H_
 
+#include <vector>
+
 #include <QString>
 
 #include <Inventor/fields/SoSFDouble.h>
@@ -46,6 +48,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 
 #include "trt.h"
 #include "TShape.h"
+#include "Vector3D.h"
 
 class SoFieldSensor;
 
@@ -62,6 +65,8 @@ public:
 	QString GetIcon() const;
 
 	bool Intersect(const Ray &ray, double *tHit, DifferentialGeometry *dg ) const;
+	bool IntersectT( const Ray& objectRay, ShapeHit* hit ) const;
+	void ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const;
 	bool IntersectP( const Ray &ray ) const;
 
 	Point3D Sample( double u, double v) const;
@@ -86,11 +91,24 @@ protected:
 	virtual ~ShapeTroughCPC();
 
 private:
-	double findThit( Ray ray, double theta, bool right ) const;
-	static bool findRoot( double (*funcion)( double, double, double, Ray ), Ray ray, double r, double thetaI, double a, double b, double y0, int max, double* theta );
+	bool IntersectProfile( const Ray& objectRay, double* tHit, double* thetaHit ) const;
+	int FindSegmentRoots( double ox, double oy, double dx, double dy, int segment,
+			double deviation0, double deviation1, double slope0, double slope1, double roots[2] ) const;
+	double FindProfileTangent( double dx, double dy, double theta0, double theta1, double slope0 ) const;
+	double FindProfileRoot( double ox, double oy, double dx, double dy, double theta0, double theta1, double deviation0, double deviation1 ) const;
+	double ProfileDeviation( double theta, double ox, double oy, double dx, double dy, double* derivative ) const;
+	Vector3D ProfileDerivative( double theta ) const;
+	double ProfileX( double theta ) const;
+	double ProfileY( double theta ) const;
+	void SetProfileTable();
 
 	double m_thetaI;
 	double m_thetaMin;
+	std::vector< double > m_profileTheta;
+	std::vector< double > m_profileX;
+	std::vector< double > m_profileY;
+	std::vector< double > m_profileDXDTheta;
+	std::vector< double > m_profileDYDTheta;
 
 	SoFieldSensor* m_aSensor;
 	SoFieldSensor* m_cMaxSensor;
@@ -143,7 +143,16 @@ QString ShapeTroughHyperbola::GetIcon() const
 	return ":/icons/ShapeTroughHyperbola.png";
 }
 
-bool ShapeTroughHyperbola::Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg) const
+bool ShapeTroughHyperbola::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
+
+bool ShapeTroughHyperbola::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
 {
 	double a = a0.getValue();
 	double b = a / tan( m_asymptoticAngle );
@@ -206,11 +215,28 @@ bool ShapeTroughHyperbola::Intersect(const Ray& objectRay, double *tHit, Differe
 				|| hitPoint.y < truncationHeight.getValue() || hitPoint.y > hyperbolaHeight.getValue()
 				|| hitPoint.z < zmin ||  hitPoint.z > zmax )	return false;
 	}
-	// Now check if the fucntion is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) ) gf::SevereError( "Function ShapeSphere::Intersect(...) called with null pointers" );
 
+	hit->tHit = thit;
+	return true;
+}
+
+void ShapeTroughHyperbola::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	double a = a0.getValue();
+	double b = a / tan( m_asymptoticAngle );
+
+	double xMin = sqrt( a * a *
+							( 1 + ( ( truncationHeight.getValue() * truncationHeight.getValue() )
+									/ ( b* b ) ) ) );
+	double xMax = sqrt( a * a * ( 1 +
+				( ( hyperbolaHeight.getValue() * hyperbolaHeight.getValue() )
+						/ ( b * b ) ) ) );
+
+	// Compute hit position
+	Point3D hitPoint = objectRay( hit.tHit );
+
+	double m =  ( zLengthXMax.getValue() / 2- zLengthXMin.getValue() / 2 ) / ( xMax - xMin );
+	double zmax = ( zLengthXMin.getValue()  / 2 ) + m * ( hitPoint.x - xMin );
 
 	// Find parametric representation of CPC concentrator hit
 	double u = ( hitPoint.x - xMin  ) / ( xMax - xMin );
@@ -220,43 +246,8 @@ bool ShapeTroughHyperbola::Intersect(const Ray& objectRay, double *tHit, Differe
 	Vector3D dpdu = GetDPDU( u, v );
 	Vector3D dpdv = GetDPDV( u, v );
 
-	// Compute cylinder \dndu and \dndv
-	double tanAngle = tan( m_asymptoticAngle );
-	double h = hyperbolaHeight.getValue();
-	double t = truncationHeight.getValue();
-	double cotAngle = 1 / tanAngle;
-	double aux1 = sqrt( a * a * (1 + ( ( h * h * tanAngle * tanAngle )/ ( a * a ) ) ) );
-	double aux2 = sqrt( a * a * (1 + ( ( t * t * tanAngle * tanAngle )/ ( a * a ) ) ) );
-	double aux = aux1 - aux2;
-
-	double d2PduuY = - ( ( cotAngle * cotAngle * cotAngle * cotAngle * aux * aux * ( aux2 + u * aux ) )
-						/ pow( ( a * a * cotAngle * cotAngle *
-								( -1 + ( ( ( a + u * aux ) * ( a + u * aux ) )
-										/ ( a * a ) ) ) ), 3.0/ 2 ) )
-					+ ( ( cotAngle * cotAngle * aux * aux )
-						/ sqrt( a * a * cotAngle * cotAngle *
-								( -1 + ( ( ( a + u * aux ) * ( a + u * aux ) )
-										/ ( a * a ) ) ) ) );
-	Vector3D d2Pduu(0 , d2PduuY, 0);
-	Vector3D d2Pduv( 0.0, 0.0, 2 * ( -0.5 * zLengthXMin.getValue() + 0.5 * zLengthXMax.getValue() ) );
-	Vector3D d2Pdvv( 0.0, 0.0, 0.0 );
-
-	// Compute coefficients for fundamental forms
-	double E = DotProduct( dpdu, dpdu );
-	double F = DotProduct( dpdu, dpdv );
-	double G = DotProduct( dpdv, dpdv );
-	Vector3D N = Normalize( CrossProduct( dpdu, dpdv ) );
-
-	double e = DotProduct( N, d2Pduu );
-	double f = DotProduct( N, d2Pduv );
-	double g = DotProduct( N, d2Pdvv );
-
-		// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / (E*G - F*F);
-	Vector3D dndu = (f*F - e*G) * invEGF2 * dpdu +
-			        (e*F - f*E) * invEGF2 * dpdv;
-	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
-	                (f*F - g*E) * invEGF2 * dpdv;
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry( hitPoint ,
@@ -265,16 +256,12 @@ bool ShapeTroughHyperbola::Intersect(const Ray& objectRay, double *tHit, Differe
 		                        dndu,
 								dndv,
 		                        u, v, this );
-
-    // Update _tHit_ for quadric intersection
-    *tHit = thit;
-
-	return true;
 }
 
 bool ShapeTroughHyperbola::IntersectP( const Ray& objectRay ) const
 {
-	return Intersect( objectRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( objectRay, &hit );
 }
 
 Point3D ShapeTroughHyperbola::Sample( double u, double v ) const
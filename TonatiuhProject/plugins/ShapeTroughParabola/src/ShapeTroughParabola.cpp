@@ -121,7 +121,16 @@ QString ShapeTroughParabola::GetIcon() const
 	return QLatin1String( ":/icons/ShapeTroughParabola.png" );
 }
 
-bool ShapeTroughParabola::Intersect(const Ray& objectRay, double *tHit, DifferentialGeometry *dg) const
+bool ShapeTroughParabola::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
+
+bool ShapeTroughParabola::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
 {
 	// Compute quadratic parabolic cylinder coefficients
 	Vector3D vObjectRayOrigin = Vector3D( objectRay.origin );
@@ -184,19 +193,24 @@ bool ShapeTroughParabola::Intersect(const Ray& objectRay, double *tHit, Differen
 			return false;
 	}
 
-	// Now check if the fucntion is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) )	gf::SevereError( "Function ParabolicCyl::Intersect(...) called with null pointers" );
+	hit->tHit = thit;
+	return true;
+}
+
+void ShapeTroughParabola::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	double xmin = xMin.getValue();
+	double xmax = xMax.getValue();
+	double zmax = std::max( lengthXMin.getValue(), lengthXMax.getValue() );
 
 	// Compute definitive parabolic cylinder hit position
-	hitPoint = objectRay( thit );
+	Point3D hitPoint = objectRay( hit.tHit );
 
 	// Find parametric representation of paraboloid hit
 	double u =  hitPoint.x  / focusLength.getValue();
 
-	z1 = ( ( zmax - lengthXMin.getValue() ) / 2 ) + ( (lengthXMin.getValue() - lengthXMax.getValue() ) / ( 2 * ( xmax - xmin ) ) ) * ( hitPoint.x - xmin );
-	z2 = ( ( zmax + lengthXMin.getValue() ) / 2 )  + ( ( (lengthXMax.getValue() - lengthXMin.getValue() ) / ( 2 * ( xmax - xmin ) ) )  * ( hitPoint.x - xmin ) );
+	double z1 = ( ( zmax - lengthXMin.getValue() ) / 2 ) + ( (lengthXMin.getValue() - lengthXMax.getValue() ) / ( 2 * ( xmax - xmin ) ) ) * ( hitPoint.x - xmin );
+	double z2 = ( ( zmax + lengthXMin.getValue() ) / 2 )  + ( ( (lengthXMax.getValue() - lengthXMin.getValue() ) / ( 2 * ( xmax - xmin ) ) )  * ( hitPoint.x - xmin ) );
 
 	double v = ( hitPoint.z - z1 ) / (z2 - z1);
 
@@ -204,42 +218,20 @@ bool ShapeTroughParabola::Intersect(const Ray& objectRay, double *tHit, Differen
 	Vector3D dpdu(1.0, hitPoint.x /( 2.0 * focusLength.getValue() ), 0.0);
 	Vector3D dpdv(0.0, 0.0, 1.0);
 
-	// Compute parabaloid \dndu and \dndv
-	Vector3D d2Pduu ( 0.0, 1.0/( 2.0* focusLength.getValue() ), 0.0 );
-	Vector3D d2Pduv ( 0.0, 0.0, 0.0 );
-	Vector3D d2Pdvv ( 0.0, 0.0, 0.0 );
-
-	// Compute coefficients for fundamental forms
-	double E = DotProduct(dpdu, dpdu);
-	double F = DotProduct(dpdu, dpdv);
-	double G = DotProduct(dpdv, dpdv);
-
 	Vector3D N = Normalize( NormalVector( CrossProduct( dpdu, dpdv ) ) );
 
-	double e = DotProduct(N, d2Pduu);
-	double f = DotProduct(N, d2Pduv);
-	double g = DotProduct(N, d2Pdvv);
-
-	// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / (E*G - F*F);
-	Vector3D dndu = (f*F - e*G) * invEGF2 * dpdu +
-		(e*F - f*E) * invEGF2 * dpdv;
-	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
-		(f*F - g*E) * invEGF2 * dpdv;
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry(hitPoint, dpdu, dpdv, dndu, dndv, u, v, this);
 	dg->shapeFrontSide = ( DotProduct( N, objectRay.direction() ) > 0 ) ? false : true;
-
-	// Update _tHit_ for quadric intersection
-	*tHit = thit;
-
-	return true;
 }
 
 bool ShapeTroughParabola::IntersectP( const Ray& objectRay ) const
 {
-	return Intersect( objectRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( objectRay, &hit );
 }
 
 Point3D ShapeTroughParabola::Sample( double u, double v ) const
@@ -83,6 +83,8 @@ void ShapeTrumpet::initClass()
  */
 ShapeTrumpet::ShapeTrumpet()
 :m_bHyperbola( 0 ),
+ m_rMin( 0 ),
+ m_rMax( 0 ),
  m_lastApertureValue( 0.25 ),
  m_lastFocusHyperbola( 0.32 ),
  m_lastHyperbolaHeightValue( 1.0 ),
@@ -176,7 +178,16 @@ QString ShapeTrumpet::GetIcon() const
  * The ray is transformed to surface coordinates system.
  * If the ray intersects with the surface \a tHit and \a dg arguments are changed with the intersection information.
  */
-bool ShapeTrumpet::Intersect(const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+bool ShapeTrumpet::Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const
+{
+	ShapeHit hit;
+	if( !IntersectT( objectRay, &hit ) ) return false;
+	*tHit = hit.tHit;
+	ComputeDifferentialGeometry( objectRay, hit, dg );
+	return true;
+}
+
+bool ShapeTrumpet::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
 {
 	double a0 = a.getValue();
 	double tH = truncationHeight.getValue();
@@ -209,13 +220,8 @@ bool ShapeTrumpet::Intersect(const Ray& objectRay, double* tHit, DifferentialGeo
 	// Compute ShapeSphere hit position and $\phi$
 	Point3D hitPoint = objectRay( thit );
 
-	double rMin = sqrt( a0 * a0 * ( 1 +
-			( ( tH * tH )
-					/ ( b * b ) ) ) );
-
-	double rMax = sqrt( a0 * a0 * ( 1 +
-			( ( hH * hH )
-					/ ( b * b ) ) ) );
+	double rMin = m_rMin;
+	double rMax = m_rMax;
 
 	double length = sqrt( hitPoint.x * hitPoint.x + hitPoint.z * hitPoint.z );
 
@@ -237,10 +243,19 @@ bool ShapeTrumpet::Intersect(const Ray& objectRay, double* tHit, DifferentialGeo
 				|| length < rMin || length > rMax
 				|| hitPoint.y < tH || hitPoint.y > hH )	return false;
 	}
-	// Now check if the fucntion is being called from IntersectP,
-	// in which case the pointers tHit and dg are 0
-	if( ( tHit == 0 ) && ( dg == 0 ) ) return true;
-	else if( ( tHit == 0 ) || ( dg == 0 ) ) gf::SevereError( "Function ShapeSphere::Intersect(...) called with null pointers" );
+
+	hit->tHit = thit;
+	return true;
+}
+
+void ShapeTrumpet::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const
+{
+	double rMin = m_rMin;
+	double rMax = m_rMax;
+
+	// Compute hit position
+	Point3D hitPoint = objectRay( hit.tHit );
+	double length = sqrt( hitPoint.x * hitPoint.x + hitPoint.z * hitPoint.z );
 
 	// Find parametric representation of CPC concentrator hit
 	double u = ( length - rMin  ) / ( rMax - rMin );
@@ -253,48 +268,8 @@ bool ShapeTrumpet::Intersect(const Ray& objectRay, double* tHit, DifferentialGeo
 	Vector3D dpdu = GetDPDU( u, v );
 	Vector3D dpdv = GetDPDV( u, v );
 
-	// Compute cylinder \dndu and \dndv
-	double h2 = hH;
-	double h1 = tH;
-	double aux1 = - sqrt( a0 * a0 * (1 + ( ( h1 * h1 )/ ( m_bHyperbola * m_bHyperbola ) ) ) );
-	double aux2 = sqrt( a0 * a0 * (1 + ( ( h2 * h2 )/ ( m_bHyperbola * m_bHyperbola ) ) ) );
-
-	double aux = aux1 + aux2;
-
-	double d2PduuY = - ( ( m_bHyperbola * m_bHyperbola * m_bHyperbola * m_bHyperbola * aux * aux * ( -aux1 + u * aux ) * ( -aux1 + u * aux ) )
-						/ ( a0 * a0 * a0 * a0 *
-								pow( m_bHyperbola * m_bHyperbola *
-										( -1 + ( ( ( -aux1 + u * aux ) * ( -aux1 + u * aux ) )
-												/ ( a0 * a0 ) ) ), 3.0/ 2 ) ) )
-					+ ( ( m_bHyperbola * m_bHyperbola * aux * aux )
-						/ ( a0 * a0  *
-								sqrt( m_bHyperbola * m_bHyperbola *
-										( -1 + ( ( ( -aux1 + u * aux ) * ( -aux1 + u * aux ) )
-												/ ( a0 * a0 ) ) ) ) ) );
-	Vector3D d2Pduu(0 , d2PduuY, 0);
-	Vector3D d2Pduv( - gc::TwoPi * sin( gc::TwoPi * v ) * aux,
-			0.0,
-			- gc::TwoPi * cos( gc::TwoPi * v ) * aux );
-	Vector3D d2Pdvv( - gc::TwoPi * gc::TwoPi * cos( gc::TwoPi * v ) * ( -aux1 + u * aux ),
-			0.0,
-			gc::TwoPi * gc::TwoPi * sin( gc::TwoPi * v ) * ( -aux1 + u * aux ) );
-
-	// Compute coefficients for fundamental forms
-	double E = DotProduct( dpdu, dpdu );
-	double F = DotProduct( dpdu, dpdv );
-	double G = DotProduct( dpdv, dpdv );
-	Vector3D N = Normalize( CrossProduct( dpdu, dpdv ) );
-
-	double e = DotProduct( N, d2Pduu );
-	double f = DotProduct( N, d2Pduv );
-	double g = DotProduct( N, d2Pdvv );
-
-		// Compute \dndu and \dndv from fundamental form coefficients
-	double invEGF2 = 1.0 / (E*G - F*F);
-	Vector3D dndu = (f*F - e*G) * invEGF2 * dpdu +
-					(e*F - f*E) * invEGF2 * dpdv;
-	Vector3D dndv = (g*F - f*G) * invEGF2 * dpdu +
-					(f*F - g*E) * invEGF2 * dpdv;
+	Vector3D dndu( 0.0, 0.0, 0.0 );
+	Vector3D dndv( 0.0, 0.0, 0.0 );
 
 	// Initialize _DifferentialGeometry_ from parametric information
 	*dg = DifferentialGeometry( hitPoint ,
@@ -303,11 +278,6 @@ bool ShapeTrumpet::Intersect(const Ray& objectRay, double* tHit, DifferentialGeo
 								dndu,
 								dndv,
 								u, v, this );
-
-	// Update _tHit_ for quadric intersection
-	*tHit = thit;
-
-	return true;
 }
 
 /*!
@@ -315,7 +285,8 @@ bool ShapeTrumpet::Intersect(const Ray& objectRay, double* tHit, DifferentialGeo
  */
 bool ShapeTrumpet::IntersectP( const Ray& objectRay ) const
 {
-	return Intersect( objectRay, 0, 0 );
+	ShapeHit hit;
+	return IntersectT( objectRay, &hit );
 }
 
 /*!
@@ -552,11 +523,17 @@ void ShapeTrumpet::generatePrimitives( SoAction *action )
 }
 
 /*!
- * Computes the asymptotic angle for the input parameters.
+ * Computes the asymptotic angle for the input parameters and the trumpet radius at the truncation and hyperbola heights.
  */
 void ShapeTrumpet::SetBHyperbola()
 {
 	m_bHyperbola = sqrt( -( a.getValue() * a.getValue() ) + ( focusHyperbola.getValue() * focusHyperbola.getValue() ) ) ;
+
+	double a0 = a.getValue();
+	double tH = truncationHeight.getValue();
+	double hH = hyperbolaHeight.getValue();
+	m_rMin = sqrt( a0 * a0 * ( 1 + ( ( tH * tH ) / ( m_bHyperbola * m_bHyperbola ) ) ) );
+	m_rMax = sqrt( a0 * a0 * ( 1 + ( ( hH * hH ) / ( m_bHyperbola * m_bHyperbola ) ) ) );
 }
 
 /*!
@@ -62,6 +62,8 @@ public:
 	QString GetIcon() const;
 
 	bool Intersect(const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const;
+	bool IntersectT( const Ray& objectRay, ShapeHit* hit ) const;
+	void ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const;
 	bool IntersectP( const Ray& objectRay ) const;
 
 	Point3D Sample( double u, double v ) const;
@@ -97,6 +99,8 @@ private:
 	Vector3D GetDPDV ( double u, double v ) const;
 
 	double m_bHyperbola;
+	double m_rMin;
+	double m_rMax;
 	double m_lastApertureValue;
 	double m_lastFocusHyperbola;
 	double m_lastHyperbolaHeightValue;
@@ -11,10 +11,12 @@ INCLUDEPATH += . \
 
 # Input
 HEADERS = src/*.h \
+           	$$(TONATIUH_ROOT)/src/source/raytracing/SunshapeTable.h \
            	$$(TONATIUH_ROOT)/src/source/raytracing/TSunShape.h 
 
 
 SOURCES = src/*.cpp \
+           	$$(TONATIUH_ROOT)/src/source/raytracing/SunshapeTable.cpp \
            	$$(TONATIUH_ROOT)/src/source/raytracing/TSunShape.cpp
 
 RESOURCES += src/SunshapeBuie.qrc	
@@ -36,6 +36,8 @@ Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez
 Juana Amieva, Azael Mancillas, Cesar Cantu.
 ***************************************************************************/
 
+#include <vector>
+
 #include <Inventor/sensors/SoFieldSensor.h>
 
 #include "gc.h"
@@ -44,6 +46,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 
 const double SunshapeBuie::m_minCRSValue = 0.000001;
 const double SunshapeBuie::m_maxCRSValue = 0.849;
+const int SunshapeBuie::m_profileSamples = 1000;
 
 
 SO_NODE_SOURCE(SunshapeBuie);
@@ -67,21 +70,35 @@ SunshapeBuie::SunshapeBuie( )
 	if( csrValue >= m_minCRSValue && csrValue <= m_maxCRSValue ) updateState( csrValue );
 }
 
+/*!
+ * Computes the profile parameters for \a csrValue and tabulates the zenith angle distribution.
+ * The solar disk is sampled uniformly and the circumsolar region, where the radiance follows a power law,
+ * with a geometric progression. Both regions share the solar disk edge angle.
+ */
 void SunshapeBuie::updateState( double csrValue )
 {
     m_thetaSD = 0.00465;
     m_thetaCS = 0.0436;
-    m_deltaThetaCSSD = m_thetaCS - m_thetaSD;
-    m_integralA = 9.224724736098827/1000000.0;
 	m_chi = chiValue( csrValue );
 	m_k = kValue( m_chi );
 	m_gamma = gammaValue( m_chi );
 	m_etokTimes1000toGamma = exp( m_k ) * pow( 1000, m_gamma );
-    m_integralB = intregralB( m_k, m_gamma, m_thetaCS, m_thetaSD );
-    m_alpha = 1.0/( m_integralA + m_integralB );
-    m_heightRectangle1 = 1.001 * pdfTheta( 0.0038915695846209047 );
-    m_heightRectangle2 = pdfTheta( m_thetaSD );
-    m_probabilityRectangle1 = probabilityRectangle1(  m_thetaSD, m_heightRectangle1, (m_thetaCS - m_thetaSD), m_heightRectangle2 );
+
+	std::vector< double > theta;
+	std::vector< double > radiance;
+	for( int i = 0; i <= m_profileSamples; ++i )
+	{
+		double thetaValue = m_thetaSD * i / m_profileSamples;
+		theta.push_back( thetaValue );
+		radiance.push_back( phiSolarDisk( thetaValue ) );
+	}
+	for( int i = 0; i <= m_profileSamples; ++i )
+	{
+		double thetaValue = m_thetaSD * pow( m_thetaCS / m_thetaSD, double( i ) / m_profileSamples );
+		theta.push_back( thetaValue );
+		radiance.push_back( phiCircumSolarRegion( thetaValue ) );
+	}
+	m_zenithAngleTable.SetProfile( theta, radiance );
 }
 
 SunshapeBuie::~SunshapeBuie()
@@ -93,7 +110,7 @@ SunshapeBuie::~SunshapeBuie()
 void SunshapeBuie::GenerateRayDirection( Vector3D& direction, RandomDeviate& rand ) const
 {
 	double phi = gc::TwoPi * rand.RandomDouble();
-    double theta = zenithAngle( rand );
+    double theta = m_zenithAngleTable.SampleTheta( rand.RandomDouble() );
     double sinTheta = sin( theta );
     double cosTheta = cos( theta );
     double cosPhi = cos( phi );
@@ -129,13 +146,7 @@ SoNode* SunshapeBuie::copy( SbBool copyConnections ) const
 	newSunShape->m_etokTimes1000toGamma = m_etokTimes1000toGamma;
 	newSunShape->m_thetaSD = m_thetaSD;
 	newSunShape->m_thetaCS = m_thetaCS;
-	newSunShape->m_deltaThetaCSSD = m_deltaThetaCSSD;
-	newSunShape->m_integralA = m_integralA;
-	newSunShape->m_integralB = m_integralB;
-	newSunShape->m_alpha = m_alpha;
-	newSunShape->m_heightRectangle1 = m_heightRectangle1;
-	newSunShape->m_heightRectangle2 = m_heightRectangle2;
-	newSunShape->m_probabilityRectangle1 = m_probabilityRectangle1;
+	newSunShape->m_zenithAngleTable = m_zenithAngleTable;
 
 	return newSunShape;
 }
@@ -147,28 +158,6 @@ void SunshapeBuie::updateCSR(void *data, SoSensor *)
 	if( csrValue >= m_minCRSValue && csrValue <= m_maxCRSValue ) sunshape->updateState( csrValue );
 }
 
-double SunshapeBuie::zenithAngle( RandomDeviate& rand ) const
-{
-	double theta;
-	double value;
-
-	do
-	{
-		if ( rand.RandomDouble() < m_probabilityRectangle1 )
-		{
-			theta = rand.RandomDouble() * m_thetaSD;
-			value = rand.RandomDouble() * m_heightRectangle1;
-		}
-		else
-		{
-			theta = m_thetaSD + rand.RandomDouble() * m_deltaThetaCSSD;
-			value = rand.RandomDouble() * m_heightRectangle2;
-		}
-	} while ( value > pdfTheta( theta ) );
-
-	return theta;
-}
-
 double SunshapeBuie::chiValue( double csr ) const
 {
 	if( csr > 0.145 )
@@ -204,12 +193,6 @@ double SunshapeBuie::phi( double theta ) const
 	else return phiCircumSolarRegion( theta );
 }
 
-double SunshapeBuie::pdfTheta( double theta ) const
-{
-	// The parameter theta is the zenith angle in radians
-	return m_alpha * phi( theta ) * sin( theta );
-}
-
 double SunshapeBuie::kValue( double chi ) const
 {
 	return 0.9 * log( 13.5 * chi ) * pow( chi, -0.3 );
@@ -219,16 +202,3 @@ double SunshapeBuie::gammaValue( double chi ) const
 {
 	return 2.2 * log( 0.52 * chi ) * pow( chi, 0.43 ) - 0.1;
 }
-
-double SunshapeBuie::intregralB( double k, double gamma, double thetaCS, double thetaSD ) const
-{
-	double gammaPlusTwo = gamma + 2.0;
-	return ( exp( k ) * pow( 1000, gamma ) / gammaPlusTwo ) * ( pow( thetaCS, gammaPlusTwo ) - pow( thetaSD, gammaPlusTwo ) );
-}
-
-double SunshapeBuie::probabilityRectangle1( double widthR1, double heightR1, double widthR2, double heightR2 ) const
-{
-	double areaR1 = widthR1 * heightR1;
-	double areaR2 = widthR2 * heightR2;
-	return areaR1 / ( areaR1 + areaR2 );
-}
@@ -40,6 +40,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #ifndef SUNSHAPEBUIE_H_
 #define SUNSHAPEBUIE_H_
 
+#include "SunshapeTable.h"
 #include "TSunShape.h"
 #include "trt.h"
 
@@ -71,12 +72,8 @@ private:
 	 double phiSolarDisk( double theta ) const;
 	 double phiCircumSolarRegion( double theta ) const;
 	 double phi( double theta ) const;
-	 double pdfTheta( double theta ) const;
-	 double zenithAngle( RandomDeviate& rand ) const;
 	 double kValue( double chi ) const;
 	 double gammaValue( double chi ) const;
-	 double intregralB( double k, double gamma, double thetaCS, double thetaSD ) const;
-	 double probabilityRectangle1( double widthR1, double heightR1, double widthR2, double heightR2 ) const;
 	 void updateState( double csrValue );
 
 	 SoFieldSensor* m_csrSensor;
@@ -87,15 +84,10 @@ private:
 	 double m_etokTimes1000toGamma;
 	 double m_thetaSD;
 	 double m_thetaCS;
-	 double m_deltaThetaCSSD;
-	 double m_integralA;
-	 double m_integralB;
-	 double m_alpha;
-	 double m_heightRectangle1;
-	 double m_heightRectangle2;
-	 double m_probabilityRectangle1;
+	 SunshapeTable m_zenithAngleTable;
 	 static const double m_minCRSValue;// = 0.001;
 	 static const double m_maxCRSValue;// = 0.8;
+	 static const int m_profileSamples;
 };
 
 #endif /* SUNSHAPEBUIE_H_ */
@@ -36,6 +36,8 @@ Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez
 Juana Amieva, Azael Mancillas, Cesar Cantu.
 ***************************************************************************/
 
+#include <Inventor/sensors/SoFieldSensor.h>
+
 #include "gc.h"
 
 #include "SunshapePillbox.h"
@@ -48,24 +50,32 @@ void SunshapePillbox::initClass()
 }
 
 SunshapePillbox::SunshapePillbox( )
+:m_thetaMaxSensor( 0 ),
+ m_sinThetaMax( 0.0 )
 {
 	SO_NODE_CONSTRUCTOR( SunshapePillbox );
 	SO_NODE_ADD_FIELD( irradiance, ( 1000.0 ) );
 	SO_NODE_ADD_FIELD( thetaMax, (0.00465));
 
+	m_thetaMaxSensor = new SoFieldSensor( updateThetaMax, this );
+	m_thetaMaxSensor->setPriority( 0 );
+	m_thetaMaxSensor->attach( &thetaMax );
+
+	m_sinThetaMax = sin( thetaMax.getValue() );
 }
 
 SunshapePillbox::~SunshapePillbox()
 {
+	delete m_thetaMaxSensor;
 }
 
 //Light Interface
 void SunshapePillbox::GenerateRayDirection( Vector3D& direction, RandomDeviate& rand ) const
 {
+	// The zenith angle inverse cumulative distribution gives its sine directly
 	double phi = gc::TwoPi * rand.RandomDouble();
-    double theta = asin( sin( thetaMax.getValue() )*sqrt( rand.RandomDouble() ) );
-    double sinTheta = sin( theta );
-    double cosTheta = cos( theta );
+    double sinTheta = m_sinThetaMax * sqrt( rand.RandomDouble() );
+    double cosTheta = sqrt( 1.0 - sinTheta * sinTheta );
     double cosPhi = cos( phi );
     double sinPhi = sin( phi );
 
@@ -93,6 +103,13 @@ SoNode* SunshapePillbox::copy( SbBool copyConnections ) const
 	// Copy the m_thetaMin, m_thetaMax private members explicitly
 	newSunShape->irradiance = irradiance;
 	newSunShape->thetaMax = thetaMax;
+	newSunShape->m_sinThetaMax = m_sinThetaMax;
 
 	return newSunShape;
 }
+
+void SunshapePillbox::updateThetaMax( void *data, SoSensor *)
+{
+	SunshapePillbox* sunshape = ( SunshapePillbox* ) data;
+	sunshape->m_sinThetaMax = sin( sunshape->thetaMax.getValue() );
+}
@@ -45,6 +45,8 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "TSunShape.h"
 #include "trt.h"
 
+class SoSensor;
+class SoFieldSensor;
 
 class SunshapePillbox : public TSunShape
 {
@@ -64,7 +66,12 @@ public:
 	trt::TONATIUH_REAL thetaMax;
 
 protected:
+	static void updateThetaMax( void *data, SoSensor *);
 	 ~SunshapePillbox();
+
+private:
+	 SoFieldSensor* m_thetaMaxSensor;
+	 double m_sinThetaMax;
 };
 
 #endif /*SUNSHAPEPILLBOX_H_*/
@@ -0,0 +1,30 @@
+
+TEMPLATE      = lib
+CONFIG       += plugin debug_and_release
+
+include( ../../config.pri )
+
+INCLUDEPATH += . \
+			src \
+            $$(TONATIUH_ROOT)/plugins \
+			$$(TONATIUH_ROOT)/src
+
+# Input
+HEADERS = src/*.h \
+           	$$(TONATIUH_ROOT)/src/source/raytracing/SunshapeTable.h \
+           	$$(TONATIUH_ROOT)/src/source/raytracing/TSunShape.h 
+
+
+SOURCES = src/*.cpp \
+           	$$(TONATIUH_ROOT)/src/source/raytracing/SunshapeTable.cpp \
+           	$$(TONATIUH_ROOT)/src/source/raytracing/TSunShape.cpp
+
+RESOURCES += src/SunshapeTabulated.qrc	
+TARGET        = SunshapeTabulated
+
+CONFIG(debug, debug|release) {
+	DESTDIR       = $$(TONATIUH_ROOT)/bin/debug/plugins/SunshapeTabulated	
+}
+else { 
+	DESTDIR       = $$(TONATIUH_ROOT)/bin/release/plugins/SunshapeTabulated
+}
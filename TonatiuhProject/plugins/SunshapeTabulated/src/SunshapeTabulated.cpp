@@ -0,0 +1,198 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <QFile>
+#include <QMessageBox>
+#include <QRegExp>
+#include <QStringList>
+#include <QTextStream>
+
+#include <Inventor/sensors/SoFieldSensor.h>
+
+#include "gc.h"
+
+#include "SunshapeTabulated.h"
+
+
+SO_NODE_SOURCE(SunshapeTabulated);
+
+void SunshapeTabulated::initClass()
+{
+	SO_NODE_INIT_CLASS(SunshapeTabulated, TSunShape, "TSunShape");
+}
+
+SunshapeTabulated::SunshapeTabulated( )
+{
+	SO_NODE_CONSTRUCTOR( SunshapeTabulated );
+	SO_NODE_ADD_FIELD( irradiance, ( 1000 ) );
+	SO_NODE_ADD_FIELD( profileFile, ( "" ) );
+
+	m_profileFileSensor = new SoFieldSensor( updateProfileFile, this );
+	m_profileFileSensor->setPriority( 0 );
+	m_profileFileSensor->attach( &profileFile );
+}
+
+SunshapeTabulated::~SunshapeTabulated()
+{
+	delete m_profileFileSensor;
+}
+
+//Light Interface
+/*!
+ * Generates a sun ray direction. While there is not a valid profile defined, all the rays
+ * have the direction of the sun center.
+ */
+void SunshapeTabulated::GenerateRayDirection( Vector3D& direction, RandomDeviate& rand ) const
+{
+	if( m_zenithAngleTable.IsEmpty() )
+	{
+		direction = Vector3D( 0.0, -1.0, 0.0 );
+		return;
+	}
+
+	double phi = gc::TwoPi * rand.RandomDouble();
+    double theta = m_zenithAngleTable.SampleTheta( rand.RandomDouble() );
+    double sinTheta = sin( theta );
+    double cosTheta = cos( theta );
+    double cosPhi = cos( phi );
+    double sinPhi = sin( phi );
+
+    direction.x = sinTheta*sinPhi;
+    direction.y = -cosTheta;
+    direction.z = sinTheta*cosPhi;
+}
+
+double SunshapeTabulated::GetIrradiance( void ) const
+{
+	return irradiance.getValue();
+}
+
+double SunshapeTabulated::GetThetaMax() const
+{
+	return m_zenithAngleTable.GetThetaMax();
+}
+
+SoNode* SunshapeTabulated::copy( SbBool copyConnections ) const
+{
+	// Use the standard version of the copy method to create
+	// a copy of this instance, including its field data
+	SunshapeTabulated* newSunShape = dynamic_cast< SunshapeTabulated* >( SoNode::copy( copyConnections ) );
+
+	newSunShape->irradiance = irradiance;
+	newSunShape->profileFile = profileFile;
+	newSunShape->m_zenithAngleTable = m_zenithAngleTable;
+
+	return newSunShape;
+}
+
+void SunshapeTabulated::updateProfileFile( void *data, SoSensor *)
+{
+	SunshapeTabulated* sunshape = ( SunshapeTabulated* ) data;
+	sunshape->updateState();
+}
+
+/*!
+ * Reads the profile defined in \a fileName and saves the zenith angles, in radians, to \a theta
+ * and the radiance values to \a radiance.
+ *
+ * Returns false and sets \a errorMessage if the file cannot be read.
+ */
+bool SunshapeTabulated::ReadProfile( QString fileName, std::vector< double >* theta, std::vector< double >* radiance, QString* errorMessage ) const
+{
+	QFile profile( fileName );
+	if( !profile.open( QIODevice::ReadOnly | QIODevice::Text ) )
+	{
+		*errorMessage = QString( "Cannot open the sunshape profile file:\n%1" ).arg( fileName );
+		return false;
+	}
+
+	QTextStream in( &profile );
+	int lineNumber = 0;
+	while( !in.atEnd() )
+	{
+		QString line = in.readLine().trimmed();
+		lineNumber++;
+		if( line.isEmpty() || line.startsWith( QLatin1Char( '#' ) ) ) continue;
+
+		QStringList values = line.split( QRegExp( QLatin1String( "[\\s,]+" ) ), QString::SkipEmptyParts );
+		bool thetaOk = false;
+		bool radianceOk = false;
+		double thetaValue = 0.0;
+		double radianceValue = 0.0;
+		if( values.count() == 2 )
+		{
+			thetaValue = values[0].toDouble( &thetaOk );
+			radianceValue = values[1].toDouble( &radianceOk );
+		}
+		if( !thetaOk || !radianceOk )
+		{
+			*errorMessage = QString( "The line %1 of the sunshape profile file is not valid:\n%2" ).arg( lineNumber ).arg( fileName );
+			return false;
+		}
+
+		theta->push_back( thetaValue / 1000 );
+		radiance->push_back( radianceValue );
+	}
+
+	return true;
+}
+
+/*!
+ * Reads the profile file and tabulates its zenith angle distribution. The table is left
+ * empty if the file is not defined or its profile is not valid.
+ */
+void SunshapeTabulated::updateState()
+{
+	m_zenithAngleTable.Clear();
+
+	QString fileName = QString( profileFile.getValue().getString() );
+	if( fileName.isEmpty() ) return;
+
+	std::vector< double > theta;
+	std::vector< double > radiance;
+	QString errorMessage;
+	if( !ReadProfile( fileName, &theta, &radiance, &errorMessage ) )
+	{
+		QMessageBox::warning( 0, QString( "Tonatiuh" ), errorMessage );
+		return;
+	}
+
+	if( !m_zenithAngleTable.SetProfile( theta, radiance ) )
+		QMessageBox::warning( 0, QString( "Tonatiuh" ),
+				QString( "The sunshape profile must have at least two increasing angles and positive radiance values:\n%1" ).arg( fileName ) );
+}
@@ -0,0 +1,90 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef SUNSHAPETABULATED_H_
+#define SUNSHAPETABULATED_H_
+
+#include <vector>
+
+#include <QString>
+
+#include <Inventor/fields/SoSFString.h>
+
+#include "SunshapeTable.h"
+#include "TSunShape.h"
+#include "trt.h"
+
+class SoSensor;
+class SoFieldSensor;
+
+//!  SunshapeTabulated is a sunshape defined with a measured radial profile.
+/*!
+  The profile is read from a text file. Each line of the file has a zenith angle, in milliradians,
+  and the relative radiance of the sun at that angle. The values can be separated with spaces or commas,
+  and the empty lines and the lines starting with '#' are ignored. The angles must be in increasing order.
+*/
+
+class SunshapeTabulated : public TSunShape
+{
+	SO_NODE_HEADER(SunshapeTabulated);
+
+public:
+	SunshapeTabulated( );
+    static void initClass();
+	SoNode* copy( SbBool copyConnections ) const;
+
+    //Sunshape Interface
+    void GenerateRayDirection( Vector3D& direction, RandomDeviate& rand) const;
+	double GetIrradiance() const;
+    double GetThetaMax() const;
+
+	trt::TONATIUH_REAL irradiance;
+	SoSFString profileFile;
+
+protected:
+	static void updateProfileFile(void *data, SoSensor *);
+	 ~SunshapeTabulated();
+private:
+	 bool ReadProfile( QString fileName, std::vector< double >* theta, std::vector< double >* radiance, QString* errorMessage ) const;
+	 void updateState();
+
+	 SoFieldSensor* m_profileFileSensor;
+	 SunshapeTable m_zenithAngleTable;
+};
+
+#endif /* SUNSHAPETABULATED_H_ */
@@ -13,7 +13,9 @@ SUBDIRS = ComponentHeliostatField \
 			PhotonMapExportFile \
 			PhotonMapExportNull\
 			RandomMersenneTwister \
+			RandomPhilox \
 			RandomRngStream \
+			RandomSobol \
             ShapeBezierSurface \
 			ShapeCAD \
 			ShapeCone \
@@ -35,6 +37,7 @@ SUBDIRS = ComponentHeliostatField \
             ShapeTrumpet \
             SunshapeBuie \
 			SunshapePillbox \
+			SunshapeTabulated \
 			TrackerHeliostat \
             TrackerLinearFresnel \
 			TrackerOneAxis \
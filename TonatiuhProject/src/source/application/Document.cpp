@@ -43,18 +43,53 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include <Inventor/VRMLnodes/SoVRMLBackground.h>
 
 #include <QApplication>
+#include <QFile>
 #include <QString>
 
 #include "Document.h"
+#include "SceneCache.h"
+#include "Timer.h"
 #include "TSceneKit.h"
 
+namespace
+{
+	/*!
+	 * Returns true if the file \a fileName starts with the gzip or bzip2 signature.
+	 */
+	bool IsCompressedFile( const QString& fileName )
+	{
+		QFile file( fileName );
+		if( !file.open( QIODevice::ReadOnly ) )	return false;
+		QByteArray signature = file.read( 3 );
+		return ( signature.startsWith( "\x1f\x8b" ) || signature.startsWith( "BZh" ) );
+	}
+
+	/*!
+	 * Returns the format of the scene file \a fileName. The compressed files are written in binary format,
+	 * and the header of the uncompressed files says if they are binary.
+	 */
+	Document::FileFormat DetectFileFormat( const QString& fileName )
+	{
+		if( IsCompressedFile( fileName ) )	return Document::CompressedBinaryFormat;
+
+		QFile file( fileName );
+		if( !file.open( QIODevice::ReadOnly ) )	return Document::ASCIIFormat;
+		QByteArray header = file.readLine( 80 );
+		if( header.startsWith( "#" ) && header.contains( " binary" ) )	return Document::BinaryFormat;
+		return Document::ASCIIFormat;
+	}
+}
+
 /*!
  * Creates a new document object.
  */
 Document::Document()
 :
   m_scene(0),
-  m_isModified( false )
+  m_isModified( false ),
+  m_fileFormat( ASCIIFormat ),
+  m_readTime( 0.0 ),
+  m_writeTime( 0.0 )
 {
     InitializeScene();
 }
@@ -87,12 +122,13 @@ void Document::InitializeScene()
 }
 
 /*!
- * Initializes the document with a empty scene.
+ * Initializes the document with a empty scene. The new scene is saved in ASCII format.
  */
 void Document::New()
 {
     InitializeScene();
 	m_isModified = false;
+	m_fileFormat = ASCIIFormat;
 }
 
 /*!
@@ -109,16 +145,28 @@ void Document::ClearScene()
 }
 
 /*!
- * Sets the scene form \a fileName to the document.
+ * Sets the scene form \a fileName to the document. If the SceneCache is enabled and the file was already read,
+ * the scene is copied from the cache. The format of the file is set as the document file format, so the scene
+ * is saved in the same format.
  */
 bool Document::ReadFile( const QString& fileName )
 {
-    if( TSceneKit* inputScene = static_cast< TSceneKit* >( GetSceneKitFromFile( fileName ) ) )
+    Timer readTimer;
+    readTimer.Start();
+
+    TSceneKit* inputScene = SceneCache::Copy( fileName );
+    if( !inputScene )	inputScene = GetSceneKitFromFile( fileName );
+
+    readTimer.Stop();
+    m_readTime = readTimer.Time();
+
+    if( inputScene )
 	{
         if ( m_scene ) ClearScene();
 	    m_scene = inputScene;
 	    m_scene->setSearchingChildren( true );
 	    m_isModified = false;
+	    m_fileFormat = DetectFileFormat( fileName );
 
 	    return ( true );
 	}
@@ -127,13 +175,23 @@ bool Document::ReadFile( const QString& fileName )
 }
 
 /*!
- * Writes the document scene to a file with the given \a fileName.
+ * Writes the document scene to a file with the given \a fileName in the document file format.
+ * If the Coin library can not compress the file, the file is written in binary format.
  *
  * Returns true if the scene was successfully written; otherwise returns false.
  */
 bool Document::WriteFile( const QString& fileName )
 {
+    Timer writeTimer;
+    writeTimer.Start();
+
     SoWriteAction SceneOuput;
+
+    //The compression must be set before the file is opened
+   	SceneOuput.getOutput()->setBinary( m_fileFormat != ASCIIFormat );
+   	if( m_fileFormat == CompressedBinaryFormat && !SceneOuput.getOutput()->setCompression( "GZIP", 0.5f ) )
+   		emit Warning( QString( "The file %1 can not be compressed. It is written in binary format." ).arg( fileName ) );
+
     if ( !SceneOuput.getOutput()->openFile( fileName.toLatin1().constData() ) )
 	{
 		QString message = QString( "Cannot open file %1." ).arg( fileName );
@@ -143,14 +201,48 @@ bool Document::WriteFile( const QString& fileName )
    	}
 
     QApplication::setOverrideCursor( Qt::WaitCursor );
-   	SceneOuput.getOutput()->setBinary( false );
    	SceneOuput.apply( m_scene );
    	SceneOuput.getOutput()->closeFile();
    	QApplication::restoreOverrideCursor();
    	m_isModified = false;
+
+   	writeTimer.Stop();
+   	m_writeTime = writeTimer.Time();
 	return true;
 }
 
+/*!
+ * Returns the format used to write the scene files.
+ */
+Document::FileFormat Document::GetFileFormat() const
+{
+    return m_fileFormat;
+}
+
+/*!
+ * Sets the \a format used to write the scene files. The files are written in ASCII format by default.
+ */
+void Document::SetFileFormat( FileFormat format )
+{
+    m_fileFormat = format;
+}
+
+/*!
+ * Returns the time, in seconds, of the last read of a scene file.
+ */
+double Document::GetReadTime() const
+{
+    return m_readTime;
+}
+
+/*!
+ * Returns the time, in seconds, of the last write of a scene file.
+ */
+double Document::GetWriteTime() const
+{
+    return m_writeTime;
+}
+
 /*!
  * Returns whether the scene was modified.
  */
@@ -186,6 +278,8 @@ TSceneKit* Document::GetSceneKitFromFile( const QString& fileName )
 	if( !sceneInput.isValidFile() )
 	{
 		QString message = QString( "Error reading file %1.\n" ).arg( fileName );
+		if( IsCompressedFile( fileName ) )
+			message.append( QLatin1String( "The file is compressed and the Coin library can not read compressed files.\n" ) );
 		emit Warning( message );
 
 		return 0;
@@ -202,6 +296,8 @@ TSceneKit* Document::GetSceneKitFromFile( const QString& fileName )
 		return 0;
 	}
 
-   return static_cast< TSceneKit* >( graphSeparator->getChild(0) );
+   TSceneKit* scene = static_cast< TSceneKit* >( graphSeparator->getChild(0) );
+   SceneCache::Insert( fileName, scene );
+   return scene;
 	return 0;
 }
@@ -57,6 +57,14 @@ class Document : public QObject
     Q_OBJECT
 
 public:
+    //! Formats to write the scene files. The format is detected when a file is read, and it is kept to save the file.
+    enum FileFormat
+    {
+    	ASCIIFormat = 0,
+    	BinaryFormat = 1,
+    	CompressedBinaryFormat = 2
+    };
+
     Document();
     ~Document();
     void SetDocumentModified( bool status );
@@ -64,6 +72,11 @@ public:
     bool ReadFile( const QString& fileName );
     bool WriteFile( const QString& fileName );
 
+    FileFormat GetFileFormat() const;
+    void SetFileFormat( FileFormat format );
+    double GetReadTime() const;
+    double GetWriteTime() const;
+
     bool IsModified( );
     TSceneKit* GetSceneKit() const;
 
@@ -77,6 +90,9 @@ private:
 
     TSceneKit* m_scene;
     bool m_isModified;
+    FileFormat m_fileFormat;
+    double m_readTime;
+    double m_writeTime;
 
 
 };
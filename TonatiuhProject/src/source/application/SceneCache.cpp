@@ -0,0 +1,158 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, I�aki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <QFileInfo>
+
+#include "SceneCache.h"
+#include "TSceneKit.h"
+
+bool SceneCache::m_enabled = false;
+qint64 SceneCache::m_maximumSize = Q_INT64_C( 512 ) * 1024 * 1024;
+qint64 SceneCache::m_size = 0;
+quint64 SceneCache::m_uses = 0;
+QMap< QString, SceneCache::CachedScene > SceneCache::m_scenes;
+
+/*!
+ * Enables the cache if \a enabled is true. Disabling the cache releases the cached scenes.
+ */
+void SceneCache::SetEnabled( bool enabled )
+{
+	m_enabled = enabled;
+	if( !m_enabled )	Clear();
+}
+
+/*!
+ * Releases all the cached scenes.
+ */
+void SceneCache::Clear()
+{
+	QMap< QString, CachedScene >::iterator it = m_scenes.begin();
+	while( it != m_scenes.end() )
+	{
+		it.value().scene->unref();
+		++it;
+	}
+	m_scenes.clear();
+	m_size = 0;
+}
+
+/*!
+ * Sets to \a maximumSize bytes the maximum size of the files of the cached scenes.
+ * The least recently used scenes are released until the cached files fit.
+ */
+void SceneCache::SetMaximumSize( qint64 maximumSize )
+{
+	m_maximumSize = maximumSize;
+	RemoveLeastRecentlyUsed( m_maximumSize );
+}
+
+/*!
+ * Returns a copy of the cached scene of \a fileName. The copy is referenced once.
+ *
+ * Returns null if the cache is disabled, the scene is not cached or the file has changed since it was cached.
+ */
+TSceneKit* SceneCache::Copy( const QString& fileName )
+{
+	if( !m_enabled )	return 0;
+
+	QFileInfo fileInfo( fileName );
+	QMap< QString, CachedScene >::iterator it = m_scenes.find( fileInfo.absoluteFilePath() );
+	if( it == m_scenes.end() )	return 0;
+
+	if( !fileInfo.exists() || fileInfo.lastModified() != it.value().lastModified || fileInfo.size() != it.value().size )
+	{
+		Remove( it );
+		return 0;
+	}
+
+	it.value().lastUsed = ++m_uses;
+	TSceneKit* scene = static_cast< TSceneKit* >( it.value().scene->copy() );
+	scene->ref();
+	return scene;
+}
+
+/*!
+ * Saves a copy of the \a scene read from \a fileName. The \a scene is not modified by the cache.
+ *
+ * If the file is larger than the maximum size, the scene is not cached.
+ */
+void SceneCache::Insert( const QString& fileName, TSceneKit* scene )
+{
+	if( !m_enabled || !scene )	return;
+
+	QFileInfo fileInfo( fileName );
+	QString filePath = fileInfo.absoluteFilePath();
+	QMap< QString, CachedScene >::iterator it = m_scenes.find( filePath );
+	if( it != m_scenes.end() )	Remove( it );
+
+	if( fileInfo.size() > m_maximumSize )	return;
+	RemoveLeastRecentlyUsed( m_maximumSize - fileInfo.size() );
+
+	CachedScene cachedScene;
+	cachedScene.lastModified = fileInfo.lastModified();
+	cachedScene.size = fileInfo.size();
+	cachedScene.lastUsed = ++m_uses;
+	cachedScene.scene = static_cast< TSceneKit* >( scene->copy() );
+	cachedScene.scene->ref();
+	m_scenes.insert( filePath, cachedScene );
+	m_size += cachedScene.size;
+}
+
+/*!
+ * Releases the cached scene \a it.
+ */
+void SceneCache::Remove( QMap< QString, CachedScene >::iterator it )
+{
+	m_size -= it.value().size;
+	it.value().scene->unref();
+	m_scenes.erase( it );
+}
+
+/*!
+ * Releases the least recently used scenes until the size of the cached files is not larger than \a maximumSize.
+ */
+void SceneCache::RemoveLeastRecentlyUsed( qint64 maximumSize )
+{
+	while( ( m_size > maximumSize ) && !m_scenes.isEmpty() )
+	{
+		QMap< QString, CachedScene >::iterator leastRecentlyUsed = m_scenes.begin();
+		for( QMap< QString, CachedScene >::iterator it = m_scenes.begin(); it != m_scenes.end(); ++it )
+			if( it.value().lastUsed < leastRecentlyUsed.value().lastUsed )	leastRecentlyUsed = it;
+		Remove( leastRecentlyUsed );
+	}
+}
@@ -71,6 +71,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "PluginManager.h"
 #include "ScriptRayTracer.h"
 #include "tonatiuh_script.h"
+#include "TracingServer.h"
 
 /*!
   \mainpage
@@ -152,7 +153,22 @@ int main( int argc, char ** argv )
    		QString tonatiuhFile = argv[1];
 
     	QFileInfo fileInfo( tonatiuhFile );
-    	if( fileInfo.completeSuffix() == QLatin1String( "tnhs") )
+    	if( tonatiuhFile == QLatin1String( "--server" ) )
+    	{
+    		//Resident process that runs the jobs of the local clients
+    		QString serverName = ( argc > 2 ) ? QString( argv[2] ) : QString( QLatin1String( "tonatiuh" ) );
+    		delete splash;
+
+    		TracingServer server( &pluginManager );
+    		if( !server.Listen( serverName ) )
+    		{
+    			std::cerr<<server.GetErrorMessage().toStdString()<<std::endl;
+    			return -1;
+    		}
+    		std::cout<<"Tonatiuh server listening on "<<server.GetServerName().toStdString()<<std::endl;
+    		exit = a.exec();
+    	}
+    	else if( fileInfo.completeSuffix() == QLatin1String( "tnhs") )
     	{
 
     		QString fileName( argv[1] );
@@ -204,6 +220,16 @@ int main( int argc, char ** argv )
 
     		}
 
+    		//The callers of the scripts, like the distributed ray tracer workers, check the exit code
+    		if( !mw->GetAbortMessage().isEmpty() )
+    		{
+    			QString errorMessage = QString( "Script Execution Error.\n%1" ).arg( mw->GetAbortMessage() );
+    			std::cerr<<errorMessage.toStdString()<<std::endl;
+    			delete mw;
+    			delete interpreter;
+    			return -1;
+    		}
+
        		delete mw;
        		delete interpreter;
     		exit = 0;
@@ -40,45 +40,77 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 
 #include <Inventor/nodes/SoTransform.h>
 
+#include "gc.h"
 #include "RandomDeviate.h"
 #include "tgf.h"
 #include "Transform.h"
+#include "Vector3D.h"
 
 
 
 
-double tgf::AlternateBoxMuller( RandomDeviate& rand )
+/*!
+ * Generates two independent normal deviates with zero mean and unit variance, \a x1 and \a x2,
+ * with the polar form of the Box-Muller transformation.
+ */
+void tgf::BoxMullerPair( RandomDeviate& rand, double* x1, double* x2 )
 {
-	static bool firsttime = true;
-	static double x1;
-	static double x2;
+	double s = 2;
+	double u1;
+	double u2;
+	while( s > 1 || s == 0 )
+	{
+		u1 = 2 * rand.RandomDouble( ) - 1;
+		u2 = 2 * rand.RandomDouble( ) - 1;
+		s = u1 * u1 + u2 * u2;
+	}
+
+	double z = sqrt( -2 * log( s ) / s );
+	*x1 = z * u1;
+	*x2 = z * u2;
+}
 
-	if (firsttime)
+/*!
+ * Returns a surface normal with a slope error in the local frame of the surface, where y is the surface normal direction.
+ * The slope error follows a pillbox distribution of half width \a sigmaSlope if \a distribution is 0 and a normal
+ * distribution of standard deviation \a sigmaSlope if \a distribution is 1. The returned normal is not normalized.
+ */
+NormalVector tgf::SlopeErrorNormal( double sigmaSlope, int distribution, RandomDeviate& rand )
+{
+	NormalVector errorNormal( 0.0, 1.0, 0.0 );
+	if( distribution == 0 )
 	{
-		double s = 2;
-		double u1;
-		double u2;
-		while(s > 1)
-		{
-	 		u1 = 2 * rand.RandomDouble( ) - 1;
-	 		u2 = 2 * rand.RandomDouble( ) - 1;
-			s = u1 * u1 + u2 * u2;
-		}
-
-		double z = sqrt( -2 * log( s ) / s );
-		x1 = z * u1;
-		x2 = z * u2;
-
-	 	firsttime = false;
-	 	return x1;
+		double phi = gc::TwoPi * rand.RandomDouble();
+		double theta = sigmaSlope * rand.RandomDouble();
+
+		errorNormal.x = sin( theta ) * sin( phi ) ;
+		errorNormal.y = cos( theta );
+		errorNormal.z = sin( theta ) * cos( phi );
 	}
-	else
+	else if( distribution == 1 )
 	{
-		firsttime = true;
-		return x2;
+		double x1;
+		double x2;
+		BoxMullerPair( rand, &x1, &x2 );
+		errorNormal.x = sigmaSlope * x1;
+		errorNormal.z = sigmaSlope * x2;
 	}
+	return errorNormal;
+}
 
+/*!
+ * Returns the unit normal with the \a localNormal components in the surface frame defined by the tangents
+ * \a dpdu, \a dpdv and the \a normal. The tangents are normalized, so it is the same as transforming \a localNormal
+ * with the inverse of the frame matrix without building the transform.
+ */
+NormalVector tgf::NormalFromLocalFrame( const NormalVector& localNormal, const NormalVector& normal, const Vector3D& dpdu, const Vector3D& dpdv )
+{
+	Vector3D s = Normalize( dpdu );
+	Vector3D t = Normalize( dpdv );
 
+	return Normalize( NormalVector( s.x * localNormal.x + normal.x * localNormal.y + t.x * localNormal.z,
+									s.y * localNormal.x + normal.y * localNormal.y + t.y * localNormal.z,
+									s.z * localNormal.x + normal.z * localNormal.y + t.z * localNormal.z ) );
 }
 
 SbMatrix tgf::MatrixFromTransform( const Transform& transform )
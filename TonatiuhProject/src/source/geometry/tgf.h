@@ -39,6 +39,8 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #ifndef TGF_H_
 #define TGF_H_
 
+#include "NormalVector.h"
+
 class SbMatrix;
 class RandomDeviate;
 class SoTransform;
@@ -46,7 +48,9 @@ class Transform;
 
 namespace tgf
 {
-   double AlternateBoxMuller( RandomDeviate& rand );
+	void BoxMullerPair( RandomDeviate& rand, double* x1, double* x2 );
+	NormalVector SlopeErrorNormal( double sigmaSlope, int distribution, RandomDeviate& rand );
+	NormalVector NormalFromLocalFrame( const NormalVector& localNormal, const NormalVector& normal, const Vector3D& dpdu, const Vector3D& dpdv );
 	SbMatrix MatrixFromTransform( const Transform& transform );
 	Transform TransformFromMatrix( SbMatrix const& matrix );
 	Transform TransformFromSoTransform( SoTransform* const & soTransform );
@@ -36,6 +36,7 @@ Contributors: Javier Garcia-Barberena, Inaki Perez, Inigo Pagola,  Gilda Jimenez
 Juana Amieva, Azael Mancillas, Cesar Cantu, Iigo Les.
 ***************************************************************************/
 
+#include <algorithm>
 #include <cmath>
 
 #include <QFileDialog>
@@ -43,7 +44,9 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 #include <QMutex>
 #include <QPair>
 #include <QProgressDialog>
+#include <QThreadPool>
 #include <QtConcurrentMap>
+#include <QVector>
 
 #include <Inventor/actions/SoGetBoundingBoxAction.h>
 #include <Inventor/nodes/SoTransform.h>
@@ -56,7 +59,6 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 #include "TPhotonMap.h"
 #include "gc.h"
 #include "RayTracer.h"
-#include "RayTracerNoTr.h"
 #include "TLightKit.h"
 #include "TLightShape.h"
 #include "Transform.h"
@@ -64,6 +66,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 #include "TShape.h"
 #include "TShapeKit.h"
 #include "TTransmissivity.h"
+#include "Vector3D.h"
 
 /******************************************
  * FluxAnalysis
@@ -79,11 +82,13 @@ m_pCurrentSceneModel( &currentSceneModel ),
 m_pRootSeparatorInstance( rootSeparatorInstance ),
 m_sunWidthDivisions( sunWidthDivisions ),
 m_sunHeightDivisions( sunHeightDivisions ),
+m_raysPerChunk( 0 ),
 m_pRandomDeviate( randomDeviate ),
 m_pPhotonMap( 0 ),
 m_surfaceURL( "" ),
 m_tracedRays( 0 ),
 m_wPhoton( 0 ),
+m_parametricSurface( false ),
 m_photonCounts( 0 ),
 m_heightDivisions( 0 ),
 m_widthDivisions( 0 ),
@@ -95,11 +100,22 @@ m_maximumPhotons( 0 ),
 m_maximumPhotonsXCoord( 0 ),
 m_maximumPhotonsYCoord( 0 ),
 m_maximumPhotonsError( 0 ),
+m_maximumFlux( 0 ),
+m_maximumFluxError( 0 ),
 m_totalPower( 0 )
 {
 
 }
 
+/*!
+ * Sets the number of rays of each ray batch traced by a thread to \a rays.
+ * If \a rays is zero, the batch size is computed from the number of rays and threads.
+ */
+void FluxAnalysis::SetRaysPerChunk( unsigned long rays )
+{
+	m_raysPerChunk = rays;
+}
+
 /*!
  * Destroy FluxAnalysis object
  */
@@ -128,6 +144,7 @@ QString FluxAnalysis::GetSurfaceType( QString nodeURL )
 
 	InstanceNode* instanceNode = m_pCurrentSceneModel->NodeFromIndex( nodeIndex );
 	if( !instanceNode || instanceNode == 0 )	return QLatin1String( "" );
+	if( !instanceNode->GetNode()->getTypeId().isDerivedFrom( TShapeKit::getClassTypeId() ) )	return QLatin1String( "" );
 
 	TShapeKit* shapeKit = static_cast< TShapeKit* > ( instanceNode->GetNode() );
 	if( !shapeKit || shapeKit == 0 )	return QLatin1String( "" );
@@ -138,17 +155,44 @@ QString FluxAnalysis::GetSurfaceType( QString nodeURL )
 	return ( shape->getTypeId().getName().getString() );
 }
 
+/*!
+ * Returns true if the surfaces of type \a surfaceType can be analyzed.
+ *
+ * The (u,v) coordinates of Bezier surfaces are local to each patch, so they do not define a map of the whole surface.
+ */
+bool FluxAnalysis::IsSupportedSurfaceType( QString surfaceType )
+{
+	return ( surfaceType != QLatin1String( "ShapeBezierSurface" ) );
+}
+
+/*!
+ * Returns the reason why the last analysis could not be run.
+ */
+QString FluxAnalysis::GetErrorMessage() const
+{
+	return m_errorMessage;
+}
+
 /*
- * Check if it the selected surface is suitable (cylinder, flat disk or flat rectangle) for the analysis
+ * Check if it the selected surface is suitable for the analysis.
+ * Cylinders, flat disks and flat rectangles are analyzed in their local coordinates and
+ * the other supported shapes in their (u,v) parametric coordinates.
  */
 bool FluxAnalysis::CheckSurface()
 {
 	QString surfaceType = GetSurfaceType( m_surfaceURL );
+	if( surfaceType.isEmpty() )
+	{
+		m_errorMessage = QString( "The surface url %1 is not valid." ).arg( m_surfaceURL );
+		return false;
+	}
 
-	if( ( surfaceType != "ShapeFlatRectangle" ) &&
-		( surfaceType != "ShapeFlatDisk" ) &&
-		( surfaceType != "ShapeCylinder" ) )
+	if( !IsSupportedSurfaceType( surfaceType ) )
+	{
+		m_errorMessage = QString( "The flux analysis is not available for %1 surfaces. "
+				"Their parametric coordinates are local to each patch." ).arg( surfaceType );
 		return false;
+	}
 
 	return true;
 }
@@ -160,32 +204,42 @@ bool FluxAnalysis::CheckSurfaceSide()
 {
 	QString surfaceType = GetSurfaceType( m_surfaceURL );
 
+	bool validSide = true;
 	if( surfaceType == "ShapeFlatRectangle" )
 	{
 		if( ( m_surfaceSide != "FRONT" ) && ( m_surfaceSide != "BACK" ) )
-			return false;
+			validSide = false;
 	}
 	else if( surfaceType == "ShapeFlatDisk" )
 	{
 		if( ( m_surfaceSide != "FRONT" ) && ( m_surfaceSide != "BACK" ) )
-			return false;
+			validSide = false;
 	}
 	else if( surfaceType == "ShapeCylinder" )
 	{
 		if( ( m_surfaceSide != "INSIDE" ) && ( m_surfaceSide != "OUTSIDE" ) )
-			return false;
+			validSide = false;
+	}
+	else
+	{
+		if( ( m_surfaceSide != "FRONT" ) && ( m_surfaceSide != "BACK" ) )
+			validSide = false;
 	}
 
-	return true;
+	if( !validSide )
+		m_errorMessage = QString( "The side %1 is not valid for %2 surfaces." ).arg( m_surfaceSide, surfaceType );
+	return validSide;
 }
 
 /*
- * Fun flux analysis
+ * Sets the surface \a nodeURL and its side \a surfaceSide as the analysis surface
+ * and the analysis grid divisions. The previous photon counts are deleted.
  */
-void FluxAnalysis::RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsigned long nOfRays, bool increasePhotonMap, int heightDivisions, int widthDivisions )
+void FluxAnalysis::SetAnalysisSurface( QString nodeURL, QString surfaceSide, int heightDivisions, int widthDivisions )
 {
 	m_surfaceURL = nodeURL;
 	m_surfaceSide = surfaceSide;
+	m_errorMessage.clear();
 
 	//Delete a photonCounts
 	if( m_photonCounts && m_photonCounts != 0 )
@@ -200,9 +254,107 @@ void FluxAnalysis::RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsign
 	m_photonCounts = 0;
 	m_heightDivisions = heightDivisions;
 	m_widthDivisions = widthDivisions;
+}
+
+/*
+ * Fun flux analysis
+ */
+void FluxAnalysis::RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsigned long nOfRays, bool increasePhotonMap, int heightDivisions, int widthDivisions )
+{
+	//The stored photons can only be increased with the photons of the same surface side
+	bool sameSurface = ( nodeURL == m_surfaceURL ) && ( surfaceSide == m_surfaceSide );
+	SetAnalysisSurface( nodeURL, surfaceSide, heightDivisions, widthDivisions );
+
+	//Check if the surface and the surface side defined is suitable
+	if( CheckSurface() == false || CheckSurfaceSide() == false ) return;
+
+	InstanceNode* surfaceNode = GetSurfaceNode();
+	if( !surfaceNode )	return;
+
+	//Create the photon map where photons are going to be stored
+	if( !m_pPhotonMap  || !increasePhotonMap || !sameSurface )
+	{
+		clearPhotonMap();
+		m_pPhotonMap = new TPhotonMap();
+		m_pPhotonMap->SetBufferSize( HUGE_VAL );
+	}
+
+	QVector< InstanceNode* > exportSuraceList;
+	exportSuraceList.push_back( surfaceNode );
+	if( !TraceRays( exportSuraceList, nOfRays ) )	return;
+
+	StoreSurfacePhotons( m_pPhotonMap->GetAllPhotons() );
+	m_pPhotonMap->EndStore( -1 );
+	UpdatePhotonCounts();
+}
+
+/*
+ * Runs the flux analysis of the surfaces of all the \a surfaceAnalyses with a single ray trace of \a nOfRays rays.
+ *
+ * The surface, side and grid of each analysis must be defined with SetAnalysisSurface. The photons are traced by the
+ * first analysis and each analysis counts the photons of its surface. Any previous results of the analyses are removed.
+ */
+void FluxAnalysis::RunFluxAnalysis( QVector< FluxAnalysis* > surfaceAnalyses, unsigned long nOfRays )
+{
+	if( surfaceAnalyses.count() < 1 )	return;
+
+	QVector< InstanceNode* > exportSuraceList;
+	for( int s = 0; s < surfaceAnalyses.count(); ++s )
+	{
+		FluxAnalysis* surfaceAnalysis = surfaceAnalyses[s];
+		surfaceAnalysis->clearPhotonMap();
+
+		if( surfaceAnalysis->CheckSurface() == false || surfaceAnalysis->CheckSurfaceSide() == false ) return;
+		InstanceNode* surfaceNode = surfaceAnalysis->GetSurfaceNode();
+		if( !surfaceNode )	return;
+		exportSuraceList.push_back( surfaceNode );
+	}
+
+	FluxAnalysis* traceAnalysis = surfaceAnalyses[0];
+	traceAnalysis->m_pPhotonMap = new TPhotonMap();
+	traceAnalysis->m_pPhotonMap->SetBufferSize( HUGE_VAL );
+	if( !traceAnalysis->TraceRays( exportSuraceList, nOfRays ) )	return;
 
+	const std::vector< Photon* >& photonList = traceAnalysis->m_pPhotonMap->GetAllPhotons();
+	for( int s = 0; s < surfaceAnalyses.count(); ++s )
+	{
+		FluxAnalysis* surfaceAnalysis = surfaceAnalyses[s];
+		surfaceAnalysis->m_tracedRays = traceAnalysis->m_tracedRays;
+		surfaceAnalysis->m_wPhoton = traceAnalysis->m_wPhoton;
+		surfaceAnalysis->StoreSurfacePhotons( photonList );
+	}
+	traceAnalysis->m_pPhotonMap->EndStore( -1 );
+
+	for( int s = 0; s < surfaceAnalyses.count(); ++s )
+		surfaceAnalyses[s]->UpdatePhotonCounts();
+}
+
+/*!
+ * Returns the value of each of the \a nSurfaces surfaces from the list \a values separated with ";".
+ * A list with a single value defines the value of all the surfaces.
+ * Returns an empty list if the number of values does not match the number of surfaces.
+ */
+QStringList FluxAnalysis::SurfaceValues( QString values, int nSurfaces )
+{
+	QStringList valueList = values.split( QLatin1String( ";" ), QString::SkipEmptyParts );
+	if( ( nSurfaces < 1 ) || valueList.isEmpty() )	return QStringList();
+	if( valueList.count() == nSurfaces )	return valueList;
+	if( valueList.count() > 1 )	return QStringList();
+
+	QStringList surfaceValues;
+	for( int s = 0; s < nSurfaces; ++s )
+		surfaceValues << valueList[0];
+	return surfaceValues;
+}
+
+/*
+ * Traces \a nOfRays rays and stores in the photon map the photons of the surfaces in \a exportSuraceList.
+ * Returns false if the scene is not ready to trace.
+ */
+bool FluxAnalysis::TraceRays( QVector< InstanceNode* > exportSuraceList, unsigned long nOfRays )
+{
 	//Check if there is a scene
-	if ( !m_pCurrentScene )  return;
+	if ( !m_pCurrentScene )  return false;
 
 	//Check if there is a transmissivity defined
 	TTransmissivity* transmissivity = 0;
@@ -211,56 +363,33 @@ void FluxAnalysis::RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsign
 		transmissivity = static_cast< TTransmissivity* > ( m_pCurrentScene->getPart( "transmissivity", false ) );
 
 	//Check if there is a rootSeparator InstanceNode
-	if( !m_pRootSeparatorInstance ) return;
+	if( !m_pRootSeparatorInstance ) return false;
 
 	InstanceNode* sceneInstance = m_pRootSeparatorInstance->GetParent();
-	if ( !sceneInstance )  return;
+	if ( !sceneInstance )  return false;
 
 	//Check if there is a light and is properly configured
-	if ( !m_pCurrentScene->getPart( "lightList[0]", false ) )return;
+	if ( !m_pCurrentScene->getPart( "lightList[0]", false ) )return false;
 	TLightKit* lightKit = static_cast< TLightKit* >( m_pCurrentScene->getPart( "lightList[0]", false ) );
 
 	InstanceNode* lightInstance = sceneInstance->children[0];
-	if ( !lightInstance ) return;
+	if ( !lightInstance ) return false;
 
-	if( !lightKit->getPart( "tsunshape", false ) ) return;
+	if( !lightKit->getPart( "tsunshape", false ) ) return false;
 	TSunShape* sunShape = static_cast< TSunShape * >( lightKit->getPart( "tsunshape", false ) );
 
-	if( !lightKit->getPart( "icon", false ) ) return;
+	if( !lightKit->getPart( "icon", false ) ) return false;
 	TLightShape* raycastingSurface = static_cast< TLightShape * >( lightKit->getPart( "icon", false ) );
 
-	if( !lightKit->getPart( "transform" ,false ) ) return;
+	if( !lightKit->getPart( "transform" ,false ) ) return false;
 	SoTransform* lightTransform = static_cast< SoTransform * >( lightKit->getPart( "transform" ,false ) );
 
 	//Check if there is a random generator is defined.
-	if( !m_pRandomDeviate || m_pRandomDeviate== 0 )	return;
-
-	//Check if the surface and the surface side defined is suitable
-	if( CheckSurface() == false || CheckSurfaceSide() == false ) return;
-
-	//Create the photon map where photons are going to be stored
-	if( !m_pPhotonMap  || !increasePhotonMap )
-	{
-		if( m_pPhotonMap ) 	m_pPhotonMap->EndStore( -1 );
-		delete m_pPhotonMap;
-		m_pPhotonMap = new TPhotonMap();
-		m_pPhotonMap->SetBufferSize( HUGE_VAL );
-		m_tracedRays = 0;
-		m_wPhoton = 0;
-		m_totalPower = 0;
-	}
-
-	QVector< InstanceNode* > exportSuraceList;
-	QModelIndex nodeIndex = m_pCurrentSceneModel->IndexFromNodeUrl( m_surfaceURL );
-	if( !nodeIndex.isValid()  )	return;
-
-	InstanceNode* surfaceNode = m_pCurrentSceneModel->NodeFromIndex( nodeIndex );
-	if( !surfaceNode || surfaceNode == 0 )	return;
-	exportSuraceList.push_back( surfaceNode );
+	if( !m_pRandomDeviate || m_pRandomDeviate== 0 )	return false;
 
 	//UpdateLightSize();
 	TSeparatorKit* concentratorRoot = static_cast< TSeparatorKit* >( m_pCurrentScene->getPart( "childList[0]", false ) );
-	if ( !concentratorRoot )	return;
+	if ( !concentratorRoot )	return false;
 
 	SoGetBoundingBoxAction* bbAction = new SoGetBoundingBoxAction( SbViewportRegion() ) ;
 	concentratorRoot->getBoundingBox( bbAction );
@@ -284,27 +413,20 @@ void FluxAnalysis::RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsign
 
 	m_pPhotonMap->SetConcentratorToWorld( m_pRootSeparatorInstance->GetIntersectionTransform() );
 
-	QStringList disabledNodes = QString( lightKit->disabledNodes.getValue().getString() ).split( ";", QString::SkipEmptyParts );
+	QSet< QString > disabledNodes = QString( lightKit->disabledNodes.getValue().getString() ).split( ";", QString::SkipEmptyParts ).toSet();
 	QVector< QPair< TShapeKit*, Transform > > surfacesList;
 	trf::ComputeFistStageSurfaceList( m_pRootSeparatorInstance, disabledNodes, &surfacesList );
 	lightKit->ComputeLightSourceArea( m_sunWidthDivisions, m_sunHeightDivisions, surfacesList );
-	if( surfacesList.count() < 1 )	return;
+	if( surfacesList.count() < 1 )	return false;
 
-	QVector< long > raysPerThread;
-	int maximumValueProgressScale = 100;
-
-	unsigned long  t1 = nOfRays/ maximumValueProgressScale;
-	for( int progressCount = 0; progressCount < maximumValueProgressScale; ++ progressCount )
-		raysPerThread<< t1;
-
-	if( ( t1 * maximumValueProgressScale ) < nOfRays )	raysPerThread<< ( nOfRays - ( t1* maximumValueProgressScale) );
+	QVector< long > raysPerThread = trf::ComputeRaysPerThread( nOfRays, m_raysPerChunk );
 
 	Transform lightToWorld = tgf::TransformFromSoTransform( lightTransform );
 	lightInstance->SetIntersectionTransform( lightToWorld.GetInverse() );
 
 	// Create a progress dialog.
 	QProgressDialog dialog;
-	dialog.setLabelText( QString("Progressing using %1 thread(s)..." ).arg( QThread::idealThreadCount() ) );
+	dialog.setLabelText( QString("Progressing using %1 thread(s)..." ).arg( QThreadPool::globalInstance()->maxThreadCount() ) );
 
 	// Create a QFutureWatcher and conncect signals and slots.
 	QFutureWatcher< void > futureWatcher;
@@ -316,19 +438,12 @@ void FluxAnalysis::RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsign
 	QMutex mutex;
 	QMutex mutexPhotonMap;
 	QFuture< void > photonMap;
-	if( transmissivity )
-		photonMap = QtConcurrent::map( raysPerThread, RayTracer( m_pRootSeparatorInstance,
-							 lightInstance, raycastingSurface, sunShape, lightToWorld,
-							 transmissivity,
-							 *m_pRandomDeviate,
-							 &mutex, m_pPhotonMap, &mutexPhotonMap,
-							 exportSuraceList ) );
-	else
-		photonMap = QtConcurrent::map( raysPerThread, RayTracerNoTr( m_pRootSeparatorInstance,
-						lightInstance, raycastingSurface, sunShape, lightToWorld,
-						*m_pRandomDeviate,
-						&mutex, m_pPhotonMap, &mutexPhotonMap,
-						exportSuraceList ) );
+	photonMap = QtConcurrent::map( raysPerThread, RayTracer( m_pRootSeparatorInstance,
+						 lightInstance, raycastingSurface, sunShape, lightToWorld,
+						 transmissivity,
+						 *m_pRandomDeviate,
+						 &mutex, m_pPhotonMap, &mutexPhotonMap,
+						 exportSuraceList ) );
 
 	futureWatcher.setFuture( photonMap );
 
@@ -342,7 +457,7 @@ void FluxAnalysis::RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsign
 	double inputAperture = raycastingSurface->GetValidArea();
 	m_wPhoton = double ( inputAperture * irradiance ) / m_tracedRays;
 
-	UpdatePhotonCounts();
+	return true;
 }
 
 /*
@@ -360,6 +475,7 @@ void FluxAnalysis::UpdatePhotonCounts( int heightDivisions, int widthDivisions )
 
 		delete[] m_photonCounts;
 	}
+	m_photonCounts = 0;
 
 	m_heightDivisions = heightDivisions;
 	m_widthDivisions = widthDivisions;
@@ -368,11 +484,13 @@ void FluxAnalysis::UpdatePhotonCounts( int heightDivisions, int widthDivisions )
 }
 
 /*
- * Update photon counts
+ * Update photon counts from the stored surface photons coordinates.
+ *
+ * The photons are divided into blocks that are counted in parallel and the counts of all the blocks are added.
  */
 void FluxAnalysis::UpdatePhotonCounts()
 {
-	if( !m_pPhotonMap )	return;
+	if( m_tracedRays < 1 )	return;
 
 	//Create a new photonCounts
 	m_photonCounts = new int*[m_heightDivisions];
@@ -387,29 +505,201 @@ void FluxAnalysis::UpdatePhotonCounts()
 	m_maximumPhotonsXCoord = 0;
 	m_maximumPhotonsYCoord = 0;
 	m_maximumPhotonsError = 0;
+	m_maximumFlux = 0;
+	m_maximumFluxError = 0;
+	m_cellAreas.clear();
 
-	QString surfaceType = GetSurfaceType( m_surfaceURL );
+	unsigned long totalPhotons = m_photonsX.size();
+	m_totalPower = totalPhotons * m_wPhoton;
+	if( ( totalPhotons < 1 ) || ( m_heightDivisions < 2 ) || ( m_widthDivisions < 2 ) )	return;
+
+	// Each block has its own counts, so the number of blocks is limited for large grids
+	unsigned long cells = m_heightDivisions * m_widthDivisions;
+	unsigned long nBlocks = totalPhotons / ( 4 * cells + 65536 ) + 1;
+	unsigned long maximumBlocks = QThreadPool::globalInstance()->maxThreadCount();
+	if( nBlocks > maximumBlocks )	nBlocks = maximumBlocks;
+
+	QVector< PhotonCountsBlock > blocks( nBlocks );
+	unsigned long blockSize = ( totalPhotons + nBlocks - 1 ) / nBlocks;
+	for( unsigned long b = 0; b < nBlocks; ++b )
+	{
+		unsigned long firstPhoton = b * blockSize;
+		blocks[b].xCoords = &m_photonsX[0] + firstPhoton;
+		blocks[b].yCoords = &m_photonsY[0] + firstPhoton;
+		blocks[b].nPhotons = std::min( blockSize, totalPhotons - firstPhoton );
+		blocks[b].xmin = m_xmin;
+		blocks[b].xmax = m_xmax;
+		blocks[b].ymin = m_ymin;
+		blocks[b].ymax = m_ymax;
+		blocks[b].widthDivisions = m_widthDivisions;
+		blocks[b].heightDivisions = m_heightDivisions;
+	}
+	QtConcurrent::blockingMap( blocks, &PhotonCountsBlock::CountPhotons );
+
+	std::vector< int > countsError( blocks[0].countsError );
+	for( unsigned long b = 1; b < nBlocks; ++b )
+	{
+		const std::vector< int >& blockCountsError = blocks[b].countsError;
+		for( unsigned int c = 0; c < countsError.size(); ++c )
+			countsError[c] += blockCountsError[c];
+	}
+
+	std::vector< double > cellAreasError;
+	ComputeCellAreas( m_heightDivisions - 1, m_widthDivisions - 1, &cellAreasError );
+	for( unsigned int c = 0; c < countsError.size(); ++c )
+	{
+		double cellFluxError = countsError[c] * m_wPhoton / cellAreasError[c];
+		if( m_maximumFluxError < cellFluxError )
+		{
+			m_maximumFluxError = cellFluxError;
+			m_maximumPhotonsError = countsError[c];
+		}
+	}
+
+	//The cells of parametric surfaces have different areas, so the maximum is the cell with the maximum flux
+	ComputeCellAreas( m_heightDivisions, m_widthDivisions, &m_cellAreas );
+	for( int h = 0; h < m_heightDivisions; h++ )
+	{
+		for( int w = 0; w < m_widthDivisions; w++ )
+		{
+			int cell = h * m_widthDivisions + w;
+			int cellCounts = 0;
+			for( unsigned long b = 0; b < nBlocks; ++b )
+				cellCounts += blocks[b].counts[cell];
+
+			m_photonCounts[h][w] = cellCounts;
+			double cellFlux = cellCounts * m_wPhoton / m_cellAreas[cell];
+			if( m_maximumFlux < cellFlux )
+			{
+				m_maximumFlux = cellFlux;
+				m_maximumPhotons = cellCounts;
+				m_maximumPhotonsXCoord = w;
+				m_maximumPhotonsYCoord = h;
+			}
+		}
+	}
+}
+
+/*
+ * Computes the area of the cells of a grid with \a heightDivisions x \a widthDivisions cells over the analysis surface.
+ *
+ * For parametric surfaces, the shape computes the areas if its points do not follow the parametric coordinates,
+ * like the meshes. Otherwise, the area of each cell is integrated from the shape points on a regular grid of
+ * subcells. If the shape points do not enclose any area, all the cells have the same area.
+ */
+void FluxAnalysis::ComputeCellAreas( int heightDivisions, int widthDivisions, std::vector< double >* cellAreas )
+{
+	double widthCell = ( m_xmax - m_xmin ) / widthDivisions;
+	double heightCell = ( m_ymax - m_ymin ) / heightDivisions;
+	cellAreas->assign( heightDivisions * widthDivisions, widthCell * heightCell );
+	if( !m_parametricSurface )	return;
+
+	InstanceNode* instanceNode = GetSurfaceNode();
+	if( !instanceNode )	return;
+	TShapeKit* surfaceNode = static_cast< TShapeKit* > ( instanceNode->GetNode() );
+	TShape* shape = static_cast< TShape* >( surfaceNode->getPart( "shape", false ) );
+	if( !shape )	return;
+
+	Transform objectToWorld = instanceNode->GetIntersectionTransform().GetInverse();
+	if( shape->ComputeParametricAreas( objectToWorld, heightDivisions, widthDivisions, cellAreas ) )
+	{
+		//The cells without facets have no photons, so any area avoids the division by zero
+		for( unsigned int c = 0; c < cellAreas->size(); ++c )
+			if( !( ( *cellAreas )[c] > 0.0 ) )	( *cellAreas )[c] = widthCell * heightCell;
+		return;
+	}
+
+	//Shape points at the vertices of the subcells
+	const int subdivisions = 4;
+	int uPoints = widthDivisions * subdivisions + 1;
+	int vPoints = heightDivisions * subdivisions + 1;
+	std::vector< Point3D > points( uPoints * vPoints );
+	for( int j = 0; j < vPoints; ++j )
+	{
+		double v = m_ymin + j * ( m_ymax - m_ymin ) / ( vPoints - 1 );
+		for( int i = 0; i < uPoints; ++i )
+		{
+			double u = m_xmin + i * ( m_xmax - m_xmin ) / ( uPoints - 1 );
+			points[j * uPoints + i] = objectToWorld( shape->Sample( u, v ) );
+		}
+	}
+
+	double totalArea = 0.0;
+	for( int h = 0; h < heightDivisions; ++h )
+	{
+		for( int w = 0; w < widthDivisions; ++w )
+		{
+			double cellArea = 0.0;
+			for( int j = h * subdivisions; j < ( h + 1 ) * subdivisions; ++j )
+			{
+				for( int i = w * subdivisions; i < ( w + 1 ) * subdivisions; ++i )
+				{
+					const Point3D& p00 = points[j * uPoints + i];
+					const Point3D& p10 = points[j * uPoints + i + 1];
+					const Point3D& p01 = points[( j + 1 ) * uPoints + i];
+					const Point3D& p11 = points[( j + 1 ) * uPoints + i + 1];
+					cellArea += 0.5 * CrossProduct( p11 - p00, p01 - p10 ).length();
+				}
+			}
+			( *cellAreas )[h * widthDivisions + w] = cellArea;
+			totalArea += cellArea;
+		}
+	}
+
+	if( !( totalArea > 0.0 ) )
+		cellAreas->assign( heightDivisions * widthDivisions, shape->GetArea() / ( heightDivisions * widthDivisions ) );
+	else
+	{
+		//Degenerated cells are not divided by zero
+		for( unsigned int c = 0; c < cellAreas->size(); ++c )
+			if( !( ( *cellAreas )[c] > 0.0 ) )	( *cellAreas )[c] = totalArea / cellAreas->size();
+	}
+}
+
+/*
+ * Returns the instance of the analysis surface. If the surface url is not valid, returns null.
+ */
+InstanceNode* FluxAnalysis::GetSurfaceNode()
+{
 	QModelIndex nodeIndex = m_pCurrentSceneModel->IndexFromNodeUrl( m_surfaceURL );
-	InstanceNode* instanceNode = m_pCurrentSceneModel->NodeFromIndex( nodeIndex );
+	if( !nodeIndex.isValid()  )	return 0;
 
+	return m_pCurrentSceneModel->NodeFromIndex( nodeIndex );
+}
+
+/*
+ * Stores the coordinates of the photons of \a photonList on the analysis surface.
+ */
+void FluxAnalysis::StoreSurfacePhotons( const std::vector< Photon* >& photonList )
+{
+	QString surfaceType = GetSurfaceType( m_surfaceURL );
+	InstanceNode* instanceNode = GetSurfaceNode();
+	if( !instanceNode )	return;
+
+	m_parametricSurface = false;
 	if( surfaceType == "ShapeFlatRectangle" )
 	{
-		FluxAnalysisFlatRectangle( instanceNode );
+		StoreFlatRectanglePhotons( instanceNode, photonList );
 	}
 	else if( surfaceType == "ShapeFlatDisk" )
 	{
-		FluxAnalysisFlatDisk( instanceNode );
+		StoreFlatDiskPhotons( instanceNode, photonList );
 	}
 	else if( surfaceType == "ShapeCylinder" )
 	{
-		FluxAnalysisCylinder( instanceNode );
+		StoreCylinderPhotons( instanceNode, photonList );
+	}
+	else
+	{
+		m_parametricSurface = true;
+		StoreParametricSurfacePhotons( instanceNode, photonList );
 	}
 }
 
 /*
- * Flux Analysis for cylinder surfaces.
+ * Stores the photons of cylinder surfaces.
  */
-void FluxAnalysis::FluxAnalysisCylinder( InstanceNode* node )
+void FluxAnalysis::StoreCylinderPhotons( InstanceNode* node, const std::vector< Photon* >& photonList )
 {
 	if( !node )	return;
 	TShapeKit* surfaceNode = static_cast< TShapeKit* > ( node->GetNode() );
@@ -427,17 +717,6 @@ void FluxAnalysis::FluxAnalysisCylinder( InstanceNode* node )
 	trt::TONATIUH_REAL* phiMaxField = static_cast< trt::TONATIUH_REAL* > ( shape->getField( "phiMax" ) );
 	double phiMax = phiMaxField->getValue();
 
-	int widthDivisionsError = m_widthDivisions-1;
-	int heightDivisionsError = m_heightDivisions-1;
-
-	int** photonCountsError = new int*[heightDivisionsError];
-	for(int i = 0; i < heightDivisionsError; ++i)
-	{
-		photonCountsError[i] = new int[widthDivisionsError];
-		for( int w = 0; w < widthDivisionsError; w++ )
-			photonCountsError[i][w] = 0;
-	}
-
 	int activeSideID = 1;
 	if( m_surfaceSide == "INSIDE" )
 		activeSideID = 0;
@@ -449,56 +728,25 @@ void FluxAnalysis::FluxAnalysisCylinder( InstanceNode* node )
 	m_xmax = phiMax  * radius;
 	m_ymax = length;
 
-	std::vector< Photon* > photonList = m_pPhotonMap->GetAllPhotons();
-	int totalPhotons = 0;
 	for( unsigned int p = 0; p < photonList.size(); p++ )
 	{
 		Photon* photon = photonList[p];
-		if( photon->side == activeSideID )
+		if( ( photon->intersectedSurface == node ) && ( photon->side == activeSideID ) )
 		{
-			totalPhotons++;
 			Point3D photonLocalCoord = worldToObject( photon->pos );
 			double phi  = atan2( photonLocalCoord.y, photonLocalCoord.x );
 			if( phi < 0.0 ) phi += 2* gc::Pi;
-			double arcLength = phi * radius;
-
-			int xbin = floor( ( arcLength - m_xmin )/( m_xmax - m_xmin ) * m_widthDivisions ) ;
-			int ybin = floor( ( photonLocalCoord.z - m_ymin )/( m_ymax - m_ymin ) * m_heightDivisions );
-			m_photonCounts[ybin][xbin] += 1;
-			if( m_maximumPhotons < m_photonCounts[ybin][xbin] )
-			{
-				m_maximumPhotons = m_photonCounts[ybin][xbin];
-				m_maximumPhotonsXCoord = xbin;
-				m_maximumPhotonsYCoord = ybin;
-			}
-
-			int xbinE = floor( ( arcLength - m_xmin )/( m_xmax - m_xmin ) * widthDivisionsError ) ;
-			int ybinE = floor( ( photonLocalCoord.z - m_ymin )/( m_ymax - m_ymin ) * heightDivisionsError );
-			photonCountsError[ybinE][xbinE] += 1;
-			if( m_maximumPhotonsError < photonCountsError[ybinE][xbinE] )
-			{
-				m_maximumPhotonsError = photonCountsError[ybinE][xbinE];
-			}
-		}
-	}
-
-	m_totalPower = totalPhotons * m_wPhoton;
 
-	if( photonCountsError )
-	{
-		for( int h = 0; h < heightDivisionsError; h++ )
-		{
-			delete[] photonCountsError[h];
+			m_photonsX.push_back( phi * radius );
+			m_photonsY.push_back( photonLocalCoord.z );
 		}
-
-		delete[] photonCountsError;
 	}
 }
 
 /*
- * Flux Analysis for flat disk surfaces.
+ * Stores the photons of flat disk surfaces.
  */
-void FluxAnalysis::FluxAnalysisFlatDisk( InstanceNode* node )
+void FluxAnalysis::StoreFlatDiskPhotons( InstanceNode* node, const std::vector< Photon* >& photonList )
 {
 	if( !node )	return;
 	TShapeKit* surfaceNode = static_cast< TShapeKit* > ( node->GetNode() );
@@ -510,17 +758,6 @@ void FluxAnalysis::FluxAnalysisFlatDisk( InstanceNode* node )
 	trt::TONATIUH_REAL* radiusField = static_cast< trt::TONATIUH_REAL* > ( shape->getField( "radius" ) );
 	double radius = radiusField->getValue();
 
-	int widthDivisionsError = m_widthDivisions-1;
-	int heightDivisionsError = m_heightDivisions-1;
-
-	int** photonCountsError = new int*[heightDivisionsError];
-	for(int i = 0; i < heightDivisionsError; ++i)
-	{
-		photonCountsError[i] = new int[widthDivisionsError];
-		for( int w = 0; w < widthDivisionsError; w++ )
-			photonCountsError[i][w] = 0;
-	}
-
 	int activeSideID = 1;
 	if( m_surfaceSide == "BACK" )
 		activeSideID = 0;
@@ -532,52 +769,22 @@ void FluxAnalysis::FluxAnalysisFlatDisk( InstanceNode* node )
 	m_xmax = radius;
 	m_ymax = radius;
 
-	std::vector< Photon* > photonList = m_pPhotonMap->GetAllPhotons();
-	int totalPhotons = 0;
 	for( unsigned int p = 0; p < photonList.size(); p++ )
 	{
 		Photon* photon = photonList[p];
-		if( photon->side == activeSideID )
+		if( ( photon->intersectedSurface == node ) && ( photon->side == activeSideID ) )
 		{
-			totalPhotons++;
 			Point3D photonLocalCoord = worldToObject( photon->pos );
-			int xbin = floor( ( photonLocalCoord.x - m_xmin )/( m_xmax - m_xmin ) * m_widthDivisions );
-			int ybin = floor( ( photonLocalCoord.z - m_ymin )/( m_ymax - m_ymin ) * m_heightDivisions );
-			m_photonCounts[ybin][xbin] += 1;
-			if( m_maximumPhotons < m_photonCounts[ybin][xbin] )
-			{
-				m_maximumPhotons = m_photonCounts[ybin][xbin];
-				m_maximumPhotonsXCoord = xbin;
-				m_maximumPhotonsYCoord = ybin;
-			}
-
-			int xbinE = floor( ( photonLocalCoord.x - m_xmin )/( m_xmax - m_xmin ) * widthDivisionsError ) ;
-			int ybinE = floor( ( photonLocalCoord.z - m_ymin )/( m_ymax - m_ymin ) * heightDivisionsError );
-			photonCountsError[ybinE][xbinE] += 1;
-			if( m_maximumPhotonsError < photonCountsError[ybinE][xbinE] )
-			{
-				m_maximumPhotonsError = photonCountsError[ybinE][xbinE];
-			}
+			m_photonsX.push_back( photonLocalCoord.x );
+			m_photonsY.push_back( photonLocalCoord.z );
 		}
 	}
-
-	m_totalPower = totalPhotons * m_wPhoton;
-
-	if( photonCountsError )
-	{
-		for( int h = 0; h < heightDivisionsError; h++ )
-		{
-			delete[] photonCountsError[h];
-		}
-
-		delete[] photonCountsError;
-	}
 }
 
 /*
- * Flux Analysis for flat rectangle surfaces.
+ * Stores the photons of flat rectangle surfaces.
  */
-void FluxAnalysis::FluxAnalysisFlatRectangle( InstanceNode* node )
+void FluxAnalysis::StoreFlatRectanglePhotons( InstanceNode* node, const std::vector< Photon* >& photonList )
 {
 	if( !node )	return;
 
@@ -593,17 +800,6 @@ void FluxAnalysis::FluxAnalysisFlatRectangle( InstanceNode* node )
 	trt::TONATIUH_REAL* heightField = static_cast< trt::TONATIUH_REAL* > ( shape->getField( "height" ) );
 	double surfaceHeight= heightField->getValue();
 
-	int widthDivisionsError = m_widthDivisions-1;
-	int heightDivisionsError = m_heightDivisions-1;
-
-	int** photonCountsError = new int*[heightDivisionsError];
-	for(int i = 0; i < heightDivisionsError; ++i)
-	{
-		photonCountsError[i] = new int[widthDivisionsError];
-		for( int w = 0; w < widthDivisionsError; w++ )
-			photonCountsError[i][w] = 0;
-	}
-
 	int activeSideID = 1;
 	if( m_surfaceSide == "BACK" )
 		activeSideID = 0;
@@ -615,46 +811,73 @@ void FluxAnalysis::FluxAnalysisFlatRectangle( InstanceNode* node )
 	m_xmax = 0.5 * surfaceHeight;
 	m_ymax = 0.5 * surfaceWidth;
 
-	std::vector< Photon* > photonList = m_pPhotonMap->GetAllPhotons();
-	int totalPhotons = 0;
 	for( unsigned int p = 0; p < photonList.size(); p++ )
 	{
 		Photon* photon = photonList[p];
-		if( photon->side == activeSideID )
+		if( ( photon->intersectedSurface == node ) && ( photon->side == activeSideID ) )
 		{
-			totalPhotons++;
 			Point3D photonLocalCoord = worldToObject( photon->pos );
-			int xbin = floor( ( photonLocalCoord.x - m_xmin )/( m_xmax - m_xmin ) * m_widthDivisions ) ;
-			int ybin = floor( ( photonLocalCoord.z - m_ymin )/( m_ymax - m_ymin ) * m_heightDivisions );
-
-			m_photonCounts[ybin][xbin] += 1;
-			if( m_maximumPhotons < m_photonCounts[ybin][xbin] )
-			{
-				m_maximumPhotons = m_photonCounts[ybin][xbin];
-				m_maximumPhotonsXCoord = xbin;
-				m_maximumPhotonsYCoord = ybin;
-			}
-
-			int xbinE = floor( ( photonLocalCoord.x - m_xmin )/( m_xmax-m_xmin ) * widthDivisionsError ) ;
-			int ybinE = floor( ( photonLocalCoord.z - m_ymin )/( m_ymax-m_ymin ) * heightDivisionsError );
-			photonCountsError[ybinE][xbinE] += 1;
-			if( m_maximumPhotonsError < photonCountsError[ybinE][xbinE] )
-			{
-				m_maximumPhotonsError = photonCountsError[ybinE][xbinE];
-			}
+			m_photonsX.push_back( photonLocalCoord.x );
+			m_photonsY.push_back( photonLocalCoord.z );
 		}
 	}
+}
 
-	m_totalPower = totalPhotons * m_wPhoton;
+/*
+ * Stores the (u,v) parametric coordinates of the photons of any other surface.
+ */
+void FluxAnalysis::StoreParametricSurfacePhotons( InstanceNode* node, const std::vector< Photon* >& photonList )
+{
+	if( !node )	return;
+
+	int activeSideID = 1;
+	if( m_surfaceSide == "BACK" )
+		activeSideID = 0;
 
-	if( photonCountsError )
+	m_xmin = 0.0;
+	m_ymin = 0.0;
+	m_xmax = 1.0;
+	m_ymax = 1.0;
+
+	for( unsigned int p = 0; p < photonList.size(); p++ )
 	{
-		for( int h = 0; h < heightDivisionsError; h++ )
+		Photon* photon = photonList[p];
+		if( ( photon->intersectedSurface == node ) && ( photon->side == activeSideID ) )
 		{
-			delete[] photonCountsError[h];
+			m_photonsX.push_back( photon->u );
+			m_photonsY.push_back( photon->v );
 		}
+	}
+}
+
+/*
+ * Counts the photons of the block in the analysis grid and in the grid with one division less,
+ * that is used to estimate the error. The photons out of the surface limits are counted in the nearest cell.
+ */
+void FluxAnalysis::PhotonCountsBlock::CountPhotons()
+{
+	int widthDivisionsError = widthDivisions - 1;
+	int heightDivisionsError = heightDivisions - 1;
+	counts.assign( widthDivisions * heightDivisions, 0 );
+	countsError.assign( widthDivisionsError * heightDivisionsError, 0 );
+
+	double xScale = widthDivisions / ( xmax - xmin );
+	double yScale = heightDivisions / ( ymax - ymin );
+	double xScaleError = widthDivisionsError / ( xmax - xmin );
+	double yScaleError = heightDivisionsError / ( ymax - ymin );
+
+	for( unsigned long p = 0; p < nPhotons; ++p )
+	{
+		double x = xCoords[p] - xmin;
+		double y = yCoords[p] - ymin;
+
+		int xbin = std::min( std::max( int( floor( x * xScale ) ), 0 ), widthDivisions - 1 );
+		int ybin = std::min( std::max( int( floor( y * yScale ) ), 0 ), heightDivisions - 1 );
+		counts[ybin * widthDivisions + xbin]++;
 
-		delete[] photonCountsError;
+		int xbinE = std::min( std::max( int( floor( x * xScaleError ) ), 0 ), widthDivisionsError - 1 );
+		int ybinE = std::min( std::max( int( floor( y * yScaleError ) ), 0 ), heightDivisionsError - 1 );
+		countsError[ybinE * widthDivisionsError + xbinE]++;
 	}
 }
 
@@ -663,7 +886,7 @@ void FluxAnalysis::FluxAnalysisFlatRectangle( InstanceNode* node )
  */
 void FluxAnalysis::ExportAnalysis( QString directory, QString fileName, bool saveCoords )
 {
-	if( m_pPhotonMap == 0 || !m_pPhotonMap ) return;
+	if( m_tracedRays < 1 ) return;
 
 	if( directory.isEmpty() ) return;
 
@@ -678,7 +901,6 @@ void FluxAnalysis::ExportAnalysis( QString directory, QString fileName, bool sav
 
 	double widthCell = ( m_xmax - m_xmin ) / m_widthDivisions;
 	double heightCell = ( m_ymax - m_ymin ) / m_heightDivisions;
-	double areaCell = widthCell * heightCell;
 
 	if( saveCoords )
 	{
@@ -688,7 +910,7 @@ void FluxAnalysis::ExportAnalysis( QString directory, QString fileName, bool sav
 		{
 			for( int j = 0; j < m_widthDivisions; j++ )
 			{
-				out<< m_xmin + widthCell/2 + j * widthCell  << "\t" << m_ymin + heightCell/2 + i * heightCell <<  "\t" << m_photonCounts[i][j] * m_wPhoton / areaCell << "\n";
+				out<< m_xmin + widthCell/2 + j * widthCell  << "\t" << m_ymin + heightCell/2 + i * heightCell <<  "\t" << m_photonCounts[i][j] * m_wPhoton / cellAreaValue( i, j ) << "\n";
 			}
 		}
 	}
@@ -698,7 +920,7 @@ void FluxAnalysis::ExportAnalysis( QString directory, QString fileName, bool sav
 		{
 			for( int j = 0; j < m_widthDivisions; j++ )
 			{
-				out<< m_photonCounts[m_heightDivisions-1-i][j] * m_wPhoton / areaCell << "\t";
+				out<< m_photonCounts[m_heightDivisions-1-i][j] * m_wPhoton / cellAreaValue( m_heightDivisions-1-i, j ) << "\t";
 			}
 			out<<"\n" ;
 		}
@@ -778,6 +1000,30 @@ int FluxAnalysis::maximumPhotonsErrorValue()
 	return m_maximumPhotonsError;
 }
 
+/*
+ * Returns m_maximumFlux value.
+ */
+double FluxAnalysis::maximumFluxValue()
+{
+	return m_maximumFlux;
+}
+
+/*
+ * Returns m_maximumFluxError value.
+ */
+double FluxAnalysis::maximumFluxErrorValue()
+{
+	return m_maximumFluxError;
+}
+
+/*
+ * Returns the area of the cell \a heightIndex, \a widthIndex of the analysis grid.
+ */
+double FluxAnalysis::cellAreaValue( int heightIndex, int widthIndex )
+{
+	return m_cellAreas[heightIndex * m_widthDivisions + widthIndex];
+}
+
 /*
  * Returns m_wPhoton value.
  */
@@ -802,6 +1048,9 @@ void FluxAnalysis::clearPhotonMap()
 	if( m_pPhotonMap ) 	m_pPhotonMap->EndStore( -1 );
 	delete m_pPhotonMap;
 	m_pPhotonMap = 0;
+	m_photonsX.clear();
+	m_photonsY.clear();
+	m_cellAreas.clear();
 	m_tracedRays = 0;
 	m_wPhoton = 0;
 	m_totalPower = 0;
@@ -39,11 +39,17 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 #ifndef FLUXANALYSIS_H_
 #define FLUXANALYSIS_H_
 
+#include <vector>
+
+#include <QStringList>
+#include <QVector>
+
 class TSceneKit;
 class SceneModel;
 class InstanceNode;
 class RandomDeviate;
 class TPhotonMap;
+struct Photon;
 
 
 class FluxAnalysis
@@ -54,7 +60,13 @@ public:
 			int sunWidthDivisions, int sunHeightDivisions, RandomDeviate* randomDeviate);
 	~FluxAnalysis();
 	QString GetSurfaceType( QString nodeURL );
+	static bool IsSupportedSurfaceType( QString surfaceType );
+	QString GetErrorMessage() const;
+	void SetRaysPerChunk( unsigned long rays );
+	void SetAnalysisSurface( QString nodeURL, QString surfaceSide, int heightDivisions, int widthDivisions );
 	void RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsigned long nOfRays, bool increasePhotonMap, int heightDivisions, int widthDivisions );
+	static void RunFluxAnalysis( QVector< FluxAnalysis* > surfaceAnalyses, unsigned long nOfRays );
+	static QStringList SurfaceValues( QString values, int nSurfaces );
 	void UpdatePhotonCounts( int heightDivisions, int widthDivisions );
 	void ExportAnalysis( QString directory, QString fileName, bool saveCoords );
 	int** photonCountsValue();
@@ -66,6 +78,9 @@ public:
 	int maximumPhotonsXCoordValue();
 	int maximumPhotonsYCoordValue();
 	int maximumPhotonsErrorValue();
+	double maximumFluxValue();
+	double maximumFluxErrorValue();
+	double cellAreaValue( int heightIndex, int widthIndex );
 	double wPhotonValue();
 	double totalPowerValue();
 	void clearPhotonMap();
@@ -73,16 +88,40 @@ public:
 private:
 	bool CheckSurface();
 	bool CheckSurfaceSide();
+	void ComputeCellAreas( int heightDivisions, int widthDivisions, std::vector< double >* cellAreas );
+	InstanceNode* GetSurfaceNode();
+	bool TraceRays( QVector< InstanceNode* > exportSuraceList, unsigned long nOfRays );
 	void UpdatePhotonCounts();
-	void FluxAnalysisCylinder( InstanceNode* node );
-	void FluxAnalysisFlatDisk( InstanceNode* node );
-	void FluxAnalysisFlatRectangle( InstanceNode* node );
+	void StoreSurfacePhotons( const std::vector< Photon* >& photonList );
+	void StoreCylinderPhotons( InstanceNode* node, const std::vector< Photon* >& photonList );
+	void StoreFlatDiskPhotons( InstanceNode* node, const std::vector< Photon* >& photonList );
+	void StoreFlatRectanglePhotons( InstanceNode* node, const std::vector< Photon* >& photonList );
+	void StoreParametricSurfacePhotons( InstanceNode* node, const std::vector< Photon* >& photonList );
+
+	//! Photon counts of a block of the surface photons.
+	struct PhotonCountsBlock
+	{
+		void CountPhotons();
+
+		const float* xCoords;
+		const float* yCoords;
+		unsigned long nPhotons;
+		double xmin;
+		double xmax;
+		double ymin;
+		double ymax;
+		int widthDivisions;
+		int heightDivisions;
+		std::vector< int > counts;
+		std::vector< int > countsError;
+	};
 
 	TSceneKit* m_pCurrentScene;
 	SceneModel* m_pCurrentSceneModel;
 	InstanceNode* m_pRootSeparatorInstance;
 	int m_sunWidthDivisions;
 	int m_sunHeightDivisions;
+	unsigned long m_raysPerChunk;
 	RandomDeviate* m_pRandomDeviate;
 
 	TPhotonMap* m_pPhotonMap;
@@ -91,6 +130,9 @@ private:
 	QString m_surfaceSide;
 	unsigned long m_tracedRays;
 	double m_wPhoton;
+	std::vector< float > m_photonsX;
+	std::vector< float > m_photonsY;
+	bool m_parametricSurface;
 
 	int** m_photonCounts;
 	int m_heightDivisions;
@@ -103,7 +145,11 @@ private:
 	int m_maximumPhotonsXCoord;
 	int m_maximumPhotonsYCoord;
 	int m_maximumPhotonsError;
+	double m_maximumFlux;
+	double m_maximumFluxError;
+	std::vector< double > m_cellAreas;
 	double m_totalPower;
+	QString m_errorMessage;
 
 protected:
 
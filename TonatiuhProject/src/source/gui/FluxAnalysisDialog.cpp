@@ -56,7 +56,6 @@ Juana Amieva, Azael Mancillas, Cesar Cantu, I
 #include "InstanceNode.h"
 #include "RandomDeviate.h"
 #include "RayTracer.h"
-#include "RayTracerNoTr.h"
 #include "SceneModel.h"
 #include "SelectSurfaceDialog.h"
 #include "TLightKit.h"
@@ -182,7 +181,13 @@ void FluxAnalysisDialog::ChangeCurrentSurface()
 	if( !selectedSurfaceURL.isEmpty() && ( selectedSurfaceURL != m_currentSurfaceURL ) )
 	{
 		QString surfaceType = m_fluxAnalysis->GetSurfaceType( selectedSurfaceURL );
-		if( !surfaceType.isEmpty() && ( surfaceType == "ShapeCylinder" || surfaceType == "ShapeFlatDisk" || surfaceType == "ShapeFlatRectangle" ) )
+		if( !surfaceType.isEmpty() && !FluxAnalysis::IsSupportedSurfaceType( surfaceType ) )
+		{
+			QMessageBox::warning( this, tr( "Tonatiuh" ),
+					tr( "The flux analysis is not available for %1 surfaces." ).arg( surfaceType ) );
+			surfaceEdit->setText( m_currentSurfaceURL );
+		}
+		else if( !surfaceType.isEmpty() )
 		{
 			m_fluxAnalysis->clearPhotonMap();
 			appendCheck->setChecked( false );
@@ -326,6 +331,11 @@ void FluxAnalysisDialog::Run()
 	QString surfaceSide = sidesCombo->currentText();
 	bool increasePhotonMap = ( appendCheck->isEnabled() && appendCheck->isChecked() );
 	m_fluxAnalysis->RunFluxAnalysis( m_currentSurfaceURL, surfaceSide, nOfRays.toInt() , increasePhotonMap, heightDivisions.toInt(), widthDivisions.toInt() );
+	if( !m_fluxAnalysis->GetErrorMessage().isEmpty() )
+	{
+		QMessageBox::warning( this, QLatin1String( "Tonatiuh" ), m_fluxAnalysis->GetErrorMessage() );
+		return;
+	}
 
 	UpdateAnalysis();
 	appendCheck->setEnabled( true );
@@ -370,15 +380,18 @@ void FluxAnalysisDialog::UpdateAnalysis()
 	int heightDivisions = heightValue.toInt();
 	double widthCell = ( xmax - xmin ) / widthDivisions;
 	double heightCell = ( ymax - ymin ) / heightDivisions;
-	double areaCell = widthCell * heightCell;
-	double maximumFlux = ( m_fluxAnalysis->maximumPhotonsValue() * wPhoton) / areaCell;
+	double maximumFlux = m_fluxAnalysis->maximumFluxValue();
 	double minimumFlux = 0;
-	double totalFlux = totalPower / areaCell;
-	double averageFlux = totalFlux / ( widthDivisions * heightDivisions );
+	double totalArea = 0.0;
+	for ( int xIndex=0; xIndex < widthDivisions; ++xIndex )
+		for ( int yIndex=0; yIndex < heightDivisions; ++yIndex )
+			totalArea += m_fluxAnalysis->cellAreaValue( yIndex, xIndex );
+	double averageFlux = totalPower / totalArea;
 	double maxXCoord = xmin + ( m_fluxAnalysis->maximumPhotonsXCoordValue() + 0.5 ) * widthCell;
 	double maxYCoord = ymin + ( m_fluxAnalysis->maximumPhotonsYCoordValue() + 0.5 ) * heightCell;
-	double maximumFluxError = ( m_fluxAnalysis->maximumPhotonsErrorValue() * wPhoton) / ( ( ( xmax - xmin) / ( widthDivisions - 1 ) ) * ( ( ymax - ymin) / ( heightDivisions - 1 ) ) );
+	double maximumFluxError = m_fluxAnalysis->maximumFluxErrorValue();
 	double error = fabs( maximumFlux - maximumFluxError ) / maximumFlux;
+	double totalFlux = 0.0;
 	double gravityX = 0.0;
 	double gravityY = 0.0;
 	double E = 0;
@@ -387,8 +400,9 @@ void FluxAnalysisDialog::UpdateAnalysis()
 	{
 		for ( int yIndex=0; yIndex < heightDivisions; ++yIndex )
 		{
-			double cellFlux = photonCounts[yIndex][xIndex] * wPhoton / areaCell;
+			double cellFlux = photonCounts[yIndex][xIndex] * wPhoton / m_fluxAnalysis->cellAreaValue( yIndex, xIndex );
 			if( minimumFlux > cellFlux )	minimumFlux = cellFlux;
+			totalFlux += cellFlux;
 
 			gravityX += cellFlux * ( xmin + ( xIndex + 0.5 ) * widthCell  );
 			gravityY += cellFlux * ( ymin + ( yIndex + 0.5 ) * heightCell  );
@@ -452,14 +466,11 @@ void FluxAnalysisDialog::UpdateFluxMapPlot( int** photonCounts, double wPhoton,
 	colorMap->data()->setRange( QCPRange( xmin, xmax ), QCPRange( ymin, ymax ) ); // and span the coordinate range -4..4 in both key (x) and value (y) dimensions
 
 	//Assign flux data
-	double widthCell = ( xmax - xmin ) / widthDivisions;
-	double heightCell = ( ymax - ymin ) / heightDivisions;
-	double areaCell = widthCell * heightCell;
 	for ( int xIndex=0; xIndex < widthDivisions; ++xIndex )
 	{
 		for ( int yIndex=0; yIndex < heightDivisions; ++yIndex )
 		{
-			double cellFlux = photonCounts[yIndex][xIndex] * wPhoton / areaCell;
+			double cellFlux = photonCounts[yIndex][xIndex] * wPhoton / m_fluxAnalysis->cellAreaValue( yIndex, xIndex );
 			colorMap->data()->setCell( xIndex, yIndex, cellFlux );
 		}
 	}
@@ -549,7 +560,6 @@ void FluxAnalysisDialog::UpdateSectorPlots( int** photonCounts, double wPhoton,
 
 	double widthCell = ( xmax - xmin ) / widthDivisions;
 	double heightCell = ( ymax - ymin ) / heightDivisions;
-	double areaCell = widthCell * heightCell;
 
 	int xbin1Index = floor( ( xCoordSector - xmin ) / ( xmax - xmin ) * widthDivisions );
 	if( xbin1Index >= widthDivisions ) xbin1Index = widthDivisions - 1;
@@ -561,14 +571,14 @@ void FluxAnalysisDialog::UpdateSectorPlots( int** photonCounts, double wPhoton,
 	for( int i = 0; i < heightDivisions; ++i)
 	{
 		verticalXValues[i] = ymin + ( i + 0.5 ) * heightCell;
-		verticalYValues[i] = photonCounts[i][xbin1Index] * wPhoton / areaCell;
+		verticalYValues[i] = photonCounts[i][xbin1Index] * wPhoton / m_fluxAnalysis->cellAreaValue( i, xbin1Index );
 	}
 
 	QVector<double> horizontalXValues( widthDivisions ), horizontalYValues( widthDivisions ); // initialize with entries 0..100
 	for( int i = 0; i < widthDivisions; ++i)
 	{
 		horizontalXValues[i] = xmin + ( i + 0.5 ) * widthCell;
-		horizontalYValues[i] = photonCounts[ybin1Index][i] * wPhoton / areaCell;
+		horizontalYValues[i] = photonCounts[ybin1Index][i] * wPhoton / m_fluxAnalysis->cellAreaValue( ybin1Index, i );
 	}
 
 	// create graph and assign data to it:
@@ -643,10 +653,7 @@ void FluxAnalysisDialog::UpdateSectorPlotSlot()
 	QString  heightValue = gridHeightLine->text();
 	int widthDivisions = withValue.toInt();
 	int heightDivisions = heightValue.toInt();
-	double widthCell = ( xmax - xmin ) / widthDivisions;
-	double heightCell = ( ymax - ymin ) / heightDivisions;
-	double areaCell = widthCell * heightCell;
-	double maximumFlux = ( m_fluxAnalysis->maximumPhotonsValue() * wPhoton) / areaCell;
+	double maximumFlux = m_fluxAnalysis->maximumFluxValue();
 	UpdateSectorPlots( photonCounts, wPhoton, widthDivisions, heightDivisions, xmin, ymin, xmax, ymax, maximumFlux );
 }
 
@@ -667,9 +674,6 @@ void FluxAnalysisDialog::SelectExportFile()
 void FluxAnalysisDialog::SelectSurface()
 {
 	SelectSurfaceDialog selectSurfaceDialog( *m_pCurrentSceneModel, false, this );
-	selectSurfaceDialog.SetShapeTypeFilters( QVector< QString >()<< QLatin1String( "ShapeFlatRectangle")
-			<< QLatin1String( "ShapeFlatDisk")
-			<< QLatin1String( "ShapeCylinder") );
 	if( !selectSurfaceDialog.exec( ) )	return;
 
 	QString selectedSurfaceURL = selectSurfaceDialog.GetSelectedSurfaceURL();
@@ -756,5 +760,10 @@ void FluxAnalysisDialog::UpdateSurfaceSides( QString selectedSurfaceURL )
 			sidesCombo->addItem( QLatin1String( "INSIDE" ) );
 			sidesCombo->addItem( QLatin1String( "OUTSIDE" ) );
 		}
+		else
+		{
+			sidesCombo->addItem( QLatin1String( "FRONT" ) );
+			sidesCombo->addItem( QLatin1String( "BACK" ) );
+		}
 	}
 }
@@ -0,0 +1,434 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QTextStream>
+#include <QtConcurrentMap>
+
+#include <Inventor/fields/SoField.h>
+
+#include "gc.h"
+#include "HeliostatFieldAnalysis.h"
+#include "InstanceNode.h"
+#include "ParallelRandomDeviate.h"
+#include "Ray.h"
+#include "SceneModel.h"
+#include "trf.h"
+#include "trt.h"
+#include "TSceneKit.h"
+#include "TSeparatorKit.h"
+#include "TShape.h"
+#include "TShapeKit.h"
+#include "TTrackerForAiming.h"
+
+/*!
+ * Creates an analysis of the heliostats under \a rootSeparatorInstance for the sun position of \a currentScene.
+ * The probe points are sampled with \a randomDeviate.
+ */
+HeliostatFieldAnalysis::HeliostatFieldAnalysis( TSceneKit* currentScene, SceneModel& currentSceneModel, InstanceNode* rootSeparatorInstance, RandomDeviate* randomDeviate )
+:m_pCurrentScene( currentScene ),
+m_pCurrentSceneModel( &currentSceneModel ),
+m_pRootSeparatorInstance( rootSeparatorInstance ),
+m_pRandomDeviate( randomDeviate )
+{
+
+}
+
+HeliostatFieldAnalysis::~HeliostatFieldAnalysis()
+{
+
+}
+
+/*!
+ * Computes the cosine factor and the shading and blocking losses of all the heliostats with \a probeRays probe points for each heliostat.
+ * Returns false if the analysis cannot be run. The reason is returned by GetErrorMessage.
+ */
+bool HeliostatFieldAnalysis::RunAnalysis( unsigned long probeRays )
+{
+	m_heliostats.clear();
+	m_skippedHeliostats.clear();
+	m_errorMessage.clear();
+
+	if( !m_pCurrentScene || !m_pRootSeparatorInstance )
+	{
+		m_errorMessage = QLatin1String( "There is no scene defined." );
+		return false;
+	}
+	if( !m_pRandomDeviate )
+	{
+		m_errorMessage = QLatin1String( "There is no random generator defined." );
+		return false;
+	}
+	if( probeRays < 1 )
+	{
+		m_errorMessage = QLatin1String( "The number of probe rays must be greater than zero." );
+		return false;
+	}
+
+	double azimuth = m_pCurrentScene->azimuth.getValue();
+	double zenith = m_pCurrentScene->zenith.getValue();
+	if( zenith >= 0.5 * gc::Pi )
+	{
+		m_errorMessage = QLatin1String( "The sun is below the horizon." );
+		return false;
+	}
+	Vector3D sunVector( sin( azimuth ) * sin( zenith ), cos( zenith ), -sin( zenith ) * cos( azimuth ) );
+
+	m_pCurrentSceneModel->UpdateSceneModel();
+
+	//Compute bounding boxes and world to object transforms
+	trf::ComputeSceneTreeMap( m_pRootSeparatorInstance, Transform( new Matrix4x4 ), true );
+
+	for( int index = 0; index < m_pRootSeparatorInstance->children.count(); ++index )
+		FindHeliostats( m_pRootSeparatorInstance->children[index] );
+	if( m_heliostats.count() < 1 )
+	{
+		if( m_skippedHeliostats.count() > 0 )
+			m_errorMessage = QString( "The surfaces of the heliostats cannot be sampled: %1." ).arg( m_skippedHeliostats.join( QLatin1String( ", " ) ) );
+		else
+			m_errorMessage = QLatin1String( "There are no heliostats with aiming point in the scene." );
+		return false;
+	}
+
+	FindBlockingCandidates();
+
+	QMutex mutex;
+	for( int h = 0; h < m_heliostats.count(); ++h )
+	{
+		Heliostat& heliostat = m_heliostats[h];
+		heliostat.sceneNode = m_pRootSeparatorInstance;
+		heliostat.sunVector = sunVector;
+		heliostat.probeRays = probeRays;
+		heliostat.randomDeviate = m_pRandomDeviate;
+		heliostat.mutex = &mutex;
+	}
+	QtConcurrent::blockingMap( m_heliostats, &Heliostat::Probe );
+
+	return true;
+}
+
+/*!
+ * Saves the results of each heliostat into the file \a fileName of the \a directory.
+ * The skipped heliostats are listed after the results.
+ * Returns false if the file cannot be written.
+ */
+bool HeliostatFieldAnalysis::ExportAnalysis( QString directory, QString fileName ) const
+{
+	if( directory.isEmpty() || fileName.isEmpty() )	return false;
+
+	QFileInfo exportFileInfo( fileName );
+	if( exportFileInfo.completeSuffix().compare( "txt" ) )	fileName.append( ".txt" );
+
+	QFile exportFile( directory + "/" + fileName  );
+	if( !exportFile.open( QIODevice::WriteOnly ) )	return false;
+
+	QTextStream out( &exportFile );
+	out<<"Heliostat\tCosine factor\tShading loss\tBlocking loss\tSkipped surfaces"<<"\n";
+	for( int h = 0; h < m_heliostats.count(); ++h )
+	{
+		const Heliostat& heliostat = m_heliostats[h];
+		out<<heliostat.heliostatNode->GetNodeURL()<<"\t"<<heliostat.cosineFactor<<"\t"<<heliostat.shadingLoss<<"\t"<<heliostat.blockingLoss
+				<<"\t"<<heliostat.skippedSurfaces<<"\n";
+	}
+	for( int s = 0; s < m_skippedHeliostats.count(); ++s )
+		out<<"Skipped heliostat without surfaces that can be sampled: "<<m_skippedHeliostats[s]<<"\n";
+	exportFile.close();
+
+	return true;
+}
+
+/*!
+ * Returns the reason why the last analysis could not be run.
+ */
+QString HeliostatFieldAnalysis::GetErrorMessage() const
+{
+	return m_errorMessage;
+}
+
+/*!
+ * Returns the number of analyzed heliostats.
+ */
+int HeliostatFieldAnalysis::GetNumberOfHeliostats() const
+{
+	return m_heliostats.count();
+}
+
+/*!
+ * Returns the URL of the node of the \a heliostat.
+ */
+QString HeliostatFieldAnalysis::GetHeliostatURL( int heliostat ) const
+{
+	return m_heliostats[heliostat].heliostatNode->GetNodeURL();
+}
+
+/*!
+ * Returns the mean cosine of the angle between the sun vector and the normal of the \a heliostat.
+ */
+double HeliostatFieldAnalysis::GetCosineFactor( int heliostat ) const
+{
+	return m_heliostats[heliostat].cosineFactor;
+}
+
+/*!
+ * Returns the fraction of the \a heliostat surface that is shaded.
+ */
+double HeliostatFieldAnalysis::GetShadingLoss( int heliostat ) const
+{
+	return m_heliostats[heliostat].shadingLoss;
+}
+
+/*!
+ * Returns the fraction of the \a heliostat surface that is not shaded and whose reflected rays are blocked by other heliostats.
+ */
+double HeliostatFieldAnalysis::GetBlockingLoss( int heliostat ) const
+{
+	return m_heliostats[heliostat].blockingLoss;
+}
+
+/*!
+ * Returns the number of surfaces of the \a heliostat that are not sampled because they do not have area.
+ */
+int HeliostatFieldAnalysis::GetSkippedSurfaces( int heliostat ) const
+{
+	return m_heliostats[heliostat].skippedSurfaces;
+}
+
+/*!
+ * Returns the URLs of the heliostats that are not analyzed because none of their surfaces can be sampled.
+ */
+QStringList HeliostatFieldAnalysis::GetSkippedHeliostats() const
+{
+	return m_skippedHeliostats;
+}
+
+/*!
+ * Adds to the analysis the heliostats of the subtree of \a instanceNode.
+ * A heliostat is a group node with a tracker with an aiming point, and its surfaces are all the surfaces of the group.
+ */
+void HeliostatFieldAnalysis::FindHeliostats( InstanceNode* instanceNode )
+{
+	if( !instanceNode || !instanceNode->GetNode() )	return;
+	if( !instanceNode->GetNode()->getTypeId().isDerivedFrom( TSeparatorKit::getClassTypeId() ) )	return;
+
+	TSeparatorKit* separatorKit = static_cast< TSeparatorKit* >( instanceNode->GetNode() );
+	SoNode* tracker = separatorKit->getPart( "tracker", false );
+	if( tracker && tracker->getTypeId().isDerivedFrom( TTrackerForAiming::getClassTypeId() ) )
+	{
+		Heliostat heliostat;
+		heliostat.heliostatNode = instanceNode;
+		heliostat.skippedSurfaces = 0;
+		heliostat.cosineFactor = 0.0;
+		heliostat.shadingLoss = 0.0;
+		heliostat.blockingLoss = 0.0;
+		if( !GetAimingPoint( instanceNode, &heliostat.aimingPoint ) )	return;
+
+		GetHeliostatSurfaces( instanceNode, &heliostat.surfaces, &heliostat.skippedSurfaces );
+		if( heliostat.surfaces.count() > 0 )	m_heliostats.push_back( heliostat );
+		else if( heliostat.skippedSurfaces > 0 )	m_skippedHeliostats.push_back( instanceNode->GetNodeURL() );
+		return;
+	}
+
+	for( int index = 0; index < instanceNode->children.count(); ++index )
+		FindHeliostats( instanceNode->children[index] );
+}
+
+/*!
+ * Sets to \a aimingPoint the aiming point of the tracker of \a heliostatNode in world coordinates.
+ * The relative aiming points are defined in the coordinates of the heliostat parent node.
+ * Returns false if the tracker does not define an aiming point.
+ */
+bool HeliostatFieldAnalysis::GetAimingPoint( InstanceNode* heliostatNode, Point3D* aimingPoint ) const
+{
+	TSeparatorKit* separatorKit = static_cast< TSeparatorKit* >( heliostatNode->GetNode() );
+	TTrackerForAiming* tracker = static_cast< TTrackerForAiming* >( separatorKit->getPart( "tracker", false ) );
+
+	SoField* aimingPointField = tracker->getField( "aimingPoint" );
+	if( !aimingPointField || !aimingPointField->isOfType( trt::TONATIUH_REALVECTOR3::getClassTypeId() ) )	return false;
+
+	trt::TONATIUH_REALVECTOR3* aimingPointValue = static_cast< trt::TONATIUH_REALVECTOR3* >( aimingPointField );
+	Point3D point( aimingPointValue->getValue()[0], aimingPointValue->getValue()[1], aimingPointValue->getValue()[2] );
+	if( tracker->typeOfAimingPoint.getValue() == TTrackerForAiming::Absolute )
+	{
+		*aimingPoint = point;
+		return true;
+	}
+
+	InstanceNode* parentNode = heliostatNode->GetParent();
+	if( !parentNode )	return false;
+	*aimingPoint = parentNode->GetIntersectionTransform().GetInverse()( point );
+	return true;
+}
+
+/*!
+ * Adds to \a surfaces the surfaces of the subtree of \a instanceNode where the probe points can be sampled.
+ * The surfaces that cannot be sampled are counted in \a skippedSurfaces.
+ */
+void HeliostatFieldAnalysis::GetHeliostatSurfaces( InstanceNode* instanceNode, QVector< HeliostatSurface >* surfaces, int* skippedSurfaces ) const
+{
+	if( !instanceNode || !instanceNode->GetNode() )	return;
+	if( instanceNode->GetNode()->getTypeId().isDerivedFrom( TShapeKit::getClassTypeId() ) )
+	{
+		TShapeKit* shapeKit = static_cast< TShapeKit* > ( instanceNode->GetNode() );
+		TShape* shape = static_cast< TShape* >( shapeKit->getPart( "shape", false ) );
+		if( !shape )	return;
+
+		//The shapes without area cannot be sampled
+		double area = shape->GetArea();
+		if( !( area > 0.0 ) )
+		{
+			++( *skippedSurfaces );
+			return;
+		}
+
+		HeliostatSurface surface;
+		surface.shape = shape;
+		surface.objectToWorld = instanceNode->GetIntersectionTransform().GetInverse();
+		surface.area = area;
+		surfaces->push_back( surface );
+		return;
+	}
+
+	for( int index = 0; index < instanceNode->children.count(); ++index )
+		GetHeliostatSurfaces( instanceNode->children[index], surfaces, skippedSurfaces );
+}
+
+/*!
+ * Finds for each heliostat the heliostats that can block its reflected rays.
+ *
+ * The rays reflected from any point of the heliostat bounding sphere to the aiming point are inside the cylinder
+ * of the same radius around the segment from the sphere center to the aiming point. Only the heliostats whose
+ * bounding spheres intersect this cylinder are tested by the blocking rays.
+ */
+void HeliostatFieldAnalysis::FindBlockingCandidates()
+{
+	int nHeliostats = m_heliostats.count();
+	QVector< Point3D > centers( nHeliostats );
+	QVector< double > radius( nHeliostats );
+	for( int h = 0; h < nHeliostats; ++h )
+		m_heliostats[h].heliostatNode->GetIntersectionBBox().BoundingSphere( centers[h], radius[h] );
+
+	for( int h = 0; h < nHeliostats; ++h )
+	{
+		Heliostat& heliostat = m_heliostats[h];
+		heliostat.blockingCandidates.clear();
+
+		Vector3D segment = heliostat.aimingPoint - centers[h];
+		double segmentLengthSquared = segment.lengthSquared();
+		for( int c = 0; c < nHeliostats; ++c )
+		{
+			if( c == h )	continue;
+
+			Vector3D centerVector = centers[c] - centers[h];
+			double s = 0.0;
+			if( segmentLengthSquared > 0.0 )
+				s = std::min( std::max( DotProduct( centerVector, segment ) / segmentLengthSquared, 0.0 ), 1.0 );
+
+			Vector3D distanceVector = centerVector - s * segment;
+			if( distanceVector.length() <= radius[h] + radius[c] )
+				heliostat.blockingCandidates.push_back( m_heliostats[c].heliostatNode );
+		}
+	}
+}
+
+/*!
+ * Samples the probe points of the heliostat surfaces and traces the shading and blocking rays from each point.
+ *
+ * The surface of each probe point is selected with a probability proportional to its area. The cosine factor
+ * is computed for the heliostat normal that reflects the sun vector to the aiming point.
+ */
+void HeliostatFieldAnalysis::Heliostat::Probe()
+{
+	cosineFactor = 0.0;
+	shadingLoss = 0.0;
+	blockingLoss = 0.0;
+
+	double totalArea = 0.0;
+	for( int s = 0; s < surfaces.count(); ++s )
+		totalArea += surfaces[s].area;
+
+	ParallelRandomDeviate rand( randomDeviate, mutex, 3 * probeRays );
+
+	double cosineSum = 0.0;
+	unsigned long shadedRays = 0;
+	unsigned long blockedRays = 0;
+	for( unsigned long p = 0; p < probeRays; ++p )
+	{
+		double areaSample = rand.RandomDouble() * totalArea;
+		int s = 0;
+		while( ( s < surfaces.count() - 1 ) && ( areaSample > surfaces[s].area ) )
+		{
+			areaSample -= surfaces[s].area;
+			++s;
+		}
+
+		double u = rand.RandomDouble();
+		double v = rand.RandomDouble();
+		Point3D probePoint = surfaces[s].objectToWorld( surfaces[s].shape->Sample( u, v ) );
+
+		Vector3D reflectedDirection = aimingPoint - probePoint;
+		double aimingDistance = reflectedDirection.length();
+		if( aimingDistance > 0.0 )	reflectedDirection /= aimingDistance;
+		cosineSum += sqrt( std::max( 0.5 * ( 1.0 + DotProduct( sunVector, reflectedDirection ) ), 0.0 ) );
+
+		if( sceneNode->IntersectP( Ray( probePoint, sunVector ), heliostatNode ) )
+		{
+			++shadedRays;
+			continue;
+		}
+
+		if( !( aimingDistance > 0.0 ) )	continue;
+		Ray reflectedRay( probePoint, reflectedDirection, gc::Epsilon, aimingDistance );
+		for( int c = 0; c < blockingCandidates.count(); ++c )
+		{
+			if( blockingCandidates[c]->IntersectP( reflectedRay, 0 ) )
+			{
+				++blockedRays;
+				break;
+			}
+		}
+	}
+
+	cosineFactor = cosineSum / probeRays;
+	shadingLoss = double( shadedRays ) / probeRays;
+	blockingLoss = double( blockedRays ) / probeRays;
+}
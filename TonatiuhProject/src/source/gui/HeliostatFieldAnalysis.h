@@ -0,0 +1,133 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef HELIOSTATFIELDANALYSIS_H_
+#define HELIOSTATFIELDANALYSIS_H_
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "Point3D.h"
+#include "Transform.h"
+#include "Vector3D.h"
+
+class InstanceNode;
+class QMutex;
+class RandomDeviate;
+class SceneModel;
+class TSceneKit;
+class TShape;
+
+//!  HeliostatFieldAnalysis computes the cosine, shading and blocking losses of each heliostat of a field.
+/*!
+  The heliostats are the group nodes of the scene with a tracker with aiming point. For the current sun
+  position, a number of probe points is sampled on the surfaces of each heliostat. A probe point is shaded
+  if the ray from the point to the sun intersects any other surface of the scene, and it is blocked if
+  the ray reflected from the point to the heliostat aiming point intersects another heliostat.
+  The surfaces without area, like the CAD meshes, cannot be sampled. They are counted for each heliostat, and
+  the heliostats without any other surface are reported as skipped.
+  Only occlusion queries are traced, so neither a Monte Carlo ray tracing nor a photon map are needed.
+  The heliostats are analyzed in parallel.
+*/
+
+class HeliostatFieldAnalysis
+{
+
+public:
+	HeliostatFieldAnalysis( TSceneKit* currentScene, SceneModel& currentSceneModel, InstanceNode* rootSeparatorInstance, RandomDeviate* randomDeviate );
+	~HeliostatFieldAnalysis();
+
+	bool RunAnalysis( unsigned long probeRays );
+	bool ExportAnalysis( QString directory, QString fileName ) const;
+
+	QString GetErrorMessage() const;
+	int GetNumberOfHeliostats() const;
+	QString GetHeliostatURL( int heliostat ) const;
+	double GetCosineFactor( int heliostat ) const;
+	double GetShadingLoss( int heliostat ) const;
+	double GetBlockingLoss( int heliostat ) const;
+	int GetSkippedSurfaces( int heliostat ) const;
+	QStringList GetSkippedHeliostats() const;
+
+private:
+	//! Surface of a heliostat where the probe points are sampled.
+	struct HeliostatSurface
+	{
+		const TShape* shape;
+		Transform objectToWorld;
+		double area;
+	};
+
+	//! Probe points and results of a heliostat.
+	struct Heliostat
+	{
+		void Probe();
+
+		InstanceNode* heliostatNode;
+		const InstanceNode* sceneNode;
+		QVector< HeliostatSurface > surfaces;
+		QVector< const InstanceNode* > blockingCandidates;
+		Point3D aimingPoint;
+		Vector3D sunVector;
+		unsigned long probeRays;
+		RandomDeviate* randomDeviate;
+		QMutex* mutex;
+
+		int skippedSurfaces;
+		double cosineFactor;
+		double shadingLoss;
+		double blockingLoss;
+	};
+
+	void FindHeliostats( InstanceNode* instanceNode );
+	bool GetAimingPoint( InstanceNode* heliostatNode, Point3D* aimingPoint ) const;
+	void GetHeliostatSurfaces( InstanceNode* instanceNode, QVector< HeliostatSurface >* surfaces, int* skippedSurfaces ) const;
+	void FindBlockingCandidates();
+
+	TSceneKit* m_pCurrentScene;
+	SceneModel* m_pCurrentSceneModel;
+	InstanceNode* m_pRootSeparatorInstance;
+	RandomDeviate* m_pRandomDeviate;
+
+	QVector< Heliostat > m_heliostats;
+	QStringList m_skippedHeliostats;
+	QString m_errorMessage;
+};
+
+#endif /* HELIOSTATFIELDANALYSIS_H_ */
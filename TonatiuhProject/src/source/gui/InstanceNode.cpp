@@ -45,6 +45,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "DifferentialGeometry.h"
 #include "InstanceNode.h"
 #include "Ray.h"
+#include "RayTracingProfiler.h"
 #include "tgf.h"
 #include "TMaterial.h"
 #include "Transform.h"
@@ -54,10 +55,22 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "TTracker.h"
 #include "TTrackerForAiming.h"
 
+namespace
+{
+	/*!
+	 * Returns the type name of \a tshape for the profiler. The name is only looked up when the profiler is enabled.
+	 */
+	const char* ProfiledShapeType( const TShape* tshape )
+	{
+		if( !RayTracingProfiler::IsEnabled() )	return 0;
+		return tshape->getTypeId().getName().getString();
+	}
+}
 
 InstanceNode::InstanceNode( SoNode* node )
-: m_coinNode( node ), m_parent( 0 )
+: m_coinNode( node ), m_parent( 0 ), m_isExported( false )
 {
+	UpdateNodeURL();
 }
 
 InstanceNode::~InstanceNode()
@@ -66,16 +79,19 @@ InstanceNode::~InstanceNode()
 }
 
 /**
- * Returns node URL.
+ * Computes the URL of the node and its children from the parent URL and the node name.
+ *
+ * The URL is stored, so it must be updated each time the node or any of its ancestors is renamed.
  */
-QString InstanceNode::GetNodeURL() const
+void InstanceNode::UpdateNodeURL()
 {
-   QString url;
-   if( GetParent() ) url = GetParent()->GetNodeURL();
-   url.append( QLatin1String( "/" ) );
-   const char* nodeName = m_coinNode->getName().getString();
-   url.append( QLatin1String( nodeName  ) );
-   return url;
+   if( GetParent() ) m_nodeURL = GetParent()->GetNodeURL();
+   else m_nodeURL.clear();
+   m_nodeURL.append( QLatin1String( "/" ) );
+   if( m_coinNode ) m_nodeURL.append( QLatin1String( m_coinNode->getName().getString() ) );
+
+   for( int index = 0; index < children.count(); ++index )
+	   children[index]->UpdateNodeURL();
 }
 
 void InstanceNode::Print( int level ) const
@@ -107,79 +123,149 @@ void InstanceNode::InsertChild( int row, InstanceNode* instanceChild)
 }
 
 
-//bool InstanceNode::Intersect( const Ray& ray, RandomDeviate& rand, InstanceNode** modelNode, Ray* outputRay )
-bool InstanceNode::Intersect( const Ray& ray, RandomDeviate& rand, bool* isShapeFront, InstanceNode** modelNode, Ray* outputRay )
+/**
+ * Intersects \a ray with the shapes under this node and computes the ray reflected by the closest one.
+ *
+ * The closest surface is searched computing only the intersection distances, so the differential geometry
+ * and the material are evaluated only for the closest surface.
+ * The \a isShapeFront, \a modelNode and \a u, \a v parametric coordinates of the closest intersection
+ * are returned even if the material of the intersected surface does not produce an output ray.
+**/
+bool InstanceNode::Intersect( const Ray& ray, RandomDeviate& rand, bool* isShapeFront, InstanceNode** modelNode, Ray* outputRay, double* u, double* v )
 {
+	InstanceNode* surfaceNode = 0;
+	ShapeHit hit;
+	if( !FindClosestSurface( ray, &surfaceNode, &hit ) ) return false;
 
+	*modelNode = surfaceNode;
+	return surfaceNode->SurfaceOutputRay( ray, hit, rand, isShapeFront, outputRay, u, v );
+}
+
+/**
+ * Searches the closest surface under this node intersected by \a ray and sets it to \a surfaceNode.
+ * The shape intersection is set to \a hit and the \a ray maxt is set to the distance to the surface.
+ * Returns false if \a ray does not intersect any surface.
+**/
+bool InstanceNode::FindClosestSurface( const Ray& ray, InstanceNode** surfaceNode, ShapeHit* hit )
+{
 	//Check if the ray intersects with the BoundingBox
-   if( !m_bbox.IntersectP(ray) ) return false;
-   if( !GetNode()->getTypeId().isDerivedFrom( TShapeKit::getClassTypeId() ) )
-   {
+	if( !m_bbox.IntersectP( ray ) ) return false;
+	if( !GetNode()->getTypeId().isDerivedFrom( TShapeKit::getClassTypeId() ) )
+	{
+		bool isSurface = false;
+		double t = ray.maxt;
+		for( int index = 0; index < children.size(); ++index )
+		{
+			InstanceNode* childSurfaceNode = 0;
+			ShapeHit childHit;
+			children[index]->FindClosestSurface( ray, &childSurfaceNode, &childHit );
+			if( ray.maxt < t )
+			{
+				t = ray.maxt;
+				*surfaceNode = childSurfaceNode;
+				*hit = childHit;
+				isSurface = true;
+			}
+		}
+		return isSurface;
+	}
 
-      bool isOutputRay = false;
-      double t = ray.maxt;
-      for( int index = 0; index < children.size(); ++index )
-      {
-         InstanceNode* intersectedChild = 0;
-         Ray childOutputRay;
-         bool childShapreFront = true;
-         bool isChildOutputRay = children[index]->Intersect( ray, rand, &childShapreFront, &intersectedChild, &childOutputRay );
+	TShape* tshape = 0;
+	TMaterial* tmaterial = 0;
+	GetSurfaceNodes( &tshape, &tmaterial );
+	if( !tshape ) return false;
 
-         if( ray.maxt < t )
-         {
-            t = ray.maxt;
-            *modelNode = intersectedChild;
-            *isShapeFront = childShapreFront;
+	ShapeHit shapeHit;
+	{
+		ProfilerTimer profilerTimer( RayTracingProfiler::ShapeIntersection, ProfiledShapeType( tshape ) );
+		if( !tshape->IntersectT( m_transformWTO( ray ), &shapeHit ) ) return false;
+	}
 
-            *outputRay = childOutputRay;
-            isOutputRay = isChildOutputRay;
+	ray.maxt = shapeHit.tHit;
+	*hit = shapeHit;
+	*surfaceNode = this;
+	return true;
+}
 
-         }
-      }
+/**
+ * Returns true if \a ray intersects any surface under this node between the ray mint and maxt.
+ * The surfaces under \a excludedNode are not tested.
+ *
+ * The search finishes at the first intersected surface, so the closest surface is not searched and
+ * neither the intersection distance nor the differential geometry of the surface are computed.
+**/
+bool InstanceNode::IntersectP( const Ray& ray, const InstanceNode* excludedNode ) const
+{
+	if( this == excludedNode ) return false;
+	if( !m_bbox.IntersectP( ray ) ) return false;
+	if( !GetNode()->getTypeId().isDerivedFrom( TShapeKit::getClassTypeId() ) )
+	{
+		for( int index = 0; index < children.size(); ++index )
+			if( children[index]->IntersectP( ray, excludedNode ) ) return true;
+		return false;
+	}
 
-      return isOutputRay;
+	TShape* tshape = 0;
+	TMaterial* tmaterial = 0;
+	GetSurfaceNodes( &tshape, &tmaterial );
+	if( !tshape ) return false;
 
-   }
-	else
+	ProfilerTimer profilerTimer( RayTracingProfiler::ShapeIntersection, ProfiledShapeType( tshape ) );
+	return tshape->IntersectP( m_transformWTO( ray ) );
+}
+
+/**
+ * Computes the ray reflected by the surface of this node for the \a ray that intersects its shape at \a hit.
+ * The differential geometry of the surface is computed only at this point.
+**/
+bool InstanceNode::SurfaceOutputRay( const Ray& ray, const ShapeHit& hit, RandomDeviate& rand, bool* isShapeFront, Ray* outputRay, double* u, double* v )
+{
+	TShape* tshape = 0;
+	TMaterial* tmaterial = 0;
+	GetSurfaceNodes( &tshape, &tmaterial );
+
+	Ray childCoordinatesRay( m_transformWTO( ray ) );
+	DifferentialGeometry dg;
 	{
-		Ray childCoordinatesRay( m_transformWTO( ray ) );
+		ProfilerTimer profilerTimer( RayTracingProfiler::ShapeDifferentialGeometry, ProfiledShapeType( tshape ) );
+		tshape->ComputeDifferentialGeometry( childCoordinatesRay, hit, &dg );
+	}
 
-		TShape* tshape = 0;
-		TMaterial* tmaterial = 0;
-		if( children[0]->GetNode()->getTypeId().isDerivedFrom( TShape::getClassTypeId() ) )
-		{
-			tshape = static_cast< TShape* >( children[0]->GetNode() );
-			if( children.size() > 1 )	tmaterial = static_cast< TMaterial* > ( children[1]->GetNode() );
-		}
-		else if(  children.count() > 1 )
-		{
-			tmaterial = static_cast< TMaterial* > ( children[0]->GetNode() );
-			tshape = static_cast< TShape* >( children[1]->GetNode() );
-		}
+	*isShapeFront = dg.shapeFrontSide;
+	*u = dg.u;
+	*v = dg.v;
 
-		if( tshape )
-		{
-			 double thit = 0.0;
-			 DifferentialGeometry dg;
-			 if( !tshape->Intersect( childCoordinatesRay, &thit, &dg ) ) return false;
-
-			 ray.maxt = thit;
-			 *modelNode = this;
-
-			 *isShapeFront = dg.shapeFrontSide;
-
-			 if( tmaterial )
-			 {
-				 Ray surfaceOutputRay;
-				 if( tmaterial->OutputRay( childCoordinatesRay, &dg, rand, &surfaceOutputRay ) )
-				 {
-					 *outputRay = m_transformOTW( surfaceOutputRay );
-					 return true;
-				 }
-			}
-      }
-   }
-	return false;
+	if( !tmaterial ) return false;
+
+	Ray surfaceOutputRay;
+	bool isOutputRay = false;
+	{
+		ProfilerTimer profilerTimer( RayTracingProfiler::MaterialOutputRay );
+		isOutputRay = tmaterial->OutputRay( childCoordinatesRay, &dg, rand, &surfaceOutputRay );
+	}
+	if( !isOutputRay ) return false;
+
+	*outputRay = m_transformOTW( surfaceOutputRay );
+	return true;
+}
+
+/**
+ * Sets to \a tshape and \a tmaterial the shape and the material of this surface node.
+ * They are set to null if the node does not have them.
+**/
+void InstanceNode::GetSurfaceNodes( TShape** tshape, TMaterial** tmaterial ) const
+{
+	if( children.count() < 1 )	return;
+	if( children[0]->GetNode()->getTypeId().isDerivedFrom( TShape::getClassTypeId() ) )
+	{
+		*tshape = static_cast< TShape* >( children[0]->GetNode() );
+		if( children.size() > 1 )	*tmaterial = static_cast< TMaterial* > ( children[1]->GetNode() );
+	}
+	else if(  children.count() > 1 )
+	{
+		*tmaterial = static_cast< TMaterial* > ( children[0]->GetNode() );
+		*tshape = static_cast< TShape* >( children[1]->GetNode() );
+	}
 }
 
 void InstanceNode::DisconnectAllTrackers()
@@ -41,6 +41,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 
 #include <vector>
 
+#include <QString>
 #include <QVector>
 #include <QMutex>
 #include <Inventor/SbBox3f.h>
@@ -53,7 +54,10 @@ class RandomDeviate;
 class Ray;
 class SoNode;
 class TLightKit;
+class TMaterial;
+class TShape;
 class SceneModel;
+struct ShapeHit;
 
 
 //!  InstanceNode class represents a instance of a node in the scene.
@@ -75,9 +79,13 @@ public:
     SoNode* GetNode() const;
     InstanceNode* GetParent() const;
     QString GetNodeURL() const;
+    void UpdateNodeURL();
+    bool IsExported() const;
+    void SetExported( bool exported );
     void Print( int level ) const;
 
-    bool Intersect( const Ray& ray, RandomDeviate& rand, bool* isShapeFront, InstanceNode** modelNode, Ray* outputRay );
+    bool Intersect( const Ray& ray, RandomDeviate& rand, bool* isShapeFront, InstanceNode** modelNode, Ray* outputRay, double* u, double* v );
+    bool IntersectP( const Ray& ray, const InstanceNode* excludedNode ) const;
 
     //template<class T> void RecursivlyApply(void (T::*func)(void));
     //template<class T,class Param1> void RecursivlyApply(void (T::*func)(Param1),Param1 param1);
@@ -96,8 +104,14 @@ public:
     QVector< InstanceNode* > children;
 
 private:
+    bool FindClosestSurface( const Ray& ray, InstanceNode** surfaceNode, ShapeHit* hit );
+    bool SurfaceOutputRay( const Ray& ray, const ShapeHit& hit, RandomDeviate& rand, bool* isShapeFront, Ray* outputRay, double* u, double* v );
+    void GetSurfaceNodes( TShape** tshape, TMaterial** tmaterial ) const;
+
     SoNode* m_coinNode;
     InstanceNode* m_parent;
+    bool m_isExported;
+    QString m_nodeURL;
     BBox m_bbox;
     Transform m_transformWTO;
     Transform m_transformOTW;
@@ -110,11 +124,13 @@ bool operator==( const InstanceNode& thisNode,const InstanceNode& otherNode );
 inline void InstanceNode::SetParent( InstanceNode* parent )
 {
 	m_parent = parent;
+	UpdateNodeURL();
 }
 
 inline void InstanceNode::SetNode( SoNode* node )
 {
 	m_coinNode = node;
+	UpdateNodeURL();
 }
 
 inline SoNode* InstanceNode::GetNode() const
@@ -122,6 +138,14 @@ inline SoNode* InstanceNode::GetNode() const
 	return m_coinNode;
 }
 
+/**
+ * Returns node URL.
+ */
+inline QString InstanceNode::GetNodeURL() const
+{
+	return m_nodeURL;
+}
+
 /**
  * Returns parent instance.
  */
@@ -130,5 +154,21 @@ inline InstanceNode* InstanceNode::GetParent() const
 	return m_parent;
 }
 
+/**
+ * Returns true if the ray tracer must store the photons that hit this node.
+ */
+inline bool InstanceNode::IsExported() const
+{
+	return m_isExported;
+}
+
+/**
+ * Sets whether the ray tracer must store the photons that hit this node.
+ */
+inline void InstanceNode::SetExported( bool exported )
+{
+	m_isExported = exported;
+}
+
 
 #endif /*INSTANCENODE_H_*/
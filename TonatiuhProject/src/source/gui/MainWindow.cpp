@@ -48,7 +48,9 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include <QPluginLoader>
 #include <QProgressDialog>
 #include <QSettings>
+#include <QThreadPool>
 #include <QtConcurrentMap>
+#include <QtConcurrentRun>
 #include <QTime>
 #include <QUndoStack>
 #include <QUndoView>
@@ -97,6 +99,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "CmdModifyParameter.h"
 #include "CmdPaste.h"
 #include "CmdTransmissivityModified.h"
+#include "DistributedRayTracer.h"
 #include "Document.h"
 #include "ExportDialog.h"
 #include "ExportPhotonMapSettingsDialog.h"
@@ -105,6 +108,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "GraphicView.h"
 #include "GraphicRoot.h"
 #include "GridSettingsDialog.h"
+#include "HeliostatFieldAnalysis.h"
 #include "InstanceNode.h"
 #include "LightDialog.h"
 #include "MainWindow.h"
@@ -113,12 +117,13 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "PhotonMapExportFactory.h"
 #include "PhotonMapExportSettings.h"
 #include "PluginManager.h"
+#include "PrimaryRayCache.h"
 #include "ProgressUpdater.h"
 #include "RandomDeviate.h"
 #include "RandomDeviateFactory.h"
 #include "RayTraceDialog.h"
 #include "RayTracer.h"
-#include "RayTracerNoTr.h"
+#include "RayTracingProfiler.h"
 #include "SceneModel.h"
 #include "ScriptEditorDialog.h"
 #include "SunPositionCalculatorDialog.h"
@@ -130,6 +135,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "TMaterial.h"
 #include "TMaterialFactory.h"
 #include "TPhotonMap.h"
+#include "TraceCheckpoint.h"
 #include "TransmissivityDialog.h"
 #include "trf.h"
 #include "TSceneKit.h"
@@ -162,6 +168,7 @@ MainWindow::MainWindow( QString tonatiuhFile , QWidget* parent, Qt::WindowFlags
 :QMainWindow( parent, flags ),
  m_commandStack( 0 ),
  m_commandView( 0 ),
+ m_abortMessage( "" ),
  m_currentFile( "" ),
  m_document( 0 ),
  m_recentFiles( "" ),
@@ -171,6 +178,8 @@ m_sceneModel( 0 ),
 m_selectionModel( 0 ),
 m_rand( 0 ),
 m_selectedRandomDeviate( -1 ),
+m_randomSeed( -1 ),
+m_randomSubstream( -1 ),
 m_bufferPhotons( 5000000 ),
 m_increasePhotonMap( false ),
 m_pExportModeSettings( 0 ),
@@ -183,10 +192,16 @@ m_coinNode_Buffer( 0 ),
 m_manipulators_Buffer( 0 ),
 m_tracedRays( 0 ),
 m_raysPerIteration( 10000 ),
+m_raysPerChunk( 0 ),
+m_profilingReportFile( "" ),
+m_primaryRayCacheFile( "" ),
+m_checkpointFile( "" ),
+m_checkpointRays( 0 ),
 m_heightDivisions( 200 ),
 m_widthDivisions( 200 ),
 m_drawPhotons( false ),
 m_drawRays( true ),
+m_drawnPhotonsLimit( 1000000 ),
 m_gridXElements( 0 ),
 m_gridZElements( 0 ),
 m_gridXSpacing( 0 ),
@@ -265,6 +280,15 @@ void MainWindow::ExecuteScriptFile( QString tonatiuhScriptFile )
 	editor.done( 0 );
 }
 
+/*!
+ * Returns the first error emitted with Abort, or an empty string if no action has been aborted.
+ * The scripts run from the command line exit with an error code if there is an abort message.
+ */
+QString MainWindow::GetAbortMessage() const
+{
+	return m_abortMessage;
+}
+
 void MainWindow::SetPluginManager( PluginManager* pluginManager )
 {
 
@@ -532,6 +556,14 @@ void MainWindow::OpenRecentFile()
     }
 }
 
+/*!
+ * Saves the \a error of the first aborted action.
+ */
+void MainWindow::RecordAbort( QString error )
+{
+	if( m_abortMessage.isEmpty() )	m_abortMessage = error;
+}
+
 /*!
  * Applies las reverted command action changes to Tonatiuh.
  */
@@ -671,11 +703,18 @@ bool MainWindow::SaveAs()
 
 	QString saveDirectory = settings.value( "saveDirectory", QString( "." ) ).toString();
 
-	QString tonatiuhFilter( "Tonatiuh files (*.tnh)" );
+	//The filters define the format of the file
+	QStringList tonatiuhFilters;
+	tonatiuhFilters<<QString( "Tonatiuh files (*.tnh)" )
+			<<QString( "Tonatiuh binary files (*.tnh)" )
+			<<QString( "Tonatiuh compressed binary files (*.tnh)" );
+	QString tonatiuhFilter = tonatiuhFilters[m_document->GetFileFormat()];
 	QString fileName = QFileDialog::getSaveFileName( this,
 	                       tr( "Save" ), saveDirectory,
-	                       tonatiuhFilter, &tonatiuhFilter );
+	                       tonatiuhFilters.join( ";;" ), &tonatiuhFilter );
 	if( fileName.isEmpty() ) return false;
+	if( tonatiuhFilters.contains( tonatiuhFilter ) )
+		m_document->SetFileFormat( Document::FileFormat( tonatiuhFilters.indexOf( tonatiuhFilter ) ) );
 
 	QFileInfo file( fileName );
 	settings.setValue( "saveDirectory", file.absolutePath() );
@@ -1810,143 +1849,257 @@ void MainWindow::PasteLink()
 }
 
 /*!
- * Runs ray tracer to defined model and paramenters.
+ * Continues the ray tracing of the \a checkpointFile that was interrupted. The model, the photon map export settings
+ * and the ray tracing parameters must be the ones of the interrupted ray tracing. The random generator, the traced
+ * rays and the exported photons are restored from the checkpoint and the remaining rays of the interrupted Run are
+ * traced, saving the new checkpoints to the same file.
  */
-void MainWindow::Run()
+void MainWindow::ResumeRun( QString checkpointFile )
 {
+	TraceCheckpoint checkpoint;
+	if( !checkpoint.Read( checkpointFile ) )
+	{
+		emit Abort( tr( "ResumeRun: %1" ).arg( checkpoint.GetErrorMessage() ) );
+		return;
+	}
 
-	InstanceNode* rootSeparatorInstance = 0;
-	InstanceNode* lightInstance = 0;
-	SoTransform* lightTransform = 0;
-	TSunShape* sunShape = 0;
-	TLightShape* raycastingSurface = 0;
-	TTransmissivity* transmissivity = 0;
-
-	QDateTime startTime = QDateTime::currentDateTime();
-	if( ReadyForRaytracing( rootSeparatorInstance, lightInstance, lightTransform, sunShape, raycastingSurface, transmissivity ) )
+	QVector< RandomDeviateFactory* > randomDeviateFactoryList = m_pPluginManager->GetRandomDeviateFactories();
+	int randomDeviateIndex = -1;
+	for( int r = 0; r < randomDeviateFactoryList.size(); ++r )
+		if( randomDeviateFactoryList[r]->RandomDeviateName() == checkpoint.randomDeviateName )	randomDeviateIndex = r;
+	if( randomDeviateIndex < 0 )
 	{
-		if( !m_pPhotonMap->GetExportMode() )
-		{
-			if( !m_pExportModeSettings ) return;
-			else
-			{
+		emit Abort( tr( "ResumeRun: The random generator %1 is not available." ).arg( checkpoint.randomDeviateName ) );
+		return;
+	}
 
-				PhotonMapExport* pExportMode = CreatePhotonMapExport();
-				if( !pExportMode )	return;
-				if( !m_pPhotonMap->SetExportMode( pExportMode )  ) return;
+	if( !m_pExportModeSettings || m_pExportModeSettings->modeTypeName != checkpoint.exportModeName )
+	{
+		emit Abort( tr( "ResumeRun: The photon map export type must be %1." ).arg( checkpoint.exportModeName ) );
+		return;
+	}
 
-			}
-		}
+	//The generator and the photon map are created again from the checkpoint
+	m_selectedRandomDeviate = randomDeviateIndex;
+	m_randomSeed = checkpoint.randomSeed;
+	m_randomSubstream = checkpoint.randomSubstream;
+	delete m_rand;
+	m_rand = 0;
+	delete m_pPhotonMap;
+	m_pPhotonMap = 0;
 
-		QVector< InstanceNode* > exportSuraceList;
-		QStringList exportSurfaceURLList = m_pExportModeSettings->exportSurfaceNodeList;
-		for( int s = 0; s < exportSurfaceURLList.count(); s++ )
-		{
-			m_sceneModel->IndexFromNodeUrl( exportSurfaceURLList[s] );
-			InstanceNode* surfaceNode = m_sceneModel->NodeFromIndex( m_sceneModel->IndexFromNodeUrl( exportSurfaceURLList[s] ) );
-			exportSuraceList.push_back( surfaceNode );
-		}
+	m_checkpointFile = checkpointFile;
+	m_checkpointRays = checkpoint.checkpointRays;
 
+	RunRayTracer( &checkpoint );
+}
 
-		UpdateLightSize();
+/*!
+ * Runs ray tracer to defined model and paramenters.
+ */
+void MainWindow::Run()
+{
+	RunRayTracer( 0 );
+}
 
-		//Compute bounding boxes and world to object transforms
-		trf::ComputeSceneTreeMap( rootSeparatorInstance, Transform( new Matrix4x4 ), true );
+/*!
+ * Runs the ray tracer splitting the rays per iteration between \a numberOfProcesses Tonatiuh worker processes.
+ * Each worker uses a different substream of the random generator. The workers photon maps are merged into the
+ * \a fileName photon map file in the \a directory, with the power per photon of the total number of rays.
+ */
+void MainWindow::RunDistributed( int numberOfProcesses, QString directory, QString fileName )
+{
+	if( numberOfProcesses < 1 )
+	{
+		emit Abort( tr( "RunDistributed: The number of processes must be greater than zero." ) );
+		return;
+	}
+	if( fileName.isEmpty() )
+	{
+		emit Abort( tr( "RunDistributed: The photon map file name is not defined." ) );
+		return;
+	}
 
-		m_pPhotonMap->SetConcentratorToWorld( rootSeparatorInstance->GetIntersectionTransform() );
+	QString commonScript;
+	if( !DistributedSetup( directory, &commonScript ) )	return;
+
+	QDir workingDirectory( directory );
+	commonScript.append( QLatin1String( "tonatiuh.SetExportPhotonMapType( \"Binary_file\" );\n" ) );
+	bool exportCoordinates = m_pExportModeSettings ? m_pExportModeSettings->exportCoordinates : true;
+	bool exportInGlobal = m_pExportModeSettings ? m_pExportModeSettings->exportInGlobalCoordinates : true;
+	bool exportSurfaceID = m_pExportModeSettings ? m_pExportModeSettings->exportSurfaceID : true;
+	bool exportSide = m_pExportModeSettings ? m_pExportModeSettings->exportIntersectionSurfaceSide : true;
+	bool exportPreviousNextID = m_pExportModeSettings ? m_pExportModeSettings->exportPreviousNextPhotonID : true;
+	commonScript.append( QString( QLatin1String( "tonatiuh.SetExportCoordinates( %1, %2 );\n" ) ).arg(
+			exportCoordinates ? QLatin1String( "true" ) : QLatin1String( "false" ),
+			exportInGlobal ? QLatin1String( "true" ) : QLatin1String( "false" ) ) );
+	commonScript.append( QString( QLatin1String( "tonatiuh.SetExportIntersectionSurface( %1 );\n" ) ).arg(
+			exportSurfaceID ? QLatin1String( "true" ) : QLatin1String( "false" ) ) );
+	commonScript.append( QString( QLatin1String( "tonatiuh.SetExportIntersectionSurfaceSide( %1 );\n" ) ).arg(
+			exportSide ? QLatin1String( "true" ) : QLatin1String( "false" ) ) );
+	commonScript.append( QString( QLatin1String( "tonatiuh.SetExportPreviousNextPhotonID( %1 );\n" ) ).arg(
+			exportPreviousNextID ? QLatin1String( "true" ) : QLatin1String( "false" ) ) );
+	if( m_pExportModeSettings )
+	{
+		QStringList exportSurfaceURLList = m_pExportModeSettings->exportSurfaceNodeList;
+		for( int s = 0; s < exportSurfaceURLList.count(); ++s )
+			commonScript.append( QString( QLatin1String( "tonatiuh.AddExportSurfaceURL( \"%1\" );\n" ) ).arg( exportSurfaceURLList[s] ) );
+	}
+	commonScript.append( QString( QLatin1String( "tonatiuh.SetExportTypeParameterValue( \"ExportDirectory\", \"%1\" );\n" ) ).arg( workingDirectory.absolutePath() ) );
+	commonScript.append( QLatin1String( "tonatiuh.SetExportTypeParameterValue( \"FileSize\", \"-1\" );\n" ) );
 
-		TLightKit* light = static_cast< TLightKit* > ( lightInstance->GetNode() );
-		QStringList disabledNodes = QString( light->disabledNodes.getValue().getString() ).split( ";", QString::SkipEmptyParts );
-		QVector< QPair< TShapeKit*, Transform > > surfacesList;
-		trf::ComputeFistStageSurfaceList( rootSeparatorInstance, disabledNodes, &surfacesList );
-		light->ComputeLightSourceArea( m_widthDivisions, m_heightDivisions, surfacesList );
-		if( surfacesList.count() < 1 )
-		{
-			emit Abort( tr( "There are no surfaces defined for ray tracing" ) );
+	DistributedRayTracer distributedRayTracer( QApplication::applicationFilePath(), workingDirectory.absolutePath(), numberOfProcesses );
+	distributedRayTracer.SetModelFileName( workingDirectory.absoluteFilePath( QLatin1String( "distributed_model.tnh" ) ) );
+	distributedRayTracer.SetCommonScript( commonScript );
+	distributedRayTracer.SetFirstSubstream( ( m_randomSubstream > 0 ) ? m_randomSubstream : 0 );
+	distributedRayTracer.SetNumberOfRays( m_raysPerIteration );
 
-			ShowRaysIn3DView();
-			return;
-		}
+	QDateTime startTime = QDateTime::currentDateTime();
+	QString traceCommand( QLatin1String( "tonatiuh.SetExportTypeParameterValue( \"ExportFile\", \"%2\" );\n"
+			"tonatiuh.Run();\n" ) );
+	if( !distributedRayTracer.RunWorkers( traceCommand ) || !distributedRayTracer.MergePhotonMapFiles( fileName ) )
+	{
+		emit Abort( tr( "RunDistributed: %1" ).arg( distributedRayTracer.GetErrorMessage() ) );
+		return;
+	}
 
-		QVector< long > raysPerThread;
-		int maximumValueProgressScale = 100;
-		unsigned long  t1 = m_raysPerIteration / maximumValueProgressScale;
-		for( int progressCount = 0; progressCount < maximumValueProgressScale; ++ progressCount )
-			raysPerThread<< t1;
+	QDateTime endTime = QDateTime::currentDateTime();
+	std::cout <<"Elapsed time: "<< startTime.secsTo( endTime ) << std::endl;
+}
 
-		if( ( t1 * maximumValueProgressScale ) < m_raysPerIteration )	raysPerThread<< ( m_raysPerIteration-( t1* maximumValueProgressScale) );
+/*!
+ * Runs the flux analysis of the \a nodeURL surface splitting the \a nOfRays rays between \a numberOfProcesses Tonatiuh
+ * worker processes. The workers flux distributions are merged into the \a fileName file in the \a directory.
+ *
+ * \sa RunFluxAnalysis
+ */
+void MainWindow::RunDistributedFluxAnalysis( QString nodeURL, QString surfaceSide, unsigned int nOfRays, int heightDivisions, int widthDivisions, QString directory, QString fileName, bool saveCoords, int numberOfProcesses )
+{
+	if( numberOfProcesses < 1 )
+	{
+		emit Abort( tr( "RunDistributedFluxAnalysis: The number of processes must be greater than zero." ) );
+		return;
+	}
+	if( fileName.isEmpty() )
+	{
+		emit Abort( tr( "RunDistributedFluxAnalysis: The flux file name is not defined." ) );
+		return;
+	}
 
+	QString commonScript;
+	if( !DistributedSetup( directory, &commonScript ) )	return;
 
-		Transform lightToWorld = tgf::TransformFromSoTransform( lightTransform );
-		lightInstance->SetIntersectionTransform( lightToWorld.GetInverse() );
+	QDir workingDirectory( directory );
+	DistributedRayTracer distributedRayTracer( QApplication::applicationFilePath(), workingDirectory.absolutePath(), numberOfProcesses );
+	distributedRayTracer.SetModelFileName( workingDirectory.absoluteFilePath( QLatin1String( "distributed_model.tnh" ) ) );
+	distributedRayTracer.SetCommonScript( commonScript );
+	distributedRayTracer.SetFirstSubstream( ( m_randomSubstream > 0 ) ? m_randomSubstream : 0 );
+	distributedRayTracer.SetNumberOfRays( nOfRays );
 
+	QString traceCommand = QString( QLatin1String( "tonatiuh.RunFluxAnalysis( \"%1\", \"%2\", %3, %4, %5, \"%6\", \"%7\", %8 );\n" ) ).arg(
+			nodeURL, surfaceSide, QLatin1String( "%1" ), QString::number( heightDivisions ), QString::number( widthDivisions ),
+			workingDirectory.absolutePath(), QLatin1String( "%2" ), saveCoords ? QLatin1String( "true" ) : QLatin1String( "false" ) );
+	if( !distributedRayTracer.RunWorkers( traceCommand ) || !distributedRayTracer.MergeFluxFiles( fileName ) )
+	{
+		emit Abort( tr( "RunDistributedFluxAnalysis: %1" ).arg( distributedRayTracer.GetErrorMessage() ) );
+		return;
+	}
+}
 
+/*
+ * Runs ray trace to calculate a flux distribution map in the surface of the node \a nodeURL related to the side \a surfaceSide.
+ * The map will be calculated with the parameters \a nOfRays, \a heightDivisions and \a heightDivisions.
+ * The results will save in a file \a directory \a QString fileName, the coordinates of the cells depending on the variable \a saveCoord.
+ */
+void MainWindow::RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsigned int nOfRays, int heightDivisions, int widthDivisions, QString directory, QString fileName, bool saveCoords )
+{
+	TSceneKit* coinScene = m_document->GetSceneKit();
+	if ( !coinScene )  return;
 
-		// Create a progress dialog.
-		QProgressDialog dialog;
-		dialog.setLabelText( QString("Progressing using %1 thread(s)..." ).arg( QThread::idealThreadCount() ) );
+	TLightKit* lightKit = static_cast< TLightKit* >( coinScene->getPart( "lightList[0]", false ) );
+	if ( !lightKit )  return;
 
-		// Create a QFutureWatcher and conncect signals and slots.
-		QFutureWatcher< void > futureWatcher;
-		QObject::connect(&futureWatcher, SIGNAL(finished()), &dialog, SLOT(reset()));
-		QObject::connect(&dialog, SIGNAL(canceled()), &futureWatcher, SLOT(cancel()));
-		QObject::connect(&futureWatcher, SIGNAL(progressRangeChanged(int, int)), &dialog, SLOT(setRange(int, int)));
-		QObject::connect(&futureWatcher, SIGNAL(progressValueChanged(int)), &dialog, SLOT(setValue(int)));
+	InstanceNode*  rootSeparatorInstance = m_sceneModel->NodeFromIndex( sceneModelView->rootIndex() );
+	if ( !rootSeparatorInstance )  return;
 
-		QMutex mutex;
-		QMutex mutexPhotonMap;
-		QFuture< void > photonMap;
-		if( transmissivity )
-			 photonMap = QtConcurrent::map( raysPerThread, RayTracer(  rootSeparatorInstance,
-							 lightInstance, raycastingSurface, sunShape, lightToWorld,
-							 transmissivity,
-							 *m_rand,
-							 &mutex, m_pPhotonMap, &mutexPhotonMap,
-							 exportSuraceList ) );
+	//Create the random generator
+	if( !CreateRandomDeviate() )	return;
 
-		else
-			photonMap = QtConcurrent::map( raysPerThread, RayTracerNoTr(  rootSeparatorInstance,
-						lightInstance, raycastingSurface, sunShape, lightToWorld,
-						*m_rand,
-						&mutex, m_pPhotonMap, &mutexPhotonMap,
-						exportSuraceList ) );
+	FluxAnalysis fluxAnalysis( coinScene, *m_sceneModel, rootSeparatorInstance, m_widthDivisions, m_heightDivisions, m_rand );
+	fluxAnalysis.SetRaysPerChunk( m_raysPerChunk );
 
-		futureWatcher.setFuture( photonMap );
+	fluxAnalysis.RunFluxAnalysis( nodeURL, surfaceSide, nOfRays, false, heightDivisions, widthDivisions );
 
-		// Display the dialog and start the event loop.
-		dialog.exec();
-		futureWatcher.waitForFinished();
+	if( !fluxAnalysis.GetErrorMessage().isEmpty() )
+	{
+		emit Abort( tr( "RunFluxAnalysis: %1" ).arg( fluxAnalysis.GetErrorMessage() ) );
+		return;
+	}
 
-		m_tracedRays += m_raysPerIteration;
+	int** photonCounts = fluxAnalysis.photonCountsValue();
+	if( !photonCounts || photonCounts == 0 )
+	{
+		emit Abort( tr( "RunFluxAnalysis: Some parameter is not correctly defined.") );
+		return;
+	}
 
-		if( exportSuraceList.count() < 1 )
-			ShowRaysIn3DView();
-		else
-		{
-			actionDisplayRays->setEnabled( false );
-			actionDisplayRays->setChecked( false );
-		}
+	fluxAnalysis.ExportAnalysis( directory, fileName, saveCoords );
+}
 
+/*!
+ * Computes the cosine factor and the shading and blocking losses of each heliostat of the scene for the current sun position.
+ * The losses are estimated with \a probeRays probe points for each heliostat, without tracing the scene,
+ * and the results are saved into the \a fileName file in the \a directory.
+ */
+void MainWindow::RunHeliostatFieldAnalysis( unsigned int probeRays, QString directory, QString fileName )
+{
+	TSceneKit* coinScene = m_document->GetSceneKit();
+	if ( !coinScene )  return;
 
-		double irradiance = sunShape->GetIrradiance();
-		double inputAperture = raycastingSurface->GetValidArea();
-		double wPhoton = ( inputAperture * irradiance ) / m_tracedRays;
+	InstanceNode*  rootSeparatorInstance = m_sceneModel->NodeFromIndex( sceneModelView->rootIndex() );
+	if ( !rootSeparatorInstance )  return;
 
-		m_pPhotonMap->EndStore( wPhoton );
+	//Create the random generator
+	if( !CreateRandomDeviate() )	return;
 
+	HeliostatFieldAnalysis fieldAnalysis( coinScene, *m_sceneModel, rootSeparatorInstance, m_rand );
+	if( !fieldAnalysis.RunAnalysis( probeRays ) )
+	{
+		emit Abort( tr( "RunHeliostatFieldAnalysis: %1" ).arg( fieldAnalysis.GetErrorMessage() ) );
+		return;
 	}
 
-	QDateTime endTime = QDateTime::currentDateTime();
-	std::cout <<"Elapsed time: "<< startTime.secsTo( endTime ) << std::endl;
+	if( !fieldAnalysis.ExportAnalysis( directory, fileName ) )
+		emit Abort( tr( "RunHeliostatFieldAnalysis: The results cannot be saved into the file %1." ).arg( fileName ) );
 }
 
-/*
- * Runs ray trace to calculate a flux distribution map in the surface of the node \a nodeURL related to the side \a surfaceSide.
- * The map will be calculated with the parameters \a nOfRays, \a heightDivisions and \a heightDivisions.
- * The results will save in a file \a directory \a QString fileName, the coordinates of the cells depending on the variable \a saveCoord.
+/*!
+ * Runs a single ray trace to calculate the flux distribution maps of several surfaces.
+ *
+ * The surfaces urls \a nodeURLs, the sides \a surfaceSides, the grid divisions \a heightDivisions and \a widthDivisions
+ * and the export files \a fileNames are lists separated with ";" with a value for each surface.
+ * The sides and grid divisions lists can have a single value to use for all the surfaces.
+ * The flux distribution of each surface is saved into its file in the \a directory.
+ *
+ * \sa RunFluxAnalysis
  */
-void MainWindow::RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsigned int nOfRays, int heightDivisions, int widthDivisions, QString directory, QString fileName, bool saveCoords )
+void MainWindow::RunMultipleFluxAnalysis( QString nodeURLs, QString surfaceSides, unsigned int nOfRays, QString heightDivisions, QString widthDivisions, QString directory, QString fileNames, bool saveCoords )
 {
+	QStringList nodeURLList = nodeURLs.split( QLatin1String( ";" ), QString::SkipEmptyParts );
+	int nSurfaces = nodeURLList.count();
+
+	QStringList surfaceSideList = FluxAnalysis::SurfaceValues( surfaceSides, nSurfaces );
+	QStringList heightDivisionsList = FluxAnalysis::SurfaceValues( heightDivisions, nSurfaces );
+	QStringList widthDivisionsList = FluxAnalysis::SurfaceValues( widthDivisions, nSurfaces );
+	QStringList fileNameList = fileNames.split( QLatin1String( ";" ), QString::SkipEmptyParts );
+
+	if( ( nSurfaces < 1 ) || ( fileNameList.count() != nSurfaces ) ||
+			surfaceSideList.isEmpty() || heightDivisionsList.isEmpty() || widthDivisionsList.isEmpty() )
+	{
+		emit Abort( tr( "RunMultipleFluxAnalysis: The lists of surfaces parameters are not correctly defined.") );
+		return;
+	}
+
 	TSceneKit* coinScene = m_document->GetSceneKit();
 	if ( !coinScene )  return;
 
@@ -1956,29 +2109,39 @@ void MainWindow::RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsigned
 	InstanceNode*  rootSeparatorInstance = m_sceneModel->NodeFromIndex( sceneModelView->rootIndex() );
 	if ( !rootSeparatorInstance )  return;
 
-	QVector< RandomDeviateFactory* > randomDeviateFactoryList = m_pPluginManager->GetRandomDeviateFactories();
-	//Check if there is a random generator selected;
-	if( m_selectedRandomDeviate == -1 )
-	{
-		if( randomDeviateFactoryList.size() > 0 ) m_selectedRandomDeviate = 0;
-		else	return;
-	}
-
 	//Create the random generator
-	if( !m_rand )	m_rand =  randomDeviateFactoryList[m_selectedRandomDeviate]->CreateRandomDeviate();
+	if( !CreateRandomDeviate() )	return;
 
-	FluxAnalysis fluxAnalysis( coinScene, *m_sceneModel, rootSeparatorInstance, m_widthDivisions, m_heightDivisions, m_rand );
+	QVector< FluxAnalysis* > surfaceAnalyses;
+	for( int s = 0; s < nSurfaces; ++s )
+	{
+		FluxAnalysis* fluxAnalysis = new FluxAnalysis( coinScene, *m_sceneModel, rootSeparatorInstance, m_widthDivisions, m_heightDivisions, m_rand );
+		fluxAnalysis->SetRaysPerChunk( m_raysPerChunk );
+		fluxAnalysis->SetAnalysisSurface( nodeURLList[s], surfaceSideList[s],
+				heightDivisionsList[s].toInt(), widthDivisionsList[s].toInt() );
+		surfaceAnalyses.push_back( fluxAnalysis );
+	}
 
-	fluxAnalysis.RunFluxAnalysis( nodeURL, surfaceSide, nOfRays, false, heightDivisions, widthDivisions );
+	FluxAnalysis::RunFluxAnalysis( surfaceAnalyses, nOfRays );
 
-	int** photonCounts = fluxAnalysis.photonCountsValue();
-	if( !photonCounts || photonCounts == 0 )
+	for( int s = 0; s < nSurfaces; ++s )
 	{
-		emit Abort( tr( "RunFluxAnalysis: Some parameter is not correctly defined.") );
-		return;
+		if( !surfaceAnalyses[s]->GetErrorMessage().isEmpty() )
+		{
+			emit Abort( tr( "RunMultipleFluxAnalysis: %1" ).arg( surfaceAnalyses[s]->GetErrorMessage() ) );
+			break;
+		}
+
+		int** photonCounts = surfaceAnalyses[s]->photonCountsValue();
+		if( !photonCounts || photonCounts == 0 )
+		{
+			emit Abort( tr( "RunMultipleFluxAnalysis: Some parameter of the surface %1 is not correctly defined.").arg( nodeURLList[s] ) );
+			break;
+		}
+		surfaceAnalyses[s]->ExportAnalysis( directory, fileNameList[s], saveCoords );
 	}
 
-	fluxAnalysis.ExportAnalysis( directory, fileName, saveCoords );
+	qDeleteAll( surfaceAnalyses );
 }
 
 /*!
@@ -2027,6 +2190,17 @@ void MainWindow::SetAimingPointRelative()
 	SetAimingPointRelativity( true );
 }
 
+/*!
+ * Saves a checkpoint of the ray tracing state in \a fileName every \a raysInterval rays, so that a stopped ray tracing
+ * can be continued with ResumeRun. The random generator seed must be defined with SetRandomSeed.
+ * An empty \a fileName or a zero \a raysInterval disables the checkpoints.
+ */
+void MainWindow::SetCheckpoint( QString fileName, unsigned int raysInterval )
+{
+	m_checkpointFile = fileName;
+	m_checkpointRays = raysInterval;
+}
+
 /*!
  *Sets to export all surfaces photons.
  */
@@ -2114,6 +2288,18 @@ void MainWindow::SetExportTypeParameterValue( QString parameterName, QString par
 
 }
 
+/*!
+ * Sets the \a format of the saved model files: "ASCII", "Binary" or "CompressedBinary". The binary files are
+ * smaller and faster to read and write. The format of a file is detected when it is opened.
+ */
+void MainWindow::SetFileFormat( QString format )
+{
+	if( format == QLatin1String( "ASCII" ) )	m_document->SetFileFormat( Document::ASCIIFormat );
+	else if( format == QLatin1String( "Binary" ) )	m_document->SetFileFormat( Document::BinaryFormat );
+	else if( format == QLatin1String( "CompressedBinary" ) )	m_document->SetFileFormat( Document::CompressedBinaryFormat );
+	else	emit Abort( tr( "SetFileFormat: %1 is not a valid file format." ).arg( format ) );
+}
+
 /*!
  * If \a increase is false, starts with a new photon map every ray tracer. Otherwise, the photon map increases.
  */
@@ -2142,6 +2328,16 @@ void MainWindow::SetNodeName( QString nodeName )
 	ChangeNodeName( m_selectionModel->currentIndex(), nodeName );
 }
 
+/*!
+ * Sets the maximum number of threads used for ray tracing to \a numberOfThreads.
+ * If \a numberOfThreads is zero, the ray tracing uses as many threads as processor cores.
+ */
+void MainWindow::SetNumberOfThreads( unsigned int numberOfThreads )
+{
+	if( numberOfThreads < 1 )	numberOfThreads = QThread::idealThreadCount();
+	QThreadPool::globalInstance()->setMaxThreadCount( numberOfThreads );
+}
+
 /*!
  *Sets the number of photons that the photon map can store to \a nPhotons.
  */
@@ -2150,6 +2346,48 @@ void MainWindow::SetPhotonMapBufferSize( unsigned int nPhotons )
 	m_bufferPhotons = nPhotons;
 }
 
+/*!
+ * Sets \a fileName as the cache file of the rays traced from the light to the first intersected surfaces.
+ * The next ray tracings start from the rays stored in the file if it was saved for the same scene geometry,
+ * light, random generator, number of rays and first stage materials. Otherwise, the file is saved with the new rays.
+ * An empty \a fileName disables the cache.
+ */
+void MainWindow::SetPrimaryRayCacheFile( QString fileName )
+{
+	m_primaryRayCacheFile = fileName;
+}
+
+/*!
+ * Sets \a fileName as the file where each ray tracing writes the time spent in its phases.
+ * If the \a fileName suffix is "json" the report is saved in JSON format, otherwise in CSV format.
+ * An empty \a fileName disables the profiling.
+ */
+void MainWindow::SetProfilingReportFile( QString fileName )
+{
+	m_profilingReportFile = fileName;
+}
+
+/*!
+ * Sets the seed of the random number generator to \a seed. The generator is restarted for the next ray tracing.
+ */
+void MainWindow::SetRandomDeviateSeed( unsigned int seed )
+{
+	m_randomSeed = seed;
+	delete m_rand;
+	m_rand = 0;
+}
+
+/*!
+ * Sets the ray tracer to use the independent substream \a substream of the random number generator.
+ * The generator is restarted for the next ray tracing.
+ */
+void MainWindow::SetRandomDeviateSubstream( unsigned int substream )
+{
+	m_randomSubstream = substream;
+	delete m_rand;
+	m_rand = 0;
+}
+
 /*!
  *Sets the random number generator type, \a typeName, for ray tracing.
  */
@@ -2198,6 +2436,25 @@ void MainWindow::SetRaysDrawingOptions(  bool drawRays, bool drawPhotons )
 	m_drawPhotons = drawPhotons;
 }
 
+/*!
+ * Sets \a nPhotons as the maximum number of photons used to represent the rays and the photons in the 3D view.
+ * If the photon map is larger, only a subset of its rays and photons is represented. If \a nPhotons is zero,
+ * all the photons are represented.
+ */
+void MainWindow::SetRaysDrawingLimit( unsigned int nPhotons )
+{
+	m_drawnPhotonsLimit = nPhotons;
+}
+
+/*!
+ *	Sets \a rays as the number of rays of each ray batch traced by a thread.
+ *	If \a rays is zero, the batch size is computed from the number of rays and threads.
+ */
+void MainWindow::SetRaysPerChunk( unsigned int rays )
+{
+	m_raysPerChunk = rays;
+}
+
 /*!
  *	Sets \a rays as the number of rays to trace for each run action.
  */
@@ -3025,6 +3282,45 @@ PhotonMapExport* MainWindow::CreatePhotonMapExport() const
 	return pExportMode;
 }
 
+/*!
+ * Creates the selected random generator if it is not created and sets its seed and substream.
+ *
+ * Returns \a false if the random generator can not be created.
+ */
+bool MainWindow::CreateRandomDeviate()
+{
+	if( m_rand )	return true;
+
+	QVector< RandomDeviateFactory* > randomDeviateFactoryList = m_pPluginManager->GetRandomDeviateFactories();
+	//Check if there is a random generator selected;
+	if( m_selectedRandomDeviate == -1 )
+	{
+		if( randomDeviateFactoryList.size() > 0 ) m_selectedRandomDeviate = 0;
+		else	return false;
+	}
+
+	m_rand =  randomDeviateFactoryList[m_selectedRandomDeviate]->CreateRandomDeviate();
+	if( !m_rand )	return false;
+
+	if( m_randomSeed > -1 && !m_rand->SetSeed( m_randomSeed ) )
+	{
+		emit Abort( tr( "The selected random generator can not be seeded." ) );
+		delete m_rand;
+		m_rand = 0;
+		return false;
+	}
+
+	if( m_randomSubstream > -1 && !m_rand->SetSubstream( m_randomSubstream ) )
+	{
+		emit Abort( tr( "The selected random generator does not provide substreams." ) );
+		delete m_rand;
+		m_rand = 0;
+		return false;
+	}
+
+	return true;
+}
+
 /*!
  * Creates a new delete command, where the \a index node was deleted.
   *
@@ -3060,6 +3356,60 @@ bool MainWindow::Delete( QModelIndex index )
 	return true;
 }
 
+/*!
+ * Prepares the \a directory for a distributed ray tracing. The current model is saved into the directory and
+ * \a commonScript is filled with the script lines that set the current ray tracing parameters in the workers.
+ *
+ * Returns \a false if the distributed ray tracing can not be started.
+ */
+bool MainWindow::DistributedSetup( QString directory, QString* commonScript )
+{
+	QDir workingDirectory( directory );
+	if( directory.isEmpty() || !workingDirectory.exists() )
+	{
+		emit Abort( tr( "The directory %1 does not exist." ).arg( directory ) );
+		return false;
+	}
+
+	QVector< RandomDeviateFactory* > randomDeviateFactoryList = m_pPluginManager->GetRandomDeviateFactories();
+	if( m_selectedRandomDeviate == -1 )
+	{
+		if( randomDeviateFactoryList.size() > 0 ) m_selectedRandomDeviate = 0;
+		else	return false;
+	}
+
+	RandomDeviate* substreamsTest = randomDeviateFactoryList[m_selectedRandomDeviate]->CreateRandomDeviate();
+	bool hasSubstreams = substreamsTest && substreamsTest->SetSubstream( 1 );
+	delete substreamsTest;
+	if( !hasSubstreams )
+	{
+		emit Abort( tr( "The selected random generator does not provide substreams." ) );
+		return false;
+	}
+
+	bool isModified = m_document->IsModified();
+	if( !m_document->WriteFile( workingDirectory.absoluteFilePath( QLatin1String( "distributed_model.tnh" ) ) ) )
+	{
+		emit Abort( tr( "The model can not be saved in the directory %1." ).arg( directory ) );
+		return false;
+	}
+	m_document->SetDocumentModified( isModified );
+
+	//All the workers must start from the same seed to use disjoint substreams of the same stream.
+	unsigned long seed = ( m_randomSeed > -1 ) ? m_randomSeed : 12345;
+
+	commonScript->append( QString( QLatin1String( "tonatiuh.SetRandomDeviateType( \"%1\" );\n" ) ).arg(
+			randomDeviateFactoryList[m_selectedRandomDeviate]->RandomDeviateName() ) );
+	commonScript->append( QString( QLatin1String( "tonatiuh.SetRandomDeviateSeed( %1 );\n" ) ).arg( QString::number( seed ) ) );
+	commonScript->append( QString( QLatin1String( "tonatiuh.SetRayCastingGrid( %1, %2 );\n" ) ).arg(
+			QString::number( m_widthDivisions ), QString::number( m_heightDivisions ) ) );
+	commonScript->append( QString( QLatin1String( "tonatiuh.SetPhotonMapBufferSize( %1 );\n" ) ).arg( QString::number( m_bufferPhotons ) ) );
+	commonScript->append( QLatin1String( "tonatiuh.SetIncreasePhotonMap( false );\n" ) );
+	commonScript->append( QLatin1String( "tonatiuh.SetRaysDrawingOptions( false, false );\n" ) );
+
+	return true;
+}
+
 /*!
  * Return horizontalSplitter splitter object.
  */
@@ -3208,16 +3558,8 @@ bool MainWindow::ReadyForRaytracing( InstanceNode*& rootSeparatorInstance,
 	lightTransform = static_cast< SoTransform * >( lightKit->getPart( "transform" ,false ) );
 
 
-	QVector< RandomDeviateFactory* > randomDeviateFactoryList = m_pPluginManager->GetRandomDeviateFactories();
-	//Check if there is a random generator selected;
-	if( m_selectedRandomDeviate == -1 )
-	{
-		if( randomDeviateFactoryList.size() > 0 ) m_selectedRandomDeviate = 0;
-		else	return false;
-	}
-
 	//Create the random generator
-	if( !m_rand )	m_rand =  randomDeviateFactoryList[m_selectedRandomDeviate]->CreateRandomDeviate();
+	if( !CreateRandomDeviate() )	return false;
 
 
 	//Create the photon map where photons are going to be stored
@@ -3240,6 +3582,215 @@ bool MainWindow::ReadyForRaytracing( InstanceNode*& rootSeparatorInstance,
 	return true;
 }
 
+/*!
+ * Runs the ray tracer to the defined model and parameters. If \a resumeCheckpoint is not null, the ray tracing
+ * continues from the checkpoint instead of tracing a new iteration.
+ *
+ * When the checkpoints are enabled, the rays are traced in segments of the checkpoint interval and the checkpoint is
+ * saved after each segment.
+ */
+void MainWindow::RunRayTracer( const TraceCheckpoint* resumeCheckpoint )
+{
+
+	InstanceNode* rootSeparatorInstance = 0;
+	InstanceNode* lightInstance = 0;
+	SoTransform* lightTransform = 0;
+	TSunShape* sunShape = 0;
+	TLightShape* raycastingSurface = 0;
+	TTransmissivity* transmissivity = 0;
+
+	bool isCheckpointEnabled = !m_checkpointFile.isEmpty() && m_checkpointRays > 0;
+	if( isCheckpointEnabled && m_randomSeed < 0 )
+	{
+		emit Abort( tr( "The checkpoints need a random generator seed. Set it with SetRandomDeviateSeed." ) );
+		return;
+	}
+
+	RayTracingProfiler::SetEnabled( !m_profilingReportFile.isEmpty() );
+	RayTracingProfiler::Reset();
+
+	QDateTime startTime = QDateTime::currentDateTime();
+	if( ReadyForRaytracing( rootSeparatorInstance, lightInstance, lightTransform, sunShape, raycastingSurface, transmissivity ) )
+	{
+		if( !m_pPhotonMap->GetExportMode() )
+		{
+			if( !m_pExportModeSettings ) return;
+			else
+			{
+
+				PhotonMapExport* pExportMode = CreatePhotonMapExport();
+				if( !pExportMode )	return;
+				if( resumeCheckpoint && !pExportMode->RestoreCheckpoint( resumeCheckpoint->exportState ) )
+				{
+					emit Abort( tr( "The exported photons do not match the checkpoint." ) );
+					delete pExportMode;
+					return;
+				}
+				if( !m_pPhotonMap->SetExportMode( pExportMode )  ) return;
+
+			}
+		}
+
+		QVector< InstanceNode* > exportSuraceList;
+		QStringList exportSurfaceURLList = m_pExportModeSettings->exportSurfaceNodeList;
+		for( int s = 0; s < exportSurfaceURLList.count(); s++ )
+		{
+			m_sceneModel->IndexFromNodeUrl( exportSurfaceURLList[s] );
+			InstanceNode* surfaceNode = m_sceneModel->NodeFromIndex( m_sceneModel->IndexFromNodeUrl( exportSurfaceURLList[s] ) );
+			exportSuraceList.push_back( surfaceNode );
+		}
+
+
+		UpdateLightSize();
+
+		//Compute bounding boxes and world to object transforms
+		{
+			ProfilerTimer profilerTimer( RayTracingProfiler::SceneTreeMap );
+			trf::ComputeSceneTreeMap( rootSeparatorInstance, Transform( new Matrix4x4 ), true );
+		}
+
+		m_pPhotonMap->SetConcentratorToWorld( rootSeparatorInstance->GetIntersectionTransform() );
+
+		TLightKit* light = static_cast< TLightKit* > ( lightInstance->GetNode() );
+		QSet< QString > disabledNodes = QString( light->disabledNodes.getValue().getString() ).split( ";", QString::SkipEmptyParts ).toSet();
+		QVector< QPair< TShapeKit*, Transform > > surfacesList;
+		{
+			ProfilerTimer profilerTimer( RayTracingProfiler::LightSourceArea );
+			trf::ComputeFistStageSurfaceList( rootSeparatorInstance, disabledNodes, &surfacesList );
+			light->ComputeLightSourceArea( m_widthDivisions, m_heightDivisions, surfacesList );
+		}
+		if( surfacesList.count() < 1 )
+		{
+			emit Abort( tr( "There are no surfaces defined for ray tracing" ) );
+
+			ShowRaysIn3DView();
+			return;
+		}
+
+		Transform lightToWorld = tgf::TransformFromSoTransform( lightTransform );
+		lightInstance->SetIntersectionTransform( lightToWorld.GetInverse() );
+
+		QVector< RandomDeviateFactory* > randomDeviateFactoryList = m_pPluginManager->GetRandomDeviateFactories();
+		QString randomDeviateName = randomDeviateFactoryList[m_selectedRandomDeviate]->RandomDeviateName();
+
+		//The checkpoint is valid for the same scene, light, random generator and materials
+		QByteArray checkpointKey;
+		if( isCheckpointEnabled || resumeCheckpoint )
+		{
+			checkpointKey = PrimaryRayCache::SceneKey( rootSeparatorInstance, lightToWorld, lightInstance,
+					m_widthDivisions, m_heightDivisions, randomDeviateName, m_randomSeed, m_randomSubstream );
+			checkpointKey.append( PrimaryRayCache::MaterialsKey( rootSeparatorInstance ) );
+		}
+
+		unsigned long lastRay = m_tracedRays + m_raysPerIteration;
+		if( resumeCheckpoint )
+		{
+			if( checkpointKey != resumeCheckpoint->sceneKey )
+			{
+				emit Abort( tr( "The checkpoint was saved for another model or ray tracing parameters." ) );
+				return;
+			}
+
+			m_rand->Skip( resumeCheckpoint->randomStreamPosition );
+			m_rand->ReservePaths( resumeCheckpoint->randomReservedPaths );
+			m_tracedRays = resumeCheckpoint->tracedRays;
+			lastRay = resumeCheckpoint->lastRay;
+		}
+
+		//The cached rays are not added to a photon map with previous rays
+		PrimaryRayCache* primaryRayCache = 0;
+		if( !m_primaryRayCacheFile.isEmpty() && m_tracedRays < 1 && !isCheckpointEnabled )
+		{
+			QByteArray sceneKey = PrimaryRayCache::SceneKey( rootSeparatorInstance, lightToWorld, lightInstance,
+					m_widthDivisions, m_heightDivisions,
+					randomDeviateName, m_randomSeed, m_randomSubstream );
+
+			primaryRayCache = new PrimaryRayCache( m_primaryRayCacheFile, sceneKey, m_raysPerIteration );
+			primaryRayCache->Read( rootSeparatorInstance );
+		}
+
+		double irradiance = sunShape->GetIrradiance();
+		double inputAperture = raycastingSurface->GetValidArea();
+
+		bool isCanceled = false;
+		while( !isCanceled && m_tracedRays < lastRay )
+		{
+			unsigned long segmentRays = lastRay - m_tracedRays;
+			if( isCheckpointEnabled && segmentRays > m_checkpointRays )	segmentRays = m_checkpointRays;
+			QVector< long > raysPerThread = trf::ComputeRaysPerThread( segmentRays, m_raysPerChunk );
+
+			// Create a progress dialog.
+			QProgressDialog dialog;
+			dialog.setLabelText( QString("Progressing using %1 thread(s)..." ).arg( QThreadPool::globalInstance()->maxThreadCount() ) );
+
+			// Create a QFutureWatcher and conncect signals and slots.
+			QFutureWatcher< void > futureWatcher;
+			QObject::connect(&futureWatcher, SIGNAL(finished()), &dialog, SLOT(reset()));
+			QObject::connect(&dialog, SIGNAL(canceled()), &futureWatcher, SLOT(cancel()));
+			QObject::connect(&futureWatcher, SIGNAL(progressRangeChanged(int, int)), &dialog, SLOT(setRange(int, int)));
+			QObject::connect(&futureWatcher, SIGNAL(progressValueChanged(int)), &dialog, SLOT(setValue(int)));
+
+			QMutex mutex;
+			QMutex mutexPhotonMap;
+			QFuture< void > photonMap;
+			photonMap = QtConcurrent::map( raysPerThread, RayTracer(  rootSeparatorInstance,
+							lightInstance, raycastingSurface, sunShape, lightToWorld,
+							transmissivity,
+							*m_rand,
+							&mutex, m_pPhotonMap, &mutexPhotonMap,
+							exportSuraceList, primaryRayCache ) );
+
+			futureWatcher.setFuture( photonMap );
+
+			// Display the dialog and start the event loop.
+			dialog.exec();
+			futureWatcher.waitForFinished();
+			isCanceled = futureWatcher.isCanceled();
+
+			m_tracedRays += segmentRays;
+
+			if( isCheckpointEnabled && !isCanceled &&
+					!WriteCheckpoint( checkpointKey, lastRay, ( inputAperture * irradiance ) / m_tracedRays ) )
+			{
+				delete primaryRayCache;
+				RayTracingProfiler::SetEnabled( false );
+				return;
+			}
+		}
+
+		if( primaryRayCache )
+		{
+			if( !isCanceled && !primaryRayCache->Write() )
+				emit Abort( tr( "The primary rays can not be written to %1." ).arg( m_primaryRayCacheFile ) );
+			delete primaryRayCache;
+		}
+
+		if( exportSuraceList.count() < 1 )
+			ShowRaysIn3DView();
+		else
+		{
+			actionDisplayRays->setEnabled( false );
+			actionDisplayRays->setChecked( false );
+		}
+
+
+		double wPhoton = ( inputAperture * irradiance ) / m_tracedRays;
+
+		{
+			ProfilerTimer profilerTimer( RayTracingProfiler::PhotonExport );
+			m_pPhotonMap->EndStore( wPhoton );
+		}
+
+		if( RayTracingProfiler::IsEnabled() && !RayTracingProfiler::WriteReport( m_profilingReportFile ) )
+			emit Abort( tr( "The profiling report can not be written to %1." ).arg( m_profilingReportFile ) );
+	}
+
+	RayTracingProfiler::SetEnabled( false );
+
+	QDateTime endTime = QDateTime::currentDateTime();
+	std::cout <<"Elapsed time: "<< startTime.secsTo( endTime ) << std::endl;
+}
+
 /*!
  * Returns \a true if the tonatiuh model is correctly saved into the the given \a fileName. Otherwise, returns \a false.
  *
@@ -3254,7 +3805,7 @@ bool MainWindow::SaveFile( const QString& fileName )
 	}
 
 	SetCurrentFile( fileName );
-	statusBar()->showMessage( tr( "File saved" ), 2000 );
+	statusBar()->showMessage( tr( "File saved in %1 s" ).arg( m_document->GetWriteTime() ), 2000 );
 	return true;
 }
 
@@ -3826,6 +4377,7 @@ void MainWindow::SetupTriggers()
 	connect( actionGridSettings, SIGNAL( triggered() ), this, SLOT( ChangeGridSettings() )  );
 	connect( actionBackground, SIGNAL( triggered() ), this, SLOT( ShowBackground() )  );
 
+	connect( this, SIGNAL( Abort( QString ) ), this, SLOT( RecordAbort( QString ) ) );
 
 }
 
@@ -3851,19 +4403,39 @@ void MainWindow::ShowRaysIn3DView()
 
 	if( m_drawRays || m_drawPhotons )
 	{
+		// The vertices of large photon maps are computed in a worker thread to keep the interface responsive
+		trf::PhotonMapVertices vertices;
+		if( m_pPhotonMap->GetAllPhotons().size() < 100000 )
+			trf::ComputePhotonMapVertices( m_pPhotonMap, m_drawPhotons, m_drawRays, m_drawnPhotonsLimit, &vertices );
+		else
+		{
+			QProgressDialog dialog;
+			dialog.setLabelText( tr( "Preparing rays representation..." ) );
+			dialog.setCancelButton( 0 );
+			dialog.setRange( 0, 0 );
+
+			QFutureWatcher< void > futureWatcher;
+			QObject::connect( &futureWatcher, SIGNAL( finished() ), &dialog, SLOT( reset() ) );
+			futureWatcher.setFuture( QtConcurrent::run( trf::ComputePhotonMapVertices,
+					m_pPhotonMap, m_drawPhotons, m_drawRays, m_drawnPhotonsLimit, &vertices ) );
+
+			dialog.exec();
+			futureWatcher.waitForFinished();
+		}
+
 		SoSeparator* rays = new SoSeparator;
 		rays->setName( "Rays" );
 
 		if( m_drawPhotons )
 		{
-			SoSeparator* points = trf::DrawPhotonMapPoints( *m_pPhotonMap );
+			SoSeparator* points = trf::DrawPhotonMapPoints( vertices.points );
 			rays->addChild(points);
 		}
 
 		if( m_drawRays )
 		{
 
-			SoSeparator* currentRays = trf::DrawPhotonMapRays( *m_pPhotonMap, m_tracedRays );
+			SoSeparator* currentRays = trf::DrawPhotonMapRays( vertices.rayPoints, vertices.rayLengths );
 			if( currentRays )	rays->addChild( currentRays );
 
 		}
@@ -3903,7 +4475,7 @@ bool MainWindow::StartOver( const QString& fileName )
 	//QStatusBar* statusbar = statusBar();
 	if( !fileName.isEmpty() && m_document->ReadFile( fileName ) )
 	{
-		statusbar->showMessage( tr( "File loaded" ), 2000 );
+		statusbar->showMessage( tr( "File loaded in %1 s" ).arg( m_document->GetReadTime() ), 2000 );
 	    SetCurrentFile( fileName );
 	}
 	else
@@ -3985,6 +4557,51 @@ void MainWindow::UpdateRecentFileActions()
 	}
 }
 
+/*!
+ * Exports the photons stored in memory and saves the checkpoint of the ray tracing to the checkpoint file.
+ * The checkpoint is saved for the \a sceneKey and the ray tracing ends at the \a lastRay. \a wPhoton is the
+ * power per photon of the rays traced until now.
+ *
+ * Returns false if the checkpoint can not be saved.
+ */
+bool MainWindow::WriteCheckpoint( QByteArray sceneKey, unsigned long lastRay, double wPhoton )
+{
+	m_pPhotonMap->FlushStore();
+
+	//The next segment starts with new random numbers, as the resumed ray tracing
+	m_rand->Skip( 0 );
+
+	PhotonMapExport* exportMode = m_pPhotonMap->GetExportMode();
+	exportMode->SetPowerPerPhoton( wPhoton );
+
+	TraceCheckpoint checkpoint;
+	if( !exportMode->SaveCheckpoint( &checkpoint.exportState ) )
+	{
+		emit Abort( tr( "The photon map export type %1 does not support checkpoints." ).arg( m_pExportModeSettings->modeTypeName ) );
+		return false;
+	}
+
+	QVector< RandomDeviateFactory* > randomDeviateFactoryList = m_pPluginManager->GetRandomDeviateFactories();
+	checkpoint.sceneKey = sceneKey;
+	checkpoint.randomDeviateName = randomDeviateFactoryList[m_selectedRandomDeviate]->RandomDeviateName();
+	checkpoint.randomSeed = m_randomSeed;
+	checkpoint.randomSubstream = m_randomSubstream;
+	checkpoint.randomStreamPosition = m_rand->StreamPosition();
+	checkpoint.randomReservedPaths = m_rand->ReservedPaths();
+	checkpoint.tracedRays = m_tracedRays;
+	checkpoint.lastRay = lastRay;
+	checkpoint.checkpointRays = m_checkpointRays;
+	checkpoint.wPhoton = wPhoton;
+	checkpoint.exportModeName = m_pExportModeSettings->modeTypeName;
+
+	if( !checkpoint.Write( m_checkpointFile ) )
+	{
+		emit Abort( checkpoint.GetErrorMessage() );
+		return false;
+	}
+	return true;
+}
+
 /*!
  * Saves application settings.
  */
@@ -66,6 +66,7 @@ class TPhotonMap;
 class PhotonToMemory;
 class TShapeFactory;
 class TSunShape;
+class TraceCheckpoint;
 class TTrackerFactory;
 class TTransmissivity;
 class SoCamera;
@@ -89,6 +90,7 @@ public:
     void FinishManipulation( );
     void StartManipulation( SoDragger* dragger );
     void ExecuteScriptFile( QString tonatiuhScriptFile );
+    QString GetAbortMessage() const;
     void SetPluginManager( PluginManager* pluginManager );
 
 signals:
@@ -118,14 +120,20 @@ public slots:
 	void Paste( QString nodeURL, QString pasteType = QString( "Shared" ) );
 	void PasteCopy();
 	void PasteLink();
+	void ResumeRun( QString checkpointFile );
 	void Run();
+	void RunDistributed( int numberOfProcesses, QString directory, QString fileName );
+	void RunDistributedFluxAnalysis( QString nodeURL, QString surfaceSide, unsigned int nOfRays, int heightDivisions, int widthDivisions, QString directory, QString fileName, bool saveCoords, int numberOfProcesses );
 	void RunFluxAnalysis( QString nodeURL, QString surfaceSide, unsigned int nOfRays, int heightDivisions, int widthDivisions, QString directory, QString fileName, bool saveCoords );
+	void RunHeliostatFieldAnalysis( unsigned int probeRays, QString directory, QString fileName );
+	void RunMultipleFluxAnalysis( QString nodeURLs, QString surfaceSides, unsigned int nOfRays, QString heightDivisions, QString widthDivisions, QString directory, QString fileNames, bool saveCoords );
 	bool Save();
 	void SaveComponent( QString componentFileName  );
 	void SaveAs( QString fileName );
     void SelectNode( QString nodeUrl );
 	void SetAimingPointAbsolute();
 	void SetAimingPointRelative();
+	void SetCheckpoint( QString fileName, unsigned int raysInterval );
 	void SetExportAllPhotonMap();
 	void SetExportCoordinates( bool enabled, bool global );
 	void SetExportIntersectionSurface( bool enabled );
@@ -133,12 +141,20 @@ public slots:
 	void SetExportPhotonMapType( QString exportModeType );
 	void SetExportPreviousNextPhotonID( bool enabled );
 	void SetExportTypeParameterValue( QString parameterName, QString parameterValue );
+	void SetFileFormat( QString format );
     void SetIncreasePhotonMap( bool increase );
     void SetNodeName( QString nodeName );
+    void SetNumberOfThreads( unsigned int numberOfThreads );
     void SetPhotonMapBufferSize( unsigned int nPhotons );
+    void SetPrimaryRayCacheFile( QString fileName );
+    void SetProfilingReportFile( QString fileName );
+    void SetRandomDeviateSeed( unsigned int seed );
+    void SetRandomDeviateSubstream( unsigned int substream );
     void SetRandomDeviateType( QString typeName );
     void SetRayCastingGrid( int widthDivisions, int heightDivisions );
+    void SetRaysDrawingLimit( unsigned int nPhotons );
     void SetRaysDrawingOptions( bool drawRays, bool drawPhotons );
+    void SetRaysPerChunk( unsigned int rays );
     void SetRaysPerIteration( unsigned int rays );
     void SetSunshape( QString sunshapeType );
     void SetSunshapeParameter( QString parameter, QString value );
@@ -169,6 +185,7 @@ private slots:
 	void ItemDragAndDropCopy(const QModelIndex& newParent, const QModelIndex& node);
 	void Open();
 	void OpenRecentFile();
+	void RecordAbort( QString error );
 	void Redo();
 	void RunCompleteRayTracer();
 	void RunFluxAnalysisRayTracer();
@@ -217,6 +234,8 @@ private:
     void ChangeModelScene();
 	SoSeparator* CreateGrid( int xDimension, int zDimension, double xSpacing, double zSpacing );
     PhotonMapExport* CreatePhotonMapExport() const;
+    bool CreateRandomDeviate();
+    bool DistributedSetup( QString directory, QString* commonScript );
     QToolBar* CreateTrackerTooBar( QMenu* pMaterialsMenu );
     bool Delete( QModelIndex index );
    	QSplitter* GetHorizontalSplitterPointer();
@@ -233,6 +252,7 @@ private:
 			                 TSunShape*& sunShape,
 			                 TLightShape*& shape,
 			                 TTransmissivity*& transmissivity );
+    void RunRayTracer( const TraceCheckpoint* resumeCheckpoint );
     bool SaveFile( const QString& fileName );
     void SetCurrentFile( const QString& fileName );
     bool SetPhotonMapExportSettings();
@@ -256,6 +276,7 @@ private:
     bool StartOver( const QString& fileName );
     QString StrippedName( const QString& fullFileName );
     void UpdateLightSize();
+    bool WriteCheckpoint( QByteArray sceneKey, unsigned long lastRay, double wPhoton );
     void UpdateRecentFileActions();
     void WriteSettings();
     double GetwPhoton();
@@ -263,6 +284,7 @@ private:
     enum { m_maxRecentFiles = 7 };
     QUndoStack* m_commandStack;
     QUndoView* m_commandView;
+    QString m_abortMessage;
     QString m_currentFile;
     Document* m_document;
     QStringList m_recentFiles;
@@ -275,6 +297,8 @@ private:
 
     RandomDeviate* m_rand;
     int m_selectedRandomDeviate;
+    long m_randomSeed;
+    long m_randomSubstream;
 
 
     unsigned long m_bufferPhotons;
@@ -292,11 +316,17 @@ private:
 
     unsigned long m_tracedRays;
     unsigned long m_raysPerIteration;
+    unsigned long m_raysPerChunk;
+    QString m_profilingReportFile;
+    QString m_primaryRayCacheFile;
+    QString m_checkpointFile;
+    unsigned long m_checkpointRays;
     int m_heightDivisions;
     int m_widthDivisions;
 
     bool m_drawPhotons;
     bool m_drawRays;
+    unsigned long m_drawnPhotonsLimit;
 
     int m_gridXElements;
     int m_gridZElements;
@@ -63,6 +63,24 @@ PhotonMapExport::~PhotonMapExport()
 
 }
 
+/*!
+ * Restores the export to the \a state saved with SaveCheckpoint. The data exported after the checkpoint is discarded.
+ * Returns false if the export does not support checkpoints or the exported data does not match the \a state.
+ */
+bool PhotonMapExport::RestoreCheckpoint( const QByteArray& /*state*/ )
+{
+	return false;
+}
+
+/*!
+ * Saves in \a state the information needed to continue the export after the photons exported until now.
+ * Returns false if the export does not support checkpoints.
+ */
+bool PhotonMapExport::SaveCheckpoint( QByteArray* /*state*/ ) const
+{
+	return false;
+}
+
 /*!
  * Sets the transformation to change from concentrator coordinates to world coordinates.
  */
@@ -41,6 +41,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 
 #include <vector>
 
+#include <QByteArray>
 #include <QStringList>
 
 #include "Photon.h"
@@ -55,6 +56,8 @@ public:
 	virtual ~PhotonMapExport();
 
 	virtual void EndExport() = 0;
+	virtual bool RestoreCheckpoint( const QByteArray& state );
+	virtual bool SaveCheckpoint( QByteArray* state ) const;
 	virtual void SavePhotonMap( std::vector < Photon* > raysLists ) = 0;
 	void SetConcentratorToWorld( Transform concentratorToWorld );
 	virtual void SetPowerPerPhoton( double wPhoton ) = 0;
@@ -84,6 +84,7 @@ void SceneModel::SetCoinRoot( SoSeparator& coinRoot )
 {
 	m_coinRoot = &coinRoot;
 	m_mapCoinQt.clear();
+	m_instanceURLIndex.clear();
 }
 
 /*!
@@ -96,6 +97,7 @@ void SceneModel::SetCoinScene( TSceneKit& coinScene )
 	beginResetModel();
 	if( m_instanceRoot )	Clear();
 	m_mapCoinQt.clear();
+	m_instanceURLIndex.clear();
 	m_coinScene = 0;
     m_coinScene = &coinScene;
 
@@ -116,6 +118,7 @@ void SceneModel::Clear()
 
 	delete m_instanceRoot;
 	m_instanceRoot = 0;
+	m_instanceURLIndex.clear();
 
 }
 
@@ -130,6 +133,7 @@ void SceneModel::SetRoot()
     QList< InstanceNode* > instanceRootNodeList;
     m_mapCoinQt.insert( std::make_pair( m_coinScene, instanceRootNodeList ) );
     m_mapCoinQt[m_coinScene].append( m_instanceRoot );
+    AddToURLIndex( *m_instanceRoot );
 }
 
 void SceneModel::SetLight()
@@ -200,6 +204,7 @@ InstanceNode* SceneModel::AddInstanceNode( InstanceNode& instanceNodeParent, SoN
 	if( instanceNode )
 	{
 		instanceNodeParent.AddChild( instanceNode );
+		AddToURLIndex( *instanceNode );
 		QList< InstanceNode* > instanceNodeList;
 		m_mapCoinQt.insert( std::make_pair( soNode, instanceNodeList ) );
 		m_mapCoinQt[soNode].append( instanceNode );
@@ -450,6 +455,7 @@ int SceneModel::InsertCoinNode( SoNode& coinChild, SoBaseKit& coinParent )
 	    InstanceNode* instanceParent = instanceListParent[index];
 		InstanceNode* instanceChild = new InstanceNode( &coinChild );
 		instanceParent->InsertChild( row, instanceChild );
+		AddToURLIndex( *instanceChild );
 
 		//Inserting InstanceNode in the map
 		QList< InstanceNode* > instanceNodeList;
@@ -471,7 +477,11 @@ void SceneModel::InsertLightNode( TLightKit& coinLight )
 {
 	SoNodeKitListPart* lightList = static_cast< SoNodeKitListPart* > ( m_coinScene->getPart("lightList", true ) ) ;
 	if ( lightList->getNumChildren() > 0 )
-		if( m_instanceRoot->children.size() > 0 ) m_instanceRoot->children.remove( 0 );
+		if( m_instanceRoot->children.size() > 0 )
+		{
+			RemoveFromURLIndex( *m_instanceRoot->children[0] );
+			m_instanceRoot->children.remove( 0 );
+		}
 
 	m_coinScene->setPart( "lightList[0]", &coinLight );
 
@@ -491,6 +501,7 @@ void SceneModel::InsertLightNode( TLightKit& coinLight )
 
 	InstanceNode* instanceLight = new InstanceNode( &coinLight );
 	m_instanceRoot->InsertChild( 0, instanceLight );
+	AddToURLIndex( *instanceLight );
 
 
 	emit LightNodeStateChanged( 1 );
@@ -525,6 +536,7 @@ void SceneModel::RemoveCoinNode( int row, SoBaseKit& coinParent )
 	{
 	    InstanceNode* instanceParent = instanceListParent[index];
 	    InstanceNode* instanceNode = instanceParent->children[row];
+	    RemoveFromURLIndex( *instanceNode );
 	    instanceParent->children.remove(row);
 
 	    QList<InstanceNode*>& instanceList = m_mapCoinQt[ instanceNode->GetNode()];
@@ -537,6 +549,7 @@ void SceneModel::RemoveLightNode( TLightKit& coinLight )
 {
 	SoNodeKitListPart* lightList = static_cast< SoNodeKitListPart* >( m_coinScene->getPart( "lightList", true ) );
     if ( lightList ) lightList->removeChild( &coinLight );
+    RemoveFromURLIndex( *m_instanceRoot->children[0] );
     m_instanceRoot->children.remove( 0 );
 
 	SoSearchAction trackersSearch;
@@ -677,12 +690,40 @@ bool SceneModel::Cut( SoBaseKit& coinParent, int row )
 /**
  * Returns the index of item with the \a nodeUrl.
  *
- * If \a nodeUrl is not a valid node url, the function returns root node index.
+ * The node is found in the URL index of the model. If \a nodeUrl is not a valid node url, the function returns an invalid index.
  *
  *
  * \sa IndexFromNodeUrl, NodeFromIndex, PathFromIndex.
 **/
 QModelIndex SceneModel::IndexFromNodeUrl( QString nodeUrl ) const
+{
+	QStringList nodeList = nodeUrl.split( QLatin1String( "/" ), QString::SkipEmptyParts );
+	if( nodeList.size() < 1 )	return QModelIndex();
+
+	if( ( nodeList.size() == 1 ) &&
+			( nodeList[0] == QLatin1String( "Light" ) ) )	return index( 0, 0 );
+
+	if( !m_instanceRoot )	return QModelIndex();
+
+	// The root node name is not part of the url
+	QString instanceURL = m_instanceRoot->GetNodeURL() + QLatin1String( "/" ) + nodeList.join( QLatin1String( "/" ) );
+	QList< InstanceNode* > instanceList = m_instanceURLIndex.values( instanceURL );
+	if( instanceList.size() < 1 )	return QModelIndex();
+	if( instanceList.size() == 1 )	return IndexFromInstance( instanceList[0] );
+
+	// There are sibling nodes with the same name, the first one is selected
+	return IndexFromNodeUrlPath( nodeUrl );
+}
+
+/**
+ * Returns the index of the first item with the \a nodeUrl, following the url path from the root node.
+ *
+ * If \a nodeUrl is not a valid node url, the function returns root node index.
+ *
+ *
+ * \sa IndexFromNodeUrl.
+**/
+QModelIndex SceneModel::IndexFromNodeUrlPath( QString nodeUrl ) const
 {
 	QStringList nodeList = nodeUrl.split( QLatin1String( "/" ), QString::SkipEmptyParts );
 
@@ -695,14 +736,15 @@ QModelIndex SceneModel::IndexFromNodeUrl( QString nodeUrl ) const
 		nodeList.removeLast();
 
 		QString parentNodeURL = QString( QLatin1String( "//" ) ) + nodeList.join( QLatin1String( "/" ) );
-		QModelIndex parentIndex = IndexFromNodeUrl( parentNodeURL );
+		QModelIndex parentIndex = IndexFromNodeUrlPath( parentNodeURL );
 		InstanceNode* parentNode = NodeFromIndex( parentIndex );
 
+		SbName coinNodeName( nodeName.toStdString().c_str() );
 		int child = 0;
 		int row = -1;
 		while( child < parentNode->children.count() )
 		{
-			if( parentNode->children[child]->GetNode()->getName()  == SbName( nodeName.toStdString().c_str() ) )
+			if( parentNode->children[child]->GetNode()->getName()  == coinNodeName )
 			{
 				row = child;
 				break;
@@ -710,7 +752,6 @@ QModelIndex SceneModel::IndexFromNodeUrl( QString nodeUrl ) const
 			child++;
 		}
 		if( row < 0 )	return QModelIndex();
-		//if(nodeName == ".") return index(row+1, 0, parentIndex );
 		return index(row, 0, parentIndex );
 	}
 	else
@@ -718,6 +759,17 @@ QModelIndex SceneModel::IndexFromNodeUrl( QString nodeUrl ) const
 
 }
 
+/**
+ * Returns the index of the \a instanceNode item.
+**/
+QModelIndex SceneModel::IndexFromInstance( InstanceNode* instanceNode ) const
+{
+	InstanceNode* instanceParent = instanceNode->GetParent();
+	if( !instanceParent )	return QModelIndex();
+
+	return createIndex( instanceParent->children.indexOf( instanceNode ), 0, instanceNode );
+}
+
 /**
  * Returns the index of item with the \a coinNodePath.
  *
@@ -853,6 +905,7 @@ bool SceneModel::Paste( tgc::PasteType type, SoBaseKit& coinParent, SoNode& coin
 	    InstanceNode* instanceParent = instanceListParent[index];
 		InstanceNode* instanceChild = new InstanceNode( coinChild );
 		instanceParent->InsertChild( row, instanceChild );
+		AddToURLIndex( *instanceChild );
 
 		//Inserting InstanceNode in the map
 		QList< InstanceNode* > instanceNodeList;
@@ -885,8 +938,16 @@ bool SceneModel::SetNodeName( SoNode* coinChild, QString newName )
 			if( child!= childIndex && idChildName == newName.toStdString().c_str() )	return false;
 		}
 	}
+	for( int index = 0; index < nodeInstances.size(); ++index )
+		RemoveFromURLIndex( *nodeInstances[index] );
+
 	coinChild->setName( newName.toStdString().c_str() );
 
+	for( int index = 0; index < nodeInstances.size(); ++index )
+	{
+		nodeInstances[index]->UpdateNodeURL();
+		AddToURLIndex( *nodeInstances[index] );
+	}
 
 	emit layoutChanged();
 	return true;
@@ -920,6 +981,26 @@ void SceneModel::UpdateSceneModel()
 
 }
 
+/*!
+ * Adds \a instanceNode and its children to the model URL index.
+ */
+void SceneModel::AddToURLIndex( InstanceNode& instanceNode )
+{
+	m_instanceURLIndex.insert( instanceNode.GetNodeURL(), &instanceNode );
+	for( int index = 0; index < instanceNode.children.count(); ++index )
+		AddToURLIndex( *instanceNode.children[index] );
+}
+
+/*!
+ * Removes \a instanceNode and its children from the model URL index.
+ */
+void SceneModel::RemoveFromURLIndex( InstanceNode& instanceNode )
+{
+	m_instanceURLIndex.remove( instanceNode.GetNodeURL(), &instanceNode );
+	for( int index = 0; index < instanceNode.children.count(); ++index )
+		RemoveFromURLIndex( *instanceNode.children[index] );
+}
+
 void SceneModel::DeleteInstanceTree( InstanceNode& instanceNode )
 {
 
@@ -934,6 +1015,7 @@ void SceneModel::DeleteInstanceTree( InstanceNode& instanceNode )
 
 	QList<InstanceNode*>& instanceList = m_mapCoinQt[ instanceNode.GetNode()];
 	instanceList.removeAt( instanceList.indexOf( &instanceNode ) );
+	m_instanceURLIndex.remove( instanceNode.GetNodeURL(), &instanceNode );
 
 	InstanceNode* instanceParent = instanceNode.GetParent();
 	if( instanceParent )
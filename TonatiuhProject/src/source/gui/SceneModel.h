@@ -40,6 +40,7 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #define SCENEMODEL_H_
 
 #include <QAbstractItemModel>
+#include <QMultiHash>
 
 #include "tgc.h"
 
@@ -105,7 +106,11 @@ signals:
 	void LightNodeStateChanged( int newState );
 
 private:
+	void AddToURLIndex( InstanceNode& instanceNode );
 	void DeleteInstanceTree( InstanceNode& instanceNode );
+	QModelIndex IndexFromInstance( InstanceNode* instanceNode ) const;
+	QModelIndex IndexFromNodeUrlPath( QString nodeUrl ) const;
+	void RemoveFromURLIndex( InstanceNode& instanceNode );
 	void SetRoot();
 	void SetLight();
 	void SetConcentrator();
@@ -122,6 +127,7 @@ private:
 	InstanceNode* m_instanceRoot;
 	InstanceNode* m_instanceConcentrator;
 	std::map< SoNode*, QList<InstanceNode*> > m_mapCoinQt;
+	QMultiHash< QString, InstanceNode* > m_instanceURLIndex;
 };
 
 #endif /*SCENEMODEL_H_*/
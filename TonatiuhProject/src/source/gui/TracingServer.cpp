@@ -0,0 +1,357 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QScriptEngine>
+#include <QTime>
+#include <QTimer>
+
+#include "MainWindow.h"
+#include "SceneCache.h"
+#include "TracingServer.h"
+
+ Q_DECLARE_METATYPE(QVector<QVariant>)
+
+/*!
+ * Creates a server that runs the jobs with the plugins of \a pluginManager. The scenes read by the jobs are
+ * kept in the SceneCache while the server exists.
+ */
+TracingServer::TracingServer( PluginManager* pluginManager, QObject* parent )
+:QObject( parent ),
+ m_pPluginManager( pluginManager ),
+ m_server( 0 ),
+ m_isRunning( false ),
+ m_isQuitRequested( false ),
+ m_interpreter( 0 )
+{
+	m_server = new QLocalServer( this );
+#if QT_VERSION >= 0x050000
+	//Only the user that runs the server can connect to it
+	m_server->setSocketOptions( QLocalServer::UserAccessOption );
+#endif
+	connect( m_server, SIGNAL( newConnection() ), this, SLOT( AddConnection() ) );
+
+	SceneCache::SetEnabled( true );
+}
+
+/*!
+ * Destroys the server and releases the cached scenes.
+ */
+TracingServer::~TracingServer()
+{
+	SceneCache::SetEnabled( false );
+}
+
+QString TracingServer::GetErrorMessage() const
+{
+	return m_errorMessage;
+}
+
+/*!
+ * Returns the full name of the local socket where the server is listening.
+ */
+QString TracingServer::GetServerName() const
+{
+	return m_server->fullServerName();
+}
+
+/*!
+ * Starts listening for clients on the local socket \a serverName. A socket left by a server that was not
+ * stopped is removed, but the socket of a server that is still running is not.
+ *
+ * Returns false if the server cannot listen.
+ */
+bool TracingServer::Listen( QString serverName )
+{
+	if( m_server->listen( serverName ) )	return true;
+
+	QLocalSocket socket;
+	socket.connectToServer( serverName );
+	if( socket.waitForConnected( 1000 ) )
+	{
+		socket.disconnectFromServer();
+		m_errorMessage = QString( QLatin1String( "Cannot listen on %1: Another server is running" ) ).arg( serverName );
+		return false;
+	}
+
+	QLocalServer::removeServer( serverName );
+	if( m_server->listen( serverName ) )	return true;
+
+	m_errorMessage = QString( QLatin1String( "Cannot listen on %1: %2" ) ).arg( serverName, m_server->errorString() );
+	return false;
+}
+
+/*!
+ * Sends the message printed by the running job script to its client.
+ */
+QScriptValue TracingServer::PrintMessage( QScriptContext* context, QScriptEngine* engine )
+{
+	TracingServer* server = qobject_cast< TracingServer* >( context->callee().data().toQObject() );
+
+	QString message;
+	for( int a = 0; a < context->argumentCount(); ++a )
+	{
+		if( a > 0 )	message.append( QLatin1Char( ' ' ) );
+		message.append( context->argument( a ).toString() );
+	}
+	if( server )	server->SendStatus( server->m_currentJob, QLatin1String( "output" ), QLatin1String( "message" ), JSONString( message ) );
+
+	return engine->undefinedValue();
+}
+
+/*!
+ * Stops the running job with the \a error emitted by the MainWindow.
+ */
+void TracingServer::AbortJob( QString error )
+{
+	if( m_jobError.isEmpty() )	m_jobError = error;
+	if( m_interpreter && m_interpreter->isEvaluating() )	m_interpreter->currentContext()->throwError( error );
+}
+
+/*!
+ * Accepts the pending client connections.
+ */
+void TracingServer::AddConnection()
+{
+	while( m_server->hasPendingConnections() )
+	{
+		QLocalSocket* client = m_server->nextPendingConnection();
+		connect( client, SIGNAL( readyRead() ), this, SLOT( ReadJobs() ) );
+		connect( client, SIGNAL( disconnected() ), client, SLOT( deleteLater() ) );
+	}
+}
+
+/*!
+ * Reads the complete job lines of the client and adds the jobs to the queue.
+ */
+void TracingServer::ReadJobs()
+{
+	QLocalSocket* client = qobject_cast< QLocalSocket* >( sender() );
+	if( !client )	return;
+
+	while( client->canReadLine() )
+	{
+		QString line = QString::fromUtf8( client->readLine() ).trimmed();
+		if( line.isEmpty() )	continue;
+
+		Job job;
+		job.client = client;
+		QString command;
+		QString error;
+		if( !ParseJob( line, &job, &command, &error ) )
+		{
+			SendStatus( job, QLatin1String( "failed" ), QLatin1String( "error" ), JSONString( error ) );
+		}
+		else if( command == QLatin1String( "quit" ) )
+		{
+			//The queued jobs are finished before quitting
+			m_isQuitRequested = true;
+			m_server->close();
+		}
+		else
+		{
+			m_jobs.push_back( job );
+			SendStatus( job, QLatin1String( "queued" ), QLatin1String( "position" ), QString::number( m_jobs.size() ) );
+		}
+	}
+
+	QTimer::singleShot( 0, this, SLOT( RunNextJob() ) );
+}
+
+/*!
+ * Runs the first job of the queue if no job is running. The job script is evaluated with a new MainWindow
+ * and the result is sent to the client of the job.
+ */
+void TracingServer::RunNextJob()
+{
+	//The ray tracing dialogs process the events while a job is running
+	if( m_isRunning )	return;
+	if( m_jobs.isEmpty() )
+	{
+		if( m_isQuitRequested )	QCoreApplication::quit();
+		return;
+	}
+
+	m_isRunning = true;
+	m_currentJob = m_jobs.takeFirst();
+	m_jobError.clear();
+
+	if( m_currentJob.client )
+	{
+		SendStatus( m_currentJob, QLatin1String( "running" ) );
+		QTime jobTime;
+		jobTime.start();
+
+		MainWindow* mainWindow = new MainWindow( QLatin1String( "" ) );
+		mainWindow->SetPluginManager( m_pPluginManager );
+		connect( mainWindow, SIGNAL( Abort( QString ) ), this, SLOT( AbortJob( QString ) ) );
+
+		m_interpreter = new QScriptEngine;
+		qScriptRegisterSequenceMetaType<QVector<QVariant> >( m_interpreter );
+		m_interpreter->globalObject().setProperty( "tonatiuh", m_interpreter->newQObject( mainWindow ) );
+		QScriptValue printFunction = m_interpreter->newFunction( TracingServer::PrintMessage );
+		printFunction.setData( m_interpreter->newQObject( this ) );
+		m_interpreter->globalObject().setProperty( "print", printFunction );
+
+		if( !m_currentJob.model.isEmpty() )
+		{
+			QFileInfo modelFile( m_currentJob.model );
+			if( !modelFile.isFile() || modelFile.suffix() != QLatin1String( "tnh" ) )
+				m_jobError = QString( QLatin1String( "Cannot open file %1." ) ).arg( m_currentJob.model );
+			else
+				mainWindow->Open( modelFile.absoluteFilePath() );
+		}
+
+		if( m_jobError.isEmpty() )
+		{
+			QScriptSyntaxCheckResult checkResult = m_interpreter->checkSyntax( m_currentJob.script );
+			if( checkResult.state() != QScriptSyntaxCheckResult::Valid )
+			{
+				m_jobError = QString( QLatin1String( "Script Syntaxis Error. Line: %1. %2" ) )
+						.arg( QString::number( checkResult.errorLineNumber() ), checkResult.errorMessage() );
+			}
+			else
+			{
+				QScriptValue result = m_interpreter->evaluate( m_currentJob.script );
+				if( result.isError() )
+				{
+					QString errorMessage = QString( QLatin1String( "Script Execution Error. Line %1. %2" ) )
+						.arg( QString::number( result.property( "lineNumber" ).toNumber() ), result.toString() );
+					if( m_jobError.isEmpty() )	m_jobError = errorMessage;
+				}
+			}
+		}
+
+		delete m_interpreter;
+		m_interpreter = 0;
+		delete mainWindow;
+
+		if( m_jobError.isEmpty() )
+			SendStatus( m_currentJob, QLatin1String( "finished" ), QLatin1String( "elapsed" ), QString::number( jobTime.elapsed() / 1000.0 ) );
+		else
+			SendStatus( m_currentJob, QLatin1String( "failed" ), QLatin1String( "error" ), JSONString( m_jobError ) );
+	}
+
+	m_currentJob = Job();
+	m_isRunning = false;
+	QTimer::singleShot( 0, this, SLOT( RunNextJob() ) );
+}
+
+/*!
+ * Returns \a text as a quoted JSON string.
+ */
+QString TracingServer::JSONString( const QString& text )
+{
+	QString json( QLatin1String( "\"" ) );
+	for( int c = 0; c < text.size(); ++c )
+	{
+		QChar character = text[c];
+		if( character == QLatin1Char( '"' ) )	json.append( QLatin1String( "\\\"" ) );
+		else if( character == QLatin1Char( '\\' ) )	json.append( QLatin1String( "\\\\" ) );
+		else if( character == QLatin1Char( '\n' ) )	json.append( QLatin1String( "\\n" ) );
+		else if( character == QLatin1Char( '\r' ) )	json.append( QLatin1String( "\\r" ) );
+		else if( character == QLatin1Char( '\t' ) )	json.append( QLatin1String( "\\t" ) );
+		else if( character.unicode() < 0x20 )
+			json.append( QString( QLatin1String( "\\u%1" ) ).arg( character.unicode(), 4, 16, QLatin1Char( '0' ) ) );
+		else	json.append( character );
+	}
+	json.append( QLatin1Char( '"' ) );
+	return json;
+}
+
+/*!
+ * Parses the JSON job \a line. A job with a "command" sets \a command; otherwise the "id", "model" and "script"
+ * of the \a job are set.
+ *
+ * Returns false and sets the \a error if the line is not a valid job.
+ */
+bool TracingServer::ParseJob( const QString& line, Job* job, QString* command, QString* error )
+{
+	QScriptEngine parser;
+	QScriptValue parse = parser.globalObject().property( "JSON" ).property( "parse" );
+	QScriptValue jobValue = parse.call( QScriptValue(), QScriptValueList() << QScriptValue( line ) );
+	if( parser.hasUncaughtException() || !jobValue.isObject() )
+	{
+		*error = QString( QLatin1String( "The job is not a JSON object: %1" ) ).arg( line );
+		return false;
+	}
+
+	if( jobValue.property( "id" ).isValid() && !jobValue.property( "id" ).isUndefined() )
+		job->id = jobValue.property( "id" ).toString();
+
+	QScriptValue commandValue = jobValue.property( "command" );
+	if( commandValue.isString() )
+	{
+		*command = commandValue.toString();
+		if( *command == QLatin1String( "quit" ) )	return true;
+
+		*error = QString( QLatin1String( "Unknown command %1." ) ).arg( *command );
+		return false;
+	}
+
+	QScriptValue scriptValue = jobValue.property( "script" );
+	if( !scriptValue.isString() )
+	{
+		*error = QLatin1String( "The job does not define a script." );
+		return false;
+	}
+	job->script = scriptValue.toString();
+
+	QScriptValue modelValue = jobValue.property( "model" );
+	if( modelValue.isString() )	job->model = modelValue.toString();
+	return true;
+}
+
+/*!
+ * Sends to the client of the \a job a line with its \a status. If \a field is defined, the line also
+ * has the \a field with the JSON \a value.
+ */
+void TracingServer::SendStatus( const Job& job, QString status, QString field, QString value )
+{
+	if( !job.client )	return;
+
+	QString line = QString( QLatin1String( "{\"id\": %1, \"status\": %2" ) ).arg( JSONString( job.id ), JSONString( status ) );
+	if( !field.isEmpty() )	line.append( QString( QLatin1String( ", %1: %2" ) ).arg( JSONString( field ), value ) );
+	line.append( QLatin1String( "}\n" ) );
+
+	job.client->write( line.toUtf8() );
+	job.client->flush();
+}
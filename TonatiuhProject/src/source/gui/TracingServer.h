@@ -0,0 +1,119 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef TRACINGSERVER_H_
+#define TRACINGSERVER_H_
+
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+
+class PluginManager;
+class QLocalServer;
+class QLocalSocket;
+class QScriptContext;
+class QScriptEngine;
+class QScriptValue;
+
+//!  TracingServer runs ray tracing jobs sent by local clients in a resident Tonatiuh process.
+/*!
+  The server listens on a local socket (a named pipe on Windows). Each line that a client writes is a JSON job:
+
+  {"id": "case1", "model": "/path/model.tnh", "script": "tonatiuh.SetRaysPerIteration( 100000 ); tonatiuh.Run();"}
+
+  The script is evaluated with the same "tonatiuh" object as the .tnhs scripts, so any ray tracing or flux
+  analysis can be run. If "model" is defined, it is opened before the script. The job {"command": "quit"} stops
+  the server.
+
+  The server answers each job with JSON lines with the "id" of the job and its "status": "queued", "running",
+  "output" for each message printed by the script with print(), and "finished" or "failed" with the error message.
+
+  The plugins are loaded once and the scenes of the model files are kept in the SceneCache, so a job only copies the
+  scene of a model already read. The jobs of all the clients are queued and run one after the other, because the
+  scene graph can only be used from the application thread. Each ray tracing uses all the threads of the global
+  thread pool. Every job runs with a new MainWindow, so the settings of a job do not change the next jobs.
+*/
+
+class TracingServer : public QObject
+{
+	Q_OBJECT
+
+public:
+	TracingServer( PluginManager* pluginManager, QObject* parent = 0 );
+	~TracingServer();
+
+	QString GetErrorMessage() const;
+	QString GetServerName() const;
+	bool Listen( QString serverName );
+
+	static QScriptValue PrintMessage( QScriptContext* context, QScriptEngine* engine );
+
+public slots:
+	void AbortJob( QString error );
+
+private slots:
+	void AddConnection();
+	void ReadJobs();
+	void RunNextJob();
+
+private:
+	struct Job
+	{
+		QPointer< QLocalSocket > client;
+		QString id;
+		QString model;
+		QString script;
+	};
+
+	static QString JSONString( const QString& text );
+	bool ParseJob( const QString& line, Job* job, QString* command, QString* error );
+	void SendStatus( const Job& job, QString status, QString field = QString(), QString value = QString() );
+
+	PluginManager* m_pPluginManager;
+	QLocalServer* m_server;
+	QList< Job > m_jobs;
+	bool m_isRunning;
+	bool m_isQuitRequested;
+	Job m_currentJob;
+	QString m_jobError;
+	QScriptEngine* m_interpreter;
+	QString m_errorMessage;
+};
+
+#endif /* TRACINGSERVER_H_ */
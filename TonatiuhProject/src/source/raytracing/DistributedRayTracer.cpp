@@ -0,0 +1,471 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QRegExp>
+#include <QTextStream>
+
+#include "DistributedRayTracer.h"
+
+/*!
+ * Creates a distributed ray tracer that runs \a numberOfProcesses instances of \a executableFileName.
+ * The workers scripts and results are stored in the \a workingDirectory.
+ */
+DistributedRayTracer::DistributedRayTracer( QString executableFileName, QString workingDirectory, int numberOfProcesses )
+:m_executableFileName( executableFileName ),
+ m_workingDirectory( workingDirectory ),
+ m_numberOfProcesses( numberOfProcesses ),
+ m_commonScript( QLatin1String( "" ) ),
+ m_firstSubstream( 0 ),
+ m_modelFileName( QLatin1String( "" ) ),
+ m_errorMessage( QLatin1String( "" ) )
+{
+	if( m_numberOfProcesses < 1 )	m_numberOfProcesses = 1;
+	m_workerRays.fill( 0, m_numberOfProcesses );
+}
+
+DistributedRayTracer::~DistributedRayTracer()
+{
+
+}
+
+/*!
+ * Returns the description of the last error.
+ */
+QString DistributedRayTracer::GetErrorMessage() const
+{
+	return m_errorMessage;
+}
+
+/*!
+ * Returns the number of worker processes.
+ */
+int DistributedRayTracer::GetNumberOfProcesses() const
+{
+	return m_numberOfProcesses;
+}
+
+/*!
+ * Returns the number of rays that traces the worker \a worker.
+ */
+unsigned long DistributedRayTracer::GetWorkerRays( int worker ) const
+{
+	if( worker < 0 || worker >= m_numberOfProcesses )	return 0;
+	return m_workerRays[worker];
+}
+
+/*!
+ * Returns the name used for the files of the worker \a worker.
+ */
+QString DistributedRayTracer::GetWorkerName( int worker ) const
+{
+	return QString( QLatin1String( "worker_%1" ) ).arg( QString::number( worker ) );
+}
+
+/*!
+ * Sets the script lines that all the workers run after opening the model.
+ * These lines define the ray tracing parameters: random generator, sun grid, export settings...
+ */
+void DistributedRayTracer::SetCommonScript( QString script )
+{
+	m_commonScript = script;
+}
+
+/*!
+ * Sets the random substream of the first worker to \a substream. The worker i uses the substream \a substream + i.
+ */
+void DistributedRayTracer::SetFirstSubstream( unsigned long substream )
+{
+	m_firstSubstream = substream;
+}
+
+/*!
+ * Sets the Tonatiuh model file that traces all the workers to \a modelFileName.
+ */
+void DistributedRayTracer::SetModelFileName( QString modelFileName )
+{
+	m_modelFileName = modelFileName;
+}
+
+/*!
+ * Partitions \a numberOfRays between the workers. The first workers trace the remaining rays.
+ */
+void DistributedRayTracer::SetNumberOfRays( unsigned long numberOfRays )
+{
+	unsigned long workerRays = numberOfRays / m_numberOfProcesses;
+	unsigned long remainingRays = numberOfRays - workerRays * m_numberOfProcesses;
+	for( int w = 0; w < m_numberOfProcesses; ++w )
+		m_workerRays[w] = ( (unsigned long) w < remainingRays ) ? workerRays + 1 : workerRays;
+}
+
+/*!
+ * Writes a script for each worker and runs all the workers. In the \a traceCommand script lines,
+ * every %1 is replaced with the worker number of rays and every %2 with the worker name.
+ * Either of them can be omitted.
+ *
+ * Returns true if all the workers finish successfully.
+ */
+bool DistributedRayTracer::RunWorkers( QString traceCommand )
+{
+	QVector< QProcess* > workers;
+	for( int w = 0; w < m_numberOfProcesses; ++w )
+	{
+		QString scriptFileName = WriteWorkerScript( w, traceCommand );
+		if( scriptFileName.isEmpty() )
+		{
+			qDeleteAll( workers );
+			return false;
+		}
+
+		QProcess* worker = new QProcess;
+		worker->setWorkingDirectory( m_workingDirectory );
+		worker->setProcessChannelMode( QProcess::ForwardedChannels );
+		worker->start( m_executableFileName, QStringList() << scriptFileName );
+		workers.push_back( worker );
+	}
+
+	bool finished = true;
+	for( int w = 0; w < workers.size(); ++w )
+	{
+		QProcess* worker = workers[w];
+		if( !worker->waitForFinished( -1 ) || worker->exitStatus() != QProcess::NormalExit || worker->exitCode() != 0 )
+		{
+			m_errorMessage = QString( QLatin1String( "The worker %1 has not finished correctly." ) ).arg( GetWorkerName( w ) );
+			finished = false;
+		}
+	}
+
+	qDeleteAll( workers );
+	return finished;
+}
+
+/*!
+ * Merges the flux distribution files exported by the workers into \a fileName. Each worker flux
+ * is weighted with the rays it traced, so the result is normalized with the total number of rays.
+ */
+bool DistributedRayTracer::MergeFluxFiles( QString fileName )
+{
+	QDir workingDirectory( m_workingDirectory );
+
+	unsigned long totalRays = 0;
+	for( int w = 0; w < m_numberOfProcesses; ++w )
+		totalRays += m_workerRays[w];
+	if( totalRays < 1 )
+	{
+		m_errorMessage = QLatin1String( "There are no rays to merge." );
+		return false;
+	}
+
+	QStringList headerLines;
+	QVector< QVector< double > > mergedValues;
+	bool saveCoords = false;
+	for( int w = 0; w < m_numberOfProcesses; ++w )
+	{
+		QFile workerFile( workingDirectory.absoluteFilePath( GetWorkerName( w ) + QLatin1String( ".txt" ) ) );
+		if( !workerFile.open( QIODevice::ReadOnly ) )
+		{
+			m_errorMessage = QString( QLatin1String( "Cannot open file %1." ) ).arg( workerFile.fileName() );
+			return false;
+		}
+
+		double workerWeight = double( m_workerRays[w] ) / totalRays;
+
+		QTextStream in( &workerFile );
+		int row = 0;
+		while( !in.atEnd() )
+		{
+			QString line = in.readLine();
+			QStringList values = line.split( QRegExp( QLatin1String( "\\s+" ) ), QString::SkipEmptyParts );
+			if( values.count() < 1 )	continue;
+
+			bool isNumber = false;
+			values[0].toDouble( &isNumber );
+			if( !isNumber )
+			{
+				if( w == 0 )	headerLines<<line;
+				saveCoords = true;
+				continue;
+			}
+
+			if( w == 0 )	mergedValues.push_back( QVector< double >( values.count(), 0.0 ) );
+			if( row >= mergedValues.size() || mergedValues[row].size() != values.count() )
+			{
+				m_errorMessage = QString( QLatin1String( "The file %1 has not the expected format." ) ).arg( workerFile.fileName() );
+				return false;
+			}
+
+			for( int c = 0; c < values.count(); ++c )
+			{
+				if( saveCoords && c < values.count() - 1 )	mergedValues[row][c] = values[c].toDouble();
+				else	mergedValues[row][c] += workerWeight * values[c].toDouble();
+			}
+			row++;
+		}
+		workerFile.close();
+	}
+
+	QFileInfo exportFileInfo( fileName );
+	if( exportFileInfo.completeSuffix().compare( QLatin1String( "txt" ) ) )	fileName.append( QLatin1String( ".txt" ) );
+
+	QFile exportFile( workingDirectory.absoluteFilePath( fileName ) );
+	if( !exportFile.open( QIODevice::WriteOnly ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot open file %1." ) ).arg( exportFile.fileName() );
+		return false;
+	}
+
+	QTextStream out( &exportFile );
+	for( int h = 0; h < headerLines.count(); ++h )
+		out<<headerLines[h]<<"\n";
+
+	for( int r = 0; r < mergedValues.size(); ++r )
+	{
+		for( int c = 0; c < mergedValues[r].size(); ++c )
+		{
+			out<<mergedValues[r][c];
+			if( !saveCoords || c < mergedValues[r].size() - 1 )	out<<"\t";
+		}
+		out<<"\n";
+	}
+	exportFile.close();
+
+	return true;
+}
+
+/*!
+ * Merges the photon map files exported by the workers into \a fileName. The photons identifiers
+ * are renumbered consecutively, the surfaces identifiers are mapped to a common surfaces list and
+ * the power per photon is normalized with the total number of rays.
+ */
+bool DistributedRayTracer::MergePhotonMapFiles( QString fileName )
+{
+	QDir workingDirectory( m_workingDirectory );
+
+	unsigned long totalRays = 0;
+	for( int w = 0; w < m_numberOfProcesses; ++w )
+		totalRays += m_workerRays[w];
+	if( totalRays < 1 )
+	{
+		m_errorMessage = QLatin1String( "There are no rays to merge." );
+		return false;
+	}
+
+	QFile mergedFile( workingDirectory.absoluteFilePath( fileName + QLatin1String( ".dat" ) ) );
+	if( !mergedFile.open( QIODevice::WriteOnly ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot open file %1." ) ).arg( mergedFile.fileName() );
+		return false;
+	}
+	QDataStream out( &mergedFile );
+
+	QStringList parameters;
+	QStringList surfacesURL;
+	double sunPower = 0.0;
+	int nSunPowerValues = 0;
+	double exportedPhotons = 0.0;
+	for( int w = 0; w < m_numberOfProcesses; ++w )
+	{
+		QString workerName = GetWorkerName( w );
+
+		QStringList workerParameters;
+		QStringList workerSurfacesURL;
+		double workerWPhoton = 0.0;
+		QString parametersFileName = workingDirectory.absoluteFilePath( workerName + QLatin1String( "_parameters.txt" ) );
+		if( !ReadPhotonMapParameters( parametersFileName, &workerParameters, &workerSurfacesURL, &workerWPhoton ) )
+			return false;
+
+		if( w == 0 )	parameters = workerParameters;
+		else if( parameters != workerParameters )
+		{
+			m_errorMessage = QString( QLatin1String( "The worker %1 has exported different photon parameters." ) ).arg( workerName );
+			return false;
+		}
+
+		if( workerWPhoton > 0.0 )
+		{
+			sunPower += workerWPhoton * m_workerRays[w];
+			nSunPowerValues++;
+		}
+
+		QVector< double > surfaceID( workerSurfacesURL.count() + 1, 0.0 );
+		for( int s = 0; s < workerSurfacesURL.count(); ++s )
+		{
+			int surfaceIndex = surfacesURL.indexOf( workerSurfacesURL[s] );
+			if( surfaceIndex < 0 )
+			{
+				surfacesURL<<workerSurfacesURL[s];
+				surfaceIndex = surfacesURL.count() - 1;
+			}
+			surfaceID[s + 1] = surfaceIndex + 1;
+		}
+
+		int idIndex = parameters.indexOf( QLatin1String( "id" ) );
+		int previousIDIndex = parameters.indexOf( QLatin1String( "previous ID" ) );
+		int nextIDIndex = parameters.indexOf( QLatin1String( "next ID" ) );
+		int surfaceIDIndex = parameters.indexOf( QLatin1String( "surface ID" ) );
+
+		//A worker without rays has not photons to export
+		QFile workerFile( workingDirectory.absoluteFilePath( workerName + QLatin1String( ".dat" ) ) );
+		if( m_workerRays[w] < 1 && !workerFile.exists() )	continue;
+		if( !workerFile.open( QIODevice::ReadOnly ) )
+		{
+			m_errorMessage = QString( QLatin1String( "Cannot open file %1." ) ).arg( workerFile.fileName() );
+			return false;
+		}
+		QDataStream in( &workerFile );
+
+		int nParameters = parameters.count();
+		QVector< double > photon( nParameters, 0.0 );
+		double workerPhotons = 0.0;
+		while( !in.atEnd() )
+		{
+			for( int p = 0; p < nParameters; ++p )
+				in>>photon[p];
+
+			if( idIndex > -1 )	photon[idIndex] += exportedPhotons;
+			if( previousIDIndex > -1 && photon[previousIDIndex] > 0.0 )	photon[previousIDIndex] += exportedPhotons;
+			if( nextIDIndex > -1 && photon[nextIDIndex] > 0.0 )	photon[nextIDIndex] += exportedPhotons;
+			if( surfaceIDIndex > -1 )
+			{
+				int workerSurfaceID = int( photon[surfaceIDIndex] );
+				photon[surfaceIDIndex] = ( workerSurfaceID > 0 && workerSurfaceID < surfaceID.size() ) ? surfaceID[workerSurfaceID] : 0.0;
+			}
+
+			for( int p = 0; p < nParameters; ++p )
+				out<<photon[p];
+			workerPhotons++;
+		}
+		workerFile.close();
+
+		exportedPhotons += workerPhotons;
+	}
+	mergedFile.close();
+
+	double wPhoton = ( nSunPowerValues > 0 ) ? ( sunPower / nSunPowerValues ) / totalRays : 0.0;
+
+	QFile parametersFile( workingDirectory.absoluteFilePath( fileName + QLatin1String( "_parameters.txt" ) ) );
+	if( !parametersFile.open( QIODevice::WriteOnly ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot open file %1." ) ).arg( parametersFile.fileName() );
+		return false;
+	}
+
+	QTextStream parametersOut( &parametersFile );
+	parametersOut<<QLatin1String( "START PARAMETERS\n" );
+	for( int p = 0; p < parameters.count(); ++p )
+		parametersOut<<parameters[p]<<"\n";
+	parametersOut<<QLatin1String( "END PARAMETERS\n" );
+	parametersOut<<QLatin1String( "START SURFACES\n" );
+	for( int s = 0; s < surfacesURL.count(); ++s )
+		parametersOut<<QString( QLatin1String( "%1 %2\n" ) ).arg( QString::number( s + 1 ), surfacesURL[s] );
+	parametersOut<<QLatin1String( "END SURFACES\n" );
+	parametersOut<<wPhoton;
+	parametersFile.close();
+
+	return true;
+}
+
+/*!
+ * Reads the exported parameters names, the surfaces URL list and the power per photon from the \a parametersFileName file.
+ */
+bool DistributedRayTracer::ReadPhotonMapParameters( QString parametersFileName, QStringList* parameters, QStringList* surfacesURL, double* wPhoton )
+{
+	QFile parametersFile( parametersFileName );
+	if( !parametersFile.open( QIODevice::ReadOnly ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot open file %1." ) ).arg( parametersFileName );
+		return false;
+	}
+
+	QTextStream in( &parametersFile );
+	int section = 0;
+	while( !in.atEnd() )
+	{
+		QString line = in.readLine().trimmed();
+		if( line.isEmpty() )	continue;
+
+		if( line == QLatin1String( "START PARAMETERS" ) )	section = 1;
+		else if( line == QLatin1String( "END PARAMETERS" ) )	section = 0;
+		else if( line == QLatin1String( "START SURFACES" ) )	section = 2;
+		else if( line == QLatin1String( "END SURFACES" ) )	section = 3;
+		else if( section == 1 )	parameters->push_back( line );
+		else if( section == 2 )	surfacesURL->push_back( line.section( QLatin1Char( ' ' ), 1 ) );
+		else if( section == 3 )	*wPhoton = line.toDouble();
+	}
+	parametersFile.close();
+
+	if( parameters->count() < 1 )
+	{
+		m_errorMessage = QString( QLatin1String( "The file %1 has not the expected format." ) ).arg( parametersFileName );
+		return false;
+	}
+	return true;
+}
+
+/*!
+ * Writes the script file for the worker \a worker and returns its name. Returns an empty string if the file can not be written.
+ */
+QString DistributedRayTracer::WriteWorkerScript( int worker, QString traceCommand )
+{
+	QDir workingDirectory( m_workingDirectory );
+	QString scriptFileName = workingDirectory.absoluteFilePath( GetWorkerName( worker ) + QLatin1String( ".tnhs" ) );
+
+	QFile scriptFile( scriptFileName );
+	if( !scriptFile.open( QIODevice::WriteOnly ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot open file %1." ) ).arg( scriptFileName );
+		return QLatin1String( "" );
+	}
+
+	QTextStream out( &scriptFile );
+	out<<QString( QLatin1String( "tonatiuh.Open( \"%1\" );\n" ) ).arg( m_modelFileName );
+	out<<m_commonScript;
+	out<<QString( QLatin1String( "tonatiuh.SetRandomDeviateSubstream( %1 );\n" ) ).arg( QString::number( m_firstSubstream + worker ) );
+	out<<QString( QLatin1String( "tonatiuh.SetRaysPerIteration( %1 );\n" ) ).arg( QString::number( m_workerRays[worker] ) );
+	QString workerCommand = traceCommand;
+	workerCommand.replace( QLatin1String( "%1" ), QString::number( m_workerRays[worker] ) );
+	workerCommand.replace( QLatin1String( "%2" ), GetWorkerName( worker ) );
+	out<<workerCommand;
+	scriptFile.close();
+
+	return scriptFileName;
+}
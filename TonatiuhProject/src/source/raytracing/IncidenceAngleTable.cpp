@@ -0,0 +1,115 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "IncidenceAngleTable.h"
+
+const int IncidenceAngleTable::m_minimumTableSize = 4096;
+const int IncidenceAngleTable::m_maximumTableSize = 65536;
+
+IncidenceAngleTable::IncidenceAngleTable()
+:m_tableSize( 0 )
+{
+
+}
+
+IncidenceAngleTable::~IncidenceAngleTable()
+{
+
+}
+
+/*!
+ * Removes the table values.
+ */
+void IncidenceAngleTable::Clear()
+{
+	m_tableSize = 0;
+	m_values.clear();
+}
+
+/*!
+ * Returns true if no valid values have been defined.
+ */
+bool IncidenceAngleTable::IsEmpty() const
+{
+	return m_values.empty();
+}
+
+/*!
+ * Builds the table for the property \a value at the \a incidenceAngle angles, in radians.
+ * The angles are sorted, so they can be defined in any order. For incidence angles smaller than
+ * the first angle, the property is the first value. For angles larger than the last angle, it is zero.
+ *
+ * Returns false and clears the table if there are less than two values or the lists sizes are different.
+ */
+bool IncidenceAngleTable::SetValues( const std::vector< double >& incidenceAngle, const std::vector< double >& value )
+{
+	Clear();
+	if( ( incidenceAngle.size() < 2 ) || ( incidenceAngle.size() != value.size() ) ) return false;
+
+	std::vector< std::pair< double, double > > points;
+	for( unsigned int j = 0; j < incidenceAngle.size(); ++j )
+		points.push_back( std::make_pair( incidenceAngle[j], value[j] ) );
+	std::stable_sort( points.begin(), points.end() );
+
+	// Large tables are sampled with more cosines to keep their resolution
+	m_tableSize = std::min( std::max( 8 * int( points.size() ), m_minimumTableSize ), m_maximumTableSize );
+	m_values.resize( m_tableSize + 1 );
+
+	// The angle increases when the cosine decreases
+	unsigned int j = 1;
+	for( int i = m_tableSize; i >= 0; --i )
+	{
+		double angle = acos( double( i ) / m_tableSize );
+		if( angle <= points[0].first )	m_values[i] = points[0].second;
+		else if( angle > points.back().first )	m_values[i] = 0.0;
+		else
+		{
+			while( points[j].first < angle ) j++;
+
+			double step = points[j].first - points[j-1].first;
+			double w = ( step > 0.0 ) ? ( angle - points[j-1].first ) / step : 1.0;
+			m_values[i] = points[j-1].second + w * ( points[j].second - points[j-1].second );
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,93 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef INCIDENCEANGLETABLE_H_
+#define INCIDENCEANGLETABLE_H_
+
+#include <vector>
+
+//!  IncidenceAngleTable evaluates an optical property tabulated against the incidence angle.
+/*!
+  The tabulated values are interpolated linearly in the incidence angle. When the values are defined,
+  the property is resampled at equally spaced cosines of the incidence angle, so each evaluation
+  is one table lookup and a linear interpolation, without inverse trigonometric functions and
+  independent of the number of tabulated angles.
+
+  Between two resampled cosines the property varies linearly with the cosine, not with the angle.
+  The cells are not uniform in angle: with the minimum table size of 4096 cells, the cell at normal
+  incidence spans about 1.3 degrees and the cells near grazing incidence span about 0.014 degrees.
+  A property that changes sharply within a degree of normal incidence is smoothed over that first cell.
+*/
+
+class IncidenceAngleTable
+{
+
+public:
+	IncidenceAngleTable();
+	~IncidenceAngleTable();
+
+	void Clear();
+	bool IsEmpty() const;
+	bool SetValues( const std::vector< double >& incidenceAngle, const std::vector< double >& value );
+	double Value( double cosIncidence ) const;
+
+private:
+	static const int m_minimumTableSize;
+	static const int m_maximumTableSize;
+
+	int m_tableSize;
+	std::vector< double > m_values;
+};
+
+/*!
+ * Returns the property value for the incidence angle with cosine \a cosIncidence.
+ * The cosine is clamped to the [0, 1] range. If the table is empty, returns zero.
+ */
+inline double IncidenceAngleTable::Value( double cosIncidence ) const
+{
+	if( m_values.empty() ) return 0.0;
+	if( cosIncidence < 0.0 ) cosIncidence = 0.0;
+
+	double position = cosIncidence * m_tableSize;
+	int index = int( position );
+	if( index >= m_tableSize ) index = m_tableSize - 1;
+
+	return m_values[index] + ( position - index ) * ( m_values[index+1] - m_values[index] );
+}
+
+#endif /* INCIDENCEANGLETABLE_H_ */
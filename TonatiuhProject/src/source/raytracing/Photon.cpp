@@ -39,19 +39,19 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "Photon.h"
 
 Photon::Photon( )
-:id( -1 ), pos( Point3D()), side(-1 ), intersectedSurface(0 ), isAbsorbed( -1 )
+:id( -1 ), pos( Point3D()), side(-1 ), intersectedSurface(0 ), isAbsorbed( -1 ), u( 0.0 ), v( 0.0 )
 {
 
 }
 
 Photon::Photon( const Photon& photon )
-:id( photon.id ), pos( photon.pos ), side( photon.side ), intersectedSurface( photon.intersectedSurface ), isAbsorbed( photon.isAbsorbed )
+:id( photon.id ), pos( photon.pos ), side( photon.side ), intersectedSurface( photon.intersectedSurface ), isAbsorbed( photon.isAbsorbed ), u( photon.u ), v( photon.v )
 {
 
 }
 
-Photon::Photon( Point3D pos, int side, double id, InstanceNode* intersectedSurface, int absorbedPhoton  )
-:id(id), pos(pos), side( side ), intersectedSurface( intersectedSurface ), isAbsorbed( absorbedPhoton)
+Photon::Photon( Point3D pos, int side, double id, InstanceNode* intersectedSurface, int absorbedPhoton, double u, double v )
+:id(id), pos(pos), side( side ), intersectedSurface( intersectedSurface ), isAbsorbed( absorbedPhoton), u( u ), v( v )
 {
 
 }
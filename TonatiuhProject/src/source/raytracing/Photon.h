@@ -46,7 +46,7 @@ struct Photon
 {
 	Photon( );
 	Photon( const Photon& photon );
-	Photon( Point3D pos, int side, double id = 0, InstanceNode* intersectedSurface = 0, int absorbedPhoton = 0 );
+	Photon( Point3D pos, int side, double id = 0, InstanceNode* intersectedSurface = 0, int absorbedPhoton = 0, double u = 0.0, double v = 0.0 );
 	~Photon();
 
 	double id;
@@ -54,6 +54,8 @@ struct Photon
 	int side;
 	InstanceNode* intersectedSurface;
 	int isAbsorbed;
+	double u;
+	double v;
 };
 
 #endif /*PHOTON_H_*/
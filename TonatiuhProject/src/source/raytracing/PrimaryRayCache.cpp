@@ -0,0 +1,431 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QMutexLocker>
+
+#include "gc.h"
+
+#include "InstanceNode.h"
+#include "PrimaryRayCache.h"
+#include "TLightKit.h"
+#include "TMaterial.h"
+#include "TShape.h"
+#include "TShapeKit.h"
+#include "TSunShape.h"
+
+namespace
+{
+	//The raw data sizes of QDataStream are int, so the records are written and read in blocks.
+	const qint64 RawDataBlockSize = 64 * 1024 * 1024;
+
+	/*!
+	 * Writes the \a size bytes of \a data to \a out. Returns false if any block cannot be written.
+	 */
+	bool WriteRawData( QDataStream& out, const char* data, qint64 size )
+	{
+		for( qint64 written = 0; written < size; )
+		{
+			int blockSize = int( qMin( RawDataBlockSize, size - written ) );
+			if( out.writeRawData( data + written, blockSize ) != blockSize )	return false;
+			written += blockSize;
+		}
+		return true;
+	}
+
+	/*!
+	 * Reads \a size bytes from \a in to \a data. Returns false if the stream ends before.
+	 */
+	bool ReadRawData( QDataStream& in, char* data, qint64 size )
+	{
+		for( qint64 read = 0; read < size; )
+		{
+			int blockSize = int( qMin( RawDataBlockSize, size - read ) );
+			if( in.readRawData( data + read, blockSize ) != blockSize )	return false;
+			read += blockSize;
+		}
+		return true;
+	}
+}
+
+PrimaryRay::PrimaryRay()
+:intersectedSurface( 0 ),
+ isFront( false ),
+ u( 0.0 ),
+ v( 0.0 ),
+ isReflectedRay( false )
+{
+
+}
+
+/*!
+ * Creates a cache for \a numberOfRays primary rays of the scene with key \a sceneKey, stored in the file \a fileName.
+ *
+ * The cache records the primary rays until it is read from a valid file.
+ */
+PrimaryRayCache::PrimaryRayCache( QString fileName, QByteArray sceneKey, unsigned long numberOfRays )
+:m_fileName( fileName ),
+ m_sceneKey( sceneKey ),
+ m_numberOfRays( numberOfRays ),
+ m_isRecording( true ),
+ m_errorMessage( QLatin1String( "" ) ),
+ m_nextRay( 0 )
+{
+
+}
+
+PrimaryRayCache::~PrimaryRayCache()
+{
+
+}
+
+/*!
+ * Returns the key of the scene under \a rootNode for the primary rays. The key changes with the geometry and the
+ * transformations of the surfaces, the light transformation \a lightToWorld, the sunshape and disabled nodes of the
+ * \a lightNode, the light \a widthDivisions and \a heightDivisions, and the \a randomGenerator with its \a randomSeed
+ * and \a randomSubstream.
+ *
+ * The world to object transforms of the scene must be computed before.
+ */
+QByteArray PrimaryRayCache::SceneKey( InstanceNode* rootNode, Transform lightToWorld, InstanceNode* lightNode,
+		int widthDivisions, int heightDivisions,
+		QString randomGenerator, long randomSeed, long randomSubstream )
+{
+	QCryptographicHash hash( QCryptographicHash::Md5 );
+	AddNodeKey( rootNode, &hash );
+
+	hash.addData( reinterpret_cast< const char* >( lightToWorld.GetMatrix()->m ), 16 * sizeof( double ) );
+	TLightKit* lightKit = static_cast< TLightKit* >( lightNode->GetNode() );
+	hash.addData( lightKit->disabledNodes.getValue().getString() );
+	SoNode* sunShape = lightKit->getPart( "tsunshape", false );
+	if( sunShape )	hash.addData( FieldsKey( sunShape ) );
+
+	hash.addData( QString( QLatin1String( "%1 %2 %3 %4 %5" ) ).arg( QString::number( widthDivisions ),
+			QString::number( heightDivisions ), randomGenerator,
+			QString::number( randomSeed ), QString::number( randomSubstream ) ).toUtf8() );
+	return hash.result();
+}
+
+/*!
+ * Returns the key of the materials of all the surfaces under \a rootNode.
+ */
+QByteArray PrimaryRayCache::MaterialsKey( InstanceNode* rootNode )
+{
+	QMap< QString, InstanceNode* > surfaceNodes;
+	SurfaceNodes( rootNode, &surfaceNodes );
+
+	QCryptographicHash hash( QCryptographicHash::Md5 );
+	QMap< QString, InstanceNode* >::const_iterator surface = surfaceNodes.constBegin();
+	for( ; surface != surfaceNodes.constEnd(); ++surface )
+	{
+		//The surfaces with the same url are not identified
+		hash.addData( surface.key().toUtf8() );
+		if( surface.value() )	hash.addData( MaterialKey( surface.value() ) );
+	}
+	return hash.result();
+}
+
+/*!
+ * Returns the description of the last error.
+ */
+QString PrimaryRayCache::GetErrorMessage() const
+{
+	return m_errorMessage;
+}
+
+/*!
+ * Returns true if the primary rays are being recorded. Otherwise, the primary rays have been read from the cache file.
+ */
+bool PrimaryRayCache::IsRecording() const
+{
+	return m_isRecording;
+}
+
+/*!
+ * Reads the primary rays of the cache file for the surfaces under \a rootNode.
+ *
+ * Returns false if the file does not exist or it was stored for another scene, number of rays or
+ * first stage materials. Then, the cache keeps recording the primary rays.
+ */
+bool PrimaryRayCache::Read( InstanceNode* rootNode )
+{
+	QFile cacheFile( m_fileName );
+	if( !cacheFile.exists() )	return false;
+	if( !cacheFile.open( QIODevice::ReadOnly ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot open file %1." ) ).arg( m_fileName );
+		return false;
+	}
+	QDataStream in( &cacheFile );
+
+	QString fileType;
+	qint32 version = 0;
+	QByteArray sceneKey;
+	quint64 numberOfRays = 0;
+	qint32 recordSize = 0;
+	in>>fileType>>version>>sceneKey>>numberOfRays>>recordSize;
+	if( fileType != QLatin1String( "TonatiuhPrimaryRays" ) || version != 1 || recordSize != sizeof( PrimaryRayRecord ) )
+	{
+		m_errorMessage = QString( QLatin1String( "The file %1 is not a valid primary rays file." ) ).arg( m_fileName );
+		return false;
+	}
+	if( sceneKey != m_sceneKey || numberOfRays != m_numberOfRays )	return false;
+
+	QMap< QString, InstanceNode* > surfaceNodes;
+	SurfaceNodes( rootNode, &surfaceNodes );
+
+	qint32 nSurfaces = 0;
+	in>>nSurfaces;
+	QVector< InstanceNode* > surfaces( nSurfaces, 0 );
+	for( int s = 0; s < nSurfaces; ++s )
+	{
+		QString surfaceURL;
+		QByteArray materialKey;
+		in>>surfaceURL>>materialKey;
+
+		surfaces[s] = surfaceNodes.value( surfaceURL, 0 );
+		if( !surfaces[s] || MaterialKey( surfaces[s] ) != materialKey )	return false;
+	}
+
+	quint64 nRecords = 0;
+	in>>nRecords;
+	if( in.status() != QDataStream::Ok || nRecords > numberOfRays )
+	{
+		m_errorMessage = QString( QLatin1String( "The file %1 is not a valid primary rays file." ) ).arg( m_fileName );
+		return false;
+	}
+
+	std::vector< PrimaryRayRecord > records( nRecords );
+	if( nRecords > 0 && !ReadRawData( in, reinterpret_cast< char* >( &records[0] ), qint64( nRecords * sizeof( PrimaryRayRecord ) ) ) )
+	{
+		m_errorMessage = QString( QLatin1String( "The file %1 is not a valid primary rays file." ) ).arg( m_fileName );
+		return false;
+	}
+
+	for( int s = 0; s < nSurfaces; ++s )
+		m_surfaceIndex.insert( surfaces[s], s );
+	m_surfaces = surfaces;
+	m_records.swap( records );
+	m_nextRay = 0;
+	m_isRecording = false;
+	return true;
+}
+
+/*!
+ * Writes the recorded primary rays to the cache file. Returns false if the file cannot be written.
+ */
+bool PrimaryRayCache::Write()
+{
+	if( !m_isRecording )	return true;
+
+	QFile cacheFile( m_fileName );
+	if( !cacheFile.open( QIODevice::WriteOnly ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot open file %1." ) ).arg( m_fileName );
+		return false;
+	}
+	QDataStream out( &cacheFile );
+
+	out<<QString( QLatin1String( "TonatiuhPrimaryRays" ) )<<qint32( 1 )<<m_sceneKey
+		<<quint64( m_numberOfRays )<<qint32( sizeof( PrimaryRayRecord ) );
+
+	out<<qint32( m_surfaces.count() );
+	for( int s = 0; s < m_surfaces.count(); ++s )
+		out<<m_surfaces[s]->GetNodeURL()<<MaterialKey( m_surfaces[s] );
+
+	out<<quint64( m_records.size() );
+	bool isWritten = ( m_records.size() < 1 ) ||
+			WriteRawData( out, reinterpret_cast< const char* >( &m_records[0] ), qint64( m_records.size() * sizeof( PrimaryRayRecord ) ) );
+
+	if( !isWritten || out.status() != QDataStream::Ok )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot write file %1." ) ).arg( m_fileName );
+		return false;
+	}
+	return true;
+}
+
+/*!
+ * Sets to \a primaryRay the cached primary ray \a index.
+ */
+void PrimaryRayCache::GetPrimaryRay( unsigned long index, PrimaryRay* primaryRay ) const
+{
+	const PrimaryRayRecord& record = m_records[index];
+
+	primaryRay->ray = Ray( Point3D( record.origin[0], record.origin[1], record.origin[2] ),
+			Vector3D( record.direction[0], record.direction[1], record.direction[2] ) );
+	primaryRay->ray.maxt = record.thit;
+	primaryRay->intersectedSurface = ( record.surface > -1 ) ? m_surfaces[record.surface] : 0;
+	primaryRay->isFront = ( record.flags & 1 );
+	primaryRay->u = record.u;
+	primaryRay->v = record.v;
+	primaryRay->isReflectedRay = ( record.flags & 2 );
+	if( primaryRay->isReflectedRay )
+		primaryRay->reflectedRay = Ray( primaryRay->ray( record.thit ),
+				Normalize( Vector3D( record.reflectedDirection[0], record.reflectedDirection[1], record.reflectedDirection[2] ) ) );
+}
+
+/*!
+ * Reserves up to \a numberOfRays cached primary rays for a tracing thread and sets to \a firstRay the index of the first one.
+ * Returns the number of reserved rays.
+ */
+unsigned long PrimaryRayCache::ReserveRays( unsigned long numberOfRays, unsigned long* firstRay )
+{
+	QMutexLocker locker( &m_mutex );
+
+	unsigned long availableRays = m_records.size() - m_nextRay;
+	if( numberOfRays > availableRays )	numberOfRays = availableRays;
+
+	*firstRay = m_nextRay;
+	m_nextRay += numberOfRays;
+	return numberOfRays;
+}
+
+/*!
+ * Records the \a primaryRays traced by a thread.
+ */
+void PrimaryRayCache::StorePrimaryRays( const std::vector< PrimaryRay >& primaryRays )
+{
+	QMutexLocker locker( &m_mutex );
+
+	m_records.reserve( m_records.size() + primaryRays.size() );
+	for( unsigned int r = 0; r < primaryRays.size(); ++r )
+	{
+		const PrimaryRay& primaryRay = primaryRays[r];
+
+		PrimaryRayRecord record;
+		record.origin[0] = primaryRay.ray.origin.x;
+		record.origin[1] = primaryRay.ray.origin.y;
+		record.origin[2] = primaryRay.ray.origin.z;
+		record.direction[0] = primaryRay.ray.direction().x;
+		record.direction[1] = primaryRay.ray.direction().y;
+		record.direction[2] = primaryRay.ray.direction().z;
+		record.thit = primaryRay.ray.maxt;
+		record.reflectedDirection[0] = float( primaryRay.reflectedRay.direction().x );
+		record.reflectedDirection[1] = float( primaryRay.reflectedRay.direction().y );
+		record.reflectedDirection[2] = float( primaryRay.reflectedRay.direction().z );
+		record.u = float( primaryRay.u );
+		record.v = float( primaryRay.v );
+		record.flags = ( primaryRay.isFront ? 1 : 0 ) | ( primaryRay.isReflectedRay ? 2 : 0 );
+
+		record.surface = -1;
+		if( primaryRay.intersectedSurface )
+		{
+			if( !m_surfaceIndex.contains( primaryRay.intersectedSurface ) )
+			{
+				m_surfaceIndex.insert( primaryRay.intersectedSurface, m_surfaces.count() );
+				m_surfaces.push_back( primaryRay.intersectedSurface );
+			}
+			record.surface = m_surfaceIndex.value( primaryRay.intersectedSurface );
+		}
+
+		m_records.push_back( record );
+	}
+}
+
+/*!
+ * Adds to \a hash the URL of \a instanceNode and, for surfaces, their shape and world to object transform.
+ * Other nodes add their children.
+ */
+void PrimaryRayCache::AddNodeKey( InstanceNode* instanceNode, QCryptographicHash* hash )
+{
+	hash->addData( instanceNode->GetNodeURL().toUtf8() );
+
+	if( instanceNode->GetNode()->getTypeId().isDerivedFrom( TShapeKit::getClassTypeId() ) )
+	{
+		Transform worldToObject = instanceNode->GetIntersectionTransform();
+		hash->addData( reinterpret_cast< const char* >( worldToObject.GetMatrix()->m ), 16 * sizeof( double ) );
+
+		for( int c = 0; c < instanceNode->children.count(); ++c )
+		{
+			SoNode* childNode = instanceNode->children[c]->GetNode();
+			if( childNode->getTypeId().isDerivedFrom( TShape::getClassTypeId() ) )
+				hash->addData( FieldsKey( childNode ) );
+		}
+		return;
+	}
+
+	for( int c = 0; c < instanceNode->children.count(); ++c )
+		AddNodeKey( instanceNode->children[c], hash );
+}
+
+/*!
+ * Returns the type name and the field values of \a node.
+ */
+QByteArray PrimaryRayCache::FieldsKey( SoNode* node )
+{
+	QByteArray key( node->getTypeId().getName().getString() );
+
+	SbString fields;
+	node->get( fields );
+	key.append( fields.getString() );
+	return key;
+}
+
+/*!
+ * Returns the key of the material of the \a surfaceNode. The key is empty if the surface has no material.
+ */
+QByteArray PrimaryRayCache::MaterialKey( InstanceNode* surfaceNode )
+{
+	for( int c = 0; c < surfaceNode->children.count(); ++c )
+	{
+		SoNode* childNode = surfaceNode->children[c]->GetNode();
+		if( childNode->getTypeId().isDerivedFrom( TMaterial::getClassTypeId() ) )
+			return QCryptographicHash::hash( FieldsKey( childNode ), QCryptographicHash::Md5 );
+	}
+	return QByteArray();
+}
+
+/*!
+ * Adds to \a surfaceNodes the surfaces under \a instanceNode with their URLs. The surfaces with the same URL
+ * are added as null nodes, because the cached rays cannot be assigned to them.
+ */
+void PrimaryRayCache::SurfaceNodes( InstanceNode* instanceNode, QMap< QString, InstanceNode* >* surfaceNodes )
+{
+	if( instanceNode->GetNode()->getTypeId().isDerivedFrom( TShapeKit::getClassTypeId() ) )
+	{
+		QString surfaceURL = instanceNode->GetNodeURL();
+		surfaceNodes->insert( surfaceURL, surfaceNodes->contains( surfaceURL ) ? 0 : instanceNode );
+		return;
+	}
+
+	for( int c = 0; c < instanceNode->children.count(); ++c )
+		SurfaceNodes( instanceNode->children[c], surfaceNodes );
+}
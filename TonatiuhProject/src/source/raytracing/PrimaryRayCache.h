@@ -0,0 +1,141 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef PRIMARYRAYCACHE_H_
+#define PRIMARYRAYCACHE_H_
+
+#include <vector>
+
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include "Ray.h"
+#include "Transform.h"
+
+class InstanceNode;
+class QCryptographicHash;
+class SoNode;
+
+//!  PrimaryRay is the first stage of a traced ray.
+/*!
+  The ray is generated at the light and its maxt is the distance to the first intersected surface.
+  If the ray does not intersect any surface, the intersected surface is null and maxt is infinite.
+*/
+
+struct PrimaryRay
+{
+	PrimaryRay();
+
+	Ray ray;
+	InstanceNode* intersectedSurface;
+	bool isFront;
+	double u;
+	double v;
+	bool isReflectedRay;
+	Ray reflectedRay;
+};
+
+//!  PrimaryRayCache stores the first stage of the rays of a ray tracing in a binary file.
+/*!
+  When the same field is traced several times, changing only the materials of the receivers or
+  the export settings, the light rays and their intersections with the first stage surfaces do not change.
+  The cache records these primary rays the first time and the following ray tracings start from the
+  rays reflected by the first stage, without generating the rays at the light and intersecting them.
+
+  The cache file is valid for the scene key computed with SceneKey, that depends on the geometry of the scene,
+  the light and the random generator, and for the given number of rays. The material of each surface
+  intersected by the primary rays is also stored, so the cache is discarded if any of them changes.
+*/
+
+class PrimaryRayCache
+{
+
+public:
+	PrimaryRayCache( QString fileName, QByteArray sceneKey, unsigned long numberOfRays );
+	~PrimaryRayCache();
+
+	static QByteArray SceneKey( InstanceNode* rootNode, Transform lightToWorld, InstanceNode* lightNode,
+			int widthDivisions, int heightDivisions,
+			QString randomGenerator, long randomSeed, long randomSubstream );
+	static QByteArray MaterialsKey( InstanceNode* rootNode );
+
+	QString GetErrorMessage() const;
+	bool IsRecording() const;
+
+	bool Read( InstanceNode* rootNode );
+	bool Write();
+
+	void GetPrimaryRay( unsigned long index, PrimaryRay* primaryRay ) const;
+	unsigned long ReserveRays( unsigned long numberOfRays, unsigned long* firstRay );
+	void StorePrimaryRays( const std::vector< PrimaryRay >& primaryRays );
+
+private:
+	struct PrimaryRayRecord
+	{
+		double origin[3];
+		double direction[3];
+		double thit;
+		float reflectedDirection[3];
+		float u;
+		float v;
+		int surface;
+		int flags;
+	};
+
+	static void AddNodeKey( InstanceNode* instanceNode, QCryptographicHash* hash );
+	static QByteArray FieldsKey( SoNode* node );
+	static QByteArray MaterialKey( InstanceNode* surfaceNode );
+	static void SurfaceNodes( InstanceNode* instanceNode, QMap< QString, InstanceNode* >* surfaceNodes );
+
+	QString m_fileName;
+	QByteArray m_sceneKey;
+	unsigned long m_numberOfRays;
+	bool m_isRecording;
+	QString m_errorMessage;
+
+	QMutex m_mutex;
+	unsigned long m_nextRay;
+	QVector< InstanceNode* > m_surfaces;
+	QMap< InstanceNode*, int > m_surfaceIndex;
+	std::vector< PrimaryRayRecord > m_records;
+};
+
+#endif /* PRIMARYRAYCACHE_H_ */
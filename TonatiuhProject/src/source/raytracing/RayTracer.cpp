@@ -39,14 +39,88 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include <QPoint>
 
 #include "DifferentialGeometry.h"
+#include "InstanceNode.h"
 #include "ParallelRandomDeviate.h"
+#include "PrimaryRayCache.h"
 #include "Ray.h"
 #include "RayTracer.h"
+#include "RayTracingProfiler.h"
 #include "TPhotonMap.h"
 #include "TLightShape.h"
 #include "TSunShape.h"
 #include "TTransmissivity.h"
 
+namespace
+{
+	/*!
+	 * Transmissivity policy of the traces with a transmissivity defined.
+	 */
+	struct WithTransmissivity
+	{
+		static bool IsAbsorbed( const TTransmissivity* transmissivity, double distance, RandomDeviate& rand )
+		{
+			ProfilerTimer profilerTimer( RayTracingProfiler::Transmissivity );
+			return ( !transmissivity->IsTransmitted( distance, rand ) );
+		}
+	};
+
+	/*!
+	 * Transmissivity policy of the traces without transmissivity. The rays are never absorbed between surfaces.
+	 */
+	struct WithoutTransmissivity
+	{
+		static bool IsAbsorbed( const TTransmissivity*, double, RandomDeviate& )
+		{
+			return ( false );
+		}
+	};
+
+	/*!
+	 * Photon policy to store the photons of all the surfaces and the light.
+	 */
+	struct AllPhotons
+	{
+		enum { StoresLightPhotons = true };
+		static bool IsStored( const InstanceNode* )	{ return ( true ); }
+	};
+
+	/*!
+	 * Photon policy to store the photons of the light and the exported surfaces.
+	 */
+	struct LightAndExportedPhotons
+	{
+		enum { StoresLightPhotons = true };
+		static bool IsStored( const InstanceNode* surface )	{ return ( surface && surface->IsExported() ); }
+	};
+
+	/*!
+	 * Photon policy to store only the photons of the exported surfaces.
+	 */
+	struct ExportedPhotons
+	{
+		enum { StoresLightPhotons = false };
+		static bool IsStored( const InstanceNode* surface )	{ return ( surface && surface->IsExported() ); }
+	};
+
+	/*!
+	 * Clears the export flag of \a node and its descendants.
+	 */
+	void ClearExportedNodes( InstanceNode* node )
+	{
+		if( !node )	return;
+		node->SetExported( false );
+		for( int c = 0; c < node->children.count(); ++c )
+			ClearExportedNodes( node->children[c] );
+	}
+}
+
+/*!
+ * Creates a ray tracer for the scene \a rootNode. If \a transmissivity is null, the rays are not absorbed between surfaces.
+ *
+ * If \a exportSuraceList is empty, the photons of all the surfaces are stored. Otherwise, only the photons of the surfaces
+ * in the list are stored, and the ray origin photons are stored if the list contains \a lightNode. The nodes of the list
+ * are marked as exported, so the list is not searched while tracing.
+ */
 RayTracer::RayTracer( InstanceNode* rootNode,
 	       InstanceNode* lightNode,
 	       TLightShape* lightShape,
@@ -57,8 +131,10 @@ RayTracer::RayTracer( InstanceNode* rootNode,
 	       QMutex* mutex,
 	       TPhotonMap* photonMap,
 	       QMutex* mutexPhotonMap,
-	       QVector< InstanceNode* > exportSuraceList  )
-:m_exportSuraceList( exportSuraceList ),
+	       QVector< InstanceNode* > exportSuraceList,
+	       PrimaryRayCache* primaryRayCache  )
+:m_exportAllSurfaces( exportSuraceList.size() < 1 ),
+m_exportLightPhotons( exportSuraceList.size() < 1 || exportSuraceList.contains( lightNode ) ),
 m_rootNode( rootNode ),
 m_lightNode( lightNode ),
 m_lightShape( lightShape ),
@@ -68,14 +144,21 @@ m_pRand( &rand ),
 m_mutex( mutex ),
 m_photonMap( photonMap ),
 m_pPhotonMapMutex( mutexPhotonMap ),
-m_transmissivity( transmissivity )
+m_transmissivity( transmissivity ),
+m_primaryRayCache( primaryRayCache )
 {
 	m_validAreasVector = m_lightShape->GetValidAreasCoord();
+
+	ClearExportedNodes( m_rootNode );
+	for( int s = 0; s < exportSuraceList.count(); ++s )
+		if( exportSuraceList[s] )	exportSuraceList[s]->SetExported( true );
 }
 
 //generating the ray
 bool RayTracer::NewPrimitiveRay( Ray* ray, ParallelRandomDeviate& rand )
 {
+	ProfilerTimer profilerTimer( RayTracingProfiler::RayGeneration );
+
 	if( m_validAreasVector.size() < 1 )	return false;
 	int area = int ( rand.RandomDouble() * m_validAreasVector.size() );
 
@@ -85,6 +168,7 @@ bool RayTracer::NewPrimitiveRay( Ray* ray, ParallelRandomDeviate& rand )
 	Point3D origin = m_lightShape->Sample( rand.RandomDouble(), rand.RandomDouble(), areaIndex.first, areaIndex.second );
 
 	//generating the ray direction
+	rand.SetPathDimension( RandomDeviate::SunShapeDimension );
 	Vector3D direction;
 	m_lightSunShape->GenerateRayDirection( direction, rand );
 	//generatin the ray
@@ -93,219 +177,125 @@ bool RayTracer::NewPrimitiveRay( Ray* ray, ParallelRandomDeviate& rand )
 	return true;
 }
 
-void RayTracer::operator()( double numberOfRays )
-{
-	if( m_exportSuraceList.size() < 1 )
-		RayTracerCreatingAllPhotons( numberOfRays );
-	else if( m_exportSuraceList.size() > 0 &&  m_exportSuraceList.contains( m_lightNode ) )
-		RayTracerCreatingLightPhotons( numberOfRays );
-	else
-		RayTracerNotCreatingLightPhotons( numberOfRays );
-}
-
-
 /*!
- * Traces \a numberOfRays rays and creates photons for all intersections.
+ * Sets to \a primaryRay the ray \a index from the light to the first intersected surface.
+ *
+ * If the primary rays have been read from the primary ray cache, the ray is taken from the cache.
+ * Otherwise, the ray is generated and intersected with the scene and, if the cache is recording, it is added to \a primaryRays.
+ * Returns false if the ray cannot be generated.
  */
-void RayTracer::RayTracerCreatingAllPhotons( double numberOfRays  )
+bool RayTracer::NewPrimaryRay( unsigned long index, PrimaryRay* primaryRay, ParallelRandomDeviate& rand, std::vector< PrimaryRay >* primaryRays )
 {
-
-	std::vector< Photon > photonsVector;
-	ParallelRandomDeviate rand( m_pRand, m_mutex );
-
-	for(  unsigned long  i = 0; i < numberOfRays; ++i )
+	if( m_primaryRayCache && !m_primaryRayCache->IsRecording() )
 	{
-		Ray ray;
-		if( NewPrimitiveRay( &ray, rand ) )
-		{
-			photonsVector.push_back( Photon( ray.origin, 1, 0, m_lightNode ) );
-			int rayLength = 0;
-
-			InstanceNode* intersectedSurface = 0;
-			bool isFront = false;
-
-			//Trace the ray
-			bool isReflectedRay = true;
-			while( isReflectedRay )
-			{
-				intersectedSurface = 0;
-				isFront = 0;
-				Ray reflectedRay;
-				isReflectedRay = m_rootNode->Intersect( ray, rand, &isFront, &intersectedSurface, &reflectedRay );
-
-				if( rayLength > 0 )
-				{
-					if( m_transmissivity && !m_transmissivity->IsTransmitted( ray.maxt, rand ) )
-					{
-						++rayLength;
-						isReflectedRay = false;
-						intersectedSurface = 0;
-						ray.maxt = HUGE_VAL;
-					}
-
-				}
-				if( isReflectedRay )
-				{
-					photonsVector.push_back( Photon( (ray)( ray.maxt ), isFront, ++rayLength, intersectedSurface, 1 ) );
-
-					//Prepare node and ray for next iteration
-					ray = reflectedRay;
-					//isDirectSun = false;
-				}
-
-			}
-
-			if( !(rayLength == 0 && ray.maxt == HUGE_VAL ) )
-			{
-
-				if( ray.maxt == HUGE_VAL  )
-				{
-					ray.maxt = 0.1;
-					photonsVector.push_back( Photon( (ray)( ray.maxt ), 0, ++rayLength, intersectedSurface) );
-				}
-				else
-					photonsVector.push_back( Photon( (ray)( ray.maxt ), isFront, ++rayLength, intersectedSurface) );
-			}
-
-		}
-
+		m_primaryRayCache->GetPrimaryRay( index, primaryRay );
+		return true;
 	}
 
-	photonsVector.resize( photonsVector.size() );
-
-	m_pPhotonMapMutex->lock();
-	m_photonMap->StoreRays( photonsVector );
-	m_pPhotonMapMutex->unlock();
+	if( !NewPrimitiveRay( &primaryRay->ray, rand ) )	return false;
+	rand.SetPathDimension( RandomDeviate::FirstSurfaceDimension );
+	{
+		ProfilerTimer profilerTimer( RayTracingProfiler::Traversal );
+		primaryRay->isReflectedRay = m_rootNode->Intersect( primaryRay->ray, rand, &primaryRay->isFront, &primaryRay->intersectedSurface,
+				&primaryRay->reflectedRay, &primaryRay->u, &primaryRay->v );
+	}
 
+	if( m_primaryRayCache )	primaryRays->push_back( *primaryRay );
+	return true;
 }
 
 /*!
- * Traces \a numberOfRays rays. Creates photons for the ray origin and to the selected surfaces
+ * Traces \a numberOfRays rays with the trace loop specialized for the transmissivity and the exported surfaces.
  */
-void RayTracer::RayTracerCreatingLightPhotons(  double numberOfRays  )
+void RayTracer::operator()( double numberOfRays )
 {
+	unsigned long firstRay = 0;
+	if( m_primaryRayCache && !m_primaryRayCache->IsRecording() )
+		numberOfRays = m_primaryRayCache->ReserveRays( (unsigned long) numberOfRays, &firstRay );
 
-	std::vector< Photon > photonsVector;
-	ParallelRandomDeviate rand( m_pRand, m_mutex );
-
-	for(  unsigned long  i = 0; i < numberOfRays; ++i )
-	{
-		Ray ray;
-		if( NewPrimitiveRay( &ray, rand ) )
-		{
-			photonsVector.push_back( Photon( ray.origin, 1, 0, m_lightNode ) );
-			int rayLength = 0;
-
-			InstanceNode* intersectedSurface = 0;
-			bool isFront = false;
-
-			//Trace the ray
-			bool isReflectedRay = true;
-			while( isReflectedRay )
-			{
-				intersectedSurface = 0;
-				isFront = 0;
-				Ray reflectedRay;
-				isReflectedRay = m_rootNode->Intersect( ray, rand, &isFront, &intersectedSurface, &reflectedRay );
-
-				if( rayLength > 0 )
-				{
-					if( m_transmissivity && !m_transmissivity->IsTransmitted( ray.maxt, rand ) )
-					{
-						++rayLength;
-						isReflectedRay = false;
-						intersectedSurface = 0;
-						ray.maxt = HUGE_VAL;
-					}
-
-				}
-				if( isReflectedRay )
-				{
-					++rayLength;
-					if( m_exportSuraceList.contains( intersectedSurface ) )
-						photonsVector.push_back( Photon( (ray)( ray.maxt ), isFront, rayLength, intersectedSurface, 1) );
-
-					//Prepare node and ray for next iteration
-					ray = reflectedRay;
-				}
-
-			}
-
-			if( m_exportSuraceList.contains( intersectedSurface ) && !(rayLength == 0 && ray.maxt == HUGE_VAL) )
-			{
-				if( ray.maxt == HUGE_VAL  )
-				{
-					ray.maxt = 0.1;
-					photonsVector.push_back( Photon( (ray)( ray.maxt ), 0, ++rayLength, intersectedSurface) );
-				}
-				else
-					photonsVector.push_back( Photon( (ray)( ray.maxt ), isFront, ++rayLength, intersectedSurface) );
-			}
-
-		}
-
-	}
-	photonsVector.resize( photonsVector.size() );
-
-	m_pPhotonMapMutex->lock();
-	m_photonMap->StoreRays( photonsVector );
-	m_pPhotonMapMutex->unlock();
+	if( m_transmissivity )
+		TraceWithTransmissivityPolicy< WithTransmissivity >( firstRay, numberOfRays );
+	else
+		TraceWithTransmissivityPolicy< WithoutTransmissivity >( firstRay, numberOfRays );
+}
 
+/*!
+ * Traces \a numberOfRays rays with the photon policy for the exported surfaces.
+ */
+template< class TransmissivityPolicy >
+void RayTracer::TraceWithTransmissivityPolicy( unsigned long firstRay, double numberOfRays )
+{
+	if( m_exportAllSurfaces )
+		Trace< TransmissivityPolicy, AllPhotons >( firstRay, numberOfRays );
+	else if( m_exportLightPhotons )
+		Trace< TransmissivityPolicy, LightAndExportedPhotons >( firstRay, numberOfRays );
+	else
+		Trace< TransmissivityPolicy, ExportedPhotons >( firstRay, numberOfRays );
 }
 
 /*!
- * Traces \a numberOfRays rays. Creates photons for the selected surfaces.
- * Photons for the rays origin will not be created.
+ * Traces \a numberOfRays rays starting from the ray \a firstRay.
+ *
+ * The TransmissivityPolicy defines whether the rays are absorbed between surfaces and the PhotonPolicy defines
+ * which photons are stored. Both are resolved at compile time, so the trace loop does not check them for each ray.
+ *
+ * Each ray is a path of the random generator. The light, the sun shape and each intersected surface take
+ * their numbers from fixed path dimensions, so a path sampler assigns the same dimensions to the same events.
  */
-void RayTracer::RayTracerNotCreatingLightPhotons(  double numberOfRays  )
+template< class TransmissivityPolicy, class PhotonPolicy >
+void RayTracer::Trace( unsigned long firstRay, double numberOfRays )
 {
 	std::vector< Photon > photonsVector;
+	std::vector< PrimaryRay > primaryRays;
 	ParallelRandomDeviate rand( m_pRand, m_mutex );
+	unsigned long firstPath = rand.ReservePaths( (unsigned long) numberOfRays );
 
 	for(  unsigned long  i = 0; i < numberOfRays; ++i )
 	{
-		Ray ray;
-		if( NewPrimitiveRay( &ray, rand ) )
+		rand.StartPath( firstPath + i, RandomDeviate::LightDimension );
+		PrimaryRay primaryRay;
+		if( NewPrimaryRay( firstRay + i, &primaryRay, rand, &primaryRays ) )
 		{
+			Ray ray = primaryRay.ray;
+			if( PhotonPolicy::StoresLightPhotons )
+				photonsVector.push_back( Photon( ray.origin, 1, 0, m_lightNode ) );
 			int rayLength = 0;
 
-			InstanceNode* intersectedSurface = 0;
-			bool isFront = false;
+			InstanceNode* intersectedSurface = primaryRay.intersectedSurface;
+			bool isFront = primaryRay.isFront;
+			double u = primaryRay.u;
+			double v = primaryRay.v;
+			Ray reflectedRay = primaryRay.reflectedRay;
 
 			//Trace the ray
-			bool isReflectedRay = true;
+			bool isReflectedRay = primaryRay.isReflectedRay;
 			while( isReflectedRay )
 			{
+				++rayLength;
+				if( PhotonPolicy::IsStored( intersectedSurface ) )
+					photonsVector.push_back( Photon( (ray)( ray.maxt ), isFront, rayLength, intersectedSurface, 1, u, v ) );
+
+				//Prepare node and ray for next iteration
+				ray = reflectedRay;
+
 				intersectedSurface = 0;
 				isFront = 0;
-				Ray reflectedRay;
-				isReflectedRay = m_rootNode->Intersect( ray, rand, &isFront, &intersectedSurface, &reflectedRay );
-
-				if( rayLength > 0 )
+				rand.SetPathDimension( RandomDeviate::FirstSurfaceDimension + rayLength * RandomDeviate::SurfaceDimensions );
 				{
-					if( m_transmissivity && !m_transmissivity->IsTransmitted( ray.maxt, rand ) )
-					{
-						++rayLength;
-						isReflectedRay = false;
-						intersectedSurface = 0;
-						ray.maxt = HUGE_VAL;
-					}
-
-
+					ProfilerTimer profilerTimer( RayTracingProfiler::Traversal );
+					isReflectedRay = m_rootNode->Intersect( ray, rand, &isFront, &intersectedSurface, &reflectedRay, &u, &v );
 				}
-				if( isReflectedRay )
+
+				if( TransmissivityPolicy::IsAbsorbed( m_transmissivity, ray.maxt, rand ) )
 				{
 					++rayLength;
-					if( m_exportSuraceList.contains( intersectedSurface ) )
-						photonsVector.push_back( Photon( (ray)( ray.maxt ), isFront, rayLength, intersectedSurface, 1) );
-
-					//Prepare node and ray for next iteration
-					ray = reflectedRay;
+					isReflectedRay = false;
+					intersectedSurface = 0;
+					ray.maxt = HUGE_VAL;
 				}
-
 			}
 
-			if( m_exportSuraceList.contains( intersectedSurface ) && !(rayLength == 0 && ray.maxt == HUGE_VAL) )
+			if( PhotonPolicy::IsStored( intersectedSurface ) && !(rayLength == 0 && ray.maxt == HUGE_VAL ) )
 			{
 				if( ray.maxt == HUGE_VAL  )
 				{
@@ -313,14 +303,19 @@ void RayTracer::RayTracerNotCreatingLightPhotons(  double numberOfRays  )
 					photonsVector.push_back( Photon( (ray)( ray.maxt ), 0, ++rayLength, intersectedSurface) );
 				}
 				else
-					photonsVector.push_back( Photon( (ray)( ray.maxt ), isFront, ++rayLength, intersectedSurface) );
+					photonsVector.push_back( Photon( (ray)( ray.maxt ), isFront, ++rayLength, intersectedSurface, 0, u, v ) );
 			}
 
 		}
 
 	}
+
 	photonsVector.resize( photonsVector.size() );
 
+	if( m_primaryRayCache && m_primaryRayCache->IsRecording() )
+		m_primaryRayCache->StorePrimaryRays( primaryRays );
+
+	ProfilerTimer profilerTimer( RayTracingProfiler::PhotonStorage );
 	m_pPhotonMapMutex->lock();
 	m_photonMap->StoreRays( photonsVector );
 	m_pPhotonMapMutex->unlock();
@@ -52,6 +52,8 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 class InstanceNode;
 class ParallelRandomDeviate;
 struct Photon;
+struct PrimaryRay;
+class PrimaryRayCache;
 class RandomDeviate;
 struct RayTracerPhoton;
 class QMutex;
@@ -75,7 +77,8 @@ public:
 		       QMutex* mutex,
 		       TPhotonMap* photonMap,
 		       QMutex* mutexPhotonMap,
-		       QVector< InstanceNode* > exportSuraceList );
+		       QVector< InstanceNode* > exportSuraceList,
+		       PrimaryRayCache* primaryRayCache = 0 );
 
 	typedef void result_type;
 	void operator()( double numberOfRays );
@@ -83,12 +86,13 @@ public:
 
 private:
 	bool NewPrimitiveRay( Ray* ray, ParallelRandomDeviate& rand );
-	void RayTracerCreatingAllPhotons(  double numberOfRays  );
-	void RayTracerCreatingLightPhotons(  double numberOfRays  );
-	void RayTracerNotCreatingLightPhotons(  double numberOfRays  );
+	bool NewPrimaryRay( unsigned long index, PrimaryRay* primaryRay, ParallelRandomDeviate& rand, std::vector< PrimaryRay >* primaryRays );
+	template< class TransmissivityPolicy > void TraceWithTransmissivityPolicy( unsigned long firstRay, double numberOfRays );
+	template< class TransmissivityPolicy, class PhotonPolicy > void Trace( unsigned long firstRay, double numberOfRays );
 
 
-    QVector< InstanceNode* > m_exportSuraceList;
+	bool m_exportAllSurfaces;
+	bool m_exportLightPhotons;
 	InstanceNode* m_rootNode;
 	InstanceNode* m_lightNode;
 	TLightShape* m_lightShape;
@@ -99,6 +103,7 @@ private:
 	TPhotonMap* m_photonMap;
     QMutex* m_pPhotonMapMutex;
 	TTransmissivity * m_transmissivity;
+	PrimaryRayCache* m_primaryRayCache;
 	std::vector< QPair< int, int > >  m_validAreasVector;
 
 
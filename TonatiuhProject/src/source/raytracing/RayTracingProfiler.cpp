@@ -0,0 +1,282 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include "RayTracingProfiler.h"
+
+QAtomicInt RayTracingProfiler::m_enabled( 0 );
+QMutex RayTracingProfiler::m_recordsMutex;
+QVector< QSharedPointer< RayTracingProfiler::ThreadRecord > > RayTracingProfiler::m_records;
+QThreadStorage< RayTracingProfiler::ThreadRecordHandle* > RayTracingProfiler::m_currentRecord;
+
+RayTracingProfiler::ThreadRecord::ThreadRecord()
+{
+	Clear();
+}
+
+void RayTracingProfiler::ThreadRecord::Clear()
+{
+	for( int p = 0; p < NumberOfPhases; ++p )
+	{
+		phaseTime[p] = 0.0;
+		phaseCalls[p] = 0;
+		shapeTime[p].clear();
+		shapeCalls[p].clear();
+	}
+}
+
+/*!
+ * Marks the record as the record of a finished thread. The record is freed by the next Reset.
+ */
+RayTracingProfiler::ThreadRecordHandle::~ThreadRecordHandle()
+{
+	record->threadFinished.fetchAndStoreOrdered( 1 );
+}
+
+/*!
+ * Enables the profiler if \a enabled is true. Otherwise, the measures are not recorded.
+ */
+void RayTracingProfiler::SetEnabled( bool enabled )
+{
+	m_enabled.fetchAndStoreOrdered( enabled ? 1 : 0 );
+}
+
+/*!
+ * Clears the times recorded by all the threads and frees the records of the finished threads.
+ *
+ * It must not be called while the ray tracer threads are running.
+ */
+void RayTracingProfiler::Reset()
+{
+	QMutexLocker locker( &m_recordsMutex );
+	for( int r = m_records.size() - 1; r >= 0; --r )
+	{
+#if QT_VERSION >= 0x050000
+		bool threadFinished = ( m_records[r]->threadFinished.load() != 0 );
+#else
+		bool threadFinished = ( m_records[r]->threadFinished != 0 );
+#endif
+		if( threadFinished )	m_records.remove( r );
+		else	m_records[r]->Clear();
+	}
+}
+
+/*!
+ * Adds \a time seconds and a call to the \a phase of the current thread.
+ */
+void RayTracingProfiler::AddPhaseTime( Phase phase, double time )
+{
+	ThreadRecord* record = CurrentThreadRecord();
+	record->phaseTime[phase] += time;
+	record->phaseCalls[phase]++;
+}
+
+/*!
+ * Adds \a time seconds and a call to the \a phase of the shapes of type \a shapeType in the current thread.
+ * The time is also added to the \a phase total. The \a shapeType pointer is used as key, so it must be
+ * the same for all the shapes of a type.
+ */
+void RayTracingProfiler::AddShapeTime( Phase phase, const char* shapeType, double time )
+{
+	ThreadRecord* record = CurrentThreadRecord();
+	record->phaseTime[phase] += time;
+	record->phaseCalls[phase]++;
+	record->shapeTime[phase][shapeType] += time;
+	record->shapeCalls[phase][shapeType]++;
+}
+
+/*!
+ * Writes the recorded times to \a fileName. If the file suffix is "json" the report is saved in JSON format.
+ * Otherwise, it is saved in CSV format.
+ *
+ * Returns false if the file cannot be written.
+ */
+bool RayTracingProfiler::WriteReport( QString fileName )
+{
+	if( QFileInfo( fileName ).suffix().toLower() == QLatin1String( "json" ) )	return WriteJSONReport( fileName );
+	return WriteCSVReport( fileName );
+}
+
+/*!
+ * Returns the record of the current thread. The record is created the first time that a thread uses the profiler.
+ * The record is shared by the thread local handle, which QThreadStorage deletes when the thread finishes,
+ * and the records list, so it is freed when both of them release it.
+ */
+RayTracingProfiler::ThreadRecord* RayTracingProfiler::CurrentThreadRecord()
+{
+	if( !m_currentRecord.hasLocalData() )
+	{
+		ThreadRecordHandle* handle = new ThreadRecordHandle;
+		handle->record = QSharedPointer< ThreadRecord >( new ThreadRecord );
+
+		QMutexLocker locker( &m_recordsMutex );
+		m_records.push_back( handle->record );
+		m_currentRecord.setLocalData( handle );
+	}
+
+	return m_currentRecord.localData()->record.data();
+}
+
+/*!
+ * Returns the name of the \a phase for the reports.
+ */
+QString RayTracingProfiler::PhaseName( int phase )
+{
+	switch( phase )
+	{
+		case SceneTreeMap:
+			return QLatin1String( "scene_tree_map" );
+		case LightSourceArea:
+			return QLatin1String( "light_source_area" );
+		case RayGeneration:
+			return QLatin1String( "ray_generation" );
+		case Traversal:
+			return QLatin1String( "traversal" );
+		case ShapeIntersection:
+			return QLatin1String( "shape_intersection" );
+		case ShapeDifferentialGeometry:
+			return QLatin1String( "shape_differential_geometry" );
+		case MaterialOutputRay:
+			return QLatin1String( "material_output_ray" );
+		case Transmissivity:
+			return QLatin1String( "transmissivity" );
+		case PhotonStorage:
+			return QLatin1String( "photon_storage" );
+		case PhotonExport:
+			return QLatin1String( "photon_export" );
+		default:
+			return QString();
+	}
+}
+
+/*!
+ * Writes the report to \a fileName with a line for each thread, phase or shape type.
+ */
+bool RayTracingProfiler::WriteCSVReport( QString fileName )
+{
+	QFile reportFile( fileName );
+	if( !reportFile.open( QIODevice::WriteOnly | QIODevice::Text ) )	return false;
+	QTextStream out( &reportFile );
+	out.setRealNumberPrecision( 9 );
+
+	QMutexLocker locker( &m_recordsMutex );
+	out<<"thread,phase,shape_type,calls,time_s\n";
+	for( int r = 0; r < m_records.size(); ++r )
+	{
+		ThreadRecord* record = m_records[r].data();
+		for( int p = 0; p < NumberOfPhases; ++p )
+		{
+			if( record->phaseCalls[p] < 1 )	continue;
+			out<<r<<","<<PhaseName( p )<<",,"<<record->phaseCalls[p]<<","<<record->phaseTime[p]<<"\n";
+		}
+
+		for( int p = 0; p < NumberOfPhases; ++p )
+		{
+			QHash< const char*, double >::const_iterator shape = record->shapeTime[p].constBegin();
+			while( shape != record->shapeTime[p].constEnd() )
+			{
+				out<<r<<","<<PhaseName( p )<<","<<shape.key()<<","
+						<<record->shapeCalls[p].value( shape.key() )<<","<<shape.value()<<"\n";
+				++shape;
+			}
+		}
+	}
+
+	reportFile.close();
+	return true;
+}
+
+/*!
+ * Writes the report to \a fileName as a JSON object with a list of threads.
+ */
+bool RayTracingProfiler::WriteJSONReport( QString fileName )
+{
+	QFile reportFile( fileName );
+	if( !reportFile.open( QIODevice::WriteOnly | QIODevice::Text ) )	return false;
+	QTextStream out( &reportFile );
+	out.setRealNumberPrecision( 9 );
+
+	QMutexLocker locker( &m_recordsMutex );
+	out<<"{\n\t\"threads\": [";
+	for( int r = 0; r < m_records.size(); ++r )
+	{
+		ThreadRecord* record = m_records[r].data();
+		if( r > 0 )	out<<",";
+		out<<"\n\t\t{\n\t\t\t\"thread\": "<<r<<",\n\t\t\t\"phases\": {";
+
+		bool first = true;
+		for( int p = 0; p < NumberOfPhases; ++p )
+		{
+			if( record->phaseCalls[p] < 1 )	continue;
+			if( !first )	out<<",";
+			out<<"\n\t\t\t\t\""<<PhaseName( p )<<"\": { \"calls\": "<<record->phaseCalls[p]
+					<<", \"time_s\": "<<record->phaseTime[p]<<" }";
+			first = false;
+		}
+		out<<"\n\t\t\t},\n\t\t\t\"shapes\": {";
+
+		first = true;
+		for( int p = 0; p < NumberOfPhases; ++p )
+		{
+			if( record->shapeTime[p].isEmpty() )	continue;
+			if( !first )	out<<",";
+			out<<"\n\t\t\t\t\""<<PhaseName( p )<<"\": {";
+
+			bool firstShape = true;
+			QHash< const char*, double >::const_iterator shape = record->shapeTime[p].constBegin();
+			while( shape != record->shapeTime[p].constEnd() )
+			{
+				if( !firstShape )	out<<",";
+				out<<"\n\t\t\t\t\t\""<<shape.key()<<"\": { \"calls\": "<<record->shapeCalls[p].value( shape.key() )
+						<<", \"time_s\": "<<shape.value()<<" }";
+				firstShape = false;
+				++shape;
+			}
+			out<<"\n\t\t\t\t}";
+			first = false;
+		}
+		out<<"\n\t\t\t}\n\t\t}";
+	}
+	out<<"\n\t]\n}\n";
+
+	reportFile.close();
+	return true;
+}
@@ -0,0 +1,180 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef RAYTRACINGPROFILER_H_
+#define RAYTRACINGPROFILER_H_
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QThreadStorage>
+#include <QVector>
+
+#include "Timer.h"
+
+//!  RayTracingProfiler accumulates the time spent in each phase of the ray tracing.
+/*!
+  The times and the number of calls are accumulated per thread, so the ray tracer threads do not
+  share any data while they are tracing. When the profiler is disabled, the measures are not started.
+
+  The phase times are inclusive: the traversal time includes the shape intersection and material times.
+  The shape intersection and the shape differential geometry are separate phases, and each of them is
+  also reported per shape type.
+
+  The record of a thread is kept after the thread finishes, so it is included in the report, and it is
+  freed by the next Reset.
+*/
+
+class RayTracingProfiler
+{
+
+public:
+	enum Phase
+	{
+		SceneTreeMap = 0,
+		LightSourceArea = 1,
+		RayGeneration = 2,
+		Traversal = 3,
+		ShapeIntersection = 4,
+		ShapeDifferentialGeometry = 5,
+		MaterialOutputRay = 6,
+		Transmissivity = 7,
+		PhotonStorage = 8,
+		PhotonExport = 9,
+		NumberOfPhases = 10
+	};
+
+	static bool IsEnabled();
+	static void SetEnabled( bool enabled );
+	static void Reset();
+
+	static void AddPhaseTime( Phase phase, double time );
+	static void AddShapeTime( Phase phase, const char* shapeType, double time );
+
+	static bool WriteReport( QString fileName );
+
+private:
+	struct ThreadRecord
+	{
+		ThreadRecord();
+		void Clear();
+
+		double phaseTime[NumberOfPhases];
+		unsigned long phaseCalls[NumberOfPhases];
+		QHash< const char*, double > shapeTime[NumberOfPhases];
+		QHash< const char*, unsigned long > shapeCalls[NumberOfPhases];
+		QAtomicInt threadFinished;
+	};
+
+	//! Thread local owner of a record. It is deleted when its thread finishes.
+	struct ThreadRecordHandle
+	{
+		~ThreadRecordHandle();
+
+		QSharedPointer< ThreadRecord > record;
+	};
+
+	static ThreadRecord* CurrentThreadRecord();
+	static QString PhaseName( int phase );
+	static bool WriteCSVReport( QString fileName );
+	static bool WriteJSONReport( QString fileName );
+
+	static QAtomicInt m_enabled;
+	static QMutex m_recordsMutex;
+	static QVector< QSharedPointer< ThreadRecord > > m_records;
+	static QThreadStorage< ThreadRecordHandle* > m_currentRecord;
+};
+
+//!  ProfilerTimer measures the time of a scope for the RayTracingProfiler.
+/*!
+  The time from the construction to the destruction of the object is added to the phase, and to the
+  shape type of the phase, defined in the constructor.
+*/
+
+class ProfilerTimer
+{
+
+public:
+	ProfilerTimer( RayTracingProfiler::Phase phase );
+	ProfilerTimer( RayTracingProfiler::Phase phase, const char* shapeType );
+	~ProfilerTimer();
+
+private:
+	bool m_enabled;
+	RayTracingProfiler::Phase m_phase;
+	const char* m_shapeType;
+	Timer m_timer;
+};
+
+inline bool RayTracingProfiler::IsEnabled()
+{
+#if QT_VERSION >= 0x050000
+	return m_enabled.load() != 0;
+#else
+	return m_enabled != 0;
+#endif
+}
+
+inline ProfilerTimer::ProfilerTimer( RayTracingProfiler::Phase phase )
+:m_enabled( RayTracingProfiler::IsEnabled() ),
+m_phase( phase ),
+m_shapeType( 0 )
+{
+	if( m_enabled )	m_timer.Start();
+}
+
+inline ProfilerTimer::ProfilerTimer( RayTracingProfiler::Phase phase, const char* shapeType )
+:m_enabled( RayTracingProfiler::IsEnabled() ),
+m_phase( phase ),
+m_shapeType( shapeType )
+{
+	if( m_enabled )	m_timer.Start();
+}
+
+inline ProfilerTimer::~ProfilerTimer()
+{
+	if( !m_enabled )	return;
+
+	m_timer.Stop();
+	if( m_shapeType )	RayTracingProfiler::AddShapeTime( m_phase, m_shapeType, m_timer.Time() );
+	else	RayTracingProfiler::AddPhaseTime( m_phase, m_timer.Time() );
+}
+
+#endif /* RAYTRACINGPROFILER_H_ */
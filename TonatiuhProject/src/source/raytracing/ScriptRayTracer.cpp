@@ -54,7 +54,6 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "RandomDeviate.h"
 #include "RandomDeviateFactory.h"
 #include "RayTracer.h"
-#include "RayTracerNoTr.h"
 #include "tgf.h"
 #include "TLightKit.h"
 #include "TLightShape.h"
@@ -360,7 +359,7 @@ int ScriptRayTracer::Trace()
 	trf::ComputeSceneTreeMap( rootSeparatorInstance, Transform( new Matrix4x4 ), true );
 
 	TLightKit* light = static_cast< TLightKit* > ( lightInstance->GetNode() );
-	QStringList disabledNodes = QString( light->disabledNodes.getValue().getString() ).split( ";", QString::SkipEmptyParts );
+	QSet< QString > disabledNodes = QString( light->disabledNodes.getValue().getString() ).split( ";", QString::SkipEmptyParts ).toSet();
 	QVector< QPair< TShapeKit*, Transform > > surfacesList;
 	trf::ComputeFistStageSurfaceList( rootSeparatorInstance, disabledNodes, &surfacesList );
 	light->ComputeLightSourceArea( m_widthDivisions, m_heightDivisions, surfacesList );
@@ -392,11 +391,7 @@ int ScriptRayTracer::Trace()
 
 	QMutex mutex;
 	QFuture< TPhotonMap* > photonMap;
-	if( transmissivity )
-		photonMap = QtConcurrent::mappedReduced( raysPerThread, RayTracer(  rootSeparatorInstance, lightInstance, raycastingSurface, sunShape, lightToWorld, transmissivity, *m_randomDeviate, &mutex, m_photonMap ), trf::CreatePhotonMap, QtConcurrent::UnorderedReduce );
-
-	else
-		photonMap = QtConcurrent::mappedReduced( raysPerThread, RayTracerNoTr(  rootSeparatorInstance, lightInstance, raycastingSurface, sunShape, lightToWorld, *m_randomDeviate, &mutex, m_photonMap ), trf::CreatePhotonMap, QtConcurrent::UnorderedReduce );
+	photonMap = QtConcurrent::mappedReduced( raysPerThread, RayTracer(  rootSeparatorInstance, lightInstance, raycastingSurface, sunShape, lightToWorld, transmissivity, *m_randomDeviate, &mutex, m_photonMap ), trf::CreatePhotonMap, QtConcurrent::UnorderedReduce );
 
 	futureWatcher.setFuture( photonMap );
 	futureWatcher.waitForFinished();
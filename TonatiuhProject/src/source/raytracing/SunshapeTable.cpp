@@ -0,0 +1,149 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include "SunshapeTable.h"
+
+const int SunshapeTable::m_tableSize = 4096;
+const int SunshapeTable::m_segmentDivisions = 16;
+
+SunshapeTable::SunshapeTable()
+:m_thetaMax( 0.0 )
+{
+
+}
+
+SunshapeTable::~SunshapeTable()
+{
+
+}
+
+/*!
+ * Removes the table values.
+ */
+void SunshapeTable::Clear()
+{
+	m_thetaMax = 0.0;
+	m_inverseCDF.clear();
+}
+
+/*!
+ * Returns the largest zenith angle of the profile.
+ */
+double SunshapeTable::GetThetaMax() const
+{
+	return m_thetaMax;
+}
+
+/*!
+ * Returns true if no valid profile has been defined.
+ */
+bool SunshapeTable::IsEmpty() const
+{
+	return m_inverseCDF.empty();
+}
+
+/*!
+ * Builds the table for the profile with the \a radiance values at the \a theta zenith angles, in radians.
+ * The radiance varies linearly between consecutive angles. The angles must be non negative and non decreasing,
+ * so repeated angles define discontinuities in the profile.
+ *
+ * Returns false and clears the table if the profile is not valid.
+ */
+bool SunshapeTable::SetProfile( const std::vector< double >& theta, const std::vector< double >& radiance )
+{
+	Clear();
+	if( ( theta.size() < 2 ) || ( theta.size() != radiance.size() ) ) return false;
+	if( ( theta[0] < 0.0 ) || ( radiance[0] < 0.0 ) ) return false;
+
+	// Cumulative distribution of the radiance weighted with the solid angle
+	std::vector< double > thetaNodes( 1, theta[0] );
+	std::vector< double > density( 1, radiance[0] * sin( theta[0] ) );
+	std::vector< double > cdf( 1, 0.0 );
+	for( unsigned int j = 1; j < theta.size(); ++j )
+	{
+		if( ( theta[j] < theta[j-1] ) || ( radiance[j] < 0.0 ) ) return false;
+
+		double theta0 = theta[j-1];
+		for( int s = 1; s <= m_segmentDivisions; ++s )
+		{
+			double w = double( s ) / m_segmentDivisions;
+			double theta1 = theta[j-1] + w * ( theta[j] - theta[j-1] );
+			double radiance1 = radiance[j-1] + w * ( radiance[j] - radiance[j-1] );
+
+			double density1 = radiance1 * sin( theta1 );
+			cdf.push_back( cdf.back() + 0.5 * ( theta1 - theta0 ) * ( density.back() + density1 ) );
+			thetaNodes.push_back( theta1 );
+			density.push_back( density1 );
+
+			theta0 = theta1;
+		}
+	}
+
+	double total = cdf.back();
+	if( !( total > 0.0 ) ) return false;
+
+	// Inverse of the cumulative distribution at equally spaced probabilities. The density varies linearly
+	// between nodes, so the distribution is inverted solving a quadratic equation.
+	m_inverseCDF.resize( m_tableSize + 1 );
+	unsigned int node = 1;
+	for( int i = 0; i <= m_tableSize; ++i )
+	{
+		double probability = total * i / m_tableSize;
+		while( ( node < cdf.size() - 1 ) && ( cdf[node] < probability ) ) node++;
+
+		double cdf0 = cdf[node-1];
+		double cdf1 = cdf[node];
+		if( cdf1 > cdf0 )
+		{
+			double step = thetaNodes[node] - thetaNodes[node-1];
+			double a = 0.5 * ( density[node] - density[node-1] ) / step;
+			double b = density[node-1];
+			double p = std::min( std::max( probability - cdf0, 0.0 ), cdf1 - cdf0 );
+			double x = ( p > 0.0 ) ? 2 * p / ( b + sqrt( std::max( b * b + 4 * a * p, 0.0 ) ) ) : 0.0;
+			m_inverseCDF[i] = thetaNodes[node-1] + std::min( x, step );
+		}
+		else
+			m_inverseCDF[i] = thetaNodes[node];
+	}
+	m_thetaMax = theta.back();
+
+	return true;
+}
@@ -0,0 +1,87 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef SUNSHAPETABLE_H_
+#define SUNSHAPETABLE_H_
+
+#include <vector>
+
+//!  SunshapeTable samples the zenith angle of the sun rays from a tabulated radial profile.
+/*!
+  The profile is the radiance of the sun, per solid angle, for increasing zenith angles. It is
+  weighted with the solid angle and integrated when the profile is defined, and the inverse of
+  its cumulative distribution is stored at equally spaced probabilities. Then, each zenith angle
+  is sampled with one table lookup and a linear interpolation.
+*/
+
+class SunshapeTable
+{
+
+public:
+	SunshapeTable();
+	~SunshapeTable();
+
+	void Clear();
+	double GetThetaMax() const;
+	bool IsEmpty() const;
+	double SampleTheta( double u ) const;
+	bool SetProfile( const std::vector< double >& theta, const std::vector< double >& radiance );
+
+private:
+	static const int m_tableSize;
+	static const int m_segmentDivisions;
+
+	double m_thetaMax;
+	std::vector< double > m_inverseCDF;
+};
+
+/*!
+ * Returns the zenith angle for the probability \a u, that must be in the [0, 1] range.
+ *
+ * The table must not be empty.
+ */
+inline double SunshapeTable::SampleTheta( double u ) const
+{
+	double position = u * m_tableSize;
+	int index = int( position );
+	if( index >= m_tableSize ) index = m_tableSize - 1;
+
+	return m_inverseCDF[index] + ( position - index ) * ( m_inverseCDF[index+1] - m_inverseCDF[index] );
+}
+
+#endif /* SUNSHAPETABLE_H_ */
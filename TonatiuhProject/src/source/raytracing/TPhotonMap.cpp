@@ -37,30 +37,36 @@ TPhotonMap::~TPhotonMap()
  */
 void TPhotonMap::EndStore( double wPhoton )
 {
-	if( m_storedPhotonsInBuffer  > 0 )
-	{
-		if( m_pExportPhotonMap ) m_pExportPhotonMap->SavePhotonMap( m_photonsInMemory );
+	FlushStore();
+	if( m_pExportPhotonMap )	m_pExportPhotonMap->SetPowerPerPhoton( wPhoton );
+	if( m_pExportPhotonMap )	m_pExportPhotonMap->EndExport();
+}
 
-		unsigned int photonListSize = m_photonsInMemory.size();
-		for( unsigned int i = 0; i < photonListSize ;++i )
-		{
-			delete m_photonsInMemory[i];
-			m_photonsInMemory[i] = 0;
-		}
+/*!
+ * Saves the photons of the buffer with the export mode and removes them from memory.
+ */
+void TPhotonMap::FlushStore()
+{
+	if( m_storedPhotonsInBuffer < 1 )	return;
 
-		m_photonsInMemory.clear();
-    	std::vector< Photon* >( m_photonsInMemory ).swap( m_photonsInMemory );
-		m_storedPhotonsInBuffer = 0;
+	if( m_pExportPhotonMap ) m_pExportPhotonMap->SavePhotonMap( m_photonsInMemory );
 
+	unsigned int photonListSize = m_photonsInMemory.size();
+	for( unsigned int i = 0; i < photonListSize ;++i )
+	{
+		delete m_photonsInMemory[i];
+		m_photonsInMemory[i] = 0;
 	}
-	if( m_pExportPhotonMap )	m_pExportPhotonMap->SetPowerPerPhoton( wPhoton );
-	if( m_pExportPhotonMap )	m_pExportPhotonMap->EndExport();
+
+	m_photonsInMemory.clear();
+	std::vector< Photon* >( m_photonsInMemory ).swap( m_photonsInMemory );
+	m_storedPhotonsInBuffer = 0;
 }
 
 /*!
- *
+ * Returns the photons stored in memory.
  */
-std::vector< Photon* > TPhotonMap::GetAllPhotons() const
+const std::vector< Photon* >& TPhotonMap::GetAllPhotons() const
 {
 	return ( m_photonsInMemory );
 }
@@ -109,19 +115,7 @@ void TPhotonMap::StoreRays( std::vector< Photon >& raysList )
 {
 	unsigned int raysListSize = raysList.size();
 	if( ( m_storedPhotonsInBuffer > 0 ) && ( ( m_storedPhotonsInBuffer + raysListSize )  > m_bufferSize ) )
-	{
-		if( m_pExportPhotonMap ) m_pExportPhotonMap->SavePhotonMap( m_photonsInMemory );
-
-		unsigned int photonListSize = m_photonsInMemory.size();
-		for( unsigned int i = 0; i < photonListSize ;++i )
-		{
-			delete m_photonsInMemory[i];
-			m_photonsInMemory[i] = 0;
-		}
-		m_photonsInMemory.clear();
-    	std::vector< Photon* >( m_photonsInMemory ).swap( m_photonsInMemory );
-		m_storedPhotonsInBuffer = 0;
-	}
+		FlushStore();
 
 	for( unsigned int photon = 0; photon < raysListSize; photon++ )
 		m_photonsInMemory.push_back( new Photon( raysList[photon] ) );
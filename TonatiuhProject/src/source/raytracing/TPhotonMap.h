@@ -12,7 +12,8 @@ public:
 	~TPhotonMap();
 
     void EndStore( double wPhoton );
-	std::vector< Photon* > GetAllPhotons() const;
+    void FlushStore();
+	const std::vector< Photon* >& GetAllPhotons() const;
 	PhotonMapExport* GetExportMode( ) const;
 	void SetBufferSize( unsigned long nPhotons );
 	void SetConcentratorToWorld( Transform concentratorToWorld );
@@ -36,6 +36,10 @@ Contributors: Javier Garcia-Barberena, I�aki Perez, Inigo Pagola,  Gilda Jimen
 Juana Amieva, Azael Mancillas, Cesar Cantu.
 ***************************************************************************/
 
+#include "gc.h"
+
+#include "DifferentialGeometry.h"
+#include "Ray.h"
 #include "TShape.h"
 
 SO_NODE_ABSTRACT_SOURCE(TShape);
@@ -54,3 +58,48 @@ TShape::~TShape()
 {
 
 }
+
+/*!
+ * Computes to \a hit only the distance of the closest intersection of \a objectRay with the shape.
+ * Returns false if the ray does not intersect the shape.
+ *
+ * The ray tracer calls this function while it searches the closest surface. The shapes that can compute the
+ * intersection distance without the surface differential geometry reimplement it, and they can store in \a hit
+ * the intersected element or profile parameter that ComputeDifferentialGeometry needs.
+ */
+bool TShape::IntersectT( const Ray& objectRay, ShapeHit* hit ) const
+{
+	DifferentialGeometry dg;
+	return Intersect( objectRay, &hit->tHit, &dg );
+}
+
+/*!
+ * Computes to \a dg the differential geometry of the shape surface at the intersection \a hit of \a objectRay.
+ * \a hit must be computed with IntersectT for the same ray.
+ *
+ * The shapes reimplement this function to compute only the point, the parameters, the partial derivatives,
+ * the normal and the side of the hit. The normal derivatives are not used by the materials, so the shapes
+ * can leave them null. By default, the closest intersection of the ray is computed again with Intersect.
+ * The ray is not limited to the hit distance, because it is already the closest intersection and some shapes reject a hit at maxt.
+ */
+void TShape::ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& /*hit*/, DifferentialGeometry* dg ) const
+{
+	Ray hitRay( objectRay );
+	hitRay.maxt = gc::Infinity;
+
+	double thit = 0.0;
+	Intersect( hitRay, &thit, dg );
+}
+
+/*!
+ * Computes to \a cellAreas the area of the cells of a grid with \a heightDivisions x \a widthDivisions cells
+ * over the [0,1]x[0,1] parametric coordinates of the shape, transformed with \a objectToWorld.
+ *
+ * The shapes whose Sample does not follow the parametric coordinates of the hits, like the meshes, reimplement
+ * this function. Returns false if the shape does not compute the areas, so they are integrated from Sample.
+ */
+bool TShape::ComputeParametricAreas( const Transform& /*objectToWorld*/, int /*heightDivisions*/, int /*widthDivisions*/,
+		std::vector< double >* /*cellAreas*/ ) const
+{
+	return false;
+}
@@ -39,6 +39,8 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #ifndef TSHAPE_H_
 #define TSHAPE_H_
 
+#include <vector>
+
 #include <Inventor/nodes/SoShape.h>
 
 struct BBox;
@@ -47,6 +49,21 @@ struct NormalVector;
 struct Point3D;
 class QString;
 class Ray;
+class Transform;
+
+//!  ShapeHit is the closest intersection of a ray with a shape.
+/*!
+  Besides the intersection distance, the shapes can store the data that they use to compute the differential
+  geometry of the hit without searching it again: the intersected \a element of a mesh or a profile \a parameter.
+*/
+struct ShapeHit
+{
+	ShapeHit() : tHit( 0.0 ), parameter( 0.0 ), element( 0 ) {}
+
+	double tHit;
+	double parameter;
+	const void* element;
+};
 
 class TShape : public SoShape
 {
@@ -57,11 +74,15 @@ public:
 
 	virtual bool IntersectP( const Ray& objectRay ) const = 0;
 	virtual bool Intersect( const Ray& objectRay, double* tHit, DifferentialGeometry* dg ) const = 0;
+	virtual bool IntersectT( const Ray& objectRay, ShapeHit* hit ) const;
+	virtual void ComputeDifferentialGeometry( const Ray& objectRay, const ShapeHit& hit, DifferentialGeometry* dg ) const;
 	virtual double GetArea() const = 0;
 	virtual double GetVolume() const = 0;
 	virtual BBox GetBBox() const = 0;
 	virtual QString GetIcon() const = 0;
 	virtual Point3D Sample( double u, double v ) const = 0;
+	virtual bool ComputeParametricAreas( const Transform& objectToWorld, int heightDivisions, int widthDivisions,
+			std::vector< double >* cellAreas ) const;
 
 protected:
 	virtual void computeBBox(SoAction *action, SbBox3f &box, SbVec3f &center) = 0;
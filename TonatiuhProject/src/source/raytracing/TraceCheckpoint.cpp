@@ -0,0 +1,182 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+
+#include "TraceCheckpoint.h"
+
+namespace
+{
+	const qint32 CheckpointVersion = 1;
+
+	QString TemporaryFileName( const QString& fileName )
+	{
+		return ( fileName + QLatin1String( ".tmp" ) );
+	}
+}
+
+TraceCheckpoint::TraceCheckpoint()
+:randomSeed( -1 ),
+ randomSubstream( -1 ),
+ randomStreamPosition( 0 ),
+ randomReservedPaths( 0 ),
+ tracedRays( 0 ),
+ lastRay( 0 ),
+ checkpointRays( 0 ),
+ wPhoton( 0.0 )
+{
+
+}
+
+QString TraceCheckpoint::GetErrorMessage() const
+{
+	return m_errorMessage;
+}
+
+/*!
+ * Reads the checkpoint from \a fileName. If the file does not exist or it is not complete,
+ * the temporary file of an interrupted Write is read.
+ *
+ * Returns false if there is not a valid checkpoint.
+ */
+bool TraceCheckpoint::Read( QString fileName )
+{
+	if( ReadFile( fileName ) )	return true;
+
+	QString errorMessage = m_errorMessage;
+	if( QFile::exists( TemporaryFileName( fileName ) ) && ReadFile( TemporaryFileName( fileName ) ) )	return true;
+
+	m_errorMessage = errorMessage;
+	return false;
+}
+
+/*!
+ * Writes the checkpoint to \a fileName. The checkpoint is written to a temporary file that replaces the
+ * previous file once it is complete.
+ *
+ * Returns false if the file cannot be written.
+ */
+bool TraceCheckpoint::Write( QString fileName )
+{
+	QByteArray contents;
+	{
+		QDataStream out( &contents, QIODevice::WriteOnly );
+		out<<sceneKey<<randomDeviateName<<qint64( randomSeed )<<qint64( randomSubstream )
+			<<quint64( randomStreamPosition )<<quint64( randomReservedPaths )
+			<<quint64( tracedRays )<<quint64( lastRay )<<quint64( checkpointRays )<<wPhoton
+			<<exportModeName<<exportState;
+	}
+
+	QString temporaryFileName = TemporaryFileName( fileName );
+	QFile temporaryFile( temporaryFileName );
+	if( !temporaryFile.open( QIODevice::WriteOnly ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot open file %1." ) ).arg( temporaryFileName );
+		return false;
+	}
+
+	QDataStream out( &temporaryFile );
+	out<<QString( QLatin1String( "TonatiuhCheckpoint" ) )<<CheckpointVersion<<contents
+		<<QCryptographicHash::hash( contents, QCryptographicHash::Md5 );
+	temporaryFile.close();
+	if( out.status() != QDataStream::Ok || temporaryFile.error() != QFile::NoError )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot write file %1." ) ).arg( temporaryFileName );
+		return false;
+	}
+
+	if( ( QFile::exists( fileName ) && !QFile::remove( fileName ) ) || !QFile::rename( temporaryFileName, fileName ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot replace file %1." ) ).arg( fileName );
+		return false;
+	}
+	return true;
+}
+
+/*!
+ * Reads the checkpoint from \a fileName. Returns false if the file is not a complete checkpoint.
+ */
+bool TraceCheckpoint::ReadFile( QString fileName )
+{
+	QFile checkpointFile( fileName );
+	if( !checkpointFile.open( QIODevice::ReadOnly ) )
+	{
+		m_errorMessage = QString( QLatin1String( "Cannot open file %1." ) ).arg( fileName );
+		return false;
+	}
+	QDataStream in( &checkpointFile );
+
+	QString fileType;
+	qint32 version = 0;
+	QByteArray contents;
+	QByteArray checksum;
+	in>>fileType>>version>>contents>>checksum;
+	if( in.status() != QDataStream::Ok || fileType != QLatin1String( "TonatiuhCheckpoint" ) || version != CheckpointVersion ||
+			checksum != QCryptographicHash::hash( contents, QCryptographicHash::Md5 ) )
+	{
+		m_errorMessage = QString( QLatin1String( "The file %1 is not a valid checkpoint file." ) ).arg( fileName );
+		return false;
+	}
+
+	QDataStream contentsIn( contents );
+	qint64 seed = -1;
+	qint64 substream = -1;
+	quint64 streamPosition = 0;
+	quint64 reservedPaths = 0;
+	quint64 traced = 0;
+	quint64 last = 0;
+	quint64 interval = 0;
+	contentsIn>>sceneKey>>randomDeviateName>>seed>>substream>>streamPosition>>reservedPaths
+		>>traced>>last>>interval>>wPhoton>>exportModeName>>exportState;
+	if( contentsIn.status() != QDataStream::Ok || traced > last )
+	{
+		m_errorMessage = QString( QLatin1String( "The file %1 is not a valid checkpoint file." ) ).arg( fileName );
+		return false;
+	}
+
+	randomSeed = long( seed );
+	randomSubstream = long( substream );
+	randomStreamPosition = streamPosition;
+	randomReservedPaths = ( unsigned long ) reservedPaths;
+	tracedRays = ( unsigned long ) traced;
+	lastRay = ( unsigned long ) last;
+	checkpointRays = ( unsigned long ) interval;
+	return true;
+}
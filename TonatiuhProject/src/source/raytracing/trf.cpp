@@ -61,25 +61,77 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include "TShapeKit.h"
 
 
-SoSeparator* trf::DrawPhotonMapPoints( const TPhotonMap& map )
+/**
+ * Computes the vertices to represent the photons of \a map in the 3D view and stores them in \a vertices.
+ *
+ * If \a drawPhotons is true, the photon positions are stored as points. If \a drawRays is true, the positions of the
+ * photons of each ray are stored as a polyline. When the map has more than \a maximumPhotons photons, only one of
+ * each n photons or rays is stored, so the number of vertices of each representation is not larger than \a maximumPhotons.
+ * If \a maximumPhotons is zero, all the photons are stored.
+ *
+ * The function only reads the photon map and does not create any Coin node, so it can be called from a worker thread.
+ **/
+void trf::ComputePhotonMapVertices( const TPhotonMap* map, bool drawPhotons, bool drawRays, unsigned long maximumPhotons, trf::PhotonMapVertices* vertices )
 {
+	const std::vector< Photon* >& photonsList = map->GetAllPhotons();
+	unsigned long nPhotons = photonsList.size();
+	if( nPhotons < 1 )	return;
 
-	SoSeparator* drawpoints = new SoSeparator;
-	SoCoordinate3* points = new SoCoordinate3;
-	std::vector< Photon* > photonsList = map.GetAllPhotons();
-    unsigned int numRays=0;
+	unsigned long step = 1;
+	if( ( maximumPhotons > 0 ) && ( nPhotons > maximumPhotons ) )	step = ( nPhotons + maximumPhotons - 1 ) / maximumPhotons;
+
+	if( drawPhotons )
+	{
+		vertices->points.reserve( ( nPhotons + step - 1 ) / step );
+		for( unsigned long i = 0; i < nPhotons; i += step )
+		{
+			const Point3D& photon = photonsList[i]->pos;
+			vertices->points.push_back( SbVec3f( photon.x, photon.y, photon.z ) );
+		}
+	}
 
-	for( unsigned int i = 0; i < photonsList.size(); i++)
+	if( drawRays )
 	{
-		Point3D photon = photonsList[i]->pos;
-		points->point.set1Value( numRays, photon.x, photon.y, photon.z );
-		numRays++;
+		vertices->rayPoints.reserve( ( nPhotons + step - 1 ) / step );
+
+		unsigned long nRay = 0;
+		unsigned long photonIndex = 0;
+		while( photonIndex < nPhotons )
+		{
+			unsigned long rayStart = photonIndex;
+			do
+			{
+				photonIndex++;
+			}while( photonIndex < nPhotons && photonsList[photonIndex]->id > 0 );
+
+			if( ( nRay % step ) == 0 )
+			{
+				for( unsigned long i = rayStart; i < photonIndex; ++i )
+				{
+					const Point3D& photon = photonsList[i]->pos;
+					vertices->rayPoints.push_back( SbVec3f( photon.x, photon.y, photon.z ) );
+				}
+				vertices->rayLengths.push_back( photonIndex - rayStart );
+			}
+			nRay++;
+		}
 	}
+}
+
+/**
+ * Creates the node to represent the photons at \a points positions.
+ **/
+SoSeparator* trf::DrawPhotonMapPoints( const std::vector< SbVec3f >& points )
+{
+
+	SoSeparator* drawpoints = new SoSeparator;
+	SoCoordinate3* coordinates = new SoCoordinate3;
+	if( points.size() > 0 )	coordinates->point.setValues( 0, points.size(), &points[0] );
 
 	SoMaterial* myMaterial = new SoMaterial;
 	myMaterial->diffuseColor.setValue(1.0, 1.0, 0.0);
 	drawpoints->addChild(myMaterial);
-	drawpoints->addChild(points);
+	drawpoints->addChild(coordinates);
 
 	SoDrawStyle* drawstyle = new SoDrawStyle;
 	drawstyle->pointSize = 3;
@@ -92,51 +144,26 @@ SoSeparator* trf::DrawPhotonMapPoints( const TPhotonMap& map )
 
 }
 
-SoSeparator* trf::DrawPhotonMapRays( const TPhotonMap& map, unsigned long /*numberOfRays*/ )
+/**
+ * Creates the node to represent the rays. The vertices of each ray are consecutive in \a points and
+ * \a rayLengths has the number of vertices of each ray.
+ **/
+SoSeparator* trf::DrawPhotonMapRays( const std::vector< SbVec3f >& points, const std::vector< int32_t >& rayLengths )
 {
 
 	SoSeparator* drawrays = new SoSeparator;
-	SoCoordinate3* points = new SoCoordinate3;
-
-	QVector< int >	rayLengths;
-	std::vector< Photon* > allRaysLists = map.GetAllPhotons();
-
-
-	int nRay = 0;
-	unsigned int photonIndex = 0;
-	while( photonIndex < allRaysLists.size() )
-	{
-		unsigned long rayLength = 0;
-		do
-		{
-			Photon* photon = allRaysLists[photonIndex];
-			Point3D photonPosistion = photon->pos;
-			points->point.set1Value( photonIndex, photonPosistion.x, photonPosistion.y, photonPosistion.z );
-			photonIndex++;
-			rayLength++;
-		}while( photonIndex < allRaysLists.size() && allRaysLists[photonIndex]->id > 0 );
-
-
-		rayLengths.push_back( rayLength );
-		nRay++;
-
-	}
+	SoCoordinate3* coordinates = new SoCoordinate3;
+	if( points.size() > 0 )	coordinates->point.setValues( 0, points.size(), &points[0] );
 
 	SoMaterial* myMaterial = new SoMaterial;
 	myMaterial->diffuseColor.setValue(1.0f, 1.0f, 0.8f);
 	drawrays->addChild( myMaterial );
-	drawrays->addChild( points );
-
-	int* lines = new int[rayLengths.size()];
-	for( int l = 0; l < rayLengths.size(); l++ )
-		lines[l] =  rayLengths[l];
+	drawrays->addChild( coordinates );
 
 	SoLineSet* lineset = new SoLineSet;
-	lineset->numVertices.setValues( 0, rayLengths.size(), lines );
+	if( rayLengths.size() > 0 )	lineset->numVertices.setValues( 0, rayLengths.size(), &rayLengths[0] );
 	drawrays->addChild( lineset );
 
-
-	delete[] lines;
 	return drawrays;
 
 }
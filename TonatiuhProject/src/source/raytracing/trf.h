@@ -41,8 +41,12 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 
 #include <QMap>
 #include <QPair>
+#include <QSet>
 #include <QStringList>
+#include <QThreadPool>
+#include <QVector>
 
+#include <Inventor/SbVec3f.h>
 #include <Inventor/actions/SoGetBoundingBoxAction.h>
 #include <Inventor/actions/SoGetMatrixAction.h>
 #include <Inventor/nodes/SoTransform.h>
@@ -67,11 +71,21 @@ class TPhotonMap;
 namespace trf
 {
 	void ComputeSceneTreeMap( InstanceNode* instanceNode, Transform parentWTO, bool insertInSurfaceList );
-	void ComputeFistStageSurfaceList( InstanceNode* instanceNode, QStringList disabledNodesURL, QVector< QPair< TShapeKit*, Transform > >* surfacesList);
+	void ComputeFistStageSurfaceList( InstanceNode* instanceNode, const QSet< QString >& disabledNodesURL, QVector< QPair< TShapeKit*, Transform > >* surfacesList);
+	QVector< long > ComputeRaysPerThread( unsigned long numberOfRays, unsigned long raysPerChunk );
 	void CreatePhotonMap( TPhotonMap*& photonMap, QPair< TPhotonMap* ,  std::vector < Photon  > > photonsList );
 
-	SoSeparator* DrawPhotonMapPoints( const TPhotonMap& map);
-	SoSeparator* DrawPhotonMapRays( const TPhotonMap& map, unsigned long numberOfRays );
+	//! Vertices of the photon map representation in the 3D view.
+	struct PhotonMapVertices
+	{
+		std::vector< SbVec3f > points;
+		std::vector< SbVec3f > rayPoints;
+		std::vector< int32_t > rayLengths;
+	};
+
+	void ComputePhotonMapVertices( const TPhotonMap* map, bool drawPhotons, bool drawRays, unsigned long maximumPhotons, PhotonMapVertices* vertices );
+	SoSeparator* DrawPhotonMapPoints( const std::vector< SbVec3f >& points );
+	SoSeparator* DrawPhotonMapRays( const std::vector< SbVec3f >& points, const std::vector< int32_t >& rayLengths );
 	Transform GetObjectToWorld(SoPath* nodePath);
 }
 
@@ -151,7 +165,7 @@ inline void trf::ComputeSceneTreeMap( InstanceNode* instanceNode, Transform pare
 	}
 }
 
-inline void trf::ComputeFistStageSurfaceList( InstanceNode* instanceNode, QStringList disabledNodesURL, QVector< QPair< TShapeKit*, Transform > >* surfacesList)
+inline void trf::ComputeFistStageSurfaceList( InstanceNode* instanceNode, const QSet< QString >& disabledNodesURL, QVector< QPair< TShapeKit*, Transform > >* surfacesList)
 {
 	if( !instanceNode ) return;
 	if( disabledNodesURL.contains( instanceNode->GetNodeURL() ) )	return;
@@ -180,6 +194,44 @@ inline void trf::ComputeFistStageSurfaceList( InstanceNode* instanceNode, QStrin
 
 }
 
+/**
+ * Splits \a numberOfRays rays into the list of ray batches that are traced in parallel.
+ *
+ * If \a raysPerChunk is zero, the batch size is computed from the number of threads of the global thread pool.
+ * Each thread gets several batches to keep all the threads busy until the end of the ray tracing, and the
+ * batch size is limited to bound the size of the photons vector of each batch.
+ * The number of batches is also bounded, so a small \a raysPerChunk is enlarged for very long ray tracings.
+ **/
+inline QVector< long > trf::ComputeRaysPerThread( unsigned long numberOfRays, unsigned long raysPerChunk )
+{
+	QVector< long > raysPerThread;
+	if( numberOfRays < 1 )	return raysPerThread;
+
+	unsigned long chunkSize = raysPerChunk;
+	if( chunkSize < 1 )
+	{
+		const int chunksPerThread = 16;
+		const unsigned long minimumRaysPerChunk = 1000;
+		const unsigned long maximumRaysPerChunk = 100000;
+
+		int numberOfThreads = QThreadPool::globalInstance()->maxThreadCount();
+		if( numberOfThreads < 1 )	numberOfThreads = 1;
+
+		chunkSize = numberOfRays / ( numberOfThreads * chunksPerThread );
+		if( chunkSize < minimumRaysPerChunk )	chunkSize = minimumRaysPerChunk;
+		if( chunkSize > maximumRaysPerChunk )	chunkSize = maximumRaysPerChunk;
+	}
+
+	const unsigned long maximumNumberOfChunks = 1048576;
+	if( ( numberOfRays / chunkSize ) >= maximumNumberOfChunks )	chunkSize = numberOfRays / maximumNumberOfChunks + 1;
+
+	unsigned long numberOfChunks = numberOfRays / chunkSize;
+	raysPerThread.fill( long( chunkSize ), int( numberOfChunks ) );
+	if( ( numberOfChunks * chunkSize ) < numberOfRays )	raysPerThread<< ( numberOfRays - ( numberOfChunks * chunkSize ) );
+
+	return raysPerThread;
+}
+
 inline void trf::CreatePhotonMap( TPhotonMap*& photonMap, QPair< TPhotonMap* , std::vector< Photon >  > photonsList )
 {
 	if( !photonMap )  photonMap = photonsList.first;
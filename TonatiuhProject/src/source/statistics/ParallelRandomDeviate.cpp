@@ -44,7 +44,7 @@ ParallelRandomDeviate::ParallelRandomDeviate( RandomDeviate* rand,  QMutex* mute
 m_pRand( rand ),
 m_mutex( mutex )
 {
-
+	SetPathSampler( rand );
 }
 ParallelRandomDeviate::~ParallelRandomDeviate( )
 {
@@ -55,6 +55,17 @@ ParallelRandomDeviate::~ParallelRandomDeviate( )
 void ParallelRandomDeviate::FillArray( double* array, const unsigned long arraySize )
 {
 	m_mutex->lock();
-	m_pRand->FillArray( array, arraySize );
+	m_pRand->FillSharedArray( array, arraySize );
+	m_mutex->unlock();
+}
+
+/*!
+ * Reserves \a nPaths paths of the shared generator, so the paths of all the threads are different.
+ */
+unsigned long ParallelRandomDeviate::ReservePaths( unsigned long nPaths )
+{
+	m_mutex->lock();
+	unsigned long firstPath = m_pRand->ReservePaths( nPaths );
 	m_mutex->unlock();
+	return firstPath;
 }
@@ -54,6 +54,7 @@ public:
 	ParallelRandomDeviate( RandomDeviate* rand, QMutex* mutex, unsigned long arraySize = 100000, QObject* parent = 0 );
 	virtual ~ParallelRandomDeviate( );
     void FillArray( double* array, const unsigned long arraySize );
+    unsigned long ReservePaths( unsigned long nPaths );
 
 private:
     RandomDeviate* m_pRand;
@@ -0,0 +1,263 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include "Philox.h"
+
+namespace
+{
+	const unsigned int Multiplier0 = 0xD2511F53U;
+	const unsigned int Multiplier1 = 0xCD9E8D57U;
+	const unsigned int Weyl0 = 0x9E3779B9U;
+	const unsigned int Weyl1 = 0xBB67AE85U;
+	const int Rounds = 10;
+
+	const double UnsignedIntegerToDouble = 1.0 / 4294967296.0;
+
+	inline unsigned int Low( quint64 value ) { return ( static_cast< unsigned int >( value & 0xFFFFFFFFUL ) ); }
+	inline unsigned int High( quint64 value ) { return ( static_cast< unsigned int >( value >> 32 ) ); }
+}
+
+#if defined( __AVX2__ )
+
+#include <immintrin.h>
+
+namespace
+{
+	typedef __m256i PacketInt;
+	const int PacketWidth = 8;
+
+	inline PacketInt Set( unsigned int value ) { return ( _mm256_set1_epi32( static_cast< int >( value ) ) ); }
+	inline PacketInt Xor( PacketInt a, PacketInt b ) { return ( _mm256_xor_si256( a, b ) ); }
+	inline PacketInt Lanes( unsigned int first ) { return ( _mm256_add_epi32( Set( first ), _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ) ) ); }
+
+	//Low and high 32 bits of the 64 bits products of each lane
+	inline void MulHiLo( PacketInt a, PacketInt multiplier, PacketInt* hi, PacketInt* lo )
+	{
+		PacketInt even = _mm256_mul_epu32( a, multiplier );
+		PacketInt odd = _mm256_mul_epu32( _mm256_srli_epi64( a, 32 ), multiplier );
+		*lo = _mm256_blend_epi32( even, _mm256_slli_epi64( odd, 32 ), 0xAA );
+		*hi = _mm256_blend_epi32( _mm256_srli_epi64( even, 32 ), odd, 0xAA );
+	}
+
+	inline void Store( PacketInt value, double* numbers )
+	{
+		const __m256d offset = _mm256_set1_pd( 2147483648.5 );
+		const __m256d scale = _mm256_set1_pd( UnsignedIntegerToDouble );
+		PacketInt centered = Xor( value, Set( 0x80000000U ) );
+		__m256d low = _mm256_cvtepi32_pd( _mm256_castsi256_si128( centered ) );
+		__m256d high = _mm256_cvtepi32_pd( _mm256_extracti128_si256( centered, 1 ) );
+		_mm256_storeu_pd( numbers, _mm256_mul_pd( _mm256_add_pd( low, offset ), scale ) );
+		_mm256_storeu_pd( numbers + 4, _mm256_mul_pd( _mm256_add_pd( high, offset ), scale ) );
+	}
+}
+
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+
+#include <emmintrin.h>
+
+namespace
+{
+	typedef __m128i PacketInt;
+	const int PacketWidth = 4;
+
+	inline PacketInt Set( unsigned int value ) { return ( _mm_set1_epi32( static_cast< int >( value ) ) ); }
+	inline PacketInt Xor( PacketInt a, PacketInt b ) { return ( _mm_xor_si128( a, b ) ); }
+	inline PacketInt Lanes( unsigned int first ) { return ( _mm_add_epi32( Set( first ), _mm_setr_epi32( 0, 1, 2, 3 ) ) ); }
+
+	//Low and high 32 bits of the 64 bits products of each lane
+	inline void MulHiLo( PacketInt a, PacketInt multiplier, PacketInt* hi, PacketInt* lo )
+	{
+		const PacketInt lowMask = _mm_setr_epi32( -1, 0, -1, 0 );
+		PacketInt even = _mm_mul_epu32( a, multiplier );
+		PacketInt odd = _mm_mul_epu32( _mm_srli_epi64( a, 32 ), multiplier );
+		*lo = _mm_or_si128( _mm_and_si128( even, lowMask ), _mm_slli_epi64( odd, 32 ) );
+		*hi = _mm_or_si128( _mm_srli_epi64( even, 32 ), _mm_andnot_si128( lowMask, odd ) );
+	}
+
+	inline void Store( PacketInt value, double* numbers )
+	{
+		const __m128d offset = _mm_set1_pd( 2147483648.5 );
+		const __m128d scale = _mm_set1_pd( UnsignedIntegerToDouble );
+		PacketInt centered = Xor( value, Set( 0x80000000U ) );
+		__m128d low = _mm_cvtepi32_pd( centered );
+		__m128d high = _mm_cvtepi32_pd( _mm_shuffle_epi32( centered, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+		_mm_storeu_pd( numbers, _mm_mul_pd( _mm_add_pd( low, offset ), scale ) );
+		_mm_storeu_pd( numbers + 2, _mm_mul_pd( _mm_add_pd( high, offset ), scale ) );
+	}
+}
+
+#else
+
+//Without SIMD instructions the blocks of a group are generated one at a time.
+namespace
+{
+	typedef unsigned int PacketInt;
+	const int PacketWidth = 1;
+
+	inline PacketInt Set( unsigned int value ) { return ( value ); }
+	inline PacketInt Xor( PacketInt a, PacketInt b ) { return ( a ^ b ); }
+	inline PacketInt Lanes( unsigned int first ) { return ( first ); }
+
+	inline void MulHiLo( PacketInt a, PacketInt multiplier, PacketInt* hi, PacketInt* lo )
+	{
+		unsigned long long product = static_cast< unsigned long long >( a ) * multiplier;
+		*lo = static_cast< unsigned int >( product );
+		*hi = static_cast< unsigned int >( product >> 32 );
+	}
+
+	inline void Store( PacketInt value, double* numbers ) { *numbers = ( value + 0.5 ) * UnsignedIntegerToDouble; }
+}
+
+#endif
+
+
+/*!
+ * Creates a generator for the \a stream of the \a seed.
+ */
+Philox::Philox( unsigned long seed, unsigned long stream )
+:m_seed( 0 ),
+ m_stream( 0 )
+{
+	SetSeed( seed );
+	SetStream( stream );
+}
+
+/*!
+ * Sets the key of the generator to \a seed.
+ */
+void Philox::SetSeed( unsigned long seed )
+{
+	m_seed = seed;
+	m_key[0] = Low( seed );
+	m_key[1] = High( seed );
+}
+
+/*!
+ * Sets the stream of the generator to \a stream. Each stream has 2^68 numbers.
+ */
+void Philox::SetStream( unsigned long stream )
+{
+	m_stream = stream;
+	m_streamCounter[0] = Low( stream );
+	m_streamCounter[1] = High( stream );
+}
+
+/*!
+ * Fills \a numbers with the Philox::GroupSize numbers of the \a group of the stream, between 0 and 1.
+ * The group starts at the number \a group * Philox::GroupSize of the stream.
+ */
+void Philox::GenerateGroup( quint64 group, double* numbers ) const
+{
+	//The first two words of the counter are the 64 bits index of the block
+	quint64 firstBlock = group * GroupBlocks;
+
+	for( int first = 0; first < GroupBlocks; first += PacketWidth )
+	{
+		quint64 block = firstBlock + first;
+
+		//The first block of a group is a multiple of GroupBlocks, so the blocks of a group have the same high word
+		PacketInt c0 = Lanes( Low( block ) );
+		PacketInt c1 = Set( High( block ) );
+		PacketInt c2 = Set( m_streamCounter[0] );
+		PacketInt c3 = Set( m_streamCounter[1] );
+		unsigned int k0 = m_key[0];
+		unsigned int k1 = m_key[1];
+
+		const PacketInt multiplier0 = Set( Multiplier0 );
+		const PacketInt multiplier1 = Set( Multiplier1 );
+		for( int round = 0; round < Rounds; ++round )
+		{
+			PacketInt hi0, lo0, hi1, lo1;
+			MulHiLo( c0, multiplier0, &hi0, &lo0 );
+			MulHiLo( c2, multiplier1, &hi1, &lo1 );
+
+			c0 = Xor( Xor( hi1, c1 ), Set( k0 ) );
+			c1 = lo1;
+			c2 = Xor( Xor( hi0, c3 ), Set( k1 ) );
+			c3 = lo0;
+
+			k0 += Weyl0;
+			k1 += Weyl1;
+		}
+
+		Store( c0, numbers + first );
+		Store( c1, numbers + GroupBlocks + first );
+		Store( c2, numbers + 2 * GroupBlocks + first );
+		Store( c3, numbers + 3 * GroupBlocks + first );
+	}
+}
+
+/*!
+ * Computes in \a output the four numbers of the block with the \a counter and \a key.
+ */
+void Philox::Block( const unsigned int counter[4], const unsigned int key[2], unsigned int output[4] )
+{
+	unsigned int c0 = counter[0];
+	unsigned int c1 = counter[1];
+	unsigned int c2 = counter[2];
+	unsigned int c3 = counter[3];
+	unsigned int k0 = key[0];
+	unsigned int k1 = key[1];
+
+	for( int round = 0; round < Rounds; ++round )
+	{
+		unsigned long long product0 = static_cast< unsigned long long >( Multiplier0 ) * c0;
+		unsigned long long product1 = static_cast< unsigned long long >( Multiplier1 ) * c2;
+
+		c0 = static_cast< unsigned int >( product1 >> 32 ) ^ c1 ^ k0;
+		c1 = static_cast< unsigned int >( product1 );
+		c2 = static_cast< unsigned int >( product0 >> 32 ) ^ c3 ^ k1;
+		c3 = static_cast< unsigned int >( product0 );
+
+		k0 += Weyl0;
+		k1 += Weyl1;
+	}
+
+	output[0] = c0;
+	output[1] = c1;
+	output[2] = c2;
+	output[3] = c3;
+}
+
+/*!
+ * Returns the 32 bits \a value as a number between 0 and 1, that is never 0 or 1.
+ */
+double Philox::ToDouble( unsigned int value )
+{
+	return ( ( value + 0.5 ) * UnsignedIntegerToDouble );
+}
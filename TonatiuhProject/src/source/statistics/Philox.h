@@ -0,0 +1,80 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#ifndef PHILOX_H_
+#define PHILOX_H_
+
+#include <QtGlobal>
+
+//!  Philox is the Philox4x32-10 counter based random generator of Salmon et al.
+/*!
+  Each number of the generator is a function of its key and its position, so any number of any stream is
+  computed directly, without generating the previous ones. The key is the seed of the generator and the
+  counter of each block of four numbers has the index of the block and the stream.
+
+  The blocks are generated in groups of GroupBlocks consecutive blocks, one block in each lane of the SSE2
+  or AVX2 registers. The numbers of a group are stored first the first number of each block, then the second
+  number of each block and so on, so the numbers of a stream are the same with and without SIMD instructions.
+*/
+
+class Philox
+{
+
+public:
+	enum { GroupBlocks = 8, GroupSize = 4 * GroupBlocks };
+
+	explicit Philox( unsigned long seed = 0, unsigned long stream = 0 );
+
+	unsigned long GetSeed() const { return ( m_seed ); }
+	unsigned long GetStream() const { return ( m_stream ); }
+	void SetSeed( unsigned long seed );
+	void SetStream( unsigned long stream );
+
+	void GenerateGroup( quint64 group, double* numbers ) const;
+
+	static void Block( const unsigned int counter[4], const unsigned int key[2], unsigned int output[4] );
+	static double ToDouble( unsigned int value );
+
+private:
+	unsigned long m_seed;
+	unsigned long m_stream;
+	unsigned int m_key[2];
+	unsigned int m_streamCounter[2];
+};
+
+#endif /* PHILOX_H_ */
@@ -39,9 +39,17 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #ifndef RANDOMDEVIATE_H_
 #define RANDOMDEVIATE_H_
 
+#include <QtGlobal>
+
 //!  RandomDeviate is the base class for random generators.
 /*!
   A random generator class can be written based on this class.
+
+  A generator can also be a path sampler, like the low discrepancy sequences. A path sampler computes the
+  number of each dimension of each traced path instead of a single stream of numbers. The ray tracer starts
+  each path with StartPath and sets the first dimension of each stage of the path with SetPathDimension,
+  so each stage always takes the same dimensions. The generators that are not path samplers ignore the
+  path and dimension and provide the numbers of their stream.
 */
 
 class RandomDeviate
@@ -53,16 +61,51 @@ public:
     unsigned long NumbersGenerated( ) const;
     unsigned long NumbersProvided( ) const;
     double RandomDouble( );
-  
+    void FillSharedArray( double* array, const unsigned long arraySize );
+    quint64 StreamPosition( ) const;
+    void Skip( quint64 nNumbers );
+    virtual bool SetSeed( unsigned long seed );
+    virtual bool SetSubstream( unsigned long substream );
+    virtual bool SetOffset( quint64 offset );
+
+    virtual bool IsPathSampler( ) const;
+    virtual double PathSample( unsigned long path, unsigned int dimension ) const;
+    virtual unsigned long ReservePaths( unsigned long nPaths );
+    unsigned long ReservedPaths( ) const;
+    void StartPath( unsigned long path, unsigned int dimension = 0 );
+    void SetPathDimension( unsigned int dimension );
+
+    //! First dimension of each stage of a traced path.
+    enum PathDimension
+    {
+    	LightDimension = 0,
+    	SunShapeDimension = 4,
+    	FirstSurfaceDimension = 8,
+    	SurfaceDimensions = 8
+    };
+
+protected:
+    void ClearArray( );
+    void ClearPaths( );
+    void SetPathSampler( const RandomDeviate* sampler );
+
 private:
      const unsigned long m_arraySize;
      double* m_randomNumber;
      unsigned long m_numbersGenerated;
      unsigned long m_nextRandomNumber;
+     quint64 m_streamPosition;
+
+     const RandomDeviate* m_pPathSampler;
+     bool m_isPathStarted;
+     unsigned long m_path;
+     unsigned int m_pathDimension;
+     unsigned long m_reservedPaths;
 };     
 
 inline RandomDeviate::RandomDeviate( const unsigned long arraySize )
-: m_arraySize(arraySize), m_randomNumber(0), m_numbersGenerated(0), m_nextRandomNumber(arraySize)
+: m_arraySize(arraySize), m_randomNumber(0), m_numbersGenerated(0), m_nextRandomNumber(arraySize), m_streamPosition(0),
+  m_pPathSampler(0), m_isPathStarted(false), m_path(0), m_pathDimension(0), m_reservedPaths(0)
 {
 	m_randomNumber = new double[arraySize];
 }
@@ -74,15 +117,161 @@ inline RandomDeviate::~RandomDeviate( )
 
 inline double RandomDeviate::RandomDouble( )
 {
+	if( m_isPathStarted )	return m_pPathSampler->PathSample( m_path, m_pathDimension++ );
+
 	if( m_nextRandomNumber >= m_arraySize  )
 	{
 		m_nextRandomNumber = 0;
 		FillArray( m_randomNumber, m_arraySize );
 		m_numbersGenerated += m_arraySize;
+		m_streamPosition += m_arraySize;
 	}
 	return m_randomNumber[m_nextRandomNumber++];
 }
 
+/*!
+ * Fills \a array with the next \a arraySize numbers of the stream for the generators that share this generator,
+ * like ParallelRandomDeviate. The numbers are counted in the stream position.
+ */
+inline void RandomDeviate::FillSharedArray( double* array, const unsigned long arraySize )
+{
+	FillArray( array, arraySize );
+	m_streamPosition += arraySize;
+}
+
+/*!
+ * Returns the number of numbers taken from the stream since the generator was created,
+ * including the numbers of the buffer that are not yet provided.
+ */
+inline quint64 RandomDeviate::StreamPosition( ) const
+{
+	return m_streamPosition;
+}
+
+/*!
+ * Moves the stream \a nNumbers numbers ahead and discards the numbers of the buffer. The generators
+ * that can skip ahead move with SetOffset, the other generators generate and discard the numbers.
+ */
+inline void RandomDeviate::Skip( quint64 nNumbers )
+{
+	if( !SetOffset( m_streamPosition + nNumbers ) )
+	{
+		quint64 toDiscard = nNumbers;
+		while( toDiscard > 0 )
+		{
+			unsigned long discarded = ( toDiscard < m_arraySize ) ? (unsigned long) toDiscard : m_arraySize;
+			FillArray( m_randomNumber, discarded );
+			toDiscard -= discarded;
+		}
+	}
+
+	ClearArray();
+	m_streamPosition += nNumbers;
+}
+
+/*!
+ * Restarts the generator from \a seed. Returns false if the generator can not be seeded.
+ */
+inline bool RandomDeviate::SetSeed( unsigned long /*seed*/ )
+{
+	return false;
+}
+
+/*!
+ * Moves the generator to the start of its independent substream number \a substream.
+ * Returns false if the generator does not provide substreams.
+ */
+inline bool RandomDeviate::SetSubstream( unsigned long /*substream*/ )
+{
+	return false;
+}
+
+/*!
+ * Moves the generator to the number \a offset of its current substream, without generating the previous numbers.
+ * Returns false if the generator can not skip ahead.
+ */
+inline bool RandomDeviate::SetOffset( quint64 /*offset*/ )
+{
+	return false;
+}
+
+/*!
+ * Returns true if the generator computes the numbers of each path dimension with PathSample.
+ */
+inline bool RandomDeviate::IsPathSampler( ) const
+{
+	return false;
+}
+
+/*!
+ * Returns the number of the \a dimension of the \a path. Only the path samplers reimplement this function,
+ * and it must be thread safe, because the threads of the ray tracer call it without locking the generator.
+ */
+inline double RandomDeviate::PathSample( unsigned long /*path*/, unsigned int /*dimension*/ ) const
+{
+	return 0.0;
+}
+
+/*!
+ * Reserves \a nPaths consecutive paths and returns the index of the first one.
+ */
+inline unsigned long RandomDeviate::ReservePaths( unsigned long nPaths )
+{
+	unsigned long firstPath = m_reservedPaths;
+	m_reservedPaths += nPaths;
+	return firstPath;
+}
+
+/*!
+ * Returns the number of paths reserved.
+ */
+inline unsigned long RandomDeviate::ReservedPaths( ) const
+{
+	return m_reservedPaths;
+}
+
+/*!
+ * Starts the \a path at its \a dimension. If there is a path sampler, the next numbers are the consecutive dimensions of the path.
+ */
+inline void RandomDeviate::StartPath( unsigned long path, unsigned int dimension )
+{
+	m_isPathStarted = ( m_pPathSampler != 0 );
+	m_path = path;
+	m_pathDimension = dimension;
+}
+
+/*!
+ * Sets the \a dimension of the current path for the next number.
+ */
+inline void RandomDeviate::SetPathDimension( unsigned int dimension )
+{
+	m_pathDimension = dimension;
+}
+
+/*!
+ * Discards the numbers already generated and not yet provided.
+ */
+inline void RandomDeviate::ClearArray( )
+{
+	m_nextRandomNumber = m_arraySize;
+}
+
+/*!
+ * Restarts the reserved paths from the first path.
+ */
+inline void RandomDeviate::ClearPaths( )
+{
+	m_reservedPaths = 0;
+}
+
+/*!
+ * Sets the generator that computes the path numbers after StartPath to \a sampler.
+ */
+inline void RandomDeviate::SetPathSampler( const RandomDeviate* sampler )
+{
+	m_pPathSampler = ( sampler && sampler->IsPathSampler() ) ? sampler : 0;
+}
+
 inline unsigned long RandomDeviate::NumbersGenerated( ) const
 {
 	return m_numbersGenerated;
@@ -20,7 +20,7 @@ DEPENDPATH += . \
               
  
               
-QT += xml opengl svg  script 
+QT += xml opengl svg  script network
 greaterThan(QT_MAJOR_VERSION, 4) {
     QT += concurrent printsupport 
 } 
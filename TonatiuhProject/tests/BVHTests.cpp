@@ -0,0 +1,131 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "BVH.h"
+#include "Point3D.h"
+#include "Ray.h"
+#include "Triangle.h"
+#include "Vector3D.h"
+
+//! Mesh of parallel layers at y = 1, 2, ... with a grid of triangles in each layer.
+class LayersMesh
+{
+public:
+	LayersMesh( int nLayers, int divisions )
+	{
+		for( int l = 1; l <= nLayers; ++l )
+			for( int i = 0; i <= divisions; ++i )
+				for( int j = 0; j <= divisions; ++j )
+					vertices.push_back( Point3D( -1.0 + 2.0 * i / divisions, l, -1.0 + 2.0 * j / divisions ) );
+
+		int layerVertices = ( divisions + 1 ) * ( divisions + 1 );
+		for( int l = 0; l < nLayers; ++l )
+		{
+			for( int i = 0; i < divisions; ++i )
+			{
+				for( int j = 0; j < divisions; ++j )
+				{
+					int v = l * layerVertices + i * ( divisions + 1 ) + j;
+					triangles.push_back( new Triangle( &vertices[0], v, v + divisions + 1, v + 1 ) );
+					triangles.push_back( new Triangle( &vertices[0], v + 1, v + divisions + 1, v + divisions + 2 ) );
+				}
+			}
+		}
+	}
+
+	~LayersMesh()
+	{
+		for( unsigned int t = 0; t < triangles.size(); ++t )
+			delete triangles[t];
+	}
+
+	std::vector< Point3D > vertices;
+	std::vector< Triangle* > triangles;
+};
+
+static double RandomValue( double min, double max )
+{
+	return min + ( max - min ) * rand() / RAND_MAX;
+}
+
+TEST( BVHTests, IntersectPMatchesIntersect )
+{
+	LayersMesh mesh( 5, 8 );
+	BVH bvh( &mesh.triangles, 1 );
+
+	srand( 17 );
+	int nHits = 0;
+	for( int r = 0; r < 2000; ++r )
+	{
+		Point3D origin( RandomValue( -2.0, 2.0 ), RandomValue( -1.0, 7.0 ), RandomValue( -2.0, 2.0 ) );
+		Vector3D direction( RandomValue( -1.0, 1.0 ), RandomValue( -1.0, 1.0 ), RandomValue( -1.0, 1.0 ) );
+		Ray ray( origin, Normalize( direction ), 0.0001, RandomValue( 0.5, 6.0 ) );
+
+		double tHit = ray.maxt;
+		const Triangle* triangle = 0;
+		bool isHit = bvh.Intersect( ray, &tHit, &triangle );
+		EXPECT_EQ( isHit, bvh.IntersectP( ray ) );
+		if( isHit )	nHits++;
+	}
+	EXPECT_GT( nHits, 100 );
+}
+
+TEST( BVHTests, IntersectPTestsOnlyTheRaySegment )
+{
+	LayersMesh mesh( 5, 8 );
+	BVH bvh( &mesh.triangles );
+
+	Point3D origin( 0.1, 0.0, 0.3 );
+	Vector3D up( 0.0, 1.0, 0.0 );
+
+	//The traversal can finish at any layer of the segment
+	EXPECT_TRUE( bvh.IntersectP( Ray( origin, up ) ) );
+	EXPECT_TRUE( bvh.IntersectP( Ray( origin, up, 0.0001, 1.5 ) ) );
+	EXPECT_TRUE( bvh.IntersectP( Ray( origin, up, 2.5, 3.5 ) ) );
+
+	//The layers before mint and after maxt are not hit
+	EXPECT_FALSE( bvh.IntersectP( Ray( origin, up, 0.0001, 0.5 ) ) );
+	EXPECT_FALSE( bvh.IntersectP( Ray( origin, up, 2.2, 2.8 ) ) );
+	EXPECT_FALSE( bvh.IntersectP( Ray( origin, up, 5.5, 10.0 ) ) );
+	EXPECT_FALSE( bvh.IntersectP( Ray( Point3D( 1.5, 0.0, 0.0 ), up ) ) );
+}
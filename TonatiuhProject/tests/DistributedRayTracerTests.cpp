@@ -0,0 +1,177 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <QDataStream>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+#include "DistributedRayTracer.h"
+
+#include "TestsAuxiliaryFunctions.h"
+
+//Writes the photon map parameters file of a worker with the \a surfacesURL and the power per photon \a wPhoton
+static void WriteWorkerParameters( const QString& fileName, const QStringList& surfacesURL, double wPhoton )
+{
+	QFile parametersFile( fileName );
+	ASSERT_TRUE( parametersFile.open( QIODevice::WriteOnly ) );
+	QTextStream out( &parametersFile );
+	out<<"START PARAMETERS\nid\nprevious ID\nnext ID\nsurface ID\nEND PARAMETERS\n";
+	out<<"START SURFACES\n";
+	for( int s = 0; s < surfacesURL.count(); ++s )
+		out<<QString( QLatin1String( "%1 %2\n" ) ).arg( QString::number( s + 1 ), surfacesURL[s] );
+	out<<"END SURFACES\n";
+	out<<wPhoton;
+}
+
+static void WritePhotons( const QString& fileName, const double* values, int nValues )
+{
+	QFile photonsFile( fileName );
+	ASSERT_TRUE( photonsFile.open( QIODevice::WriteOnly ) );
+	QDataStream out( &photonsFile );
+	for( int v = 0; v < nValues; ++v )
+		out<<values[v];
+}
+
+static QVector< double > ReadPhotons( const QString& fileName )
+{
+	QVector< double > values;
+	QFile photonsFile( fileName );
+	if( !photonsFile.open( QIODevice::ReadOnly ) )	return values;
+	QDataStream in( &photonsFile );
+	while( !in.atEnd() )
+	{
+		double value;
+		in>>value;
+		values.push_back( value );
+	}
+	return values;
+}
+
+static QString ReadText( const QString& fileName )
+{
+	QFile textFile( fileName );
+	if( !textFile.open( QIODevice::ReadOnly | QIODevice::Text ) )	return QString();
+	return QTextStream( &textFile ).readAll();
+}
+
+TEST( DistributedRayTracerTests, PartitionsRays )
+{
+	taf::TemporaryDirectory directory;
+	DistributedRayTracer distributedRayTracer( QLatin1String( "tonatiuh" ), directory.Path(), 3 );
+	distributedRayTracer.SetNumberOfRays( 200 );
+	EXPECT_EQ( 67UL, distributedRayTracer.GetWorkerRays( 0 ) );
+	EXPECT_EQ( 67UL, distributedRayTracer.GetWorkerRays( 1 ) );
+	EXPECT_EQ( 66UL, distributedRayTracer.GetWorkerRays( 2 ) );
+	EXPECT_EQ( QString( "worker_2" ), distributedRayTracer.GetWorkerName( 2 ) );
+}
+
+TEST( DistributedRayTracerTests, WorkerScriptsUseTheWorkerName )
+{
+	taf::TemporaryDirectory directory;
+	DistributedRayTracer distributedRayTracer( directory.FilePath( "missing_executable" ), directory.Path(), 2 );
+	distributedRayTracer.SetModelFileName( directory.FilePath( "model.tnh" ) );
+	distributedRayTracer.SetNumberOfRays( 200 );
+
+	//The workers do not start, but their scripts are written
+	EXPECT_FALSE( distributedRayTracer.RunWorkers( QLatin1String( "tonatiuh.SetExportTypeParameterValue( \"ExportFile\", \"%2\" );\n" ) ) );
+
+	for( int w = 0; w < 2; ++w )
+	{
+		QString script = ReadText( directory.FilePath( QString( QLatin1String( "worker_%1.tnhs" ) ).arg( w ) ) );
+		EXPECT_TRUE( script.contains( QString( QLatin1String( "SetRaysPerIteration( 100 );" ) ) ) );
+		EXPECT_TRUE( script.contains( QString( QLatin1String( "\"ExportFile\", \"worker_%1\"" ) ).arg( w ) ) );
+		EXPECT_FALSE( script.contains( QLatin1String( "\"100\"" ) ) );
+	}
+}
+
+TEST( DistributedRayTracerTests, MergesPhotonMapsOfEqualWorkers )
+{
+	taf::TemporaryDirectory directory;
+	DistributedRayTracer distributedRayTracer( QLatin1String( "tonatiuh" ), directory.Path(), 2 );
+	distributedRayTracer.SetNumberOfRays( 200 );
+	ASSERT_EQ( distributedRayTracer.GetWorkerRays( 0 ), distributedRayTracer.GetWorkerRays( 1 ) );
+
+	//Photons: id, previous ID, next ID, surface ID
+	WriteWorkerParameters( directory.FilePath( "worker_0_parameters.txt" ), QStringList()<<"//Field/A"<<"//Field/B", 0.5 );
+	double workerPhotons0[8] = { 1.0, 0.0, 2.0, 1.0,
+			2.0, 1.0, 0.0, 2.0 };
+	WritePhotons( directory.FilePath( "worker_0.dat" ), workerPhotons0, 8 );
+
+	WriteWorkerParameters( directory.FilePath( "worker_1_parameters.txt" ), QStringList()<<"//Field/B", 0.5 );
+	double workerPhotons1[8] = { 1.0, 0.0, 2.0, 1.0,
+			2.0, 1.0, 0.0, 0.0 };
+	WritePhotons( directory.FilePath( "worker_1.dat" ), workerPhotons1, 8 );
+
+	ASSERT_TRUE( distributedRayTracer.MergePhotonMapFiles( QLatin1String( "merged" ) ) );
+
+	//The second worker photons are renumbered and its surface is mapped to the merged surfaces list
+	double expectedPhotons[16] = { 1.0, 0.0, 2.0, 1.0,
+			2.0, 1.0, 0.0, 2.0,
+			3.0, 0.0, 4.0, 2.0,
+			4.0, 3.0, 0.0, 0.0 };
+	QVector< double > mergedPhotons = ReadPhotons( directory.FilePath( "merged.dat" ) );
+	ASSERT_EQ( 16, mergedPhotons.size() );
+	for( int v = 0; v < 16; ++v )
+		EXPECT_DOUBLE_EQ( expectedPhotons[v], mergedPhotons[v] );
+
+	QStringList parameters = ReadText( directory.FilePath( "merged_parameters.txt" ) ).split( QLatin1Char( '\n' ) );
+	ASSERT_EQ( 11, parameters.size() );
+	EXPECT_EQ( QString( "surface ID" ), parameters[4] );
+	EXPECT_EQ( QString( "1 //Field/A" ), parameters[7] );
+	EXPECT_EQ( QString( "2 //Field/B" ), parameters[8] );
+	EXPECT_DOUBLE_EQ( 0.25, parameters[10].toDouble() );
+}
+
+TEST( DistributedRayTracerTests, MissingWorkerPhotonsAreAnError )
+{
+	taf::TemporaryDirectory directory;
+	DistributedRayTracer distributedRayTracer( QLatin1String( "tonatiuh" ), directory.Path(), 2 );
+	distributedRayTracer.SetNumberOfRays( 200 );
+
+	double workerPhotons[4] = { 1.0, 0.0, 0.0, 1.0 };
+	for( int w = 0; w < 2; ++w )
+		WriteWorkerParameters( directory.FilePath( QString( QLatin1String( "worker_%1_parameters.txt" ) ).arg( w ) ), QStringList()<<"//Field/A", 0.5 );
+	WritePhotons( directory.FilePath( "worker_0.dat" ), workerPhotons, 4 );
+
+	EXPECT_FALSE( distributedRayTracer.MergePhotonMapFiles( QLatin1String( "merged" ) ) );
+	EXPECT_TRUE( distributedRayTracer.GetErrorMessage().contains( QLatin1String( "worker_1.dat" ) ) );
+}
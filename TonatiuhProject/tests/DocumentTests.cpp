@@ -0,0 +1,195 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <Inventor/SoOutput.h>
+#include <Inventor/nodekits/SoNodeKitListPart.h>
+
+#include <QFile>
+
+#include "Document.h"
+#include "TDefaultMaterial.h"
+#include "TSceneKit.h"
+#include "TSeparatorKit.h"
+#include "TShapeKit.h"
+#include "TSquare.h"
+
+#include "TestsAuxiliaryFunctions.h"
+
+//Returns true if the Coin library can write files with the compression \a method
+static bool IsCompressionAvailable( const char* method )
+{
+	unsigned int nMethods = 0;
+	const SbName* methods = SoOutput::getAvailableCompressionMethods( nMethods );
+	for( unsigned int m = 0; m < nMethods; ++m )
+		if( methods[m] == method )	return true;
+	return false;
+}
+
+static QByteArray ReadContents( const QString& fileName )
+{
+	QFile file( fileName );
+	if( !file.open( QIODevice::ReadOnly ) )	return QByteArray();
+	return file.readAll();
+}
+
+//Scene with a group node and a square with the default material
+static void CreateScene( Document& document )
+{
+	document.New();
+
+	TSeparatorKit* separatorKit = new TSeparatorKit;
+	separatorKit->setName( "Heliostat" );
+	SoNodeKitListPart* sceneChildList = static_cast< SoNodeKitListPart* >( document.GetSceneKit()->getPart( "childList", true ) );
+	sceneChildList->addChild( separatorKit );
+
+	TShapeKit* shapeKit = new TShapeKit;
+	shapeKit->setName( "Mirror" );
+	SoNodeKitListPart* childList = static_cast< SoNodeKitListPart* >( separatorKit->getPart( "childList", true ) );
+	childList->addChild( shapeKit );
+
+	TSquare* square = new TSquare;
+	square->m_sideLength.setValue( 2.5 );
+	shapeKit->setPart( "shape", square );
+	shapeKit->setPart( "material", new TDefaultMaterial );
+}
+
+//Writes the scene in the \a format, reads it and writes it again in ASCII format
+static QByteArray ASCIIRoundTrip( Document::FileFormat format, const QString& fileName, const QString& asciiFileName )
+{
+	Document document;
+	CreateScene( document );
+	document.SetFileFormat( format );
+	if( !document.WriteFile( fileName ) )	return QByteArray();
+
+	Document readDocument;
+	if( !readDocument.ReadFile( fileName ) )	return QByteArray();
+	readDocument.SetFileFormat( Document::ASCIIFormat );
+	if( !readDocument.WriteFile( asciiFileName ) )	return QByteArray();
+	return ReadContents( asciiFileName );
+}
+
+TEST( DocumentTests, ASCIIIsDefaultFormat )
+{
+	taf::TemporaryDirectory directory;
+	Document document;
+	EXPECT_EQ( Document::ASCIIFormat, document.GetFileFormat() );
+
+	QString fileName = directory.FilePath( "ascii.tnh" );
+	CreateScene( document );
+	ASSERT_TRUE( document.WriteFile( fileName ) );
+	EXPECT_TRUE( ReadContents( fileName ).startsWith( "#Inventor V2.1 ascii" ) );
+	EXPECT_GE( document.GetWriteTime(), 0.0 );
+}
+
+TEST( DocumentTests, BinaryRoundTrip )
+{
+	taf::TemporaryDirectory directory;
+	QString asciiFileName = directory.FilePath( "ascii.tnh" );
+	QString fileName = directory.FilePath( "binary.tnh" );
+	QString roundTripFileName = directory.FilePath( "binary_ascii.tnh" );
+
+	QByteArray ascii = ASCIIRoundTrip( Document::ASCIIFormat, asciiFileName, roundTripFileName );
+	ASSERT_FALSE( ascii.isEmpty() );
+
+	QByteArray binaryRoundTrip = ASCIIRoundTrip( Document::BinaryFormat, fileName, roundTripFileName );
+	EXPECT_TRUE( ReadContents( fileName ).startsWith( "#Inventor V2.1 binary" ) );
+	EXPECT_EQ( ascii, binaryRoundTrip );
+}
+
+TEST( DocumentTests, CompressedBinaryRoundTrip )
+{
+	taf::TemporaryDirectory directory;
+	QString asciiFileName = directory.FilePath( "ascii.tnh" );
+	QString fileName = directory.FilePath( "compressed.tnh" );
+	QString roundTripFileName = directory.FilePath( "compressed_ascii.tnh" );
+
+	QByteArray ascii = ASCIIRoundTrip( Document::ASCIIFormat, asciiFileName, roundTripFileName );
+	ASSERT_FALSE( ascii.isEmpty() );
+
+	//Without compression support in Coin, the file is written in binary format
+	QByteArray compressedRoundTrip = ASCIIRoundTrip( Document::CompressedBinaryFormat, fileName, roundTripFileName );
+	if( IsCompressionAvailable( "GZIP" ) )
+		EXPECT_TRUE( ReadContents( fileName ).startsWith( "\x1f\x8b" ) );
+	else
+		EXPECT_TRUE( ReadContents( fileName ).startsWith( "#Inventor V2.1 binary" ) );
+	EXPECT_EQ( ascii, compressedRoundTrip );
+}
+
+TEST( DocumentTests, ReadFileKeepsTheFileFormat )
+{
+	taf::TemporaryDirectory directory;
+	QString fileName = directory.FilePath( "format.tnh" );
+
+	Document::FileFormat formats[3] = { Document::BinaryFormat, Document::ASCIIFormat, Document::CompressedBinaryFormat };
+	for( int f = 0; f < 3; ++f )
+	{
+		//Without compression support in Coin, the compressed files are written in binary format
+		Document::FileFormat expectedFormat = formats[f];
+		if( ( expectedFormat == Document::CompressedBinaryFormat ) && !IsCompressionAvailable( "GZIP" ) )
+			expectedFormat = Document::BinaryFormat;
+
+		Document document;
+		CreateScene( document );
+		document.SetFileFormat( formats[f] );
+		ASSERT_TRUE( document.WriteFile( fileName ) );
+
+		Document readDocument;
+		ASSERT_TRUE( readDocument.ReadFile( fileName ) );
+		EXPECT_EQ( expectedFormat, readDocument.GetFileFormat() );
+	}
+}
+
+TEST( DocumentTests, NewSceneIsASCII )
+{
+	taf::TemporaryDirectory directory;
+	QString fileName = directory.FilePath( "binary.tnh" );
+
+	Document document;
+	CreateScene( document );
+	document.SetFileFormat( Document::BinaryFormat );
+	ASSERT_TRUE( document.WriteFile( fileName ) );
+
+	//A new scene after reading a binary file is not saved in binary format
+	Document readDocument;
+	ASSERT_TRUE( readDocument.ReadFile( fileName ) );
+	ASSERT_EQ( Document::BinaryFormat, readDocument.GetFileFormat() );
+	readDocument.New();
+	EXPECT_EQ( Document::ASCIIFormat, readDocument.GetFileFormat() );
+}
@@ -0,0 +1,206 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <QModelIndex>
+#include <QStringList>
+#include <QVector>
+
+#include <Inventor/nodes/SoTransform.h>
+
+#include "FluxAnalysis.h"
+#include "InstanceNode.h"
+#include "RandomSobol.h"
+#include "SceneModel.h"
+#include "ShapeFlatRectangle.h"
+#include "SunshapePillbox.h"
+#include "TLightKit.h"
+#include "TSceneKit.h"
+#include "TSeparatorKit.h"
+#include "TShapeKit.h"
+
+static const char* LeftSurface = "//SunNode/RootNode/Left/Surface";
+static const char* RightSurface = "//SunNode/RootNode/Right/Surface";
+
+//! Scene of two flat rectangles side by side lit from above.
+class FluxScene
+{
+public:
+	FluxScene()
+	:m_scene( new TSceneKit ),
+	 m_model( new SceneModel )
+	{
+		m_scene->ref();
+
+		TLightKit* lightKit = new TLightKit;
+		lightKit->setPart( "tsunshape", new SunshapePillbox );
+		m_scene->setPart( "lightList[0]", lightKit );
+		m_model->SetCoinScene( *m_scene );
+
+		QModelIndex rootIndex = m_model->IndexFromNodeUrl( QLatin1String( "//SunNode/RootNode" ) );
+		SoBaseKit* concentratorRoot = static_cast< SoBaseKit* >( m_model->NodeFromIndex( rootIndex )->GetNode() );
+		AddSurface( concentratorRoot, "Left", -2.0 );
+		AddSurface( concentratorRoot, "Right", 2.0 );
+	}
+	~FluxScene()
+	{
+		delete m_model;
+		m_scene->unref();
+	}
+
+	/*!
+	 * Creates an analysis of the scene that traces the rays with \a rand.
+	 */
+	FluxAnalysis* CreateAnalysis( RandomDeviate* rand )
+	{
+		QModelIndex sunIndex = m_model->IndexFromNodeUrl( QLatin1String( "//SunNode" ) );
+		return new FluxAnalysis( m_scene, *m_model, m_model->NodeFromIndex( sunIndex ), 100, 100, rand );
+	}
+
+private:
+	void AddSurface( SoBaseKit* concentratorRoot, const char* name, double x )
+	{
+		TSeparatorKit* group = new TSeparatorKit;
+		group->setName( name );
+		SoTransform* transform = new SoTransform;
+		transform->translation.setValue( x, 0.0, 0.0 );
+		group->setPart( "transform", transform );
+		m_model->InsertCoinNode( *group, *concentratorRoot );
+
+		ShapeFlatRectangle* rectangle = new ShapeFlatRectangle;
+		rectangle->width.setValue( 2.0 );
+		rectangle->height.setValue( 2.0 );
+		TShapeKit* surface = new TShapeKit;
+		surface->setName( "Surface" );
+		surface->setPart( "shape", rectangle );
+		m_model->InsertCoinNode( *surface, *group );
+	}
+
+	TSceneKit* m_scene;
+	SceneModel* m_model;
+};
+
+/*!
+ * Expects the same photon counts and power in the analyses \a expected and \a analysis of \a heightDivisions x \a widthDivisions cells.
+ */
+static void ExpectSameFlux( FluxAnalysis& expected, FluxAnalysis& analysis, int heightDivisions, int widthDivisions )
+{
+	int** expectedCounts = expected.photonCountsValue();
+	int** counts = analysis.photonCountsValue();
+	ASSERT_TRUE( expectedCounts != 0 );
+	ASSERT_TRUE( counts != 0 );
+	for( int h = 0; h < heightDivisions; ++h )
+		for( int w = 0; w < widthDivisions; ++w )
+			EXPECT_EQ( expectedCounts[h][w], counts[h][w] );
+	EXPECT_DOUBLE_EQ( expected.totalPowerValue(), analysis.totalPowerValue() );
+}
+
+TEST( FluxAnalysisTests, SurfaceValues )
+{
+	QStringList values = FluxAnalysis::SurfaceValues( QLatin1String( "FRONT;BACK;" ), 2 );
+	ASSERT_EQ( 2, values.count() );
+	EXPECT_EQ( QString( "FRONT" ), values[0] );
+	EXPECT_EQ( QString( "BACK" ), values[1] );
+
+	//A single value is used for all the surfaces
+	values = FluxAnalysis::SurfaceValues( QLatin1String( "20" ), 3 );
+	ASSERT_EQ( 3, values.count() );
+	EXPECT_EQ( QString( "20" ), values[2] );
+
+	EXPECT_TRUE( FluxAnalysis::SurfaceValues( QLatin1String( "20;30" ), 3 ).isEmpty() );
+	EXPECT_TRUE( FluxAnalysis::SurfaceValues( QLatin1String( ";" ), 2 ).isEmpty() );
+	EXPECT_TRUE( FluxAnalysis::SurfaceValues( QLatin1String( "20" ), 0 ).isEmpty() );
+}
+
+TEST( FluxAnalysisTests, SingleTraceOfTwoSurfaces )
+{
+	FluxScene scene;
+	unsigned long nOfRays = 20000;
+
+	RandomSobol rand( 1234 );
+	FluxAnalysis* left = scene.CreateAnalysis( &rand );
+	FluxAnalysis* right = scene.CreateAnalysis( &rand );
+	left->SetAnalysisSurface( QLatin1String( LeftSurface ), QLatin1String( "FRONT" ), 10, 10 );
+	right->SetAnalysisSurface( QLatin1String( RightSurface ), QLatin1String( "FRONT" ), 5, 8 );
+	QVector< FluxAnalysis* > surfaceAnalyses;
+	surfaceAnalyses << left << right;
+	FluxAnalysis::RunFluxAnalysis( surfaceAnalyses, nOfRays );
+	EXPECT_TRUE( left->GetErrorMessage().isEmpty() );
+	EXPECT_TRUE( right->GetErrorMessage().isEmpty() );
+	EXPECT_GT( left->totalPowerValue(), 0.0 );
+	EXPECT_GT( right->totalPowerValue(), 0.0 );
+
+	//Each surface has the flux of a trace of its own with the same rays
+	RandomSobol leftRand( 1234 );
+	FluxAnalysis* leftOnly = scene.CreateAnalysis( &leftRand );
+	leftOnly->RunFluxAnalysis( QLatin1String( LeftSurface ), QLatin1String( "FRONT" ), nOfRays, false, 10, 10 );
+	ExpectSameFlux( *leftOnly, *left, 10, 10 );
+
+	RandomSobol rightRand( 1234 );
+	FluxAnalysis* rightOnly = scene.CreateAnalysis( &rightRand );
+	rightOnly->RunFluxAnalysis( QLatin1String( RightSurface ), QLatin1String( "FRONT" ), nOfRays, false, 5, 8 );
+	ExpectSameFlux( *rightOnly, *right, 5, 8 );
+
+	delete rightOnly;
+	delete leftOnly;
+	delete right;
+	delete left;
+}
+
+TEST( FluxAnalysisTests, IncreasedAnalysisOfAnotherSurfaceIsNew )
+{
+	FluxScene scene;
+	unsigned long nOfRays = 20000;
+
+	RandomSobol rand( 1234 );
+	FluxAnalysis* analysis = scene.CreateAnalysis( &rand );
+	analysis->RunFluxAnalysis( QLatin1String( LeftSurface ), QLatin1String( "FRONT" ), nOfRays, false, 10, 10 );
+	EXPECT_GT( analysis->totalPowerValue(), 0.0 );
+	analysis->RunFluxAnalysis( QLatin1String( RightSurface ), QLatin1String( "FRONT" ), nOfRays, true, 10, 10 );
+
+	//The photons of the left surface are not added to the right surface analysis
+	RandomSobol rightRand( 1234 );
+	rightRand.ReservePaths( nOfRays );
+	FluxAnalysis* rightOnly = scene.CreateAnalysis( &rightRand );
+	rightOnly->RunFluxAnalysis( QLatin1String( RightSurface ), QLatin1String( "FRONT" ), nOfRays, false, 10, 10 );
+	ExpectSameFlux( *rightOnly, *analysis, 10, 10 );
+
+	delete rightOnly;
+	delete analysis;
+}
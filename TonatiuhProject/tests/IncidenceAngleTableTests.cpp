@@ -0,0 +1,121 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include "IncidenceAngleTable.h"
+
+/*
+ * Linear interpolation of the sorted \a angles and \a values at the incidence angle \a angle.
+ */
+static double InterpolatedValue( const std::vector< double >& angles, const std::vector< double >& values, double angle )
+{
+	if( angle <= angles[0] ) return values[0];
+	for( unsigned int j = 1; j < angles.size(); ++j )
+		if( angles[j] >= angle )
+			return values[j-1] + ( angle - angles[j-1] ) / ( angles[j] - angles[j-1] ) * ( values[j] - values[j-1] );
+	return 0.0;
+}
+
+TEST( IncidenceAngleTableTests, EmptyTable )
+{
+	IncidenceAngleTable table;
+	EXPECT_TRUE( table.IsEmpty() );
+	EXPECT_DOUBLE_EQ( 0.0, table.Value( 0.5 ) );
+}
+
+TEST( IncidenceAngleTableTests, InvalidValues )
+{
+	IncidenceAngleTable table;
+
+	std::vector< double > angles( 1, 0.0 );
+	std::vector< double > values( 1, 0.9 );
+	EXPECT_FALSE( table.SetValues( angles, values ) );
+	EXPECT_TRUE( table.IsEmpty() );
+
+	angles.push_back( 1.0 );
+	EXPECT_FALSE( table.SetValues( angles, values ) );
+	EXPECT_TRUE( table.IsEmpty() );
+	EXPECT_DOUBLE_EQ( 0.0, table.Value( 1.0 ) );
+}
+
+TEST( IncidenceAngleTableTests, LinearInterpolation )
+{
+	std::vector< double > angles;
+	std::vector< double > values;
+	for( int j = 0; j <= 18; ++j )
+	{
+		angles.push_back( j * 0.05 * M_PI / 2 );
+		values.push_back( 0.95 - 0.4 * pow( j / 18.0, 3 ) );
+	}
+
+	IncidenceAngleTable table;
+	ASSERT_TRUE( table.SetValues( angles, values ) );
+	EXPECT_FALSE( table.IsEmpty() );
+
+	EXPECT_NEAR( values[0], table.Value( 1.0 ), 1e-12 );
+	for( int i = 0; i <= 1000; ++i )
+	{
+		double cosIncidence = i * 0.001;
+		double expected = InterpolatedValue( angles, values, acos( cosIncidence ) );
+		EXPECT_NEAR( expected, table.Value( cosIncidence ), 1e-4 );
+	}
+}
+
+TEST( IncidenceAngleTableTests, UnsortedAndOutOfRangeAngles )
+{
+	std::vector< double > angles;
+	std::vector< double > values;
+	angles.push_back( 0.8 );
+	values.push_back( 0.5 );
+	angles.push_back( 0.2 );
+	values.push_back( 0.9 );
+	angles.push_back( 0.5 );
+	values.push_back( 0.7 );
+
+	IncidenceAngleTable table;
+	ASSERT_TRUE( table.SetValues( angles, values ) );
+
+	EXPECT_NEAR( 0.9, table.Value( cos( 0.1 ) ), 1e-12 );
+	EXPECT_NEAR( 0.8, table.Value( cos( 0.35 ) ), 1e-4 );
+	EXPECT_NEAR( 0.6, table.Value( cos( 0.65 ) ), 1e-4 );
+	EXPECT_DOUBLE_EQ( 0.0, table.Value( cos( 1.0 ) ) );
+	EXPECT_DOUBLE_EQ( 0.0, table.Value( -0.5 ) );
+}
@@ -0,0 +1,190 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "BBox.h"
+#include "InstanceNode.h"
+#include "Point3D.h"
+#include "RandomDeviate.h"
+#include "Ray.h"
+#include "ShapeTroughCPC.h"
+#include "Transform.h"
+#include "TSeparatorKit.h"
+#include "TShapeKit.h"
+#include "Vector3D.h"
+
+//! Random deviate that always returns the same number.
+class ConstantDeviate : public RandomDeviate
+{
+public:
+	void FillArray( double* array, const unsigned long arraySize )
+	{
+		for( unsigned long i = 0; i < arraySize; ++i )	array[i] = 0.5;
+	}
+};
+
+/*!
+ * Returns the cell of a grid with \a divisions x \a divisions cells over [0,1]x[0,1] that contains \a value,
+ * as the flux analysis counts the photons.
+ */
+static int CellIndex( double value, int divisions )
+{
+	int cell = int( value * divisions );
+	if( cell < 0 )	return 0;
+	if( cell >= divisions )	return divisions - 1;
+	return cell;
+}
+
+/*!
+ * Creates a surface node for \a shapeKit with an identity transform.
+ */
+static InstanceNode* CreateSurfaceNode( TShapeKit* shapeKit, TShape* shape )
+{
+	InstanceNode* surfaceNode = new InstanceNode( shapeKit );
+	surfaceNode->AddChild( new InstanceNode( shape ) );
+	surfaceNode->SetIntersectionTransform( Transform( 1.0, 0.0, 0.0, 0.0,
+														0.0, 1.0, 0.0, 0.0,
+														0.0, 0.0, 1.0, 0.0,
+														0.0, 0.0, 0.0, 1.0 ) );
+	surfaceNode->SetIntersectionBBox( BBox( Point3D( -10.0, -10.0, -10.0 ), Point3D( 10.0, 10.0, 10.0 ) ) );
+	return surfaceNode;
+}
+
+/*!
+ * Returns a ray that intersects \a shape at distance \a distance, normal to the surface at the parameters \a u, \a v.
+ */
+static Ray RayToSurface( TShape* shape, double u, double v, double distance )
+{
+	double du = 0.000001;
+	Point3D point = shape->Sample( u, v );
+	Vector3D dpdu = shape->Sample( u + du, v ) - shape->Sample( u - du, v );
+	Vector3D dpdv = shape->Sample( u, v + du ) - shape->Sample( u, v - du );
+	Vector3D normal = Normalize( CrossProduct( dpdu, dpdv ) );
+	return Ray( point + normal * distance, -normal );
+}
+
+TEST( InstanceNodeTests, CurvedSurfaceCoordinatesSpreadAcrossFluxCells )
+{
+	TShapeKit* shapeKit = new TShapeKit;
+	shapeKit->ref();
+	ShapeTroughCPC* shape = new ShapeTroughCPC;
+	shapeKit->setPart( "shape", shape );
+
+	InstanceNode* surfaceNode = CreateSurfaceNode( shapeKit, shape );
+
+	ConstantDeviate rand;
+
+	//Rays to the centers of the cells of a grid over the surface parametric coordinates
+	const int divisions = 4;
+	std::vector< int > counts( divisions * divisions, 0 );
+	for( int h = 0; h < divisions; ++h )
+	{
+		double v = ( h + 0.5 ) / divisions;
+		for( int w = 0; w < divisions; ++w )
+		{
+			double u = ( w + 0.5 ) / divisions;
+			Ray ray = RayToSurface( shape, u, v, 0.01 );
+			bool isShapeFront = false;
+			InstanceNode* modelNode = 0;
+			Ray outputRay;
+			double uHit = -1.0;
+			double vHit = -1.0;
+			surfaceNode->Intersect( ray, rand, &isShapeFront, &modelNode, &outputRay, &uHit, &vHit );
+
+			ASSERT_TRUE( modelNode == surfaceNode );
+			EXPECT_GE( uHit, 0.0 );
+			EXPECT_LE( uHit, 1.0 );
+			EXPECT_GE( vHit, 0.0 );
+			EXPECT_LE( vHit, 1.0 );
+			counts[CellIndex( vHit, divisions ) * divisions + CellIndex( uHit, divisions )]++;
+		}
+	}
+
+	//Each photon is counted in the cell of its ray
+	for( int c = 0; c < divisions * divisions; ++c )
+		EXPECT_EQ( 1, counts[c] )<<"cell "<<c;
+
+	delete surfaceNode;
+	shapeKit->unref();
+}
+
+TEST( InstanceNodeTests, IntersectPTestsTheRaySegment )
+{
+	TShapeKit* shapeKit = new TShapeKit;
+	shapeKit->ref();
+	ShapeTroughCPC* shape = new ShapeTroughCPC;
+	shapeKit->setPart( "shape", shape );
+	InstanceNode* surfaceNode = CreateSurfaceNode( shapeKit, shape );
+
+	Ray ray = RayToSurface( shape, 0.5, 0.5, 0.01 );
+	EXPECT_TRUE( surfaceNode->IntersectP( ray, 0 ) );
+
+	//The surface is farther than the ray maxt
+	Ray shortRay( ray.origin, ray.direction(), ray.mint, 0.005 );
+	EXPECT_FALSE( surfaceNode->IntersectP( shortRay, 0 ) );
+
+	delete surfaceNode;
+	shapeKit->unref();
+}
+
+TEST( InstanceNodeTests, IntersectPSkipsTheExcludedNode )
+{
+	TSeparatorKit* separatorKit = new TSeparatorKit;
+	separatorKit->ref();
+	TShapeKit* shapeKit = new TShapeKit;
+	shapeKit->ref();
+	ShapeTroughCPC* shape = new ShapeTroughCPC;
+	shapeKit->setPart( "shape", shape );
+
+	InstanceNode* groupNode = new InstanceNode( separatorKit );
+	groupNode->SetIntersectionBBox( BBox( Point3D( -10.0, -10.0, -10.0 ), Point3D( 10.0, 10.0, 10.0 ) ) );
+	InstanceNode* surfaceNode = CreateSurfaceNode( shapeKit, shape );
+	groupNode->AddChild( surfaceNode );
+
+	Ray ray = RayToSurface( shape, 0.25, 0.5, 0.01 );
+	EXPECT_TRUE( groupNode->IntersectP( ray, 0 ) );
+	EXPECT_FALSE( groupNode->IntersectP( ray, surfaceNode ) );
+	EXPECT_FALSE( groupNode->IntersectP( ray, groupNode ) );
+
+	delete groupNode;
+	shapeKit->unref();
+	separatorKit->unref();
+}
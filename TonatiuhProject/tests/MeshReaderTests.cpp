@@ -0,0 +1,206 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <string.h>
+
+#include <gtest/gtest.h>
+
+#include <QFile>
+
+#include "MeshReader.h"
+
+#include "TestsAuxiliaryFunctions.h"
+
+static bool WriteContents( const QString& fileName, const QByteArray& contents )
+{
+	QFile file( fileName );
+	if( !file.open( QIODevice::WriteOnly ) )	return false;
+	return ( file.write( contents ) == contents.size() );
+}
+
+static Point3D FacetVertex( const MeshReader& meshReader, int facet, int vertex )
+{
+	return meshReader.GetVertices()[meshReader.GetFacetVertices()[3 * facet + vertex]];
+}
+
+static void ExpectPoint( const Point3D& expected, const Point3D& point )
+{
+	EXPECT_DOUBLE_EQ( expected.x, point.x );
+	EXPECT_DOUBLE_EQ( expected.y, point.y );
+	EXPECT_DOUBLE_EQ( expected.z, point.z );
+}
+
+//Appends a binary STL facet with the \a values of the normal and the three vertices
+static void AppendBinaryFacet( QByteArray* contents, const float values[12] )
+{
+	char facet[50];
+	memset( facet, 0, sizeof( facet ) );
+	memcpy( facet, values, 12 * sizeof( float ) );
+	contents->append( facet, sizeof( facet ) );
+}
+
+TEST( MeshReaderTests, ASCIISTL )
+{
+	taf::TemporaryDirectory directory;
+	QString fileName = directory.FilePath( "ascii.stl" );
+	ASSERT_TRUE( WriteContents( fileName,
+			"solid square\n"
+			"  facet normal 0 0 1\n"
+			"    outer loop\n"
+			"      vertex 0 0 0\n"
+			"      vertex 1 0 0\n"
+			"      vertex 1 1 0\n"
+			"    endloop\n"
+			"  endfacet\n"
+			"  facet normal 0 0 1\n"
+			"    outer loop\n"
+			"      vertex 0 0 0\n"
+			"      vertex 1 1 0\n"
+			"      vertex 0 1.5e0 0\n"
+			"    endloop\n"
+			"  endfacet\n"
+			"endsolid square\n" ) );
+
+	MeshReader meshReader;
+	ASSERT_TRUE( meshReader.Read( fileName ) )<<meshReader.GetErrorMessage().toStdString();
+
+	//The shared vertices are stored once
+	EXPECT_EQ( 4u, meshReader.GetVertices().size() );
+	ASSERT_EQ( 6u, meshReader.GetFacetVertices().size() );
+	ASSERT_EQ( 2u, meshReader.GetFacetNormals().size() );
+	EXPECT_EQ( meshReader.GetFacetVertices()[0], meshReader.GetFacetVertices()[3] );
+	EXPECT_EQ( meshReader.GetFacetVertices()[2], meshReader.GetFacetVertices()[4] );
+
+	ExpectPoint( Point3D( 1.0, 0.0, 0.0 ), FacetVertex( meshReader, 0, 1 ) );
+	ExpectPoint( Point3D( 0.0, 1.5, 0.0 ), FacetVertex( meshReader, 1, 2 ) );
+	EXPECT_DOUBLE_EQ( 1.0, meshReader.GetFacetNormals()[1].z );
+}
+
+TEST( MeshReaderTests, BinarySTL )
+{
+	taf::TemporaryDirectory directory;
+	//The header starts with "solid", as in some binary files
+	QByteArray contents( "solid binary" );
+	contents.append( QByteArray( 80 - contents.size(), ' ' ) );
+	quint32 nFacets = 2;
+	contents.append( reinterpret_cast< const char* >( &nFacets ), 4 );
+
+	const float facet1[12] = { 0.0f, 0.0f, 1.0f,   0.0f, 0.0f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 0.0f };
+	const float facet2[12] = { 0.0f, 0.0f, 0.0f,   0.0f, 0.0f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f, 0.0f };
+	AppendBinaryFacet( &contents, facet1 );
+	AppendBinaryFacet( &contents, facet2 );
+
+	QString fileName = directory.FilePath( "binary.stl" );
+	ASSERT_TRUE( WriteContents( fileName, contents ) );
+
+	MeshReader meshReader;
+	ASSERT_TRUE( meshReader.Read( fileName ) )<<meshReader.GetErrorMessage().toStdString();
+
+	EXPECT_EQ( 4u, meshReader.GetVertices().size() );
+	ASSERT_EQ( 6u, meshReader.GetFacetVertices().size() );
+	ASSERT_EQ( 2u, meshReader.GetFacetNormals().size() );
+	ExpectPoint( Point3D( 1.0, 1.0, 0.0 ), FacetVertex( meshReader, 0, 2 ) );
+	ExpectPoint( Point3D( 0.0, 1.0, 0.0 ), FacetVertex( meshReader, 1, 2 ) );
+	EXPECT_EQ( meshReader.GetFacetVertices()[2], meshReader.GetFacetVertices()[4] );
+
+	//The null normal is computed from the vertices
+	EXPECT_DOUBLE_EQ( 1.0, meshReader.GetFacetNormals()[0].z );
+	EXPECT_DOUBLE_EQ( 1.0, meshReader.GetFacetNormals()[1].z );
+
+	//A truncated file is not read
+	ASSERT_TRUE( WriteContents( fileName, contents.left( contents.size() - 10 ) ) );
+	EXPECT_FALSE( meshReader.Read( fileName ) );
+}
+
+TEST( MeshReaderTests, OBJRelativeIndicesAndDuplicatedVertices )
+{
+	taf::TemporaryDirectory directory;
+	QString fileName = directory.FilePath( "mesh.obj" );
+	ASSERT_TRUE( WriteContents( fileName,
+			"# square and two triangles\n"
+			"v 0 0 0\n"
+			"v 1 0 0\n"
+			"v 1 1 0\n"
+			"v 0 1 0\n"
+			"v 1 0 0\n"
+			"vn 0 0 1\n"
+			"vt 0.5 0.5\n"
+			"f 1 2 3 4\n"
+			"v 0 0 1\n"
+			"f -1 -2 -6\n"
+			"f 1/1/1 5//1 6\n" ) );
+
+	MeshReader meshReader;
+	ASSERT_TRUE( meshReader.Read( fileName ) )<<meshReader.GetErrorMessage().toStdString();
+
+	//The second (1,0,0) vertex is the same vertex
+	EXPECT_EQ( 5u, meshReader.GetVertices().size() );
+	ASSERT_EQ( 12u, meshReader.GetFacetVertices().size() );
+
+	//The quad is split in two triangles
+	ExpectPoint( Point3D( 0.0, 0.0, 0.0 ), FacetVertex( meshReader, 0, 0 ) );
+	ExpectPoint( Point3D( 1.0, 1.0, 0.0 ), FacetVertex( meshReader, 0, 2 ) );
+	ExpectPoint( Point3D( 1.0, 1.0, 0.0 ), FacetVertex( meshReader, 1, 1 ) );
+	ExpectPoint( Point3D( 0.0, 1.0, 0.0 ), FacetVertex( meshReader, 1, 2 ) );
+
+	//Relative indices refer to the last vertices
+	ExpectPoint( Point3D( 0.0, 0.0, 1.0 ), FacetVertex( meshReader, 2, 0 ) );
+	ExpectPoint( Point3D( 1.0, 0.0, 0.0 ), FacetVertex( meshReader, 2, 1 ) );
+	ExpectPoint( Point3D( 0.0, 0.0, 0.0 ), FacetVertex( meshReader, 2, 2 ) );
+	EXPECT_EQ( meshReader.GetFacetVertices()[1], meshReader.GetFacetVertices()[7] );
+
+	//Texture and normal indices are skipped
+	ExpectPoint( Point3D( 1.0, 0.0, 0.0 ), FacetVertex( meshReader, 3, 1 ) );
+	ExpectPoint( Point3D( 0.0, 0.0, 1.0 ), FacetVertex( meshReader, 3, 2 ) );
+	EXPECT_EQ( meshReader.GetFacetVertices()[1], meshReader.GetFacetVertices()[10] );
+}
+
+TEST( MeshReaderTests, OBJUndefinedVertex )
+{
+	taf::TemporaryDirectory directory;
+	QString fileName = directory.FilePath( "invalid.obj" );
+	ASSERT_TRUE( WriteContents( fileName,
+			"v 0 0 0\n"
+			"v 1 0 0\n"
+			"v 1 1 0\n"
+			"f 1 2 4\n" ) );
+
+	MeshReader meshReader;
+	EXPECT_FALSE( meshReader.Read( fileName ) );
+	EXPECT_FALSE( meshReader.GetErrorMessage().isEmpty() );
+}
@@ -0,0 +1,203 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Philox.h"
+
+static const unsigned long NumbersToTest = 32 * 32768;
+
+static std::vector< double > GenerateStream( unsigned long seed, unsigned long stream, unsigned long nNumbers )
+{
+	Philox philox( seed, stream );
+	std::vector< double > numbers( nNumbers );
+	for( unsigned long group = 0; group < nNumbers / Philox::GroupSize; ++group )
+		philox.GenerateGroup( group, &numbers[group * Philox::GroupSize] );
+	return numbers;
+}
+
+static double ChiSquare( const std::vector< unsigned long >& counts, double expected )
+{
+	double chiSquare = 0.0;
+	for( unsigned int i = 0; i < counts.size(); ++i )
+		chiSquare += ( counts[i] - expected ) * ( counts[i] - expected ) / expected;
+	return chiSquare;
+}
+
+//Known answer vectors of the Random123 library
+TEST( PhiloxTests, KnownAnswerVectors )
+{
+	const unsigned int counter[3][4] = { { 0, 0, 0, 0 },
+			{ 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff },
+			{ 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 } };
+	const unsigned int key[3][2] = { { 0, 0 }, { 0xffffffff, 0xffffffff }, { 0xa4093822, 0x299f31d0 } };
+	const unsigned int expected[3][4] = { { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 },
+			{ 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd },
+			{ 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } };
+
+	for( int v = 0; v < 3; ++v )
+	{
+		unsigned int output[4];
+		Philox::Block( counter[v], key[v], output );
+		for( int word = 0; word < 4; ++word )
+			EXPECT_EQ( expected[v][word], output[word] );
+	}
+}
+
+//The SIMD groups must give the numbers of the blocks in the same order in all the instruction sets
+TEST( PhiloxTests, GroupMatchesBlocks )
+{
+	const unsigned long seed = 0x9abcdef0UL;
+	const unsigned long stream = 77;
+	Philox philox( seed, stream );
+
+	const unsigned long groups[4] = { 0, 1, 12345, 536870911UL };
+	for( int g = 0; g < 4; ++g )
+	{
+		double numbers[Philox::GroupSize];
+		philox.GenerateGroup( groups[g], numbers );
+
+		for( int lane = 0; lane < Philox::GroupBlocks; ++lane )
+		{
+			unsigned long block = groups[g] * Philox::GroupBlocks + lane;
+			const unsigned int counter[4] = { static_cast< unsigned int >( block & 0xFFFFFFFFUL ),
+					static_cast< unsigned int >( ( block >> 16 ) >> 16 ), stream, 0 };
+			const unsigned int key[2] = { seed, 0 };
+			unsigned int output[4];
+			Philox::Block( counter, key, output );
+
+			for( int word = 0; word < 4; ++word )
+				EXPECT_EQ( Philox::ToDouble( output[word] ), numbers[word * Philox::GroupBlocks + lane] );
+		}
+	}
+}
+
+TEST( PhiloxTests, NumbersInOpenInterval )
+{
+	EXPECT_GT( Philox::ToDouble( 0 ), 0.0 );
+	EXPECT_LT( Philox::ToDouble( 0xffffffff ), 1.0 );
+
+	std::vector< double > numbers = GenerateStream( 5489, 0, NumbersToTest );
+	for( unsigned long i = 0; i < numbers.size(); ++i )
+	{
+		EXPECT_GT( numbers[i], 0.0 );
+		EXPECT_LT( numbers[i], 1.0 );
+	}
+}
+
+TEST( PhiloxTests, MeanAndVariance )
+{
+	std::vector< double > numbers = GenerateStream( 5489, 0, NumbersToTest );
+	double n = numbers.size();
+
+	double sum = 0.0;
+	double sumSquares = 0.0;
+	for( unsigned long i = 0; i < numbers.size(); ++i )
+	{
+		sum += numbers[i];
+		sumSquares += numbers[i] * numbers[i];
+	}
+	double mean = sum / n;
+	double variance = sumSquares / n - mean * mean;
+
+	//Five standard errors
+	EXPECT_NEAR( 0.5, mean, 5.0 * std::sqrt( 1.0 / ( 12.0 * n ) ) );
+	EXPECT_NEAR( 1.0 / 12.0, variance, 5.0 * std::sqrt( 1.0 / ( 180.0 * n ) ) );
+}
+
+//Equidistribution test with 256 intervals
+TEST( PhiloxTests, ChiSquareFrequency )
+{
+	std::vector< double > numbers = GenerateStream( 5489, 0, NumbersToTest );
+	std::vector< unsigned long > counts( 256, 0 );
+	for( unsigned long i = 0; i < numbers.size(); ++i )
+		++counts[static_cast< int >( numbers[i] * 256 )];
+
+	//The critical value of the chi-square with 255 degrees of freedom for p = 0.001 is 330.5
+	EXPECT_LT( ChiSquare( counts, numbers.size() / 256.0 ), 330.5 );
+}
+
+//Serial test of the non overlapping pairs of consecutive numbers in a 16x16 grid
+TEST( PhiloxTests, ChiSquareSerialPairs )
+{
+	std::vector< double > numbers = GenerateStream( 5489, 0, NumbersToTest );
+	std::vector< unsigned long > counts( 256, 0 );
+	for( unsigned long i = 0; i + 1 < numbers.size(); i += 2 )
+		++counts[static_cast< int >( numbers[i] * 16 ) * 16 + static_cast< int >( numbers[i + 1] * 16 )];
+
+	EXPECT_LT( ChiSquare( counts, numbers.size() / 512.0 ), 330.5 );
+}
+
+//Correlation of the numbers with the numbers at lags inside and across the blocks and the groups
+TEST( PhiloxTests, SerialCorrelation )
+{
+	std::vector< double > numbers = GenerateStream( 5489, 0, NumbersToTest );
+	const unsigned long lags[4] = { 1, 4, Philox::GroupBlocks, Philox::GroupSize };
+	for( int l = 0; l < 4; ++l )
+	{
+		unsigned long n = numbers.size() - lags[l];
+		double correlation = 0.0;
+		for( unsigned long i = 0; i < n; ++i )
+			correlation += ( numbers[i] - 0.5 ) * ( numbers[i + lags[l]] - 0.5 );
+		correlation *= 12.0 / n;
+
+		EXPECT_LT( std::fabs( correlation ), 5.0 / std::sqrt( double( n ) ) );
+	}
+}
+
+//Consecutive streams and seeds must not be correlated
+TEST( PhiloxTests, IndependentStreams )
+{
+	std::vector< double > first = GenerateStream( 5489, 0, NumbersToTest );
+	std::vector< double > nextStream = GenerateStream( 5489, 1, NumbersToTest );
+	std::vector< double > nextSeed = GenerateStream( 5490, 0, NumbersToTest );
+
+	double streamCorrelation = 0.0;
+	double seedCorrelation = 0.0;
+	for( unsigned long i = 0; i < first.size(); ++i )
+	{
+		streamCorrelation += ( first[i] - 0.5 ) * ( nextStream[i] - 0.5 );
+		seedCorrelation += ( first[i] - 0.5 ) * ( nextSeed[i] - 0.5 );
+	}
+	double n = first.size();
+	EXPECT_LT( std::fabs( 12.0 * streamCorrelation / n ), 5.0 / std::sqrt( n ) );
+	EXPECT_LT( std::fabs( 12.0 * seedCorrelation / n ), 5.0 / std::sqrt( n ) );
+}
@@ -56,4 +56,24 @@ TEST(PhotonTests, ConstructorFromPhoton){
 	}
 }
 
+TEST(PhotonTests, ParametricCoordinates){
+	srand ( time(NULL) );
+
+	// Extension of the testing space
+	double b = maximumCoordinate;
+	double a = -b;
 
+	for( unsigned long int i = 0; i < maximumNumberOfTests; i++ ){
+		Point3D point=taf::randomPoint(a,b);
+		double u=taf::randomNumber(0.0,1.0);
+		double v=taf::randomNumber(0.0,1.0);
+		Photon ph( point, 1, 1, 0, 1, u, v );
+		EXPECT_DOUBLE_EQ( u,ph.u );
+		EXPECT_DOUBLE_EQ( v,ph.v );
+
+		Photon result(ph);
+		EXPECT_DOUBLE_EQ( u,result.u );
+		EXPECT_DOUBLE_EQ( v,result.v );
+		EXPECT_EQ( ph.isAbsorbed,result.isAbsorbed );
+	}
+}
@@ -0,0 +1,227 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <Inventor/nodekits/SoNodeKitListPart.h>
+
+#include <QFile>
+
+#include "InstanceNode.h"
+#include "PrimaryRayCache.h"
+#include "TDefaultMaterial.h"
+#include "TSeparatorKit.h"
+#include "TShapeKit.h"
+#include "TSquare.h"
+
+#include "TestsAuxiliaryFunctions.h"
+
+//Instance tree with a group node and a square surface named \a surfaceName. The coin nodes are referenced by \a group.
+static InstanceNode* CreateInstanceTree( TSeparatorKit* group, const char* surfaceName, bool withMaterial )
+{
+	InstanceNode* rootNode = new InstanceNode( group );
+
+	TShapeKit* shapeKit = new TShapeKit;
+	shapeKit->setName( surfaceName );
+	SoNodeKitListPart* childList = static_cast< SoNodeKitListPart* >( group->getPart( "childList", true ) );
+	childList->addChild( shapeKit );
+	InstanceNode* surfaceNode = new InstanceNode( shapeKit );
+	rootNode->AddChild( surfaceNode );
+
+	TSquare* square = new TSquare;
+	shapeKit->setPart( "shape", square );
+	surfaceNode->AddChild( new InstanceNode( square ) );
+	if( withMaterial )
+	{
+		TDefaultMaterial* material = new TDefaultMaterial;
+		shapeKit->setPart( "material", material );
+		surfaceNode->AddChild( new InstanceNode( material ) );
+	}
+
+	return rootNode;
+}
+
+//Records a ray that misses the scene and two rays that hit \a surfaceNode, one of them reflected
+static void RecordRays( PrimaryRayCache& cache, InstanceNode* surfaceNode )
+{
+	std::vector< PrimaryRay > primaryRays( 3 );
+	for( int r = 0; r < 3; ++r )
+		primaryRays[r].ray = Ray( Point3D( r, 10.0, 0.5 * r ), Vector3D( 0.0, -1.0, 0.0 ) );
+
+	primaryRays[1].ray.maxt = 10.0;
+	primaryRays[1].intersectedSurface = surfaceNode;
+	primaryRays[1].isFront = true;
+	primaryRays[1].u = 0.25;
+	primaryRays[1].v = 0.75;
+
+	primaryRays[2].ray.maxt = 9.5;
+	primaryRays[2].intersectedSurface = surfaceNode;
+	primaryRays[2].u = 0.5;
+	primaryRays[2].v = 0.125;
+	primaryRays[2].isReflectedRay = true;
+	primaryRays[2].reflectedRay = Ray( primaryRays[2].ray( 9.5 ), Vector3D( 0.0, 1.0, 0.0 ) );
+
+	cache.StorePrimaryRays( primaryRays );
+}
+
+TEST( PrimaryRayCacheTests, WrittenRaysAreRead )
+{
+	taf::TemporaryDirectory directory;
+	TSeparatorKit* group = new TSeparatorKit;
+	group->ref();
+	group->setName( "Field" );
+	InstanceNode* rootNode = CreateInstanceTree( group, "Heliostat", true );
+	InstanceNode* surfaceNode = rootNode->children[0];
+
+	QString fileName = directory.FilePath( "primary.rays" );
+	PrimaryRayCache writeCache( fileName, QByteArray( "scene" ), 100 );
+	EXPECT_TRUE( writeCache.IsRecording() );
+	EXPECT_FALSE( writeCache.Read( rootNode ) );
+	RecordRays( writeCache, surfaceNode );
+	ASSERT_TRUE( writeCache.Write() );
+
+	PrimaryRayCache readCache( fileName, QByteArray( "scene" ), 100 );
+	ASSERT_TRUE( readCache.Read( rootNode ) );
+	EXPECT_FALSE( readCache.IsRecording() );
+
+	unsigned long firstRay = 0;
+	EXPECT_EQ( 3u, readCache.ReserveRays( 10, &firstRay ) );
+	EXPECT_EQ( 0u, firstRay );
+	EXPECT_EQ( 0u, readCache.ReserveRays( 10, &firstRay ) );
+
+	PrimaryRay primaryRay;
+	readCache.GetPrimaryRay( 0, &primaryRay );
+	EXPECT_TRUE( primaryRay.intersectedSurface == 0 );
+	EXPECT_FALSE( primaryRay.isReflectedRay );
+
+	readCache.GetPrimaryRay( 1, &primaryRay );
+	EXPECT_TRUE( primaryRay.intersectedSurface == surfaceNode );
+	EXPECT_TRUE( primaryRay.isFront );
+	EXPECT_FALSE( primaryRay.isReflectedRay );
+	EXPECT_DOUBLE_EQ( 1.0, primaryRay.ray.origin.x );
+	EXPECT_DOUBLE_EQ( -1.0, primaryRay.ray.direction().y );
+	EXPECT_DOUBLE_EQ( 10.0, primaryRay.ray.maxt );
+	EXPECT_DOUBLE_EQ( 0.25, primaryRay.u );
+	EXPECT_DOUBLE_EQ( 0.75, primaryRay.v );
+
+	readCache.GetPrimaryRay( 2, &primaryRay );
+	EXPECT_TRUE( primaryRay.intersectedSurface == surfaceNode );
+	EXPECT_FALSE( primaryRay.isFront );
+	EXPECT_TRUE( primaryRay.isReflectedRay );
+	EXPECT_DOUBLE_EQ( 9.5, primaryRay.ray.maxt );
+	EXPECT_DOUBLE_EQ( 0.5, primaryRay.reflectedRay.origin.y );
+	EXPECT_DOUBLE_EQ( 1.0, primaryRay.reflectedRay.direction().y );
+
+	delete rootNode;
+	group->unref();
+}
+
+TEST( PrimaryRayCacheTests, KeyMismatchKeepsRecording )
+{
+	taf::TemporaryDirectory directory;
+	TSeparatorKit* group = new TSeparatorKit;
+	group->ref();
+	group->setName( "Field" );
+	InstanceNode* rootNode = CreateInstanceTree( group, "Heliostat", true );
+
+	QString fileName = directory.FilePath( "primary.rays" );
+	PrimaryRayCache writeCache( fileName, QByteArray( "scene" ), 100 );
+	RecordRays( writeCache, rootNode->children[0] );
+	ASSERT_TRUE( writeCache.Write() );
+
+	//Another scene
+	PrimaryRayCache sceneCache( fileName, QByteArray( "other scene" ), 100 );
+	EXPECT_FALSE( sceneCache.Read( rootNode ) );
+	EXPECT_TRUE( sceneCache.IsRecording() );
+	EXPECT_TRUE( sceneCache.GetErrorMessage().isEmpty() );
+
+	//Another number of rays
+	PrimaryRayCache raysCache( fileName, QByteArray( "scene" ), 200 );
+	EXPECT_FALSE( raysCache.Read( rootNode ) );
+	EXPECT_TRUE( raysCache.IsRecording() );
+
+	//The intersected surface has not a material
+	TSeparatorKit* otherGroup = new TSeparatorKit;
+	otherGroup->ref();
+	otherGroup->setName( "Field" );
+	InstanceNode* otherRootNode = CreateInstanceTree( otherGroup, "Heliostat", false );
+	PrimaryRayCache materialCache( fileName, QByteArray( "scene" ), 100 );
+	EXPECT_FALSE( materialCache.Read( otherRootNode ) );
+	EXPECT_TRUE( materialCache.IsRecording() );
+
+	delete otherRootNode;
+	otherGroup->unref();
+	delete rootNode;
+	group->unref();
+}
+
+TEST( PrimaryRayCacheTests, InvalidFilesAreNotRead )
+{
+	taf::TemporaryDirectory directory;
+	TSeparatorKit* group = new TSeparatorKit;
+	group->ref();
+	group->setName( "Field" );
+	InstanceNode* rootNode = CreateInstanceTree( group, "Heliostat", true );
+
+	QString fileName = directory.FilePath( "primary.rays" );
+	QFile invalidFile( fileName );
+	ASSERT_TRUE( invalidFile.open( QIODevice::WriteOnly ) );
+	invalidFile.write( "not a primary rays file" );
+	invalidFile.close();
+
+	PrimaryRayCache invalidCache( fileName, QByteArray( "scene" ), 100 );
+	EXPECT_FALSE( invalidCache.Read( rootNode ) );
+	EXPECT_TRUE( invalidCache.IsRecording() );
+	EXPECT_FALSE( invalidCache.GetErrorMessage().isEmpty() );
+
+	//Truncated records
+	PrimaryRayCache writeCache( fileName, QByteArray( "scene" ), 100 );
+	RecordRays( writeCache, rootNode->children[0] );
+	ASSERT_TRUE( writeCache.Write() );
+	ASSERT_TRUE( invalidFile.resize( invalidFile.size() - 8 ) );
+
+	PrimaryRayCache truncatedCache( fileName, QByteArray( "scene" ), 100 );
+	EXPECT_FALSE( truncatedCache.Read( rootNode ) );
+	EXPECT_TRUE( truncatedCache.IsRecording() );
+	EXPECT_FALSE( truncatedCache.GetErrorMessage().isEmpty() );
+
+	delete rootNode;
+	group->unref();
+}
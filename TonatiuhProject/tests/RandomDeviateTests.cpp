@@ -0,0 +1,177 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <QMutex>
+
+#include "ParallelRandomDeviate.h"
+#include "RandomDeviate.h"
+
+//Stream generator that returns 0, 1, 2, ...
+class CounterDeviate : public RandomDeviate
+{
+public:
+	CounterDeviate() : RandomDeviate( 4 ), m_next( 0 ) {}
+	void FillArray( double* array, const unsigned long arraySize )
+	{
+		for( unsigned long i = 0; i < arraySize; ++i )	array[i] = m_next++;
+	}
+
+private:
+	double m_next;
+};
+
+//Path sampler that returns path * 100 + dimension
+class PathDeviate : public CounterDeviate
+{
+public:
+	PathDeviate() { SetPathSampler( this ); }
+	bool IsPathSampler() const { return true; }
+	double PathSample( unsigned long path, unsigned int dimension ) const { return path * 100.0 + dimension; }
+};
+
+//Counter generator that moves to any offset of the stream
+class OffsetDeviate : public RandomDeviate
+{
+public:
+	OffsetDeviate() : RandomDeviate( 4 ), m_next( 0 ), m_filledNumbers( 0 ) {}
+	void FillArray( double* array, const unsigned long arraySize )
+	{
+		for( unsigned long i = 0; i < arraySize; ++i )	array[i] = m_next++;
+		m_filledNumbers += arraySize;
+	}
+	bool SetOffset( quint64 offset ) { m_next = offset; return true; }
+	unsigned long FilledNumbers() const { return m_filledNumbers; }
+
+private:
+	double m_next;
+	unsigned long m_filledNumbers;
+};
+
+TEST( RandomDeviateTests, StreamGeneratorIgnoresPaths )
+{
+	CounterDeviate rand;
+	EXPECT_FALSE( rand.IsPathSampler() );
+
+	EXPECT_DOUBLE_EQ( 0.0, rand.RandomDouble() );
+	rand.StartPath( 7, RandomDeviate::SunShapeDimension );
+	EXPECT_DOUBLE_EQ( 1.0, rand.RandomDouble() );
+	rand.SetPathDimension( RandomDeviate::FirstSurfaceDimension );
+	EXPECT_DOUBLE_EQ( 2.0, rand.RandomDouble() );
+	EXPECT_DOUBLE_EQ( 3.0, rand.RandomDouble() );
+	EXPECT_DOUBLE_EQ( 4.0, rand.RandomDouble() );
+}
+
+TEST( RandomDeviateTests, ReservedPathsAreConsecutive )
+{
+	CounterDeviate rand;
+	EXPECT_EQ( 0UL, rand.ReservePaths( 10 ) );
+	EXPECT_EQ( 10UL, rand.ReservePaths( 5 ) );
+	EXPECT_EQ( 15UL, rand.ReservePaths( 1 ) );
+}
+
+TEST( RandomDeviateTests, PathSamplerDimensions )
+{
+	PathDeviate sampler;
+	QMutex mutex;
+	ParallelRandomDeviate rand( &sampler, &mutex, 4 );
+
+	//The numbers are taken from the stream until a path is started
+	EXPECT_DOUBLE_EQ( 0.0, rand.RandomDouble() );
+
+	unsigned long firstPath = rand.ReservePaths( 3 );
+	EXPECT_EQ( 0UL, firstPath );
+	EXPECT_EQ( 3UL, sampler.ReservePaths( 0 ) );
+
+	rand.StartPath( firstPath + 2, RandomDeviate::LightDimension );
+	EXPECT_DOUBLE_EQ( 200.0, rand.RandomDouble() );
+	EXPECT_DOUBLE_EQ( 201.0, rand.RandomDouble() );
+
+	rand.SetPathDimension( RandomDeviate::SunShapeDimension );
+	EXPECT_DOUBLE_EQ( 200.0 + RandomDeviate::SunShapeDimension, rand.RandomDouble() );
+
+	rand.SetPathDimension( RandomDeviate::FirstSurfaceDimension + RandomDeviate::SurfaceDimensions );
+	EXPECT_DOUBLE_EQ( 200.0 + RandomDeviate::FirstSurfaceDimension + RandomDeviate::SurfaceDimensions, rand.RandomDouble() );
+
+	rand.StartPath( firstPath );
+	EXPECT_DOUBLE_EQ( 0.0, rand.RandomDouble() );
+	EXPECT_DOUBLE_EQ( 1.0, rand.RandomDouble() );
+}
+
+TEST( RandomDeviateTests, StreamPositionCountsBuffers )
+{
+	CounterDeviate rand;
+	EXPECT_EQ( 0UL, rand.StreamPosition() );
+
+	rand.RandomDouble();
+	EXPECT_EQ( 4UL, rand.StreamPosition() );
+	for( int i = 0; i < 4; ++i )	rand.RandomDouble();
+	EXPECT_EQ( 8UL, rand.StreamPosition() );
+
+	double shared[6];
+	rand.FillSharedArray( shared, 6 );
+	EXPECT_DOUBLE_EQ( 8.0, shared[0] );
+	EXPECT_EQ( 14UL, rand.StreamPosition() );
+}
+
+TEST( RandomDeviateTests, SkipContinuesTheStream )
+{
+	CounterDeviate rand;
+	rand.RandomDouble();
+
+	//The numbers of the buffer are discarded
+	rand.Skip( 10 );
+	EXPECT_EQ( 14UL, rand.StreamPosition() );
+	EXPECT_DOUBLE_EQ( 14.0, rand.RandomDouble() );
+
+	CounterDeviate resumed;
+	resumed.Skip( 14 );
+	EXPECT_DOUBLE_EQ( 14.0, resumed.RandomDouble() );
+	EXPECT_DOUBLE_EQ( 15.0, resumed.RandomDouble() );
+}
+
+TEST( RandomDeviateTests, SkipWithOffset )
+{
+	OffsetDeviate rand;
+	rand.Skip( 1000000 );
+	EXPECT_EQ( 0UL, rand.FilledNumbers() );
+	EXPECT_EQ( 1000000UL, rand.StreamPosition() );
+	EXPECT_DOUBLE_EQ( 1000000.0, rand.RandomDouble() );
+	EXPECT_EQ( 4UL, rand.FilledNumbers() );
+}
@@ -0,0 +1,136 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "RandomSobol.h"
+
+/*!
+ * Returns true if each elementary interval of volume 1/2^\a k of the unit square contains one of the
+ * first 2^\a k paths of the dimensions \a dimension1 and \a dimension2.
+ */
+static bool FillsElementaryIntervals( const RandomSobol& sobol, int k, unsigned int dimension1, unsigned int dimension2 )
+{
+	unsigned long nPaths = 1UL << k;
+	for( int a = 0; a <= k; ++a )
+	{
+		unsigned long rows = 1UL << a;
+		unsigned long columns = 1UL << ( k - a );
+		std::vector< int > counts( nPaths, 0 );
+		for( unsigned long path = 0; path < nPaths; ++path )
+		{
+			unsigned long row = static_cast< unsigned long >( sobol.PathSample( path, dimension1 ) * rows );
+			unsigned long column = static_cast< unsigned long >( sobol.PathSample( path, dimension2 ) * columns );
+			++counts[row * columns + column];
+		}
+
+		for( unsigned long c = 0; c < nPaths; ++c )
+			if( counts[c] != 1 )	return false;
+	}
+	return true;
+}
+
+TEST( RandomSobolTests, PathSamplesInOpenInterval )
+{
+	RandomSobol sobol( 5489 );
+	for( unsigned long path = 0; path < 4096; ++path )
+	{
+		for( unsigned int dimension = 0; dimension < 12; ++dimension )
+		{
+			double sample = sobol.PathSample( path, dimension );
+			EXPECT_GT( sample, 0.0 );
+			EXPECT_LT( sample, 1.0 );
+		}
+	}
+
+	//Paths beyond the 32 bits index of the sequence
+	unsigned long farPath = 4294967295UL;
+	for( unsigned int dimension = 0; dimension < 4; ++dimension )
+	{
+		double sample = sobol.PathSample( farPath, dimension );
+		EXPECT_GT( sample, 0.0 );
+		EXPECT_LT( sample, 1.0 );
+	}
+}
+
+//The scrambling must keep the (0,m,2)-nets of the first two dimensions of each group
+TEST( RandomSobolTests, ScrambledPathsFillElementaryIntervals )
+{
+	RandomSobol sobol( 5489 );
+	for( int k = 1; k <= 10; ++k )
+	{
+		EXPECT_TRUE( FillsElementaryIntervals( sobol, k, 0, 1 ) )<<"k = "<<k;
+		EXPECT_TRUE( FillsElementaryIntervals( sobol, k, 4, 5 ) )<<"k = "<<k;
+	}
+
+	sobol.SetSeed( 12345 );
+	EXPECT_TRUE( FillsElementaryIntervals( sobol, 10, 0, 1 ) );
+	sobol.SetSubstream( 3 );
+	EXPECT_TRUE( FillsElementaryIntervals( sobol, 10, 8, 9 ) );
+}
+
+//Each dimension alone is stratified in 2^k intervals
+TEST( RandomSobolTests, ScrambledPathsStratifyEachDimension )
+{
+	RandomSobol sobol( 5489 );
+	const int k = 10;
+	const unsigned long nPaths = 1UL << k;
+	for( unsigned int dimension = 0; dimension < 8; ++dimension )
+	{
+		std::vector< int > counts( nPaths, 0 );
+		for( unsigned long path = 0; path < nPaths; ++path )
+			++counts[static_cast< unsigned long >( sobol.PathSample( path, dimension ) * nPaths )];
+
+		for( unsigned long c = 0; c < nPaths; ++c )
+			EXPECT_EQ( 1, counts[c] )<<"dimension "<<dimension<<" interval "<<c;
+	}
+}
+
+//Different seeds must give different scramblings of the sequence
+TEST( RandomSobolTests, SeedsChangeTheScrambling )
+{
+	RandomSobol first( 5489 );
+	RandomSobol second( 5490 );
+
+	int equalSamples = 0;
+	for( unsigned long path = 0; path < 256; ++path )
+		if( first.PathSample( path, 0 ) == second.PathSample( path, 0 ) )	++equalSamples;
+	EXPECT_LT( equalSamples, 4 );
+}
@@ -0,0 +1,197 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+
+#include "RayTracingProfiler.h"
+
+#include "TestsAuxiliaryFunctions.h"
+
+//Thread that adds a transmissivity time to the profiler
+class ProfiledThread : public QThread
+{
+protected:
+	void run()
+	{
+		RayTracingProfiler::AddPhaseTime( RayTracingProfiler::Transmissivity, 0.5 );
+	}
+};
+
+static QStringList ReadReport( QString fileName )
+{
+	QFile reportFile( fileName );
+	if( !reportFile.open( QIODevice::ReadOnly | QIODevice::Text ) )	return QStringList();
+	QTextStream in( &reportFile );
+	return in.readAll().split( QLatin1Char( '\n' ), QString::SkipEmptyParts );
+}
+
+/*!
+ * Returns the report line of \a phase and \a shapeType without the thread column.
+ */
+static QString FindReportLine( const QStringList& lines, QString phase, QString shapeType )
+{
+	for( int l = 1; l < lines.size(); ++l )
+	{
+		QString line = lines[l].section( QLatin1Char( ',' ), 1 );
+		if( line.section( QLatin1Char( ',' ), 0, 0 ) == phase && line.section( QLatin1Char( ',' ), 1, 1 ) == shapeType )
+			return line;
+	}
+	return QString();
+}
+
+TEST( RayTracingProfilerTests, DisabledProfilerDoesNotRecord )
+{
+	taf::TemporaryDirectory directory;
+	RayTracingProfiler::SetEnabled( false );
+	RayTracingProfiler::Reset();
+	EXPECT_FALSE( RayTracingProfiler::IsEnabled() );
+
+	{
+		ProfilerTimer profilerTimer( RayTracingProfiler::Traversal );
+	}
+	{
+		ProfilerTimer profilerTimer( RayTracingProfiler::ShapeIntersection, "TShapeTest" );
+	}
+
+	QString fileName = directory.FilePath( "disabled.csv" );
+	ASSERT_TRUE( RayTracingProfiler::WriteReport( fileName ) );
+	QStringList lines = ReadReport( fileName );
+	ASSERT_EQ( 1, lines.size() );
+	EXPECT_EQ( QString( "thread,phase,shape_type,calls,time_s" ), lines[0] );
+}
+
+TEST( RayTracingProfilerTests, AccumulatesTimesAndCalls )
+{
+	taf::TemporaryDirectory directory;
+	RayTracingProfiler::SetEnabled( true );
+	RayTracingProfiler::Reset();
+	EXPECT_TRUE( RayTracingProfiler::IsEnabled() );
+
+	static const char* shapeType = "TShapeTest";
+	RayTracingProfiler::AddPhaseTime( RayTracingProfiler::Traversal, 0.25 );
+	RayTracingProfiler::AddPhaseTime( RayTracingProfiler::Traversal, 0.5 );
+	RayTracingProfiler::AddShapeTime( RayTracingProfiler::ShapeIntersection, shapeType, 0.125 );
+	RayTracingProfiler::AddShapeTime( RayTracingProfiler::ShapeIntersection, shapeType, 0.125 );
+	RayTracingProfiler::AddShapeTime( RayTracingProfiler::ShapeIntersection, shapeType, 0.25 );
+	RayTracingProfiler::AddShapeTime( RayTracingProfiler::ShapeDifferentialGeometry, shapeType, 0.0625 );
+
+	QString fileName = directory.FilePath( "accumulation.csv" );
+	ASSERT_TRUE( RayTracingProfiler::WriteReport( fileName ) );
+	QStringList lines = ReadReport( fileName );
+	ASSERT_EQ( 6, lines.size() );
+	EXPECT_EQ( QString( "traversal,,2,0.75" ), FindReportLine( lines, QLatin1String( "traversal" ), QString() ) );
+	EXPECT_EQ( QString( "shape_intersection,,3,0.5" ), FindReportLine( lines, QLatin1String( "shape_intersection" ), QString() ) );
+	EXPECT_EQ( QString( "shape_intersection,TShapeTest,3,0.5" ),
+			FindReportLine( lines, QLatin1String( "shape_intersection" ), QLatin1String( "TShapeTest" ) ) );
+
+	//The differential geometry of the shape is not added to its intersection
+	EXPECT_EQ( QString( "shape_differential_geometry,,1,0.0625" ),
+			FindReportLine( lines, QLatin1String( "shape_differential_geometry" ), QString() ) );
+	EXPECT_EQ( QString( "shape_differential_geometry,TShapeTest,1,0.0625" ),
+			FindReportLine( lines, QLatin1String( "shape_differential_geometry" ), QLatin1String( "TShapeTest" ) ) );
+
+	RayTracingProfiler::Reset();
+	ASSERT_TRUE( RayTracingProfiler::WriteReport( fileName ) );
+	EXPECT_EQ( 1, ReadReport( fileName ).size() );
+
+	RayTracingProfiler::SetEnabled( false );
+}
+
+TEST( RayTracingProfilerTests, ProfilerTimerMeasuresScope )
+{
+	taf::TemporaryDirectory directory;
+	RayTracingProfiler::SetEnabled( true );
+	RayTracingProfiler::Reset();
+
+	for( int i = 0; i < 3; ++i )
+	{
+		ProfilerTimer profilerTimer( RayTracingProfiler::MaterialOutputRay );
+	}
+
+	QString fileName = directory.FilePath( "timer.csv" );
+	ASSERT_TRUE( RayTracingProfiler::WriteReport( fileName ) );
+	QString line = FindReportLine( ReadReport( fileName ), QLatin1String( "material_output_ray" ), QString() );
+	EXPECT_EQ( QString( "3" ), line.section( QLatin1Char( ',' ), 2, 2 ) );
+	EXPECT_GE( line.section( QLatin1Char( ',' ), 3, 3 ).toDouble(), 0.0 );
+
+	RayTracingProfiler::SetEnabled( false );
+}
+
+TEST( RayTracingProfilerTests, JSONReport )
+{
+	taf::TemporaryDirectory directory;
+	RayTracingProfiler::SetEnabled( true );
+	RayTracingProfiler::Reset();
+	RayTracingProfiler::AddShapeTime( RayTracingProfiler::ShapeIntersection, "TShapeTest", 0.5 );
+
+	QString fileName = directory.FilePath( "report.json" );
+	ASSERT_TRUE( RayTracingProfiler::WriteReport( fileName ) );
+	QString report = ReadReport( fileName ).join( QLatin1String( "\n" ) );
+	EXPECT_TRUE( report.startsWith( QLatin1String( "{" ) ) );
+	EXPECT_TRUE( report.contains( QLatin1String( "\"shape_intersection\": { \"calls\": 1, \"time_s\": 0.5 }" ) ) );
+	EXPECT_TRUE( report.contains( QLatin1String( "\"TShapeTest\": { \"calls\": 1, \"time_s\": 0.5 }" ) ) );
+
+	RayTracingProfiler::Reset();
+	RayTracingProfiler::SetEnabled( false );
+}
+
+TEST( RayTracingProfilerTests, FinishedThreadRecordIsKeptUntilReset )
+{
+	taf::TemporaryDirectory directory;
+	RayTracingProfiler::SetEnabled( true );
+	RayTracingProfiler::Reset();
+
+	ProfiledThread thread;
+	thread.start();
+	ASSERT_TRUE( thread.wait( 10000 ) );
+
+	QString fileName = directory.FilePath( "thread.csv" );
+	ASSERT_TRUE( RayTracingProfiler::WriteReport( fileName ) );
+	EXPECT_EQ( QString( "transmissivity,,1,0.5" ), FindReportLine( ReadReport( fileName ), QLatin1String( "transmissivity" ), QString() ) );
+
+	RayTracingProfiler::Reset();
+	ASSERT_TRUE( RayTracingProfiler::WriteReport( fileName ) );
+	EXPECT_TRUE( FindReportLine( ReadReport( fileName ), QLatin1String( "transmissivity" ), QString() ).isEmpty() );
+
+	RayTracingProfiler::SetEnabled( false );
+}
@@ -0,0 +1,228 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <Inventor/actions/SoSearchAction.h>
+
+#include <QDir>
+#include <QFile>
+
+#include "Document.h"
+#include "SceneCache.h"
+#include "ShapeFlatRectangle.h"
+#include "TSceneKit.h"
+
+#include "TestsAuxiliaryFunctions.h"
+
+static void WriteSceneFile( const QString& fileName, const char* contents )
+{
+	QFile sceneFile( fileName );
+	ASSERT_TRUE( sceneFile.open( QIODevice::WriteOnly ) );
+	sceneFile.write( contents );
+	sceneFile.close();
+}
+
+//Returns the first flat rectangle of the \a scene
+static ShapeFlatRectangle* FindFlatRectangle( TSceneKit* scene )
+{
+	SoSearchAction search;
+	search.setType( ShapeFlatRectangle::getClassTypeId() );
+	search.setInterest( SoSearchAction::FIRST );
+	search.setSearchingAll( true );
+	search.apply( scene );
+	if( !search.getPath() )	return 0;
+	return static_cast< ShapeFlatRectangle* >( search.getPath()->getTail() );
+}
+
+TEST( SceneCacheTests, DisabledCacheIsEmpty )
+{
+	taf::TemporaryDirectory directory;
+	QString fileName = directory.FilePath( "scene.tnh" );
+	WriteSceneFile( fileName, "scene" );
+
+	SceneCache::SetEnabled( false );
+	TSceneKit* scene = new TSceneKit;
+	scene->ref();
+	SceneCache::Insert( fileName, scene );
+	EXPECT_TRUE( SceneCache::Copy( fileName ) == 0 );
+
+	scene->unref();
+}
+
+TEST( SceneCacheTests, CopiesCachedScene )
+{
+	taf::TemporaryDirectory directory;
+	QString fileName = directory.FilePath( "scene.tnh" );
+	WriteSceneFile( fileName, "scene" );
+
+	SceneCache::SetEnabled( true );
+	TSceneKit* scene = new TSceneKit;
+	scene->ref();
+	scene->setName( "CachedScene" );
+	SceneCache::Insert( fileName, scene );
+
+	TSceneKit* copy = SceneCache::Copy( fileName );
+	ASSERT_TRUE( copy != 0 );
+	EXPECT_TRUE( copy != scene );
+	EXPECT_EQ( 1, copy->getRefCount() );
+	EXPECT_TRUE( copy->getName() == SbName( "CachedScene" ) );
+
+	//The cached scene does not change with the scenes copied from it
+	copy->setName( "ModifiedScene" );
+	TSceneKit* secondCopy = SceneCache::Copy( fileName );
+	ASSERT_TRUE( secondCopy != 0 );
+	EXPECT_TRUE( secondCopy->getName() == SbName( "CachedScene" ) );
+
+	copy->unref();
+	secondCopy->unref();
+	scene->unref();
+	SceneCache::SetEnabled( false );
+}
+
+TEST( SceneCacheTests, ModifiedFileIsReadAgain )
+{
+	taf::TemporaryDirectory directory;
+	QString fileName = directory.FilePath( "scene.tnh" );
+	WriteSceneFile( fileName, "scene" );
+
+	SceneCache::SetEnabled( true );
+	TSceneKit* scene = new TSceneKit;
+	scene->ref();
+	SceneCache::Insert( fileName, scene );
+
+	WriteSceneFile( fileName, "modified scene" );
+	EXPECT_TRUE( SceneCache::Copy( fileName ) == 0 );
+
+	scene->unref();
+	SceneCache::SetEnabled( false );
+}
+
+TEST( SceneCacheTests, CopyOfModelFileIsIndependent )
+{
+	QString fileName = QDir( TEST_DIR ).absoluteFilePath( "SolarFurnace_normal.tnh" );
+
+	SceneCache::SetEnabled( true );
+	Document document;
+	ASSERT_TRUE( document.ReadFile( fileName ) );
+
+	TSceneKit* copy = SceneCache::Copy( fileName );
+	ASSERT_TRUE( copy != 0 );
+	ShapeFlatRectangle* cachedRectangle = FindFlatRectangle( copy );
+	ASSERT_TRUE( cachedRectangle != 0 );
+	double width = cachedRectangle->width.getValue();
+
+	//The shapes of the copies are not shared with the cached scene
+	TSceneKit* modifiedCopy = SceneCache::Copy( fileName );
+	ASSERT_TRUE( modifiedCopy != 0 );
+	ShapeFlatRectangle* modifiedRectangle = FindFlatRectangle( modifiedCopy );
+	ASSERT_TRUE( modifiedRectangle != 0 );
+	EXPECT_TRUE( modifiedRectangle != cachedRectangle );
+	modifiedRectangle->width.setValue( width + 1.0 );
+
+	TSceneKit* secondCopy = SceneCache::Copy( fileName );
+	ASSERT_TRUE( secondCopy != 0 );
+	ShapeFlatRectangle* secondRectangle = FindFlatRectangle( secondCopy );
+	ASSERT_TRUE( secondRectangle != 0 );
+	EXPECT_DOUBLE_EQ( width, secondRectangle->width.getValue() );
+
+	//Nor with the scene of the document that read the file
+	ShapeFlatRectangle* documentRectangle = FindFlatRectangle( document.GetSceneKit() );
+	ASSERT_TRUE( documentRectangle != 0 );
+	EXPECT_TRUE( documentRectangle != secondRectangle );
+	EXPECT_DOUBLE_EQ( width, documentRectangle->width.getValue() );
+
+	copy->unref();
+	modifiedCopy->unref();
+	secondCopy->unref();
+	SceneCache::SetEnabled( false );
+}
+
+TEST( SceneCacheTests, LeastRecentlyUsedScenesAreReleased )
+{
+	taf::TemporaryDirectory directory;
+	QString firstFileName = directory.FilePath( "first.tnh" );
+	QString secondFileName = directory.FilePath( "second.tnh" );
+	QString thirdFileName = directory.FilePath( "third.tnh" );
+	QString largeFileName = directory.FilePath( "large.tnh" );
+	WriteSceneFile( firstFileName, "0123456789" );
+	WriteSceneFile( secondFileName, "0123456789" );
+	WriteSceneFile( thirdFileName, "0123456789" );
+	WriteSceneFile( largeFileName, "0123456789012345678901234567890" );
+
+	SceneCache::SetEnabled( true );
+	qint64 maximumSize = SceneCache::GetMaximumSize();
+	SceneCache::SetMaximumSize( 25 );
+
+	TSceneKit* scene = new TSceneKit;
+	scene->ref();
+	SceneCache::Insert( firstFileName, scene );
+	SceneCache::Insert( secondFileName, scene );
+
+	//The first scene is used after the second one, so the second one is released for the third one
+	TSceneKit* firstCopy = SceneCache::Copy( firstFileName );
+	ASSERT_TRUE( firstCopy != 0 );
+	firstCopy->unref();
+	SceneCache::Insert( thirdFileName, scene );
+	EXPECT_TRUE( SceneCache::Copy( secondFileName ) == 0 );
+
+	TSceneKit* thirdCopy = SceneCache::Copy( thirdFileName );
+	ASSERT_TRUE( thirdCopy != 0 );
+	thirdCopy->unref();
+	firstCopy = SceneCache::Copy( firstFileName );
+	ASSERT_TRUE( firstCopy != 0 );
+	firstCopy->unref();
+
+	//A file larger than the cache is not cached and the cached scenes are kept
+	SceneCache::Insert( largeFileName, scene );
+	EXPECT_TRUE( SceneCache::Copy( largeFileName ) == 0 );
+	firstCopy = SceneCache::Copy( firstFileName );
+	ASSERT_TRUE( firstCopy != 0 );
+	firstCopy->unref();
+
+	//A smaller maximum size releases the scenes that do not fit
+	SceneCache::SetMaximumSize( 15 );
+	EXPECT_TRUE( SceneCache::Copy( thirdFileName ) == 0 );
+	firstCopy = SceneCache::Copy( firstFileName );
+	ASSERT_TRUE( firstCopy != 0 );
+	firstCopy->unref();
+
+	scene->unref();
+	SceneCache::SetMaximumSize( maximumSize );
+	SceneCache::SetEnabled( false );
+}
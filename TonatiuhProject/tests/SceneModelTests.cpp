@@ -0,0 +1,151 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <QModelIndex>
+
+#include "InstanceNode.h"
+#include "SceneModel.h"
+#include "TSceneKit.h"
+#include "TSeparatorKit.h"
+
+static TSeparatorKit* CreateGroup( const char* name )
+{
+	TSeparatorKit* group = new TSeparatorKit;
+	group->setName( name );
+	return group;
+}
+
+static SoNode* NodeFromUrl( const SceneModel& model, const char* nodeUrl )
+{
+	QModelIndex nodeIndex = model.IndexFromNodeUrl( QLatin1String( nodeUrl ) );
+	if( !nodeIndex.isValid() )	return 0;
+	return model.NodeFromIndex( nodeIndex )->GetNode();
+}
+
+TEST( SceneModelTests, InsertedNodesAreIndexed )
+{
+	TSceneKit* scene = new TSceneKit;
+	scene->ref();
+	SceneModel* model = new SceneModel;
+	model->SetCoinScene( *scene );
+
+	TSeparatorKit* concentratorRoot = static_cast< TSeparatorKit* >( NodeFromUrl( *model, "//SunNode/RootNode" ) );
+	ASSERT_TRUE( concentratorRoot != 0 );
+	EXPECT_TRUE( NodeFromUrl( *model, "//SunNode/RootNode/Group" ) == 0 );
+
+	TSeparatorKit* group = CreateGroup( "Group" );
+	model->InsertCoinNode( *group, *concentratorRoot );
+	TSeparatorKit* child = CreateGroup( "Child" );
+	model->InsertCoinNode( *child, *group );
+
+	EXPECT_TRUE( NodeFromUrl( *model, "//SunNode/RootNode/Group" ) == group );
+	EXPECT_TRUE( NodeFromUrl( *model, "//SunNode/RootNode/Group/Child" ) == child );
+
+	QModelIndex childIndex = model->IndexFromNodeUrl( QLatin1String( "//SunNode/RootNode/Group/Child" ) );
+	EXPECT_EQ( model->IndexFromNodeUrl( QLatin1String( "//SunNode/RootNode/Group" ) ), model->parent( childIndex ) );
+
+	EXPECT_FALSE( model->IndexFromNodeUrl( QLatin1String( "//SunNode/Unknown/Group" ) ).isValid() );
+	EXPECT_FALSE( model->IndexFromNodeUrl( QLatin1String( "//SunNode/RootNode/Child" ) ).isValid() );
+
+	delete model;
+	scene->unref();
+}
+
+TEST( SceneModelTests, RemovedNodesAreNotIndexed )
+{
+	TSceneKit* scene = new TSceneKit;
+	scene->ref();
+	SceneModel* model = new SceneModel;
+	model->SetCoinScene( *scene );
+
+	TSeparatorKit* concentratorRoot = static_cast< TSeparatorKit* >( NodeFromUrl( *model, "//SunNode/RootNode" ) );
+	ASSERT_TRUE( concentratorRoot != 0 );
+
+	TSeparatorKit* firstGroup = CreateGroup( "FirstGroup" );
+	int firstRow = model->InsertCoinNode( *firstGroup, *concentratorRoot );
+	TSeparatorKit* secondGroup = CreateGroup( "SecondGroup" );
+	model->InsertCoinNode( *secondGroup, *concentratorRoot );
+	model->InsertCoinNode( *CreateGroup( "Child" ), *firstGroup );
+
+	model->RemoveCoinNode( firstRow, *concentratorRoot );
+
+	EXPECT_TRUE( NodeFromUrl( *model, "//SunNode/RootNode/FirstGroup" ) == 0 );
+	EXPECT_TRUE( NodeFromUrl( *model, "//SunNode/RootNode/FirstGroup/Child" ) == 0 );
+	EXPECT_TRUE( NodeFromUrl( *model, "//SunNode/RootNode/SecondGroup" ) == secondGroup );
+
+	//The row of the index follows the removal
+	QModelIndex secondIndex = model->IndexFromNodeUrl( QLatin1String( "//SunNode/RootNode/SecondGroup" ) );
+	EXPECT_EQ( firstRow, secondIndex.row() );
+
+	delete model;
+	scene->unref();
+}
+
+TEST( SceneModelTests, RenamedNodesAreIndexedWithTheNewUrl )
+{
+	TSceneKit* scene = new TSceneKit;
+	scene->ref();
+	SceneModel* model = new SceneModel;
+	model->SetCoinScene( *scene );
+
+	TSeparatorKit* concentratorRoot = static_cast< TSeparatorKit* >( NodeFromUrl( *model, "//SunNode/RootNode" ) );
+	ASSERT_TRUE( concentratorRoot != 0 );
+
+	TSeparatorKit* group = CreateGroup( "Group" );
+	model->InsertCoinNode( *group, *concentratorRoot );
+	TSeparatorKit* child = CreateGroup( "Child" );
+	model->InsertCoinNode( *child, *group );
+	TSeparatorKit* sibling = CreateGroup( "Sibling" );
+	model->InsertCoinNode( *sibling, *concentratorRoot );
+
+	EXPECT_TRUE( model->SetNodeName( group, QLatin1String( "RenamedGroup" ) ) );
+	EXPECT_TRUE( NodeFromUrl( *model, "//SunNode/RootNode/Group" ) == 0 );
+	EXPECT_TRUE( NodeFromUrl( *model, "//SunNode/RootNode/Group/Child" ) == 0 );
+	EXPECT_TRUE( NodeFromUrl( *model, "//SunNode/RootNode/RenamedGroup" ) == group );
+	EXPECT_TRUE( NodeFromUrl( *model, "//SunNode/RootNode/RenamedGroup/Child" ) == child );
+
+	//A sibling name can not be used
+	EXPECT_FALSE( model->SetNodeName( group, QLatin1String( "Sibling" ) ) );
+	EXPECT_TRUE( NodeFromUrl( *model, "//SunNode/RootNode/RenamedGroup" ) == group );
+	EXPECT_TRUE( NodeFromUrl( *model, "//SunNode/RootNode/Sibling" ) == sibling );
+
+	delete model;
+	scene->unref();
+}
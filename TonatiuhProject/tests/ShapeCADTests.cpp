@@ -0,0 +1,124 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "DifferentialGeometry.h"
+#include "Point3D.h"
+#include "Ray.h"
+#include "ShapeCAD.h"
+#include "Transform.h"
+#include "Vector3D.h"
+
+/*!
+ * Creates a flat rectangle mesh of two facets from (0,0,0) to (\a width,0,\a length).
+ */
+static ShapeCAD* CreateRectangleMesh( double width, double length )
+{
+	std::vector< Point3D > vertices;
+	vertices.push_back( Point3D( 0.0, 0.0, 0.0 ) );
+	vertices.push_back( Point3D( width, 0.0, 0.0 ) );
+	vertices.push_back( Point3D( width, 0.0, length ) );
+	vertices.push_back( Point3D( 0.0, 0.0, length ) );
+
+	int facets[6] = { 0, 2, 1, 0, 3, 2 };
+	std::vector< int > facetVertices( facets, facets + 6 );
+
+	ShapeCAD* shape = new ShapeCAD;
+	shape->ref();
+	shape->SetMesh( vertices, facetVertices );
+	return shape;
+}
+
+TEST( ShapeCADTests, HitCoordinatesAreMeshCoordinates )
+{
+	ShapeCAD* shape = CreateRectangleMesh( 2.0, 3.0 );
+
+	Ray ray( Point3D( 0.5, 1.0, 2.25 ), Vector3D( 0.0, -1.0, 0.0 ) );
+	ShapeHit hit;
+	ASSERT_TRUE( shape->IntersectT( ray, &hit ) );
+	DifferentialGeometry dg;
+	shape->ComputeDifferentialGeometry( ray, hit, &dg );
+	EXPECT_NEAR( 0.25, dg.u, 1e-12 );
+	EXPECT_NEAR( 0.75, dg.v, 1e-12 );
+
+	shape->unref();
+}
+
+TEST( ShapeCADTests, ParametricAreasAddClippedFacets )
+{
+	ShapeCAD* shape = CreateRectangleMesh( 2.0, 3.0 );
+
+	Transform identity( 1.0, 0.0, 0.0, 0.0,
+						0.0, 1.0, 0.0, 0.0,
+						0.0, 0.0, 1.0, 0.0,
+						0.0, 0.0, 0.0, 1.0 );
+	std::vector< double > cellAreas;
+	ASSERT_TRUE( shape->ComputeParametricAreas( identity, 3, 4, &cellAreas ) );
+	ASSERT_EQ( 12u, cellAreas.size() );
+	for( unsigned int c = 0; c < cellAreas.size(); ++c )
+		EXPECT_NEAR( 0.5, cellAreas[c], 1e-12 );
+
+	//The areas are computed in world coordinates
+	Transform scale( 2.0, 0.0, 0.0, 0.0,
+					0.0, 1.0, 0.0, 0.0,
+					0.0, 0.0, 1.0, 0.0,
+					0.0, 0.0, 0.0, 1.0 );
+	ASSERT_TRUE( shape->ComputeParametricAreas( scale, 3, 4, &cellAreas ) );
+	for( unsigned int c = 0; c < cellAreas.size(); ++c )
+		EXPECT_NEAR( 1.0, cellAreas[c], 1e-12 );
+
+	shape->unref();
+}
+
+TEST( ShapeCADTests, EmptyMeshHasNoParametricAreas )
+{
+	ShapeCAD* shape = new ShapeCAD;
+	shape->ref();
+
+	Transform identity( 1.0, 0.0, 0.0, 0.0,
+						0.0, 1.0, 0.0, 0.0,
+						0.0, 0.0, 1.0, 0.0,
+						0.0, 0.0, 0.0, 1.0 );
+	std::vector< double > cellAreas;
+	EXPECT_FALSE( shape->ComputeParametricAreas( identity, 2, 2, &cellAreas ) );
+
+	shape->unref();
+}
@@ -0,0 +1,249 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "DifferentialGeometry.h"
+#include "gc.h"
+#include "Point3D.h"
+#include "Ray.h"
+#include "ShapeTroughAsymmetricCPC.h"
+#include "ShapeTroughCPC.h"
+#include "Vector3D.h"
+
+/*!
+ * Deviation between the CPC profile and the ray for the profile angle \a theta, as it was evaluated by the analytic root search.
+ */
+static double AnalyticDeviation( double theta, double a, double thetaI, const Ray& ray )
+{
+	double xrd = ray.direction().x;
+	double xro = ray.origin.x;
+	double yrd = ray.direction().y;
+	double yro = ray.origin.y;
+
+	return ( 1 /(-1 + cos( theta ))) * ( (a + xro ) * yrd - xrd * yro + (-xro * yrd + xrd * yro ) * cos(theta)
+					+ a * ( -yrd * ( cos(theta - 2 * thetaI ) + 2 * sin( theta - thetaI ))
+					+ 2 * xrd * cos( theta - thetaI ) * (1 + sin(thetaI) ) ) );
+}
+
+/*!
+ * Returns the closest intersection distance of \a ray with the CPC profile from a dense scan of the analytic deviation.
+ * Returns a negative value if there is no intersection.
+ */
+static double AnalyticIntersection( double a, double thetaI, const Ray& ray, double tolerance )
+{
+	double thetaMin = 2 * thetaI;
+	double thetaMax = ( gc::Pi / 2 ) + thetaI;
+	int nIntervals = 20000;
+
+	double tHit = -1.0;
+	double theta0 = thetaMin;
+	double deviation0 = AnalyticDeviation( theta0, a, thetaI, ray );
+	for( int i = 1; i <= nIntervals; ++i )
+	{
+		double theta1 = thetaMin + i * ( thetaMax - thetaMin ) / nIntervals;
+		double deviation1 = AnalyticDeviation( theta1, a, thetaI, ray );
+		if( ( deviation0 < 0.0 ) != ( deviation1 < 0.0 ) )
+		{
+			double inf = theta0;
+			double sup = theta1;
+			double deviationInf = deviation0;
+			while( ( sup - inf ) > 1.0e-13 )
+			{
+				double theta = ( inf + sup ) / 2.0;
+				double deviation = AnalyticDeviation( theta, a, thetaI, ray );
+				if( ( deviation < 0.0 ) == ( deviationInf < 0.0 ) )
+				{
+					inf = theta;
+					deviationInf = deviation;
+				}
+				else	sup = theta;
+			}
+			double theta = ( inf + sup ) / 2.0;
+
+			double x = ( ( 2 * a * ( 1 + sin( thetaI ) ) * sin( theta - thetaI ) ) / ( 1 - cos( theta ) ) ) - a;
+			double y = ( 2 * a * ( 1 + sin( thetaI ) ) * cos( theta - thetaI ) ) / ( 1 - cos( theta ) );
+			double t = ( fabs( ray.direction().x ) > fabs( ray.direction().y ) ) ? ( x - ray.origin.x ) / ray.direction().x
+																				: ( y - ray.origin.y ) / ray.direction().y;
+			if( ( t >= tolerance ) && ( ( tHit < 0.0 ) || ( t < tHit ) ) )	tHit = t;
+		}
+		theta0 = theta1;
+		deviation0 = deviation1;
+	}
+
+	return tHit;
+}
+
+static double RandomValue( double min, double max )
+{
+	return min + ( max - min ) * ( rand() / ( RAND_MAX + 1.0 ) );
+}
+
+/*!
+ * Returns true if a ray parallel to the profile tangent at \a u, and moved \a offset from it to any of the sides,
+ * intersects \a shape within \a distance of the tangency point.
+ */
+static bool IntersectsNearTangent( TShape* shape, double u, double offset, double back, double distance )
+{
+	double du = 0.000001;
+	Point3D point = shape->Sample( u, 0.5 );
+	Vector3D tangent = Normalize( shape->Sample( u + du, 0.5 ) - shape->Sample( u - du, 0.5 ) );
+	Vector3D normal( -tangent.y, tangent.x, 0.0 );
+
+	for( int side = -1; side <= 1; side += 2 )
+	{
+		Ray ray( point + normal * ( side * offset ) - tangent * back, tangent );
+		ShapeHit hit;
+		if( shape->IntersectT( ray, &hit ) && ( Distance( ray( hit.tHit ), point ) < distance ) )	return true;
+	}
+	return false;
+}
+
+TEST( ShapeTroughCPCTests, MatchesAnalyticRootSearch )
+{
+	ShapeTroughCPC* cpc = new ShapeTroughCPC;
+	cpc->ref();
+	double a = cpc->a.getValue();
+	double thetaI = asin( 1 / cpc->cMax.getValue() );
+
+	srand( 31 );
+	int nHits = 0;
+	for( int r = 0; r < 2000; ++r )
+	{
+		double angle = RandomValue( 0.0, 2 * gc::Pi );
+		Ray ray( Point3D( RandomValue( -2.0, 2.0 ), RandomValue( -1.0, 4.0 ), 0.0 ), Vector3D( cos( angle ), sin( angle ), 0.0 ) );
+
+		double tExpected = AnalyticIntersection( a, thetaI, ray, 0.0001 );
+		ShapeHit hit;
+		bool isHit = cpc->IntersectT( ray, &hit );
+		ASSERT_EQ( tExpected >= 0.0, isHit );
+		if( isHit )
+		{
+			EXPECT_NEAR( tExpected, hit.tHit, 1.0e-8 );
+
+			// The differential geometry uses the profile angle stored in the hit
+			DifferentialGeometry dg;
+			cpc->ComputeDifferentialGeometry( ray, hit, &dg );
+			ASSERT_TRUE( ( dg.u >= 0.0 ) && ( dg.u <= 1.0 ) );
+			EXPECT_LT( Distance( cpc->Sample( dg.u, dg.v ), dg.point ), 1.0e-6 );
+			nHits++;
+		}
+	}
+	EXPECT_GT( nHits, 100 );
+
+	cpc->unref();
+}
+
+TEST( ShapeTroughCPCTests, ApertureAndTruncationEdges )
+{
+	ShapeTroughCPC* cpc = new ShapeTroughCPC;
+	cpc->ref();
+	cpc->height.setValue( 1.2 );
+
+	//The profile is searched only between the truncation and the receiver, so the rays that would
+	//hit the untruncated profile above the truncation or its extension below the receiver miss
+	double xMin = cpc->a.getValue();
+	Point3D top = cpc->Sample( 0.0, 0.5 );
+	EXPECT_NEAR( 1.2, top.y, 1.0e-3 );
+	double delta = 0.0001;
+	ShapeHit hit;
+
+	//Vertical rays next to the truncation edge
+	Ray insideTop( Point3D( top.x - delta, 10.0, 0.0 ), Vector3D( 0.0, -1.0, 0.0 ) );
+	ASSERT_TRUE( cpc->IntersectT( insideTop, &hit ) );
+	EXPECT_NEAR( top.y, insideTop( hit.tHit ).y, 0.01 );
+	EXPECT_FALSE( cpc->IntersectT( Ray( Point3D( top.x + delta, 10.0, 0.0 ), Vector3D( 0.0, -1.0, 0.0 ) ), &hit ) );
+
+	//Horizontal rays next to the truncation edge
+	Ray belowTop( Point3D( 5.0, top.y - delta, 0.0 ), Vector3D( -1.0, 0.0, 0.0 ) );
+	ASSERT_TRUE( cpc->IntersectT( belowTop, &hit ) );
+	EXPECT_NEAR( top.x, belowTop( hit.tHit ).x, 0.01 );
+	EXPECT_FALSE( cpc->IntersectT( Ray( Point3D( 5.0, top.y + delta, 0.0 ), Vector3D( -1.0, 0.0, 0.0 ) ), &hit ) );
+
+	//Horizontal rays next to the receiver edge
+	Ray aboveReceiver( Point3D( 0.0, delta, 0.0 ), Vector3D( 1.0, 0.0, 0.0 ) );
+	ASSERT_TRUE( cpc->IntersectT( aboveReceiver, &hit ) );
+	EXPECT_NEAR( xMin, aboveReceiver( hit.tHit ).x, 0.01 );
+	EXPECT_FALSE( cpc->IntersectT( Ray( Point3D( 0.0, -delta, 0.0 ), Vector3D( 1.0, 0.0, 0.0 ) ), &hit ) );
+
+	//Rays next to the trough ends, that are at z = +-0.5 for the default lengths
+	Ray insideEnd( Point3D( 0.0, delta, 0.5 - delta ), Vector3D( 1.0, 0.0, 0.0 ) );
+	ASSERT_TRUE( cpc->IntersectT( insideEnd, &hit ) );
+	DifferentialGeometry dg;
+	cpc->ComputeDifferentialGeometry( insideEnd, hit, &dg );
+	EXPECT_NEAR( 1.0, dg.u, 0.01 );
+	EXPECT_LE( dg.v, 1.0 );
+	EXPECT_GT( dg.v, 0.99 );
+	EXPECT_FALSE( cpc->IntersectT( Ray( Point3D( 0.0, delta, 0.5 + delta ), Vector3D( 1.0, 0.0, 0.0 ) ), &hit ) );
+	EXPECT_FALSE( cpc->IntersectT( Ray( Point3D( 0.0, delta, -0.5 - delta ), Vector3D( 1.0, 0.0, 0.0 ) ), &hit ) );
+
+	cpc->unref();
+}
+
+TEST( ShapeTroughCPCTests, GrazingRays )
+{
+	ShapeTroughCPC* cpc = new ShapeTroughCPC;
+	cpc->ref();
+
+	for( double u = 0.025; u < 1.0; u += 0.05 )
+	{
+		EXPECT_TRUE( IntersectsNearTangent( cpc, u, 0.000001, 0.05, 0.02 ) ) << "u = " << u;
+		EXPECT_TRUE( IntersectsNearTangent( cpc, u, 0.00001, 0.05, 0.02 ) ) << "u = " << u;
+	}
+
+	cpc->unref();
+}
+
+TEST( ShapeTroughAsymmetricCPCTests, GrazingRays )
+{
+	ShapeTroughAsymmetricCPC* cpc = new ShapeTroughAsymmetricCPC;
+	cpc->ref();
+
+	for( double u = 0.0125; u < 1.0; u += 0.025 )
+	{
+		if( fabs( u - 0.5 ) < 0.02 )	continue;
+		EXPECT_TRUE( IntersectsNearTangent( cpc, u, 0.0000001, 0.005, 0.002 ) ) << "u = " << u;
+		EXPECT_TRUE( IntersectsNearTangent( cpc, u, 0.000001, 0.005, 0.002 ) ) << "u = " << u;
+	}
+
+	cpc->unref();
+}
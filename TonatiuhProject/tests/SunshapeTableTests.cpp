@@ -0,0 +1,124 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include "SunshapeTable.h"
+
+TEST( SunshapeTableTests, EmptyTable )
+{
+	SunshapeTable table;
+	EXPECT_TRUE( table.IsEmpty() );
+	EXPECT_DOUBLE_EQ( 0.0, table.GetThetaMax() );
+}
+
+TEST( SunshapeTableTests, InvalidProfiles )
+{
+	SunshapeTable table;
+
+	std::vector< double > theta( 1, 0.0 );
+	std::vector< double > radiance( 1, 1.0 );
+	EXPECT_FALSE( table.SetProfile( theta, radiance ) );
+	EXPECT_TRUE( table.IsEmpty() );
+
+	theta.push_back( -0.001 );
+	radiance.push_back( 1.0 );
+	EXPECT_FALSE( table.SetProfile( theta, radiance ) );
+	EXPECT_TRUE( table.IsEmpty() );
+
+	theta[1] = 0.001;
+	radiance[1] = -1.0;
+	EXPECT_FALSE( table.SetProfile( theta, radiance ) );
+	EXPECT_TRUE( table.IsEmpty() );
+
+	radiance[0] = 0.0;
+	radiance[1] = 0.0;
+	EXPECT_FALSE( table.SetProfile( theta, radiance ) );
+	EXPECT_TRUE( table.IsEmpty() );
+}
+
+TEST( SunshapeTableTests, PillboxProfile )
+{
+	double thetaMax = 0.00465;
+
+	std::vector< double > theta;
+	theta.push_back( 0.0 );
+	theta.push_back( thetaMax );
+	std::vector< double > radiance( 2, 1.0 );
+
+	SunshapeTable table;
+	ASSERT_TRUE( table.SetProfile( theta, radiance ) );
+	EXPECT_FALSE( table.IsEmpty() );
+	EXPECT_DOUBLE_EQ( thetaMax, table.GetThetaMax() );
+
+	EXPECT_NEAR( 0.0, table.SampleTheta( 0.0 ), 1.0e-12 );
+	EXPECT_NEAR( thetaMax, table.SampleTheta( 1.0 ), 1.0e-9 * thetaMax );
+
+	// The cumulative distribution of a uniform radiance is ( 1 - cos( theta ) ) / ( 1 - cos( thetaMax ) )
+	for( int i = 1; i < 100; ++i )
+	{
+		double u = i / 100.0;
+		double expected = acos( 1.0 - u * ( 1.0 - cos( thetaMax ) ) );
+		EXPECT_NEAR( expected, table.SampleTheta( u ), 1.0e-6 * thetaMax );
+	}
+}
+
+TEST( SunshapeTableTests, SamplesAreIncreasing )
+{
+	std::vector< double > theta;
+	std::vector< double > radiance;
+	for( int i = 0; i <= 20; ++i )
+	{
+		theta.push_back( 0.001 * i );
+		radiance.push_back( exp( -double( i ) ) );
+	}
+
+	SunshapeTable table;
+	ASSERT_TRUE( table.SetProfile( theta, radiance ) );
+
+	double previous = table.SampleTheta( 0.0 );
+	for( int i = 1; i <= 1000; ++i )
+	{
+		double current = table.SampleTheta( i / 1000.0 );
+		EXPECT_GE( current, previous );
+		previous = current;
+	}
+	EXPECT_NEAR( 0.02, previous, 1.0e-9 );
+}
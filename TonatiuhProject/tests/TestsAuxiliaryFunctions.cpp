@@ -40,6 +40,10 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #include <stdlib.h>
 #include <time.h>
 
+#include <QDir>
+#include <QStringList>
+#include <QTemporaryFile>
+
 #include "BBox.h"
 #include "Ray.h"
 
@@ -85,3 +89,49 @@ Ray taf::randomRay( double a, double b )
 {
 	return Ray( randomPoint(a, b), randomDirection() );
 }
+
+/*!
+ * Creates an empty directory with a unique name in the system temporary directory.
+ * The name is reserved with a QTemporaryFile, as QTemporaryDir is not available in Qt 4.
+ */
+taf::TemporaryDirectory::TemporaryDirectory()
+{
+	QTemporaryFile file( QDir::temp().absoluteFilePath( QLatin1String( "TonatiuhTests_XXXXXX" ) ) );
+	file.setAutoRemove( false );
+	if( !file.open() )	return;
+	QString path = file.fileName();
+	file.close();
+
+	QFile::remove( path );
+	if( QDir().mkdir( path ) )	m_path = path;
+}
+
+/*!
+ * Removes the files in the directory and the directory.
+ */
+taf::TemporaryDirectory::~TemporaryDirectory()
+{
+	if( m_path.isEmpty() )	return;
+
+	QDir directory( m_path );
+	QStringList files = directory.entryList( QDir::Files | QDir::Hidden | QDir::System );
+	for( int f = 0; f < files.count(); ++f )
+		directory.remove( files[f] );
+	QDir().rmdir( m_path );
+}
+
+/*!
+ * Returns the absolute path of the directory.
+ */
+QString taf::TemporaryDirectory::Path() const
+{
+	return m_path;
+}
+
+/*!
+ * Returns the absolute path of the file \a fileName inside the directory.
+ */
+QString taf::TemporaryDirectory::FilePath( const QString& fileName ) const
+{
+	return QDir( m_path ).absoluteFilePath( fileName );
+}
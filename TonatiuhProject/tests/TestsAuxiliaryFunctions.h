@@ -39,6 +39,8 @@ Juana Amieva, Azael Mancillas, Cesar Cantu.
 #ifndef TESTSAUXILIARYFUNCTIONS_H_
 #define TESTSAUXILIARYFUNCTIONS_H_
 
+#include <QString>
+
 class Point3D;
 class Vector3D;
 class Ray;
@@ -52,6 +54,20 @@ namespace taf
    BBox randomBox( double a, double b );
    Vector3D randomDirection( );
    Ray randomRay( double a, double b );
+
+   //! Unique directory for the files written by a test. It is removed with its files on destruction.
+   class TemporaryDirectory
+   {
+   public:
+      TemporaryDirectory();
+      ~TemporaryDirectory();
+
+      QString Path() const;
+      QString FilePath( const QString& fileName ) const;
+
+   private:
+      QString m_path;
+   };
 }
 
 #endif /* TESTSAUXILIARYFUNCTIONS_H_ */
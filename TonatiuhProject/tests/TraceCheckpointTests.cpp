@@ -0,0 +1,314 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <QFile>
+#include <QMutex>
+
+#include "BBox.h"
+#include "InstanceNode.h"
+#include "Photon.h"
+#include "Point3D.h"
+#include "RandomDeviate.h"
+#include "RayTracer.h"
+#include "ShapeTroughCPC.h"
+#include "SunshapePillbox.h"
+#include "TLightShape.h"
+#include "TPhotonMap.h"
+#include "TraceCheckpoint.h"
+#include "Transform.h"
+#include "TSeparatorKit.h"
+#include "TShapeKit.h"
+
+#include "TestsAuxiliaryFunctions.h"
+
+//! Linear congruential generator that can not skip ahead, so the resumed stream is generated again.
+class SequenceDeviate : public RandomDeviate
+{
+public:
+	SequenceDeviate()
+	:m_state( 12345 )
+	{
+	}
+	void FillArray( double* array, const unsigned long arraySize )
+	{
+		for( unsigned long i = 0; i < arraySize; ++i )
+		{
+			m_state = m_state * Q_UINT64_C( 6364136223846793005 ) + Q_UINT64_C( 1442695040888963407 );
+			array[i] = double( m_state >> 11 ) / 9007199254740992.0;
+		}
+	}
+
+private:
+	quint64 m_state;
+};
+
+//! Scene of a CPC trough lit from above by a light of 2x2 cells.
+class TraceScene
+{
+public:
+	TraceScene()
+	:m_rootKit( new TSeparatorKit ),
+	 m_shapeKit( new TShapeKit ),
+	 m_lightShape( new TLightShape ),
+	 m_sunShape( new SunshapePillbox ),
+	 m_rootNode( 0 ),
+	 m_surfaceNode( 0 )
+	{
+		m_rootKit->ref();
+		m_shapeKit->ref();
+		m_lightShape->ref();
+		m_sunShape->ref();
+
+		ShapeTroughCPC* shape = new ShapeTroughCPC;
+		m_shapeKit->setPart( "shape", shape );
+
+		Transform identity( 1.0, 0.0, 0.0, 0.0,
+							0.0, 1.0, 0.0, 0.0,
+							0.0, 0.0, 1.0, 0.0,
+							0.0, 0.0, 0.0, 1.0 );
+
+		m_rootNode = new InstanceNode( m_rootKit );
+		m_rootNode->SetIntersectionTransform( identity );
+		m_rootNode->SetIntersectionBBox( BBox( Point3D( -10.0, -10.0, -10.0 ), Point3D( 10.0, 10.0, 10.0 ) ) );
+
+		m_surfaceNode = new InstanceNode( m_shapeKit );
+		m_surfaceNode->AddChild( new InstanceNode( shape ) );
+		m_surfaceNode->SetIntersectionTransform( identity );
+		m_surfaceNode->SetIntersectionBBox( BBox( Point3D( -10.0, -10.0, -10.0 ), Point3D( 10.0, 10.0, 10.0 ) ) );
+		m_rootNode->AddChild( m_surfaceNode );
+
+		m_lightShape->xMin.setValue( 0.0 );
+		m_lightShape->xMax.setValue( 2.0 );
+		m_lightShape->zMin.setValue( -0.4 );
+		m_lightShape->zMax.setValue( 0.4 );
+		int** lightArea = new int*[2];
+		for( int h = 0; h < 2; ++h )
+		{
+			lightArea[h] = new int[2];
+			lightArea[h][0] = 1;
+			lightArea[h][1] = 1;
+		}
+		m_lightShape->SetLightSourceArea( 2, 2, lightArea );
+	}
+	~TraceScene()
+	{
+		delete m_rootNode;
+		m_sunShape->unref();
+		m_lightShape->unref();
+		m_shapeKit->unref();
+		m_rootKit->unref();
+	}
+
+	/*!
+	 * Traces \a numberOfRays rays with \a rand in a single thread and stores the photons to \a photonMap.
+	 */
+	void Trace( double numberOfRays, RandomDeviate& rand, TPhotonMap* photonMap )
+	{
+		Transform lightToWorld( 1.0, 0.0, 0.0, 0.0,
+								0.0, 1.0, 0.0, 10.0,
+								0.0, 0.0, 1.0, 0.0,
+								0.0, 0.0, 0.0, 1.0 );
+		QMutex mutex;
+		QMutex mutexPhotonMap;
+		RayTracer rayTracer( m_rootNode, 0, m_lightShape, m_sunShape, lightToWorld, 0, rand, &mutex,
+				photonMap, &mutexPhotonMap, QVector< InstanceNode* >() );
+		rayTracer( numberOfRays );
+	}
+
+	const InstanceNode* SurfaceNode() const
+	{
+		return m_surfaceNode;
+	}
+
+private:
+	TSeparatorKit* m_rootKit;
+	TShapeKit* m_shapeKit;
+	TLightShape* m_lightShape;
+	SunshapePillbox* m_sunShape;
+	InstanceNode* m_rootNode;
+	InstanceNode* m_surfaceNode;
+};
+
+static TraceCheckpoint CreateCheckpoint()
+{
+	TraceCheckpoint checkpoint;
+	checkpoint.sceneKey = QByteArray( "scene" );
+	checkpoint.randomDeviateName = QLatin1String( "Philox" );
+	checkpoint.randomSeed = 1234;
+	checkpoint.randomSubstream = 3;
+	checkpoint.randomStreamPosition = Q_UINT64_C( 5000000000 );
+	checkpoint.randomReservedPaths = 42;
+	checkpoint.tracedRays = 200000;
+	checkpoint.lastRay = 1000000;
+	checkpoint.checkpointRays = 100000;
+	checkpoint.wPhoton = 0.25;
+	checkpoint.exportModeName = QLatin1String( "SaveToFile" );
+	checkpoint.exportState = QByteArray( "\0\1\2\3", 4 );
+	return checkpoint;
+}
+
+TEST( TraceCheckpointTests, WriteAndRead )
+{
+	taf::TemporaryDirectory directory;
+	QString fileName = directory.FilePath( "trace.tck" );
+
+	TraceCheckpoint checkpoint = CreateCheckpoint();
+	ASSERT_TRUE( checkpoint.Write( fileName ) );
+	EXPECT_FALSE( QFile::exists( fileName + QLatin1String( ".tmp" ) ) );
+
+	TraceCheckpoint read;
+	ASSERT_TRUE( read.Read( fileName ) );
+	EXPECT_EQ( checkpoint.sceneKey, read.sceneKey );
+	EXPECT_EQ( checkpoint.randomDeviateName, read.randomDeviateName );
+	EXPECT_EQ( checkpoint.randomSeed, read.randomSeed );
+	EXPECT_EQ( checkpoint.randomSubstream, read.randomSubstream );
+	EXPECT_EQ( checkpoint.randomStreamPosition, read.randomStreamPosition );
+	EXPECT_EQ( checkpoint.randomReservedPaths, read.randomReservedPaths );
+	EXPECT_EQ( checkpoint.tracedRays, read.tracedRays );
+	EXPECT_EQ( checkpoint.lastRay, read.lastRay );
+	EXPECT_EQ( checkpoint.checkpointRays, read.checkpointRays );
+	EXPECT_DOUBLE_EQ( checkpoint.wPhoton, read.wPhoton );
+	EXPECT_EQ( checkpoint.exportModeName, read.exportModeName );
+	EXPECT_EQ( checkpoint.exportState, read.exportState );
+
+	//A new checkpoint replaces the previous one
+	checkpoint.tracedRays = 300000;
+	ASSERT_TRUE( checkpoint.Write( fileName ) );
+	ASSERT_TRUE( read.Read( fileName ) );
+	EXPECT_EQ( 300000UL, read.tracedRays );
+}
+
+TEST( TraceCheckpointTests, ReadsTemporaryFile )
+{
+	taf::TemporaryDirectory directory;
+	QString fileName = directory.FilePath( "trace.tck" );
+
+	//A checkpoint interrupted after writing the temporary file
+	TraceCheckpoint checkpoint = CreateCheckpoint();
+	ASSERT_TRUE( checkpoint.Write( fileName ) );
+	ASSERT_TRUE( QFile::rename( fileName, fileName + QLatin1String( ".tmp" ) ) );
+
+	TraceCheckpoint read;
+	ASSERT_TRUE( read.Read( fileName ) );
+	EXPECT_EQ( checkpoint.tracedRays, read.tracedRays );
+}
+
+TEST( TraceCheckpointTests, RejectsIncompleteFile )
+{
+	taf::TemporaryDirectory directory;
+	QString fileName = directory.FilePath( "trace.tck" );
+
+	TraceCheckpoint checkpoint = CreateCheckpoint();
+	ASSERT_TRUE( checkpoint.Write( fileName ) );
+
+	QFile checkpointFile( fileName );
+	ASSERT_TRUE( checkpointFile.resize( checkpointFile.size() - 8 ) );
+
+	TraceCheckpoint read;
+	EXPECT_FALSE( read.Read( fileName ) );
+	EXPECT_FALSE( read.GetErrorMessage().isEmpty() );
+
+	//Without the checkpoint files
+	ASSERT_TRUE( QFile::remove( fileName ) );
+	EXPECT_FALSE( read.Read( fileName ) );
+}
+
+TEST( TraceCheckpointTests, ResumedTraceContinuesPhotonMap )
+{
+	const double checkpointRays = 500;
+	const double remainingRays = 700;
+
+	TraceScene scene;
+
+	//Trace without interruption. The rays are traced in the same two segments, because each segment
+	//discards the numbers that it takes from the generator and does not use.
+	SequenceDeviate rand;
+	TPhotonMap photonMap;
+	photonMap.SetBufferSize( 100000 );
+	scene.Trace( checkpointRays, rand, &photonMap );
+	scene.Trace( remainingRays, rand, &photonMap );
+
+	//Trace until the checkpoint
+	taf::TemporaryDirectory directory;
+	QString fileName = directory.FilePath( "trace.tck" );
+
+	SequenceDeviate checkpointRand;
+	TPhotonMap checkpointPhotonMap;
+	checkpointPhotonMap.SetBufferSize( 100000 );
+	scene.Trace( checkpointRays, checkpointRand, &checkpointPhotonMap );
+
+	TraceCheckpoint checkpoint = CreateCheckpoint();
+	checkpoint.randomStreamPosition = checkpointRand.StreamPosition();
+	checkpoint.randomReservedPaths = checkpointRand.ReservedPaths();
+	ASSERT_TRUE( checkpoint.Write( fileName ) );
+
+	//Resume with a new generator
+	TraceCheckpoint read;
+	ASSERT_TRUE( read.Read( fileName ) );
+	SequenceDeviate resumedRand;
+	resumedRand.Skip( read.randomStreamPosition );
+	resumedRand.ReservePaths( read.randomReservedPaths );
+	TPhotonMap resumedPhotonMap;
+	resumedPhotonMap.SetBufferSize( 100000 );
+	scene.Trace( remainingRays, resumedRand, &resumedPhotonMap );
+
+	EXPECT_EQ( rand.StreamPosition(), resumedRand.StreamPosition() );
+	EXPECT_EQ( rand.ReservedPaths(), resumedRand.ReservedPaths() );
+
+	std::vector< Photon* > photons = photonMap.GetAllPhotons();
+	std::vector< Photon* > resumedPhotons = checkpointPhotonMap.GetAllPhotons();
+	resumedPhotons.insert( resumedPhotons.end(), resumedPhotonMap.GetAllPhotons().begin(), resumedPhotonMap.GetAllPhotons().end() );
+	ASSERT_EQ( photons.size(), resumedPhotons.size() );
+
+	int surfacePhotons = 0;
+	for( unsigned int p = 0; p < photons.size(); ++p )
+	{
+		EXPECT_EQ( photons[p]->pos.x, resumedPhotons[p]->pos.x );
+		EXPECT_EQ( photons[p]->pos.y, resumedPhotons[p]->pos.y );
+		EXPECT_EQ( photons[p]->pos.z, resumedPhotons[p]->pos.z );
+		EXPECT_EQ( photons[p]->id, resumedPhotons[p]->id );
+		EXPECT_EQ( photons[p]->side, resumedPhotons[p]->side );
+		EXPECT_TRUE( photons[p]->intersectedSurface == resumedPhotons[p]->intersectedSurface );
+		if( photons[p]->intersectedSurface == scene.SurfaceNode() )	++surfacePhotons;
+	}
+	EXPECT_GT( surfacePhotons, 0 );
+}
@@ -0,0 +1,137 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Point3D.h"
+#include "Ray.h"
+#include "Triangle.h"
+#include "TrianglePacket.h"
+#include "Vector3D.h"
+
+static double RandomValue( double min, double max )
+{
+	return min + ( max - min ) * rand() / RAND_MAX;
+}
+
+/*!
+ * Tests with rays from all the directions at the angle \a elevation with the plane of the triangles of \a packet
+ * that the packet returns as candidates all the triangles that the double test intersects.
+ * Returns the number of intersections.
+ */
+static int TestRaysAtElevation( const TrianglePacket& packet, const std::vector< Point3D >& vertices, double elevation )
+{
+	int nHits = 0;
+	for( int r = 0; r < 2000; ++r )
+	{
+		//A point of the first triangle, or near its edges
+		double a = RandomValue( -0.01, 1.01 );
+		double b = RandomValue( -0.01, 1.01 - a );
+		Point3D target = vertices[0] + a * ( vertices[1] - vertices[0] ) + b * ( vertices[2] - vertices[0] );
+
+		double azimuth = RandomValue( 0.0, 2 * M_PI );
+		Vector3D direction( cos( elevation ) * cos( azimuth ), sin( elevation ), cos( elevation ) * sin( azimuth ) );
+		Ray ray( target - 50.0 * direction, direction, 0.0001, 1000.0 );
+
+		for( int t = 0; t < packet.GetNumberOfTriangles(); ++t )
+		{
+			double tHit = ray.maxt;
+			if( packet.GetTriangle( t )->IntersectT( ray, &tHit ) )
+			{
+				nHits++;
+				EXPECT_TRUE( ( packet.Intersect( ray, ray.maxt ) & ( 1 << t ) ) != 0 )
+						<< "elevation " << elevation << " triangle " << t;
+			}
+		}
+	}
+	return nHits;
+}
+
+TEST( TrianglePacketTests, GrazingRaysAreCandidates )
+{
+	//Large triangles far from the origin, almost in a horizontal plane
+	std::vector< Point3D > vertices;
+	vertices.push_back( Point3D( 1000.0, 5.0, 1000.0 ) );
+	vertices.push_back( Point3D( 1100.0, 5.0, 1000.0 ) );
+	vertices.push_back( Point3D( 1000.0, 5.001, 1100.0 ) );
+	vertices.push_back( Point3D( 1100.0, 5.002, 1100.0 ) );
+
+	std::vector< Triangle* > triangles;
+	triangles.push_back( new Triangle( &vertices[0], 0, 1, 2 ) );
+	triangles.push_back( new Triangle( &vertices[0], 1, 3, 2 ) );
+	TrianglePacket packet( &triangles[0], int( triangles.size() ) );
+
+	srand( 23 );
+	int nHits = 0;
+	for( int e = 0; e <= 6; ++e )
+		nHits += TestRaysAtElevation( packet, vertices, pow( 10.0, -e ) );
+	EXPECT_GT( nHits, 1000 );
+
+	for( unsigned int t = 0; t < triangles.size(); ++t )
+		delete triangles[t];
+}
+
+TEST( TrianglePacketTests, DistantTrianglesAreNotCandidates )
+{
+	std::vector< Point3D > vertices;
+	vertices.push_back( Point3D( 0.0, 0.0, 0.0 ) );
+	vertices.push_back( Point3D( 1.0, 0.0, 0.0 ) );
+	vertices.push_back( Point3D( 0.0, 0.0, 1.0 ) );
+	vertices.push_back( Point3D( 5.0, 0.0, 5.0 ) );
+	vertices.push_back( Point3D( 6.0, 0.0, 5.0 ) );
+	vertices.push_back( Point3D( 5.0, 0.0, 6.0 ) );
+
+	std::vector< Triangle* > triangles;
+	triangles.push_back( new Triangle( &vertices[0], 0, 1, 2 ) );
+	triangles.push_back( new Triangle( &vertices[0], 3, 4, 5 ) );
+	TrianglePacket packet( &triangles[0], int( triangles.size() ) );
+
+	//A vertical ray through the first triangle is not a candidate for the second one
+	Ray ray( Point3D( 0.25, 1.0, 0.25 ), Vector3D( 0.0, -1.0, 0.0 ) );
+	EXPECT_EQ( 1, packet.Intersect( ray, ray.maxt ) );
+
+	//The triangles beyond the ray segment are not candidates
+	EXPECT_EQ( 0, packet.Intersect( Ray( Point3D( 0.25, 1.0, 0.25 ), Vector3D( 0.0, -1.0, 0.0 ), 0.0001, 0.5 ), 0.5 ) );
+
+	for( unsigned int t = 0; t < triangles.size(); ++t )
+		delete triangles[t];
+}
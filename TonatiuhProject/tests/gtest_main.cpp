@@ -46,6 +46,13 @@
 #include "TSquare.h"
 #include "TSceneKit.h"
 #include "TSceneTracker.h"
+#include "MaterialStandardSpecular.h"
+#include "ShapeCAD.h"
+#include "ShapeFlatRectangle.h"
+#include "ShapeSphericalPolygon.h"
+#include "ShapeTroughAsymmetricCPC.h"
+#include "ShapeTroughCPC.h"
+#include "SunshapePillbox.h"
 #include "TTrackerForAiming.h"
 #include "TTransmissivity.h"
 
@@ -74,6 +81,13 @@ int main(int argc, char **argv )
 	TSceneTracker::initClass();
 	TTrackerForAiming::initClass();
 	TTransmissivity::initClass();
+	MaterialStandardSpecular::initClass();
+	ShapeCAD::initClass();
+	ShapeFlatRectangle::initClass();
+	ShapeSphericalPolygon::initClass();
+	ShapeTroughCPC::initClass();
+	ShapeTroughAsymmetricCPC::initClass();
+	SunshapePillbox::initClass();
 
 
     testing::InitGoogleTest(&argc, argv);
@@ -3,17 +3,34 @@ CONFIG += console debug_and_release
 include( ../config.pri )
 
 QT += xml opengl svg  script network
+greaterThan(QT_MAJOR_VERSION, 4) {
+    QT += concurrent
+}
+
+DEFINES += TEST_DIR=\\\"$$PWD\\\"
 
-DEFINES += TEST_DIR=\\\"PWD/../tests\\\"
+INCLUDEPATH += $$(TONATIUH_ROOT)/plugins/MaterialStandardSpecular/src \
+               $$(TONATIUH_ROOT)/plugins/RandomSobol/src \
+               $$(TONATIUH_ROOT)/plugins/ShapeCAD/src \
+               $$(TONATIUH_ROOT)/plugins/ShapeFlatRectangle/src \
+               $$(TONATIUH_ROOT)/plugins/ShapeSphericalPolygon/src \
+               $$(TONATIUH_ROOT)/plugins/ShapeTroughAsymmetricCPC/src \
+               $$(TONATIUH_ROOT)/plugins/ShapeTroughCPC/src \
+               $$(TONATIUH_ROOT)/plugins/SunshapePillbox/src
 
 SOURCES += *.cpp 
            
 CONFIG(debug, debug|release) {
     OBJECTS       +=    $$(TONATIUH_ROOT)/debug/BBox.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/BVH.o \
                         $$(TONATIUH_ROOT)/debug/DifferentialGeometry.o \
+                        $$(TONATIUH_ROOT)/debug/DistributedRayTracer.o \
                         $$(TONATIUH_ROOT)/debug/Document.o \
+                        $$(TONATIUH_ROOT)/debug/FluxAnalysis.o \
                         $$(TONATIUH_ROOT)/debug/InstanceNode.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/MaterialStandardSpecular.o \
                         $$(TONATIUH_ROOT)/debug/Matrix4x4.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/MeshReader.o \
                         $$(TONATIUH_ROOT)/debug/moc_Document.o \
                         $$(TONATIUH_ROOT)/debug/moc_ParallelRandomDeviate.o \
                         $$(TONATIUH_ROOT)/debug/moc_SceneModel.o \
@@ -21,27 +38,41 @@ CONFIG(debug, debug|release) {
                         $$(TONATIUH_ROOT)/debug/NormalVector.o \
                         $$(TONATIUH_ROOT)/debug/ParallelRandomDeviate.o \
                         $$(TONATIUH_ROOT)/debug/PathWrapper.o \
+                        $$(TONATIUH_ROOT)/debug/Philox.o \
                         $$(TONATIUH_ROOT)/debug/Photon.o \
                         $$(TONATIUH_ROOT)/debug/PhotonMapExport.o \
                         $$(TONATIUH_ROOT)/debug/Point3D.o \
                         $$(TONATIUH_ROOT)/debug/PluginManager.o \
+                        $$(TONATIUH_ROOT)/debug/PrimaryRayCache.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/RandomSobol.o \
                         $$(TONATIUH_ROOT)/debug/RayTracer.o \
-                        $$(TONATIUH_ROOT)/debug/RayTracerNoTr.o \
+                        $$(TONATIUH_ROOT)/debug/RayTracingProfiler.o \
                         $$(TONATIUH_ROOT)/debug/RefCount.o \
+                        $$(TONATIUH_ROOT)/debug/SceneCache.o \
                         $$(TONATIUH_ROOT)/debug/SceneModel.o \
                         $$(TONATIUH_ROOT)/debug/ScriptRayTracer.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/ShapeCAD.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/ShapeFlatRectangle.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/ShapeSphericalPolygon.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/ShapeTroughAsymmetricCPC.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/ShapeTroughCPC.o \
                         $$(TONATIUH_ROOT)/debug/sunpos.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/SunshapePillbox.o \
+                        $$(TONATIUH_ROOT)/debug/IncidenceAngleTable.o \
+                        $$(TONATIUH_ROOT)/debug/SunshapeTable.o \
                         $$(TONATIUH_ROOT)/debug/TCube.o \
                         $$(TONATIUH_ROOT)/debug/TDefaultMaterial.o \
                         $$(TONATIUH_ROOT)/debug/TDefaultSunShape.o \
                         $$(TONATIUH_ROOT)/debug/TDefaultTracker.o \
                         $$(TONATIUH_ROOT)/debug/TDefaultTransmissivity.o \
+                        $$(TONATIUH_ROOT)/debug/Timer.o \
                         $$(TONATIUH_ROOT)/debug/tgf.o \
                         $$(TONATIUH_ROOT)/debug/TLightKit.o \
                         $$(TONATIUH_ROOT)/debug/TLightShape.o \
                         $$(TONATIUH_ROOT)/debug/TMaterial.o \
                         $$(TONATIUH_ROOT)/debug/tonatiuh_script.o \
                         $$(TONATIUH_ROOT)/debug/TPhotonMap.o \
+                        $$(TONATIUH_ROOT)/debug/TraceCheckpoint.o \
                         $$(TONATIUH_ROOT)/debug/Transform.o \
                         $$(TONATIUH_ROOT)/debug/trf.o \
                         $$(TONATIUH_ROOT)/debug/TSceneTracker.o \
@@ -54,14 +85,21 @@ CONFIG(debug, debug|release) {
                         $$(TONATIUH_ROOT)/debug/TTracker.o \
                         $$(TONATIUH_ROOT)/debug/TTrackerForAiming.o \
                         $$(TONATIUH_ROOT)/debug/TTransmissivity.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/Triangle.o \
+                        $$(TONATIUH_ROOT)/debug/plugins/TrianglePacket.o \
                         $$(TONATIUH_ROOT)/debug/Vector3D.o
 }                     
 else { 
     OBJECTS       +=    $$(TONATIUH_ROOT)/release/BBox.o \
+                        $$(TONATIUH_ROOT)/release/plugins/BVH.o \
                         $$(TONATIUH_ROOT)/release/DifferentialGeometry.o \
+                        $$(TONATIUH_ROOT)/release/DistributedRayTracer.o \
                         $$(TONATIUH_ROOT)/release/Document.o \
+                        $$(TONATIUH_ROOT)/release/FluxAnalysis.o \
                         $$(TONATIUH_ROOT)/release/InstanceNode.o \
+                        $$(TONATIUH_ROOT)/release/plugins/MaterialStandardSpecular.o \
                         $$(TONATIUH_ROOT)/release/Matrix4x4.o \
+                        $$(TONATIUH_ROOT)/release/plugins/MeshReader.o \
                         $$(TONATIUH_ROOT)/release/moc_Document.o \
                         $$(TONATIUH_ROOT)/release/moc_ParallelRandomDeviate.o \
                         $$(TONATIUH_ROOT)/release/moc_SceneModel.o \
@@ -69,27 +107,41 @@ else {
                         $$(TONATIUH_ROOT)/release/NormalVector.o \
                         $$(TONATIUH_ROOT)/release/ParallelRandomDeviate.o \
                         $$(TONATIUH_ROOT)/release/PathWrapper.o \
+                        $$(TONATIUH_ROOT)/release/Philox.o \
                         $$(TONATIUH_ROOT)/release/Photon.o \
                         $$(TONATIUH_ROOT)/release/PhotonMapExport.o \
                         $$(TONATIUH_ROOT)/release/Point3D.o \
                         $$(TONATIUH_ROOT)/release/PluginManager.o \
+                        $$(TONATIUH_ROOT)/release/PrimaryRayCache.o \
+                        $$(TONATIUH_ROOT)/release/plugins/RandomSobol.o \
                         $$(TONATIUH_ROOT)/release/RayTracer.o \
-                        $$(TONATIUH_ROOT)/release/RayTracerNoTr.o \
+                        $$(TONATIUH_ROOT)/release/RayTracingProfiler.o \
                         $$(TONATIUH_ROOT)/release/RefCount.o \
+                        $$(TONATIUH_ROOT)/release/SceneCache.o \
                         $$(TONATIUH_ROOT)/release/SceneModel.o \
                         $$(TONATIUH_ROOT)/release/ScriptRayTracer.o \
+                        $$(TONATIUH_ROOT)/release/plugins/ShapeCAD.o \
+                        $$(TONATIUH_ROOT)/release/plugins/ShapeFlatRectangle.o \
+                        $$(TONATIUH_ROOT)/release/plugins/ShapeSphericalPolygon.o \
+                        $$(TONATIUH_ROOT)/release/plugins/ShapeTroughAsymmetricCPC.o \
+                        $$(TONATIUH_ROOT)/release/plugins/ShapeTroughCPC.o \
                         $$(TONATIUH_ROOT)/release/sunpos.o \
+                        $$(TONATIUH_ROOT)/release/plugins/SunshapePillbox.o \
+                        $$(TONATIUH_ROOT)/release/IncidenceAngleTable.o \
+                        $$(TONATIUH_ROOT)/release/SunshapeTable.o \
                         $$(TONATIUH_ROOT)/release/TCube.o \
                         $$(TONATIUH_ROOT)/release/TDefaultMaterial.o \
                         $$(TONATIUH_ROOT)/release/TDefaultSunShape.o \
                         $$(TONATIUH_ROOT)/release/TDefaultTracker.o \
                         $$(TONATIUH_ROOT)/release/TDefaultTransmissivity.o \
+                        $$(TONATIUH_ROOT)/release/Timer.o \
                         $$(TONATIUH_ROOT)/release/tgf.o \
                         $$(TONATIUH_ROOT)/release/TLightKit.o \
                         $$(TONATIUH_ROOT)/release/TLightShape.o \
                         $$(TONATIUH_ROOT)/release/TMaterial.o \
                         $$(TONATIUH_ROOT)/release/tonatiuh_script.o \
                         $$(TONATIUH_ROOT)/release/TPhotonMap.o \
+                        $$(TONATIUH_ROOT)/release/TraceCheckpoint.o \
                         $$(TONATIUH_ROOT)/release/Transform.o \
                         $$(TONATIUH_ROOT)/release/trf.o \
                         $$(TONATIUH_ROOT)/release/TSeparatorKit.o \
@@ -102,6 +154,8 @@ else {
                         $$(TONATIUH_ROOT)/release/TTracker.o \
                         $$(TONATIUH_ROOT)/release/TTrackerForAiming.o \
                         $$(TONATIUH_ROOT)/release/TTransmissivity.o \
+                        $$(TONATIUH_ROOT)/release/plugins/Triangle.o \
+                        $$(TONATIUH_ROOT)/release/plugins/TrianglePacket.o \
                         $$(TONATIUH_ROOT)/release/Vector3D.o
 }
 
@@ -0,0 +1,163 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+#include "NormalVector.h"
+#include "RandomDeviate.h"
+#include "tgf.h"
+#include "Vector3D.h"
+
+//Stream generator with the numbers of the standard library generator in (0,1)
+class StdDeviate : public RandomDeviate
+{
+public:
+	StdDeviate( unsigned int seed ) { srand( seed ); }
+	void FillArray( double* array, const unsigned long arraySize )
+	{
+		for( unsigned long i = 0; i < arraySize; ++i )	array[i] = ( rand() + 0.5 ) / ( RAND_MAX + 1.0 );
+	}
+};
+
+//Orthonormal surface frame
+static const NormalVector frameNormal = Normalize( NormalVector( 1.0, 2.0, 3.0 ) );
+static const Vector3D frameS = Normalize( CrossProduct( Vector3D( frameNormal ), Vector3D( 0.0, 0.0, 1.0 ) ) );
+static const Vector3D frameT = CrossProduct( frameS, Vector3D( frameNormal ) );
+
+TEST( tgfTests, BoxMullerPairHasUnitVariance )
+{
+	StdDeviate rand( 1234 );
+
+	const int nPairs = 100000;
+	double sum1 = 0.0;
+	double sum2 = 0.0;
+	double sumSquares1 = 0.0;
+	double sumSquares2 = 0.0;
+	double sumProducts = 0.0;
+	for( int i = 0; i < nPairs; ++i )
+	{
+		double x1 = 0.0;
+		double x2 = 0.0;
+		tgf::BoxMullerPair( rand, &x1, &x2 );
+		ASSERT_LT( fabs( x1 ), 100.0 );
+		ASSERT_LT( fabs( x2 ), 100.0 );
+
+		sum1 += x1;
+		sum2 += x2;
+		sumSquares1 += x1 * x1;
+		sumSquares2 += x2 * x2;
+		sumProducts += x1 * x2;
+	}
+
+	EXPECT_NEAR( 0.0, sum1 / nPairs, 0.02 );
+	EXPECT_NEAR( 0.0, sum2 / nPairs, 0.02 );
+	EXPECT_NEAR( 1.0, sumSquares1 / nPairs, 0.03 );
+	EXPECT_NEAR( 1.0, sumSquares2 / nPairs, 0.03 );
+	EXPECT_NEAR( 0.0, sumProducts / nPairs, 0.02 );
+}
+
+TEST( tgfTests, SlopeErrorNormalWithZeroSigmaIsTheSurfaceNormal )
+{
+	StdDeviate rand( 1 );
+	for( int distribution = 0; distribution < 2; ++distribution )
+	{
+		NormalVector errorNormal = tgf::SlopeErrorNormal( 0.0, distribution, rand );
+		EXPECT_DOUBLE_EQ( 0.0, errorNormal.x );
+		EXPECT_DOUBLE_EQ( 1.0, errorNormal.y );
+		EXPECT_DOUBLE_EQ( 0.0, errorNormal.z );
+	}
+}
+
+TEST( tgfTests, SlopeErrorNormalPillboxIsWithinSigma )
+{
+	StdDeviate rand( 2 );
+	double sigmaSlope = 0.01;
+	for( int i = 0; i < 1000; ++i )
+	{
+		NormalVector errorNormal = tgf::SlopeErrorNormal( sigmaSlope, 0, rand );
+		EXPECT_NEAR( 1.0, errorNormal.length(), 1.0e-12 );
+		EXPECT_LE( acos( errorNormal.y ), sigmaSlope * ( 1.0 + 1.0e-9 ) );
+	}
+}
+
+TEST( tgfTests, NormalFromLocalFrameIsOrthonormal )
+{
+	Vector3D dpdu = frameS * 2.5;
+	Vector3D dpdv = frameT * 0.3;
+
+	NormalVector x = tgf::NormalFromLocalFrame( NormalVector( 1.0, 0.0, 0.0 ), frameNormal, dpdu, dpdv );
+	NormalVector y = tgf::NormalFromLocalFrame( NormalVector( 0.0, 1.0, 0.0 ), frameNormal, dpdu, dpdv );
+	NormalVector z = tgf::NormalFromLocalFrame( NormalVector( 0.0, 0.0, 1.0 ), frameNormal, dpdu, dpdv );
+
+	EXPECT_NEAR( 1.0, x.length(), 1.0e-12 );
+	EXPECT_NEAR( 1.0, y.length(), 1.0e-12 );
+	EXPECT_NEAR( 1.0, z.length(), 1.0e-12 );
+	EXPECT_NEAR( 0.0, DotProduct( x, y ), 1.0e-12 );
+	EXPECT_NEAR( 0.0, DotProduct( x, z ), 1.0e-12 );
+	EXPECT_NEAR( 0.0, DotProduct( y, z ), 1.0e-12 );
+
+	EXPECT_NEAR( 1.0, DotProduct( y, frameNormal ), 1.0e-12 );
+	EXPECT_NEAR( 1.0, DotProduct( Vector3D( x ), frameS ), 1.0e-12 );
+	EXPECT_NEAR( 1.0, DotProduct( Vector3D( z ), frameT ), 1.0e-12 );
+
+	//Any local normal keeps its angle with the surface normal
+	StdDeviate rand( 3 );
+	for( int i = 0; i < 1000; ++i )
+	{
+		NormalVector localNormal = tgf::SlopeErrorNormal( 0.2, 1, rand );
+		NormalVector normal = tgf::NormalFromLocalFrame( localNormal, frameNormal, dpdu, dpdv );
+		EXPECT_NEAR( 1.0, normal.length(), 1.0e-12 );
+		EXPECT_NEAR( localNormal.y / localNormal.length(), DotProduct( normal, frameNormal ), 1.0e-12 );
+	}
+}
+
+TEST( tgfTests, ZeroSlopeErrorKeepsTheSurfaceNormal )
+{
+	StdDeviate rand( 4 );
+	for( int distribution = 0; distribution < 2; ++distribution )
+	{
+		NormalVector localNormal = tgf::SlopeErrorNormal( 0.0, distribution, rand );
+		NormalVector normal = tgf::NormalFromLocalFrame( localNormal, frameNormal, frameS * 4.0, frameT * 0.5 );
+		EXPECT_NEAR( frameNormal.x, normal.x, 1.0e-12 );
+		EXPECT_NEAR( frameNormal.y, normal.y, 1.0e-12 );
+		EXPECT_NEAR( frameNormal.z, normal.z, 1.0e-12 );
+	}
+}
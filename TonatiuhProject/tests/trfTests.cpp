@@ -0,0 +1,74 @@
+/***************************************************************************
+Copyright (C) 2008 by the Tonatiuh Software Development Team.
+
+This file is part of Tonatiuh.
+
+Tonatiuh program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+Acknowledgments:
+
+The development of Tonatiuh was started on 2004 by Dr. Manuel J. Blanco,
+then Chair of the Department of Engineering of the University of Texas at
+Brownsville. From May 2004 to July 2008, it was supported by the Department
+of Energy (DOE) and the National Renewable Energy Laboratory (NREL) under
+the Minority Research Associate (MURA) Program Subcontract ACQ-4-33623-06.
+During 2007, NREL also contributed to the validation of Tonatiuh under the
+framework of the Memorandum of Understanding signed with the Spanish
+National Renewable Energy Centre (CENER) on February, 20, 2007 (MOU#NREL-07-117).
+Since June 2006, the development of Tonatiuh is being led by the CENER, under the
+direction of Dr. Blanco, now Director of CENER Solar Thermal Energy Department.
+
+Developers: Manuel J. Blanco (mblanco@cener.com), Amaia Mutuberria, Victor Martin.
+
+Contributors: Javier Garcia-Barberena, Iaki Perez, Inigo Pagola,  Gilda Jimenez,
+Juana Amieva, Azael Mancillas, Cesar Cantu.
+***************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "trf.h"
+
+static quint64 TotalRays( const QVector< long >& raysPerThread )
+{
+	quint64 totalRays = 0;
+	for( int c = 0; c < raysPerThread.size(); ++c )	totalRays += raysPerThread[c];
+	return totalRays;
+}
+
+TEST( trfTests, ComputeRaysPerThreadUsesTheChunkSize )
+{
+	QVector< long > raysPerThread = trf::ComputeRaysPerThread( 10, 3 );
+	ASSERT_EQ( 4, raysPerThread.size() );
+	EXPECT_EQ( 3, raysPerThread[0] );
+	EXPECT_EQ( 3, raysPerThread[2] );
+	EXPECT_EQ( 1, raysPerThread[3] );
+
+	EXPECT_TRUE( trf::ComputeRaysPerThread( 0, 3 ).isEmpty() );
+	EXPECT_EQ( 1, trf::ComputeRaysPerThread( 2, 3 ).size() );
+}
+
+TEST( trfTests, ComputeRaysPerThreadBoundsTheNumberOfChunks )
+{
+	unsigned long numberOfRays = 4000000000UL;
+	QVector< long > raysPerThread = trf::ComputeRaysPerThread( numberOfRays, 1 );
+	EXPECT_LE( raysPerThread.size(), 1048576 );
+	EXPECT_GT( raysPerThread.size(), 524288 );
+	EXPECT_EQ( quint64( numberOfRays ), TotalRays( raysPerThread ) );
+
+	//The computed chunk size
+	raysPerThread = trf::ComputeRaysPerThread( numberOfRays, 0 );
+	EXPECT_GT( raysPerThread.size(), 0 );
+	EXPECT_EQ( quint64( numberOfRays ), TotalRays( raysPerThread ) );
+}